@@ -6,6 +6,8 @@ using System;
 using System.Runtime;
 using System.Runtime.InteropServices;
 
+using Internal.Runtime.CompilerServices;
+
 using Debug = Internal.Runtime.CompilerHelpers.StartupDebug;
 
 namespace Internal.Runtime.CompilerHelpers
@@ -158,7 +160,10 @@ namespace Internal.Runtime.CompilerHelpers
             if (staticsSection != IntPtr.Zero)
             {
                 Debug.Assert(length % IntPtr.Size == 0);
-                InitializeStatics(staticsSection, length);
+
+                // The runtime decides whether the preinitialized static bases are used in place in the image.
+                bool usePreInitializedStaticsInPlace = RuntimeImports.RhpRegisterPreInitializedStatics(typeManager);
+                InitializeStatics(staticsSection, length, usePreInitializedStaticsInPlace);
             }
 #endif
 
@@ -169,6 +174,15 @@ namespace Internal.Runtime.CompilerHelpers
                 Debug.Assert(length % IntPtr.Size == 0);
                 InitializeModuleFrozenObjectSegment(frozenObjectSection, length);
             }
+
+            // Frozen objects with reference fields are kept in a separate segment. The runtime reports their
+            // references as static roots since the objects may be modified.
+            IntPtr frozenObjectsWithGCRefsSection = RuntimeImports.RhGetModuleSection(typeManager, ReadyToRunSectionType.FrozenObjectsWithGCRefsRegion, out length);
+            if (frozenObjectsWithGCRefsSection != IntPtr.Zero)
+            {
+                Debug.Assert(length % IntPtr.Size == 0);
+                InitializeModuleFrozenObjectSegment(frozenObjectsWithGCRefsSection, length);
+            }
         }
 
         private static unsafe void InitializeModuleFrozenObjectSegment(IntPtr segmentStart, int length)
@@ -267,7 +281,7 @@ namespace Internal.Runtime.CompilerHelpers
         }
 
 #if !PROJECTN
-        private static unsafe void InitializeStatics(IntPtr gcStaticRegionStart, int length)
+        private static unsafe void InitializeStatics(IntPtr gcStaticRegionStart, int length, bool usePreInitializedStaticsInPlace)
         {
             IntPtr gcStaticRegionEnd = (IntPtr)((byte*)gcStaticRegionStart + length);
 
@@ -281,16 +295,28 @@ namespace Internal.Runtime.CompilerHelpers
                 long blockAddr = (*pBlock).ToInt64();
                 if ((blockAddr & GCStaticRegionConstants.Uninitialized) == GCStaticRegionConstants.Uninitialized)
                 {
-                    object obj = RuntimeImports.RhNewObject(new EETypePtr(new IntPtr(blockAddr & ~GCStaticRegionConstants.Mask)));
+                    object obj;
 
                     if ((blockAddr & GCStaticRegionConstants.HasPreInitializedData) == GCStaticRegionConstants.HasPreInitializedData)
                     {
-                        // The next pointer is preinitialized data blob that contains preinitialized static GC fields,
-                        // which are pointer relocs to GC objects in frozen segment. 
-                        // It actually has all GC fields including non-preinitialized fields and we simply copy over the
-                        // entire blob to this object, overwriting everything. 
-                        IntPtr pPreInitDataAddr = *(pBlock + 1);
-                        RuntimeImports.RhBulkMoveWithWriteBarrier(ref obj.GetRawData(), ref *(byte *)pPreInitDataAddr, obj.GetRawDataSize());
+                        // The next pointer is a GC static object in the preinitialized statics region that contains
+                        // preinitialized static GC fields, which are pointer relocs to GC objects in frozen segment.
+                        // It actually has all GC fields including non-preinitialized fields. Either use the object
+                        // in place, or simply copy over the entire field data to a new object, overwriting everything.
+                        IntPtr pPreInitObject = *(pBlock + 1);
+                        if (usePreInitializedStaticsInPlace)
+                        {
+                            obj = Unsafe.As<IntPtr, object>(ref pPreInitObject);
+                        }
+                        else
+                        {
+                            obj = RuntimeImports.RhNewObject(new EETypePtr(new IntPtr(blockAddr & ~GCStaticRegionConstants.Mask)));
+                            RuntimeImports.RhBulkMoveWithWriteBarrier(ref obj.GetRawData(), ref *((byte *)pPreInitObject + IntPtr.Size), obj.GetRawDataSize());
+                        }
+                    }
+                    else
+                    {
+                        obj = RuntimeImports.RhNewObject(new EETypePtr(new IntPtr(blockAddr & ~GCStaticRegionConstants.Mask)));
                     }
 
                     *pBlock = RuntimeImports.RhHandleAlloc(obj, GCHandleType.Normal);
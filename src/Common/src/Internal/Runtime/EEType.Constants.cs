@@ -250,6 +250,11 @@ namespace Internal.Runtime
         /// </summary>
         NullableValueOffset,
 
+        /// <summary>
+        /// Union of the InterfaceSignatureBits of the interfaces in the interface map
+        /// </summary>
+        InterfaceSignature,
+
         // Number of field types we support
         Count
     }
@@ -284,4 +289,16 @@ namespace Internal.Runtime
         public static int GetSize(int pointerSize) => pointerSize;
         public static int GetAlignment(int pointerSize) => pointerSize;
     }
+
+    // Types with many interfaces carry a small bloom filter of their interface map so that casts to interfaces
+    // they don't implement can be rejected without scanning the map. Each interface sets two of the 32 bits,
+    // chosen by the hash code of its EEType.
+    internal static class InterfaceSignatureBits
+    {
+        // Smaller interface maps are scanned about as fast as the signature is decoded
+        public const int MinimumInterfaceCount = 8;
+
+        public static uint Get(uint interfaceHashCode) =>
+            (1u << (int)(interfaceHashCode & 31)) | (1u << (int)((interfaceHashCode >> 5) & 31));
+    }
 }
@@ -789,7 +789,10 @@ namespace Internal.Runtime
                         return DynamicTemplateType->DispatchMap;
                 }
 
-                return ((DispatchMap**)TypeManager.DispatchMap)[idxDispatchMap];
+                if (!SupportsRelativePointers)
+                    return ((DispatchMap**)TypeManager.DispatchMap)[idxDispatchMap];
+
+                return (DispatchMap*)FollowRelativePointer(&((int*)TypeManager.DispatchMap)[idxDispatchMap]);
             }
         }
 
@@ -951,6 +954,22 @@ namespace Internal.Runtime
             }
         }
 
+        /// <summary>
+        /// Gets the union of the InterfaceSignatureBits of the interfaces in the interface map, or zero if the
+        /// compiler didn't record one for this type.
+        /// </summary>
+        internal uint InterfaceSignature
+        {
+            get
+            {
+                byte* optionalFields = OptionalFieldsPtr;
+                if (optionalFields == null)
+                    return 0;
+
+                return OptionalFieldsReader.GetInlineField(optionalFields, EETypeOptionalFieldTag.InterfaceSignature, 0);
+            }
+        }
+
         internal EEType* RelatedParameterType
         {
             get
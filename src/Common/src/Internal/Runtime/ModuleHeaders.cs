@@ -83,6 +83,8 @@ namespace Internal.Runtime
         ThreadStaticIndex = 210,
         LoopHijackFlag = 211,
         ImportAddressTables = 212,
+        PreInitializedStaticsRegion = 213,
+        FrozenObjectsWithGCRefsRegion = 214,
 
         // Sections 300 - 399 are reserved for RhFindBlob backwards compatibility
         ReadonlyBlobRegionStart = 300,
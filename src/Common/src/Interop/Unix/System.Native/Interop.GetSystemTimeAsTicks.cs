@@ -9,6 +9,7 @@ internal static partial class Interop
     internal unsafe partial class Sys
     {
         [DllImport(Interop.Libraries.SystemNative, EntryPoint = "SystemNative_GetSystemTimeAsTicks")]
+        [SuppressGCTransition]
         internal static extern long GetSystemTimeAsTicks();
     }
 }
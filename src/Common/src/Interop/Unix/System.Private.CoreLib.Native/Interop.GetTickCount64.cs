@@ -10,6 +10,7 @@ internal static partial class Interop
     internal unsafe partial class Sys
     {
         [DllImport(Interop.Libraries.CoreLibNative, EntryPoint = "CoreLibNative_GetTickCount64")]
+        [SuppressGCTransition]
         internal static extern ulong GetTickCount64();
     }
 }
@@ -9,6 +9,7 @@ internal static partial class Interop
     internal static partial class Kernel32
     {
         [DllImport(Libraries.Kernel32)]
+        [SuppressGCTransition]
         internal static extern unsafe void GetSystemTimeAsFileTime(long* lpSystemTimeAsFileTime);
     }
 }
@@ -11,6 +11,7 @@ internal static partial class Interop
     internal static unsafe partial class mincore
     {
         [DllImport("api-ms-win-core-sysinfo-l1-1-0.dll")]
+        [SuppressGCTransition]
         internal extern static ulong GetTickCount64();
     }
 }
@@ -20,6 +20,9 @@ namespace ILCompiler
         protected DevirtualizationManager _devirtualizationManager = new DevirtualizationManager();
         protected bool _methodBodyFolding;
         protected bool _singleThreaded;
+        protected bool _compressDebugSections;
+        protected EETypeLayoutOrder _eetypeLayoutOrder;
+        protected MethodLayoutOrder _methodLayoutOrder;
         protected InstructionSetSupport _instructionSetSupport;
 
         partial void InitializePartial()
@@ -82,6 +85,24 @@ namespace ILCompiler
             return this;
         }
 
+        public CompilationBuilder UseCompressedDebugSections(bool enable)
+        {
+            _compressDebugSections = enable;
+            return this;
+        }
+
+        public CompilationBuilder UseEETypeLayoutOrder(EETypeLayoutOrder order)
+        {
+            _eetypeLayoutOrder = order;
+            return this;
+        }
+
+        public CompilationBuilder UseMethodLayoutOrder(MethodLayoutOrder order)
+        {
+            _methodLayoutOrder = order;
+            return this;
+        }
+
         public CompilationBuilder UsePreinitializationManager(PreinitializationManager manager)
         {
             _preinitializationManager = manager;
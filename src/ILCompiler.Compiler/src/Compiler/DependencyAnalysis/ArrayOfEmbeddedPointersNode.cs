@@ -11,13 +11,16 @@ namespace ILCompiler.DependencyAnalysis
 {
     /// <summary>
     /// Represents an array of pointers to symbols. <typeparamref name="TTarget"/> is the type
-    /// of node each pointer within the vector points to.
+    /// of node each pointer within the vector points to. When the array is created with relative
+    /// pointers and the target supports them, the elements are 32-bit offsets from the element to
+    /// its target. Those don't need a dynamic relocation when the image is loaded at a different address.
     /// </summary>
     public sealed class ArrayOfEmbeddedPointersNode<TTarget> : ArrayOfEmbeddedDataNode<EmbeddedPointerIndirectionNode<TTarget>>
         where TTarget : ISortableSymbolNode
     {
         private int _nextId;
         private string _startSymbolMangledName;
+        private bool _useRelativePointers;
 
         /// <summary>
         /// Provides a callback mechanism for notification when an EmbeddedPointerIndirectionNode is marked and added to the
@@ -25,13 +28,14 @@ namespace ILCompiler.DependencyAnalysis
         /// </summary>
         public delegate void OnMarkedDelegate(EmbeddedPointerIndirectionNode<TTarget> embeddedObject);
 
-        public ArrayOfEmbeddedPointersNode(string startSymbolMangledName, string endSymbolMangledName, IComparer<TTarget> nodeSorter)
+        public ArrayOfEmbeddedPointersNode(string startSymbolMangledName, string endSymbolMangledName, IComparer<TTarget> nodeSorter, bool useRelativePointers = false)
             : base(
                   startSymbolMangledName,
                   endSymbolMangledName,
                   nodeSorter != null ? new PointerIndirectionNodeComparer(nodeSorter) : null)
         {
             _startSymbolMangledName = startSymbolMangledName;
+            _useRelativePointers = useRelativePointers;
         }
 
         public EmbeddedObjectNode NewNode(TTarget target)
@@ -80,6 +84,19 @@ namespace ILCompiler.DependencyAnalysis
 
             protected override string GetName(NodeFactory factory) => $"Embedded pointer to {Target.GetMangledName(factory.NameMangler)}";
 
+            public override void EncodeData(ref ObjectDataBuilder dataBuilder, NodeFactory factory, bool relocsOnly)
+            {
+                if (_parentNode._useRelativePointers && factory.Target.SupportsRelativePointers)
+                {
+                    dataBuilder.RequireInitialAlignment(4);
+                    dataBuilder.EmitReloc(Target, RelocType.IMAGE_REL_BASED_RELPTR32);
+                }
+                else
+                {
+                    base.EncodeData(ref dataBuilder, factory, relocsOnly);
+                }
+            }
+
             protected override void OnMarked(NodeFactory factory)
             {
                 // We don't want the child in the parent collection unless it's necessary.
@@ -891,6 +891,7 @@ namespace ILCompiler.DependencyAnalysis
             ComputeRareFlags(factory, relocsOnly);
             ComputeNullableValueOffset();
             ComputeValueTypeFieldPadding();
+            ComputeInterfaceSignature();
         }
 
         void ComputeRareFlags(NodeFactory factory, bool relocsOnly)
@@ -963,6 +964,27 @@ namespace ILCompiler.DependencyAnalysis
             }
         }
 
+        /// <summary>
+        /// Types with many interfaces record a bloom filter of their interface map so that the runtime can reject
+        /// casts to other interfaces without scanning the map. Shared generic types are skipped since the type
+        /// loader builds types from them with different interfaces.
+        /// </summary>
+        void ComputeInterfaceSignature()
+        {
+            if (!EmitVirtualSlotsAndInterfaces || _type.IsCanonicalSubtype(CanonicalFormKind.Any))
+                return;
+
+            DefType[] interfaces = _type.RuntimeInterfaces;
+            if (interfaces.Length < InterfaceSignatureBits.MinimumInterfaceCount)
+                return;
+
+            uint signature = 0;
+            foreach (DefType interfaceType in interfaces)
+                signature |= InterfaceSignatureBits.Get(unchecked((uint)interfaceType.GetHashCode()));
+
+            _optionalFieldsBuilder.SetFieldValue(EETypeOptionalFieldTag.InterfaceSignature, signature);
+        }
+
         protected virtual void ComputeValueTypeFieldPadding()
         {
             // All objects that can have appreciable which can be derived from size compute ValueTypeFieldPadding. 
@@ -96,9 +96,24 @@ namespace ILCompiler.DependencyAnalysis
             return dependencies;
         }
 
+        private bool ContainsGCPointers
+        {
+            get
+            {
+                TypeDesc elementType = ((ArrayType)_preInitFieldInfo.Type).ElementType;
+                return elementType.IsGCPointer || (elementType is DefType defType && defType.ContainsGCPointers);
+            }
+        }
+
         protected override void OnMarked(NodeFactory factory)
         {
-            factory.FrozenSegmentRegion.AddEmbeddedObject(this);
+            // The program may store references to objects on the GC heap into arrays with reference
+            // elements, so the runtime has to report those. Keep them apart from the rest of the frozen
+            // objects so it only needs to walk these.
+            if (ContainsGCPointers)
+                factory.FrozenObjectsWithGCRefsRegion.AddEmbeddedObject(this);
+            else
+                factory.FrozenSegmentRegion.AddEmbeddedObject(this);
         }
 
         public override int ClassCode => 1789429316;
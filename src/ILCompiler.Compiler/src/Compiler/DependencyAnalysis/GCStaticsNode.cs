@@ -49,6 +49,23 @@ namespace ILCompiler.DependencyAnalysis
             return factory.GCStaticEEType(map);
         }
 
+        /// <summary>
+        /// Returns the preinitialized data of a static field of the type, or null if it doesn't have any.
+        /// </summary>
+        public PreInitFieldInfo GetPreInitFieldInfo(FieldDesc field)
+        {
+            if (_preInitFieldInfos != null)
+            {
+                foreach (PreInitFieldInfo fieldInfo in _preInitFieldInfos)
+                {
+                    if (fieldInfo.Field == field)
+                        return fieldInfo;
+                }
+            }
+
+            return null;
+        }
+
         public GCStaticsPreInitDataNode NewPreInitDataNode()
         {
             Debug.Assert(_preInitFieldInfos != null);
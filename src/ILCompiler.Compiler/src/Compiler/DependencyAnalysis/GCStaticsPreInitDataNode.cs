@@ -2,6 +2,7 @@
 // The .NET Foundation licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 
+using System;
 using System.Collections.Generic;
 
 using Internal.Text;
@@ -15,9 +16,12 @@ namespace ILCompiler.DependencyAnalysis
     /// Contains all GC static fields for a particular EEType.
     /// Fields that have preinitialized data are pointer reloc pointing to frozen objects.
     /// Other fields are initialized with 0.
-    /// We simply memcpy these over the GC static EEType object.
+    /// The data is laid out as a complete GC static base object (sync block, GC static EEType and fields) in
+    /// the writable preinitialized statics region. The runtime either memcpys the fields over a GC static
+    /// EEType object allocated on the GC heap, or uses the object in place when the region is registered
+    /// with the GC.
     /// </summary>
-    public class GCStaticsPreInitDataNode : ObjectNode, ISymbolDefinitionNode
+    public class GCStaticsPreInitDataNode : EmbeddedObjectNode, ISymbolDefinitionNode
     {
         private MetadataType _type;
         private List<PreInitFieldInfo> _sortedPreInitFields;
@@ -32,14 +36,24 @@ namespace ILCompiler.DependencyAnalysis
             _sortedPreInitFields.Sort(PreInitFieldInfo.FieldDescCompare);
         }
 
-        protected override string GetName(NodeFactory factory) => GetMangledName(_type, factory.NameMangler);
+        protected override string GetName(NodeFactory factory) => this.GetMangledName(factory.NameMangler);
 
         public void AppendMangledName(NameMangler nameMangler, Utf8StringBuilder sb)
         {
-            sb.Append(GetMangledName(_type, nameMangler));
+            sb.Append(nameMangler.CompilationUnitPrefix).Append(GetMangledName(_type, nameMangler));
+        }
+
+        int ISymbolNode.Offset => 0;
+
+        int ISymbolDefinitionNode.Offset
+        {
+            get
+            {
+                // The symbol points at the EEType portion of the object, skipping over the sync block
+                return OffsetFromBeginningOfArray + _type.Context.Target.PointerSize;
+            }
         }
 
-        public int Offset => 0;
         public MetadataType Type => _type;
 
         public static string GetMangledName(TypeDesc type, NameMangler nameMangler)
@@ -49,18 +63,60 @@ namespace ILCompiler.DependencyAnalysis
 
         public override bool StaticDependenciesAreComputed => true;
 
-        public override ObjectNodeSection Section => ObjectNodeSection.ReadOnlyDataSection;
-        public override bool IsShareable => EETypeNode.IsTypeNodeShareable(_type);
+        private ISymbolNode GetGCStaticEETypeNode(NodeFactory factory)
+        {
+            GCPointerMap map = GCPointerMap.FromStaticLayout(_type);
+            return factory.GCStaticEEType(map);
+        }
 
-        public override ObjectData GetData(NodeFactory factory, bool relocsOnly = false)
+        public override void EncodeData(ref ObjectDataBuilder dataBuilder, NodeFactory factory, bool relocsOnly)
         {
             // We only need this for CoreRT (at least for now) as we emit static field value directly in GCStaticsNode for N
             Debug.Assert(factory.Target.Abi == TargetAbi.CoreRT);
 
-            return GetDataForPreInitDataField(
-                this, _type, _sortedPreInitFields, 
-                factory.Target.PointerSize,     // CoreRT static size calculation includes EEType - skip it
-                factory, relocsOnly);
+            int pointerSize = factory.Target.PointerSize;
+            int start = dataBuilder.CountBytes;
+
+            // Sync Block
+            dataBuilder.EmitZeroPointer();
+
+            // EEType
+            dataBuilder.EmitPointerReloc(GetGCStaticEETypeNode(factory));
+
+            // Field data. CoreRT static size calculation includes EEType - skip it
+            int fieldStart = dataBuilder.CountBytes;
+            EmitPreInitFieldData(ref dataBuilder, _type, _sortedPreInitFields, pointerSize, factory, relocsOnly);
+            Debug.Assert(dataBuilder.CountBytes - fieldStart == _type.GCStaticFieldSize.AsInt - pointerSize);
+
+            // Pad the object to the base size of the GC static EEType so that the GC can walk over it
+            // (+1 for SyncBlock, minimum GC eetype size is 3 pointers).
+            int objectSize = AlignmentHelper.AlignUp(_type.GCStaticFieldSize.AsInt, pointerSize) + pointerSize;
+            objectSize = Math.Max(objectSize, pointerSize * 3);
+            dataBuilder.EmitZeros(objectSize - (dataBuilder.CountBytes - start));
+        }
+
+        public override IEnumerable<DependencyListEntry> GetStaticDependencies(NodeFactory factory)
+        {
+            ObjectDataBuilder builder = new ObjectDataBuilder(factory, true);
+            EncodeData(ref builder, factory, true);
+            Relocation[] relocs = builder.ToObjectData().Relocs;
+            DependencyList dependencies = null;
+
+            if (relocs != null)
+            {
+                dependencies = new DependencyList();
+                foreach (Relocation reloc in relocs)
+                {
+                    dependencies.Add(reloc.Target, "reloc");
+                }
+            }
+
+            return dependencies;
+        }
+
+        protected override void OnMarked(NodeFactory factory)
+        {
+            factory.PreInitializedStaticsRegion.AddEmbeddedObject(this);
         }
 
         public static ObjectData GetDataForPreInitDataField(
@@ -73,6 +129,19 @@ namespace ILCompiler.DependencyAnalysis
 
             builder.RequireInitialAlignment(_type.GCStaticFieldAlignment.AsInt);
 
+            EmitPreInitFieldData(ref builder, _type, sortedPreInitFields, startOffset, factory, relocsOnly);
+
+            builder.AddSymbol(node);
+
+            return builder.ToObjectData();
+        }
+
+        private static void EmitPreInitFieldData(
+            ref ObjectDataBuilder builder,
+            MetadataType _type, List<PreInitFieldInfo> sortedPreInitFields,
+            int startOffset,
+            NodeFactory factory, bool relocsOnly)
+        {
             int staticOffset = startOffset;
             int staticOffsetEnd = _type.GCStaticFieldSize.AsInt;
             int idx = 0;
@@ -107,10 +176,6 @@ namespace ILCompiler.DependencyAnalysis
                     idx++;
                 }
             }
-
-            builder.AddSymbol(node);
-
-            return builder.ToObjectData();
         }
 
         public override int ClassCode => 1148300665;
@@ -1057,13 +1057,24 @@ namespace ILCompiler.DependencyAnalysis
         public ArrayOfEmbeddedPointersNode<InterfaceDispatchMapNode> DispatchMapTable = new ArrayOfEmbeddedPointersNode<InterfaceDispatchMapNode>(
             "__DispatchMapTableStart",
             "__DispatchMapTableEnd",
-            new SortableDependencyNode.ObjectNodeComparer(new CompilerComparer()));
+            new SortableDependencyNode.ObjectNodeComparer(new CompilerComparer()),
+            useRelativePointers: true);
 
         public ArrayOfEmbeddedDataNode<EmbeddedObjectNode> FrozenSegmentRegion = new ArrayOfFrozenObjectsNode<EmbeddedObjectNode>(
             "__FrozenSegmentRegionStart",
             "__FrozenSegmentRegionEnd",
             new SortableDependencyNode.EmbeddedObjectNodeComparer(new CompilerComparer()));
 
+        public ArrayOfEmbeddedDataNode<EmbeddedObjectNode> FrozenObjectsWithGCRefsRegion = new ArrayOfFrozenObjectsNode<EmbeddedObjectNode>(
+            "__FrozenObjectsWithGCRefsRegionStart",
+            "__FrozenObjectsWithGCRefsRegionEnd",
+            new SortableDependencyNode.EmbeddedObjectNodeComparer(new CompilerComparer()));
+
+        public ArrayOfEmbeddedDataNode<GCStaticsPreInitDataNode> PreInitializedStaticsRegion = new ArrayOfFrozenObjectsNode<GCStaticsPreInitDataNode>(
+            "__PreInitializedStaticsRegionStart",
+            "__PreInitializedStaticsRegionEnd",
+            new SortableDependencyNode.EmbeddedObjectNodeComparer(new CompilerComparer()));
+
         public ArrayOfEmbeddedPointersNode<MrtProcessedImportAddressTableNode> ImportAddressTablesTable = new ArrayOfEmbeddedPointersNode<MrtProcessedImportAddressTableNode>(
             "__ImportTablesTableStart",
             "__ImportTablesTableEnd",
@@ -1090,6 +1101,8 @@ namespace ILCompiler.DependencyAnalysis
             graph.AddRoot(TypeManagerIndirection, "TypeManagerIndirection is always generated");
             graph.AddRoot(DispatchMapTable, "DispatchMapTable is always generated");
             graph.AddRoot(FrozenSegmentRegion, "FrozenSegmentRegion is always generated");
+            graph.AddRoot(FrozenObjectsWithGCRefsRegion, "FrozenObjectsWithGCRefsRegion is always generated");
+            graph.AddRoot(PreInitializedStaticsRegion, "PreInitializedStaticsRegion is always generated");
             graph.AddRoot(InterfaceDispatchCellSection, "Interface dispatch cell section is always generated");
 
             ReadyToRunHeader.Add(ReadyToRunSectionType.GCStaticRegion, GCStaticsRegion, GCStaticsRegion.StartSymbol, GCStaticsRegion.EndSymbol);
@@ -1098,6 +1111,8 @@ namespace ILCompiler.DependencyAnalysis
             ReadyToRunHeader.Add(ReadyToRunSectionType.TypeManagerIndirection, TypeManagerIndirection, TypeManagerIndirection);
             ReadyToRunHeader.Add(ReadyToRunSectionType.InterfaceDispatchTable, DispatchMapTable, DispatchMapTable.StartSymbol);
             ReadyToRunHeader.Add(ReadyToRunSectionType.FrozenObjectRegion, FrozenSegmentRegion, FrozenSegmentRegion.StartSymbol, FrozenSegmentRegion.EndSymbol);
+            ReadyToRunHeader.Add(ReadyToRunSectionType.FrozenObjectsWithGCRefsRegion, FrozenObjectsWithGCRefsRegion, FrozenObjectsWithGCRefsRegion.StartSymbol, FrozenObjectsWithGCRefsRegion.EndSymbol);
+            ReadyToRunHeader.Add(ReadyToRunSectionType.PreInitializedStaticsRegion, PreInitializedStaticsRegion, PreInitializedStaticsRegion.StartSymbol, PreInitializedStaticsRegion.EndSymbol);
 
             var commonFixupsTableNode = new ExternalReferencesTableNode("CommonFixupsTable", this);
             InteropStubManager.AddToReadyToRunHeader(ReadyToRunHeader, this, commonFixupsTableNode);
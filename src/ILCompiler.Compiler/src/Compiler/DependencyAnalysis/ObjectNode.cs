@@ -51,6 +51,15 @@ namespace ILCompiler.DependencyAnalysis
             return false;
         }
 
+        /// <summary>
+        /// Called by the object writer once the node is written to the object file. Nodes that keep large
+        /// data around until then (such as compiled code) can drop it so that the memory used while the
+        /// object file is written doesn't hold the whole image twice. GetData must not be called afterwards.
+        /// </summary>
+        public virtual void ReleaseEmittedData()
+        {
+        }
+
         public override bool HasConditionalStaticDependencies => false;
         public override bool HasDynamicDependencies => false;
         public override bool InterestingForDynamicDependencyAnalysis => false;
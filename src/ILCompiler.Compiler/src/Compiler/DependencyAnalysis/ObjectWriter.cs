@@ -240,6 +240,12 @@ namespace ILCompiler.DependencyAnalysis
             EmitCFICode(_nativeObjectWriter, nativeOffset, blob);
         }
 
+        [DllImport(NativeObjectWriterFileName)]
+        private static extern void EnableManagedUnwindTable(IntPtr objWriter);
+
+        [DllImport(NativeObjectWriterFileName)]
+        private static extern void EnableCompressedDebugSections(IntPtr objWriter);
+
         [DllImport(NativeObjectWriterFileName)]
         private static extern void EmitDebugFileInfo(IntPtr objWriter, int fileId, string fileName);
         public void EmitDebugFileInfo(int fileId, string fileName)
@@ -884,7 +890,7 @@ namespace ILCompiler.DependencyAnalysis
 
         private IntPtr _nativeObjectWriter = IntPtr.Zero;
 
-        public ObjectWriter(string objectFilePath, NodeFactory factory)
+        public ObjectWriter(string objectFilePath, NodeFactory factory, ObjectWritingOptions options = 0)
         {
             var triple = GetLLVMTripleFromTarget(factory.Target);
 
@@ -897,6 +903,19 @@ namespace ILCompiler.DependencyAnalysis
             _targetPlatform = _nodeFactory.Target;
             _isSingleFileCompilation = _nodeFactory.CompilationModuleGroup.IsSingleFileCompilation;
             _userDefinedTypeDescriptor = new UserDefinedTypeDescriptor(this, factory);
+
+            // Let the runtime find unwind rules of managed code without interpreting .eh_frame (ELF only)
+            if (_targetPlatform.Architecture == TargetArchitecture.X64 &&
+                !_targetPlatform.IsWindows && _targetPlatform.OperatingSystem != TargetOS.OSX)
+            {
+                EnableManagedUnwindTable(_nativeObjectWriter);
+            }
+
+            // zlib compressed DWARF sections (ELF only)
+            if ((options & ObjectWritingOptions.CompressDebugSections) != 0)
+            {
+                EnableCompressedDebugSections(_nativeObjectWriter);
+            }
         }
 
         public void Dispose()
@@ -970,9 +989,9 @@ namespace ILCompiler.DependencyAnalysis
             }
         }
 
-        public static void EmitObject(string objectFilePath, IEnumerable<DependencyNode> nodes, NodeFactory factory, IObjectDumper dumper)
+        public static void EmitObject(string objectFilePath, IEnumerable<DependencyNode> nodes, NodeFactory factory, IObjectDumper dumper, ObjectWritingOptions options = 0)
         {
-            ObjectWriter objectWriter = new ObjectWriter(objectFilePath, factory);
+            ObjectWriter objectWriter = new ObjectWriter(objectFilePath, factory, options);
             bool succeeded = false;
 
             try
@@ -1157,6 +1176,9 @@ namespace ILCompiler.DependencyAnalysis
                         objectWriter.EmitDebugEHClauseInfo(node);
                         objectWriter.EmitDebugFunctionInfo(node, nodeContents.Data.Length);
                     }
+
+                    // The native object writer has its own copy of everything written so far
+                    node.ReleaseEmittedData();
                 }
 
                 objectWriter.EmitDebugModuleInfo();
@@ -1269,4 +1291,10 @@ namespace ILCompiler.DependencyAnalysis
             return $"{arch}{sub}-{vendor}-{sys}-{abi}";
         }
     }
+
+    [Flags]
+    public enum ObjectWritingOptions
+    {
+        CompressDebugSections = 0x1,
+    }
 }
@@ -0,0 +1,61 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+using System.Collections.Generic;
+using System.IO;
+
+using ILCompiler.DependencyAnalysis;
+using ILCompiler.DependencyAnalysisFramework;
+
+namespace ILCompiler
+{
+    /// <summary>
+    /// Places the EETypes named by a profile at the start of their section, next to each other and in the order
+    /// of the profile. The vtable of an EEType follows it, so the types that casts and virtual dispatch touch the
+    /// most end up on as few cache lines and pages as possible. The profile lists one mangled EEType symbol name
+    /// per line, as found in the map file, hottest first. Lines that don't name an emitted EEType are ignored.
+    /// </summary>
+    public class EETypeLayoutOrder
+    {
+        private readonly Dictionary<string, int> _order = new Dictionary<string, int>();
+
+        public EETypeLayoutOrder(string profileFile)
+        {
+            foreach (string line in File.ReadAllLines(profileFile))
+            {
+                string name = line.Trim();
+                if (name.Length > 0 && !_order.ContainsKey(name))
+                    _order.Add(name, _order.Count);
+            }
+        }
+
+        public IEnumerable<DependencyNode> Apply(IEnumerable<DependencyNode> nodes, NodeFactory factory)
+        {
+            var hotTypes = new List<KeyValuePair<int, DependencyNode>>();
+            var otherNodes = new List<DependencyNode>();
+
+            foreach (DependencyNode node in nodes)
+            {
+                int index;
+                if (node is EETypeNode eetypeNode &&
+                    _order.TryGetValue(eetypeNode.GetMangledName(factory.NameMangler), out index))
+                {
+                    hotTypes.Add(new KeyValuePair<int, DependencyNode>(index, node));
+                }
+                else
+                {
+                    otherNodes.Add(node);
+                }
+            }
+
+            hotTypes.Sort((x, y) => x.Key.CompareTo(y.Key));
+
+            var result = new List<DependencyNode>(hotTypes.Count + otherNodes.Count);
+            foreach (var hotType in hotTypes)
+                result.Add(hotType.Value);
+            result.AddRange(otherNodes);
+            return result;
+        }
+    }
+}
@@ -98,6 +98,8 @@ namespace ILCompiler
             public const int Bmi1 = 0x0400;
             public const int Bmi2 = 0x0800;
             public const int Lzcnt = 0x1000;
+            // Detected by the runtime for its own use (GC mark list sorting); not exposed as an intrinsic.
+            public const int Avx512f = 0x2000;
 
             public static int FromHardwareIntrinsicId(string id)
             {
@@ -0,0 +1,79 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+using System.Collections.Generic;
+using System.IO;
+
+using ILCompiler.DependencyAnalysis;
+using ILCompiler.DependencyAnalysisFramework;
+
+namespace ILCompiler
+{
+    /// <summary>
+    /// Places the method bodies named by a profile at the start of the managed code section, next to each other
+    /// and in the order of the profile, so the code that startup executes is paged in together instead of being
+    /// scattered over the whole section. The unwind, GC and EH info of a method is written when its body is, so
+    /// it ends up at the start of its section in the same order, and so does the associated data of the hot
+    /// methods. The profile lists one mangled method symbol name per line, as found in the map file, hottest
+    /// first. Lines that don't name an emitted method body are ignored.
+    /// </summary>
+    public class MethodLayoutOrder
+    {
+        private readonly Dictionary<string, int> _order = new Dictionary<string, int>();
+
+        public MethodLayoutOrder(string profileFile)
+        {
+            foreach (string line in File.ReadAllLines(profileFile))
+            {
+                string name = line.Trim();
+                if (name.Length > 0 && !_order.ContainsKey(name))
+                    _order.Add(name, _order.Count);
+            }
+        }
+
+        public IEnumerable<DependencyNode> Apply(IEnumerable<DependencyNode> nodes, NodeFactory factory)
+        {
+            var hotMethods = new List<KeyValuePair<int, DependencyNode>>();
+            var otherNodes = new List<DependencyNode>();
+
+            foreach (DependencyNode node in nodes)
+            {
+                int index;
+                if (node is IMethodBodyNode methodNode &&
+                    _order.TryGetValue(methodNode.GetMangledName(factory.NameMangler), out index))
+                {
+                    hotMethods.Add(new KeyValuePair<int, DependencyNode>(index, node));
+                }
+                else
+                {
+                    otherNodes.Add(node);
+                }
+            }
+
+            hotMethods.Sort((x, y) => x.Key.CompareTo(y.Key));
+
+            // The associated data nodes of the hot methods follow them, in the same order
+            var hotData = new HashSet<DependencyNode>();
+            var result = new List<DependencyNode>(hotMethods.Count + otherNodes.Count);
+            foreach (var hotMethod in hotMethods)
+                result.Add(hotMethod.Value);
+            foreach (var hotMethod in hotMethods)
+            {
+                if (hotMethod.Value is INodeWithCodeInfo codeInfo &&
+                    codeInfo.GetAssociatedDataNode(factory) is DependencyNode dataNode &&
+                    dataNode.Marked && hotData.Add(dataNode))
+                {
+                    result.Add(dataNode);
+                }
+            }
+
+            foreach (DependencyNode node in otherNodes)
+            {
+                if (!hotData.Contains(node))
+                    result.Add(node);
+            }
+            return result;
+        }
+    }
+}
@@ -91,6 +91,53 @@ namespace ILCompiler
         }
     }
 
+    public class PreInitStringFixupInfo : PreInitFixupInfo
+    {
+        public string StringFixup { get; }
+
+        public PreInitStringFixupInfo(int offset, string value)
+            : base(offset)
+        {
+            StringFixup = value;
+        }
+
+        public override void WriteData(ref ObjectDataBuilder builder, NodeFactory factory)
+        {
+            builder.EmitPointerReloc(factory.SerializedStringObject(StringFixup));
+        }
+    }
+
+    /// <summary>
+    /// Reference to the frozen object of another preinitialized static field. This is how arrays of
+    /// objects point to each other to form a preinitialized object graph.
+    /// </summary>
+    public class PreInitFrozenObjectFixupInfo : PreInitFixupInfo
+    {
+        public FieldDesc FieldFixup { get; }
+
+        public PreInitFrozenObjectFixupInfo(int offset, FieldDesc field)
+            : base(offset)
+        {
+            FieldFixup = field;
+        }
+
+        public override void WriteData(ref ObjectDataBuilder builder, NodeFactory factory)
+        {
+            MetadataType type = (MetadataType)FieldFixup.OwningType;
+
+            // Do not support fixing up fields from external modules
+            if (!factory.CompilationModuleGroup.ContainsType(type))
+                throw new BadImageFormatException();
+
+            // Go through the GC static base of the type so there is a single frozen object per field
+            PreInitFieldInfo fieldInfo = (factory.TypeGCStaticsSymbol(type) as GCStaticsNode)?.GetPreInitFieldInfo(FieldFixup);
+            if (fieldInfo == null)
+                throw new BadImageFormatException();
+
+            builder.EmitPointerReloc(factory.SerializedFrozenArray(fieldInfo));
+        }
+    }
+
     public class PreInitFieldInfo
     {
         public FieldDesc Field { get; }
@@ -339,6 +386,50 @@ namespace ILCompiler
 
                 fixups.Add(new PreInitFieldFixupInfo(offset, fixupField));
             }
+
+            var stringFixupAttrs = ecmaDataField.GetDecodedCustomAttributes("System.Runtime.CompilerServices", "StringFixupAttribute");
+            foreach (var stringFixupAttr in stringFixupAttrs)
+            {
+                if (stringFixupAttr.FixedArguments[0].Type != field.Context.GetWellKnownType(WellKnownType.Int32))
+                    throw new BadImageFormatException();
+
+                int offset = (int)stringFixupAttr.FixedArguments[0].Value;
+                string value = stringFixupAttr.FixedArguments[1].Value as string;
+                if (value == null)
+                    throw new BadImageFormatException();
+
+                fixups = fixups ?? new List<PreInitFixupInfo>();
+
+                fixups.Add(new PreInitStringFixupInfo(offset, value));
+            }
+
+            var frozenObjectFixupAttrs = ecmaDataField.GetDecodedCustomAttributes("System.Runtime.CompilerServices", "FrozenObjectFixupAttribute");
+            foreach (var frozenObjectFixupAttr in frozenObjectFixupAttrs)
+            {
+                if (frozenObjectFixupAttr.FixedArguments[0].Type != field.Context.GetWellKnownType(WellKnownType.Int32))
+                    throw new BadImageFormatException();
+
+                int offset = (int)frozenObjectFixupAttr.FixedArguments[0].Value;
+                TypeDesc fixupType = frozenObjectFixupAttr.FixedArguments[1].Value as TypeDesc;
+                if (fixupType == null)
+                    throw new BadImageFormatException();
+
+                string fieldName = frozenObjectFixupAttr.FixedArguments[2].Value as string;
+                if (fieldName == null)
+                    throw new BadImageFormatException();
+
+                var fixupField = fixupType.GetField(fieldName);
+                if (fixupField == null)
+                    throw new BadImageFormatException();
+
+                // The target has to be a preinitialized frozen array itself
+                if (!fixupField.IsStatic || !fixupField.HasGCStaticBase || !fixupField.FieldType.IsSzArray)
+                    throw new BadImageFormatException();
+
+                fixups = fixups ?? new List<PreInitFixupInfo>();
+
+                fixups.Add(new PreInitFrozenObjectFixupInfo(offset, fixupField));
+            }
             
             if (fieldType.IsValueType || fieldType.IsPointer)
             {
@@ -2,16 +2,50 @@
 // The .NET Foundation licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 
+using System;
 using System.Collections.Generic;
+using System.Globalization;
 
 namespace ILCompiler
 {
     /// <summary>
     /// A root provider that provides a runtime configuration blob that influences runtime behaviors.
-    /// See RhConfigValues.h for allowed values.
+    /// See RhConfigValues.h for allowed values. Options that don't start with RH_ are handed to the GC
+    /// as the value of the GC configuration with that name (see gcconfig.h).
     /// </summary>
+    /// <remarks>
+    /// The options are parsed at compile time so that the runtime doesn't have to. The blob is an array
+    /// of fixed size records sorted by the hash of the option name:
+    ///     UInt32 Count
+    ///     UInt32 Reserved
+    ///     { UInt32 KeyHash; UInt32 Type; UInt64 Value; } [Count]
+    /// The layout needs to be kept in sync with CompilerEmbeddedSettingsBlob in RhConfig.cpp.
+    /// </remarks>
     public class RuntimeConfigurationRootProvider : ICompilationRootProvider
     {
+        private const string RuntimeOptionPrefix = "RH_";
+
+        // Needs to match EmbeddedSettingType in RhConfig.h
+        private enum SettingType
+        {
+            Integer = 0,
+            Boolean = 1,
+        }
+
+        private struct Setting
+        {
+            public readonly string Name;
+            public readonly SettingType Type;
+            public readonly ulong Value;
+
+            public Setting(string name, SettingType type, ulong value)
+            {
+                Name = name;
+                Type = type;
+                Value = value;
+            }
+        }
+
         private readonly IEnumerable<string> _runtimeOptions;
 
         public RuntimeConfigurationRootProvider(IEnumerable<string> runtimeOptions)
@@ -21,38 +55,99 @@ namespace ILCompiler
 
         void ICompilationRootProvider.AddCompilationRoots(IRootingServiceProvider rootProvider)
         {
-            rootProvider.RootReadOnlyDataBlob(GetRuntimeOptionsBlob(), 4, "Runtime configuration information", "g_compilerEmbeddedSettingsBlob");
+            rootProvider.RootReadOnlyDataBlob(GetRuntimeOptionsBlob(), 8, "Runtime configuration information", "g_compilerEmbeddedSettingsBlob");
         }
 
         protected byte[] GetRuntimeOptionsBlob()
         {
-            const int HeaderSize = 4;
-
-            ArrayBuilder<byte> options = new ArrayBuilder<byte>();
-
-            // Reserve space for the header
-            options.ZeroExtend(HeaderSize);
+            var settings = new SortedDictionary<uint, Setting>();
 
             foreach (string option in _runtimeOptions)
             {
-                byte[] optionBytes = System.Text.Encoding.ASCII.GetBytes(option);
-                options.Append(optionBytes);
+                int separator = option.IndexOf('=');
+                if (separator <= 0)
+                    throw new ArgumentException($"Runtime option '{option}' is not in the <name>=<value> format");
+
+                string name = option.Substring(0, separator).Trim();
+                string valueString = option.Substring(separator + 1).Trim();
+
+                SettingType type;
+                ulong value;
+                if (string.Equals(valueString, "true", StringComparison.OrdinalIgnoreCase))
+                {
+                    type = SettingType.Boolean;
+                    value = 1;
+                }
+                else if (string.Equals(valueString, "false", StringComparison.OrdinalIgnoreCase))
+                {
+                    type = SettingType.Boolean;
+                    value = 0;
+                }
+                else
+                {
+                    // Like the environment variables, the values are hexadecimal
+                    if (valueString.StartsWith("0x", StringComparison.OrdinalIgnoreCase))
+                        valueString = valueString.Substring(2);
+
+                    if (!ulong.TryParse(valueString, NumberStyles.AllowHexSpecifier, CultureInfo.InvariantCulture, out value))
+                        throw new ArgumentException($"Value of runtime option '{option}' is not a hexadecimal number");
 
-                // Emit a null to separate the next option
-                options.Add(0);
+                    type = SettingType.Integer;
+                }
+
+                if (name.StartsWith(RuntimeOptionPrefix, StringComparison.OrdinalIgnoreCase) && value > uint.MaxValue)
+                    throw new ArgumentException($"Value of runtime option '{option}' doesn't fit in 32 bits");
+
+                uint hash = HashOptionName(name);
+                if (settings.TryGetValue(hash, out Setting existing) && !string.Equals(existing.Name, name, StringComparison.OrdinalIgnoreCase))
+                    throw new ArgumentException($"Runtime options '{existing.Name}' and '{name}' can't be used together");
+
+                // Later options override the earlier ones
+                settings[hash] = new Setting(name, type, value);
             }
 
-            byte[] result = options.ToArray();
+            const int HeaderSize = 8;
+            const int SettingSize = 16;
 
-            int length = options.Count - HeaderSize;
+            byte[] result = new byte[HeaderSize + settings.Count * SettingSize];
 
-            // Encode the size of the blob into the header
-            result[0] = (byte)length;
-            result[1] = (byte)(length >> 8);
-            result[2] = (byte)(length >> 0x10);
-            result[3] = (byte)(length >> 0x18);
+            WriteUInt32(result, 0, (uint)settings.Count);
+
+            int offset = HeaderSize;
+            foreach (var setting in settings)
+            {
+                WriteUInt32(result, offset, setting.Key);
+                WriteUInt32(result, offset + 4, (uint)setting.Value.Type);
+                WriteUInt32(result, offset + 8, (uint)setting.Value.Value);
+                WriteUInt32(result, offset + 12, (uint)(setting.Value.Value >> 32));
+                offset += SettingSize;
+            }
 
             return result;
         }
+
+        /// <summary>
+        /// Case insensitive FNV-1a hash of the option name. Needs to match RhConfig::HashConfigName.
+        /// </summary>
+        private static uint HashOptionName(string name)
+        {
+            uint hash = 2166136261;
+            foreach (char c in name)
+            {
+                char ch = c;
+                if (ch >= 'a' && ch <= 'z')
+                    ch = (char)(ch - 'a' + 'A');
+                hash = unchecked((hash ^ ch) * 16777619);
+            }
+            return hash;
+        }
+
+        private static void WriteUInt32(byte[] buffer, int offset, uint value)
+        {
+            buffer[offset] = (byte)value;
+            buffer[offset + 1] = (byte)(value >> 8);
+            buffer[offset + 2] = (byte)(value >> 0x10);
+            buffer[offset + 3] = (byte)(value >> 0x18);
+        }
     }
 }
@@ -52,6 +52,13 @@ namespace Internal.IL
         {
             public ILExceptionRegion ILRegion;
             public int ReturnLabels;
+
+            // Code the end of a finally continues with for each return label, see ImportLeave
+            public List<string> ReturnContinuations = new List<string>();
+
+            // Spill slots the exception object is passed to the filter and handler in
+            public string FilterExceptionSlot;
+            public string HandlerExceptionSlot;
         };
         private ExceptionRegion[] _exceptionRegions;
 
@@ -851,7 +858,19 @@ namespace Internal.IL
             for (int i = 0; i < _exceptionRegions.Length; i++)
             {
                 var r = _exceptionRegions[i];
-                if (r.ReturnLabels != 0)
+                if (!IsTryImported(r))
+                    continue;
+
+                if (GetTryGroup(i) == i)
+                {
+                    AppendLine();
+                    Append("void * __exception");
+                    Append(i.ToStringInvariant());
+                    Append(" = 0");
+                    AppendSemicolon();
+                }
+
+                if (IsFinallyOrFault(r))
                 {
                     AppendLine();
                     Append("int __finallyReturn");
@@ -864,16 +883,24 @@ namespace Internal.IL
             // Temporary the indentation while printing blocks.
             // We want block to start on the first character of the line
             Exdent();
-            for (int i = 0; i < _basicBlocks.Length; i++)
+            for (int i = 0; i <= _basicBlocks.Length; i++)
             {
-                BasicBlock basicBlock = _basicBlocks[i];
+                AppendExceptionRegionEnds(i);
+
+                BasicBlock basicBlock = i < _basicBlocks.Length ? _basicBlocks[i] : null;
                 if (basicBlock != null)
                 {
                     AppendEmptyLine();
                     AppendLine();
                     Append("_bb");
                     Append(i.ToStringInvariant());
-                    Append(": {");
+                    Append(":");
+
+                    // The label stays in front of the try so that branches to the start of the region don't
+                    // jump into it
+                    AppendTryStarts(i);
+
+                    Append(" {");
                     ForceAppendEmptyLine();
                     Append(basicBlock.Code);
                     AppendLine();
@@ -881,33 +908,6 @@ namespace Internal.IL
                 }
             }
 
-            for (int i = 0; i < _exceptionRegions.Length; i++)
-            {
-                var r = _exceptionRegions[i];
-                if (r.ReturnLabels != 0)
-                {
-                    AppendEmptyLine();
-                    AppendLine();
-                    Append("__endFinally" + i.ToStringInvariant() + ":");
-                    Indent();
-                    AppendLine();
-                    Append("switch(__finallyReturn" + i.ToStringInvariant() + ") {");
-                    Indent();
-                    for (int j = 1; j <= r.ReturnLabels; j++)
-                    {
-                        AppendLine();
-                        Append("case " + j.ToStringInvariant() + ": goto __returnFromFinally" + i.ToStringInvariant() +
-                                            "_" + j.ToStringInvariant() + ";");
-                    }
-                    AppendLine();
-                    Append("default: CORERT_UNREACHABLE;");
-                    Exdent();
-                    AppendLine();
-                    Append("}");
-                    Exdent();
-                }
-            }
-
             AppendEmptyLine();
             Append("}");
 
@@ -918,6 +918,9 @@ namespace Internal.IL
         {
             _stack.Clear();
 
+            if (basicBlock.TryStart)
+                MarkExceptionHandlers(basicBlock);
+
             EvaluationStack<StackEntry> entryStack = basicBlock.EntryStack;
             if (entryStack != null)
             {
@@ -1018,7 +1021,7 @@ namespace Internal.IL
 
             AddTypeReference(canonType, false);
 
-            Append(opcode == ILOpcode.isinst ? "__isinst" : "__castclass");
+            Append(opcode == ILOpcode.isinst ? "__isinst_fast" : "__castclass_fast");
             Append("(");
             if (runtimeDeterminedType.IsRuntimeDeterminedSubtype)
             {
@@ -1622,7 +1625,7 @@ namespace Internal.IL
                     // We do not reset needNewLine since we still need for the next statement.
                     if (needNewLine)
                         AppendLine();
-                    Append("__allocate_object(");
+                    Append("__allocate_object_fast(");
 
                     if (runtimeDeterminedRetType.IsRuntimeDeterminedSubtype)
                     {
@@ -3040,7 +3043,7 @@ namespace Internal.IL
             Append(GetStackValueKindCPPTypeName(StackValueKind.ObjRef, type));
             Append(" ");
             Append(tempName);
-            Append(" = __allocate_object(");
+            Append(" = __allocate_object_fast(");
 
             if (runtimeDeterminedType.IsRuntimeDeterminedSubtype)
             {
@@ -3073,26 +3076,278 @@ namespace Internal.IL
             return start <= offset && offset < start + length;
         }
 
-        private static string AddReturnLabel(ExceptionRegion r)
+        private static bool IsFinallyOrFault(ExceptionRegion r)
         {
-            r.ReturnLabels++;
-            return r.ReturnLabels.ToStringInvariant();
+            return r.ILRegion.Kind == ILExceptionRegionKind.Finally || r.ILRegion.Kind == ILExceptionRegionKind.Fault;
         }
 
-        private void ImportLeave(BasicBlock target)
+        //
+        // Exception handling
+        //
+        // Every try region is covered by a C++ try whose catch clause takes the managed exception out of the
+        // ManagedExceptionWrapper thrown by RhpThrowEx and jumps to the dispatch code emitted after the try. The
+        // dispatch code runs the clauses of the region in order, like the second pass of the runtime's EH would.
+        // Handlers stay where they are in the IL, outside the C++ try, so that they are reached with goto and the
+        // C++ exception is done with before they run. Filters run after the finally blocks of the inner regions,
+        // since C++ unwinds in a single pass. Regions with the same try range share the C++ try.
+        //
+
+        private int GetTryGroup(int regionIndex)
         {
-            // Empty the stack
-            _stack.Clear();
+            var r = _exceptionRegions[regionIndex].ILRegion;
+            for (int i = 0; i < regionIndex; i++)
+            {
+                var other = _exceptionRegions[i].ILRegion;
+                if (other.TryOffset == r.TryOffset && other.TryLength == r.TryLength)
+                    return i;
+            }
+            return regionIndex;
+        }
 
-            // Close the scope and open a new one so that we don't put a goto label in the middle
-            // of a scope.
+        private bool IsTryImported(ExceptionRegion r)
+        {
+            return _basicBlocks[r.ILRegion.TryOffset].State != BasicBlock.ImportState.Unmarked;
+        }
+
+        private string GetDispatchLabel(int regionIndex, int tryGroup)
+        {
+            // The clauses of a try group are consecutive in the EH table
+            if (regionIndex < _exceptionRegions.Length && GetTryGroup(regionIndex) == tryGroup)
+                return "__dispatch" + regionIndex.ToStringInvariant();
+            return "__rethrow" + tryGroup.ToStringInvariant();
+        }
+
+        private int FindNearestFilter(int offset)
+        {
+            for (int i = 0; i < _exceptionRegions.Length; i++)
+            {
+                var r = _exceptionRegions[i].ILRegion;
+                if (r.Kind == ILExceptionRegionKind.Filter && r.FilterOffset <= offset && offset < r.HandlerOffset)
+                    return i;
+            }
+            throw new InvalidProgramException();
+        }
+
+        private StackEntry NewExceptionSlot(BasicBlock block, TypeDesc type)
+        {
+            StackEntry slot = NewSpillSlot(new ExpressionEntry(StackValueKind.ObjRef, null, type));
+
+            block.EntryStack = new EvaluationStack<StackEntry>(1);
+            block.EntryStack.Push(slot);
+            MarkBasicBlock(block);
+
+            return slot;
+        }
+
+        private void MarkExceptionHandlers(BasicBlock tryStart)
+        {
+            for (int i = 0; i < _exceptionRegions.Length; i++)
+            {
+                var r = _exceptionRegions[i];
+                if (r.ILRegion.TryOffset != tryStart.StartOffset)
+                    continue;
+
+                BasicBlock handler = _basicBlocks[r.ILRegion.HandlerOffset];
+                switch (r.ILRegion.Kind)
+                {
+                    case ILExceptionRegionKind.Catch:
+                        TypeDesc catchType = _writer.ConvertToCanonFormIfNecessary((TypeDesc)_canonMethodIL.GetObject(r.ILRegion.ClassToken),
+                            CanonicalFormKind.Specific);
+                        AddTypeReference(catchType, false);
+                        r.HandlerExceptionSlot = ((ExpressionEntry)NewExceptionSlot(handler, catchType)).Name;
+                        break;
+
+                    case ILExceptionRegionKind.Filter:
+                        TypeDesc objectType = GetWellKnownType(WellKnownType.Object);
+                        r.FilterExceptionSlot = ((ExpressionEntry)NewExceptionSlot(_basicBlocks[r.ILRegion.FilterOffset], objectType)).Name;
+                        r.HandlerExceptionSlot = ((ExpressionEntry)NewExceptionSlot(handler, objectType)).Name;
+                        break;
+
+                    default:
+                        MarkBasicBlock(handler);
+                        break;
+                }
+            }
+        }
+
+        private void AppendTryStarts(int offset)
+        {
+            for (int i = 0; i < _exceptionRegions.Length; i++)
+            {
+                var r = _exceptionRegions[i];
+                if (r.ILRegion.TryOffset == offset && GetTryGroup(i) == i && IsTryImported(r))
+                    Append(" try {");
+            }
+        }
+
+        private void AppendExceptionRegionEnds(int offset)
+        {
+            // Ends of finally handlers and of try groups, keyed by where the handler or try starts
+            List<(int Start, int RegionIndex, bool IsTry)> ends = new List<(int, int, bool)>();
+            for (int i = 0; i < _exceptionRegions.Length; i++)
+            {
+                var r = _exceptionRegions[i].ILRegion;
+                if (!IsTryImported(_exceptionRegions[i]))
+                    continue;
+
+                if (IsFinallyOrFault(_exceptionRegions[i]) && r.HandlerOffset + r.HandlerLength == offset)
+                    ends.Add((r.HandlerOffset, i, false));
+
+                if (r.TryOffset + r.TryLength == offset && GetTryGroup(i) == i)
+                    ends.Add((r.TryOffset, i, true));
+            }
+
+            // Innermost first, the end of a finally handler is inside the try that contains the handler
+            ends.Sort((x, y) => y.Start.CompareTo(x.Start));
+            foreach (var end in ends)
+            {
+                if (end.IsTry)
+                    AppendExceptionDispatch(end.RegionIndex);
+                else
+                    AppendEndFinally(end.RegionIndex);
+            }
+        }
+
+        private void AppendEndFinally(int regionIndex)
+        {
+            var r = _exceptionRegions[regionIndex];
+            string index = regionIndex.ToStringInvariant();
+
+            AppendEmptyLine();
+            AppendLine();
+            Append("__endFinally" + index + ":");
+            Indent();
+            AppendLine();
+            Append("switch(__finallyReturn" + index + ") {");
+            Indent();
+            AppendLine();
+            Append("case 0: __throw_exception(__exception" + GetTryGroup(regionIndex).ToStringInvariant() + ");");
+            for (int j = 1; j <= r.ReturnLabels; j++)
+            {
+                AppendLine();
+                Append("case " + j.ToStringInvariant() + ": " + r.ReturnContinuations[j - 1]);
+            }
+            AppendLine();
+            Append("default: CORERT_UNREACHABLE;");
             Exdent();
             AppendLine();
             Append("}");
+            Exdent();
+        }
+
+        private void AppendExceptionDispatch(int tryGroup)
+        {
+            string exception = "__exception" + tryGroup.ToStringInvariant();
+
             AppendLine();
-            Append("{");
+            Append("} catch (ManagedExceptionWrapper & __e) { ");
+            Append(exception);
+            Append(" = __e.m_pManagedException; goto ");
+            Append(GetDispatchLabel(tryGroup, tryGroup));
+            Append("; }");
+
+            for (int i = tryGroup; i < _exceptionRegions.Length && GetTryGroup(i) == tryGroup; i++)
+            {
+                var r = _exceptionRegions[i];
+
+                AppendEmptyLine();
+                AppendLine();
+                Append(GetDispatchLabel(i, tryGroup));
+                Append(":");
+                Indent();
+                AppendLine();
+
+                switch (r.ILRegion.Kind)
+                {
+                    case ILExceptionRegionKind.Catch:
+                        TypeDesc runtimeDeterminedType = (TypeDesc)_methodIL.GetObject(r.ILRegion.ClassToken);
+                        TypeDesc catchType = _writer.ConvertToCanonFormIfNecessary((TypeDesc)_canonMethodIL.GetObject(r.ILRegion.ClassToken),
+                            CanonicalFormKind.Specific);
+
+                        if (!catchType.IsObject)
+                        {
+                            Append("if (__isinst_fast(");
+                            if (runtimeDeterminedType.IsRuntimeDeterminedSubtype)
+                            {
+                                Append("(MethodTable *)");
+                                Append(GetGenericLookupHelperAndAddReference(ReadyToRunHelperId.TypeHandle, runtimeDeterminedType));
+                                Append("(");
+                                Append(GetGenericContext());
+                                Append(")");
+                            }
+                            else
+                            {
+                                Append(_writer.GetCppTypeName(runtimeDeterminedType));
+                                Append("::__getMethodTable()");
+                            }
+                            Append(", ");
+                            Append(exception);
+                            Append(") != 0) ");
+                        }
+                        Append("{ ");
+                        Append(r.HandlerExceptionSlot);
+                        Append(" = (");
+                        Append(GetStackValueKindCPPTypeName(StackValueKind.ObjRef, catchType));
+                        Append(")");
+                        Append(exception);
+                        Append("; goto _bb");
+                        Append(r.ILRegion.HandlerOffset.ToStringInvariant());
+                        Append("; }");
+                        break;
+
+                    case ILExceptionRegionKind.Filter:
+                        Append(r.FilterExceptionSlot);
+                        Append(" = (");
+                        Append(GetStackValueKindCPPTypeName(StackValueKind.ObjRef, GetWellKnownType(WellKnownType.Object)));
+                        Append(")");
+                        Append(exception);
+                        Append("; goto _bb");
+                        Append(r.ILRegion.FilterOffset.ToStringInvariant());
+                        Append(";");
+                        break;
+
+                    default:
+                        // The end of the finally or fault rethrows the exception
+                        Append("__finallyReturn");
+                        Append(i.ToStringInvariant());
+                        Append(" = 0; goto _bb");
+                        Append(r.ILRegion.HandlerOffset.ToStringInvariant());
+                        Append(";");
+                        break;
+                }
+                Exdent();
+            }
+
+            AppendEmptyLine();
+            AppendLine();
+            Append("__rethrow");
+            Append(tryGroup.ToStringInvariant());
+            Append(":");
             Indent();
+            AppendLine();
+            Append("__throw_exception(");
+            Append(exception);
+            Append(")");
+            AppendSemicolon();
+            Exdent();
+        }
+
+        private static string AddReturnLabel(ExceptionRegion r, string continuation)
+        {
+            r.ReturnLabels++;
+            r.ReturnContinuations.Add(continuation);
+            return r.ReturnLabels.ToStringInvariant();
+        }
 
+        private void ImportLeave(BasicBlock target)
+        {
+            // Empty the stack
+            _stack.Clear();
+
+            // The finally blocks the leave exits run innermost first. The end of each finally continues with
+            // the next one and the last one continues at the target, so no label is needed here, where it
+            // could end up inside the C++ try that covers the region.
+            List<int> finallyRegions = new List<int>();
             for (int i = 0; i < _exceptionRegions.Length; i++)
             {
                 var r = _exceptionRegions[i];
@@ -3101,36 +3356,25 @@ namespace Internal.IL
                     IsOffsetContained(_currentOffset - 1, r.ILRegion.TryOffset, r.ILRegion.TryLength) &&
                     !IsOffsetContained(target.StartOffset, r.ILRegion.TryOffset, r.ILRegion.TryLength))
                 {
-                    string returnLabel = AddReturnLabel(r);
-
-                    AppendLine();
-                    Append("__finallyReturn");
-                    Append(i.ToStringInvariant());
-                    Append(" = ");
-                    Append(returnLabel);
-                    AppendSemicolon();
+                    finallyRegions.Add(i);
+                }
+            }
 
-                    AppendLine();
-                    Append("goto _bb");
-                    Append(r.ILRegion.HandlerOffset.ToStringInvariant());
-                    AppendSemicolon();
+            string continuation = "goto _bb" + target.StartOffset.ToStringInvariant() + ";";
+            for (int j = finallyRegions.Count - 1; j >= 0; j--)
+            {
+                int i = finallyRegions[j];
+                var r = _exceptionRegions[i];
 
-                    AppendEmptyLine();
-                    Append("__returnFromFinally");
-                    Append(i.ToStringInvariant());
-                    Append("_");
-                    Append(returnLabel);
-                    Append(":");
-                    AppendSemicolon();
+                string returnLabel = AddReturnLabel(r, continuation);
+                continuation = "__finallyReturn" + i.ToStringInvariant() + " = " + returnLabel + "; goto _bb" +
+                    r.ILRegion.HandlerOffset.ToStringInvariant() + ";";
 
-                    MarkBasicBlock(_basicBlocks[r.ILRegion.HandlerOffset]);
-                }
+                MarkBasicBlock(_basicBlocks[r.ILRegion.HandlerOffset]);
             }
 
             AppendLine();
-            Append("goto _bb");
-            Append(target.StartOffset.ToStringInvariant());
-            AppendSemicolon();
+            Append(continuation);
 
             MarkBasicBlock(target);
         }
@@ -3142,7 +3386,7 @@ namespace Internal.IL
             {
                 var r = _exceptionRegions[i];
 
-                if (r.ILRegion.Kind == ILExceptionRegionKind.Finally &&
+                if (IsFinallyOrFault(r) &&
                     IsOffsetContained(offset, r.ILRegion.HandlerOffset, r.ILRegion.HandlerLength))
                 {
                     if (candidate == -1 ||
@@ -3178,7 +3422,7 @@ namespace Internal.IL
 
             PushTemp(StackValueKind.ObjRef, arrayType);
 
-            Append("__allocate_array(");
+            Append("__allocate_array_fast(");
             Append(numElements);
             Append(", ");
 
@@ -3257,6 +3501,21 @@ namespace Internal.IL
             var index = _stack.Pop();
             var arrayPtr = _stack.Pop();
 
+            if (elementType.IsGCPointer)
+            {
+                // The helper does the range check, the covariance check and the write barrier
+                AppendLine();
+                Append("__stelem_ref_fast(");
+                Append(arrayPtr);
+                Append(", ");
+                Append(index);
+                Append(", ");
+                Append(value);
+                Append(")");
+                AppendSemicolon();
+                return;
+            }
+
             // Range check
             AppendLine();
             Append("__range_check(");
@@ -3265,7 +3524,6 @@ namespace Internal.IL
             Append(index);
             Append(");");
 
-            // TODO: Array covariance
             // TODO: Write barrier as necessary!!!
 
             AppendLine();
@@ -3287,11 +3545,46 @@ namespace Internal.IL
 
         private void ImportAddressOfElement(int token)
         {
+            TypeDesc runtimeDeterminedType = (TypeDesc)_methodIL.GetObject(token);
             TypeDesc elementType = (TypeDesc)_canonMethodIL.GetObject(token);
             var index = _stack.Pop();
             var arrayPtr = _stack.Pop();
 
-            // TODO: type check, unless readonly prefix was applied
+            bool isReadOnly = (_pendingPrefix & Prefix.ReadOnly) != 0;
+            _pendingPrefix &= ~Prefix.ReadOnly;
+
+            if (elementType.IsGCPointer && !isReadOnly)
+            {
+                // Arrays of reference types are covariant, the helper checks the element type of the array is
+                // exactly the one the address is taken for, as well as the range
+                TypeDesc byRefType = elementType.MakeByRefType();
+                AddTypeReference(elementType, true);
+
+                PushTemp(StackValueKind.ByRef, byRefType);
+                AppendCastIfNecessary(StackValueKind.ByRef, byRefType);
+
+                Append("__ldelema_ref_fast(");
+                Append(arrayPtr);
+                Append(", ");
+                Append(index);
+                Append(", ");
+                if (runtimeDeterminedType.IsRuntimeDeterminedSubtype)
+                {
+                    Append("(MethodTable *)");
+                    Append(GetGenericLookupHelperAndAddReference(ReadyToRunHelperId.TypeHandle, runtimeDeterminedType));
+                    Append("(");
+                    Append(GetGenericContext());
+                    Append(")");
+                }
+                else
+                {
+                    Append(_writer.GetCppTypeName(runtimeDeterminedType));
+                    Append("::__getMethodTable()");
+                }
+                Append(")");
+                AppendSemicolon();
+                return;
+            }
 
             // Range check
             AppendLine();
@@ -3500,7 +3793,28 @@ namespace Internal.IL
 
         private void ImportEndFilter()
         {
-            throw new NotImplementedException();
+            var result = _stack.Pop();
+
+            int filterIndex = FindNearestFilter(_currentOffset - 1);
+            var r = _exceptionRegions[filterIndex];
+
+            // The handler gets the exception if the filter accepts it, the remaining clauses of the try otherwise
+            AppendLine();
+            Append("if (");
+            Append(result);
+            Append(") { ");
+            Append(r.HandlerExceptionSlot);
+            Append(" = (");
+            Append(GetStackValueKindCPPTypeName(StackValueKind.ObjRef, GetWellKnownType(WellKnownType.Object)));
+            Append(")__exception");
+            Append(GetTryGroup(filterIndex).ToStringInvariant());
+            Append("; goto _bb");
+            Append(r.ILRegion.HandlerOffset.ToStringInvariant());
+            Append("; }");
+            AppendLine();
+            Append("goto ");
+            Append(GetDispatchLabel(filterIndex + 1, GetTryGroup(filterIndex)));
+            AppendSemicolon();
         }
 
         private void ImportCpBlk()
@@ -3526,7 +3840,27 @@ namespace Internal.IL
 
         private void ImportRethrow()
         {
-            throw new NotImplementedException();
+            int candidate = -1;
+            for (int i = 0; i < _exceptionRegions.Length; i++)
+            {
+                var r = _exceptionRegions[i];
+
+                if ((r.ILRegion.Kind == ILExceptionRegionKind.Catch || r.ILRegion.Kind == ILExceptionRegionKind.Filter) &&
+                    IsOffsetContained(_currentOffset - 1, r.ILRegion.HandlerOffset, r.ILRegion.HandlerLength))
+                {
+                    if (candidate == -1 ||
+                        _exceptionRegions[candidate].ILRegion.HandlerOffset < _exceptionRegions[i].ILRegion.HandlerOffset)
+                    {
+                        candidate = i;
+                    }
+                }
+            }
+
+            AppendLine();
+            Append("__throw_exception(__exception");
+            Append(GetTryGroup(candidate).ToStringInvariant());
+            Append(")");
+            AppendSemicolon();
         }
 
         private void ImportSizeOf(int token)
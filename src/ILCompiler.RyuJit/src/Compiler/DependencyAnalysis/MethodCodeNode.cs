@@ -21,6 +21,7 @@ namespace ILCompiler.DependencyAnalysis
         private DebugVarInfo[] _debugVarInfos;
         private DebugEHClauseInfo[] _debugEHClauseInfos;
         private bool _isFoldable;
+        private bool _isDataReleased;
 
         public MethodCodeNode(MethodDesc method)
         {
@@ -50,7 +51,7 @@ namespace ILCompiler.DependencyAnalysis
             }
         }
         
-        public override bool StaticDependenciesAreComputed => _methodCode != null;
+        public override bool StaticDependenciesAreComputed => _methodCode != null || _isDataReleased;
 
         public virtual void AppendMangledName(NameMangler nameMangler, Utf8StringBuilder sb)
         {
@@ -95,9 +96,23 @@ namespace ILCompiler.DependencyAnalysis
 
         public override ObjectData GetData(NodeFactory factory, bool relocsOnly)
         {
+            Debug.Assert(!_isDataReleased);
             return _methodCode;
         }
 
+        public override void ReleaseEmittedData()
+        {
+            // The code, its unwind, GC and EH info and the debug info are only needed to write the node
+            _isDataReleased = true;
+            _methodCode = null;
+            _frameInfos = null;
+            _gcInfo = null;
+            _ehInfo = null;
+            _debugLocInfos = null;
+            _debugVarInfos = null;
+            _debugEHClauseInfos = null;
+        }
+
         public bool IsSpecialUnboxingThunk => ((CompilerTypeSystemContext)Method.Context).IsSpecialUnboxingThunk(_method);
 
         public ISymbolNode GetUnboxingThunkTarget(NodeFactory factory)
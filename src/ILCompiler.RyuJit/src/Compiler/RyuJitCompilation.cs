@@ -24,6 +24,8 @@ namespace ILCompiler
         private readonly ExternSymbolMappedField _hardwareIntrinsicFlags;
         private CountdownEvent _compilationCountdown;
         private readonly Dictionary<string, InstructionSet> _instructionSetMap;
+        private readonly EETypeLayoutOrder _eetypeLayoutOrder;
+        private readonly MethodLayoutOrder _methodLayoutOrder;
 
         public InstructionSetSupport InstructionSetSupport { get; }
 
@@ -36,10 +38,14 @@ namespace ILCompiler
             Logger logger,
             DevirtualizationManager devirtualizationManager,
             InstructionSetSupport instructionSetSupport,
-            RyuJitCompilationOptions options)
+            RyuJitCompilationOptions options,
+            EETypeLayoutOrder eetypeLayoutOrder,
+            MethodLayoutOrder methodLayoutOrder)
             : base(dependencyGraph, nodeFactory, roots, ilProvider, debugInformationProvider, devirtualizationManager, logger)
         {
             _compilationOptions = options;
+            _eetypeLayoutOrder = eetypeLayoutOrder;
+            _methodLayoutOrder = methodLayoutOrder;
             _hardwareIntrinsicFlags = new ExternSymbolMappedField(nodeFactory.TypeSystemContext.GetWellKnownType(WellKnownType.Int32), "g_cpuFeatures");
             InstructionSetSupport = instructionSetSupport;
 
@@ -56,10 +62,21 @@ namespace ILCompiler
         protected override void CompileInternal(string outputFile, ObjectDumper dumper)
         {
             _dependencyGraph.ComputeMarkedNodes();
-            var nodes = _dependencyGraph.MarkedNodeList;
+            IEnumerable<DependencyNode> nodes = _dependencyGraph.MarkedNodeList;
 
             NodeFactory.SetMarkingComplete();
-            ObjectWriter.EmitObject(outputFile, nodes, NodeFactory, dumper);
+
+            if (_eetypeLayoutOrder != null)
+                nodes = _eetypeLayoutOrder.Apply(nodes, NodeFactory);
+
+            if (_methodLayoutOrder != null)
+                nodes = _methodLayoutOrder.Apply(nodes, NodeFactory);
+
+            ObjectWritingOptions objectWritingOptions = 0;
+            if ((_compilationOptions & RyuJitCompilationOptions.CompressDebugSections) != 0)
+                objectWritingOptions |= ObjectWritingOptions.CompressDebugSections;
+
+            ObjectWriter.EmitObject(outputFile, nodes, NodeFactory, dumper, objectWritingOptions);
         }
 
         protected override void ComputeDependencyNodeDependencies(List<DependencyNodeCore<NodeFactory>> obj)
@@ -210,5 +227,6 @@ namespace ILCompiler
     {
         MethodBodyFolding = 0x1,
         SingleThreadedCompilation = 0x2,
+        CompressDebugSections = 0x4,
     }
 }
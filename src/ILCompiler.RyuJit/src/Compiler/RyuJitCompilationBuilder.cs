@@ -106,11 +106,14 @@ namespace ILCompiler
             if (_singleThreaded)
                 options |= RyuJitCompilationOptions.SingleThreadedCompilation;
 
+            if (_compressDebugSections)
+                options |= RyuJitCompilationOptions.CompressDebugSections;
+
             var factory = new RyuJitNodeFactory(_context, _compilationGroup, _metadataManager, _interopStubManager, _nameMangler, _vtableSliceProvider, _dictionaryLayoutProvider, GetPreinitializationManager());
 
             JitConfigProvider.Initialize(jitFlagBuilder.ToArray(), _ryujitOptions);
             DependencyAnalyzerBase<NodeFactory> graph = CreateDependencyGraph(factory, new ObjectNode.ObjectNodeComparer(new CompilerComparer()));
-            return new RyuJitCompilation(graph, factory, _compilationRoots, _ilProvider, _debugInformationProvider, _logger, _devirtualizationManager, _instructionSetSupport, options);
+            return new RyuJitCompilation(graph, factory, _compilationRoots, _ilProvider, _debugInformationProvider, _logger, _devirtualizationManager, _instructionSetSupport, options, _eetypeLayoutOrder, _methodLayoutOrder);
         }
     }
 }
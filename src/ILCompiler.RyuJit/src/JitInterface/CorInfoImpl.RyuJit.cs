@@ -790,6 +790,20 @@ namespace Internal.JitInterface
                 if (_sequencePoints.TryGetValue((int)ilOffset, out s))
                 {
                     Debug.Assert(s.Document != null);
+
+                    // The JIT reports boundaries at call sites and where the IL stack is empty too, many of
+                    // them within the same statement. A row for the line the previous row is already on
+                    // doesn't change what the line table says about any address, so leave it out.
+                    if (debugLocInfos.Count > 0)
+                    {
+                        DebugLocInfo previous = debugLocInfos[debugLocInfos.Count - 1];
+                        if (previous.LineNumber == s.LineNumber && previous.FileName == s.Document)
+                        {
+                            previousNativeOffset = nativeOffset;
+                            continue;
+                        }
+                    }
+
                     DebugLocInfo loc = new DebugLocInfo(nativeOffset, s.Document, s.LineNumber);
                     debugLocInfos.Add(loc);
                     previousNativeOffset = nativeOffset;
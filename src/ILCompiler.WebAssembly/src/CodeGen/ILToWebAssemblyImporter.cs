@@ -70,8 +70,28 @@ namespace Internal.IL
         private readonly Dictionary<Tuple<int, IntPtr>, LLVMBasicBlockRef> _landingPads;
         private readonly Dictionary<IntPtr, LLVMBasicBlockRef> _funcletUnreachableBlocks = new Dictionary<IntPtr, LLVMBasicBlockRef>();
         private readonly Dictionary<IntPtr, LLVMBasicBlockRef> _funcletResumeBlocks = new Dictionary<IntPtr, LLVMBasicBlockRef>();
+        private readonly Dictionary<IntPtr, (LLVMValueRef Top, LLVMValueRef Live)> _funcletShadowFrames = new Dictionary<IntPtr, (LLVMValueRef Top, LLVMValueRef Live)>();
         private readonly EHInfoNode _ehInfoNode;
         private AddressCacheContext _funcletAddrCacheCtx;
+        private LLVMValueRef _shadowFrameHeader;
+        private LLVMValueRef _previousShadowFrame;
+        private LLVMValueRef _frameSizeGlobal;
+        private LLVMValueRef _gcSlotsGlobal;
+
+        // Layout of the header every method keeps on the shadow stack after its parameters, see ShadowFrame in thread.cpp
+        private const int ShadowFramePrevious = 0;
+        private const int ShadowFrameFrame = 1;
+        private const int ShadowFrameGcSlots = 2;
+        private const int ShadowFrameLive = 3;
+        private const int ShadowFrameFieldCount = 4;
+
+        // Flags in the low bits of the GC slot table entries, the rest is the offset of the slot in the frame
+        private const int GcSlotInterior = 1;
+        private const int GcSlotPinned = 2;
+        private const int GcSlotFlagBits = 2;
+
+        // TrapThreadsFlags::TrapThreads in threadstore.h
+        private const int TrapThreadsFlagsTrapThreads = 2;
 
         /// <summary>
         /// Stack of values pushed onto the IL stack: locals, arguments, values, function pointer, ...
@@ -215,6 +235,8 @@ namespace Internal.IL
             }
             finally
             {
+                EmitShadowFrameInfo();
+
                 // Generate thunk for runtime exports
                 if ((_method.IsRuntimeExport || _method.IsUnmanagedCallersOnly) && _method is EcmaMethod)  // TODO: Reverse delegate invokes probably need something here, but what would be the export name?
                 {
@@ -238,6 +260,8 @@ namespace Internal.IL
             LLVMBuilderRef prologBuilder = Context.CreateBuilder();
             LLVMBasicBlockRef prologBlock = _llvmFunction.AppendBasicBlock("Prolog");
             prologBuilder.PositionAtEnd(prologBlock);
+            PushShadowFrame(prologBuilder);
+
             // Copy arguments onto the stack to allow
             // them to be referenced by address
             int thisOffset = 0;
@@ -415,6 +439,8 @@ namespace Internal.IL
                 TriggerCctor(metadataType, prologBuilder);
             }
 
+            EmitGcPoll(prologBuilder);
+
             LLVMBasicBlockRef block0 = GetLLVMBasicBlockForBlock(_basicBlocks[0]);
             prologBuilder.PositionBefore(prologBuilder.BuildBr(block0));
             _builder.PositionAtEnd(block0);
@@ -470,6 +496,14 @@ namespace Internal.IL
                 funclet = Module.AddFunction(funcletName, universalFuncletSignature);
 
                 _exceptionFunclets.Add(funclet);
+
+                // Remember the state of the shadow frames on entry so the returns and landing pads of the funclet can restore it
+                LLVMBuilderRef entryBuilder = Context.CreateBuilder();
+                entryBuilder.PositionAtEnd(funclet.AppendBasicBlock("FuncletEntry"));
+                LLVMValueRef top = entryBuilder.BuildLoad(ShadowFrameTop, "funcletShadowFrameTop");
+                LLVMValueRef live = entryBuilder.BuildLoad(GetShadowFrameField(entryBuilder, funclet.GetParam(0), ShadowFrameLive, LLVMTypeRef.Int32), "funcletShadowFrameLive");
+                _funcletShadowFrames[funclet.Handle] = (top, live);
+                entryBuilder.BuildBr(GetLLVMBasicBlockForBlock(_basicBlocks[handlerOffset]));
             }
 
             return funclet;
@@ -545,8 +579,12 @@ namespace Internal.IL
             {
                 LLVMValueRef blockFunclet = GetFuncletForBlock(block);
 
-                block.Block = blockFunclet.AppendBasicBlock("Block" + block.StartOffset.ToString("X"));
-                block.LLVMBlocks.Add(block.Block);
+                // Creating a funclet also creates the block it starts with
+                if (block.Block.Handle == IntPtr.Zero)
+                {
+                    block.Block = blockFunclet.AppendBasicBlock("Block" + block.StartOffset.ToString("X"));
+                    block.LLVMBlocks.Add(block.Block);
+                }
             }
             return block.Block;
         }
@@ -1510,6 +1548,15 @@ namespace Internal.IL
         }
 
         private int GetTotalParameterOffset()
+        {
+            return GetShadowFrameHeaderOffset() + ShadowFrameFieldCount * _pointerSize;
+        }
+
+        /// <summary>
+        /// Returns the offset of the shadow frame header, which follows the parameters
+        /// passed on the shadow stack
+        /// </summary>
+        private int GetShadowFrameHeaderOffset()
         {
             int offset = 0;
             for (int i = 0; i < _signature.Length; i++)
@@ -1744,6 +1791,7 @@ namespace Internal.IL
         {
             if (_signature.ReturnType.IsVoid)
             {
+                PopShadowFrame();
                 _builder.BuildRetVoid();
                 return;
             }
@@ -1751,6 +1799,7 @@ namespace Internal.IL
             StackEntry retVal = _stack.Pop();
             LLVMTypeRef valueType = GetLLVMTypeForTypeDesc(_signature.ReturnType);
             LLVMValueRef castValue = retVal.ValueAsType(valueType, _builder);
+            PopShadowFrame();
 
             if (NeedsReturnStackSlot(_signature))
             {
@@ -2668,6 +2717,9 @@ namespace Internal.IL
                     argOffset += argType.GetElementSize().AsInt;
                 }
             }
+
+            // The helper calls above may have used the shadow stack past the callee's frame
+            SetShadowFrameLive(builder, offset);
             LLVMValueRef llvmReturn = default;
             LLVMBasicBlockRef nextInstrBlock = default(LLVMBasicBlockRef);
             if (fatFunctionPtr.Handle != IntPtr.Zero) // indicates GVM
@@ -2864,6 +2916,10 @@ namespace Internal.IL
             LLVMValueRef pad = landingPadBuilder.BuildLandingPad(GxxPersonalityType, GxxPersonality, 1, "");
             pad.AddClause(LLVMValueRef.CreateConstPointerNull(LLVMTypeRef.CreatePointer(LLVMTypeRef.Int8, 0)));
             pad.IsCleanup = true; // always enter this clause regardless of exception type - do our own exception type matching
+
+            // The frames of the callees the exception unwound through are gone
+            LLVMValueRef shadowFrameTop = _currentFunclet.Handle.Equals(_llvmFunction.Handle) ? _shadowFrameHeader : _funcletShadowFrames[_currentFunclet.Handle].Top;
+            landingPadBuilder.BuildStore(shadowFrameTop, ShadowFrameTop);
             if (RhpCallCatchFunclet.Handle.Equals(IntPtr.Zero))
             {
                 RhpCallCatchFunclet = GetOrCreateLLVMFunction("RhpCallCatchFunclet", LLVMTypeRef.CreateFunction(LLVMTypeRef.Int32, new []
@@ -3069,7 +3125,9 @@ namespace Internal.IL
             }
 
             // Save the top of the shadow stack in case the callee reverse P/Invokes
-            LLVMValueRef stackFrameSize = BuildConstInt32(GetTotalParameterOffset() + GetTotalLocalOffset());
+            int offset = GetTotalParameterOffset() + GetTotalLocalOffset();
+            SetShadowFrameLive(_builder, offset);
+            LLVMValueRef stackFrameSize = BuildConstInt32(offset);
             _builder.BuildStore(_builder.BuildGEP(_currentFunclet.GetParam(0), new LLVMValueRef[] { stackFrameSize }, "shadowStackTop"),
                 Module.GetNamedGlobal("t_pShadowStackTop"));
 
@@ -3142,6 +3200,215 @@ namespace Internal.IL
             }
         }
 
+        static LLVMValueRef s_shadowFrameTop = default(LLVMValueRef);
+
+        LLVMValueRef ShadowFrameTop
+        {
+            get
+            {
+                if (s_shadowFrameTop.Handle.Equals(IntPtr.Zero))
+                {
+                    s_shadowFrameTop = Module.AddGlobal(LLVMTypeRef.CreatePointer(LLVMTypeRef.Int8, 0), "t_pShadowFrameTop");
+                    s_shadowFrameTop.Linkage = LLVMLinkage.LLVMExternalLinkage;
+                    s_shadowFrameTop.Initializer = LLVMValueRef.CreateConstPointerNull(LLVMTypeRef.CreatePointer(LLVMTypeRef.Int8, 0));
+                    s_shadowFrameTop.ThreadLocalMode = LLVMThreadLocalMode.LLVMLocalDynamicTLSModel;
+                }
+                return s_shadowFrameTop;
+            }
+        }
+
+        private LLVMValueRef GetShadowFrameField(LLVMBuilderRef builder, LLVMValueRef frame, int field, LLVMTypeRef fieldType)
+        {
+            LLVMValueRef fieldAddress = builder.BuildGEP(frame, new LLVMValueRef[] { BuildConstInt32(GetShadowFrameHeaderOffset() + field * _pointerSize) }, "shadowFrameField");
+            return builder.BuildPointerCast(fieldAddress, LLVMTypeRef.CreatePointer(fieldType, 0), String.Empty);
+        }
+
+        /// <summary>
+        /// Links the frame of the method into the list of shadow frames the GC walks and clears its locals
+        /// and spill slots, so the GC never sees what an earlier callee left in them
+        /// </summary>
+        private void PushShadowFrame(LLVMBuilderRef builder)
+        {
+            LLVMTypeRef int8PtrType = LLVMTypeRef.CreatePointer(LLVMTypeRef.Int8, 0);
+            LLVMValueRef frame = _llvmFunction.GetParam(0);
+
+            // The size of the frame and the GC slots are only known once the method is imported, see EmitShadowFrameInfo
+            _frameSizeGlobal = Module.AddGlobal(LLVMTypeRef.Int32, _mangledName + "__FrameSize");
+            _frameSizeGlobal.Linkage = LLVMLinkage.LLVMInternalLinkage;
+            _frameSizeGlobal.IsGlobalConstant = true;
+            _frameSizeGlobal.Initializer = BuildConstInt32(0);
+            _gcSlotsGlobal = Module.AddGlobal(LLVMTypeRef.CreatePointer(LLVMTypeRef.Int32, 0), _mangledName + "__GcSlotsPtr");
+            _gcSlotsGlobal.Linkage = LLVMLinkage.LLVMInternalLinkage;
+            _gcSlotsGlobal.IsGlobalConstant = true;
+            _gcSlotsGlobal.Initializer = LLVMValueRef.CreateConstPointerNull(LLVMTypeRef.CreatePointer(LLVMTypeRef.Int32, 0));
+
+            _shadowFrameHeader = builder.BuildGEP(frame, new LLVMValueRef[] { BuildConstInt32(GetShadowFrameHeaderOffset()) }, "shadowFrame");
+            _previousShadowFrame = builder.BuildLoad(ShadowFrameTop, "previousShadowFrame");
+            builder.BuildStore(_previousShadowFrame, GetShadowFrameField(builder, frame, ShadowFramePrevious, int8PtrType));
+            builder.BuildStore(frame, GetShadowFrameField(builder, frame, ShadowFrameFrame, int8PtrType));
+            builder.BuildStore(builder.BuildLoad(_gcSlotsGlobal, "gcSlots"), GetShadowFrameField(builder, frame, ShadowFrameGcSlots, LLVMTypeRef.CreatePointer(LLVMTypeRef.Int32, 0)));
+            builder.BuildStore(BuildConstInt32(0), GetShadowFrameField(builder, frame, ShadowFrameLive, LLVMTypeRef.Int32));
+
+            int localsOffset = GetTotalParameterOffset();
+            LLVMValueRef locals = builder.BuildGEP(frame, new LLVMValueRef[] { BuildConstInt32(localsOffset) }, "locals");
+            LLVMValueRef localsSize = builder.BuildSub(builder.BuildLoad(_frameSizeGlobal, "frameSize"), BuildConstInt32(localsOffset), "localsSize");
+            ImportCallMemset(locals, 0, localsSize, builder);
+
+            builder.BuildStore(_shadowFrameHeader, ShadowFrameTop);
+        }
+
+        private void PopShadowFrame()
+        {
+            _builder.BuildStore(_previousShadowFrame, ShadowFrameTop);
+        }
+
+        /// <summary>
+        /// Records that the part of the frame below <paramref name="calleeOffset"/> is in use by this method and
+        /// the rest belongs to the callee, the GC only reports the slots of this method below it
+        /// </summary>
+        private void SetShadowFrameLive(LLVMBuilderRef builder, int calleeOffset)
+        {
+            builder.BuildStore(BuildConstInt32(calleeOffset), GetShadowFrameField(builder, _currentFunclet.GetParam(0), ShadowFrameLive, LLVMTypeRef.Int32));
+        }
+
+        /// <summary>
+        /// Emits the check of RhpTrapThreads at a safe point: while the runtime suspends threads for a GC, the
+        /// thread waits in RhpGcPoll until the GC is done
+        /// </summary>
+        private void EmitGcPoll(LLVMBuilderRef builder)
+        {
+            LLVMValueRef trapThreadsGlobal = Module.GetNamedGlobal("RhpTrapThreads");
+            if (trapThreadsGlobal.Handle == IntPtr.Zero)
+            {
+                trapThreadsGlobal = Module.AddGlobal(LLVMTypeRef.Int32, "RhpTrapThreads");
+                trapThreadsGlobal.Linkage = LLVMLinkage.LLVMExternalLinkage;
+            }
+
+            LLVMValueRef trapThreads = builder.BuildLoad(trapThreadsGlobal, "trapThreads");
+            trapThreads.Volatile = true;
+            LLVMValueRef trap = builder.BuildICmp(LLVMIntPredicate.LLVMIntNE, builder.BuildAnd(trapThreads, BuildConstInt32(TrapThreadsFlagsTrapThreads), "trapThreadsFlag"), BuildConstInt32(0), "trap");
+
+            LLVMBasicBlockRef pollBlock = _currentFunclet.AppendBasicBlock("GcPoll");
+            LLVMBasicBlockRef continueBlock = _currentFunclet.AppendBasicBlock("GcPollDone");
+            builder.BuildCondBr(trap, pollBlock, continueBlock);
+
+            builder.PositionAtEnd(pollBlock);
+            SetShadowFrameLive(builder, GetTotalParameterOffset() + GetTotalLocalOffset());
+            builder.BuildCall(GetOrCreateLLVMFunction("RhpGcPoll", LLVMTypeRef.CreateFunction(LLVMTypeRef.Void, Array.Empty<LLVMTypeRef>(), false)), Array.Empty<LLVMValueRef>(), String.Empty);
+            builder.BuildBr(continueBlock);
+
+            builder.PositionAtEnd(continueBlock);
+            if (_currentBasicBlock != null)
+            {
+                _curBasicBlock = continueBlock;
+                _currentBasicBlock.LLVMBlocks.Add(pollBlock);
+                _currentBasicBlock.LLVMBlocks.Add(continueBlock);
+                _currentBasicBlock.LastInternalBlock = continueBlock;
+            }
+        }
+
+        private void RestoreFuncletShadowFrame()
+        {
+            (LLVMValueRef Top, LLVMValueRef Live) state = _funcletShadowFrames[_currentFunclet.Handle];
+            _builder.BuildStore(state.Live, GetShadowFrameField(_builder, _currentFunclet.GetParam(0), ShadowFrameLive, LLVMTypeRef.Int32));
+        }
+
+        /// <summary>
+        /// Emits the size of the frame of the method and the table of the GC references in it. The table
+        /// is the number of entries followed by the entries sorted by offset from the start of the frame, each
+        /// shifted left by <see cref="GcSlotFlagBits"/> and combined with the GcSlot flags
+        /// </summary>
+        private void EmitShadowFrameInfo()
+        {
+            _frameSizeGlobal.Initializer = BuildConstInt32(GetTotalParameterOffset() + GetTotalLocalOffset());
+
+            List<int> slots = new List<int>();
+
+            int thisOffset = _signature.IsStatic ? 0 : 1;
+            for (int i = 0; i < thisOffset + _signature.Length; i++)
+            {
+                int argOffset = GetArgOffsetAtIndex(i, out int realArgIndex);
+                if (realArgIndex != -1)
+                {
+                    continue;
+                }
+
+                TypeDesc argType;
+                if (i < thisOffset)
+                {
+                    argType = _thisType.IsValueType ? _thisType.MakeByRefType() : _thisType;
+                }
+                else
+                {
+                    argType = _signature[i - thisOffset];
+                }
+                AddGcSlots(slots, argType, argOffset, 0);
+            }
+
+            for (int i = 0; i < _locals.Length; i++)
+            {
+                int localOffset = GetLocalOffsetAtIndex(i);
+                if (localOffset != -1)
+                {
+                    AddGcSlots(slots, _locals[i].Type, localOffset + GetTotalParameterOffset(), _locals[i].IsPinned ? GcSlotPinned : 0);
+                }
+            }
+
+            for (int i = 0; i < _spilledExpressions.Count; i++)
+            {
+                SpilledExpressionEntry spill = _spilledExpressions[i];
+                int spillOffset = GetSpillOffsetAtIndex(i, GetTotalRealLocalOffset()) + GetTotalParameterOffset();
+
+                // The type of a spilled reference is not always the type of what it points to
+                if (spill.Kind == StackValueKind.ByRef && !spill.Type.IsByReferenceOfT ||
+                    spill.Kind == StackValueKind.ObjRef && !spill.Type.IsValueType && !spill.Type.IsGCPointer)
+                {
+                    slots.Add((spillOffset << GcSlotFlagBits) | GcSlotInterior);
+                }
+                else
+                {
+                    AddGcSlots(slots, spill.Type, spillOffset, 0);
+                }
+            }
+
+            slots.Sort();
+
+            LLVMValueRef[] entries = new LLVMValueRef[slots.Count + 1];
+            entries[0] = BuildConstInt32(slots.Count);
+            for (int i = 0; i < slots.Count; i++)
+            {
+                entries[i + 1] = BuildConstInt32(slots[i]);
+            }
+
+            LLVMValueRef gcSlots = Module.AddGlobal(LLVMTypeRef.CreateArray(LLVMTypeRef.Int32, (uint)entries.Length), _mangledName + "__GcSlots");
+            gcSlots.Linkage = LLVMLinkage.LLVMInternalLinkage;
+            gcSlots.IsGlobalConstant = true;
+            gcSlots.Initializer = LLVMValueRef.CreateConstArray(LLVMTypeRef.Int32, entries);
+            _gcSlotsGlobal.Initializer = LLVMValueRef.CreateConstBitCast(gcSlots, LLVMTypeRef.CreatePointer(LLVMTypeRef.Int32, 0));
+        }
+
+        private static void AddGcSlots(List<int> slots, TypeDesc type, int offset, int flags)
+        {
+            if (type.IsGCPointer)
+            {
+                slots.Add((offset << GcSlotFlagBits) | flags);
+            }
+            else if (type.IsByRef || type.IsByReferenceOfT)
+            {
+                slots.Add((offset << GcSlotFlagBits) | GcSlotInterior | flags);
+            }
+            else if (type is DefType defType && defType.IsValueType && (defType.ContainsGCPointers || defType.IsByRefLike))
+            {
+                foreach (FieldDesc field in defType.GetFields())
+                {
+                    if (!field.IsStatic)
+                    {
+                        AddGcSlots(slots, field.FieldType, offset + field.Offset.AsInt, flags);
+                    }
+                }
+            }
+        }
+
         private void EmitNativeToManagedThunk(WebAssemblyCodegenCompilation compilation, MethodDesc method, string nativeName, LLVMValueRef managedFunction)
         {
             if (_pinvokeMap.TryGetValue(nativeName, out MethodDesc existing))
@@ -3452,6 +3719,10 @@ namespace Internal.IL
             if (opcode == ILOpcode.br)
             {
                 ImportFallthrough(target);
+                if (target.StartOffset < _currentOffset)
+                {
+                    EmitGcPoll(_builder);
+                }
                 _builder.BuildBr(GetLLVMBasicBlockForBlock(target));
             }
             else
@@ -3583,6 +3854,10 @@ namespace Internal.IL
 
                 ImportFallthrough(target);
                 ImportFallthrough(fallthrough);
+                if (target.StartOffset < _currentOffset)
+                {
+                    EmitGcPoll(_builder);
+                }
                 _builder.BuildCondBr(condition, GetLLVMBasicBlockForBlock(target), GetLLVMBasicBlockForBlock(fallthrough));
             }
         }
@@ -3590,6 +3865,10 @@ namespace Internal.IL
         private void ImportSwitchJump(int jmpBase, int[] jmpDelta, BasicBlock fallthrough)
         {
             var operand = _stack.Pop();
+            if (jmpDelta.Any(delta => delta < 0))
+            {
+                EmitGcPoll(_builder);
+            }
 
             var @switch = _builder.BuildSwitch(operand.ValueAsInt32(_builder, false), GetLLVMBasicBlockForBlock(fallthrough), (uint)jmpDelta.Length);
             for (var i = 0; i < jmpDelta.Length; i++)
@@ -4198,6 +4477,7 @@ namespace Internal.IL
         LLVMValueRef GetShadowStack()
         {
             int offset = GetTotalParameterOffset() + GetTotalLocalOffset();
+            SetShadowFrameLive(_builder, offset);
             return _builder.BuildGEP(_currentFunclet.GetParam(0),
                 new LLVMValueRef[] { LLVMValueRef.CreateConstInt(LLVMTypeRef.Int32, (uint)offset, false) },
                 String.Empty);
@@ -4287,7 +4567,9 @@ namespace Internal.IL
 
         private void ImportEndFilter()
         {
-            _builder.BuildRet(_stack.Pop().ValueAsInt32(_builder, false));
+            LLVMValueRef result = _stack.Pop().ValueAsInt32(_builder, false);
+            RestoreFuncletShadowFrame();
+            _builder.BuildRet(result);
         }
 
         private void ImportCpBlk()
@@ -4868,6 +5150,7 @@ namespace Internal.IL
             }
             else
             {
+                RestoreFuncletShadowFrame();
                 _builder.BuildRet(BuildConstInt32(target.StartOffset));
             }
         }
@@ -5010,6 +5293,7 @@ namespace Internal.IL
 
         private void ImportEndFinally()
         {
+            RestoreFuncletShadowFrame();
             _builder.BuildRetVoid();
         }
 
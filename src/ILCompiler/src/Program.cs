@@ -51,6 +51,8 @@ namespace ILCompiler
         private bool _noScanner;
         private bool _emitStackTraceData;
         private string _mapFileName;
+        private string _eetypeOrderFileName;
+        private string _methodOrderFileName;
         private string _metadataLogFileName;
         private bool _noMetadataBlocking;
         private bool _disableReflection;
@@ -58,6 +60,7 @@ namespace ILCompiler
         private bool _scanReflection;
         private bool _methodBodyFolding;
         private bool _singleThreaded;
+        private bool _compressDebugSections;
         private string _instructionSet;
 
         private string _singleMethodTypeName;
@@ -174,6 +177,8 @@ namespace ILCompiler
                 syntax.DefineOptionList("rdxml", ref _rdXmlFilePaths, "RD.XML file(s) for compilation");
                 syntax.DefineOption("rootallapplicationassemblies", ref _rootAllApplicationAssemblies, "Consider all non-framework assemblies dynamically used");
                 syntax.DefineOption("map", ref _mapFileName, "Generate a map file");
+                syntax.DefineOption("eetypeorder", ref _eetypeOrderFileName, "File listing the hottest EETypes to place first, in order");
+                syntax.DefineOption("methodorder", ref _methodOrderFileName, "File listing the hottest methods to place first, in order");
                 syntax.DefineOption("metadatalog", ref _metadataLogFileName, "Generate a metadata log file");
                 syntax.DefineOption("nometadatablocking", ref _noMetadataBlocking, "Ignore metadata blocking for internal implementation details");
                 syntax.DefineOption("disablereflection", ref _disableReflection, "Disable generation of reflection metadata");
@@ -189,6 +194,7 @@ namespace ILCompiler
                 syntax.DefineOptionList("runtimeopt", ref _runtimeOptions, "Runtime options to set");
                 syntax.DefineOptionList("removefeature", ref _removedFeatures, "Framework features to remove");
                 syntax.DefineOption("singlethreaded", ref _singleThreaded, "Run compilation on a single thread");
+                syntax.DefineOption("compressdebug", ref _compressDebugSections, "Compress the DWARF debug sections of ELF object files");
                 syntax.DefineOption("instructionset", ref _instructionSet, "Instruction set to allow or disallow");
 
                 syntax.DefineOption("targetarch", ref _targetArchitectureStr, "Target architecture for cross compilation");
@@ -688,6 +694,7 @@ namespace ILCompiler
                 .UseBackendOptions(_codegenOptions)
                 .UseMethodBodyFolding(enable: _methodBodyFolding)
                 .UseSingleThread(enable: _singleThreaded)
+                .UseCompressedDebugSections(enable: _compressDebugSections)
                 .UseMetadataManager(metadataManager)
                 .UseInteropStubManager(interopStubManager)
                 .UseLogger(logger)
@@ -696,6 +703,12 @@ namespace ILCompiler
                 .UseOptimizationMode(_optimizationMode)
                 .UseDebugInfoProvider(debugInfoProvider);
 
+            if (_eetypeOrderFileName != null)
+                builder.UseEETypeLayoutOrder(new EETypeLayoutOrder(_eetypeOrderFileName));
+
+            if (_methodOrderFileName != null)
+                builder.UseMethodLayoutOrder(new MethodLayoutOrder(_methodOrderFileName));
+
             if (scanResults != null)
             {
                 // If we have a scanner, feed the vtable analysis results to the compilation.
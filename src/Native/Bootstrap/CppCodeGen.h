@@ -63,6 +63,118 @@ struct PInvokeTransitionFrame
     uint32_t    m_Flags;  // PInvokeTransitionFrameFlags
 };
 
+// The start of gc_alloc_context, which is the first field of the runtime's Thread and so is found at the start
+// of tls_CurrentThread, where the assembly allocation helpers also find it.
+struct CppCodeGenAllocContext
+{
+    uint8_t*    alloc_ptr;
+    uint8_t*    alloc_limit;
+};
+
+extern "C" CORERT_THREAD CppCodeGenAllocContext tls_CurrentThread;
+
+#define CPPCODEGEN_EETYPE_HAS_FINALIZER     0x0010  // EEType::HasFinalizerFlag
+#define CPPCODEGEN_LARGE_OBJECT_SIZE        85000   // RH_LARGE_OBJECT_SIZE
+
+// Allocation fast paths the C++ compiler can inline into generated code. They bump the allocation context of
+// the current thread like RhpNewFast and RhpNewArray do and leave anything else to the runtime: finalizable
+// and large objects, arrays whose size could overflow, a thread that doesn't have an allocation context yet
+// and the end of the context. Types that need 8 byte alignment on 32-bit ARM always take the slow path.
+inline Object * __allocate_object_fast(MethodTable * pMT)
+{
+#if !defined(_M_ARM) && !defined(__arm__)
+    RawEEType * pEEType = (RawEEType *)pMT;
+    if ((pEEType->m_flags & CPPCODEGEN_EETYPE_HAS_FINALIZER) == 0 && pEEType->m_baseSize < CPPCODEGEN_LARGE_OBJECT_SIZE)
+    {
+        CppCodeGenAllocContext * acontext = &tls_CurrentThread;
+        uint8_t * result = acontext->alloc_ptr;
+        if ((size_t)(acontext->alloc_limit - result) >= pEEType->m_baseSize)
+        {
+            acontext->alloc_ptr = result + pEEType->m_baseSize;
+            *(MethodTable **)result = pMT;
+            return (Object *)result;
+        }
+    }
+#endif
+    return __allocate_object(pMT);
+}
+
+inline Object * __allocate_array_fast(size_t elements, MethodTable * pMT)
+{
+#if !defined(_M_ARM) && !defined(__arm__)
+    // The component size is at most 0xffff, so up to 0x10000 elements the size can't overflow
+    RawEEType * pEEType = (RawEEType *)pMT;
+    if (elements <= 0x10000)
+    {
+        size_t size = (pEEType->m_baseSize + elements * pEEType->m_componentSize + (sizeof(void*) - 1)) & ~(sizeof(void*) - 1);
+        CppCodeGenAllocContext * acontext = &tls_CurrentThread;
+        uint8_t * result = acontext->alloc_ptr;
+        if (size < CPPCODEGEN_LARGE_OBJECT_SIZE && (size_t)(acontext->alloc_limit - result) >= size)
+        {
+            acontext->alloc_ptr = result + size;
+            *(MethodTable **)result = pMT;
+            *(uint32_t *)(result + sizeof(void*)) = (uint32_t)elements;
+            return (Object *)result;
+        }
+    }
+#endif
+    return __allocate_array(elements, pMT);
+}
+
+extern "C" void RhpAssignRef(void ** dst, void * ref);
+
+// Casting and array element fast paths. An object whose EEType is the target type, and an array whose element
+// type is exactly the type of the object stored or of the address taken, don't need the runtime to walk the
+// type hierarchy. Everything else goes to the runtime helpers, which also throw the cast exceptions.
+inline Object * __castclass_fast(MethodTable * pTargetMT, void * obj)
+{
+    if (obj == NULL || *(MethodTable **)obj == pTargetMT)
+        return (Object *)obj;
+    return __castclass(pTargetMT, obj);
+}
+
+inline Object * __isinst_fast(MethodTable * pTargetMT, void * obj)
+{
+    if (obj == NULL || *(MethodTable **)obj == pTargetMT)
+        return (Object *)obj;
+    return __isinst(pTargetMT, obj);
+}
+
+inline MethodTable * __array_element_type(void * pArray)
+{
+    // The element type of an array is in the related type field, where other types have their base type
+    return ((RawEEType *)*(MethodTable **)pArray)->m_pBaseType;
+}
+
+inline void __stelem_ref_fast(void * pArray, size_t idx, void * obj)
+{
+    __range_check(pArray, idx);
+
+    void ** pElement = (void **)((char *)pArray + ARRAY_BASE) + idx;
+    if (obj == NULL)
+    {
+        // Storing null does not require write barrier
+        *pElement = NULL;
+    }
+    else if (*(MethodTable **)obj == __array_element_type(pArray))
+    {
+        RhpAssignRef(pElement, obj);
+    }
+    else
+    {
+        __stelem_ref(pArray, (unsigned)idx, obj);
+    }
+}
+
+inline void * __ldelema_ref_fast(void * pArray, size_t idx, MethodTable * type)
+{
+    __range_check(pArray, idx);
+
+    if (__array_element_type(pArray) == type)
+        return (void **)((char *)pArray + ARRAY_BASE) + idx;
+    return __ldelema_ref(pArray, (unsigned)idx, type);
+}
+
 // Should be synchronized with System.Private.CoreLib/src/System/Runtime/CompilerServices/StaticClassConstructionContext.cs
 struct StaticClassConstructionContext
 {
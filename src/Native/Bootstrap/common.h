@@ -46,11 +46,27 @@ extern "C" Object * __allocate_object(MethodTable * pMT);
 extern "C" Object * __allocate_array(size_t elements, MethodTable * pMT);
 extern "C" Object * __castclass(MethodTable * pMT, void * obj);
 extern "C" Object * __isinst(MethodTable * pMT, void * obj);
+extern "C" void __stelem_ref(void * pArray, unsigned idx, void * obj);
+extern "C" void* __ldelema_ref(void * pArray, unsigned idx, MethodTable * type);
 extern "C" __NORETURN void __throw_exception(void * pEx);
 extern "C" void __debug_break();
 
 Object * __load_string_literal(const char * string);
 
+// Exception wrapper type that allows us to differentiate managed and native exceptions. The C++ code generator
+// catches it in the C++ try blocks it emits for the try regions of managed code.
+class ManagedExceptionWrapper : exception
+{
+public:
+    ManagedExceptionWrapper(void* pManagedException)
+    {
+        m_pManagedException = pManagedException;
+    }
+
+public:
+    void* m_pManagedException;
+};
+
 extern "C" void __range_check_fail();
 
 inline void __range_check(void * a, size_t elem)
@@ -98,6 +98,11 @@ extern "C" char __stop___unbox;
 static char& __unbox_a = __start___unbox;
 static char& __unbox_z = __stop___unbox;
 
+// The managed unwind table is optional, the bookends are null if no obj file contributed to it.
+extern "C" char __start___managedunwind __attribute__((weak));
+extern "C" char __stop___managedunwind __attribute__((weak));
+#define HAS_MANAGED_UNWIND_TABLE
+
 #endif // __APPLE__
 
 #endif // _MSC_VER
@@ -236,28 +241,9 @@ Object * __load_string_literal(const char * string)
     return pString;
 }
 
-#if defined(HOST_WASM)
-// Exception wrapper type that allows us to differentiate managed and native exceptions
-class ManagedExceptionWrapper : exception
-{
-public:
-    ManagedExceptionWrapper(void* pManagedException)
-    {
-        m_pManagedException = pManagedException;
-    }
-
-public:
-    void* m_pManagedException;
-};
-#endif
-
 extern "C" void RhpThrowEx(void * pEx)
 {
-#if defined(HOST_WASM)
     throw ManagedExceptionWrapper(pEx);
-#else 
-    throw "RhpThrowEx";
-#endif
 }
 
 extern "C" void RhpThrowHwEx()
@@ -336,6 +322,7 @@ extern "C" void __fail_fast()
 extern "C" bool RhInitialize();
 extern "C" void RhpEnableConservativeStackReporting();
 extern "C" void RhpShutdown();
+extern "C" void RhpRecordManagedMainBegin();
 extern "C" void RhSetRuntimeInitializationCallback(int (*fPtr)());
 
 #ifndef CPPCODEGEN
@@ -347,6 +334,10 @@ extern "C" bool RhRegisterOSModule(void * pModule,
 
 extern "C" void* PalGetModuleHandleFromPointer(void* pointer);
 
+#ifdef HAS_MANAGED_UNWIND_TABLE
+extern "C" void RhRegisterManagedUnwindTable(void * pvManagedCodeStartRange, void * pvUnwindTable, uint32_t cbUnwindTable);
+#endif
+
 #endif // !CPPCODEGEN
 
 extern "C" void GetRuntimeException();
@@ -354,6 +345,7 @@ extern "C" void FailFast();
 extern "C" void AppendExceptionStackFrame();
 extern "C" void GetSystemArrayEEType();
 extern "C" void OnFirstChanceException();
+extern "C" void AppendExceptionStackFrames();
 
 typedef void(*pfn)();
 
@@ -367,6 +359,7 @@ static const pfn c_classlibFunctions[] = {
     &OnFirstChanceException,
     nullptr, // &DebugFuncEvalHelper,
     nullptr, // &DebugFuncEvalAbortHelper,
+    &AppendExceptionStackFrames,
 };
 
 extern "C" void InitializeModules(void* osModule, void ** modules, int count, void ** pClasslibFunctions, int nClasslibFunctions);
@@ -404,6 +397,14 @@ static int InitializeRuntime()
     {
         return -1;
     }
+
+#ifdef HAS_MANAGED_UNWIND_TABLE
+    if (&__start___managedunwind != nullptr)
+    {
+        RhRegisterManagedUnwindTable((void*)&__managedcode_a,
+            (void*)&__start___managedunwind, (uint32_t)(&__stop___managedunwind - &__start___managedunwind));
+    }
+#endif
 #endif // !CPPCODEGEN
 
 #ifndef CPPCODEGEN
@@ -433,6 +434,8 @@ int main(int argc, char* argv[])
     if (initval != 0)
         return initval;
 
+    RhpRecordManagedMainBegin();
+
     int retval;
 #ifdef CPPCODEGEN
     try
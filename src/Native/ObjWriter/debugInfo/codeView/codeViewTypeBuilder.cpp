@@ -102,10 +102,17 @@ unsigned UserDefinedCodeViewTypesBuilder::GetClassTypeIndex(
       ClassDescriptor.IsStruct ? TypeRecordKind::Struct : TypeRecordKind::Class;
   ClassOptions CO = ClassOptions::ForwardReference | GetCommonClassOptions();
 
+  TypeRecordKey Key('c');
+  Key.Add(ClassDescriptor.Name).Add(ClassDescriptor.IsStruct);
+
+  unsigned SharedIndex;
+  if (FindSharedType(Key, &SharedIndex))
+    return SharedIndex;
+
   ClassRecord CR(Kind, 0, CO, TypeIndex(), TypeIndex(), TypeIndex(), 0,
                  ClassDescriptor.Name, StringRef());
   TypeIndex FwdDeclTI = TypeTable.writeKnownType(CR);
-  return FwdDeclTI.getIndex();
+  return AddSharedType(Key, FwdDeclTI.getIndex());
 }
 
 unsigned UserDefinedCodeViewTypesBuilder::GetCompleteClassTypeIndex(
@@ -228,14 +235,33 @@ unsigned UserDefinedCodeViewTypesBuilder::GetPointerTypeIndex(const PointerTypeD
     PointerMode pointerMode = PointerDescriptor.IsReference ? PointerMode::LValueReference : PointerMode::Pointer;
     PointerOptions pointerOptions = PointerDescriptor.IsConst ? PointerOptions::Const : PointerOptions::None;
 
+    TypeRecordKey Key('p');
+    Key.Add(elementType).Add(PointerDescriptor.Is64Bit).Add(PointerDescriptor.IsReference).Add(PointerDescriptor.IsConst);
+
+    unsigned SharedIndex;
+    if (FindSharedType(Key, &SharedIndex))
+        return SharedIndex;
+
     PointerRecord PointerToClass(TypeIndex(elementType), pointerKind, pointerMode, pointerOptions, 0);
     TypeIndex PointerIndex = TypeTable.writeKnownType(PointerToClass);
-    return PointerIndex.getIndex();
+    return AddSharedType(Key, PointerIndex.getIndex());
 }
 
 unsigned UserDefinedCodeViewTypesBuilder::GetMemberFunctionTypeIndex(const MemberFunctionTypeDescriptor& MemberDescriptor,
     uint32_t const *const ArgumentTypes)
 {
+    // Methods with the same signature on the same class share their type.
+    TypeRecordKey Key('f');
+    Key.Add(MemberDescriptor.ReturnType).Add(MemberDescriptor.ContainingClass)
+       .Add(MemberDescriptor.TypeIndexOfThisPointer).Add((uint64)(int64_t)MemberDescriptor.ThisAdjust)
+       .Add(MemberDescriptor.CallingConvention).Add(MemberDescriptor.NumberOfArguments);
+    for (uint16_t iArgument = 0; iArgument < MemberDescriptor.NumberOfArguments; iArgument++)
+        Key.Add(ArgumentTypes[iArgument]);
+
+    unsigned SharedIndex;
+    if (FindSharedType(Key, &SharedIndex))
+        return SharedIndex;
+
     std::vector<TypeIndex> argumentTypes;
     argumentTypes.reserve(MemberDescriptor.NumberOfArguments);
     for (uint16_t iArgument = 0; iArgument < MemberDescriptor.NumberOfArguments; iArgument++)
@@ -255,14 +281,21 @@ unsigned UserDefinedCodeViewTypesBuilder::GetMemberFunctionTypeIndex(const Membe
                                         MemberDescriptor.ThisAdjust);
 
     TypeIndex MemberFunctionIndex = TypeTable.writeKnownType(MemberFunction);
-    return MemberFunctionIndex.getIndex();
+    return AddSharedType(Key, MemberFunctionIndex.getIndex());
 }
 
 unsigned UserDefinedCodeViewTypesBuilder::GetMemberFunctionId(const MemberFunctionIdTypeDescriptor& MemberIdDescriptor)
 {
+    TypeRecordKey Key('i');
+    Key.Add(MemberIdDescriptor.MemberFunction).Add(MemberIdDescriptor.ParentClass).Add(MemberIdDescriptor.Name);
+
+    unsigned SharedIndex;
+    if (FindSharedType(Key, &SharedIndex))
+        return SharedIndex;
+
     MemberFuncIdRecord MemberFuncId(TypeIndex(MemberIdDescriptor.MemberFunction), TypeIndex(MemberIdDescriptor.ParentClass), MemberIdDescriptor.Name);
     TypeIndex MemberFuncIdIndex = TypeTable.writeKnownType(MemberFuncId);
-    return MemberFuncIdIndex.getIndex();
+    return AddSharedType(Key, MemberFuncIdIndex.getIndex());
 }
 
 unsigned UserDefinedCodeViewTypesBuilder::GetPrimitiveTypeIndex(PrimitiveTypeFlags Type) {
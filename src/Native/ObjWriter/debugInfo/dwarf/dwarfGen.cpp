@@ -552,7 +552,7 @@ public:
       MCSection *TypeSection, MCSection *StrSection) override;
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override {};
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override {};
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -673,13 +673,8 @@ void VarInfo::DumpLocsIfNeeded(MCObjectStreamer *Streamer,
   Streamer->EmitIntValue(0, TargetPointerSize);
 }
 
-void VarInfo::DumpStrings(MCObjectStreamer *Streamer) {
-  if (IsThis) {
-    Streamer->EmitBytes(StringRef("this"));
-  } else {
-    Streamer->EmitBytes(StringRef(DebugInfo.Name));
-  }
-  Streamer->EmitIntValue(0, 1);
+void VarInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
+  StrSymbol = TypeBuilder->EmitString(Streamer, IsThis ? StringRef("this") : StringRef(DebugInfo.Name));
 }
 
 void VarInfo::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
@@ -33,7 +33,7 @@ public:
   bool IsParam() const { return DebugInfo.IsParam; }
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -59,7 +59,7 @@ public:
       MCSection *TypeSection, MCSection *StrSection, MCSection *LocSection);
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override {}
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override {}
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -34,9 +34,7 @@ void DwarfInfo::Dump(UserDefinedDwarfTypesBuilder *TypeBuilder, MCObjectStreamer
   DumpTypes(TypeBuilder, Streamer, TypeSection, StrSection);
 
   Streamer->SwitchSection(StrSection);
-  StrSymbol = context.createTempSymbol();
-  Streamer->EmitLabel(StrSymbol);
-  DumpStrings(Streamer);
+  DumpStrings(Streamer, TypeBuilder);
 
   Streamer->SwitchSection(TypeSection);
   Streamer->EmitLabel(InfoSymbol);
@@ -137,7 +135,7 @@ static PrimitiveTypeDesc GetPrimitiveTypeDesc(PrimitiveTypeFlags Type, unsigned
   }
 }
 
-void DwarfPrimitiveTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
+void DwarfPrimitiveTypeInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
   MCContext &context = Streamer->getContext();
   unsigned TargetPointerSize = context.getAsmInfo()->getCodePointerSize();
 
@@ -145,8 +143,7 @@ void DwarfPrimitiveTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
   if (TD.Name == nullptr)
     return;
 
-  Streamer->EmitBytes(StringRef(TD.Name));
-  Streamer->EmitIntValue(0, 1);
+  StrSymbol = TypeBuilder->EmitString(Streamer, TD.Name);
 }
 
 void DwarfPrimitiveTypeInfo::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
@@ -172,9 +169,8 @@ void DwarfPrimitiveTypeInfo::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefine
 
 // DwarfEnumerator
 
-void DwarfEnumerator::DumpStrings(MCObjectStreamer *Streamer) {
-  Streamer->EmitBytes(Name);
-  Streamer->EmitIntValue(0, 1);
+void DwarfEnumerator::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
+  StrSymbol = TypeBuilder->EmitString(Streamer, Name);
 }
 
 void DwarfEnumerator::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
@@ -255,9 +251,8 @@ void DwarfEnumTypeInfo::Dump(UserDefinedDwarfTypesBuilder *TypeBuilder, MCObject
   Streamer->EmitIntValue(0, 1);
 }
 
-void DwarfEnumTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
-  Streamer->EmitBytes(Name);
-  Streamer->EmitIntValue(0, 1);
+void DwarfEnumTypeInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
+  StrSymbol = TypeBuilder->EmitString(Streamer, Name);
 }
 
 void DwarfEnumTypeInfo::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
@@ -279,9 +274,8 @@ void DwarfEnumTypeInfo::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwar
 
 // DwarfDataField
 
-void DwarfDataField::DumpStrings(MCObjectStreamer *Streamer) {
-  Streamer->EmitBytes(StringRef(Name));
-  Streamer->EmitIntValue(0, 1);
+void DwarfDataField::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
+  StrSymbol = TypeBuilder->EmitString(Streamer, Name);
 }
 
 void DwarfDataField::DumpTypes(UserDefinedDwarfTypesBuilder *TypeBuilder, MCObjectStreamer *Streamer,
@@ -403,9 +397,8 @@ void DwarfClassTypeInfo::Dump(UserDefinedDwarfTypesBuilder *TypeBuilder, MCObjec
   Streamer->EmitIntValue(0, 1);
 }
 
-void DwarfClassTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
-  Streamer->EmitBytes(StringRef(Name));
-  Streamer->EmitIntValue(0, 1);
+void DwarfClassTypeInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
+  StrSymbol = TypeBuilder->EmitString(Streamer, Name);
 }
 
 void DwarfClassTypeInfo::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
@@ -452,7 +445,7 @@ void DwarfSimpleArrayTypeInfo::DumpTypes(UserDefinedDwarfTypesBuilder *TypeBuild
   ElementInfo->Dump(TypeBuilder, Streamer, TypeSection, StrSection);
 }
 
-void DwarfSimpleArrayTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
+void DwarfSimpleArrayTypeInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
   // nothing to dump
 }
 
@@ -493,7 +486,7 @@ void DwarfPointerTypeInfo::DumpTypes(UserDefinedDwarfTypesBuilder *TypeBuilder,
   Info->Dump(TypeBuilder, Streamer, TypeSection, StrSection);
 }
 
-void DwarfPointerTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
+void DwarfPointerTypeInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
   // nothing to dump
 }
 
@@ -524,7 +517,7 @@ DwarfMemberFunctionTypeInfo::DwarfMemberFunctionTypeInfo(
   }
 }
 
-void DwarfMemberFunctionTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
+void DwarfMemberFunctionTypeInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
   // nothing to dump
 }
 
@@ -563,15 +556,9 @@ void DwarfMemberFunctionIdTypeInfo::DumpTypes(UserDefinedDwarfTypesBuilder *Type
   }
 }
 
-void DwarfMemberFunctionIdTypeInfo::DumpStrings(MCObjectStreamer *Streamer) {
-  Streamer->EmitBytes(StringRef(Name));
-  Streamer->EmitIntValue(0, 1);
-
-  MCContext &context = Streamer->getContext();
-  LinkageNameSymbol = context.createTempSymbol();
-  Streamer->EmitLabel(LinkageNameSymbol);
-  Streamer->EmitBytes(StringRef(LinkageName));
-  Streamer->EmitIntValue(0, 1);
+void DwarfMemberFunctionIdTypeInfo::DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
+  StrSymbol = TypeBuilder->EmitString(Streamer, Name);
+  LinkageNameSymbol = TypeBuilder->EmitString(Streamer, LinkageName);
 }
 
 void DwarfMemberFunctionIdTypeInfo::DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) {
@@ -634,6 +621,17 @@ void DwarfMemberFunctionIdTypeInfo::DumpTypeInfo(MCObjectStreamer *Streamer, Use
 
 // DwarfTypesBuilder
 
+MCSymbol *UserDefinedDwarfTypesBuilder::EmitString(MCObjectStreamer *Streamer, StringRef Str) {
+  MCSymbol *&Symbol = Strings[Str];
+  if (Symbol == nullptr) {
+    Symbol = Streamer->getContext().createTempSymbol();
+    Streamer->EmitLabel(Symbol);
+    Streamer->EmitBytes(Str);
+    Streamer->EmitIntValue(0, 1);
+  }
+  return Symbol;
+}
+
 void UserDefinedDwarfTypesBuilder::EmitTypeInformation(
     MCSection *TypeSection,
     MCSection *StrSection) {
@@ -653,9 +651,17 @@ unsigned UserDefinedDwarfTypesBuilder::GetEnumTypeIndex(
 
 unsigned UserDefinedDwarfTypesBuilder::GetClassTypeIndex(
     const ClassTypeDescriptor &ClassDescriptor) {
-  unsigned TypeIndex = ArrayIndexToTypeIndex(DwarfTypes.size());
+  TypeRecordKey Key('c');
+  Key.Add(ClassDescriptor.Name).Add(ClassDescriptor.IsStruct)
+     .Add(ClassDescriptor.BaseClassId).Add(ClassDescriptor.InstanceSize);
+
+  unsigned TypeIndex;
+  if (FindSharedType(Key, &TypeIndex))
+    return TypeIndex;
+
+  TypeIndex = ArrayIndexToTypeIndex(DwarfTypes.size());
   DwarfTypes.push_back(make_unique<DwarfClassTypeInfo>(ClassDescriptor));
-  return TypeIndex;
+  return AddSharedType(Key, TypeIndex);
 }
 
 unsigned UserDefinedDwarfTypesBuilder::GetCompleteClassTypeIndex(
@@ -713,18 +719,38 @@ unsigned UserDefinedDwarfTypesBuilder::GetArrayTypeIndex(
 
 unsigned UserDefinedDwarfTypesBuilder::GetPointerTypeIndex(const PointerTypeDescriptor& PointerDescriptor)
 {
-  unsigned TypeIndex = ArrayIndexToTypeIndex(DwarfTypes.size());
+  TypeRecordKey Key('p');
+  Key.Add(PointerDescriptor.ElementType).Add(PointerDescriptor.IsReference)
+     .Add(PointerDescriptor.IsConst).Add(PointerDescriptor.Is64Bit);
+
+  unsigned TypeIndex;
+  if (FindSharedType(Key, &TypeIndex))
+    return TypeIndex;
+
+  TypeIndex = ArrayIndexToTypeIndex(DwarfTypes.size());
   DwarfTypes.push_back(make_unique<DwarfPointerTypeInfo>(PointerDescriptor));
-  return TypeIndex;
+  return AddSharedType(Key, TypeIndex);
 }
 
 unsigned UserDefinedDwarfTypesBuilder::GetMemberFunctionTypeIndex(const MemberFunctionTypeDescriptor& MemberDescriptor,
     uint32_t const *const ArgumentTypes)
 {
-  unsigned TypeIndex = ArrayIndexToTypeIndex(DwarfTypes.size());
+  // Methods with the same signature on the same class share their type.
+  TypeRecordKey Key('f');
+  Key.Add(MemberDescriptor.ReturnType).Add(MemberDescriptor.ContainingClass)
+     .Add(MemberDescriptor.TypeIndexOfThisPointer).Add((uint64)(int64_t)MemberDescriptor.ThisAdjust)
+     .Add(MemberDescriptor.CallingConvention).Add(MemberDescriptor.NumberOfArguments);
+  for (uint16_t i = 0; i < MemberDescriptor.NumberOfArguments; i++)
+    Key.Add(ArgumentTypes[i]);
+
+  unsigned TypeIndex;
+  if (FindSharedType(Key, &TypeIndex))
+    return TypeIndex;
+
+  TypeIndex = ArrayIndexToTypeIndex(DwarfTypes.size());
   bool IsStatic = MemberDescriptor.TypeIndexOfThisPointer == GetPrimitiveTypeIndex(PrimitiveTypeFlags::Void);
   DwarfTypes.push_back(make_unique<DwarfMemberFunctionTypeInfo>(MemberDescriptor, ArgumentTypes, IsStatic));
-  return TypeIndex;
+  return AddSharedType(Key, TypeIndex);
 }
 
 unsigned UserDefinedDwarfTypesBuilder::GetMemberFunctionId(const MemberFunctionIdTypeDescriptor& MemberIdDescriptor)
@@ -765,7 +791,7 @@ unsigned UserDefinedDwarfTypesBuilder::GetPrimitiveTypeIndex(PrimitiveTypeFlags
 unsigned UserDefinedDwarfTypesBuilder::GetSimpleArrayTypeIndex(unsigned ElemIndex, unsigned Size) {
   auto Iter = SimpleArrayDwarfTypes.find(ElemIndex);
   if (Iter != SimpleArrayDwarfTypes.end()) {
-    auto CountMap = Iter->second;
+    auto &CountMap = Iter->second;
     auto CountIter = CountMap.find(Size);
     if (CountIter != CountMap.end())
       return CountIter->second;
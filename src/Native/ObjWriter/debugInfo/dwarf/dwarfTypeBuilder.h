@@ -11,6 +11,7 @@
 #pragma once
 
 #include "debugInfo/typeBuilder.h"
+#include "llvm/ADT/StringMap.h"
 
 #include <vector>
 #include <unordered_map>
@@ -39,7 +40,7 @@ public:
   const MCExpr *GetInfoExpr() { return InfoExpr; }
 
 protected:
-  virtual void DumpStrings(MCObjectStreamer *Streamer) = 0;
+  virtual void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) = 0;
   virtual void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) = 0;
 
   static void EmitSectionOffset(MCObjectStreamer *Streamer,
@@ -73,7 +74,7 @@ public:
   PrimitiveTypeFlags GetType() { return Type; }
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -89,7 +90,7 @@ public:
       Name(Descriptor.Name), Value(Descriptor.Value), EnumTypeInfo(TypeInfo) {}
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -113,7 +114,7 @@ public:
   uint8_t GetByteSize() const { return ByteSize; }
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -139,7 +140,7 @@ public:
   const std::string &GetName() const { return Name; }
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
   std::string Name;
@@ -202,7 +203,7 @@ public:
   const std::string &GetName() const { return Name; }
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -227,7 +228,7 @@ public:
       MCSection *TypeSection, MCSection *StrSection) override;
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -245,7 +246,7 @@ public:
       MCSection *TypeSection, MCSection *StrSection) override;
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -268,7 +269,7 @@ public:
   uint32_t GetThisPtrTypeIndex() const { return TypeDesc.TypeIndexOfThisPointer; }
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -298,7 +299,7 @@ public:
   bool IsStatic() const { return MemberFunctionTypeInfo->IsStatic(); }
 
 protected:
-  void DumpStrings(MCObjectStreamer *Streamer) override;
+  void DumpStrings(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
   void DumpTypeInfo(MCObjectStreamer *Streamer, UserDefinedDwarfTypesBuilder *TypeBuilder) override;
 
 private:
@@ -352,6 +353,10 @@ public:
 
   const std::vector<DwarfClassTypeInfo*> &GetClassesWithStaticFields() const { return ClassesWithStaticFields; }
 
+  // Emits a string to the current section the first time it is seen and returns the label of that copy.
+  // Types, members and locals share a handful of names, so .debug_str holds every one of them once.
+  MCSymbol *EmitString(MCObjectStreamer *Streamer, StringRef Str);
+
 private:
   static const unsigned StartTypeIndex = 1; // Make TypeIndex 0 - Invalid
   static unsigned TypeIndexToArrayIndex(unsigned TypeIndex) { return TypeIndex - StartTypeIndex; }
@@ -363,4 +368,6 @@ private:
   std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> SimpleArrayDwarfTypes;
 
   std::vector<DwarfClassTypeInfo*> ClassesWithStaticFields;
+
+  StringMap<MCSymbol*> Strings;
 };
\ No newline at end of file
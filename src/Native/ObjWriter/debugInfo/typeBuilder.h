@@ -13,6 +13,7 @@
 #include "llvm/MC/MCObjectStreamer.h"
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 using namespace llvm;
@@ -106,6 +107,31 @@ extern "C" struct MemberFunctionIdTypeDescriptor {
 };
 
 #pragma pack(pop)
+
+// The content of a type record, used to share structurally identical records.
+// It is made of the record kind and each field that makes up the record.
+class TypeRecordKey {
+public:
+  explicit TypeRecordKey(char Kind) : Key(1, Kind) {}
+
+  TypeRecordKey &Add(uint64 Value) {
+    Key.append(reinterpret_cast<const char *>(&Value), sizeof(Value));
+    return *this;
+  }
+
+  TypeRecordKey &Add(const char *Name) {
+    // Include the terminator so that adjacent names can't run into each other.
+    Key.append(Name != nullptr ? Name : "");
+    Key.push_back('\0');
+    return *this;
+  }
+
+  const std::string &Get() const { return Key; }
+
+private:
+  std::string Key;
+};
+
 class UserDefinedTypesBuilder {
 public:
   UserDefinedTypesBuilder() : Streamer(nullptr), TargetPointerSize(0) {}
@@ -151,8 +177,25 @@ public:
   }
 
 protected:
+  // Returns true and the type index of an earlier record with the same content.
+  bool FindSharedType(const TypeRecordKey &Key, unsigned *TypeIndex) const {
+    auto Iter = SharedTypes.find(Key.Get());
+    if (Iter == SharedTypes.end())
+      return false;
+    *TypeIndex = Iter->second;
+    return true;
+  }
+
+  unsigned AddSharedType(const TypeRecordKey &Key, unsigned TypeIndex) {
+    SharedTypes.insert(std::make_pair(Key.Get(), TypeIndex));
+    return TypeIndex;
+  }
+
   MCObjectStreamer *Streamer;
   unsigned TargetPointerSize;
 
   std::vector<std::pair<std::string, uint32_t>> UserDefinedTypes;
+
+private:
+  std::unordered_map<std::string, unsigned> SharedTypes;
 };
\ No newline at end of file
@@ -55,6 +55,17 @@
 using namespace llvm;
 using namespace llvm::codeview;
 
+// x64 DWARF register numbers used by the managed unwind table
+enum {
+  DWARF_REG_RBX = 3,
+  DWARF_REG_RBP = 6,
+  DWARF_REG_RSP = 7,
+  DWARF_REG_R12 = 12,
+  DWARF_REG_R13 = 13,
+  DWARF_REG_R14 = 14,
+  DWARF_REG_R15 = 15,
+};
+
 bool error(const Twine &Error) {
   errs() << Twine("error: ") + Error + "\n";
   return false;
@@ -161,6 +172,7 @@ bool ObjectWriter::Init(llvm::StringRef ObjectFilePath, const char* tripleName)
 
   FrameOpened = false;
   FuncId = 1;
+  ManagedUnwindTableEnabled = false;
 
   SetCodeSectionAttribute("text", CustomSectionAttributes_Executable, nullptr);
 
@@ -184,7 +196,144 @@ bool ObjectWriter::Init(llvm::StringRef ObjectFilePath, const char* tripleName)
   return true;
 }
 
-void ObjectWriter::Finish() { Streamer->Finish(); }
+void ObjectWriter::Finish() {
+  MergeStreams();
+
+  if (!ManagedUnwindFrames.empty()) {
+    EmitManagedUnwindTable();
+  }
+  Streamer->Finish();
+}
+
+ObjectWriterStream *ObjectWriter::CreateStream() {
+  std::lock_guard<std::mutex> Lock(StreamsLock);
+  Streams.emplace_back(new ObjectWriterStream());
+  return Streams.back().get();
+}
+
+void ObjectWriter::MergeStreams() {
+  std::vector<std::unique_ptr<ObjectWriterStream>> StreamsToMerge;
+  {
+    std::lock_guard<std::mutex> Lock(StreamsLock);
+    StreamsToMerge.swap(Streams);
+  }
+
+  for (const auto &Stream : StreamsToMerge) {
+    Stream->Replay(this);
+  }
+}
+
+size_t ObjectWriterStream::AddString(const char *String) {
+  if (String == nullptr)
+    return NoData;
+  return AddBlob(String, strlen(String) + 1);
+}
+
+size_t ObjectWriterStream::AddBlob(const char *Blob, size_t Size) {
+  size_t Offset = Data.size();
+  Data.insert(Data.end(), Blob, Blob + Size);
+  return Offset;
+}
+
+const char *ObjectWriterStream::GetData(size_t Offset) const {
+  return Offset == NoData ? nullptr : Data.data() + Offset;
+}
+
+void ObjectWriterStream::SwitchSection(const char *SectionName,
+                                       CustomSectionAttributes attributes,
+                                       const char *ComdatName) {
+  Commands.push_back({CommandKind::SwitchSection, attributes, 0, 0,
+                      AddString(SectionName), AddString(ComdatName)});
+}
+
+void ObjectWriterStream::EmitAlignment(int ByteAlignment) {
+  Commands.push_back({CommandKind::EmitAlignment, ByteAlignment, 0, 0, NoData, NoData});
+}
+
+void ObjectWriterStream::EmitBlob(int BlobSize, const char *Blob) {
+  Commands.push_back({CommandKind::EmitBlob, BlobSize, 0, 0,
+                      AddBlob(Blob, BlobSize), NoData});
+}
+
+void ObjectWriterStream::EmitIntValue(uint64_t Value, unsigned Size) {
+  Commands.push_back({CommandKind::EmitIntValue, (int32_t)Size, 0, Value, NoData, NoData});
+}
+
+void ObjectWriterStream::EmitSymbolDef(const char *SymbolName, bool global) {
+  Commands.push_back({CommandKind::EmitSymbolDef, global, 0, 0,
+                      AddString(SymbolName), NoData});
+}
+
+int ObjectWriterStream::EmitSymbolRef(const char *SymbolName,
+                                      RelocType RelocationType, int Delta) {
+  Commands.push_back({CommandKind::EmitSymbolRef, (int32_t)RelocationType, Delta, 0,
+                      AddString(SymbolName), NoData});
+
+  // Must match the size ObjectWriter::EmitSymbolRef emits.
+  switch (RelocationType) {
+  case RelocType::IMAGE_REL_BASED_DIR64:
+  case RelocType::IMAGE_REL_BASED_THUMB_MOV32:
+    return 8;
+  default:
+    return 4;
+  }
+}
+
+void ObjectWriterStream::EmitCFIStart(int Offset) {
+  Commands.push_back({CommandKind::EmitCFIStart, Offset, 0, 0, NoData, NoData});
+}
+
+void ObjectWriterStream::EmitCFIEnd(int Offset) {
+  Commands.push_back({CommandKind::EmitCFIEnd, Offset, 0, 0, NoData, NoData});
+}
+
+void ObjectWriterStream::EmitCFILsda(const char *LsdaBlobSymbolName) {
+  Commands.push_back({CommandKind::EmitCFILsda, 0, 0, 0,
+                      AddString(LsdaBlobSymbolName), NoData});
+}
+
+void ObjectWriterStream::EmitCFICode(int Offset, const char *Blob) {
+  Commands.push_back({CommandKind::EmitCFICode, Offset, 0, 0,
+                      AddBlob(Blob, sizeof(CFI_CODE)), NoData});
+}
+
+void ObjectWriterStream::Replay(ObjectWriter *OW) const {
+  for (const Command &C : Commands) {
+    switch (C.Kind) {
+    case CommandKind::SwitchSection:
+      OW->SwitchSection(GetData(C.DataOffset), (CustomSectionAttributes)C.IntArg,
+                        GetData(C.DataOffset2));
+      break;
+    case CommandKind::EmitAlignment:
+      OW->EmitAlignment(C.IntArg);
+      break;
+    case CommandKind::EmitBlob:
+      OW->EmitBlob(C.IntArg, GetData(C.DataOffset));
+      break;
+    case CommandKind::EmitIntValue:
+      OW->EmitIntValue(C.Value, (unsigned)C.IntArg);
+      break;
+    case CommandKind::EmitSymbolDef:
+      OW->EmitSymbolDef(GetData(C.DataOffset), C.IntArg != 0);
+      break;
+    case CommandKind::EmitSymbolRef:
+      OW->EmitSymbolRef(GetData(C.DataOffset), (RelocType)C.IntArg, C.IntArg2);
+      break;
+    case CommandKind::EmitCFIStart:
+      OW->EmitCFIStart(C.IntArg);
+      break;
+    case CommandKind::EmitCFIEnd:
+      OW->EmitCFIEnd(C.IntArg);
+      break;
+    case CommandKind::EmitCFILsda:
+      OW->EmitCFILsda(GetData(C.DataOffset));
+      break;
+    case CommandKind::EmitCFICode:
+      OW->EmitCFICode(C.IntArg, GetData(C.DataOffset));
+      break;
+    }
+  }
+}
 
 void ObjectWriter::SwitchSection(const char *SectionName,
                                  CustomSectionAttributes attributes,
@@ -475,12 +624,34 @@ void ObjectWriter::EmitCFIStart(int Offset) {
   assert(!FrameOpened && "frame should be closed before CFIStart");
   Streamer->EmitCFIStartProc(false);
   FrameOpened = true;
+
+  if (ManagedUnwindTableEnabled) {
+    // The CIE defines CFA as RSP + 8 with the return address right below it.
+    ManagedUnwindFrame &Frame = CurrentUnwindFrame;
+    Frame.Start = OutContext->createTempSymbol();
+    Streamer->EmitLabel(Frame.Start);
+    Frame.End = nullptr;
+    Frame.Lsda = nullptr;
+    Frame.Section = Streamer->getCurrentSectionOnly();
+    Frame.StartOffset = Offset;
+    Frame.PrologSize = 0;
+    Frame.CfaRegister = DWARF_REG_RSP;
+    Frame.CfaOffset = 8;
+    memset(Frame.SavedRegisterOffsets, 0, sizeof(Frame.SavedRegisterOffsets));
+    Frame.IsSimple = true;
+  }
 }
 
 void ObjectWriter::EmitCFIEnd(int Offset) {
   assert(FrameOpened && "frame should be opened before CFIEnd");
   Streamer->EmitCFIEndProc();
   FrameOpened = false;
+
+  if (ManagedUnwindTableEnabled) {
+    CurrentUnwindFrame.End = OutContext->createTempSymbol();
+    Streamer->EmitLabel(CurrentUnwindFrame.End);
+    ManagedUnwindFrames.push_back(CurrentUnwindFrame);
+  }
 }
 
 void ObjectWriter::EmitCFILsda(const char *LsdaBlobSymbolName) {
@@ -491,6 +662,10 @@ void ObjectWriter::EmitCFILsda(const char *LsdaBlobSymbolName) {
   Assembler->registerSymbol(*T);
   Streamer->EmitCFILsda(T, llvm::dwarf::Constants::DW_EH_PE_pcrel |
                                llvm::dwarf::Constants::DW_EH_PE_sdata4);
+
+  if (ManagedUnwindTableEnabled) {
+    CurrentUnwindFrame.Lsda = T;
+  }
 }
 
 void ObjectWriter::EmitCFICode(int Offset, const char *Blob) {
@@ -515,6 +690,150 @@ void ObjectWriter::EmitCFICode(int Offset, const char *Blob) {
     assert(false && "Unrecognized CFI");
     break;
   }
+
+  if (ManagedUnwindTableEnabled) {
+    TrackManagedUnwindCode(CfiCode, Offset);
+  }
+}
+
+// Index of a callee-saved register in ManagedUnwindFrame::SavedRegisterOffsets,
+// or -1 if the table can't describe it.
+static int GetManagedUnwindSavedRegisterIndex(int DwarfReg) {
+  switch (DwarfReg) {
+  case DWARF_REG_RBX:
+    return 0;
+  case DWARF_REG_RBP:
+    return 1;
+  case DWARF_REG_R12:
+  case DWARF_REG_R13:
+  case DWARF_REG_R14:
+  case DWARF_REG_R15:
+    return DwarfReg - DWARF_REG_R12 + 2;
+  default:
+    return -1;
+  }
+}
+
+void ObjectWriter::TrackManagedUnwindCode(const CFI_CODE *CfiCode, int Offset) {
+  ManagedUnwindFrame &Frame = CurrentUnwindFrame;
+
+  // Offset is relative to the start of the node, like the one passed to
+  // EmitCFIStart. Unwinding at a PC past the last CFI code only needs the
+  // final state of the frame.
+  int PrologSize = Offset - Frame.StartOffset;
+  if (PrologSize > Frame.PrologSize) {
+    Frame.PrologSize = PrologSize;
+  }
+
+  switch (CfiCode->CfiOpCode) {
+  case CFI_ADJUST_CFA_OFFSET:
+    Frame.CfaOffset += CfiCode->Offset;
+    break;
+  case CFI_REL_OFFSET: {
+    // The offset is relative to the current CFA register, make it relative
+    // to the CFA the same way MC does.
+    int Index = GetManagedUnwindSavedRegisterIndex(CfiCode->DwarfReg);
+    if (Index < 0) {
+      Frame.IsSimple = false;
+      break;
+    }
+    Frame.SavedRegisterOffsets[Index] = CfiCode->Offset - Frame.CfaOffset;
+    break;
+  }
+  case CFI_DEF_CFA_REGISTER:
+    if (CfiCode->DwarfReg != DWARF_REG_RSP &&
+        CfiCode->DwarfReg != DWARF_REG_RBP) {
+      Frame.IsSimple = false;
+    }
+    Frame.CfaRegister = CfiCode->DwarfReg;
+    break;
+  default:
+    Frame.IsSimple = false;
+    break;
+  }
+}
+
+void ObjectWriter::EnableManagedUnwindTable() {
+  // The table format only describes x64 frames.
+  if (ObjFileInfo->getObjectFileType() == ObjFileInfo->IsELF &&
+      GetTriple().getArch() == Triple::x86_64) {
+    ManagedUnwindTableEnabled = true;
+  }
+}
+
+void ObjectWriter::EnableCompressedDebugSections() {
+  // The ELF writer compresses the .debug_* sections into SHF_COMPRESSED ones
+  // when it writes them. COFF has no compressed sections, the linker reads
+  // the CodeView records to build the PDB.
+  if (ObjFileInfo->getObjectFileType() == ObjFileInfo->IsELF &&
+      zlib::isAvailable()) {
+    AsmInfo->setCompressDebugSections(DebugCompressionType::Z);
+  }
+}
+
+void ObjectWriter::EmitRelPtr32(const MCSymbol *Target) {
+  MCSymbol *Here = OutContext->createTempSymbol();
+  Streamer->EmitLabel(Here);
+  EmitLabelDiff(Here, Target, 4);
+}
+
+// Emits the frames of managed code into the __managedunwind section as a table
+// of fixed-size entries sorted by address, so that the runtime can find the
+// unwind rules of managed methods with a binary search instead of interpreting
+// .eh_frame. Each entry is laid out as follows; keep in sync with
+// ManagedUnwindTableEntry in UnixNativeCodeManager.cpp:
+//
+//   int32  Frame start, relative to the field
+//   uint32 Frame length
+//   int32  LSDA, relative to the field
+//   int32  CFA offset from the CFA register
+//   uint8  Prolog size; the rules only apply past the prolog
+//   uint8  Frame kind: 0 CFA is RSP based, 1 CFA is RBP based, 0xFF the frame
+//          can only be unwound with .eh_frame
+//   uint16 Mask of the callee-saved registers saved by the frame (RBX, RBP,
+//          R12, R13, R14, R15)
+//   int16  CFA relative offsets of the saved registers, in the mask order
+//
+// Only frames placed in the managed code section are included. Frames are
+// emitted in the order they were written, which is their address order.
+void ObjectWriter::EmitManagedUnwindTable() {
+  MCSection *ManagedCodeSection = GetSpecificSection(
+      "__managedcode", CustomSectionAttributes_Executable, nullptr);
+
+  MCSection *Section = GetSpecificSection(
+      "__managedunwind", CustomSectionAttributes_ReadOnly, nullptr);
+  Streamer->SwitchSection(Section);
+  Streamer->EmitValueToAlignment(4);
+
+  for (const ManagedUnwindFrame &Frame : ManagedUnwindFrames) {
+    if (Frame.Section != ManagedCodeSection || Frame.Lsda == nullptr) {
+      continue;
+    }
+
+    bool IsSimple = Frame.IsSimple && Frame.PrologSize <= 0xFF;
+    uint8_t FrameKind = !IsSimple ? 0xFF
+                        : (Frame.CfaRegister == DWARF_REG_RBP) ? 1 : 0;
+
+    uint16_t SavedRegisterMask = 0;
+    for (int I = 0; I < 6; I++) {
+      if (Frame.SavedRegisterOffsets[I] != 0) {
+        SavedRegisterMask |= (1 << I);
+      }
+    }
+
+    EmitRelPtr32(Frame.Start);
+    EmitLabelDiff(Frame.Start, Frame.End, 4);
+    EmitRelPtr32(Frame.Lsda);
+    Streamer->EmitIntValue(Frame.CfaOffset, 4);
+    Streamer->EmitIntValue(IsSimple ? Frame.PrologSize : 0, 1);
+    Streamer->EmitIntValue(FrameKind, 1);
+    Streamer->EmitIntValue(SavedRegisterMask, 2);
+    for (int I = 0; I < 6; I++) {
+      Streamer->EmitIntValue((uint16_t)(int16_t)Frame.SavedRegisterOffsets[I], 2);
+    }
+  }
+
+  ManagedUnwindFrames.clear();
 }
 
 void ObjectWriter::EmitLabelDiff(const MCSymbol *From, const MCSymbol *To,
@@ -19,6 +19,8 @@
 #include "jitDebugInfo.h"
 #include <string>
 #include <set>
+#include <memory>
+#include <mutex>
 #include "debugInfo/typeBuilder.h"
 #include "debugInfo/dwarf/dwarfGen.h"
 
@@ -57,11 +59,75 @@ enum class RelocType {
   IMAGE_REL_BASED_RELPTR32 = 0x7C,
 };
 
+class ObjectWriter;
+
+// A recording of object writer calls that can be made on any thread. The
+// MCStreamer is not thread safe, so streams don't touch it or the MCContext;
+// they are replayed into the object writer in the order they were created by
+// MergeStreams, or at the latest by Finish. Each stream must only be used by
+// one thread at a time and ends with no open frame.
+class ObjectWriterStream {
+public:
+  void SwitchSection(const char *SectionName,
+                     CustomSectionAttributes attributes,
+                     const char *ComdatName);
+  void EmitAlignment(int ByteAlignment);
+  void EmitBlob(int BlobSize, const char *Blob);
+  void EmitIntValue(uint64_t Value, unsigned Size);
+  void EmitSymbolDef(const char *SymbolName, bool global);
+  int EmitSymbolRef(const char *SymbolName, RelocType RelocType, int Delta);
+  void EmitCFIStart(int Offset);
+  void EmitCFIEnd(int Offset);
+  void EmitCFILsda(const char *LsdaBlobSymbolName);
+  void EmitCFICode(int Offset, const char *Blob);
+
+  void Replay(ObjectWriter *OW) const;
+
+private:
+  enum class CommandKind : uint8_t {
+    SwitchSection,
+    EmitAlignment,
+    EmitBlob,
+    EmitIntValue,
+    EmitSymbolDef,
+    EmitSymbolRef,
+    EmitCFIStart,
+    EmitCFIEnd,
+    EmitCFILsda,
+    EmitCFICode,
+  };
+
+  // Strings and blobs are kept in Data and referred to by offset, since Data
+  // moves as it grows.
+  static const size_t NoData = ~(size_t)0;
+
+  struct Command {
+    CommandKind Kind;
+    int32_t IntArg;
+    int32_t IntArg2;
+    uint64_t Value;
+    size_t DataOffset;
+    size_t DataOffset2;
+  };
+
+  size_t AddString(const char *String);
+  size_t AddBlob(const char *Blob, size_t Size);
+  const char *GetData(size_t Offset) const;
+
+  std::vector<Command> Commands;
+  std::vector<char> Data;
+};
+
 class ObjectWriter {
 public:
   bool Init(StringRef FunctionName, const char* tripleName = nullptr);
   void Finish();
 
+  // Creates a stream that can be filled on another thread, see ObjectWriterStream.
+  ObjectWriterStream *CreateStream();
+  // Replays all streams created so far into the streamer and frees them.
+  void MergeStreams();
+
   void SwitchSection(const char *SectionName,
                      CustomSectionAttributes attributes,
                      const char *ComdatName);
@@ -92,6 +158,9 @@ public:
   void EmitCFILsda(const char *LsdaBlobSymbolName);
   void EmitCFICode(int Offset, const char *Blob);
 
+  void EnableManagedUnwindTable();
+  void EnableCompressedDebugSections();
+
   unsigned GetEnumTypeIndex(const EnumTypeDescriptor &TypeDescriptor,
                             const EnumRecordTypeDescriptor *TypeRecords);
   unsigned GetClassTypeIndex(const ClassTypeDescriptor &ClassDescriptor);
@@ -154,6 +223,10 @@ private:
                               bool IsPCRel = false, int Size = 0);
   void EmitARMExIdxPerOffset();
 
+  void TrackManagedUnwindCode(const CFI_CODE *CfiCode, int Offset);
+  void EmitRelPtr32(const MCSymbol *Target);
+  void EmitManagedUnwindTable();
+
 
 private:
   std::unique_ptr<MCRegisterInfo> RegisterInfo;
@@ -185,6 +258,27 @@ private:
   MCObjectStreamer *Streamer; // Owned by AsmPrinter
 
   SmallVector<CFI_CODE, 32> CFIsPerOffset;
+
+  // Frame state tracked for the managed unwind table, see EmitManagedUnwindTable.
+  struct ManagedUnwindFrame {
+    MCSymbol *Start;
+    MCSymbol *End;
+    MCSymbol *Lsda;
+    MCSection *Section;
+    int StartOffset;
+    int PrologSize;
+    int CfaRegister;
+    int CfaOffset;
+    int SavedRegisterOffsets[6];
+    bool IsSimple;
+  };
+
+  bool ManagedUnwindTableEnabled;
+  ManagedUnwindFrame CurrentUnwindFrame;
+  std::vector<ManagedUnwindFrame> ManagedUnwindFrames;
+
+  std::mutex StreamsLock;
+  std::vector<std::unique_ptr<ObjectWriterStream>> Streams;
 };
 
 // When object writer is created/initialized successfully, it is returned.
@@ -272,6 +366,79 @@ DLL_EXPORT STDMETHODCALLTYPE void EmitCFICode(ObjectWriter *OW, int Offset, cons
   OW->EmitCFICode(Offset, Blob);
 }
 
+DLL_EXPORT STDMETHODCALLTYPE ObjectWriterStream *CreateObjWriterStream(ObjectWriter *OW) {
+  assert(OW && "ObjWriter is null");
+  return OW->CreateStream();
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void MergeObjWriterStreams(ObjectWriter *OW) {
+  assert(OW && "ObjWriter is null");
+  OW->MergeStreams();
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamSwitchSection(ObjectWriterStream *OWS, const char *SectionName,
+                                                      CustomSectionAttributes attributes,
+                                                      const char *ComdatName) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->SwitchSection(SectionName, attributes, ComdatName);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitAlignment(ObjectWriterStream *OWS, int ByteAlignment) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitAlignment(ByteAlignment);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitBlob(ObjectWriterStream *OWS, int BlobSize, const char *Blob) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitBlob(BlobSize, Blob);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitIntValue(ObjectWriterStream *OWS, uint64_t Value, unsigned Size) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitIntValue(Value, Size);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitSymbolDef(ObjectWriterStream *OWS, const char *SymbolName, bool global) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitSymbolDef(SymbolName, global);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE int StreamEmitSymbolRef(ObjectWriterStream *OWS, const char *SymbolName,
+                                                     RelocType RelocType, int Delta) {
+  assert(OWS && "ObjWriter stream is null");
+  return OWS->EmitSymbolRef(SymbolName, RelocType, Delta);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitCFIStart(ObjectWriterStream *OWS, int Offset) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitCFIStart(Offset);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitCFIEnd(ObjectWriterStream *OWS, int Offset) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitCFIEnd(Offset);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitCFILsda(ObjectWriterStream *OWS, const char *LsdaBlobSymbolName) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitCFILsda(LsdaBlobSymbolName);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void StreamEmitCFICode(ObjectWriterStream *OWS, int Offset, const char *Blob) {
+  assert(OWS && "ObjWriter stream is null");
+  OWS->EmitCFICode(Offset, Blob);
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void EnableManagedUnwindTable(ObjectWriter *OW) {
+  assert(OW && "ObjWriter is null");
+  OW->EnableManagedUnwindTable();
+}
+
+DLL_EXPORT STDMETHODCALLTYPE void EnableCompressedDebugSections(ObjectWriter *OW) {
+  assert(OW && "ObjWriter is null");
+  OW->EnableCompressedDebugSections();
+}
+
 DLL_EXPORT STDMETHODCALLTYPE void EmitDebugFileInfo(ObjectWriter *OW, int FileId,
                                   const char *FileName) {
   assert(OW && "ObjWriter is null");
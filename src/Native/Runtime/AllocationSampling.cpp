@@ -0,0 +1,223 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "common.h"
+#include "gcenv.h"
+#include "gcheaputilities.h"
+#include "gcrhinterface.h"
+#include "slist.h"
+#include "varint.h"
+#include "regdisplay.h"
+#include "StackFrameIterator.h"
+#include "thread.h"
+#include "holder.h"
+#include "RWLock.h"
+#include "threadstore.h"
+#include "threadstore.inl"
+#include "thread.inl"
+#include "RhConfig.h"
+
+#include "AllocationSampling.h"
+
+#undef min
+#undef max
+#include <cmath>
+
+//
+// Each thread owns an AllocationSampler that is created the first time one of its allocations is sampled. The
+// sample buffer is a single-producer single-consumer ring: only the owning thread writes samples and advances
+// m_iWrite, and only a drainer holding g_AllocationSamplingLock advances m_iRead. When the ring is full new
+// samples are dropped (and counted) rather than overwriting ones that a drainer may be copying.
+//
+#define ALLOCATION_SAMPLE_BUFFER_SIZE   64
+
+struct AllocationSampler
+{
+    Int64               m_cbUntilNextSample;
+    UInt64              m_cbLastAllocated;          // Allocation context byte count at the previous check
+    UInt32              m_uRandomState;
+    UInt32 volatile     m_iWrite;
+    UInt32 volatile     m_iRead;
+    UInt32              m_cDropped;
+    AllocationSample    m_rgSamples[ALLOCATION_SAMPLE_BUFFER_SIZE];
+};
+
+bool g_fAllocationSamplingEnabled = false;
+
+static UInt32 g_cbAllocationSamplingInterval = 0;
+static UInt32 g_cAllocationSamplesDropped = 0;
+static CrstStatic g_AllocationSamplingLock;
+
+bool InitializeAllocationSampling()
+{
+    g_AllocationSamplingLock.Init(CrstAllocationSampling, CRST_DEFAULT);
+
+    g_cbAllocationSamplingInterval = g_pRhConfig->GetAllocationSamplingInterval();
+    g_fAllocationSamplingEnabled = g_cbAllocationSamplingInterval != 0;
+
+    return true;
+}
+
+// Returns the number of bytes to the next sample, drawn from an exponential distribution whose mean is the
+// configured sampling interval. This makes the sampling points a Poisson process over the allocated bytes.
+static Int64 GetNextSampleDistance(AllocationSampler * pSampler)
+{
+    // xorshift32, the state is never zero
+    UInt32 x = pSampler->m_uRandomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pSampler->m_uRandomState = x;
+
+    // Map to (0, 1] so that the logarithm is finite.
+    double u = ((double)(x >> 8) + 1.0) / (double)(1 << 24);
+    double distance = -std::log(u) * (double)g_cbAllocationSamplingInterval;
+
+    return (distance < 1.0) ? 1 : (Int64)distance;
+}
+
+static AllocationSampler * GetOrCreateAllocationSampler(Thread * pThread)
+{
+    AllocationSampler * pSampler = (AllocationSampler *)pThread->GetAllocationSampler();
+    if (pSampler != NULL)
+        return pSampler;
+
+    pSampler = new (nothrow) AllocationSampler();
+    if (pSampler == NULL)
+        return NULL;
+
+    pSampler->m_uRandomState = (UInt32)pThread->GetPalThreadIdForLogging() ^ (UInt32)(size_t)pSampler;
+    if (pSampler->m_uRandomState == 0)
+        pSampler->m_uRandomState = 1;
+    pSampler->m_cbUntilNextSample = GetNextSampleDistance(pSampler);
+
+    pThread->SetAllocationSampler(pSampler);
+    return pSampler;
+}
+
+static UInt32 CaptureAllocationStack(void ** rgFrames)
+{
+    UInt32 cFrames = 0;
+
+    StackFrameIterator frameIterator;
+    frameIterator.InitForStackTrace();
+    while (frameIterator.IsValid() && (cFrames < ALLOCATION_SAMPLE_MAX_FRAMES))
+    {
+        rgFrames[cFrames++] = (void *)frameIterator.GetRegisterSet()->GetIP();
+        frameIterator.Next();
+    }
+
+    return cFrames;
+}
+
+void SampleAllocation(Thread * pThread, EEType * pEEType, size_t cbSize, void * pTransitionFrame)
+{
+    ASSERT(g_fAllocationSamplingEnabled);
+
+    AllocationSampler * pSampler = GetOrCreateAllocationSampler(pThread);
+    if (pSampler == NULL)
+        return;
+
+    // The allocation context counts the bytes of every quantum it was given (less what was returned unused),
+    // which is what the fast path allocated from it since the previous check.
+    gc_alloc_context * pAllocContext = pThread->GetAllocContext();
+    UInt64 cbAllocated = (UInt64)(pAllocContext->alloc_bytes + pAllocContext->alloc_bytes_uoh);
+    Int64 cbSinceLastCheck = (Int64)(cbAllocated - pSampler->m_cbLastAllocated);
+    pSampler->m_cbLastAllocated = cbAllocated;
+
+    pSampler->m_cbUntilNextSample -= (cbSinceLastCheck > 0) ? cbSinceLastCheck : (Int64)cbSize;
+    if (pSampler->m_cbUntilNextSample > 0)
+        return;
+
+    // Several sampling points may have been passed at once; the sample then stands for all of them.
+    UInt64 cbSampledBytes = 0;
+    while (pSampler->m_cbUntilNextSample <= 0)
+    {
+        Int64 cbDistance = GetNextSampleDistance(pSampler);
+        pSampler->m_cbUntilNextSample += cbDistance;
+        cbSampledBytes += cbDistance;
+    }
+
+    UInt32 iWrite = pSampler->m_iWrite;
+    if (iWrite - pSampler->m_iRead >= ALLOCATION_SAMPLE_BUFFER_SIZE)
+    {
+        pSampler->m_cDropped++;
+        return;
+    }
+
+    AllocationSample * pSample = &pSampler->m_rgSamples[iWrite % ALLOCATION_SAMPLE_BUFFER_SIZE];
+    pSample->m_pEEType = pEEType;
+    pSample->m_cbSize = cbSize;
+    pSample->m_cbSampledBytes = cbSampledBytes;
+    pSample->m_uThreadId = pThread->GetPalThreadIdForLogging();
+    // Without a transition frame (portable helpers) the stack can't be walked.
+    pSample->m_cFrames = (pTransitionFrame != NULL) ? CaptureAllocationStack(pSample->m_rgFrames) : 0;
+
+    // Publish the sample only after its contents are written.
+    PalMemoryBarrier();
+    pSampler->m_iWrite = iWrite + 1;
+}
+
+void ReleaseAllocationSampler(Thread * pThread)
+{
+    AllocationSampler * pSampler = (AllocationSampler *)pThread->GetAllocationSampler();
+    if (pSampler == NULL)
+        return;
+
+    // The thread store lock is held for writing, so no drainer or other exiting thread can race with us.
+    g_cAllocationSamplesDropped += pSampler->m_cDropped + (pSampler->m_iWrite - pSampler->m_iRead);
+
+    pThread->SetAllocationSampler(NULL);
+    delete pSampler;
+}
+
+// Moves up to cMaxSamples pending allocation samples of all threads into pOutputBuffer and returns how many
+// were written. If pcDropped is not NULL it receives the number of samples lost so far because a thread's
+// buffer was full or the thread exited before being drained.
+EXTERN_C REDHAWK_API UInt32 __cdecl RhpGetAllocationSamples(AllocationSample * pOutputBuffer, UInt32 cMaxSamples, UInt32 * pcDropped)
+{
+    UInt32 cWritten = 0;
+
+    if (g_fAllocationSamplingEnabled)
+    {
+        CrstHolder lock(&g_AllocationSamplingLock);
+
+        UInt32 cDropped = g_cAllocationSamplesDropped;
+
+        // Walking the thread store keeps threads (and their samplers) from being destroyed under us.
+        FOREACH_THREAD(pThread)
+        {
+            AllocationSampler * pSampler = (AllocationSampler *)pThread->GetAllocationSampler();
+            if (pSampler == NULL)
+                continue;
+
+            UInt32 iRead = pSampler->m_iRead;
+            UInt32 iWrite = pSampler->m_iWrite;
+
+            // Don't read the samples before the index that publishes them.
+            PalMemoryBarrier();
+
+            while ((iRead != iWrite) && (cWritten < cMaxSamples))
+            {
+                pOutputBuffer[cWritten++] = pSampler->m_rgSamples[iRead % ALLOCATION_SAMPLE_BUFFER_SIZE];
+                iRead++;
+            }
+
+            // Hand the slots back to the producer only once they are copied.
+            PalMemoryBarrier();
+            pSampler->m_iRead = iRead;
+
+            cDropped += pSampler->m_cDropped;
+        }
+        END_FOREACH_THREAD
+
+        if (pcDropped != NULL)
+            *pcDropped = cDropped;
+    }
+    else if (pcDropped != NULL)
+    {
+        *pcDropped = 0;
+    }
+
+    return cWritten;
+}
@@ -0,0 +1,39 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Sampling allocation profiler. When the AllocationSamplingInterval runtime configuration value is set, each
+// thread picks allocations about once every that many bytes (the distance between samples is exponentially
+// distributed so that samples are not biased by allocation patterns) and records the type, size and the
+// managed stack of the allocation into a per-thread ring buffer that is drained by RhpGetAllocationSamples.
+//
+
+#pragma once
+
+#define ALLOCATION_SAMPLE_MAX_FRAMES    16
+
+// A sampled allocation, returned by RhpGetAllocationSamples.
+struct AllocationSample
+{
+    EEType *    m_pEEType;                                  // Type of the sampled object
+    UInt64      m_cbSize;                                   // Size of the sampled object in bytes
+    UInt64      m_cbSampledBytes;                           // Bytes of allocation this sample stands for
+    UInt64      m_uThreadId;                                // Thread that allocated the object
+    UInt32      m_cFrames;                                  // Number of valid entries in m_rgFrames
+    void *      m_rgFrames[ALLOCATION_SAMPLE_MAX_FRAMES];   // Return addresses, innermost frame first
+};
+
+class Thread;
+
+bool InitializeAllocationSampling();
+
+// Called on the allocation slow path after the object has been allocated. The fast path only sees the
+// allocation context being exhausted, so the bytes to the next sample are counted at allocation context
+// granularity, and the allocation that crosses a sampling point is the one that gets recorded.
+void SampleAllocation(Thread * pThread, EEType * pEEType, size_t cbSize, void * pTransitionFrame);
+
+// Frees the sampling state of a thread that is going away. Samples that were not drained yet are lost.
+void ReleaseAllocationSampler(Thread * pThread);
+
+extern bool g_fAllocationSamplingEnabled;
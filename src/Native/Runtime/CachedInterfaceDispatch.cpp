@@ -25,6 +25,7 @@
 #include "eetype.h"
 #include "Range.h"
 #include "allocheap.h"
+#include "NativeMemory.h"
 #include "rhbinder.h"
 #include "ObjectLayout.h"
 #include "gcrhinterface.h"
@@ -32,41 +33,40 @@
 #include "RWLock.h"
 #include "TypeManager.h"
 #include "RuntimeInstance.h"
+#include "RhConfig.h"
+#include "regdisplay.h"
+#include "StackFrameIterator.h"
+#include "event.h"
+#include "thread.h"
+#include "threadstore.h"
+#include "threadstore.inl"
+#include "thread.inl"
 #include "eetype.inl"
 
 #include "CachedInterfaceDispatch.h"
 
-// We always allocate cache sizes with a power of 2 number of entries. We have a maximum size we support,
-// defined below.
-#define CID_MAX_CACHE_SIZE_LOG2 6
-#define CID_MAX_CACHE_SIZE      (1 << CID_MAX_CACHE_SIZE_LOG2)
+// Interface dispatch statistics. These are cheap enough to support in retail builds: when collection is
+// disabled each counter update costs a single predictable branch. When enabled we update one of a set of
+// cache-line sized stripes selected by the current processor number to avoid contention between CPUs. The
+// updates are not interlocked (a thread may be migrated between reading the processor number and updating
+// the stripe) so an occasional increment may be lost; this is acceptable for the statistical purposes these
+// counters serve.
+#define CID_STATS_STRIPE_COUNT  64
 
-//#define FEATURE_CID_STATS 1
-
-#ifdef FEATURE_CID_STATS
-
-// Some counters used for debugging and profiling the algorithms.
-extern "C"
+struct DECLSPEC_ALIGN(64) CidStatsStripe
 {
-    UInt32 CID_g_cLoadVirtFunc = 0;
-    UInt32 CID_g_cCacheMisses = 0;
-    UInt32 CID_g_cCacheSizeOverflows = 0;
-    UInt32 CID_g_cCacheOutOfMemory = 0;
-    UInt32 CID_g_cCacheReallocates = 0;
-    UInt32 CID_g_cCacheAllocates = 0;
-    UInt32 CID_g_cCacheDiscards = 0;
-    UInt32 CID_g_cInterfaceDispatches = 0;
-    UInt32 CID_g_cbMemoryAllocated = 0;
-    UInt32 CID_g_rgAllocatesBySize[CID_MAX_CACHE_SIZE_LOG2 + 1] = { 0 };
+    InterfaceDispatchStats m_stats;
 };
 
-#define CID_COUNTER_INC(_counter_name) CID_g_c##_counter_name++
-
-#else
+static CidStatsStripe g_rgCidStatsStripes[CID_STATS_STRIPE_COUNT];
+static bool g_fCidStatsEnabled = false;
 
-#define CID_COUNTER_INC(_counter_name)
+static InterfaceDispatchStats * GetCidStatsStripe()
+{
+    return &g_rgCidStatsStripes[PalGetCurrentProcessorNumber() % CID_STATS_STRIPE_COUNT].m_stats;
+}
 
-#endif // FEATURE_CID_STATS
+#define CID_COUNTER_INC(_counter_name) do { if (g_fCidStatsEnabled) GetCidStatsStripe()->m_c##_counter_name++; } while (0)
 
 // Helper function for updating two adjacent pointers (which are aligned on a double pointer-sized boundary)
 // atomically.
@@ -185,9 +185,20 @@ static InterfaceDispatchCache * UpdateCellStubAndCache(InterfaceDispatchCell * p
 // Instead we link them into a global list and then at the next GC (when no code can hold a reference to these
 // any more) we can place them on one of several free lists based on their size.
 //
+// To avoid discarded caches piling up between GCs (and lengthening the GC pause that sorts them) we also
+// reclaim them incrementally using a simple epoch scheme. Once enough caches have been discarded the list is
+// sealed into a pending batch and the global epoch is advanced. Threads report passing through the new epoch
+// whenever they enter RhpUpdateDispatchCellCache (at which point they can't be holding any cache pointer
+// loaded by a dispatch stub). When every thread has either reported the epoch or is observed in preemptive
+// mode the pending batch can't be referenced any more and is returned to the free lists without waiting for
+// a GC. Threads that stay in cooperative mode without missing in a cache simply delay the batch until the
+// next GC, which reclaims everything as before.
+//
 
 #if defined(HOST_AMD64) || defined(HOST_ARM64)
 
+typedef InterfaceDispatchCache DiscardedCacheListEntry;
+
 // Head of the list of discarded cache blocks that can't be re-used just yet.
 InterfaceDispatchCache * g_pDiscardedCacheList; // for AMD64 and ARM64, m_pCell is not used and we can link the discarded blocks themselves
 
@@ -205,8 +216,24 @@ static DiscardedCacheBlock * g_pDiscardedCacheList = NULL;
 // Free list of DiscardedCacheBlock items
 static DiscardedCacheBlock * g_pDiscardedCacheFree = NULL;
 
+typedef DiscardedCacheBlock DiscardedCacheListEntry;
+
 #endif // defined(HOST_AMD64) || defined(HOST_ARM64)
 
+// Number of caches added to g_pDiscardedCacheList since it was last emptied.
+static UInt32 g_cDiscardedCaches = 0;
+
+// Batch of discarded caches waiting for all threads to pass through g_uPendingCacheEpoch.
+static DiscardedCacheListEntry * g_pPendingCacheList = NULL;
+static UInt32 g_uPendingCacheEpoch = 0;
+
+// The current reclamation epoch and a flag ensuring a single thread at a time drives reclamation.
+static UInt32 volatile g_uCacheEpoch = 0;
+static Int32 volatile g_fCacheReclaimInProgress = 0;
+
+// Number of discarded caches that triggers sealing a new pending batch.
+#define CID_RECLAIM_BATCH_THRESHOLD 32
+
 // Free lists for each cache size up to the maximum. We allocate from these in preference to new memory.
 static InterfaceDispatchCache * g_rgFreeLists[CID_MAX_CACHE_SIZE_LOG2 + 1];
 
@@ -307,11 +334,16 @@ static UIntNative AllocateCache(UInt32 cCacheEntries, InterfaceDispatchCache * p
         if (pCache == NULL)
             return NULL;
 
-        CID_COUNTER_INC(CacheAllocates);
-#ifdef FEATURE_CID_STATS
-        CID_g_cbMemoryAllocated += sizeof(InterfaceDispatchCacheEntry) * cCacheEntries;
-        CID_g_rgAllocatesBySize[idxCacheSize]++;
-#endif
+        NativeMemoryAdd(NativeMemoryKind_InterfaceDispatch,
+                        sizeof(InterfaceDispatchCache) + (sizeof(InterfaceDispatchCacheEntry) * cCacheEntries));
+
+        if (g_fCidStatsEnabled)
+        {
+            InterfaceDispatchStats * pStats = GetCidStatsStripe();
+            pStats->m_cCacheAllocates++;
+            pStats->m_cbMemoryAllocated += sizeof(InterfaceDispatchCacheEntry) * cCacheEntries;
+            pStats->m_rgAllocatesBySize[idxCacheSize]++;
+        }
     }
 
     // We have a cache block, now initialize it.
@@ -365,9 +397,15 @@ static void DiscardCache(InterfaceDispatchCache * pCache)
     // instead, allocate an auxiliary node (with its own auxiliary free list)
     DiscardedCacheBlock * pDiscardedCacheBlock = g_pDiscardedCacheFree;
     if (pDiscardedCacheBlock != NULL)
+    {
         g_pDiscardedCacheFree = pDiscardedCacheBlock->m_pNext;
+    }
     else
+    {
         pDiscardedCacheBlock = (DiscardedCacheBlock *)g_pAllocHeap->Alloc(sizeof(DiscardedCacheBlock));
+        if (pDiscardedCacheBlock != NULL)
+            NativeMemoryAdd(NativeMemoryKind_InterfaceDispatch, sizeof(DiscardedCacheBlock));
+    }
 
     if (pDiscardedCacheBlock != NULL) // if we did NOT get the memory, we leak the discarded block
     {
@@ -377,19 +415,18 @@ static void DiscardCache(InterfaceDispatchCache * pCache)
         g_pDiscardedCacheList = pDiscardedCacheBlock;
     }
 #endif // defined(HOST_AMD64) || defined(HOST_ARM64)
+
+    g_cDiscardedCaches++;
 }
 
-// Called during a GC to empty the list of discarded caches (which we can now guarantee aren't being accessed)
-// and sort the results into the free lists we maintain for each cache size.
-void ReclaimUnusedInterfaceDispatchCaches()
+// Sorts a list of discarded caches (which we can guarantee aren't being accessed any more) into the free
+// lists we maintain for each cache size. The caller must either hold g_sListLock or be running during a GC.
+static void ReturnDiscardedCachesToFreeLists(DiscardedCacheListEntry * pList)
 {
-    // No need for any locks, we're not racing with any other threads any more.
-
-    // Walk the list of discarded caches.
 #if defined(HOST_AMD64) || defined(HOST_ARM64)
 
     // on AMD64, this is threaded directly through the cache blocks
-    InterfaceDispatchCache * pCache = g_pDiscardedCacheList;
+    InterfaceDispatchCache * pCache = pList;
     while (pCache)
     {
         InterfaceDispatchCache * pNextCache = pCache->m_pNextFree;
@@ -407,7 +444,7 @@ void ReclaimUnusedInterfaceDispatchCaches()
 #else // defined(HOST_AMD64) || defined(HOST_ARM64)
 
     // on other architectures, we use an auxiliary list instead
-    DiscardedCacheBlock * pDiscardedCacheBlock = g_pDiscardedCacheList;
+    DiscardedCacheBlock * pDiscardedCacheBlock = pList;
     while (pDiscardedCacheBlock)
     {
         InterfaceDispatchCache * pCache = pDiscardedCacheBlock->m_pCache;
@@ -427,9 +464,462 @@ void ReclaimUnusedInterfaceDispatchCaches()
     }
 
 #endif // defined(HOST_AMD64) || defined(HOST_ARM64)
+}
+
+// Attempts to make progress on reclaiming discarded caches without waiting for a GC. Called from
+// RhpUpdateDispatchCellCache once the current thread has reported the current epoch.
+static void TryReclaimDiscardedCaches(Thread * pCurrentThread)
+{
+    // Cheap unsynchronized check so the common case costs nothing.
+    if ((g_pPendingCacheList == NULL) && (g_cDiscardedCaches < CID_RECLAIM_BATCH_THRESHOLD))
+        return;
+
+    if (PalInterlockedCompareExchange(&g_fCacheReclaimInProgress, 1, 0) != 0)
+        return;
+
+    if (g_pPendingCacheList == NULL)
+    {
+        // Seal the currently discarded caches into a new batch tagged with a new epoch. Every cache in the
+        // batch has already been unlinked from its dispatch cell so no code can pick up a new reference to
+        // it; we just have to wait out the threads that may have loaded it before that.
+        CrstHolder lh(&g_sListLock);
+
+        if (g_cDiscardedCaches >= CID_RECLAIM_BATCH_THRESHOLD)
+        {
+            g_pPendingCacheList = g_pDiscardedCacheList;
+            g_pDiscardedCacheList = NULL;
+            g_cDiscardedCaches = 0;
+
+            g_uPendingCacheEpoch = g_uCacheEpoch + 1;
+            g_uCacheEpoch = g_uPendingCacheEpoch;
+        }
+    }
+    else
+    {
+        // Ensure the transition frame state of all other threads is current before we examine it (this is
+        // the same requirement the thread suspension logic has).
+        PalFlushProcessWriteBuffers();
+
+        bool fAllQuiescent = true;
+        FOREACH_THREAD(pThread)
+        {
+            if ((pThread != pCurrentThread) && !pThread->IsInterfaceDispatchQuiescent(g_uPendingCacheEpoch))
+            {
+                fAllQuiescent = false;
+                break;
+            }
+        }
+        END_FOREACH_THREAD
+
+        if (fAllQuiescent)
+        {
+            CrstHolder lh(&g_sListLock);
+
+            ReturnDiscardedCachesToFreeLists(g_pPendingCacheList);
+            g_pPendingCacheList = NULL;
+        }
+    }
+
+    pCurrentThread->NoteInterfaceDispatchQuiescent(g_uCacheEpoch);
+
+    g_fCacheReclaimInProgress = 0;
+}
+
+//
+// Megamorphic dispatch table.
+//
+// Cells whose cache has grown to CID_MAX_CACHE_SIZE entries and still miss are promoted into a single,
+// process-wide hash table keyed on the (cell, instance type) pair. RhpSearchDispatchCellCache consults this
+// table whenever the cell's own cache is full, so resolving such a call becomes a bounded probe rather than
+// a walk of the type's dispatch map.
+//
+// The table is open addressed with linear probing limited to CID_MEGAMORPHIC_MAX_PROBES slots. Readers take
+// no lock. Entries are only ever written once (under g_sMegamorphicLock) and are never removed, so a reader
+// that observes non-NULL values for all three fields of an entry has observed a complete mapping; a reader
+// racing with the initialization of an entry simply sees a miss. When an insertion can't find a free slot
+// within the probe limit the table is doubled in size. The replaced table may still be in use by readers,
+// so it's kept on a retired list until the next GC, in the same manner as discarded caches.
+//
+
+#define CID_MEGAMORPHIC_INITIAL_SIZE_LOG2   10
+#define CID_MEGAMORPHIC_MAX_SIZE_LOG2       20
+#define CID_MEGAMORPHIC_MAX_PROBES          16
+
+struct MegamorphicDispatchEntry
+{
+    InterfaceDispatchCell * volatile    m_pCell;
+    EEType * volatile                   m_pInstanceType;
+    void * volatile                     m_pTargetCode;
+};
+
+struct MegamorphicDispatchTable
+{
+    MegamorphicDispatchTable *  m_pNextRetired;
+    UInt32                      m_cEntriesMask;
+    MegamorphicDispatchEntry *  m_pEntries;
+
+    ~MegamorphicDispatchTable()
+    {
+        if (m_pEntries != NULL)
+            NativeMemoryRemove(NativeMemoryKind_InterfaceDispatch, GetSize(m_cEntriesMask + 1));
+
+        delete[] m_pEntries;
+    }
+
+    static UIntNative GetSize(UInt32 cEntries)
+    {
+        return sizeof(MegamorphicDispatchTable) + (sizeof(MegamorphicDispatchEntry) * cEntries);
+    }
+};
+
+// The current table (NULL until the first cell overflows) and the list of tables it has replaced.
+static MegamorphicDispatchTable * volatile g_pMegamorphicTable = NULL;
+static MegamorphicDispatchTable * g_pRetiredMegamorphicTables = NULL;
+
+// Lock serializing updates to the megamorphic table.
+static CrstStatic g_sMegamorphicLock;
+
+static UInt32 MegamorphicHash(InterfaceDispatchCell * pCell, EEType * pInstanceType)
+{
+    UInt32 hash = (UInt32)((UIntNative)pCell >> 3) * 0x9E3779B1;
+    hash ^= (UInt32)((UIntNative)pInstanceType >> 3);
+    return hash ^ (hash >> 15);
+}
+
+static void * LookupMegamorphicTable(MegamorphicDispatchTable * pTable, InterfaceDispatchCell * pCell, EEType * pInstanceType)
+{
+    UInt32 idx = MegamorphicHash(pCell, pInstanceType);
+    for (UInt32 i = 0; i < CID_MEGAMORPHIC_MAX_PROBES; i++, idx++)
+    {
+        MegamorphicDispatchEntry * pEntry = &pTable->m_pEntries[idx & pTable->m_cEntriesMask];
+
+        InterfaceDispatchCell * pEntryCell = pEntry->m_pCell;
+        if (pEntryCell == NULL)
+            return NULL;
+
+        if ((pEntryCell == pCell) && (pEntry->m_pInstanceType == pInstanceType))
+            return pEntry->m_pTargetCode;
+    }
+
+    return NULL;
+}
+
+// Attempts to place a mapping in the given table without growing it. The caller must hold g_sMegamorphicLock
+// or own the (not yet published) table.
+static bool InsertMegamorphicTable(MegamorphicDispatchTable * pTable, InterfaceDispatchCell * pCell, EEType * pInstanceType, void * pTargetCode)
+{
+    UInt32 idx = MegamorphicHash(pCell, pInstanceType);
+    for (UInt32 i = 0; i < CID_MEGAMORPHIC_MAX_PROBES; i++, idx++)
+    {
+        MegamorphicDispatchEntry * pEntry = &pTable->m_pEntries[idx & pTable->m_cEntriesMask];
+
+        if (pEntry->m_pCell == NULL)
+        {
+            // Initialize the entry key last so readers see either a miss or a complete entry.
+            pEntry->m_pTargetCode = pTargetCode;
+            pEntry->m_pInstanceType = pInstanceType;
+            PalMemoryBarrier();
+            pEntry->m_pCell = pCell;
+            return true;
+        }
+
+        if ((pEntry->m_pCell == pCell) && (pEntry->m_pInstanceType == pInstanceType))
+            return true;
+    }
+
+    return false;
+}
+
+static MegamorphicDispatchTable * AllocateMegamorphicTable(UInt32 cEntriesLog2)
+{
+    NewHolder<MegamorphicDispatchTable> pTable = new (nothrow) MegamorphicDispatchTable();
+    if (pTable == NULL)
+        return NULL;
+
+    UInt32 cEntries = 1 << cEntriesLog2;
+    pTable->m_pNextRetired = NULL;
+    pTable->m_cEntriesMask = cEntries - 1;
+    pTable->m_pEntries = new (nothrow) MegamorphicDispatchEntry[cEntries];
+    if (pTable->m_pEntries == NULL)
+        return NULL;
+
+    memset(pTable->m_pEntries, 0, sizeof(MegamorphicDispatchEntry) * cEntries);
+    NativeMemoryAdd(NativeMemoryKind_InterfaceDispatch, MegamorphicDispatchTable::GetSize(cEntries));
+
+    pTable.SuppressRelease();
+    return pTable;
+}
+
+// Records a mapping for a cell whose cache can no longer grow. Returns false if the mapping could not be
+// recorded (out of memory or the table has reached its maximum size).
+static bool AddMegamorphicDispatchEntry(InterfaceDispatchCell * pCell, EEType * pInstanceType, void * pTargetCode)
+{
+    CrstHolder lh(&g_sMegamorphicLock);
+
+    MegamorphicDispatchTable * pTable = g_pMegamorphicTable;
+    if (pTable != NULL && InsertMegamorphicTable(pTable, pCell, pInstanceType, pTargetCode))
+    {
+        CID_COUNTER_INC(MegamorphicInserts);
+        return true;
+    }
+
+    // Either there's no table yet or the probe sequence for this key is full: build a larger table.
+    UInt32 cEntriesLog2 = CID_MEGAMORPHIC_INITIAL_SIZE_LOG2;
+    if (pTable != NULL)
+    {
+        while ((1u << cEntriesLog2) <= pTable->m_cEntriesMask)
+            cEntriesLog2++;
+        cEntriesLog2++;
+    }
+
+    for (; cEntriesLog2 <= CID_MEGAMORPHIC_MAX_SIZE_LOG2; cEntriesLog2++)
+    {
+        NewHolder<MegamorphicDispatchTable> pNewTable = AllocateMegamorphicTable(cEntriesLog2);
+        if (pNewTable == NULL)
+            return false;
+
+        bool fSuccess = true;
+        if (pTable != NULL)
+        {
+            for (UInt32 i = 0; fSuccess && (i <= pTable->m_cEntriesMask); i++)
+            {
+                MegamorphicDispatchEntry * pEntry = &pTable->m_pEntries[i];
+                if (pEntry->m_pCell != NULL)
+                    fSuccess = InsertMegamorphicTable(pNewTable, pEntry->m_pCell, pEntry->m_pInstanceType, pEntry->m_pTargetCode);
+            }
+        }
+
+        if (fSuccess)
+            fSuccess = InsertMegamorphicTable(pNewTable, pCell, pInstanceType, pTargetCode);
+
+        if (!fSuccess)
+        {
+            // Pathological clustering in the larger table as well; try the next size up.
+            continue;
+        }
+
+        pNewTable.SuppressRelease();
+        PalInterlockedExchangePointer((void * volatile *)&g_pMegamorphicTable, (MegamorphicDispatchTable *)pNewTable);
+
+        // The old table may still be being probed by other threads, free it at the next GC.
+        if (pTable != NULL)
+        {
+            pTable->m_pNextRetired = g_pRetiredMegamorphicTables;
+            g_pRetiredMegamorphicTables = pTable;
+        }
+
+        CID_COUNTER_INC(MegamorphicInserts);
+        return true;
+    }
+
+    return false;
+}
+
+// Looks up a mapping for a cell whose cache is full.
+static void * FindMegamorphicDispatchEntry(InterfaceDispatchCell * pCell, EEType * pInstanceType)
+{
+    MegamorphicDispatchTable * pTable = g_pMegamorphicTable;
+    if (pTable == NULL)
+        return NULL;
+
+    return LookupMegamorphicTable(pTable, pCell, pInstanceType);
+}
+
+//
+// Trimming of grown caches.
+//
+// Caches only ever grow, so a cell that saw many types during a transient polymorphic phase keeps probing a
+// large cache after its call site settles down to one or two types, and those may sit anywhere in the cache.
+// The dispatch stubs don't count hits, so the working set of a cell is sampled by resetting its cache instead.
+// Cells whose cache grows to CID_TRIM_MIN_CACHE_SIZE entries are tracked, and at the GCs they are due (when no
+// thread can be in a dispatch stub) their cache is replaced by an empty single entry cache. The cache then
+// regrows to the types the call site still uses, in the order they are first called after the reset, which
+// tends to put the hot types in the first entries.
+//
+// A reset costs a miss for each type in the working set, so the resets of a cell back off: when the cache has
+// regrown to at least its previous size by the next time the cell is due, the working set didn't shrink and the
+// interval doubles, up to CID_TRIM_MAX_INTERVAL GCs. A cell whose cache regrew smaller goes back to the initial
+// interval.
+//
+// The tracked cells are kept in an open addressed set, updated under g_sListLock and read during GCs. Cells are
+// never freed, so neither are the entries.
+//
+
+#define CID_TRIM_MIN_CACHE_SIZE     8
+#define CID_TRIM_INITIAL_INTERVAL   4
+#define CID_TRIM_MAX_INTERVAL       256
+#define CID_TRIM_INITIAL_SIZE_LOG2  8
+
+struct TrimmedCell
+{
+    InterfaceDispatchCell * m_pCell;
+    UInt16                  m_uInterval;            // GCs between resets
+    UInt16                  m_uGcsUntilReset;
+    UInt32                  m_cEntriesBeforeReset;  // Size of the cache at the last reset, 0 if there wasn't one
+};
+
+static TrimmedCell * g_rgTrimmedCells = NULL;
+static UInt32 g_cTrimmedCellsMask = 0;
+static UInt32 g_cTrimmedCells = 0;
+
+static bool g_fCidTrimEnabled = false;
+
+static UInt32 TrimmedCellHash(InterfaceDispatchCell * pCell)
+{
+    UInt32 hash = (UInt32)((UIntNative)pCell >> 3) * 0x9E3779B1;
+    return hash ^ (hash >> 15);
+}
+
+// Places a cell in the given table, which must have a free slot. Returns false if the cell is already there.
+static bool InsertTrimmedCell(TrimmedCell * rgCells, UInt32 cMask, TrimmedCell const & cell)
+{
+    for (UInt32 idx = TrimmedCellHash(cell.m_pCell); ; idx++)
+    {
+        TrimmedCell * pEntry = &rgCells[idx & cMask];
+        if (pEntry->m_pCell == cell.m_pCell)
+            return false;
+
+        if (pEntry->m_pCell == NULL)
+        {
+            *pEntry = cell;
+            return true;
+        }
+    }
+}
+
+// Starts tracking a cell whose cache has grown to CID_TRIM_MIN_CACHE_SIZE entries. Cells reach that size again
+// after each of their resets, in which case they are already tracked. A cell that can't be tracked for lack of
+// memory simply keeps its cache.
+static void TrackCellForTrimming(InterfaceDispatchCell * pCell)
+{
+    CrstHolder lh(&g_sListLock);
+
+    // Keep the table at most half full
+    if ((g_cTrimmedCells + 1) * 2 > g_cTrimmedCellsMask + 1)
+    {
+        UInt32 cNewEntries = (g_rgTrimmedCells == NULL) ? (1 << CID_TRIM_INITIAL_SIZE_LOG2) : (g_cTrimmedCellsMask + 1) * 2;
+        TrimmedCell * rgNewCells = new (nothrow) TrimmedCell[cNewEntries];
+        if (rgNewCells == NULL)
+            return;
+
+        memset(rgNewCells, 0, sizeof(TrimmedCell) * cNewEntries);
+        NativeMemoryAdd(NativeMemoryKind_InterfaceDispatch, sizeof(TrimmedCell) * cNewEntries);
+
+        if (g_rgTrimmedCells != NULL)
+        {
+            for (UInt32 i = 0; i <= g_cTrimmedCellsMask; i++)
+            {
+                if (g_rgTrimmedCells[i].m_pCell != NULL)
+                    InsertTrimmedCell(rgNewCells, cNewEntries - 1, g_rgTrimmedCells[i]);
+            }
+
+            // The table is only read under the lock or during a GC, neither of which can be running now
+            delete[] g_rgTrimmedCells;
+            NativeMemoryRemove(NativeMemoryKind_InterfaceDispatch, sizeof(TrimmedCell) * (g_cTrimmedCellsMask + 1));
+        }
+
+        g_rgTrimmedCells = rgNewCells;
+        g_cTrimmedCellsMask = cNewEntries - 1;
+    }
+
+    TrimmedCell cell;
+    cell.m_pCell = pCell;
+    cell.m_uInterval = CID_TRIM_INITIAL_INTERVAL;
+    cell.m_uGcsUntilReset = CID_TRIM_INITIAL_INTERVAL;
+    cell.m_cEntriesBeforeReset = 0;
+
+    if (InsertTrimmedCell(g_rgTrimmedCells, g_cTrimmedCellsMask, cell))
+        g_cTrimmedCells++;
+}
+
+// Resets the caches of the tracked cells that are due. Must be called during a GC, after the discarded caches
+// have been returned to the free lists: the empty caches are taken from there, a cell is postponed to the next
+// GC when there is none.
+static void TrimInterfaceDispatchCaches()
+{
+    if (g_rgTrimmedCells == NULL)
+        return;
+
+    for (UInt32 i = 0; i <= g_cTrimmedCellsMask; i++)
+    {
+        TrimmedCell * pTrimmedCell = &g_rgTrimmedCells[i];
+        if (pTrimmedCell->m_pCell == NULL)
+            continue;
+
+        if (--pTrimmedCell->m_uGcsUntilReset != 0)
+            continue;
+
+        InterfaceDispatchCache * pCache = (InterfaceDispatchCache *)pTrimmedCell->m_pCell->GetCache();
+        UInt32 cEntries = (pCache != NULL) ? pCache->m_cEntries : 0;
+        if (cEntries < CID_TRIM_MIN_CACHE_SIZE)
+        {
+            // The cache is still small since the last reset, there is nothing to trim
+            pTrimmedCell->m_uInterval = CID_TRIM_INITIAL_INTERVAL;
+            pTrimmedCell->m_uGcsUntilReset = CID_TRIM_INITIAL_INTERVAL;
+            continue;
+        }
+
+        InterfaceDispatchCache * pEmptyCache = g_rgFreeLists[0];
+        if (pEmptyCache == NULL)
+        {
+            pTrimmedCell->m_uGcsUntilReset = 1;
+            continue;
+        }
+
+        g_rgFreeLists[0] = pEmptyCache->m_pNextFree;
+
+        if (pTrimmedCell->m_cEntriesBeforeReset != 0 && cEntries >= pTrimmedCell->m_cEntriesBeforeReset)
+            pTrimmedCell->m_uInterval = (UInt16)min(pTrimmedCell->m_uInterval * 2, CID_TRIM_MAX_INTERVAL);
+        else
+            pTrimmedCell->m_uInterval = CID_TRIM_INITIAL_INTERVAL;
+
+        pTrimmedCell->m_uGcsUntilReset = pTrimmedCell->m_uInterval;
+        pTrimmedCell->m_cEntriesBeforeReset = cEntries;
+
+        pEmptyCache->m_cacheHeader = pCache->m_cacheHeader;
+        pEmptyCache->m_pNextFree = NULL;
+#if !defined(HOST_AMD64) && !defined(HOST_ARM64)
+        pEmptyCache->m_pCell = pTrimmedCell->m_pCell;
+#endif // !defined(HOST_AMD64) && !defined(HOST_ARM64)
+        pEmptyCache->m_cEntries = 1;
+        memset(pEmptyCache->m_rgEntries, 0, sizeof(InterfaceDispatchCacheEntry));
+
+        UpdateCellStubAndCache(pTrimmedCell->m_pCell, g_rgDispatchStubs[0], (UIntNative)pEmptyCache);
 
-    // We processed all the discarded entries, so we can simply NULL the list head.
+        // No thread can be using the old cache during the GC, it can be reused right away
+        UInt32 idxCacheSize = CacheSizeToIndex(cEntries);
+        pCache->m_pNextFree = g_rgFreeLists[idxCacheSize];
+        g_rgFreeLists[idxCacheSize] = pCache;
+
+        CID_COUNTER_INC(CacheTrims);
+    }
+}
+
+// Called during a GC to empty the list of discarded caches (which we can now guarantee aren't being accessed)
+// and sort the results into the free lists we maintain for each cache size.
+void ReclaimUnusedInterfaceDispatchCaches()
+{
+    // No need for any locks, we're not racing with any other threads any more.
+    ReturnDiscardedCachesToFreeLists(g_pDiscardedCacheList);
+    ReturnDiscardedCachesToFreeLists(g_pPendingCacheList);
+
+    if (g_fCidTrimEnabled)
+        TrimInterfaceDispatchCaches();
+
+    // We processed all the discarded entries, so we can simply NULL the list heads.
     g_pDiscardedCacheList = NULL;
+    g_pPendingCacheList = NULL;
+    g_cDiscardedCaches = 0;
+
+    // Likewise no thread can be probing a megamorphic table that has been replaced.
+    MegamorphicDispatchTable * pRetiredTable = g_pRetiredMegamorphicTables;
+    while (pRetiredTable)
+    {
+        MegamorphicDispatchTable * pNextRetiredTable = pRetiredTable->m_pNextRetired;
+        delete pRetiredTable;
+        pRetiredTable = pNextRetiredTable;
+    }
+    g_pRetiredMegamorphicTables = NULL;
 }
 
 // One time initialization of interface dispatch.
@@ -443,12 +933,110 @@ bool InitializeInterfaceDispatch()
         return false;
 
     g_sListLock.Init(CrstInterfaceDispatchGlobalLists, CRST_DEFAULT);
+    g_sMegamorphicLock.Init(CrstDispatchCache, CRST_DEFAULT);
+
+    g_fCidStatsEnabled = g_pRhConfig->GetInterfaceDispatchStats() != 0;
+    g_fCidTrimEnabled = g_pRhConfig->GetInterfaceDispatchCacheTrimming() != 0;
+
+    return true;
+}
+
+//
+// Dispatch cells for the type loader.
+//
+// Each dynamic dispatch cell is a pair of InterfaceDispatchCells: the cell dispatched through, and a
+// terminating cell holding the slot number. Pairs are carved out of cache line aligned slabs allocated from
+// the AllocHeap, rather than allocated one at a time from the native heap, so they carry no heap header and
+// pairs created together share cache lines. Types built by the type loader are never unloaded so the cells
+// are never freed.
+//
+
+#define CID_DYNAMIC_CELL_SLAB_SIZE 4096
+
+EXTERN_C void RhpInitialDynamicInterfaceDispatch();
+
+static UInt8 * g_pDynamicCellSlabCurrent = NULL;
+static UInt8 * g_pDynamicCellSlabLimit = NULL;
+static UInt32 volatile g_cDynamicCells = 0;
+
+COOP_PINVOKE_HELPER(void *, RhNewInterfaceDispatchCell, (EEType * pInterface, Int32 slotNumber))
+{
+    const UIntNative cbCellPair = sizeof(InterfaceDispatchCell) * 2;
+
+    InterfaceDispatchCell * pCell;
+    {
+        CrstHolder lh(&g_sListLock);
+
+        if (g_pDynamicCellSlabCurrent + cbCellPair > g_pDynamicCellSlabLimit)
+        {
+            UInt8 * pSlab = g_pAllocHeap->AllocAligned(CID_DYNAMIC_CELL_SLAB_SIZE, 64);
+            if (pSlab == NULL)
+                return NULL;
+
+            NativeMemoryAdd(NativeMemoryKind_InterfaceDispatch, CID_DYNAMIC_CELL_SLAB_SIZE);
+
+            g_pDynamicCellSlabCurrent = pSlab;
+            g_pDynamicCellSlabLimit = pSlab + CID_DYNAMIC_CELL_SLAB_SIZE;
+        }
+
+        pCell = (InterfaceDispatchCell *)g_pDynamicCellSlabCurrent;
+        g_pDynamicCellSlabCurrent += cbCellPair;
+        g_cDynamicCells++;
+    }
+
+    // Due to the synchronization mechanism used to update this indirection cell we must ensure the cell's alignment is twice that of a pointer.
+    ASSERT(IS_ALIGNED(pCell, 2 * POINTER_SIZE));
+    ASSERT(IS_ALIGNED(pInterface, (InterfaceDispatchCell::IDC_CachePointerMask + 1)));
+
+    pCell[1].m_pStub = 0;
+    pCell[1].m_pCache = (UIntNative)slotNumber;
+    pCell[0].m_pCache = ((UIntNative)pInterface) | InterfaceDispatchCell::IDC_CachePointerIsInterfacePointerOrMetadataToken;
+    pCell[0].m_pStub = (UIntNative)&RhpInitialDynamicInterfaceDispatch;
+
+    return pCell;
+}
+
+// Returns the interface dispatch counters summed over all CPUs. Returns false (and zeroes everything but the
+// count of dynamic cells) if collection of the statistics is not enabled.
+COOP_PINVOKE_HELPER(Boolean, RhGetInterfaceDispatchStats, (InterfaceDispatchStats * pStats))
+{
+    memset(pStats, 0, sizeof(InterfaceDispatchStats));
+
+    pStats->m_cDynamicCells = g_cDynamicCells;
+
+    if (!g_fCidStatsEnabled)
+        return false;
+
+    for (UInt32 i = 0; i < CID_STATS_STRIPE_COUNT; i++)
+    {
+        InterfaceDispatchStats * pStripe = &g_rgCidStatsStripes[i].m_stats;
+
+        pStats->m_cCacheMisses += pStripe->m_cCacheMisses;
+        pStats->m_cCacheSizeOverflows += pStripe->m_cCacheSizeOverflows;
+        pStats->m_cMegamorphicInserts += pStripe->m_cMegamorphicInserts;
+        pStats->m_cCacheOutOfMemory += pStripe->m_cCacheOutOfMemory;
+        pStats->m_cCacheReallocates += pStripe->m_cCacheReallocates;
+        pStats->m_cCacheAllocates += pStripe->m_cCacheAllocates;
+        pStats->m_cCacheDiscards += pStripe->m_cCacheDiscards;
+        pStats->m_cCacheTrims += pStripe->m_cCacheTrims;
+        pStats->m_cbMemoryAllocated += pStripe->m_cbMemoryAllocated;
+
+        for (UInt32 j = 0; j <= CID_MAX_CACHE_SIZE_LOG2; j++)
+            pStats->m_rgAllocatesBySize[j] += pStripe->m_rgAllocatesBySize[j];
+    }
 
     return true;
 }
 
 COOP_PINVOKE_HELPER(PTR_Code, RhpUpdateDispatchCellCache, (InterfaceDispatchCell * pCell, PTR_Code pTargetCode, EEType* pInstanceType, DispatchCellInfo *pNewCellInfo))
 {
+    CID_COUNTER_INC(CacheMisses);
+
+    // Having reached here the current thread is not in the middle of a dispatch stub and so cannot be holding
+    // any cache pointer that has been discarded.
+    Thread * pCurrentThread = ThreadStore::GetCurrentThread();
+    pCurrentThread->NoteInterfaceDispatchQuiescent(g_uCacheEpoch);
+
     // Attempt to update the cache with this new mapping (if we have any cache at all, the initial state
     // is none).
     InterfaceDispatchCache * pCache = (InterfaceDispatchCache*)pCell->GetCache();
@@ -475,12 +1063,11 @@ COOP_PINVOKE_HELPER(PTR_Code, RhpUpdateDispatchCellCache, (InterfaceDispatchCell
 
     if (cOldCacheEntries == CID_MAX_CACHE_SIZE)
     {
-        // We already reached the maximum cache size we wish to allocate. For now don't attempt to cache
-        // the mapping we just did: there's no safe way to update the existing cache right now if it
-        // doesn't have an empty entries. There are schemes that would let us do this at the next GC point
-        // but it's not clear whether we should do this or re-tune the cache max size, we need to measure
-        // this.
-        CID_COUNTER_INC(CacheSizeOverflows);
+        // We already reached the maximum cache size we wish to allocate. There's no safe way to update the
+        // existing cache right now if it doesn't have an empty entries, so promote the mapping into the
+        // megamorphic table instead (see RhpSearchDispatchCellCache).
+        if (!AddMegamorphicDispatchEntry(pCell, pInstanceType, pTargetCode))
+            CID_COUNTER_INC(CacheSizeOverflows);
         return (PTR_Code)pTargetCode;
     }
 
@@ -515,20 +1102,25 @@ COOP_PINVOKE_HELPER(PTR_Code, RhpUpdateDispatchCellCache, (InterfaceDispatchCell
     if (pDiscardedCache)
         DiscardCache(pDiscardedCache);
 
+    if (g_fCidTrimEnabled && (cNewCacheEntries == CID_TRIM_MIN_CACHE_SIZE) && (pDiscardedCache != (InterfaceDispatchCache *)newCacheValue))
+        TrackCellForTrimming(pCell);
+
+    TryReclaimDiscardedCaches(pCurrentThread);
+
     return (PTR_Code)pTargetCode;
 }
 
 COOP_PINVOKE_HELPER(PTR_Code, RhpSearchDispatchCellCache, (InterfaceDispatchCell * pCell, EEType* pInstanceType))
 {
     // This function must be implemented in native code so that we do not take a GC while walking the cache
+    void * pTargetCode = LookupInterfaceDispatchCache(pCell, pInstanceType);
+    if (pTargetCode != NULL)
+        return (PTR_Code)pTargetCode;
+
+    // Cells with a full cache have their overflow mappings recorded in the megamorphic table.
     InterfaceDispatchCache * pCache = (InterfaceDispatchCache*)pCell->GetCache();
-    if (pCache != NULL)
-    {
-        InterfaceDispatchCacheEntry * pCacheEntry = pCache->m_rgEntries;
-        for (UInt32 i = 0; i < pCache->m_cEntries; i++, pCacheEntry++)
-            if (pCacheEntry->m_pInstanceType == pInstanceType)
-                return (PTR_Code)pCacheEntry->m_pTargetCode;
-    }
+    if (pCache != NULL && pCache->m_cEntries == CID_MAX_CACHE_SIZE)
+        return (PTR_Code)FindMegamorphicDispatchEntry(pCell, pInstanceType);
 
     return nullptr;
 }
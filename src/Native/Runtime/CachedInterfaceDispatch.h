@@ -10,9 +10,33 @@
 
 #ifdef FEATURE_CACHED_INTERFACE_DISPATCH
 
+// We always allocate cache sizes with a power of 2 number of entries. We have a maximum size we support,
+// defined below.
+#define CID_MAX_CACHE_SIZE_LOG2 6
+#define CID_MAX_CACHE_SIZE      (1 << CID_MAX_CACHE_SIZE_LOG2)
+
 bool InitializeInterfaceDispatch();
 void ReclaimUnusedInterfaceDispatchCaches();
 
+// Counters describing the behavior of the interface dispatch caches, returned by RhGetInterfaceDispatchStats.
+// Collection is enabled through the InterfaceDispatchStats runtime configuration value. The values are
+// aggregated from per-CPU counters that are updated without synchronization, so they should be treated as
+// approximations.
+struct InterfaceDispatchStats
+{
+    UInt64  m_cCacheMisses;                                         // Calls to RhpUpdateDispatchCellCache
+    UInt64  m_cCacheSizeOverflows;                                  // Misses that could not be cached anywhere
+    UInt64  m_cMegamorphicInserts;                                  // Mappings added to the megamorphic table
+    UInt64  m_cCacheOutOfMemory;                                    // Failures to allocate a new cache
+    UInt64  m_cCacheReallocates;                                    // Caches satisfied from the free lists
+    UInt64  m_cCacheAllocates;                                      // Caches satisfied from new memory
+    UInt64  m_cCacheDiscards;                                       // Caches retired after being replaced
+    UInt64  m_cCacheTrims;                                          // Grown caches reset at a GC to relearn their working set
+    UInt64  m_cbMemoryAllocated;                                    // Bytes of cache entries allocated from new memory
+    UInt64  m_rgAllocatesBySize[CID_MAX_CACHE_SIZE_LOG2 + 1];       // New allocations indexed by log2(cache size)
+    UInt64  m_cDynamicCells;                                        // Live cells from RhNewInterfaceDispatchCell, always reported
+};
+
 // Interface dispatch caches contain an array of these entries. An instance of a cache is paired with a stub
 // that implicitly knows how many entries are contained. These entries must be aligned to twice the alignment
 // of a pointer due to the synchonization mechanism used to update them at runtime.
@@ -44,4 +68,21 @@ struct InterfaceDispatchCache
 };
 #pragma warning(pop)
 
+// Probe the cache attached to a dispatch cell for the target of a call on an instance of the given type. This
+// is the lookup the RhpInterfaceDispatchN stubs perform in assembly, for the helpers written in C++. Returns
+// NULL if the cell has no cache or the type is not in it, the megamorphic table is not consulted.
+inline void * LookupInterfaceDispatchCache(InterfaceDispatchCell * pCell, EEType * pInstanceType)
+{
+    InterfaceDispatchCache * pCache = (InterfaceDispatchCache*)pCell->GetCache();
+    if (pCache == NULL)
+        return NULL;
+
+    InterfaceDispatchCacheEntry * pCacheEntry = pCache->m_rgEntries;
+    for (UInt32 i = 0; i < pCache->m_cEntries; i++, pCacheEntry++)
+        if (pCacheEntry->m_pInstanceType == pInstanceType)
+            return pCacheEntry->m_pTargetCode;
+
+    return NULL;
+}
+
 #endif // FEATURE_CACHED_INTERFACE_DISPATCH
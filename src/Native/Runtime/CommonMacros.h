@@ -183,22 +183,36 @@ inline bool IS_ALIGNED(T* val, UIntNative alignment);
 
 #define INLINE inline
 
+// Keep in sync with s_startupTimelineEventNames in startup.cpp
 enum STARTUP_TIMELINE_EVENT_ID
 {
     PROCESS_ATTACH_BEGIN = 0,
+    PAL_INIT_COMPLETE,
     NONGC_INIT_COMPLETE,
+    GC_HEAP_INIT_COMPLETE,
+    FINALIZATION_INIT_COMPLETE,
     GC_INIT_COMPLETE,
+    CPU_FEATURES_DETECTED,
     PROCESS_ATTACH_COMPLETE,
+    REGISTER_OS_MODULE_BEGIN,
+    REGISTER_OS_MODULE_COMPLETE,
+    CREATE_TYPE_MANAGER_BEGIN,
+    CREATE_TYPE_MANAGER_COMPLETE,
+    FIRST_ALLOCATION_REFILL,
+    MANAGED_MAIN_BEGIN,
 
     NUM_STARTUP_TIMELINE_EVENTS
 };
 
-#ifdef PROFILE_STARTUP
-extern unsigned __int64 g_startupTimelineEvents[NUM_STARTUP_TIMELINE_EVENTS];
-#define STARTUP_TIMELINE_EVENT(eventid) PalQueryPerformanceCounter((LARGE_INTEGER*)&g_startupTimelineEvents[eventid]);
-#else // PROFILE_STARTUP
+#ifndef DACCESS_COMPILE
+// Appends a timestamped event to the startup timeline, a small fixed size buffer that is printed at shutdown
+// when RH_StartupTimeline is set. Events that don't fit are only counted. Recording is cheap enough to always
+// be on, so the timeline covers the phases before the configuration can be read.
+void RecordStartupTimelineEvent(STARTUP_TIMELINE_EVENT_ID eventId);
+#define STARTUP_TIMELINE_EVENT(eventid) RecordStartupTimelineEvent(eventid);
+#else
 #define STARTUP_TIMELINE_EVENT(eventid)
-#endif // PROFILE_STARTUP
+#endif // DACCESS_COMPILE
 
 #ifndef C_ASSERT
 #define C_ASSERT(e) static_assert(e, #e)
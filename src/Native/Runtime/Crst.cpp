@@ -6,8 +6,14 @@
 #include "CommonMacros.h"
 #include "PalRedhawkCommon.h"
 #include "PalRedhawk.h"
+#include "rhassert.h"
 #include "holder.h"
 #include "Crst.h"
+#include "yieldprocessornormalized.h"
+
+// Bounds on the number of normalized yields a contended Enter spins for before blocking.
+#define CRST_MIN_SPIN_COUNT     10
+#define CRST_MAX_SPIN_COUNT     1000
 
 void CrstStatic::Init(CrstType eType, CrstFlags eFlags)
 {
@@ -17,6 +23,7 @@ void CrstStatic::Init(CrstType eType, CrstFlags eFlags)
 #if defined(_DEBUG)
     m_uiOwnerId.Clear();
 #endif // _DEBUG
+    m_uSpinEstimate = 0;
     PalInitializeCriticalSectionEx(&m_sCritSec, 0, 0);
 #endif // !DACCESS_COMPILE
 }
@@ -28,11 +35,43 @@ void CrstStatic::Destroy()
 #endif // !DACCESS_COMPILE
 }
 
+#ifndef DACCESS_COMPILE
+void CrstStatic::EnterContended()
+{
+    if (g_RhSystemInfo.dwNumberOfProcessors > 1)
+    {
+        // Spin for up to about twice as long as contended Enters recently needed. The estimate follows the
+        // typical wait while spinning pays off, and decays when the lock isn't released in time (long hold
+        // times or a descheduled holder) so that such locks soon only spin briefly before blocking.
+        UInt32 uSpinEstimate = m_uSpinEstimate;
+        UInt32 uMaxSpins = min(uSpinEstimate * 2 + CRST_MIN_SPIN_COUNT, (UInt32)CRST_MAX_SPIN_COUNT);
+
+        // The normalized yield is calibrated by yieldprocessornormalized.cpp (the defaults are used until the
+        // measurement is done), so the spin duration doesn't depend on the processor's pause latency.
+        YieldProcessorNormalizationInfo normalizationInfo;
+        for (UInt32 uSpins = 1; uSpins <= uMaxSpins; uSpins++)
+        {
+            YieldProcessorNormalized(normalizationInfo);
+            if (PalTryEnterCriticalSection(&m_sCritSec))
+            {
+                m_uSpinEstimate = uSpinEstimate + ((Int32)(uSpins - uSpinEstimate) / 8);
+                return;
+            }
+        }
+
+        m_uSpinEstimate = uSpinEstimate - (uSpinEstimate / 4);
+    }
+
+    PalEnterCriticalSection(&m_sCritSec);
+}
+#endif // !DACCESS_COMPILE
+
 // static 
 void CrstStatic::Enter(CrstStatic *pCrst)
 {
 #ifndef DACCESS_COMPILE
-    PalEnterCriticalSection(&pCrst->m_sCritSec);
+    if (!PalTryEnterCriticalSection(&pCrst->m_sCritSec))
+        pCrst->EnterContended();
 #if defined(_DEBUG)
     pCrst->m_uiOwnerId.SetToCurrentThread();
 #endif // _DEBUG
@@ -8,6 +8,11 @@
 // Minimal Crst implementation based on CRITICAL_SECTION. Doesn't support much except for the basic locking
 // functionality (in particular there is no rank violation checking).
 //
+// A contended Enter spins for a while before blocking on the critical section. The spin length adapts per
+// lock to how long waiters recently had to wait for the lock to be released, so locks that are held briefly
+// are acquired without a context switch, and locks whose holders run long (or got descheduled, which is
+// common in oversubscribed containers) quickly stop wasting CPU on spinning.
+//
 
 enum CrstType
 {
@@ -23,6 +28,11 @@ enum CrstType
     CrstSuspendEE,
     CrstCastCache,
     CrstYieldProcessorNormalized,
+    CrstAllocationSampling,
+    CrstEventSession,
+    CrstHeapSnapshot,
+    CrstSamplingProfiler,
+    CrstPerfMap,
 };
 
 enum CrstFlags
@@ -51,7 +61,10 @@ public:
 #endif // _DEBUG
 
 private:
+    void EnterContended();
+
     CRITICAL_SECTION    m_sCritSec;
+    uint32_t            m_uSpinEstimate;    // Running average of the spin iterations that contended Enters needed
 #if defined(_DEBUG)
     EEThreadId          m_uiOwnerId;
 #endif // _DEBUG
@@ -0,0 +1,367 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "common.h"
+#include "gcenv.h"
+#include "gcheaputilities.h"
+#include "gcrhinterface.h"
+#include "slist.h"
+#include "varint.h"
+#include "regdisplay.h"
+#include "StackFrameIterator.h"
+#include "thread.h"
+#include "holder.h"
+#include "RWLock.h"
+#include "threadstore.h"
+#include "threadstore.inl"
+#include "thread.inl"
+#include "RhConfig.h"
+
+#include "EventSession.h"
+
+//
+// Every runtime thread owns the buffer its events are written to, so recording an event takes no lock. A
+// buffer is handed to the writer thread when it is full, when an event is recorded into it more than
+// EVENT_SESSION_FLUSH_INTERVAL after its first one, and when the thread goes away. Threads the runtime doesn't
+// know about (the server GC threads and the background GC thread) share a buffer guarded by
+// g_EventSessionLock. Handed off buffers are pushed on a lock-free list that the writer thread takes in one
+// go every EVENT_SESSION_FLUSH_INTERVAL and appends to the file.
+//
+#define EVENT_SESSION_BUFFER_SIZE       (16 * 1024)
+#define EVENT_SESSION_FLUSH_INTERVAL    100         // milliseconds
+#define EVENT_SESSION_TYPE_TABLE_SIZE   4096        // must be a power of 2
+
+struct EventBuffer
+{
+    EventBuffer *               m_pNext;
+    UInt64                      m_firstTimeStamp;
+    EventSessionBufferHeader    m_header;           // must be followed by m_data, both are written as one
+    UInt8                       m_data[EVENT_SESSION_BUFFER_SIZE];
+};
+
+UInt32 volatile g_eventSessionKeywords = 0;
+
+static CrstStatic g_EventSessionLock;
+static HANDLE g_hEventSessionFile = INVALID_HANDLE_VALUE;
+static UInt64 g_eventSessionFlushTicks = 0;
+static EventBuffer * g_pSharedEventBuffer = NULL;
+static EventBuffer * volatile g_pFullEventBuffers = NULL;
+static EventSessionRangeBuffer * volatile g_pRangeBuffers = NULL;
+
+// EETypes that a BulkType event was recorded for, lock-free insert only
+static EEType * volatile g_rgRecordedTypes[EVENT_SESSION_TYPE_TABLE_SIZE];
+
+static UInt64 GetEventTimeStamp()
+{
+    LARGE_INTEGER timeStamp;
+    PalQueryPerformanceCounter(&timeStamp);
+    return (UInt64)timeStamp.QuadPart;
+}
+
+static void QueueEventBuffer(EventBuffer * pBuffer)
+{
+    // Any number of threads push, the writer thread only ever takes the whole list.
+    EventBuffer * pHead;
+    do
+    {
+        pHead = g_pFullEventBuffers;
+        pBuffer->m_pNext = pHead;
+    } while (PalInterlockedCompareExchangePointer((void * volatile *)&g_pFullEventBuffers, pBuffer, pHead) != pHead);
+}
+
+static UInt32 __stdcall EventSessionWriterThread(void * /*pContext*/)
+{
+    for (;;)
+    {
+        PalSleep(EVENT_SESSION_FLUSH_INTERVAL);
+
+        EventBuffer * pBuffers = (EventBuffer *)PalInterlockedExchangePointer((void * volatile *)&g_pFullEventBuffers, NULL);
+
+        // The buffers were pushed as a stack, put them back in the order they were queued.
+        EventBuffer * pOrdered = NULL;
+        while (pBuffers != NULL)
+        {
+            EventBuffer * pNext = pBuffers->m_pNext;
+            pBuffers->m_pNext = pOrdered;
+            pOrdered = pBuffers;
+            pBuffers = pNext;
+        }
+
+        while (pOrdered != NULL)
+        {
+            // If the write fails there is nobody to tell, the events are lost.
+            PalWriteFileContents(g_hEventSessionFile, &pOrdered->m_header,
+                                 sizeof(EventSessionBufferHeader) + pOrdered->m_header.cbEvents);
+
+            EventBuffer * pNext = pOrdered->m_pNext;
+            delete pOrdered;
+            pOrdered = pNext;
+        }
+    }
+}
+
+static bool OpenEventSessionFile()
+{
+    TCHAR fileName[32] = _T("events_");
+    TCHAR * pch = fileName;
+    while (*pch != 0)
+        pch++;
+
+    TCHAR digits[10];
+    int cDigits = 0;
+    UInt32 pid = PalGetCurrentProcessId();
+    do
+    {
+        digits[cDigits++] = (TCHAR)(_T('0') + pid % 10);
+        pid /= 10;
+    } while (pid != 0);
+    while (cDigits > 0)
+        *pch++ = digits[--cDigits];
+
+    const TCHAR extension[] = _T(".bin");
+    for (size_t i = 0; i < COUNTOF(extension); i++)
+        *pch++ = extension[i];
+
+    g_hEventSessionFile = PalCreateFileForWriting(fileName);
+    if (g_hEventSessionFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER frequency;
+    PalQueryPerformanceFrequency(&frequency);
+
+    EventSessionHeader header;
+    header.Magic = EVENT_SESSION_MAGIC;
+    header.Version = EVENT_SESSION_VERSION;
+    header.TickFrequency = (UInt64)frequency.QuadPart;
+    header.StartTimeStamp = GetEventTimeStamp();
+    header.ProcessId = PalGetCurrentProcessId();
+    header.PointerSize = sizeof(void *);
+
+    if (!PalWriteFileContents(g_hEventSessionFile, &header, sizeof(header)) ||
+        !PalStartBackgroundGCThread(EventSessionWriterThread, NULL))
+    {
+        PalCloseHandle(g_hEventSessionFile);
+        g_hEventSessionFile = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    g_eventSessionFlushTicks = (UInt64)frequency.QuadPart * EVENT_SESSION_FLUSH_INTERVAL / 1000;
+    return true;
+}
+
+// Sets the GC event state the GC checks before it calls the event sink. ETW uses the same state on Windows,
+// so whichever of the two changed it last wins.
+static void UpdateGCEventState(UInt32 keywords)
+{
+    if (keywords & EVENT_SESSION_KEYWORD_ALLOCATION)
+        GCHeapUtilities::RecordEventStateChange(true, GCEventKeyword_GC, GCEventLevel_Verbose);
+    else if (keywords & EVENT_SESSION_KEYWORD_GC)
+        GCHeapUtilities::RecordEventStateChange(true, GCEventKeyword_GC, GCEventLevel_Information);
+    else
+        GCHeapUtilities::RecordEventStateChange(true, GCEventKeyword_None, GCEventLevel_None);
+}
+
+// Starts recording the events selected by keywords (EVENT_SESSION_KEYWORD_*) to events_<pid>.bin, or changes
+// the events that are recorded if a session is running already. Returns false if the file couldn't be created.
+EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpStartEventSession(UInt32 keywords)
+{
+    CrstHolder lock(&g_EventSessionLock);
+
+    if ((g_hEventSessionFile == INVALID_HANDLE_VALUE) && !OpenEventSessionFile())
+        return UInt32_FALSE;
+
+    g_eventSessionKeywords = keywords;
+    UpdateGCEventState(keywords);
+    return UInt32_TRUE;
+}
+
+// Stops recording events. The events that were recorded so far are written to the file, except for the ones
+// in the buffers of threads other than the calling one, which are written when the thread records its next
+// event or goes away.
+EXTERN_C REDHAWK_API void __cdecl RhpStopEventSession()
+{
+    CrstHolder lock(&g_EventSessionLock);
+
+    g_eventSessionKeywords = 0;
+    UpdateGCEventState(0);
+
+    if (g_pSharedEventBuffer != NULL)
+    {
+        QueueEventBuffer(g_pSharedEventBuffer);
+        g_pSharedEventBuffer = NULL;
+    }
+
+    Thread * pThread = ThreadStore::GetCurrentThreadIfAvailable();
+    if (pThread != NULL)
+        ReleaseEventSessionBuffer(pThread);
+}
+
+bool InitializeEventSession()
+{
+    g_EventSessionLock.Init(CrstEventSession, CRST_DEFAULT);
+
+    // The runtime works the same without the session, so failing to start it isn't fatal.
+    UInt32 keywords = g_pRhConfig->GetEventSessionKeywords();
+    if (keywords != 0)
+        RhpStartEventSession(keywords);
+
+    return true;
+}
+
+// Appends an event to pBuffer and returns the buffer to use from now on, NULL if the buffer was handed off
+static EventBuffer * AppendEvent(EventBuffer * pBuffer, UInt64 threadId, EventSessionEventId id, const void * pPayload, UInt32 cbPayload)
+{
+    UInt32 cbEvent = sizeof(EventSessionEventHeader) + cbPayload;
+    ASSERT(cbEvent <= EVENT_SESSION_BUFFER_SIZE);
+
+    if ((pBuffer != NULL) && (pBuffer->m_header.cbEvents + cbEvent > EVENT_SESSION_BUFFER_SIZE))
+    {
+        QueueEventBuffer(pBuffer);
+        pBuffer = NULL;
+    }
+
+    UInt64 timeStamp = GetEventTimeStamp();
+
+    if (pBuffer == NULL)
+    {
+        pBuffer = new (nothrow) EventBuffer();
+        if (pBuffer == NULL)
+            return NULL;
+
+        pBuffer->m_firstTimeStamp = timeStamp;
+        pBuffer->m_header.ThreadId = threadId;
+        pBuffer->m_header.cbEvents = 0;
+        pBuffer->m_header.Padding = 0;
+    }
+
+    EventSessionEventHeader * pEvent = (EventSessionEventHeader *)&pBuffer->m_data[pBuffer->m_header.cbEvents];
+    pEvent->Id = (UInt16)id;
+    pEvent->cbPayload = (UInt16)cbPayload;
+    pEvent->Padding = 0;
+    pEvent->TimeStamp = timeStamp;
+    if (cbPayload != 0)
+        memcpy(pEvent + 1, pPayload, cbPayload);
+
+    // Keep the events 8 byte aligned.
+    pBuffer->m_header.cbEvents += ALIGN_UP(cbEvent, 8);
+
+    if (timeStamp - pBuffer->m_firstTimeStamp > g_eventSessionFlushTicks)
+    {
+        QueueEventBuffer(pBuffer);
+        pBuffer = NULL;
+    }
+
+    return pBuffer;
+}
+
+void WriteEventSessionEvent(EventSessionEventId id, const void * pPayload, UInt32 cbPayload)
+{
+    Thread * pThread = ThreadStore::GetCurrentThreadIfAvailable();
+    if (pThread != NULL)
+    {
+        EventBuffer * pBuffer = (EventBuffer *)pThread->GetEventSessionBuffer();
+        pThread->SetEventSessionBuffer(AppendEvent(pBuffer, pThread->GetPalThreadIdForLogging(), id, pPayload, cbPayload));
+    }
+    else
+    {
+        CrstHolder lock(&g_EventSessionLock);
+        g_pSharedEventBuffer = AppendEvent(g_pSharedEventBuffer, 0, id, pPayload, cbPayload);
+    }
+}
+
+void WriteEventSessionType(EEType * pEEType)
+{
+    UInt32 iSlot = (UInt32)(((size_t)pEEType >> 3) * 0x9E3779B1) & (EVENT_SESSION_TYPE_TABLE_SIZE - 1);
+    for (UInt32 cProbes = 0; cProbes < EVENT_SESSION_TYPE_TABLE_SIZE; cProbes++)
+    {
+        EEType * pEntry = g_rgRecordedTypes[iSlot];
+        if (pEntry == pEEType)
+            return;
+
+        if (pEntry == NULL)
+        {
+            pEntry = (EEType *)PalInterlockedCompareExchangePointer((void * volatile *)&g_rgRecordedTypes[iSlot], pEEType, NULL);
+            if (pEntry == NULL)
+                break;
+            if (pEntry == pEEType)
+                return;
+
+            // Another type took the slot, keep probing.
+        }
+
+        iSlot = (iSlot + 1) & (EVENT_SESSION_TYPE_TABLE_SIZE - 1);
+    }
+
+    // If the table is full the type is recorded again, which readers handle just like the first time.
+    EventSessionBulkType type;
+    type.TypeId = (UInt64)(size_t)pEEType;
+    type.RelatedTypeId = pEEType->IsParameterizedType() ? (UInt64)(size_t)pEEType->get_RelatedParameterType() : 0;
+    type.BaseSize = pEEType->get_BaseSize();
+    type.ComponentSize = pEEType->get_ComponentSize();
+    type.ElementType = (UInt32)pEEType->GetElementType();
+    type.Flags = (pEEType->IsArray() ? EVENT_SESSION_TYPE_FLAG_ARRAY : 0) |
+                 (pEEType->get_IsValueType() ? EVENT_SESSION_TYPE_FLAG_VALUE_TYPE : 0) |
+                 (pEEType->HasFinalizer() ? EVENT_SESSION_TYPE_FLAG_FINALIZER : 0) |
+                 (pEEType->HasReferenceFields() ? EVENT_SESSION_TYPE_FLAG_REFERENCE_FIELDS : 0);
+
+    WriteEventSessionEvent(EventSessionEvent_BulkType, &type, sizeof(type));
+}
+
+EventSessionRangeBuffer * GetEventSessionRangeBuffer(void * gcContext)
+{
+    // There is a buffer per GC heap and heaps never go away, so the list stays short and is only ever pushed to.
+    EventSessionRangeBuffer * pHead = g_pRangeBuffers;
+    for (EventSessionRangeBuffer * pBuffer = pHead; pBuffer != NULL; pBuffer = pBuffer->m_pNext)
+    {
+        if (pBuffer->m_gcContext == gcContext)
+            return pBuffer;
+    }
+
+    // A heap is only walked by one thread at a time, so no other thread can be adding the buffer of this heap.
+    EventSessionRangeBuffer * pBuffer = new (nothrow) EventSessionRangeBuffer();
+    if (pBuffer == NULL)
+        return NULL;
+
+    pBuffer->m_gcContext = gcContext;
+    pBuffer->m_fCompacting = false;
+    pBuffer->m_header.Count = 0;
+    pBuffer->m_header.Padding = 0;
+
+    do
+    {
+        pHead = g_pRangeBuffers;
+        pBuffer->m_pNext = pHead;
+    } while (PalInterlockedCompareExchangePointer((void * volatile *)&g_pRangeBuffers, pBuffer, pHead) != pHead);
+
+    return pBuffer;
+}
+
+void FlushEventSessionObjectRanges(EventSessionRangeBuffer * pBuffer)
+{
+    UInt32 cRanges = pBuffer->m_header.Count;
+    if (cRanges == 0)
+        return;
+
+    if (pBuffer->m_fCompacting)
+    {
+        WriteEventSessionEvent(EventSessionEvent_MovedObjectRanges, &pBuffer->m_header,
+                               sizeof(EventSessionObjectRanges) + cRanges * sizeof(EventSessionMovedObjectRange));
+    }
+    else
+    {
+        WriteEventSessionEvent(EventSessionEvent_SurvivingObjectRanges, &pBuffer->m_header,
+                               sizeof(EventSessionObjectRanges) + cRanges * sizeof(EventSessionSurvivingObjectRange));
+    }
+
+    pBuffer->m_header.Count = 0;
+}
+
+void ReleaseEventSessionBuffer(Thread * pThread)
+{
+    EventBuffer * pBuffer = (EventBuffer *)pThread->GetEventSessionBuffer();
+    if (pBuffer == NULL)
+        return;
+
+    pThread->SetEventSessionBuffer(NULL);
+    QueueEventBuffer(pBuffer);
+}
@@ -0,0 +1,242 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Cross-platform event session. ETW is not available outside of Windows, so GC and runtime events are also
+// written into per-thread buffers that a background thread streams to events_<pid>.bin while a session is
+// running. A session is started at startup by the EventSessionKeywords runtime configuration value or at any
+// time by RhpStartEventSession, and the keywords select which events are recorded.
+//
+// The file starts with an EventSessionHeader followed by the buffers of the threads, each an
+// EventSessionBufferHeader followed by cbEvents bytes of events. Every event is an EventSessionEventHeader
+// followed by the payload of its id. Events of one buffer are in order, buffers of different threads are not.
+//
+
+#pragma once
+
+#define EVENT_SESSION_KEYWORD_GC            0x1     // GC start, end and heap statistics
+#define EVENT_SESSION_KEYWORD_ALLOCATION    0x2     // Allocation ticks and the types they name
+#define EVENT_SESSION_KEYWORD_SUSPENSION    0x4     // Execution engine suspension and restart
+#define EVENT_SESSION_KEYWORD_GC_SURVIVAL   0x8     // Object ranges that survived or were moved by each GC
+#define EVENT_SESSION_KEYWORD_ALLOC_TRACE   0x10    // Every allocation that leaves the allocation helpers and every
+                                                    // handle creation and destruction, see gc/sample/GCBench.cpp
+
+enum EventSessionEventId
+{
+    EventSessionEvent_GCStart = 1,          // EventSessionGCStart
+    EventSessionEvent_GCEnd,                // EventSessionGCEnd
+    EventSessionEvent_GCHeapStats,          // EventSessionGCHeapStats
+    EventSessionEvent_AllocationTick,       // EventSessionAllocationTick
+    EventSessionEvent_SuspendEEBegin,       // EventSessionSuspendEE
+    EventSessionEvent_SuspendEEEnd,         // no payload
+    EventSessionEvent_RestartEEBegin,       // no payload
+    EventSessionEvent_RestartEEEnd,         // no payload
+    EventSessionEvent_BulkType,             // EventSessionBulkType, written before the first event naming the type
+    EventSessionEvent_MovedObjectRanges,    // EventSessionObjectRanges followed by EventSessionMovedObjectRange[Count]
+    EventSessionEvent_SurvivingObjectRanges,// EventSessionObjectRanges followed by EventSessionSurvivingObjectRange[Count]
+    EventSessionEvent_SlowSuspension,       // EventSessionSlowSuspension
+    EventSessionEvent_AllocationTrace,      // EventSessionAllocationTrace
+    EventSessionEvent_HandleCreated,        // EventSessionHandle
+    EventSessionEvent_HandleDestroyed,      // EventSessionHandle, Type is 0
+};
+
+#define EVENT_SESSION_MAGIC     0x54534545  // 'EEST'
+#define EVENT_SESSION_VERSION   1
+
+struct EventSessionHeader
+{
+    UInt32  Magic;
+    UInt32  Version;
+    UInt64  TickFrequency;                  // Timestamps are in these units per second
+    UInt64  StartTimeStamp;
+    UInt32  ProcessId;
+    UInt32  PointerSize;
+};
+
+struct EventSessionBufferHeader
+{
+    UInt64  ThreadId;                       // 0 for events of threads the runtime doesn't know about
+    UInt32  cbEvents;
+    UInt32  Padding;
+};
+
+struct EventSessionEventHeader
+{
+    UInt16  Id;                             // EventSessionEventId
+    UInt16  cbPayload;
+    UInt32  Padding;
+    UInt64  TimeStamp;
+};
+
+struct EventSessionGCStart
+{
+    UInt32  Count;
+    UInt32  Depth;
+    UInt32  Reason;
+    UInt32  Type;
+};
+
+struct EventSessionGCEnd
+{
+    UInt32  Count;
+    UInt32  Depth;
+};
+
+struct EventSessionGCHeapStats
+{
+    UInt64  GenerationSize[5];              // gen0, gen1, gen2, LOH and POH
+    UInt64  TotalPromotedSize[5];
+    UInt64  FinalizationPromotedSize;
+    UInt64  FinalizationPromotedCount;
+    UInt32  PinnedObjectCount;
+    UInt32  GCHandleCount;
+};
+
+struct EventSessionAllocationTick
+{
+    UInt64  AllocationAmount;
+    UInt64  TypeId;                         // EEType of the allocation that crossed the tick
+    UInt64  ObjectAddress;
+    UInt32  AllocationKind;
+    UInt32  HeapIndex;
+};
+
+// The allocation helpers allocate from the allocation context of the thread until it is used up and only call
+// into the runtime then, or for objects that the context can't be used for. AllocatedBytes tells how much the
+// thread allocated in between, including earlier allocations of this kind that went to the small object heap.
+struct EventSessionAllocationTrace
+{
+    UInt64  AllocatedBytes;                 // Bytes allocated from the allocation context of the thread so far
+    UInt64  Size;
+    UInt32  Flags;                          // GC_ALLOC_* flags
+    UInt32  Padding;
+};
+
+struct EventSessionHandle
+{
+    UInt64  Handle;
+    UInt32  Type;                           // HandleType
+    UInt32  Padding;
+};
+
+struct EventSessionSuspendEE
+{
+    UInt32  Reason;
+    UInt32  GcCount;
+};
+
+struct EventSessionSlowSuspension
+{
+    UInt64  ThreadId;
+    UInt64  IP;                             // Where the thread was running when it was last hijacked
+    UInt64  MethodStart;                    // Start of the managed method containing IP, 0 if IP isn't managed code
+    UInt64  ElapsedMicroseconds;            // Time since the suspension started
+};
+
+struct EventSessionBulkType
+{
+    UInt64  TypeId;
+    UInt64  RelatedTypeId;                  // Element type of arrays and pointers, 0 otherwise
+    UInt32  BaseSize;
+    UInt32  ComponentSize;
+    UInt32  ElementType;                    // EETypeElementType
+    UInt32  Flags;                          // EVENT_SESSION_TYPE_FLAG_*
+};
+
+struct EventSessionObjectRanges
+{
+    UInt32  Count;
+    UInt32  Padding;
+};
+
+struct EventSessionMovedObjectRange
+{
+    UInt64  OldRangeBase;
+    UInt64  NewRangeBase;
+    UInt64  RangeLength;
+};
+
+struct EventSessionSurvivingObjectRange
+{
+    UInt64  RangeBase;
+    UInt64  RangeLength;
+};
+
+#define EVENT_SESSION_TYPE_FLAG_ARRAY               0x1
+#define EVENT_SESSION_TYPE_FLAG_VALUE_TYPE          0x2
+#define EVENT_SESSION_TYPE_FLAG_FINALIZER           0x4
+#define EVENT_SESSION_TYPE_FLAG_REFERENCE_FIELDS    0x8
+
+class Thread;
+class EEType;
+
+extern UInt32 volatile g_eventSessionKeywords;
+
+inline bool IsEventSessionEnabled(UInt32 keyword)
+{
+    return (g_eventSessionKeywords & keyword) != 0;
+}
+
+bool InitializeEventSession();
+
+// Records an event of the current thread. Callers check IsEventSessionEnabled first.
+void WriteEventSessionEvent(EventSessionEventId id, const void * pPayload, UInt32 cbPayload);
+
+// Records a BulkType event for pEEType if it wasn't recorded before.
+void WriteEventSessionType(EEType * pEEType);
+
+// Records a HandleCreated or HandleDestroyed event. Callers check IsEventSessionEnabled first.
+inline void WriteEventSessionHandle(EventSessionEventId id, void * handle, UInt32 type)
+{
+    EventSessionHandle payload = { (UInt64)(size_t)handle, type, 0 };
+    WriteEventSessionEvent(id, &payload, sizeof(payload));
+}
+
+// Object ranges reported by a GC heap walk are batched in a buffer that belongs to the GC heap, so the walk
+// records an event per EVENT_SESSION_MAX_OBJECT_RANGES ranges rather than per range. The buffers are allocated
+// the first time a heap is walked and reused by the following GCs.
+#define EVENT_SESSION_MAX_OBJECT_RANGES 512
+
+struct EventSessionRangeBuffer
+{
+    EventSessionRangeBuffer *   m_pNext;
+    void *                      m_gcContext;
+    bool                        m_fCompacting;
+    EventSessionObjectRanges    m_header;           // must be followed by the ranges, both are recorded as one
+    union
+    {
+        EventSessionMovedObjectRange        m_rgMoved[EVENT_SESSION_MAX_OBJECT_RANGES];
+        EventSessionSurvivingObjectRange    m_rgSurviving[EVENT_SESSION_MAX_OBJECT_RANGES];
+    };
+};
+
+// Returns the range buffer of the GC heap gcContext stands for, NULL if it can't be allocated.
+EventSessionRangeBuffer * GetEventSessionRangeBuffer(void * gcContext);
+
+// Records the batched ranges, called when the buffer is full and at the end of each heap walk.
+void FlushEventSessionObjectRanges(EventSessionRangeBuffer * pBuffer);
+
+inline void RecordEventSessionObjectRange(EventSessionRangeBuffer * pBuffer, UInt8 * pRangeStart, UInt8 * pRangeEnd, IntNative cbReloc, bool fCompacting)
+{
+    if ((pBuffer->m_header.Count == EVENT_SESSION_MAX_OBJECT_RANGES) || (pBuffer->m_fCompacting != fCompacting))
+        FlushEventSessionObjectRanges(pBuffer);
+
+    pBuffer->m_fCompacting = fCompacting;
+
+    UInt32 i = pBuffer->m_header.Count++;
+    if (fCompacting)
+    {
+        pBuffer->m_rgMoved[i].OldRangeBase = (UInt64)(size_t)pRangeStart;
+        pBuffer->m_rgMoved[i].NewRangeBase = (UInt64)(size_t)(pRangeStart + cbReloc);
+        pBuffer->m_rgMoved[i].RangeLength = (UInt64)(pRangeEnd - pRangeStart);
+    }
+    else
+    {
+        pBuffer->m_rgSurviving[i].RangeBase = (UInt64)(size_t)pRangeStart;
+        pBuffer->m_rgSurviving[i].RangeLength = (UInt64)(pRangeEnd - pRangeStart);
+    }
+}
+
+// Hands the events of a thread that is going away to the writer.
+void ReleaseEventSessionBuffer(Thread * pThread);
@@ -24,14 +24,42 @@
 #include "thread.inl"
 
 #include "yieldprocessornormalized.h"
+#include "RhConfig.h"
+#include "GCMemoryHelpers.h"
+#include "GCMemoryHelpers.inl"
 
 GPTR_DECL(Thread, g_pFinalizerThread);
 
 CLREventStatic g_FinalizerEvent;
 CLREventStatic g_FinalizerDoneEvent;
 
-// Finalizer method implemented by redhawkm.
+// Finalizer methods implemented by redhawkm.
 extern "C" void __cdecl ProcessFinalizers();
+extern "C" void __cdecl ProcessFinalizersOnHelperThread(UInt32 index);
+
+// When the FinalizerThreadCount configuration value asks for more than one finalizer thread, the regular
+// finalizer thread is joined by helper threads. Every time the finalizer thread is asked to drain the queue it
+// wakes all the helpers, which drain the same queue alongside it, and waits for them to finish before it
+// reports the finalization pass as complete.
+#define MAX_FINALIZER_HELPER_THREADS    63
+
+static UInt32 g_cFinalizerHelperThreads = 0;
+static Thread * volatile g_rgpFinalizerHelperThreads[MAX_FINALIZER_HELPER_THREADS];
+static CLREventStatic g_rgFinalizerHelperEvents[MAX_FINALIZER_HELPER_THREADS];
+static CLREventStatic g_FinalizerHelpersDoneEvent;
+static volatile Int32 g_cBusyFinalizerHelpers = 0;
+
+// With the LazyFinalizerThread configuration value set, the finalizer thread and its helpers aren't started at
+// startup but by RhEnsureFinalizerThreadStarted, the first time a finalizable object is allocated or finalizers
+// are requested. Processes that never finalize anything then don't pay for the threads.
+enum FinalizerThreadState
+{
+    FinalizerThreadStarted = 0,
+    FinalizerThreadDeferred,
+    FinalizerThreadStarting,
+};
+
+static Int32 volatile g_finalizerThreadState = FinalizerThreadStarted;
 
 // Unmanaged front-end to the finalizer thread. We require this because at the point the GC creates the
 // finalizer thread we're still executing the DllMain for RedhawkU. At that point we can't run managed code
@@ -72,6 +100,74 @@ UInt32 WINAPI FinalizerStart(void* pContext)
     return 0;
 }
 
+// Unmanaged front-end to the finalizer helper threads. Like FinalizerStart it doesn't run any managed code
+// before the first request, which only comes once the finalizer thread itself is up and running.
+UInt32 WINAPI FinalizerHelperStart(void* pContext)
+{
+    UInt32 index = (UInt32)(size_t)pContext;
+
+    ThreadStore::AttachCurrentThread();
+    Thread * pThread = ThreadStore::GetCurrentThread();
+    pThread->SetSuppressGcStress();
+
+    g_rgpFinalizerHelperThreads[index] = pThread;
+
+    UInt32 uResult = PalWaitForSingleObjectEx(g_rgFinalizerHelperEvents[index].GetOSEvent(), INFINITE, FALSE);
+    ASSERT(uResult == WAIT_OBJECT_0);
+
+    // Set the auto-reset event again so that the managed loop starts with the request we just consumed.
+    g_rgFinalizerHelperEvents[index].Set();
+
+    ProcessFinalizersOnHelperThread(index);
+
+    ASSERT(!"Finalizer helper thread should never return");
+    return 0;
+}
+
+static void StartFinalizerHelperThreads()
+{
+    UInt32 cFinalizerThreads = g_pRhConfig->GetFinalizerThreadCount();
+    if (cFinalizerThreads <= 1)
+        return;
+
+    UInt32 cHelpers = cFinalizerThreads - 1;
+    if (cHelpers > MAX_FINALIZER_HELPER_THREADS)
+        cHelpers = MAX_FINALIZER_HELPER_THREADS;
+
+    if (!g_FinalizerHelpersDoneEvent.CreateAutoEventNoThrow(false))
+        return;
+
+    // Helpers are optional, so failing to create one just leaves us with fewer of them.
+    UInt32 i;
+    for (i = 0; i < cHelpers; i++)
+    {
+        if (!g_rgFinalizerHelperEvents[i].CreateAutoEventNoThrow(false))
+            break;
+
+        if (!PalStartFinalizerThread(FinalizerHelperStart, (void*)(size_t)i))
+        {
+            g_rgFinalizerHelperEvents[i].CloseEvent();
+            break;
+        }
+    }
+
+    g_cFinalizerHelperThreads = i;
+}
+
+static bool IsFinalizerThread(Thread * pThread)
+{
+    if (pThread == g_pFinalizerThread)
+        return true;
+
+    for (UInt32 i = 0; i < g_cFinalizerHelperThreads; i++)
+    {
+        if (pThread == g_rgpFinalizerHelperThreads[i])
+            return true;
+    }
+
+    return false;
+}
+
 bool RhStartFinalizerThread()
 {
 #ifdef APP_LOCAL_RUNTIME
@@ -122,13 +218,43 @@ bool RhInitializeFinalization()
     if (!g_FinalizerDoneEvent.CreateManualEventNoThrow(false))
         return false;
 
+    if (g_pRhConfig->GetLazyFinalizerThread() != 0)
+    {
+        g_finalizerThreadState = FinalizerThreadDeferred;
+        return true;
+    }
+
     // Create the finalizer thread itself.
     if (!RhStartFinalizerThread())
         return false;
 
+    StartFinalizerHelperThreads();
+
     return true;
 }
 
+void RhEnsureFinalizerThreadStarted()
+{
+    if (g_finalizerThreadState != FinalizerThreadDeferred)
+        return;
+
+    // Only one thread gets to start the threads. Others go on; the finalizer thread consumes any request
+    // made before it is up.
+    if (PalInterlockedCompareExchange(&g_finalizerThreadState, FinalizerThreadStarting, FinalizerThreadDeferred) != FinalizerThreadDeferred)
+        return;
+
+    if (!RhStartFinalizerThread())
+    {
+        // Try again on the next request.
+        g_finalizerThreadState = FinalizerThreadDeferred;
+        return;
+    }
+
+    StartFinalizerHelperThreads();
+
+    g_finalizerThreadState = FinalizerThreadStarted;
+}
+
 void RhEnableFinalization()
 {
     g_FinalizerEvent.Set();
@@ -136,6 +262,8 @@ void RhEnableFinalization()
 
 EXTERN_C REDHAWK_API void __cdecl RhInitializeFinalizerThread()
 {
+    RhEnsureFinalizerThreadStarted();
+
 #ifdef APP_LOCAL_RUNTIME
     // We may have failed to create the finalizer thread at startup.
     // Try again now.
@@ -151,14 +279,16 @@ EXTERN_C REDHAWK_API void __cdecl RhWaitForPendingFinalizers(UInt32_BOOL allowRe
     // called in cooperative mode.
     ASSERT(!ThreadStore::GetCurrentThread()->IsCurrentThreadInCooperativeMode());
 
-    // Can't call this from the finalizer thread itself.
-    if (ThreadStore::GetCurrentThread() != g_pFinalizerThread)
+    // Can't call this from the finalizer thread itself (or one of its helpers).
+    if (!IsFinalizerThread(ThreadStore::GetCurrentThread()))
     {
         // Clear any current indication that a finalization pass is finished and wake the finalizer thread up
         // (if there's no work to do it'll set the done event immediately).
         g_FinalizerDoneEvent.Reset();
         g_FinalizerEvent.Set();
 
+        RhEnsureFinalizerThreadStarted();
+
 #ifdef APP_LOCAL_RUNTIME
         // We may have failed to create the finalizer thread at startup.
         // Try again now.
@@ -185,6 +315,10 @@ EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpWaitForFinalizerRequest()
 
     IGCHeap * pHeap = GCHeapUtilities::GetGCHeap();
 
+    // The finalizer thread is about to wait anyway, so it keeps the spin-waits of the process tuned to the current
+    // frequency of the processors.
+    RefreshYieldProcessorNormalized();
+
     // Wait in a loop because we may have to retry if we decide to only wait for finalization events but the
     // two second timeout expires.
     do
@@ -233,6 +367,45 @@ EXTERN_C REDHAWK_API void __cdecl RhpSignalFinalizationComplete()
     g_FinalizerDoneEvent.Set();
 }
 
+// Wake the finalizer helper threads (if any) to drain the finalization queue alongside the finalizer thread.
+// Returns the number of helpers woken, the finalizer thread must wait for them with RhpWaitForFinalizerHelpers
+// before it signals the finalization pass as complete.
+EXTERN_C REDHAWK_API UInt32 __cdecl RhpStartFinalizerHelpers()
+{
+    UInt32 cHelpers = g_cFinalizerHelperThreads;
+    if (cHelpers == 0)
+        return 0;
+
+    g_cBusyFinalizerHelpers = (Int32)cHelpers;
+    for (UInt32 i = 0; i < cHelpers; i++)
+        g_rgFinalizerHelperEvents[i].Set();
+
+    return cHelpers;
+}
+
+// Block the finalizer thread until all the helpers woken by RhpStartFinalizerHelpers are done.
+EXTERN_C REDHAWK_API void __cdecl RhpWaitForFinalizerHelpers()
+{
+    UInt32 uResult = PalWaitForSingleObjectEx(g_FinalizerHelpersDoneEvent.GetOSEvent(), INFINITE, FALSE);
+    ASSERT(uResult == WAIT_OBJECT_0);
+}
+
+// Block a finalizer helper thread until the finalizer thread has work for it.
+EXTERN_C REDHAWK_API void __cdecl RhpWaitForFinalizerHelperRequest(UInt32 index)
+{
+    ASSERT(index < g_cFinalizerHelperThreads);
+
+    UInt32 uResult = PalWaitForSingleObjectEx(g_rgFinalizerHelperEvents[index].GetOSEvent(), INFINITE, FALSE);
+    ASSERT(uResult == WAIT_OBJECT_0);
+}
+
+// Indicate that a finalizer helper thread found the finalization queue empty.
+EXTERN_C REDHAWK_API void __cdecl RhpSignalFinalizerHelperDone()
+{
+    if (PalInterlockedDecrement(&g_cBusyFinalizerHelpers) == 0)
+        g_FinalizerHelpersDoneEvent.Set();
+}
+
 //
 // The following helpers are special in that they interact with internal GC state or directly manipulate
 // managed references so they're called with a special co-operative p/invoke.
@@ -261,3 +434,44 @@ COOP_PINVOKE_HELPER(OBJECTREF, RhpGetNextFinalizableObject, ())
         return refNext;
     }
 }
+
+// Fetch as many objects which need finalization as fit in pResults, return the number fetched or zero if we've
+// reached the end of the list.
+COOP_PINVOKE_HELPER(UInt32, RhpGetNextFinalizableObjects, (Array * pResults))
+{
+    Object ** pObjects = (Object **)pResults->GetArrayData();
+    UInt32 cMax = pResults->GetArrayLength();
+
+    while (true)
+    {
+        UInt32 cFetched = GCHeapUtilities::GetGCHeap()->GetNextFinalizables(pObjects, cMax);
+        if (cFetched == 0)
+            return 0;
+
+        // Skip (and reset the flag of) objects that have been marked as finalized already, as
+        // RhpGetNextFinalizableObject does.
+        UInt32 cFinalizable = 0;
+        for (UInt32 i = 0; i < cFetched; i++)
+        {
+            Object * pObject = pObjects[i];
+            if (pObject->GetHeader()->GetBits() & BIT_SBLK_FINALIZER_RUN)
+            {
+                pObject->GetHeader()->ClrBit(BIT_SBLK_FINALIZER_RUN);
+                continue;
+            }
+
+            pObjects[cFinalizable++] = pObject;
+        }
+
+        // Don't leave references to the skipped objects behind.
+        for (UInt32 i = cFinalizable; i < cFetched; i++)
+            pObjects[i] = NULL;
+
+        if (cFinalizable != 0)
+        {
+            // The references were stored straight into the managed array.
+            InlinedBulkWriteBarrier(pObjects, cFinalizable * sizeof(Object *));
+            return cFinalizable;
+        }
+    }
+}
@@ -26,6 +26,9 @@
 #include "threadstore.inl"
 #include "thread.inl"
 
+#include "GCMemoryHelpers.h"
+#include "GCMemoryHelpers.inl"
+
 EXTERN_C REDHAWK_API void __cdecl RhpCollect(UInt32 uGeneration, UInt32 uMode)
 {
     // This must be called via p/invoke rather than RuntimeImport to make the stack crawlable.
@@ -41,6 +44,23 @@ EXTERN_C REDHAWK_API void __cdecl RhpCollect(UInt32 uGeneration, UInt32 uMode)
     pCurThread->EnablePreemptiveMode();
 }
 
+EXTERN_C REDHAWK_API Int32 __cdecl RhpNotifyIdle()
+{
+    // This must be called via p/invoke rather than RuntimeImport to make the stack crawlable.
+
+    Thread * pCurThread = ThreadStore::GetCurrentThread();
+
+    pCurThread->SetupHackPInvokeTunnel();
+    pCurThread->DisablePreemptiveMode();
+
+    ASSERT(!pCurThread->IsDoNotTriggerGcSet());
+    Int32 generation = GCHeapUtilities::GetGCHeap()->NotifyIdle();
+
+    pCurThread->EnablePreemptiveMode();
+
+    return generation;
+}
+
 EXTERN_C REDHAWK_API Int64 __cdecl RhpGetGcTotalMemory()
 {
     // This must be called via p/invoke rather than RuntimeImport to make the stack crawlable.
@@ -118,6 +138,18 @@ COOP_PINVOKE_HELPER(Int32, RhSetGcLatencyMode, (Int32 newLatencyMode))
     return GCHeapUtilities::GetGCHeap()->SetGcLatencyMode(newLatencyMode);
 }
 
+// Gets the longest GC pause in microseconds the GC tunes its ephemeral budgets for, 0 if it doesn't.
+COOP_PINVOKE_HELPER(UInt32, RhGetGcPauseTarget, ())
+{
+    return GCHeapUtilities::GetGCHeap()->GetGcPauseTarget();
+}
+
+// Sets the pause target in microseconds, 0 turns the tuning off. Returns the previous target.
+COOP_PINVOKE_HELPER(UInt32, RhSetGcPauseTarget, (UInt32 pauseTargetUs))
+{
+    return GCHeapUtilities::GetGCHeap()->SetGcPauseTarget(pauseTargetUs);
+}
+
 COOP_PINVOKE_HELPER(Boolean, RhIsServerGc, ())
 {
     return GCHeapUtilities::IsServerHeap();
@@ -133,6 +165,16 @@ COOP_PINVOKE_HELPER(void, RhUnregisterGcCallout, (GcRestrictedCalloutKind eKind,
     RestrictedCallouts::UnregisterGcCallout(eKind, pCallout);
 }
 
+COOP_PINVOKE_HELPER(Boolean, RhRegisterEagerFinalizer, (void * pCallout, EEType * pTypeFilter))
+{
+    return RestrictedCallouts::RegisterEagerFinalizer(pCallout, pTypeFilter);
+}
+
+COOP_PINVOKE_HELPER(void, RhUnregisterEagerFinalizer, (void * pCallout, EEType * pTypeFilter))
+{
+    RestrictedCallouts::UnregisterEagerFinalizer(pCallout, pTypeFilter);
+}
+
 COOP_PINVOKE_HELPER(Boolean, RhIsPromoted, (OBJECTREF obj))
 {
     return GCHeapUtilities::GetGCHeap()->IsPromoted(obj) ? Boolean_true : Boolean_false;
@@ -168,14 +210,66 @@ COOP_PINVOKE_HELPER(Int64, RhGetLastGCDuration, (Int32 generation))
     return GCHeapUtilities::GetGCHeap()->GetLastGCDuration(generation);
 }
 
+// Fills pInfo with up to maxCount of the most recent GC pauses, newest first, each broken down into the time
+// spent suspending threads, in the GC phases and resuming threads. Returns the number of records written.
+COOP_PINVOKE_HELPER(UInt32, RhGetGCPauseInfo, (gc_pause_info * pInfo, UInt32 maxCount))
+{
+    return GCHeapUtilities::GetGCHeap()->GetGCPauseInfo(pInfo, maxCount);
+}
+
+// Fills pInfo with up to maxCount of the snapshots of the generations taken at the end of the most recent GCs,
+// newest first: the budget of every generation and how much of it is left, its size before and after its last
+// collection, what survived and was promoted, and its fragmentation. Returns the number of records written.
+// Doesn't take any lock, so it can be polled from a monitoring thread while GCs happen.
+COOP_PINVOKE_HELPER(UInt32, RhGetGenerationInfo, (gc_generation_info * pInfo, UInt32 maxCount))
+{
+    return GCHeapUtilities::GetGCHeap()->GetGenerationInfo(pInfo, maxCount);
+}
+
+// With RH_GcTypeStats=1 the mark phase of every full GC counts the live objects and bytes of each EEType. Fills
+// pStats with up to maxCount of the entries of the last full GC and returns the number of entries there are, so
+// a caller whose buffer was too small can retry with a larger one. The entry with a null type sums the types
+// that didn't fit in the tables. pGcIndex receives the index of the GC the entries are from, 0 if none.
+COOP_PINVOKE_HELPER(UInt32, RhGetGCHeapTypeStats, (gc_type_stats * pStats, UInt32 maxCount, UInt64 * pGcIndex))
+{
+    uint64_t gcIndex;
+    UInt32 count = GCHeapUtilities::GetGCHeap()->GetHeapTypeStats(pStats, maxCount, &gcIndex);
+    if (pGcIndex != NULL)
+        *pGcIndex = gcIndex;
+    return count;
+}
+
 COOP_PINVOKE_HELPER(Boolean, RhRegisterForFullGCNotification, (Int32 maxGenerationThreshold, Int32 largeObjectHeapThreshold))
 {
     ASSERT(maxGenerationThreshold >= 1 && maxGenerationThreshold <= 99);
     ASSERT(largeObjectHeapThreshold >= 1 && largeObjectHeapThreshold <= 99);
-    return GCHeapUtilities::GetGCHeap()->RegisterForFullGCNotification(maxGenerationThreshold, largeObjectHeapThreshold)
+    return GCHeapUtilities::GetGCHeap()->RegisterForFullGCNotification(maxGenerationThreshold, largeObjectHeapThreshold, 0)
         ? Boolean_true : Boolean_false;
 }
 
+// Registers a GCRC_FullGCApproach callout and the full GC notification that makes it, so that hosts can react
+// to an approaching full blocking GC without a thread waiting in RhWaitForFullGCApproach. The GC notifies once
+// the gen2 or LOH budget left drops to its threshold percentage or to leadBytes, whichever happens first, and
+// again after the next full GC. The thresholds are shared with RhRegisterForFullGCNotification, the last
+// registration sets them. Unregister the callout with RhUnregisterGcCallout.
+COOP_PINVOKE_HELPER(Boolean, RhRegisterForFullGCApproachCallout, (void * pCallout, Int32 maxGenerationThreshold, Int32 largeObjectHeapThreshold, Int64 leadBytes))
+{
+    ASSERT(maxGenerationThreshold >= 1 && maxGenerationThreshold <= 99);
+    ASSERT(largeObjectHeapThreshold >= 1 && largeObjectHeapThreshold <= 99);
+    ASSERT(leadBytes >= 0);
+
+    if (!RestrictedCallouts::RegisterGcCallout(GCRC_FullGCApproach, pCallout))
+        return Boolean_false;
+
+    if (!GCHeapUtilities::GetGCHeap()->RegisterForFullGCNotification(maxGenerationThreshold, largeObjectHeapThreshold, (size_t)leadBytes))
+    {
+        RestrictedCallouts::UnregisterGcCallout(GCRC_FullGCApproach, pCallout);
+        return Boolean_false;
+    }
+
+    return Boolean_true;
+}
+
 COOP_PINVOKE_HELPER(Boolean, RhCancelFullGCNotification, ())
 {
     return GCHeapUtilities::GetGCHeap()->CancelFullGCNotification() ? Boolean_true : Boolean_false;
@@ -245,11 +339,41 @@ COOP_PINVOKE_HELPER(Int64, RhGetTotalAllocatedBytes, ())
     return current_high;
 }
 
+// How many times RhGetTotalAllocatedBytesPrecise tries to read the alloc contexts between GCs before it
+// suspends the EE instead.
+#define PRECISE_ALLOCATED_BYTES_ATTEMPTS 4
+
 EXTERN_C REDHAWK_API Int64 __cdecl RhGetTotalAllocatedBytesPrecise()
 {
     Int64 allocated;
 
-    // We need to suspend/restart the EE to get each thread's
+    // The unused part of every alloc context has to be taken off the total the GC handed out. Threads refill
+    // their contexts on their own between GCs, and the epoch of each thread tells whether the context was
+    // read while it wasn't being refilled. A thread that is refilling is in the middle of an allocation, its
+    // whole context counts as allocated. Only the GC changes the contexts of all threads, so the walk is
+    // retried if one runs meanwhile.
+    for (int attempt = 0; attempt < PRECISE_ALLOCATED_BYTES_ATTEMPTS; attempt++)
+    {
+        if (GCHeapUtilities::IsGCInProgress(TRUE))
+            RedhawkGCInterface::WaitForGCCompletion();
+
+        unsigned gcCount = GCHeapUtilities::GetGCHeap()->GetGcCount();
+
+        allocated = GCHeapUtilities::GetGCHeap()->GetTotalAllocatedBytes() - RedhawkGCInterface::GetDeadThreadsNonAllocBytes();
+
+        FOREACH_THREAD(pThread)
+        {
+            UIntNative cbUnused;
+            if (pThread->TryGetUnusedAllocContextBytes(&cbUnused))
+                allocated -= cbUnused;
+        }
+        END_FOREACH_THREAD
+
+        if (!GCHeapUtilities::IsGCInProgress(TRUE) && (GCHeapUtilities::GetGCHeap()->GetGcCount() == gcCount))
+            return allocated;
+    }
+
+    // GCs keep happening, suspend/restart the EE to get each thread's
     // non-allocated memory from their allocation contexts
 
     GCToEEInterface::SuspendEE(SUSPEND_REASON::SUSPEND_FOR_GC);
@@ -336,13 +460,15 @@ static Array* AllocateNewArrayImpl(Thread* pThread, EEType* pArrayEEType, UInt32
         }
     }
 
-    if (size > RH_LARGE_OBJECT_SIZE)
+    if (RedhawkGCInterface::IsLargeObjectSize(size))
         flags |= GC_ALLOC_LARGE_OBJECT_HEAP;
 
     // Save the EEType for instrumentation purposes.
     RedhawkGCInterface::SetLastAllocEEType(pArrayEEType);
 
+    pThread->BeginAllocContextUpdate();
     Array* pArray = (Array*)GCHeapUtilities::GetGCHeap()->Alloc(pThread->GetAllocContext(), size, flags);
+    pThread->EndAllocContextUpdate();
     if (pArray == NULL)
     {
         return NULL;
@@ -351,7 +477,7 @@ static Array* AllocateNewArrayImpl(Thread* pThread, EEType* pArrayEEType, UInt32
     pArray->set_EEType(pArrayEEType);
     pArray->InitArrayLength(numElements);
 
-    if (size >= RH_LARGE_OBJECT_SIZE)
+    if (RedhawkGCInterface::IsLargeObjectSize(size))
         GCHeapUtilities::GetGCHeap()->PublishObject((uint8_t*)pArray);
 
     return pArray;
@@ -370,3 +496,92 @@ EXTERN_C REDHAWK_API void RhAllocateNewArray(EEType* pArrayEEType, UInt32 numEle
 
     pThread->EnablePreemptiveMode();
 }
+
+// Allocates up to cObjects instances of the given (non-array) type, storing them into consecutive elements of
+// pResults, and returns the number of objects allocated. Fewer objects than requested are only returned if the
+// GC fails to satisfy an allocation (the caller is expected to throw OutOfMemoryException in that case).
+//
+// As many objects as possible are carved out of the current thread's allocation context with a single bounds
+// check; the context is only refilled through the GC once it is exhausted. pResults may point into the GC heap
+// (e.g. the data of an object[]), so each group of stored references is made visible to the GC via the write
+// barrier before anything that could trigger a collection.
+EXTERN_C REDHAWK_API UInt32 RhpNewFastBatch(EEType* pEEType, UInt32 cObjects, Object** pResults)
+{
+    ASSERT(!pEEType->IsArray());
+
+    Thread* pThread = ThreadStore::GetCurrentThread();
+
+    pThread->SetupHackPInvokeTunnel();
+    pThread->DisablePreemptiveMode();
+
+    ASSERT(!pThread->IsDoNotTriggerGcSet());
+
+    size_t size = pEEType->get_BaseSize();
+
+    UInt32 flags = 0;
+    if (pEEType->HasFinalizer())
+        flags |= GC_ALLOC_FINALIZE;
+#ifdef FEATURE_64BIT_ALIGNMENT
+    if (pEEType->RequiresAlign8())
+        flags |= GC_ALLOC_ALIGN8;
+#endif // FEATURE_64BIT_ALIGNMENT
+    if (RedhawkGCInterface::IsLargeObjectSize(size))
+        flags |= GC_ALLOC_LARGE_OBJECT_HEAP;
+
+    // Save the EEType for instrumentation purposes.
+    RedhawkGCInterface::SetLastAllocEEType(pEEType);
+
+    gc_alloc_context* acontext = pThread->GetAllocContext();
+    UInt32 cAllocated = 0;
+
+    while (cAllocated < cObjects)
+    {
+        UInt32 cChunk = 0;
+
+        // Objects that need no special handling from the GC can be bump allocated directly from the context.
+        if (flags == 0)
+        {
+            UIntNative cAvailable = (UIntNative)(acontext->alloc_limit - acontext->alloc_ptr) / size;
+            cChunk = (UInt32)min((UIntNative)(cObjects - cAllocated), cAvailable);
+
+            UInt8* result = acontext->alloc_ptr;
+            acontext->alloc_ptr = result + (cChunk * size);
+
+            for (UInt32 i = 0; i < cChunk; i++, result += size)
+            {
+                Object* pObject = (Object*)result;
+                pObject->set_EEType(pEEType);
+                pResults[cAllocated + i] = pObject;
+            }
+        }
+
+        if (cAllocated + cChunk < cObjects)
+        {
+            // The allocation context is exhausted (or the type can't be bump allocated). Publish the
+            // references stored so far before allocating through the GC, which also refills the context.
+            InlinedBulkWriteBarrier(&pResults[cAllocated], cChunk * sizeof(Object*));
+            cAllocated += cChunk;
+
+            pThread->BeginAllocContextUpdate();
+            Object* pObject = (Object*)GCHeapUtilities::GetGCHeap()->Alloc(acontext, size, flags);
+            pThread->EndAllocContextUpdate();
+            if (pObject == NULL)
+                break;
+
+            pObject->set_EEType(pEEType);
+
+            if (RedhawkGCInterface::IsLargeObjectSize(size))
+                GCHeapUtilities::GetGCHeap()->PublishObject((uint8_t*)pObject);
+
+            pResults[cAllocated] = pObject;
+            cChunk = 1;
+        }
+
+        InlinedBulkWriteBarrier(&pResults[cAllocated], cChunk * sizeof(Object*));
+        cAllocated += cChunk;
+    }
+
+    pThread->EnablePreemptiveMode();
+
+    return cAllocated;
+}
@@ -14,6 +14,225 @@
 #include "GCMemoryHelpers.h"
 #include "GCMemoryHelpers.inl"
 
+#if defined(HOST_AMD64)
+#include <immintrin.h>
+#include "IntrinsicConstants.h"
+
+// Fills of at least this many bytes use 32 byte AVX stores when the processor supports them. Shorter fills
+// are done before the extra alignment and the vector setup would pay off.
+#define GC_SAFE_FILL_AVX_THRESHOLD          256
+
+// Fills larger than this would evict most of the cache for memory that is unlikely to be read soon, they are
+// written with non-temporal stores that bypass it.
+#define GC_SAFE_FILL_NONTEMPORAL_THRESHOLD  (1024 * 1024)
+
+// Fills the pointer aligned memory with 32 byte AVX stores, every pointer sized element of which is written
+// atomically, and returns the number of bytes filled. The rest is left to InlineGCSafeFillMemory.
+#if defined(__GNUC__)
+__attribute__((target("avx")))
+#endif
+static size_t GCSafeFillMemoryAvx(void * mem, size_t size, UIntNative pv)
+{
+    ASSERT(IS_ALIGNED(mem, sizeof(void *)));
+    ASSERT(size >= GC_SAFE_FILL_AVX_THRESHOLD);
+
+    // align the stores to the vector size so that none of them splits a cache line
+    volatile UIntNative * memPtr = (UIntNative *)mem;
+    while (!IS_ALIGNED(memPtr, sizeof(__m256i)))
+    {
+        *memPtr++ = pv;
+        size -= sizeof(void *);
+    }
+
+    __m256i * vecPtr = (__m256i *)memPtr;
+    size_t nVectors = size / sizeof(__m256i);
+    __m256i vpv = _mm256_set1_epi64x((long long)pv);
+
+    if (size >= GC_SAFE_FILL_NONTEMPORAL_THRESHOLD)
+    {
+        for (size_t i = 0; i < nVectors; i++)
+            _mm256_stream_si256(vecPtr++, vpv);
+
+        // the non-temporal stores are weakly ordered, have them visible before anything written after the fill
+        _mm_sfence();
+    }
+    else
+    {
+        for (; nVectors >= 4; nVectors -= 4)
+        {
+            _mm256_store_si256(vecPtr, vpv);
+            _mm256_store_si256(vecPtr + 1, vpv);
+            _mm256_store_si256(vecPtr + 2, vpv);
+            _mm256_store_si256(vecPtr + 3, vpv);
+            vecPtr += 4;
+        }
+
+        for (size_t i = 0; i < nVectors; i++)
+            _mm256_store_si256(vecPtr++, vpv);
+    }
+
+    return (UInt8 *)vecPtr - (UInt8 *)mem;
+}
+
+// Copies of at least this many bytes use 32 byte AVX loads and stores.
+#define GC_SAFE_COPY_AVX_THRESHOLD          256
+
+// Copies the start of the pointer aligned memory with 32 byte AVX loads and stores, every pointer sized element
+// of which is accessed atomically, and returns the number of bytes copied. The rest is left to
+// InlineForwardGCSafeCopy. As with it, the destination may overlap the source from below.
+#if defined(__GNUC__)
+__attribute__((target("avx")))
+#endif
+static size_t ForwardGCSafeCopyAvx(void * dest, const void * src, size_t len)
+{
+    ASSERT(len >= GC_SAFE_COPY_AVX_THRESHOLD);
+
+    // align the stores to the vector size so that none of them splits a cache line
+    UIntNative * dmem = (UIntNative *)dest;
+    const UIntNative * smem = (const UIntNative *)src;
+    while (!IS_ALIGNED(dmem, sizeof(__m256i)))
+        *dmem++ = *smem++;
+
+    size_t size = len - ((UInt8 *)dmem - (UInt8 *)dest);
+    for (; size >= 4 * sizeof(__m256i); size -= 4 * sizeof(__m256i))
+    {
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)smem);
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)smem + 1);
+        __m256i v2 = _mm256_loadu_si256((const __m256i *)smem + 2);
+        __m256i v3 = _mm256_loadu_si256((const __m256i *)smem + 3);
+        _mm256_store_si256((__m256i *)dmem, v0);
+        _mm256_store_si256((__m256i *)dmem + 1, v1);
+        _mm256_store_si256((__m256i *)dmem + 2, v2);
+        _mm256_store_si256((__m256i *)dmem + 3, v3);
+        smem += 4 * sizeof(__m256i) / sizeof(UIntNative);
+        dmem += 4 * sizeof(__m256i) / sizeof(UIntNative);
+    }
+
+    return (UInt8 *)dmem - (UInt8 *)dest;
+}
+
+// Like ForwardGCSafeCopyAvx, but copies the end of the memory, from the top down, and leaves the start to
+// InlineBackwardGCSafeCopy. The destination may overlap the source from above.
+#if defined(__GNUC__)
+__attribute__((target("avx")))
+#endif
+static size_t BackwardGCSafeCopyAvx(void * dest, const void * src, size_t len)
+{
+    ASSERT(len >= GC_SAFE_COPY_AVX_THRESHOLD);
+
+    UIntNative * dmem = (UIntNative *)((UInt8 *)dest + len);
+    const UIntNative * smem = (const UIntNative *)((const UInt8 *)src + len);
+    while (!IS_ALIGNED(dmem, sizeof(__m256i)))
+        *--dmem = *--smem;
+
+    size_t size = (UInt8 *)dmem - (UInt8 *)dest;
+    for (; size >= 4 * sizeof(__m256i); size -= 4 * sizeof(__m256i))
+    {
+        smem -= 4 * sizeof(__m256i) / sizeof(UIntNative);
+        dmem -= 4 * sizeof(__m256i) / sizeof(UIntNative);
+        __m256i v3 = _mm256_loadu_si256((const __m256i *)smem + 3);
+        __m256i v2 = _mm256_loadu_si256((const __m256i *)smem + 2);
+        __m256i v1 = _mm256_loadu_si256((const __m256i *)smem + 1);
+        __m256i v0 = _mm256_loadu_si256((const __m256i *)smem);
+        _mm256_store_si256((__m256i *)dmem + 3, v3);
+        _mm256_store_si256((__m256i *)dmem + 2, v2);
+        _mm256_store_si256((__m256i *)dmem + 1, v1);
+        _mm256_store_si256((__m256i *)dmem, v0);
+    }
+
+    return len - ((UInt8 *)dmem - (UInt8 *)dest);
+}
+
+static void GCSafeFillMemoryWithAvx(void * mem, size_t size, size_t pv)
+{
+    if ((size >= GC_SAFE_FILL_AVX_THRESHOLD) && IS_ALIGNED(mem, sizeof(void *)))
+    {
+        size_t cbFilled = GCSafeFillMemoryAvx(mem, size, pv);
+        mem = (UInt8 *)mem + cbFilled;
+        size -= cbFilled;
+    }
+
+    InlineGCSafeFillMemory(mem, size, pv);
+}
+
+static void ForwardGCSafeCopyWithAvx(void * dest, const void * src, size_t len)
+{
+    if (len >= GC_SAFE_COPY_AVX_THRESHOLD)
+    {
+        size_t cbCopied = ForwardGCSafeCopyAvx(dest, src, len);
+        dest = (UInt8 *)dest + cbCopied;
+        src = (const UInt8 *)src + cbCopied;
+        len -= cbCopied;
+    }
+
+    InlineForwardGCSafeCopy(dest, src, len);
+}
+
+static void BackwardGCSafeCopyWithAvx(void * dest, const void * src, size_t len)
+{
+    if (len >= GC_SAFE_COPY_AVX_THRESHOLD)
+        len -= BackwardGCSafeCopyAvx(dest, src, len);
+
+    InlineBackwardGCSafeCopy(dest, src, len);
+}
+#endif // HOST_AMD64
+
+static void GCSafeFillMemoryBaseline(void * mem, size_t size, size_t pv)
+{
+    InlineGCSafeFillMemory(mem, size, pv);
+}
+
+static void ForwardGCSafeCopyBaseline(void * dest, const void * src, size_t len)
+{
+    InlineForwardGCSafeCopy(dest, src, len);
+}
+
+static void BackwardGCSafeCopyBaseline(void * dest, const void * src, size_t len)
+{
+    InlineBackwardGCSafeCopy(dest, src, len);
+}
+
+//
+// The out of line helpers below call through this table to the variants for the instruction sets of the
+// processor. It starts out with the variants that every processor of the architecture supports, so the helpers
+// work before InitializeGCMemoryHelpers runs, and isn't written after that.
+//
+struct GCMemoryHelperTable
+{
+    void (*pfnFill)(void * mem, size_t size, size_t pv);
+    void (*pfnForwardCopy)(void * dest, const void * src, size_t len);
+    void (*pfnBackwardCopy)(void * dest, const void * src, size_t len);
+};
+
+static GCMemoryHelperTable g_GCMemoryHelpers =
+{
+    GCSafeFillMemoryBaseline,
+    ForwardGCSafeCopyBaseline,
+    BackwardGCSafeCopyBaseline,
+};
+
+void InitializeGCMemoryHelpers()
+{
+#if defined(HOST_AMD64)
+    // 32 byte integer loads and stores only need AVX. AVX-512 isn't used, the 64 byte stores lower the clock
+    // of some processors for longer than a copy takes, and the helpers are limited by the caches, not by the
+    // width of the stores. ARM64 has NEON as its baseline already.
+    if ((g_cpuFeatures & XArchIntrinsicConstants_Avx) != 0)
+    {
+        g_GCMemoryHelpers.pfnFill = GCSafeFillMemoryWithAvx;
+        g_GCMemoryHelpers.pfnForwardCopy = ForwardGCSafeCopyWithAvx;
+        g_GCMemoryHelpers.pfnBackwardCopy = BackwardGCSafeCopyWithAvx;
+    }
+#endif // HOST_AMD64
+}
+
+// Out of line variant of InlineGCSafeFillMemory with the same guarantees, that uses the widest stores the
+// processor supports for large fills.
+void GCSafeFillMemory(void * mem, size_t size, size_t pv)
+{
+    g_GCMemoryHelpers.pfnFill(mem, size, pv);
+}
+
 // This function clears a piece of memory in a GC safe way.  It makes the guarantee that it will clear memory in at 
 // least pointer sized chunks whenever possible.  Unaligned memory at the beginning and remaining bytes at the end are 
 // written bytewise. We must make this guarantee whenever we clear memory in the GC heap that could contain object 
@@ -39,7 +258,7 @@ COOP_PINVOKE_CDECL_HELPER(void *, RhpInitMultibyte, (void * mem, int c, size_t s
             bv << 3*8 | bv << 2*8 | bv << 1*8 | bv;
     }
 
-    InlineGCSafeFillMemory(mem, size, pv);
+    GCSafeFillMemory(mem, size, pv);
 
     // memset returns the destination buffer
     return mem;
@@ -61,7 +280,7 @@ COOP_PINVOKE_CDECL_HELPER(void *, memcpyGCRefs, (void * dest, const void *src, s
     ASSERT(dest != nullptr);
     ASSERT(src != nullptr);
 
-    InlineForwardGCSafeCopy(dest, src, len);
+    g_GCMemoryHelpers.pfnForwardCopy(dest, src, len);
 
     // memcpy returns the destination buffer
     return dest;
@@ -83,7 +302,7 @@ COOP_PINVOKE_CDECL_HELPER(void *, memcpyGCRefsWithWriteBarrier, (void * dest, co
     ASSERT(dest != nullptr);
     ASSERT(src != nullptr);
 
-    InlineForwardGCSafeCopy(dest, src, len);
+    g_GCMemoryHelpers.pfnForwardCopy(dest, src, len);
     InlinedBulkWriteBarrier(dest, len);
 
     // memcpy returns the destination buffer
@@ -113,16 +332,16 @@ COOP_PINVOKE_CDECL_HELPER(void *, memcpyAnyWithWriteBarrier, (void * dest, const
 COOP_PINVOKE_HELPER(void, RhBulkMoveWithWriteBarrier, (uint8_t* pDest, uint8_t* pSrc, size_t cbDest))
 {
     if (pDest <= pSrc || pSrc + cbDest <= pDest)
-        InlineForwardGCSafeCopy(pDest, pSrc, cbDest);
+        g_GCMemoryHelpers.pfnForwardCopy(pDest, pSrc, cbDest);
     else
-        InlineBackwardGCSafeCopy(pDest, pSrc, cbDest);
+        g_GCMemoryHelpers.pfnBackwardCopy(pDest, pSrc, cbDest);
 
     InlinedBulkWriteBarrier(pDest, cbDest);
 }
 
 void GCSafeCopyMemoryWithWriteBarrier(void * dest, const void *src, size_t len)
 {
-    InlineForwardGCSafeCopy(dest, src, len);
+    g_GCMemoryHelpers.pfnForwardCopy(dest, src, len);
     InlinedBulkWriteBarrier(dest, len);
 }
 
@@ -6,6 +6,10 @@
 // Unmanaged GC memory helpers
 //
 
+// Selects the variants of the helpers for the instruction sets of the processor, once the CPU features are known.
+void InitializeGCMemoryHelpers();
+
+void GCSafeFillMemory(void * mem, size_t size, size_t pv);
 void GCSafeCopyMemoryWithWriteBarrier(void * dest, const void *src, size_t len);
 
 EXTERN_C void REDHAWK_CALLCONV RhpBulkWriteBarrier(void* pMemStart, UInt32 cbMemSize);
@@ -4,6 +4,29 @@
 
 #include "volatile.h"
 
+// On 64-bit targets the helpers below move 16 bytes at a time with SSE2/NEON. Every pointer sized element of
+// such a load or store is accessed atomically as long as it is pointer aligned, so other threads and the GC
+// never see a torn object reference. Both instruction sets are part of the baseline of their architecture.
+#if defined(HOST_AMD64)
+#include <emmintrin.h>
+#define GC_SAFE_VECTOR_COPY
+typedef __m128i GCSafeVector;
+#define GCSafeVectorLoad(p)         _mm_loadu_si128((const __m128i *)(p))
+#define GCSafeVectorStore(p, v)     _mm_storeu_si128((__m128i *)(p), (v))
+#define GCSafeVectorSplat(pv)       _mm_set1_epi64x((long long)(pv))
+#elif defined(HOST_ARM64)
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <arm64_neon.h>
+#else
+#include <arm_neon.h>
+#endif
+#define GC_SAFE_VECTOR_COPY
+typedef uint64x2_t GCSafeVector;
+#define GCSafeVectorLoad(p)         vld1q_u64((const uint64_t *)(p))
+#define GCSafeVectorStore(p, v)     vst1q_u64((uint64_t *)(p), (v))
+#define GCSafeVectorSplat(pv)       vdupq_n_u64((uint64_t)(pv))
+#endif
+
 //
 // Unmanaged GC memory helpers
 //
@@ -27,6 +50,20 @@ FORCEINLINE void InlineGCSafeFillMemory(void * mem, size_t size, size_t pv)
     // volatile ensures that this doesn't get optimized back into a memset call
     size_t nPtrs = (endBytes - memBytes) / sizeof(void *);
     volatile UIntNative* memPtr = (UIntNative*)memBytes;
+
+#ifdef GC_SAFE_VECTOR_COPY
+    const size_t nPtrsPerVector = sizeof(GCSafeVector) / sizeof(void *);
+    GCSafeVector vpv = GCSafeVectorSplat(pv);
+    for (; nPtrs >= 4 * nPtrsPerVector; nPtrs -= 4 * nPtrsPerVector)
+    {
+        GCSafeVectorStore(memPtr, vpv);
+        GCSafeVectorStore(memPtr + nPtrsPerVector, vpv);
+        GCSafeVectorStore(memPtr + 2 * nPtrsPerVector, vpv);
+        GCSafeVectorStore(memPtr + 3 * nPtrsPerVector, vpv);
+        memPtr += 4 * nPtrsPerVector;
+    }
+#endif // GC_SAFE_VECTOR_COPY
+
     for (size_t i = 0; i < nPtrs; i++)
         *memPtr++ = pv;
 
@@ -53,6 +90,24 @@ FORCEINLINE void InlineForwardGCSafeCopy(void * dest, const void *src, size_t le
     // regions must be non-overlapping
     ASSERT(dmem <= smem || smem + size <= dmem);
 
+#ifdef GC_SAFE_VECTOR_COPY
+    // copy 64 bytes at a time
+    while (size >= 4 * sizeof(GCSafeVector))
+    {
+        size -= 4 * sizeof(GCSafeVector);
+        GCSafeVector v0 = GCSafeVectorLoad(smem);
+        GCSafeVector v1 = GCSafeVectorLoad(smem + sizeof(GCSafeVector));
+        GCSafeVector v2 = GCSafeVectorLoad(smem + 2 * sizeof(GCSafeVector));
+        GCSafeVector v3 = GCSafeVectorLoad(smem + 3 * sizeof(GCSafeVector));
+        GCSafeVectorStore(dmem, v0);
+        GCSafeVectorStore(dmem + sizeof(GCSafeVector), v1);
+        GCSafeVectorStore(dmem + 2 * sizeof(GCSafeVector), v2);
+        GCSafeVectorStore(dmem + 3 * sizeof(GCSafeVector), v3);
+        smem += 4 * sizeof(GCSafeVector);
+        dmem += 4 * sizeof(GCSafeVector);
+    }
+#endif // GC_SAFE_VECTOR_COPY
+
     // copy 4 pointers at a time 
     while (size >= 4 * sizeof(size_t))
     {
@@ -95,6 +150,24 @@ FORCEINLINE void InlineBackwardGCSafeCopy(void * dest, const void *src, size_t l
     // regions must be non-overlapping
     ASSERT(smem <= dmem || dmem + size <= smem);
 
+#ifdef GC_SAFE_VECTOR_COPY
+    // copy 64 bytes at a time
+    while (size >= 4 * sizeof(GCSafeVector))
+    {
+        size -= 4 * sizeof(GCSafeVector);
+        smem -= 4 * sizeof(GCSafeVector);
+        dmem -= 4 * sizeof(GCSafeVector);
+        GCSafeVector v3 = GCSafeVectorLoad(smem + 3 * sizeof(GCSafeVector));
+        GCSafeVector v2 = GCSafeVectorLoad(smem + 2 * sizeof(GCSafeVector));
+        GCSafeVector v1 = GCSafeVectorLoad(smem + sizeof(GCSafeVector));
+        GCSafeVector v0 = GCSafeVectorLoad(smem);
+        GCSafeVectorStore(dmem + 3 * sizeof(GCSafeVector), v3);
+        GCSafeVectorStore(dmem + 2 * sizeof(GCSafeVector), v2);
+        GCSafeVectorStore(dmem + sizeof(GCSafeVector), v1);
+        GCSafeVectorStore(dmem, v0);
+    }
+#endif // GC_SAFE_VECTOR_COPY
+
     // copy 4 pointers at a time 
     while (size >= 4 * sizeof(size_t))
     {
@@ -147,6 +220,11 @@ FORCEINLINE void InlineWriteBarrier(void * dst, void * ref)
 {
     if (((uint8_t*)ref >= g_ephemeral_low) && ((uint8_t*)ref < g_ephemeral_high))
     {
+        // Generation 0 objects don't need their cards set since every GC scans all of generation 0.
+        // g_gen0_low is ~0 unless the precise write barrier is enabled.
+        if (((uint8_t*)dst >= g_gen0_low) && ((uint8_t*)dst < g_ephemeral_high))
+            return;
+
         // volatile is used here to prevent fetch of g_card_table from being reordered 
         // with g_lowest/highest_address check above. See comment in code:gc_heap::grow_brick_card_tables.
         uint8_t* pCardByte = (uint8_t *)VolatileLoadWithoutBarrier(&g_card_table) + ((size_t)dst >> LOG2_CLUMP_SIZE);
@@ -221,36 +299,49 @@ FORCEINLINE void InlinedBulkWriteBarrier(void* pMemStart, size_t cbMemSize)
 
 #endif // WRITE_BARRIER_CHECK
 
-    // Compute the starting card address and the number of bytes to write (groups of 8 cards). We could try
-    // for further optimization here using aligned 32-bit writes but there's some overhead in setup required
-    // and additional complexity. It's not clear this is warranted given that a single byte of card table
-    // update already covers 1K of object space (2K on 64-bit platforms). It's also not worth probing that
-    // 1K/2K range to see if any of the pointers appear to be non-ephemeral GC references. Given the size of
-    // the area the chances are high that at least one interesting GC refenence is present.
+    // A range that is entirely in generation 0 doesn't need cards, see InlineWriteBarrier.
+    if (((uint8_t*)pMemStart >= g_gen0_low) && ((uint8_t*)pMemStart + cbMemSize <= g_ephemeral_high))
+        return;
 
-    size_t startAddress = (size_t)pMemStart;
-    size_t endAddress = startAddress + cbMemSize;
-    size_t startingClump = startAddress >> LOG2_CLUMP_SIZE;
-    size_t endingClump = (endAddress + CLUMP_SIZE - 1) >> LOG2_CLUMP_SIZE;
+    // Only mark the cards that actually received a reference to an ephemeral object. Copies of large reference
+    // arrays between older objects would otherwise set every card the destination spans, and each of these
+    // cards is scanned (and found to be useless) by the following ephemeral GCs. The range is not known to
+    // contain only object references, so other data that happens to look like an ephemeral address marks a
+    // card as well, which is harmless. A card that is already set is not probed at all.
+    //
+    // No GC can happen while we run, so the ephemeral bounds can't change under us. The range test is a single
+    // unsigned compare per slot.
+    size_t ephemeralLow = (size_t)g_ephemeral_low;
+    size_t ephemeralRange = (size_t)g_ephemeral_high - ephemeralLow;
 
-    // calculate the number of clumps to mark (round_up(end) - start)
-    size_t clumpCount = endingClump - startingClump;
     // VolatileLoadWithoutBarrier() is used here to prevent fetch of g_card_table from being reordered 
     // with g_lowest/highest_address check at the beginning of this function. 
-    uint8_t* card = ((uint8_t*)VolatileLoadWithoutBarrier(&g_card_table)) + startingClump;
+    uint8_t* cardTable = (uint8_t*)VolatileLoadWithoutBarrier(&g_card_table);
+
+    UIntNative* pSlot = (UIntNative*)ALIGN_DOWN(pMemStart, sizeof(UIntNative));
+    UIntNative* pEnd = (UIntNative*)((uint8_t*)pMemStart + cbMemSize);
 
-    // Fill the cards. To avoid cache line thrashing we check whether the cards have already been set before
-    // writing.
-    do
+    while (pSlot < pEnd)
     {
+        UIntNative* pCardEnd = (UIntNative*)(((size_t)pSlot + CLUMP_SIZE) & ~((size_t)CLUMP_SIZE - 1));
+        if (pCardEnd > pEnd)
+            pCardEnd = pEnd;
+
+        // To avoid cache line thrashing we check whether the card has already been set before writing.
+        uint8_t* card = cardTable + ((size_t)pSlot >> LOG2_CLUMP_SIZE);
         if (*card != 0xff)
         {
-            *card = 0xff;
+            for (; pSlot < pCardEnd; pSlot++)
+            {
+                if ((*pSlot - ephemeralLow) < ephemeralRange)
+                {
+                    *card = 0xff;
+                    break;
+                }
+            }
         }
 
-        card++;
-        clumpCount--;
+        pSlot = pCardEnd;
     }
-    while (clumpCount != 0);
 }
 #endif // DACCESS_COMPILE
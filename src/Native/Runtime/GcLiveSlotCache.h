@@ -0,0 +1,114 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Cache of the live slots of a code manager's methods at the safe points GCs found them stopped at, keyed by
+// the safe point address. The same call sites are on the stacks at every GC, and decoding the GC info of a
+// method up to a code offset is the expensive part of reporting a frame. Unlike the decoded GC info, the
+// entries don't depend on the frame, so EnumGcRefs can report the slots of an entry again for any frame
+// stopped at the same address.
+//
+// Entries are immutable once published and are only freed with the cache, which is freed with its code
+// manager when the code is unloaded, so they can be read without locks. The cache doesn't evict: when all the
+// slots an address may use are taken, or a safe point has more live slots than an entry holds, the GC info
+// is just decoded every time.
+//
+// The live slots are only valid for the flags they were recorded with, the code managers only cache the
+// frames they enumerate without ICodeManagerFlags.
+//
+
+#pragma once
+
+class GcLiveSlotCache
+{
+    struct Entry
+    {
+        PTR_VOID m_safePointAddress;
+        GcLiveSlotList m_liveSlots;
+        GcLiveSlot m_slots[1];  // Actually m_liveSlots.NumSlots entries
+    };
+
+    static const UInt32 CacheSize = 1024;
+    static const UInt32 MaxProbes = 8;
+
+    Entry * volatile m_entries[CacheSize];
+
+    static UInt32 GetBucket(PTR_VOID safePointAddress)
+    {
+        UIntNative address = dac_cast<TADDR>(safePointAddress);
+        return (UInt32)((address >> 2) ^ (address >> 12)) % CacheSize;
+    }
+
+public:
+    // The most live slots an entry holds, and the size of the buffer to record the slots in
+    static const UInt32 MaxSlots = 64;
+
+    GcLiveSlotCache()
+    {
+        memset((void *)m_entries, 0, sizeof(m_entries));
+    }
+
+    ~GcLiveSlotCache()
+    {
+        for (UInt32 i = 0; i < CacheSize; i++)
+        {
+            delete[] (UInt8 *)m_entries[i];
+        }
+    }
+
+    GcLiveSlotList * Lookup(PTR_VOID safePointAddress)
+    {
+        UInt32 bucket = GetBucket(safePointAddress);
+        for (UInt32 i = 0; i < MaxProbes; i++)
+        {
+            Entry * pEntry = m_entries[(bucket + i) % CacheSize];
+            if (pEntry == NULL)
+                return NULL;
+
+            if (pEntry->m_safePointAddress == safePointAddress)
+                return &pEntry->m_liveSlots;
+        }
+
+        return NULL;
+    }
+
+    void Add(PTR_VOID safePointAddress, GcLiveSlotList * pLiveSlots)
+    {
+        ASSERT(pLiveSlots->IsComplete());
+
+        UInt32 nSlots = pLiveSlots->NumSlots;
+        size_t cbEntry = offsetof(Entry, m_slots) + (nSlots != 0 ? nSlots : 1) * sizeof(GcLiveSlot);
+        Entry * pEntry = (Entry *)new (nothrow) UInt8[cbEntry];
+        if (pEntry == NULL)
+            return;
+
+        pEntry->m_safePointAddress = safePointAddress;
+        pEntry->m_liveSlots = *pLiveSlots;
+        pEntry->m_liveSlots.pSlots = pEntry->m_slots;
+        pEntry->m_liveSlots.MaxSlots = nSlots;
+        memcpy(pEntry->m_slots, pLiveSlots->pSlots, nSlots * sizeof(GcLiveSlot));
+
+        // The entry has to be complete before another thread can find it
+        PalMemoryBarrier();
+
+        UInt32 bucket = GetBucket(safePointAddress);
+        for (UInt32 i = 0; i < MaxProbes; i++)
+        {
+            Entry * volatile * ppSlot = &m_entries[(bucket + i) % CacheSize];
+            Entry * pExisting = *ppSlot;
+            if (pExisting == NULL)
+            {
+                pExisting = (Entry *)PalInterlockedCompareExchangePointer((void * volatile *)ppSlot, pEntry, NULL);
+                if (pExisting == NULL)
+                    return;
+            }
+
+            // Another thread may have added the same address first
+            if (pExisting->m_safePointAddress == safePointAddress)
+                break;
+        }
+
+        delete[] (UInt8 *)pEntry;
+    }
+};
@@ -119,9 +119,47 @@ private:
         return pEntry == NULL;    
     }
 
+    // Bloom filter of the call sites that already got their first hit GC, checked before taking the lock so
+    // that the threads don't serialize on it for the call sites hit over and over. A false positive only means
+    // that a new call site doesn't get its first hit GC; the hit counts are not kept up for the call sites the
+    // filter has seen.
+    static void GetFirstHitFilterBits(UIntNative CallsiteIP, UInt32 * pBit1, UInt32 * pBit2)
+    {
+        UInt64 hash = (UInt64)CallsiteIP * 0x9E3779B97F4A7C15ull;
+        *pBit1 = (UInt32)(hash >> 48) % FirstHitFilterBits;
+        *pBit2 = (UInt32)(hash >> 32) % FirstHitFilterBits;
+    }
+
+    static bool IsFirstHitFilterBitSet(UInt32 bit)
+    {
+        return (s_firstHitFilter[bit / 32] & (1u << (bit % 32))) != 0;
+    }
+
+    static void SetFirstHitFilterBit(UInt32 bit)
+    {
+        Int32 volatile * pWord = (Int32 volatile *)&s_firstHitFilter[bit / 32];
+        Int32 mask = (Int32)(1u << (bit % 32));
+        for (;;)
+        {
+            Int32 oldValue = *pWord;
+            if ((oldValue & mask) != 0 || PalInterlockedCompareExchange(pWord, oldValue | mask, oldValue) == oldValue)
+                return;
+        }
+    }
+
     static bool GcStressTriggerFirstHit(UIntNative CallsiteIP, HijackType ht)
     {
-        return GcStressTrackAtIP(CallsiteIP, ht, false);
+        UInt32 bit1, bit2;
+        GetFirstHitFilterBits(CallsiteIP, &bit1, &bit2);
+        if (IsFirstHitFilterBitSet(bit1) && IsFirstHitFilterBitSet(bit2))
+            return false;
+
+        bool fFirstHit = GcStressTrackAtIP(CallsiteIP, ht, false);
+
+        SetFirstHitFilterBit(bit1);
+        SetFirstHitFilterBit(bit2);
+
+        return fFirstHit;
     }
 
     static UInt32 GcStressRNG(UInt32 uMaxValue, Thread *pCurrentThread)
@@ -154,7 +192,10 @@ private:
     }
 
 private:
+    static const UInt32         FirstHitFilterBits = 64 * 1024;
+
     static CrstStatic           s_lock;
+    static UInt32 volatile      s_firstHitFilter[FirstHitFilterBits / 32];
     static UInt32               s_lGcStressRNGSeed;
     static UInt32               s_lGcStressFreqDenom;
     static volatile InitState   s_initState;
@@ -167,6 +208,7 @@ public:
 
 CallsiteCountSHash GcStressControl::s_callsites;
 CrstStatic GcStressControl::s_lock;
+UInt32 volatile GcStressControl::s_firstHitFilter[GcStressControl::FirstHitFilterBits / 32];
 UInt32 GcStressControl::s_lGcStressRNGSeed = 0;
 UInt32 GcStressControl::s_lGcStressFreqDenom = 0;
 volatile GcStressControl::InitState GcStressControl::s_initState = GcStressControl::isNotInited;
@@ -14,23 +14,67 @@
 #include "objecthandle.h"
 #include "RestrictedCallouts.h"
 #include "gchandleutilities.h"
+#include "EventSession.h"
 
 
 COOP_PINVOKE_HELPER(OBJECTHANDLE, RhpHandleAlloc, (Object *pObject, int type))
 {
-    return GCHandleUtilities::GetGCHandleManager()->GetGlobalHandleStore()->CreateHandleOfType(pObject, (HandleType)type);
+    OBJECTHANDLE handle = GCHandleUtilities::GetGCHandleManager()->GetGlobalHandleStore()->CreateHandleOfType(pObject, (HandleType)type);
+
+    if ((handle != NULL) && IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOC_TRACE))
+        WriteEventSessionHandle(EventSessionEvent_HandleCreated, handle, (UInt32)type);
+
+    return handle;
 }
 
 COOP_PINVOKE_HELPER(OBJECTHANDLE, RhpHandleAllocDependent, (Object *pPrimary, Object *pSecondary))
 {
-    return GCHandleUtilities::GetGCHandleManager()->GetGlobalHandleStore()->CreateDependentHandle(pPrimary, pSecondary);
+    OBJECTHANDLE handle = GCHandleUtilities::GetGCHandleManager()->GetGlobalHandleStore()->CreateDependentHandle(pPrimary, pSecondary);
+
+    if ((handle != NULL) && IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOC_TRACE))
+        WriteEventSessionHandle(EventSessionEvent_HandleCreated, handle, HNDTYPE_DEPENDENT);
+
+    return handle;
 }
 
 COOP_PINVOKE_HELPER(void, RhHandleFree, (OBJECTHANDLE handle))
 {
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOC_TRACE))
+        WriteEventSessionHandle(EventSessionEvent_HandleDestroyed, handle, 0);
+
     GCHandleUtilities::GetGCHandleManager()->DestroyHandleOfUnknownType(handle);
 }
 
+// Allocates a handle of the given type for every element of pObjects and stores them in pHandles, which must
+// have room for as many handles as there are elements. Either all handles are allocated or none are.
+COOP_PINVOKE_HELPER(Boolean, RhpHandleAllocBatch, (Array *pObjects, int type, OBJECTHANDLE *pHandles))
+{
+    if (!GCHandleUtilities::GetGCHandleManager()->GetGlobalHandleStore()->CreateHandlesOfType(
+        (Object **)pObjects->GetArrayData(), (HandleType)type, pHandles, pObjects->GetArrayLength()))
+    {
+        return Boolean_false;
+    }
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOC_TRACE))
+    {
+        for (UInt32 i = 0; i < pObjects->GetArrayLength(); i++)
+            WriteEventSessionHandle(EventSessionEvent_HandleCreated, pHandles[i], (UInt32)type);
+    }
+
+    return Boolean_true;
+}
+
+COOP_PINVOKE_HELPER(void, RhHandleFreeBatch, (OBJECTHANDLE *pHandles, UInt32 count))
+{
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOC_TRACE))
+    {
+        for (UInt32 i = 0; i < count; i++)
+            WriteEventSessionHandle(EventSessionEvent_HandleDestroyed, pHandles[i], 0);
+    }
+
+    GCHandleUtilities::GetGCHandleManager()->DestroyHandlesOfUnknownType(pHandles, count);
+}
+
 COOP_PINVOKE_HELPER(Object *, RhHandleGet, (OBJECTHANDLE handle))
 {
     return ObjectFromHandle(handle);
@@ -65,7 +109,12 @@ COOP_PINVOKE_HELPER(void, RhUnregisterRefCountedHandleCallback, (void * pCallout
 
 COOP_PINVOKE_HELPER(OBJECTHANDLE, RhpHandleAllocVariable, (Object * pObject, UInt32 type)) 
 {
-    return GCHandleUtilities::GetGCHandleManager()->GetGlobalHandleStore()->CreateHandleWithExtraInfo(pObject, HNDTYPE_VARIABLE, (void*)((uintptr_t)type));
+    OBJECTHANDLE handle = GCHandleUtilities::GetGCHandleManager()->GetGlobalHandleStore()->CreateHandleWithExtraInfo(pObject, HNDTYPE_VARIABLE, (void*)((uintptr_t)type));
+
+    if ((handle != NULL) && IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOC_TRACE))
+        WriteEventSessionHandle(EventSessionEvent_HandleCreated, handle, HNDTYPE_VARIABLE);
+
+    return handle;
 }
 
 COOP_PINVOKE_HELPER(UInt32, RhHandleGetVariableType, (OBJECTHANDLE handle))
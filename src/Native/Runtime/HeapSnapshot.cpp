@@ -0,0 +1,604 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "common.h"
+#include "gcenv.h"
+#include "gcheaputilities.h"
+#include "gcrhinterface.h"
+#include "slist.h"
+#include "varint.h"
+#include "regdisplay.h"
+#include "StackFrameIterator.h"
+#include "thread.h"
+#include "holder.h"
+#include "RWLock.h"
+#include "threadstore.h"
+#include "threadstore.inl"
+#include "thread.inl"
+#include "RhConfig.h"
+
+#include "HeapSnapshot.h"
+
+//
+// The snapshot is written by the thread that did the GC, with the threads suspended, by walking the roots and
+// then the heap the way the ETW heap dump in GCProfileWalkHeapWorker does. Records are collected in the blocks
+// of the writer and a block is appended to the file when it is full, so the memory used doesn't depend on the
+// size of the heap. The references of an object that has more than fit a block are streamed to a block of
+// their own.
+//
+#define HEAP_SNAPSHOT_OBJECTS_PER_BLOCK     16384
+#define HEAP_SNAPSHOT_REFERENCES_PER_BLOCK  65536
+#define HEAP_SNAPSHOT_ROOTS_PER_BLOCK       16384
+#define HEAP_SNAPSHOT_SIGNAL_POLL_INTERVAL  100         // milliseconds
+
+static CrstStatic g_HeapSnapshotLock;
+static bool volatile g_fHeapSnapshotRequested = false;
+static bool g_fHeapSnapshotWritten = false;
+static UInt32 g_cHeapSnapshots = 0;
+static Int32 volatile g_heapSnapshotSignaled = 0;
+
+class HeapSnapshotWriter
+{
+    HANDLE                  m_hFile;
+    UInt64                  m_offset;
+    bool                    m_fFailed;
+
+    HeapSnapshotIndexEntry *m_rgIndex;
+    UInt32                  m_cIndex;
+    UInt32                  m_cIndexCapacity;
+
+    // Open addressed EEType to type index map, m_cTypeSlots is a power of 2
+    EEType **               m_rgTypeSlots;
+    UInt32 *                m_rgTypeSlotIndexes;
+    UInt32                  m_cTypeSlots;
+    HeapSnapshotType *      m_rgTypes;
+    UInt32                  m_cTypes;
+    UInt32                  m_cTypesCapacity;
+
+    HANDLE *                m_rgModules;
+    UInt32                  m_cModules;
+    UInt32                  m_cModulesCapacity;
+
+    UInt32                  m_cObjects;
+    UInt32                  m_cReferences;
+    UInt32                  m_cRoots;
+    HeapSnapshotObject      m_rgObjects[HEAP_SNAPSHOT_OBJECTS_PER_BLOCK];
+    UInt64                  m_rgReferences[HEAP_SNAPSHOT_REFERENCES_PER_BLOCK];
+    HeapSnapshotRoot        m_rgRoots[HEAP_SNAPSHOT_ROOTS_PER_BLOCK];
+
+    template <typename T>
+    static bool Grow(T ** prgItems, UInt32 * pcCapacity, UInt32 cInitial)
+    {
+        UInt32 cNewCapacity = (*pcCapacity == 0) ? cInitial : *pcCapacity * 2;
+        T * rgNewItems = new (nothrow) T[cNewCapacity];
+        if (rgNewItems == NULL)
+            return false;
+
+        if (*prgItems != NULL)
+        {
+            memcpy(rgNewItems, *prgItems, *pcCapacity * sizeof(T));
+            delete[] *prgItems;
+        }
+
+        *prgItems = rgNewItems;
+        *pcCapacity = cNewCapacity;
+        return true;
+    }
+
+    void Write(const void * pData, UInt64 cbData)
+    {
+        const UInt8 * pCurrent = (const UInt8 *)pData;
+        while (!m_fFailed && (cbData != 0))
+        {
+            UInt32 cbChunk = (UInt32)min(cbData, (UInt64)0x40000000);
+            if (!PalWriteFileContents(m_hFile, pCurrent, cbChunk))
+                m_fFailed = true;
+
+            m_offset += cbChunk;
+            pCurrent += cbChunk;
+            cbData -= cbChunk;
+        }
+    }
+
+    void Pad()
+    {
+        static const UInt8 s_zeroes[8] = { 0 };
+        if ((m_offset & 7) != 0)
+            Write(s_zeroes, 8 - (m_offset & 7));
+    }
+
+    void BeginBlock(HeapSnapshotBlockKind kind, UInt32 count, UInt64 cbBlock)
+    {
+        ASSERT((m_offset & 7) == 0);
+
+        if ((m_cIndex == m_cIndexCapacity) && !Grow(&m_rgIndex, &m_cIndexCapacity, 64))
+        {
+            m_fFailed = true;
+            return;
+        }
+
+        m_rgIndex[m_cIndex].Kind = kind;
+        m_rgIndex[m_cIndex].Count = count;
+        m_rgIndex[m_cIndex].Offset = m_offset;
+        m_cIndex++;
+
+        HeapSnapshotBlockHeader header;
+        header.Kind = kind;
+        header.Count = count;
+        header.cbBlock = cbBlock;
+        Write(&header, sizeof(header));
+    }
+
+    UInt32 GetModuleIndex(EEType * pEEType)
+    {
+        HANDLE hModule = PalGetModuleHandleFromPointer(pEEType);
+        if (hModule == NULL)
+            return ~0u;
+
+        for (UInt32 i = 0; i < m_cModules; i++)
+        {
+            if (m_rgModules[i] == hModule)
+                return i;
+        }
+
+        if ((m_cModules == m_cModulesCapacity) && !Grow(&m_rgModules, &m_cModulesCapacity, 8))
+            return ~0u;
+
+        m_rgModules[m_cModules] = hModule;
+        return m_cModules++;
+    }
+
+    bool GrowTypeSlots()
+    {
+        UInt32 cNewSlots = (m_cTypeSlots == 0) ? 1024 : m_cTypeSlots * 2;
+        EEType ** rgNewSlots = new (nothrow) EEType *[cNewSlots];
+        UInt32 * rgNewSlotIndexes = new (nothrow) UInt32[cNewSlots];
+        if ((rgNewSlots == NULL) || (rgNewSlotIndexes == NULL))
+        {
+            delete[] rgNewSlots;
+            delete[] rgNewSlotIndexes;
+            return false;
+        }
+
+        memset(rgNewSlots, 0, cNewSlots * sizeof(EEType *));
+
+        for (UInt32 i = 0; i < m_cTypeSlots; i++)
+        {
+            if (m_rgTypeSlots[i] == NULL)
+                continue;
+
+            UInt32 iSlot = GetTypeSlot(m_rgTypeSlots[i], cNewSlots);
+            while (rgNewSlots[iSlot] != NULL)
+                iSlot = (iSlot + 1) & (cNewSlots - 1);
+
+            rgNewSlots[iSlot] = m_rgTypeSlots[i];
+            rgNewSlotIndexes[iSlot] = m_rgTypeSlotIndexes[i];
+        }
+
+        delete[] m_rgTypeSlots;
+        delete[] m_rgTypeSlotIndexes;
+        m_rgTypeSlots = rgNewSlots;
+        m_rgTypeSlotIndexes = rgNewSlotIndexes;
+        m_cTypeSlots = cNewSlots;
+        return true;
+    }
+
+    static UInt32 GetTypeSlot(EEType * pEEType, UInt32 cSlots)
+    {
+        return (UInt32)(((size_t)pEEType >> 3) * 0x9E3779B1) & (cSlots - 1);
+    }
+
+    UInt32 GetTypeIndex(EEType * pEEType)
+    {
+        // Keep the table at most half full
+        if ((m_cTypes * 2 >= m_cTypeSlots) && !GrowTypeSlots())
+        {
+            m_fFailed = true;
+            return 0;
+        }
+
+        UInt32 iSlot = GetTypeSlot(pEEType, m_cTypeSlots);
+        while (m_rgTypeSlots[iSlot] != NULL)
+        {
+            if (m_rgTypeSlots[iSlot] == pEEType)
+                return m_rgTypeSlotIndexes[iSlot];
+
+            iSlot = (iSlot + 1) & (m_cTypeSlots - 1);
+        }
+
+        if ((m_cTypes == m_cTypesCapacity) && !Grow(&m_rgTypes, &m_cTypesCapacity, 1024))
+        {
+            m_fFailed = true;
+            return 0;
+        }
+
+        HeapSnapshotType * pType = &m_rgTypes[m_cTypes];
+        pType->TypeId = (UInt64)(size_t)pEEType;
+        pType->RelatedTypeId = pEEType->IsParameterizedType() ? (UInt64)(size_t)pEEType->get_RelatedParameterType() : 0;
+        pType->ModuleIndex = GetModuleIndex(pEEType);
+        pType->BaseSize = pEEType->get_BaseSize();
+        pType->ComponentSize = pEEType->get_ComponentSize();
+        pType->Flags = (pEEType->IsArray() ? HEAP_SNAPSHOT_TYPE_FLAG_ARRAY : 0) |
+                       (pEEType->get_IsValueType() ? HEAP_SNAPSHOT_TYPE_FLAG_VALUE_TYPE : 0) |
+                       (pEEType->HasFinalizer() ? HEAP_SNAPSHOT_TYPE_FLAG_FINALIZER : 0) |
+                       (pEEType->HasReferenceFields() ? HEAP_SNAPSHOT_TYPE_FLAG_REFERENCE_FIELDS : 0);
+
+        m_rgTypeSlots[iSlot] = pEEType;
+        m_rgTypeSlotIndexes[iSlot] = m_cTypes;
+        return m_cTypes++;
+    }
+
+    void FlushObjects()
+    {
+        if (m_cObjects == 0)
+            return;
+
+        BeginBlock(HeapSnapshotBlock_Objects, m_cObjects,
+                   (UInt64)m_cObjects * sizeof(HeapSnapshotObject) + (UInt64)m_cReferences * sizeof(UInt64));
+        Write(m_rgObjects, m_cObjects * sizeof(HeapSnapshotObject));
+        Write(m_rgReferences, m_cReferences * sizeof(UInt64));
+
+        m_cObjects = 0;
+        m_cReferences = 0;
+    }
+
+    static bool CountReference(Object * pReference, void * pvContext)
+    {
+        UNREFERENCED_PARAMETER(pReference);
+        (*(UInt32 *)pvContext)++;
+        return true;
+    }
+
+    static bool SaveReference(Object * pReference, void * pvContext)
+    {
+        HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pvContext;
+        pWriter->m_rgReferences[pWriter->m_cReferences++] = (UInt64)(size_t)pReference;
+        return true;
+    }
+
+    static bool StreamReference(Object * pReference, void * pvContext)
+    {
+        HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pvContext;
+        if (pWriter->m_cReferences == HEAP_SNAPSHOT_REFERENCES_PER_BLOCK)
+        {
+            pWriter->Write(pWriter->m_rgReferences, sizeof(pWriter->m_rgReferences));
+            pWriter->m_cReferences = 0;
+        }
+
+        pWriter->m_rgReferences[pWriter->m_cReferences++] = (UInt64)(size_t)pReference;
+        return true;
+    }
+
+public:
+    HeapSnapshotWriter()
+        : m_hFile(INVALID_HANDLE_VALUE), m_offset(0), m_fFailed(false),
+          m_rgIndex(NULL), m_cIndex(0), m_cIndexCapacity(0),
+          m_rgTypeSlots(NULL), m_rgTypeSlotIndexes(NULL), m_cTypeSlots(0),
+          m_rgTypes(NULL), m_cTypes(0), m_cTypesCapacity(0),
+          m_rgModules(NULL), m_cModules(0), m_cModulesCapacity(0),
+          m_cObjects(0), m_cReferences(0), m_cRoots(0)
+    {
+    }
+
+    ~HeapSnapshotWriter()
+    {
+        if (m_hFile != INVALID_HANDLE_VALUE)
+            PalCloseHandle(m_hFile);
+
+        delete[] m_rgIndex;
+        delete[] m_rgTypeSlots;
+        delete[] m_rgTypeSlotIndexes;
+        delete[] m_rgTypes;
+        delete[] m_rgModules;
+    }
+
+    bool HasFailed()
+    {
+        return m_fFailed;
+    }
+
+    bool Open(const TCHAR * fileName)
+    {
+        m_hFile = PalCreateFileForWriting(fileName);
+        if (m_hFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER timeStamp;
+        PalQueryPerformanceCounter(&timeStamp);
+
+        HeapSnapshotHeader header;
+        header.Magic = HEAP_SNAPSHOT_MAGIC;
+        header.Version = HEAP_SNAPSHOT_VERSION;
+        header.PointerSize = sizeof(void *);
+        header.CharSize = sizeof(TCHAR);
+        header.ProcessId = PalGetCurrentProcessId();
+        header.GcCount = GCHeapUtilities::GetGCHeap()->GetGcCount();
+        header.TimeStamp = (UInt64)timeStamp.QuadPart;
+        Write(&header, sizeof(header));
+
+        return !m_fFailed;
+    }
+
+    void AddRoot(UInt32 kind, UInt32 flags, void * pLocation, Object * pObject, Object * pSecondary)
+    {
+        if (m_cRoots == HEAP_SNAPSHOT_ROOTS_PER_BLOCK)
+            FlushRoots();
+
+        HeapSnapshotRoot * pRoot = &m_rgRoots[m_cRoots++];
+        pRoot->Location = (UInt64)(size_t)pLocation;
+        pRoot->Object = (UInt64)(size_t)pObject;
+        pRoot->Secondary = (UInt64)(size_t)pSecondary;
+        pRoot->Kind = kind;
+        pRoot->Flags = flags;
+    }
+
+    void FlushRoots()
+    {
+        if (m_cRoots == 0)
+            return;
+
+        BeginBlock(HeapSnapshotBlock_Roots, m_cRoots, (UInt64)m_cRoots * sizeof(HeapSnapshotRoot));
+        Write(m_rgRoots, m_cRoots * sizeof(HeapSnapshotRoot));
+        m_cRoots = 0;
+    }
+
+    // Callback of DiagWalkHeap, returns false to stop the walk once writing failed
+    static bool AddObject(Object * pObject, void * pvContext)
+    {
+        HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pvContext;
+        IGCHeap * pHeap = GCHeapUtilities::GetGCHeap();
+
+        UInt32 cReferences = 0;
+        pHeap->DiagWalkObject(pObject, &CountReference, &cReferences);
+
+        if ((pWriter->m_cObjects == HEAP_SNAPSHOT_OBJECTS_PER_BLOCK) ||
+            (pWriter->m_cReferences + cReferences > HEAP_SNAPSHOT_REFERENCES_PER_BLOCK))
+        {
+            pWriter->FlushObjects();
+        }
+
+        HeapSnapshotObject * pRecord = &pWriter->m_rgObjects[pWriter->m_cObjects++];
+        pRecord->Address = (UInt64)(size_t)pObject;
+        pRecord->Size = pObject->GetSize();
+        pRecord->TypeIndex = pWriter->GetTypeIndex(pObject->get_SafeEEType());
+        pRecord->ReferenceCount = cReferences;
+
+        if (cReferences <= HEAP_SNAPSHOT_REFERENCES_PER_BLOCK)
+        {
+            if (cReferences != 0)
+                pHeap->DiagWalkObject(pObject, &SaveReference, pWriter);
+        }
+        else
+        {
+            // A block of its own, the references don't fit in memory
+            pWriter->BeginBlock(HeapSnapshotBlock_Objects, 1, sizeof(HeapSnapshotObject) + (UInt64)cReferences * sizeof(UInt64));
+            pWriter->Write(pRecord, sizeof(HeapSnapshotObject));
+            pWriter->m_cObjects = 0;
+
+            pHeap->DiagWalkObject(pObject, &StreamReference, pWriter);
+            pWriter->Write(pWriter->m_rgReferences, pWriter->m_cReferences * sizeof(UInt64));
+            pWriter->m_cReferences = 0;
+        }
+
+        return !pWriter->m_fFailed;
+    }
+
+    // Writes the types and modules seen, the index and the trailer. Returns false if anything couldn't be written.
+    bool Close()
+    {
+        FlushRoots();
+        FlushObjects();
+
+        BeginBlock(HeapSnapshotBlock_Types, m_cTypes, (UInt64)m_cTypes * sizeof(HeapSnapshotType));
+        Write(m_rgTypes, (UInt64)m_cTypes * sizeof(HeapSnapshotType));
+
+        HeapSnapshotModule * rgModules = new (nothrow) HeapSnapshotModule[m_cModules + 1];
+        if (rgModules == NULL)
+            m_fFailed = true;
+
+        UInt32 cbNames = 0;
+        for (UInt32 i = 0; !m_fFailed && (i < m_cModules); i++)
+        {
+            const TCHAR * pName = NULL;
+            Int32 cchName = PalGetModuleFileName(&pName, m_rgModules[i]);
+            rgModules[i].Base = (UInt64)(size_t)m_rgModules[i];
+            rgModules[i].NameOffset = cbNames;
+            rgModules[i].NameLength = (pName != NULL) ? (UInt32)cchName : 0;
+            cbNames += rgModules[i].NameLength * sizeof(TCHAR);
+        }
+
+        if (!m_fFailed)
+        {
+            BeginBlock(HeapSnapshotBlock_Modules, m_cModules,
+                       (UInt64)m_cModules * sizeof(HeapSnapshotModule) + ALIGN_UP(cbNames, 8));
+            Write(rgModules, m_cModules * sizeof(HeapSnapshotModule));
+
+            for (UInt32 i = 0; i < m_cModules; i++)
+            {
+                const TCHAR * pName = NULL;
+                PalGetModuleFileName(&pName, m_rgModules[i]);
+                Write(pName, rgModules[i].NameLength * sizeof(TCHAR));
+            }
+            Pad();
+        }
+
+        delete[] rgModules;
+
+        HeapSnapshotTrailer trailer;
+        trailer.IndexOffset = m_offset;
+        trailer.BlockCount = m_cIndex;
+        trailer.Magic = HEAP_SNAPSHOT_MAGIC;
+
+        Write(m_rgIndex, m_cIndex * sizeof(HeapSnapshotIndexEntry));
+        Write(&trailer, sizeof(trailer));
+
+        return !m_fFailed;
+    }
+};
+
+static void AddStackRoot(PTR_PTR_Object ppObject, ScanContext * pSC, UInt32 flags)
+{
+    HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pSC->_unused1;
+
+    Object * pObject = *ppObject;
+    UInt32 snapshotFlags = 0;
+
+    if (flags & GC_CALL_INTERIOR)
+    {
+        pObject = GCHeapUtilities::GetGCHeap()->GetContainingObject(pObject, false);
+        if (pObject == NULL)
+            return;
+        snapshotFlags |= HEAP_SNAPSHOT_ROOT_FLAG_INTERIOR;
+    }
+
+    if (flags & GC_CALL_PINNED)
+        snapshotFlags |= HEAP_SNAPSHOT_ROOT_FLAG_PINNING;
+
+    pWriter->AddRoot(HEAP_SNAPSHOT_ROOT_KIND_STACK, snapshotFlags, ppObject, pObject, NULL);
+}
+
+static void AddFinalizerRoot(Object ** ppObject, ScanContext * pSC, UInt32 /*flags*/)
+{
+    HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pSC->_unused1;
+    pWriter->AddRoot(HEAP_SNAPSHOT_ROOT_KIND_FINALIZER, 0, ppObject, *ppObject, NULL);
+}
+
+static void AddHandleRoot(Object ** pRef, Object * pSec, UInt32 flags, ScanContext * pSC, bool isDependent)
+{
+    HeapSnapshotWriter * pWriter = (HeapSnapshotWriter *)pSC->_unused1;
+    if (*pRef == NULL)
+        return;
+
+    pWriter->AddRoot(isDependent ? HEAP_SNAPSHOT_ROOT_KIND_DEPENDENT_HANDLE : HEAP_SNAPSHOT_ROOT_KIND_HANDLE,
+                     flags, pRef, *pRef, isDependent ? pSec : NULL);
+}
+
+static TCHAR * AppendNumber(TCHAR * pch, UInt32 value)
+{
+    TCHAR digits[10];
+    int cDigits = 0;
+    do
+    {
+        digits[cDigits++] = (TCHAR)(_T('0') + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (cDigits > 0)
+        *pch++ = digits[--cDigits];
+
+    return pch;
+}
+
+static bool WriteHeapSnapshot()
+{
+    TCHAR fileName[48] = _T("heapsnapshot_");
+    TCHAR * pch = fileName;
+    while (*pch != 0)
+        pch++;
+
+    pch = AppendNumber(pch, PalGetCurrentProcessId());
+    *pch++ = _T('_');
+    pch = AppendNumber(pch, g_cHeapSnapshots++);
+
+    const TCHAR extension[] = _T(".bin");
+    for (size_t i = 0; i < COUNTOF(extension); i++)
+        *pch++ = extension[i];
+
+    NewHolder<HeapSnapshotWriter> pWriter = new (nothrow) HeapSnapshotWriter();
+    if ((pWriter == NULL) || !pWriter->Open(fileName))
+        return false;
+
+    IGCHeap * pHeap = GCHeapUtilities::GetGCHeap();
+    int maxGeneration = (int)pHeap->GetMaxGeneration();
+
+    ScanContext sc;
+    sc.promotion = false;
+    sc._unused1 = pWriter;
+
+    FOREACH_THREAD(pThread)
+    {
+        if (pThread->IsGCSpecial())
+            continue;
+
+        sc.thread_under_crawl = pThread;
+        pThread->GcScanRoots(reinterpret_cast<void *>(&AddStackRoot), &sc);
+    }
+    END_FOREACH_THREAD
+
+    sc.thread_under_crawl = NULL;
+    pHeap->DiagScanFinalizeQueue(&AddFinalizerRoot, &sc);
+    pHeap->DiagScanHandles(&AddHandleRoot, maxGeneration, &sc);
+    pHeap->DiagScanDependentHandles(&AddHandleRoot, maxGeneration, &sc);
+
+    if (!pWriter->HasFailed())
+        pHeap->DiagWalkHeap(&HeapSnapshotWriter::AddObject, pWriter, maxGeneration, true /* walk the large object heap */);
+
+    return pWriter->Close();
+}
+
+void WriteHeapSnapshotIfRequested()
+{
+    if (!g_fHeapSnapshotRequested)
+        return;
+
+    g_fHeapSnapshotRequested = false;
+    g_fHeapSnapshotWritten = WriteHeapSnapshot();
+}
+
+// The thread must be in preemptive mode, so it doesn't hold up a GC started by another thread while it waits
+// for the lock.
+static UInt32_BOOL CollectAndWriteHeapSnapshot(Thread * pThread)
+{
+    CrstHolder lock(&g_HeapSnapshotLock);
+
+    g_fHeapSnapshotWritten = false;
+    g_fHeapSnapshotRequested = true;
+
+    pThread->DisablePreemptiveMode();
+    GCHeapUtilities::GetGCHeap()->GarbageCollect(-1, FALSE, collection_blocking);
+    pThread->EnablePreemptiveMode();
+
+    return g_fHeapSnapshotWritten ? UInt32_TRUE : UInt32_FALSE;
+}
+
+// Writes a snapshot of the GC heap to heapsnapshot_<pid>_<n>.bin in the current directory after a full blocking
+// GC. Returns false if the file couldn't be written.
+EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhpWriteHeapSnapshot()
+{
+    // This must be called via p/invoke rather than RuntimeImport to make the stack crawlable.
+
+    Thread * pCurThread = ThreadStore::GetCurrentThread();
+
+    pCurThread->SetupHackPInvokeTunnel();
+
+    ASSERT(!pCurThread->IsDoNotTriggerGcSet());
+    return CollectAndWriteHeapSnapshot(pCurThread);
+}
+
+static UInt32 __stdcall HeapSnapshotSignalThread(void * /*pContext*/)
+{
+    // The thread has no managed frames, so like the ETW thread that forces GCs it is attached as a GC special
+    // thread to keep the GC from walking its stack.
+    ThreadStore::AttachCurrentThread();
+    Thread * pThread = ThreadStore::GetCurrentThread();
+    pThread->SetGCSpecial(true);
+
+    for (;;)
+    {
+        PalSleep(HEAP_SNAPSHOT_SIGNAL_POLL_INTERVAL);
+
+        if (PalInterlockedExchange(&g_heapSnapshotSignaled, 0) != 0)
+            CollectAndWriteHeapSnapshot(pThread);
+    }
+}
+
+bool InitializeHeapSnapshot()
+{
+    g_HeapSnapshotLock.Init(CrstHeapSnapshot, CRST_DEFAULT);
+
+    // The runtime works the same without the signal, so failing to set it up isn't fatal.
+    UInt32 signal = g_pRhConfig->GetHeapSnapshotSignal();
+    if ((signal != 0) && PalSetFlagOnSignal(signal, &g_heapSnapshotSignaled))
+        PalStartBackgroundGCThread(HeapSnapshotSignalThread, NULL);
+
+    return true;
+}
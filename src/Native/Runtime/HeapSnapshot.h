@@ -0,0 +1,124 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Heap snapshots. RhpWriteHeapSnapshot, or on Unix the signal named by the HeapSnapshotSignal runtime
+// configuration value, induces a blocking GC and writes the objects of the GC heap, the references between
+// them, the roots and the types of the objects to heapsnapshot_<pid>_<n>.bin at the end of it, when the heap is
+// walked for ETW.
+//
+// The file starts with a HeapSnapshotHeader followed by blocks, and it ends with an index of the blocks and a
+// HeapSnapshotTrailer. A reader maps the file, finds the index from the trailer and uses the records of each
+// block in place. Blocks are written as the heap is walked, so only one block at a time is held in memory.
+// Every block is a HeapSnapshotBlockHeader followed by cbBlock bytes, and blocks and records are 8 byte aligned.
+//
+//  HeapSnapshotBlock_Roots     HeapSnapshotRoot[Count]
+//  HeapSnapshotBlock_Objects   HeapSnapshotObject[Count] followed by the references of the objects, one UInt64
+//                              address each, in the order of the objects
+//  HeapSnapshotBlock_Types     HeapSnapshotType[Count], TypeIndex of an object indexes the types of the file
+//  HeapSnapshotBlock_Modules   HeapSnapshotModule[Count] followed by the names, CharSize bytes per character
+//
+// The native runtime doesn't know the names of types, an EEType is identified by its address and the module it
+// belongs to. The symbols of the module name the EEType at that offset from the module base.
+//
+
+#pragma once
+
+#define HEAP_SNAPSHOT_MAGIC     0x504E5348  // 'HSNP'
+#define HEAP_SNAPSHOT_VERSION   1
+
+enum HeapSnapshotBlockKind
+{
+    HeapSnapshotBlock_Roots = 1,
+    HeapSnapshotBlock_Objects,
+    HeapSnapshotBlock_Types,
+    HeapSnapshotBlock_Modules,
+};
+
+struct HeapSnapshotHeader
+{
+    UInt32  Magic;
+    UInt32  Version;
+    UInt32  PointerSize;
+    UInt32  CharSize;                       // Size of the characters of module names
+    UInt32  ProcessId;
+    UInt32  GcCount;                        // Number of the GC the snapshot was taken at
+    UInt64  TimeStamp;                      // Performance counter value when the walk started
+};
+
+struct HeapSnapshotBlockHeader
+{
+    UInt32  Kind;                           // HeapSnapshotBlockKind
+    UInt32  Count;                          // Number of records of the kind
+    UInt64  cbBlock;                        // Bytes that follow the header
+};
+
+struct HeapSnapshotIndexEntry
+{
+    UInt32  Kind;
+    UInt32  Count;
+    UInt64  Offset;                         // Offset of the HeapSnapshotBlockHeader from the start of the file
+};
+
+struct HeapSnapshotTrailer
+{
+    UInt64  IndexOffset;                    // Offset of HeapSnapshotIndexEntry[BlockCount] from the start of the file
+    UInt32  BlockCount;
+    UInt32  Magic;
+};
+
+#define HEAP_SNAPSHOT_ROOT_KIND_STACK               0   // The same values as EtwGCRootKind
+#define HEAP_SNAPSHOT_ROOT_KIND_FINALIZER           1
+#define HEAP_SNAPSHOT_ROOT_KIND_HANDLE              2
+#define HEAP_SNAPSHOT_ROOT_KIND_OTHER               3
+#define HEAP_SNAPSHOT_ROOT_KIND_DEPENDENT_HANDLE    4   // Object keeps Secondary alive
+
+#define HEAP_SNAPSHOT_ROOT_FLAG_PINNING             0x1 // The same values as EtwGCRootFlags
+#define HEAP_SNAPSHOT_ROOT_FLAG_WEAK                0x2
+#define HEAP_SNAPSHOT_ROOT_FLAG_INTERIOR            0x4
+
+struct HeapSnapshotRoot
+{
+    UInt64  Location;                       // Stack slot, handle or finalization queue entry
+    UInt64  Object;                         // Object containing the address of an interior root
+    UInt64  Secondary;                      // Target of a dependent handle, 0 otherwise
+    UInt32  Kind;                           // HEAP_SNAPSHOT_ROOT_KIND_*
+    UInt32  Flags;                          // HEAP_SNAPSHOT_ROOT_FLAG_*
+};
+
+struct HeapSnapshotObject
+{
+    UInt64  Address;
+    UInt64  Size;
+    UInt32  TypeIndex;
+    UInt32  ReferenceCount;
+};
+
+#define HEAP_SNAPSHOT_TYPE_FLAG_ARRAY               0x1
+#define HEAP_SNAPSHOT_TYPE_FLAG_VALUE_TYPE          0x2
+#define HEAP_SNAPSHOT_TYPE_FLAG_FINALIZER           0x4
+#define HEAP_SNAPSHOT_TYPE_FLAG_REFERENCE_FIELDS    0x8
+
+struct HeapSnapshotType
+{
+    UInt64  TypeId;                         // Address of the EEType
+    UInt64  RelatedTypeId;                  // Element type of arrays and pointers, 0 otherwise
+    UInt32  ModuleIndex;                    // Module the EEType is in, ~0 for types built at runtime
+    UInt32  BaseSize;
+    UInt32  ComponentSize;
+    UInt32  Flags;                          // HEAP_SNAPSHOT_TYPE_FLAG_*
+};
+
+struct HeapSnapshotModule
+{
+    UInt64  Base;
+    UInt32  NameOffset;                     // Offset of the name from the end of the module records, in bytes
+    UInt32  NameLength;                     // In characters
+};
+
+bool InitializeHeapSnapshot();
+
+// Called at the end of every blocking GC while the execution engine is suspended, writes the snapshot if one
+// was requested.
+void WriteHeapSnapshotIfRequested();
@@ -109,6 +109,7 @@ enum class ClasslibFunctionId
     OnFirstChanceException = 6,
     DebugFuncEvalHelper = 7,
     DebugFuncEvalAbortHelper = 8,
+    AppendExceptionStackFrames = 9,
 };
 
 enum class AssociatedDataFlags : unsigned char
@@ -53,6 +53,14 @@ COOP_PINVOKE_HELPER(void, RhSpinWait, (Int32 iterations))
     YieldProcessorNormalizedForPreSkylakeCount(normalizationInfo, iterations);
 }
 
+// The most iterations a spin-wait should pass to RhSpinWait at a time, based on the measured delay of a yield. It is in the
+// pre-Skylake iterations RhSpinWait takes and follows the measurements RefreshYieldProcessorNormalized does.
+COOP_PINVOKE_HELPER(Int32, RhGetOptimalMaxSpinWaitsPerSpinIteration, ())
+{
+    const unsigned int PreSkylakeCountToSkylakeCountDivisor = 8;
+    return (Int32)(g_optimalMaxNormalizedYieldsPerSpinIteration * PreSkylakeCountToSkylakeCountDivisor);
+}
+
 // Yield the cpu to another thread ready to process, if one is available.
 EXTERN_C REDHAWK_API UInt32_BOOL __cdecl RhYield()
 {
@@ -455,7 +463,16 @@ COOP_PINVOKE_HELPER(Boolean, RhpArrayClear, (Array * pArray, Int32 index, Int32
     if (length == 0)
         return true;
 
-    InlineGCSafeFillMemory((UInt8 *)pArray->GetArrayData() + index * componentSize, length * componentSize, 0);
+    UInt8 * pStart = (UInt8 *)pArray->GetArrayData() + index * componentSize;
+    size_t cbClear = (size_t)length * componentSize;
+
+    // Without object references there is nothing another thread or the GC could see torn, and the CRT memset
+    // picks the fastest way to clear memory of the size on this processor, including rep stosb and non-temporal
+    // stores.
+    if (!pArrayType->HasReferenceFields())
+        memset(pStart, 0, cbClear);
+    else
+        GCSafeFillMemory(pStart, cbClear, 0);
 
     return true;
 }
@@ -484,6 +501,79 @@ EXTERN_C REDHAWK_API void __cdecl RhpReleaseCastCacheLock()
     g_CastCacheLock.Leave();
 }
 
+// Fixed size cast cache shared by all threads. The managed cast cache records its results under
+// g_CastCacheLock, so casts that miss it first look here: a result computed by any thread is recorded with a
+// few interlocked operations and can be found without the lock. Each entry is a seqlock, the sequence is odd
+// while a writer updates the entry and readers that see it odd or changed treat the lookup as a miss. Writers
+// that find the entry busy give up rather than wait, the result is just not cached. Entries are overwritten
+// by pairs that hash to the same slot, which is fine since the managed code can always compute the result
+// again. EETypes are never freed so a cached pair stays valid for the life of the process.
+#define NATIVE_CAST_CACHE_SIZE 4096 // MUST BE A POWER OF TWO
+
+struct NativeCastCacheEntry
+{
+    Int32           m_sequence;
+    UIntNative      m_sourceAndVariation;   // source EEType with the AssignmentVariation in the low 2 bits
+    UIntNative      m_targetAndResult;      // target EEType with the cast result in the low bit
+};
+
+static NativeCastCacheEntry s_nativeCastCache[NATIVE_CAST_CACHE_SIZE];
+
+static NativeCastCacheEntry * GetNativeCastCacheEntry(UIntNative sourceAndVariation, UIntNative target)
+{
+    UIntNative hash = sourceAndVariation ^ (target >> 4) ^ (target >> 16);
+    hash ^= hash >> 12;
+    return &s_nativeCastCache[hash & (NATIVE_CAST_CACHE_SIZE - 1)];
+}
+
+// Returns the cached result of casting pSourceType to pTargetType with the given AssignmentVariation, 1 if
+// the cast succeeds, 0 if it fails and -1 if the pair isn't cached.
+COOP_PINVOKE_HELPER(Int32, RhpCastCacheLookup, (EEType * pSourceType, EEType * pTargetType, UInt32 variation))
+{
+    ASSERT(variation <= 3);
+
+    UIntNative sourceAndVariation = (UIntNative)pSourceType | variation;
+    UIntNative target = (UIntNative)pTargetType;
+    NativeCastCacheEntry * pEntry = GetNativeCastCacheEntry(sourceAndVariation, target);
+
+    Int32 sequence = VolatileLoad(&pEntry->m_sequence);
+    if (sequence & 1)
+        return -1;
+
+    UIntNative entrySourceAndVariation = VolatileLoad(&pEntry->m_sourceAndVariation);
+    UIntNative entryTargetAndResult = VolatileLoad(&pEntry->m_targetAndResult);
+
+    if (VolatileLoad(&pEntry->m_sequence) != sequence)
+        return -1;
+
+    if ((entrySourceAndVariation != sourceAndVariation) || ((entryTargetAndResult & ~(UIntNative)1) != target))
+        return -1;
+
+    return (Int32)(entryTargetAndResult & 1);
+}
+
+// Records the result of a cast for RhpCastCacheLookup. Returns FALSE if the entry was being updated by
+// another thread and the result wasn't recorded.
+COOP_PINVOKE_HELPER(UInt32_BOOL, RhpCastCacheAdd, (EEType * pSourceType, EEType * pTargetType, UInt32 variation, UInt32_BOOL result))
+{
+    ASSERT(variation <= 3);
+    ASSERT(((UIntNative)pSourceType & 3) == 0);
+
+    UIntNative sourceAndVariation = (UIntNative)pSourceType | variation;
+    UIntNative target = (UIntNative)pTargetType;
+    NativeCastCacheEntry * pEntry = GetNativeCastCacheEntry(sourceAndVariation, target);
+
+    Int32 sequence = VolatileLoad(&pEntry->m_sequence);
+    if ((sequence & 1) || (PalInterlockedCompareExchange((Int32 volatile *)&pEntry->m_sequence, sequence + 1, sequence) != sequence))
+        return FALSE;
+
+    VolatileStore(&pEntry->m_sourceAndVariation, sourceAndVariation);
+    VolatileStore(&pEntry->m_targetAndResult, target | (result ? 1 : 0));
+    VolatileStore(&pEntry->m_sequence, sequence + 2);
+
+    return TRUE;
+}
+
 extern CrstStatic g_ThunkPoolLock;
 
 EXTERN_C REDHAWK_API void __cdecl RhpAcquireThunkPoolLock()
@@ -496,15 +586,107 @@ EXTERN_C REDHAWK_API void __cdecl RhpReleaseThunkPoolLock()
     g_ThunkPoolLock.Leave();
 }
 
-EXTERN_C Int32 __cdecl RhpCalculateStackTraceWorker(void* pOutputBuffer, UInt32 outputBufferLength);
+// Fills pOutputBuffer with the return addresses of the managed frames on the current thread's stack, starting
+// with the caller of RhGetCurrentThreadStackTrace.
+// Return value:    positive: number of entries written to pOutputBuffer
+//                  negative: number of required entries in pOutputBuffer in case it's too small (or null)
+EXTERN_C REDHAWK_API Int32 __cdecl RhpGetCurrentThreadStackTrace(void** pOutputBuffer, UInt32 outputBufferLength)
+{
+    // This must be called via p/invoke rather than RuntimeImport to make the stack crawlable.
+
+    Thread * pCurThread = ThreadStore::GetCurrentThread();
 
-EXTERN_C REDHAWK_API Int32 __cdecl RhpGetCurrentThreadStackTrace(void* pOutputBuffer, UInt32 outputBufferLength)
+    pCurThread->SetupHackPInvokeTunnel();
+    pCurThread->DisablePreemptiveMode();
+
+    UInt32 nFrames = 0;
+    bool success = true;
+
+    // The walk is done here rather than by a managed worker driving the iterator through RhpSfiInit and
+    // RhpSfiNext, which saves the reverse p/invoke and a runtime call per frame.
+    StackFrameIterator frameIterator;
+    frameIterator.InitForStackTrace();
+    ASSERT_MSG(frameIterator.IsValid(), "Missing RhGetCurrentThreadStackTrace frame");
+
+    // Skip the RhGetCurrentThreadStackTrace frame
+    frameIterator.Next();
+
+    while (frameIterator.IsValid())
+    {
+        if (nFrames < outputBufferLength)
+            pOutputBuffer[nFrames] = frameIterator.GetControlPC();
+        else
+            success = false;
+
+        nFrames++;
+        frameIterator.Next();
+    }
+
+    pCurThread->EnablePreemptiveMode();
+
+    return success ? (Int32)nFrames : -(Int32)nFrames;
+}
+
+// A frame returned by RhpGetCurrentThreadStackFrames, must match StackFrameData in RuntimeImports.cs.
+struct StackFrameData
+{
+    void *  IP;                     // Return address, the same value RhGetCurrentThreadStackTrace returns
+    void *  SP;
+    void *  MethodStart;            // What RhFindMethodStartAddress returns for IP
+    UInt32  Flags;                  // STACK_FRAME_DATA_FLAG_*
+};
+
+#define STACK_FRAME_DATA_FLAG_FUNCLET   0x1
+
+// Fills pFrames with the managed frames on the current thread's stack, starting with the caller of
+// RhGetCurrentThreadStackFrames after skipping skipFrames frames. Callers that don't know the depth of the
+// stack can fetch it in batches by moving skipFrames along.
+// Return value:    positive: number of entries written to pFrames
+//                  negative: number of frames after the skipped ones, when pFrames is too small (or null)
+EXTERN_C REDHAWK_API Int32 __cdecl RhpGetCurrentThreadStackFrames(StackFrameData* pFrames, UInt32 cFrames, UInt32 skipFrames)
 {
     // This must be called via p/invoke rather than RuntimeImport to make the stack crawlable.
 
-    ThreadStore::GetCurrentThread()->SetupHackPInvokeTunnel();
+    Thread * pCurThread = ThreadStore::GetCurrentThread();
+
+    pCurThread->SetupHackPInvokeTunnel();
+    pCurThread->DisablePreemptiveMode();
+
+    UInt32 nFrames = 0;
+    bool success = true;
+
+    StackFrameIterator frameIterator;
+    frameIterator.InitForStackTrace();
+    ASSERT_MSG(frameIterator.IsValid(), "Missing RhGetCurrentThreadStackFrames frame");
 
-    return RhpCalculateStackTraceWorker(pOutputBuffer, outputBufferLength);
+    // Skip the RhGetCurrentThreadStackFrames frame
+    frameIterator.Next();
+
+    for (; skipFrames > 0 && frameIterator.IsValid(); skipFrames--)
+        frameIterator.Next();
+
+    while (frameIterator.IsValid())
+    {
+        if (nFrames < cFrames)
+        {
+            StackFrameData * pFrame = &pFrames[nFrames];
+            pFrame->IP = frameIterator.GetControlPC();
+            pFrame->SP = (void *)frameIterator.GetRegisterSet()->GetSP();
+            pFrame->MethodStart = frameIterator.GetCodeManager()->GetMethodStartAddress(frameIterator.GetMethodInfo());
+            pFrame->Flags = frameIterator.GetCodeManager()->IsFunclet(frameIterator.GetMethodInfo()) ? STACK_FRAME_DATA_FLAG_FUNCLET : 0;
+        }
+        else
+        {
+            success = false;
+        }
+
+        nFrames++;
+        frameIterator.Next();
+    }
+
+    pCurThread->EnablePreemptiveMode();
+
+    return success ? (Int32)nFrames : -(Int32)nFrames;
 }
 
 COOP_PINVOKE_HELPER(void*, RhpRegisterFrozenSegment, (void* pSegmentStart, size_t length))
@@ -517,6 +699,13 @@ COOP_PINVOKE_HELPER(void, RhpUnregisterFrozenSegment, (void* pSegmentHandle))
     RedhawkGCInterface::UnregisterFrozenSegment((GcSegmentHandle)pSegmentHandle);
 }
 
+// Returns true if the preinitialized GC statics of the module are to be used in place (see
+// TypeManager::RegisterPreInitializedStatics) rather than copied to GC static objects on the GC heap.
+COOP_PINVOKE_HELPER(Boolean, RhpRegisterPreInitializedStatics, (TypeManagerHandle *pModule))
+{
+    return pModule->AsTypeManager()->RegisterPreInitializedStatics();
+}
+
 COOP_PINVOKE_HELPER(void*, RhpGetModuleSection, (TypeManagerHandle *pModule, Int32 headerId, Int32* length))
 {
     return pModule->AsTypeManager()->GetModuleSection((ReadyToRunSectionType)headerId, length);
@@ -0,0 +1,62 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "common.h"
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "rhassert.h"
+#include "stressLog.h"
+#include "NativeMemory.h"
+
+static Int64 volatile s_rgNativeMemoryBytes[NativeMemoryKind_Count];
+
+static void NativeMemoryUpdate(NativeMemoryKind kind, Int64 delta)
+{
+    ASSERT(kind < NativeMemoryKind_Count);
+
+    Int64 volatile * pBytes = &s_rgNativeMemoryBytes[kind];
+    Int64 oldBytes;
+    do
+    {
+        oldBytes = *pBytes;
+    }
+    while (PalInterlockedCompareExchange64(pBytes, oldBytes + delta, oldBytes) != oldBytes);
+
+    ASSERT(oldBytes + delta >= 0);
+}
+
+void NativeMemoryAdd(NativeMemoryKind kind, UIntNative cbMem)
+{
+    NativeMemoryUpdate(kind, (Int64)cbMem);
+}
+
+void NativeMemoryRemove(NativeMemoryKind kind, UIntNative cbMem)
+{
+    NativeMemoryUpdate(kind, -(Int64)cbMem);
+}
+
+// Copies the counters of up to cKinds kinds to pBytes and returns the number of kinds the runtime tracks, so
+// callers can size the buffer with a call that passes 0.
+COOP_PINVOKE_HELPER(UInt32, RhGetNativeMemoryInfo, (Int64 * pBytes, UInt32 cKinds))
+{
+    for (UInt32 i = 0; i < cKinds && i < NativeMemoryKind_Count; i++)
+    {
+        if (i == NativeMemoryKind_StressLog)
+        {
+            // The stress log already counts its chunks
+#ifdef STRESS_LOG
+            pBytes[i] = (Int64)StressLog::theLog.totalChunk * STRESSLOG_CHUNK_SIZE;
+#else
+            pBytes[i] = 0;
+#endif
+            continue;
+        }
+
+        pBytes[i] = s_rgNativeMemoryBytes[i];
+    }
+
+    return NativeMemoryKind_Count;
+}
@@ -0,0 +1,31 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Accounting of the native memory the runtime allocates for its own structures, which is not part of the GC
+// heap. Each allocation site of a tracked structure adds the bytes it allocates to the counter of its kind and
+// subtracts them when it frees them. RhGetNativeMemoryInfo copies the counters out, indexed by NativeMemoryKind.
+//
+// The counters are bytes requested from the native heap, or reserved from the OS for the kinds that map memory,
+// so they don't include the overhead of the allocator. The kinds are not disjoint: the memory of the interface
+// dispatch caches comes from an AllocHeap and is also part of NativeMemoryKind_AllocHeap.
+//
+// The values of NativeMemoryKind are part of the contract with managed code, new kinds are added at the end.
+//
+
+#pragma once
+
+enum NativeMemoryKind
+{
+    NativeMemoryKind_AllocHeap,             // Blocks of AllocHeaps
+    NativeMemoryKind_InterfaceDispatch,     // Interface dispatch caches and megamorphic dispatch tables
+    NativeMemoryKind_Thunks,                // Mappings of thunks allocated at runtime
+    NativeMemoryKind_ThreadStatics,         // Thread statics storage of dynamic types and the tables that point to it
+    NativeMemoryKind_StressLog,             // Chunks of the stress log
+
+    NativeMemoryKind_Count
+};
+
+void NativeMemoryAdd(NativeMemoryKind kind, UIntNative cbMem);
+void NativeMemoryRemove(NativeMemoryKind kind, UIntNative cbMem);
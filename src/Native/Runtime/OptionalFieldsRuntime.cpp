@@ -16,6 +16,7 @@
 #include "eetype.h"
 #include "ObjectLayout.h"
 #include "varint.h"
+#include "volatile.h"
 
 // Reads the field type from the current byte of the stream and indicates whether this represents the last
 // field.
@@ -70,3 +71,53 @@ UInt32 OptionalFields::DecodeFieldValue(PTR_UInt8 * ppFields)
     // Reached end of stream without getting a match. Field is not present so return default value.
     return uiDefaultValue;
 }
+
+#ifndef DACCESS_COMPILE
+
+// Side table of the rare flags decoded from the optional fields of the types that asked for them last. Each
+// entry is a seqlock like the native cast cache: the sequence is odd while a writer updates the entry, and
+// readers that see it odd or changed decode the flags again. Writers that find the entry busy don't wait.
+// Types are never freed once they are published, so an entry stays valid as long as it names the same type.
+#define RARE_FLAGS_CACHE_SIZE 1024 // MUST BE A POWER OF TWO
+
+struct RareFlagsCacheEntry
+{
+    Int32       m_sequence;
+    UInt32      m_rareFlags;
+    EEType *    m_pEEType;
+};
+
+static RareFlagsCacheEntry s_rareFlagsCache[RARE_FLAGS_CACHE_SIZE];
+
+UInt32 EEType::GetCachedRareFlags()
+{
+    ASSERT(HasOptionalFields());
+
+    UIntNative key = (UIntNative)this;
+    RareFlagsCacheEntry * pEntry = &s_rareFlagsCache[((key >> 4) ^ (key >> 14)) & (RARE_FLAGS_CACHE_SIZE - 1)];
+
+    Int32 sequence = VolatileLoad(&pEntry->m_sequence);
+    if ((sequence & 1) == 0)
+    {
+        EEType * pEntryEEType = VolatileLoad(&pEntry->m_pEEType);
+        UInt32 rareFlags = VolatileLoad(&pEntry->m_rareFlags);
+
+        if ((pEntryEEType == this) && (VolatileLoad(&pEntry->m_sequence) == sequence))
+            return rareFlags;
+    }
+
+    // The default is zero if that particular field was not included.
+    UInt32 rareFlags = get_OptionalFields()->GetRareFlags(0);
+
+    if (((sequence & 1) == 0) &&
+        (PalInterlockedCompareExchange((Int32 volatile *)&pEntry->m_sequence, sequence + 1, sequence) == sequence))
+    {
+        VolatileStore(&pEntry->m_pEEType, this);
+        VolatileStore(&pEntry->m_rareFlags, rareFlags);
+        VolatileStore(&pEntry->m_sequence, sequence + 2);
+    }
+
+    return rareFlags;
+}
+
+#endif // !DACCESS_COMPILE
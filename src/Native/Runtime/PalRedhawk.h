@@ -706,8 +706,19 @@ REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalGetThreadContext(HANDLE hThread, _Out_
 
 REDHAWK_PALIMPORT Int32 REDHAWK_PALAPI PalGetProcessCpuCount();
 
+// Returns the number of the processor the calling thread is currently running on. This is only a hint (the
+// thread may be migrated at any time) and zero is returned on platforms that cannot provide the information.
+REDHAWK_PALIMPORT UInt32 REDHAWK_PALAPI PalGetCurrentProcessorNumber();
+
 REDHAWK_PALIMPORT UInt32 REDHAWK_PALAPI PalReadFileContents(_In_z_ const TCHAR *, _Out_writes_all_(maxBytesToRead) char * buff, _In_ UInt32 maxBytesToRead);
 
+// Creates the file, replacing an existing one, to be written sequentially with PalWriteFileContents. The
+// returned handle is closed with PalCloseHandle, INVALID_HANDLE_VALUE is returned on failure.
+REDHAWK_PALIMPORT HANDLE REDHAWK_PALAPI PalCreateFileForWriting(_In_z_ const TCHAR * fileName);
+
+// Appends cbBuffer bytes to a file created by PalCreateFileForWriting.
+REDHAWK_PALIMPORT UInt32_BOOL REDHAWK_PALAPI PalWriteFileContents(HANDLE hFile, _In_reads_bytes_(cbBuffer) const void * pBuffer, UInt32 cbBuffer);
+
 // Retrieves the entire range of memory dedicated to the calling thread's stack.  This does
 // not get the current dynamic bounds of the stack, which can be significantly smaller than 
 // the maximum bounds.
@@ -808,6 +819,10 @@ typedef UInt32 (__stdcall *BackgroundCallback)(_In_opt_ void* pCallbackContext);
 REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalStartBackgroundGCThread(_In_ BackgroundCallback callback, _In_opt_ void* pCallbackContext);
 REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalStartFinalizerThread(_In_ BackgroundCallback callback, _In_opt_ void* pCallbackContext);
 
+// Sets *pFlag to 1 whenever the process receives the signal, for a thread to poll. Returns false if the platform
+// has no signals or the handler couldn't be installed.
+REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalSetFlagOnSignal(UInt32 signal, _In_ Int32 volatile * pFlag);
+
 typedef UInt32_BOOL (*PalHijackCallback)(HANDLE hThread, _In_ PAL_LIMITED_CONTEXT* pThreadContext, _In_opt_ void* pCallbackContext);
 REDHAWK_PALIMPORT UInt32 REDHAWK_PALAPI PalHijack(HANDLE hThread, _In_ PalHijackCallback callback, _In_opt_ void* pCallbackContext);
 
@@ -850,6 +865,9 @@ REDHAWK_PALIMPORT Int32 __cdecl _stricmp(const char *string1, const char *string
 REDHAWK_PALIMPORT uint32_t REDHAWK_PALAPI getcpuid(uint32_t arg1, unsigned char result[16]);
 REDHAWK_PALIMPORT uint32_t REDHAWK_PALAPI getextcpuid(uint32_t arg1, uint32_t arg2, unsigned char result[16]);
 REDHAWK_PALIMPORT uint32_t REDHAWK_PALAPI xmmYmmStateSupport();
+#if defined(HOST_AMD64)
+REDHAWK_PALIMPORT uint32_t REDHAWK_PALAPI zmmStateSupport();
+#endif // defined(HOST_AMD64)
 REDHAWK_PALIMPORT bool REDHAWK_PALAPI PalIsAvxEnabled();
 #endif // defined(HOST_X86) || defined(HOST_AMD64)
 
@@ -167,6 +167,7 @@ typedef void (__fastcall * ThreadExitCallback)();
 
 extern ThreadExitCallback g_threadExitCallback;
 
+// Only the control registers (IP, SP, and FP and LR where they exist) of palContext are valid.
 typedef Int32 (*PHARDWARE_EXCEPTION_HANDLER)(UIntNative faultCode, UIntNative faultAddress, PAL_LIMITED_CONTEXT* palContext, UIntNative* arg0Reg, UIntNative* arg1Reg);
 #endif
 
@@ -166,6 +166,12 @@ inline void PalTerminateProcess(HANDLE arg1, UInt32 arg2)
     TerminateProcess(arg1, arg2);
 }
 
+extern "C" UInt32_BOOL __stdcall TryEnterCriticalSection(CRITICAL_SECTION *);
+inline UInt32_BOOL PalTryEnterCriticalSection(CRITICAL_SECTION * arg1)
+{
+    return TryEnterCriticalSection(arg1);
+}
+
 extern "C" UInt32 __stdcall WaitForSingleObjectEx(HANDLE, UInt32, UInt32_BOOL);
 inline UInt32 PalWaitForSingleObjectEx(HANDLE arg1, UInt32 arg2, UInt32_BOOL arg3)
 {
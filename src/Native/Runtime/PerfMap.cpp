@@ -0,0 +1,77 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "common.h"
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "rhassert.h"
+#include "holder.h"
+#include "Crst.h"
+#include "RhConfig.h"
+
+#include "PerfMap.h"
+
+static CrstStatic g_PerfMapLock;
+static HANDLE g_hPerfMapFile = INVALID_HANDLE_VALUE;
+
+#ifdef TARGET_UNIX
+// The name of a module is the file name of the module the address is in, without the directory
+static const char * GetModuleName(void * pvModuleAddress)
+{
+    const TCHAR * pModuleName = NULL;
+    HANDLE hModule = PalGetModuleHandleFromPointer(pvModuleAddress);
+    if ((hModule == NULL) || (PalGetModuleFileName(&pModuleName, hModule) == 0) || (pModuleName == NULL))
+        return "<unknown>";
+
+    const char * pFileName = strrchr(pModuleName, '/');
+    return (pFileName != NULL) ? pFileName + 1 : pModuleName;
+}
+#endif // TARGET_UNIX
+
+void PerfMapLogCode(void * pvStartRange, UIntNative cbRange, const char * szKind, void * pvModuleAddress)
+{
+#ifdef TARGET_UNIX
+    if ((g_hPerfMapFile == INVALID_HANDLE_VALUE) || (cbRange == 0))
+        return;
+
+    char line[512];
+    int cchLine;
+    if (pvModuleAddress != NULL)
+        cchLine = snprintf(line, sizeof(line), "%zx %zx %s %s\n", (size_t)pvStartRange, (size_t)cbRange, szKind, GetModuleName(pvModuleAddress));
+    else
+        cchLine = snprintf(line, sizeof(line), "%zx %zx %s\n", (size_t)pvStartRange, (size_t)cbRange, szKind);
+
+    if ((cchLine <= 0) || (cchLine >= (int)sizeof(line)))
+        return;
+
+    CrstHolder lock(&g_PerfMapLock);
+
+    // The profilers read the map after the process exits, a partial map is still better than none
+    PalWriteFileContents(g_hPerfMapFile, line, (UInt32)cchLine);
+#else
+    UNREFERENCED_PARAMETER(pvStartRange);
+    UNREFERENCED_PARAMETER(cbRange);
+    UNREFERENCED_PARAMETER(szKind);
+    UNREFERENCED_PARAMETER(pvModuleAddress);
+#endif // TARGET_UNIX
+}
+
+bool InitializePerfMap()
+{
+    g_PerfMapLock.Init(CrstPerfMap, CRST_DEFAULT);
+
+#ifdef TARGET_UNIX
+    if (g_pRhConfig->GetPerfMapEnabled() == 0)
+        return true;
+
+    // The runtime works the same without the map, so failing to create it isn't fatal.
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "/tmp/perf-%u.map", PalGetCurrentProcessId());
+    g_hPerfMapFile = PalCreateFileForWriting(fileName);
+#endif // TARGET_UNIX
+
+    return true;
+}
@@ -0,0 +1,24 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Perf map. When the PerfMapEnabled runtime configuration value is set on Unix, the code the runtime learns
+// about is described in /tmp/perf-<pid>.map, the file perf and the eBPF based profilers read to name the code
+// of a process that has no symbols. Every line is the start address and the size in hex and the name of the
+// range:
+//
+//  [managed code] <module>     The managed code of a module registered with RhRegisterOSModule
+//  [unboxing stubs] <module>   The unboxing stubs of the module
+//  [thunks]                    A mapping of thunks allocated by RhAllocateThunksMapping
+//
+// The profilers only use the map for addresses outside of mapped files, like the thunks. The ranges of the
+// modules are there for the ones that don't read the modules' symbols, everything else has a symbol in them.
+//
+
+#pragma once
+
+bool InitializePerfMap();
+
+// Appends a line for the range to the map if it is enabled
+void PerfMapLogCode(void * pvStartRange, UIntNative cbRange, const char * szKind, void * pvModuleAddress);
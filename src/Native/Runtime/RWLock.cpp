@@ -83,8 +83,13 @@ ReaderWriterLock::WriteHolder::~WriteHolder()
 #endif // !DACCESS_COMPILE
 }
 
-ReaderWriterLock::ReaderWriterLock(bool fBlockOnGc) :
-    m_RWLock(0)
+// Upper bound on the number of reader stripes of a lock in scalable reader mode.
+#define MAX_READER_STRIPES 32
+
+ReaderWriterLock::ReaderWriterLock(bool fBlockOnGc, bool fScalableReaders) :
+    m_RWLock(0),
+    m_pReaderStripes(NULL),
+    m_uReaderStripeMask(0)
 #if 0
     , m_WriterWaiting(false)
 #endif
@@ -95,6 +100,36 @@ ReaderWriterLock::ReaderWriterLock(bool fBlockOnGc) :
 #endif
         4000);
     m_fBlockOnGc = fBlockOnGc;
+
+#ifndef DACCESS_COMPILE
+    UInt32 cCpus = PalGetProcessCpuCount();
+    if (fScalableReaders && (cCpus > 1))
+    {
+        // One stripe per processor (rounded up to a power of two) keeps the chance of two concurrent
+        // readers sharing a stripe low. If the stripes can't be allocated the lock just uses the shared
+        // reader counter.
+        UInt32 cStripes = 1;
+        while ((cStripes < cCpus) && (cStripes < MAX_READER_STRIPES))
+            cStripes *= 2;
+
+        m_pReaderStripes = new (nothrow) ReaderStripe[cStripes];
+        if (m_pReaderStripes != NULL)
+        {
+            for (UInt32 i = 0; i < cStripes; i++)
+                m_pReaderStripes[i].m_cReaders = 0;
+            m_uReaderStripeMask = cStripes - 1;
+        }
+    }
+#else
+    UNREFERENCED_PARAMETER(fScalableReaders);
+#endif // !DACCESS_COMPILE
+}
+
+ReaderWriterLock::~ReaderWriterLock()
+{
+#ifndef DACCESS_COMPILE
+    delete[] m_pReaderStripes;
+#endif // !DACCESS_COMPILE
 }
 
 
@@ -119,8 +154,33 @@ bool ReaderWriterLock::DangerousTryPulseReadLock()
     return false;
 }
 
+// The stripe is derived from the address of the current thread's TLS block, so a thread takes and releases
+// its read lock on the same stripe even if it migrates to another processor in between.
+ReaderWriterLock::ReaderStripe * ReaderWriterLock::GetReaderStripe()
+{
+    UInt32 uHash = (UInt32)((size_t)ThreadStore::RawGetCurrentThread() >> 6) * 2654435761u;
+    return &m_pReaderStripes[(uHash >> 16) & m_uReaderStripeMask];
+}
+
 bool ReaderWriterLock::TryAcquireReadLock()
 {
+    if (m_pReaderStripes != NULL)
+    {
+        if (m_RWLock == -1)
+            return false;
+
+        // Announce the reader first and only then check for a writer. The writer does the opposite (takes
+        // m_RWLock, then checks the stripes), and both use full barriers, so at least one of them sees
+        // the other and backs off.
+        ReaderStripe * pStripe = GetReaderStripe();
+        PalInterlockedIncrement(&pStripe->m_cReaders);
+        if (m_RWLock != -1)
+            return true;
+
+        PalInterlockedDecrement(&pStripe->m_cReaders);
+        return false;
+    }
+
     Int32 RWLock;
 
     do 
@@ -193,6 +253,13 @@ void ReaderWriterLock::AcquireReadLockWorker()
 
 void ReaderWriterLock::ReleaseReadLock()
 {
+    if (m_pReaderStripes != NULL)
+    {
+        Int32 cReaders = PalInterlockedDecrement(&GetReaderStripe()->m_cReaders);
+        ASSERT(cReaders >= 0);
+        return;
+    }
+
     Int32 RWLock;
     RWLock = PalInterlockedDecrement(&m_RWLock);
     ASSERT(RWLock >= 0);
@@ -208,6 +275,20 @@ bool ReaderWriterLock::TryAcquireWriteLock()
     if (RWLock)
         return false;
 
+    if (m_pReaderStripes != NULL)
+    {
+        // New readers now back off, but the ones that got in before must be gone as well. If some are still
+        // there give the lock up again rather than keep readers out while waiting for them.
+        for (UInt32 i = 0; i <= m_uReaderStripeMask; i++)
+        {
+            if (m_pReaderStripes[i].m_cReaders != 0)
+            {
+                PalInterlockedExchange(&m_RWLock, 0);
+                return false;
+            }
+        }
+    }
+
 #if 0
     m_WriterWaiting = false;
 #endif
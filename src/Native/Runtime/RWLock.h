@@ -7,9 +7,20 @@
 
 class ReaderWriterLock
 {
-    volatile Int32  m_RWLock;       // lock used for R/W synchronization
+    // In scalable reader mode each reader only touches the counter of its own stripe (picked from the
+    // current thread, so that acquire and release always use the same one) instead of a single shared
+    // counter. Each stripe is the size of a cache line so stripes never share one.
+    struct ReaderStripe
+    {
+        volatile Int32  m_cReaders;
+        UInt8           m_rgPadding[64 - sizeof(Int32)];
+    };
+
+    volatile Int32  m_RWLock;       // lock used for R/W synchronization; only 0 or -1 in scalable reader mode
     Int32           m_spinCount;    // spin count for a reader waiting for a writer to release the lock
     bool            m_fBlockOnGc;   // True if the spinning writers should block when GC is in progress
+    ReaderStripe *  m_pReaderStripes;   // Reader counters in scalable reader mode, NULL otherwise
+    UInt32          m_uReaderStripeMask;
 
 
 #if 0
@@ -22,6 +33,8 @@ class ReaderWriterLock
     bool TryAcquireReadLock();
     bool TryAcquireWriteLock();
 
+    ReaderStripe * GetReaderStripe();
+
 public:
     class ReadHolder
     {
@@ -41,7 +54,10 @@ public:
         ~WriteHolder();
     };
 
-    ReaderWriterLock(bool fBlockOnGc = false);
+    // fScalableReaders trades a more expensive write lock acquisition (the writer has to check every reader
+    // stripe) for readers that don't contend on a shared cache line. Use it for read-mostly locks.
+    ReaderWriterLock(bool fBlockOnGc = false, bool fScalableReaders = false);
+    ~ReaderWriterLock();
 
     void AcquireReadLock();
     void ReleaseReadLock();
@@ -39,8 +39,14 @@ RestrictedCallouts::GcRestrictedCallout * RestrictedCallouts::s_rgGcRestrictedCa
 // The head of the chain of HandleTable callouts.
 RestrictedCallouts::HandleTableRestrictedCallout * RestrictedCallouts::s_pHandleTableRestrictedCallouts = NULL;
 
-// Lock protecting access to s_rgGcRestrictedCallouts and s_pHandleTableRestrictedCallouts during registration
-// and unregistration (not used during actual callbacks since everything is single threaded then).
+// The HandleTable callouts hashed by type filter, NULL if there are none or the table couldn't be allocated.
+RestrictedCallouts::RefCountedHandleCalloutTable * RestrictedCallouts::s_pRefCountedHandleCalloutTable = NULL;
+
+// The head of the chain of eager finalizer callouts.
+RestrictedCallouts::EagerFinalizerRestrictedCallout * RestrictedCallouts::s_pEagerFinalizerRestrictedCallouts = NULL;
+
+// Lock protecting access to s_rgGcRestrictedCallouts, s_pHandleTableRestrictedCallouts and
+// s_pEagerFinalizerRestrictedCallouts during registration and unregistration (not used during actual callbacks since everything is single threaded then).
 CrstStatic RestrictedCallouts::s_sLock;
 
 // One time startup initialization.
@@ -136,6 +142,8 @@ bool RestrictedCallouts::RegisterRefCountedHandleCallback(void * pCalloutMethod,
     pCallout->m_pNext = s_pHandleTableRestrictedCallouts;
     s_pHandleTableRestrictedCallouts = pCallout;
 
+    RebuildRefCountedHandleCalloutTable();
+
     return true;
 }
 
@@ -159,6 +167,143 @@ void RestrictedCallouts::UnregisterRefCountedHandleCallback(void * pCalloutMetho
             else
                 s_pHandleTableRestrictedCallouts = pCurrCallout->m_pNext;
 
+            RebuildRefCountedHandleCalloutTable();
+
+            delete pCurrCallout;
+
+            return;
+        }
+
+        pPrevCallout = pCurrCallout;
+        pCurrCallout = pCurrCallout->m_pNext;
+    }
+
+    // If we get here we didn't find a matching registration, indicating a bug on the part of the caller.
+    ASSERT_UNCONDITIONALLY("Attempted to unregister restricted callout that wasn't registered.");
+    RhFailFast();
+}
+
+// Returns the bucket of the given type, or the empty bucket the type would be added to.
+RestrictedCallouts::RefCountedHandleCalloutBucket * RestrictedCallouts::FindRefCountedHandleCalloutBucket(
+    RefCountedHandleCalloutTable * pTable, EEType * pEEType)
+{
+    UIntNative address = (UIntNative)pEEType;
+    UInt32 mask = pTable->m_cBuckets - 1;
+    UInt32 bucket = (UInt32)((address >> 3) ^ (address >> 12)) & mask;
+
+    // The table is never more than half full, so there always is an empty bucket to stop at.
+    while (true)
+    {
+        RefCountedHandleCalloutBucket * pBucket = &pTable->m_rgBuckets[bucket];
+        if (pBucket->m_pTypeFilter == pEEType || pBucket->m_pTypeFilter == NULL)
+            return pBucket;
+
+        bucket = (bucket + 1) & mask;
+    }
+}
+
+// Replace the hashed HandleTable callouts with ones built from the current chain. Called with s_sLock held.
+void RestrictedCallouts::RebuildRefCountedHandleCalloutTable()
+{
+    RefCountedHandleCalloutTable * pOldTable = s_pRefCountedHandleCalloutTable;
+    s_pRefCountedHandleCalloutTable = NULL;
+    delete[] (UInt8 *)pOldTable;
+
+    UInt32 cCallouts = 0;
+    for (HandleTableRestrictedCallout * pCallout = s_pHandleTableRestrictedCallouts; pCallout; pCallout = pCallout->m_pNext)
+        cCallouts++;
+
+    if (cCallouts == 0)
+        return;
+
+    UInt32 cBuckets = 4;
+    while (cBuckets < cCallouts * 2)
+        cBuckets *= 2;
+
+    // Allocate the table, the buckets and the callouts in one block.
+    size_t cbTable = sizeof(RefCountedHandleCalloutTable) +
+                     cBuckets * sizeof(RefCountedHandleCalloutBucket) +
+                     cCallouts * sizeof(HandleTableRestrictedCallout *);
+    UInt8 * pbTable = new (nothrow) UInt8[cbTable];
+    if (pbTable == NULL)
+        return;
+
+    memset(pbTable, 0, cbTable);
+
+    RefCountedHandleCalloutTable * pTable = (RefCountedHandleCalloutTable *)pbTable;
+    pTable->m_cBuckets = cBuckets;
+    pTable->m_rgBuckets = (RefCountedHandleCalloutBucket *)(pbTable + sizeof(RefCountedHandleCalloutTable));
+    pTable->m_rgCallouts = (HandleTableRestrictedCallout **)(pTable->m_rgBuckets + cBuckets);
+
+    // Count the callouts of each type.
+    for (HandleTableRestrictedCallout * pCallout = s_pHandleTableRestrictedCallouts; pCallout; pCallout = pCallout->m_pNext)
+    {
+        RefCountedHandleCalloutBucket * pBucket = FindRefCountedHandleCalloutBucket(pTable, pCallout->m_pTypeFilter);
+        pBucket->m_pTypeFilter = pCallout->m_pTypeFilter;
+        pBucket->m_cCallouts++;
+    }
+
+    // Give each type its run of m_rgCallouts.
+    UInt32 iNextCallout = 0;
+    for (UInt32 i = 0; i < cBuckets; i++)
+    {
+        RefCountedHandleCalloutBucket * pBucket = &pTable->m_rgBuckets[i];
+        pBucket->m_iFirstCallout = iNextCallout;
+        iNextCallout += pBucket->m_cCallouts;
+        pBucket->m_cCallouts = 0;
+    }
+
+    // Fill the runs in the order of the chain.
+    for (HandleTableRestrictedCallout * pCallout = s_pHandleTableRestrictedCallouts; pCallout; pCallout = pCallout->m_pNext)
+    {
+        RefCountedHandleCalloutBucket * pBucket = FindRefCountedHandleCalloutBucket(pTable, pCallout->m_pTypeFilter);
+        pTable->m_rgCallouts[pBucket->m_iFirstCallout + pBucket->m_cCallouts++] = pCallout;
+    }
+
+    s_pRefCountedHandleCalloutTable = pTable;
+}
+
+// Register an eager finalizer for objects of the given type (the type match must be exact). The most recently
+// registered callbacks are called first. Returns true on success, false if insufficient memory was available
+// for the registration.
+bool RestrictedCallouts::RegisterEagerFinalizer(void * pCalloutMethod, EEType * pTypeFilter)
+{
+    EagerFinalizerRestrictedCallout * pCallout = new (nothrow) EagerFinalizerRestrictedCallout();
+    if (pCallout == NULL)
+        return false;
+
+    pCallout->m_pCalloutMethod = pCalloutMethod;
+    pCallout->m_pTypeFilter = pTypeFilter;
+
+    CrstHolder lh(&s_sLock);
+
+    // Link new callout to head of the chain.
+    pCallout->m_pNext = s_pEagerFinalizerRestrictedCallouts;
+    s_pEagerFinalizerRestrictedCallouts = pCallout;
+
+    return true;
+}
+
+// Unregister a previously registered eager finalizer. Removes the first registration that matches on both
+// callout address and filter type. Causes a fail fast if the registration doesn't exist.
+void RestrictedCallouts::UnregisterEagerFinalizer(void * pCalloutMethod, EEType * pTypeFilter)
+{
+    CrstHolder lh(&s_sLock);
+
+    EagerFinalizerRestrictedCallout * pCurrCallout = s_pEagerFinalizerRestrictedCallouts;
+    EagerFinalizerRestrictedCallout * pPrevCallout = NULL;
+
+    while (pCurrCallout)
+    {
+        if ((pCurrCallout->m_pCalloutMethod == pCalloutMethod) &&
+            (pCurrCallout->m_pTypeFilter == pTypeFilter))
+        {
+            // Found a matching entry, remove it from the chain.
+            if (pPrevCallout)
+                pPrevCallout->m_pNext = pCurrCallout->m_pNext;
+            else
+                s_pEagerFinalizerRestrictedCallouts = pCurrCallout->m_pNext;
+
             delete pCurrCallout;
 
             return;
@@ -204,6 +349,55 @@ void RestrictedCallouts::InvokeGcCallouts(GcRestrictedCalloutKind eKind, UInt32
     pThread->ClearDoNotTriggerGc();
 }
 
+// Returns true if any ref counted handle callouts are registered for objects of the given type.
+bool RestrictedCallouts::HasRefCountedHandleCallouts(EEType * pEEType)
+{
+    RefCountedHandleCalloutTable * pTable = s_pRefCountedHandleCalloutTable;
+    if (pTable != NULL)
+        return FindRefCountedHandleCalloutBucket(pTable, pEEType)->m_pTypeFilter != NULL;
+
+    HandleTableRestrictedCallout * pCurrCallout = s_pHandleTableRestrictedCallouts;
+    while (pCurrCallout && (pCurrCallout->m_pTypeFilter != pEEType))
+        pCurrCallout = pCurrCallout->m_pNext;
+
+    return pCurrCallout != NULL;
+}
+
+// Make the ref counted handle callouts that match the type of the object until one of them returns true. The
+// caller has made sure the callouts can't trigger a GC.
+bool RestrictedCallouts::MakeRefCountedHandleCallouts(Object * pObject)
+{
+    EEType * pEEType = pObject->get_SafeEEType();
+
+    RefCountedHandleCalloutTable * pTable = s_pRefCountedHandleCalloutTable;
+    if (pTable != NULL)
+    {
+        RefCountedHandleCalloutBucket * pBucket = FindRefCountedHandleCalloutBucket(pTable, pEEType);
+        HandleTableRestrictedCallout ** ppCallouts = &pTable->m_rgCallouts[pBucket->m_iFirstCallout];
+        for (UInt32 i = 0; i < pBucket->m_cCallouts; i++)
+        {
+            if (((HandleTableRestrictedCallbackFunction)ppCallouts[i]->m_pCalloutMethod)(pObject))
+                return true;
+        }
+
+        return false;
+    }
+
+    HandleTableRestrictedCallout * pCurrCallout = s_pHandleTableRestrictedCallouts;
+    while (pCurrCallout)
+    {
+        if (pEEType == pCurrCallout->m_pTypeFilter)
+        {
+            if (((HandleTableRestrictedCallbackFunction)pCurrCallout->m_pCalloutMethod)(pObject))
+                return true;
+        }
+
+        pCurrCallout = pCurrCallout->m_pNext;
+    }
+
+    return false;
+}
+
 // Invoke all the registered ref counted handle callouts for the given object extracted from the handle. The
 // result is the union of the results for all the handlers that matched the object type (i.e. if one of them
 // returned true the overall result is true otherwise false is returned (which includes the case where no
@@ -211,6 +405,69 @@ void RestrictedCallouts::InvokeGcCallouts(GcRestrictedCalloutKind eKind, UInt32
 // soon as a handler returns true.
 bool RestrictedCallouts::InvokeRefCountedHandleCallbacks(Object * pObject)
 {
+    return InvokeRefCountedHandleCallbacks(&pObject, 1) != 0;
+}
+
+// Invoke the registered ref counted handle callouts for each of the given objects, as the single object
+// version does. The objects for which the result is true are moved to the start of the array, in their
+// original order, and their number is returned.
+size_t RestrictedCallouts::InvokeRefCountedHandleCallbacks(Object ** rgpObjects, size_t cObjects)
+{
+    size_t cPromoted = 0;
+
+    // The thread state is only changed once a callout has to be made, and then only once for the batch. Most
+    // objects of ref counted handles have no callouts.
+    Thread * pThread = NULL;
+    bool fGcStressWasSuppressed = false;
+
+    for (size_t i = 0; i < cObjects; i++)
+    {
+        Object * pObject = rgpObjects[i];
+        if (!HasRefCountedHandleCallouts(pObject->get_SafeEEType()))
+            continue;
+
+        if (pThread == NULL)
+        {
+            // It is illegal for any of the callouts to trigger a GC.
+            pThread = ThreadStore::GetCurrentThread();
+            pThread->SetDoNotTriggerGc();
+
+            // Due to the above we have better suppress GC stress.
+            fGcStressWasSuppressed = pThread->IsSuppressGcStressSet();
+            if (!fGcStressWasSuppressed)
+                pThread->SetSuppressGcStress();
+        }
+
+        if (MakeRefCountedHandleCallouts(pObject))
+            rgpObjects[cPromoted++] = pObject;
+    }
+
+    if (pThread != NULL)
+    {
+        // Revert GC stress mode if we changed it.
+        if (!fGcStressWasSuppressed)
+            pThread->ClearSuppressGcStress();
+
+        pThread->ClearDoNotTriggerGc();
+    }
+
+    return cPromoted;
+}
+
+// Invoke the registered eager finalizers that match the type of the given unreachable object. Returns true as
+// soon as one of them reports the object as finalized, false otherwise.
+bool RestrictedCallouts::InvokeEagerFinalizers(Object * pObject)
+{
+    // This is called for every unreachable finalizable object, so keep the case where nothing is registered
+    // (or nothing matches) free of any thread state changes.
+    EagerFinalizerRestrictedCallout * pCurrCallout = s_pEagerFinalizerRestrictedCallouts;
+    EEType * pEEType = pObject->get_SafeEEType();
+    while (pCurrCallout && (pCurrCallout->m_pTypeFilter != pEEType))
+        pCurrCallout = pCurrCallout->m_pNext;
+
+    if (pCurrCallout == NULL)
+        return false;
+
     bool fResult = false;
 
     // It is illegal for any of the callouts to trigger a GC.
@@ -222,23 +479,21 @@ bool RestrictedCallouts::InvokeRefCountedHandleCallbacks(Object * pObject)
     if (!fGcStressWasSuppressed)
         pThread->SetSuppressGcStress();
 
-    HandleTableRestrictedCallout * pCurrCallout = s_pHandleTableRestrictedCallouts;
     while (pCurrCallout)
     {
-        if (pObject->get_SafeEEType() == pCurrCallout->m_pTypeFilter)
+        if (pCurrCallout->m_pTypeFilter == pEEType)
         {
             // Make the callout. Return true to our caller as soon as we see a true result here.
-            if (((HandleTableRestrictedCallbackFunction)pCurrCallout->m_pCalloutMethod)(pObject))
+            if (((EagerFinalizerRestrictedCallbackFunction)pCurrCallout->m_pCalloutMethod)(pObject))
             {
                 fResult = true;
-                goto Done;
+                break;
             }
         }
 
         pCurrCallout = pCurrCallout->m_pNext;
     }
 
-  Done:
     // Revert GC stress mode if we changed it.
     if (!fGcStressWasSuppressed)
         pThread->ClearSuppressGcStress();
@@ -17,6 +17,12 @@
 //    example we know about so far is making a p/invoke call.
 //  * For the AfterMarkPhase callout special attention must be paid to avoid any action that reads the EEType*
 //    from an object header (e.g. casting). At this point the GC may have mark bits set in the the pointer.
+//  * Eager finalizers run while the GC scans the finalization queue. The object passed in is unreachable and
+//    so are possibly the objects it references (which won't be kept alive by the callout); they must only be
+//    used to release resources that do not involve other managed objects, such as GC handles.
+//  * The FullGCApproach callout is made outside of GCs as well, on the thread allocating when the GC detects
+//    the full GC, while it holds the allocation lock of its heap. It should only record the notification,
+//    e.g. set a flag that the host polls.
 //
 
 class EEType;
@@ -29,6 +35,9 @@ enum GcRestrictedCalloutKind
     GCRC_EndCollection      = 1,    // Collection has completed
     GCRC_AfterMarkPhase     = 2,    // All live objects are marked (not including ready for finalization
                                     // objects), no handles have been cleared
+    GCRC_FullGCApproach     = 3,    // A full blocking collection is approaching, see
+                                    // RhRegisterForFullGCApproachCallout. The generation passed is 2 for the
+                                    // gen2 budget or 3 for the LOH budget.
     GCRC_Count                      // Maximum number of callout types
 };
 
@@ -56,6 +65,17 @@ public:
     // address and filter type. Causes a fail fast if the registration doesn't exist.
     static void UnregisterRefCountedHandleCallback(void * pCalloutMethod, EEType * pTypeFilter);
 
+    // Register an eager finalizer for objects of the given type (the type match must be exact). Instead of
+    // being queued for the finalizer thread, unreachable finalizable objects of that type are passed to the
+    // callout while the GC scans the finalization queue; if the callout returns true the object is treated as
+    // finalized and is not queued. The most recently registered callbacks are called first. Returns true on
+    // success, false if insufficient memory was available for the registration.
+    static bool RegisterEagerFinalizer(void * pCalloutMethod, EEType * pTypeFilter);
+
+    // Unregister a previously registered eager finalizer. Removes the first registration that matches on both
+    // callout address and filter type. Causes a fail fast if the registration doesn't exist.
+    static void UnregisterEagerFinalizer(void * pCalloutMethod, EEType * pTypeFilter);
+
     // Invoke all the registered GC callouts of the given kind. The condemned generation of the current
     // collection is passed along to the callouts.
     static void InvokeGcCallouts(GcRestrictedCalloutKind eKind, UInt32 uiCondemnedGeneration);
@@ -67,6 +87,16 @@ public:
     // invocations cease as soon as a handler returns true.
     static bool InvokeRefCountedHandleCallbacks(Object * pObject);
 
+    // Invoke the ref counted handle callouts for each of the given objects, as above, setting up the thread for
+    // the callouts once for the batch. The objects for which the result is true are moved to the start of the
+    // array, in their original order, and their number is returned.
+    static size_t InvokeRefCountedHandleCallbacks(Object ** rgpObjects, size_t cObjects);
+
+    // Invoke the registered eager finalizers that match the type of the given unreachable object. Returns true
+    // as soon as one of them reports the object as finalized, false otherwise (including the case where no
+    // eager finalizer matched, which is the common case and doesn't leave the fast path).
+    static bool InvokeEagerFinalizers(Object * pObject);
+
 private:
     // Context struct used to record which GC callbacks are registered to be made (we allow multiple
     // registrations).
@@ -92,12 +122,45 @@ private:
     // The head of the chain of HandleTable callouts.
     static HandleTableRestrictedCallout * s_pHandleTableRestrictedCallouts;
 
-    // Lock protecting access to s_rgGcRestrictedCallouts and s_pHandleTableRestrictedCallouts during
-    // registration and unregistration (not used during actual callbacks since everything is single threaded
-    // then).
+    // InvokeRefCountedHandleCallbacks runs for every ref counted handle at every GC, so the callouts are also
+    // hashed by their type filter. The table is open addressed and rebuilt from the chain whenever a callout is
+    // registered or unregistered. A bucket refers to the run of m_rgCallouts holding the callouts of its type,
+    // in the order of the chain. Registrations happen in cooperative mode and so never overlap with a GC
+    // reading the table. If the table can't be allocated it is left NULL and the chain is walked instead.
+    struct RefCountedHandleCalloutBucket
+    {
+        EEType *                        m_pTypeFilter;      // NULL for an empty bucket
+        UInt32                          m_iFirstCallout;    // Index of the first callout in m_rgCallouts
+        UInt32                          m_cCallouts;
+    };
+
+    struct RefCountedHandleCalloutTable
+    {
+        UInt32                          m_cBuckets;         // Power of 2
+        RefCountedHandleCalloutBucket * m_rgBuckets;
+        HandleTableRestrictedCallout ** m_rgCallouts;
+    };
+
+    static RefCountedHandleCalloutTable * s_pRefCountedHandleCalloutTable;
+
+    static void RebuildRefCountedHandleCalloutTable();
+    static RefCountedHandleCalloutBucket * FindRefCountedHandleCalloutBucket(RefCountedHandleCalloutTable * pTable, EEType * pEEType);
+    static bool HasRefCountedHandleCallouts(EEType * pEEType);
+    static bool MakeRefCountedHandleCallouts(Object * pObject);
+
+    // Eager finalizers use the same type filtered registration as the HandleTable callouts.
+    typedef HandleTableRestrictedCallout EagerFinalizerRestrictedCallout;
+
+    // The head of the chain of eager finalizer callouts.
+    static EagerFinalizerRestrictedCallout * s_pEagerFinalizerRestrictedCallouts;
+
+    // Lock protecting access to s_rgGcRestrictedCallouts, s_pHandleTableRestrictedCallouts and
+    // s_pEagerFinalizerRestrictedCallouts during registration and unregistration (not used during actual
+    // callbacks since everything is single threaded then).
     static CrstStatic s_sLock;
 
     // Prototypes for the callouts.
     typedef void (__fastcall * GcRestrictedCallbackFunction)(UInt32 uiCondemnedGeneration);
     typedef Boolean (__fastcall * HandleTableRestrictedCallbackFunction)(Object * pObject);
+    typedef Boolean (__fastcall * EagerFinalizerRestrictedCallbackFunction)(Object * pObject);
 };
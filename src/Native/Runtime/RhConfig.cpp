@@ -26,305 +26,290 @@
 
 #include <string.h>
 
-UInt32 RhConfig::ReadConfigValue(_In_z_ const TCHAR *wszName, UInt32 uiDefaultValue)
+// Names of all the config values, indexed by RhConfigValue
+static const TCHAR * const s_rgConfigNames[] =
 {
-    TCHAR wszBuffer[CONFIG_VAL_MAXLEN + 1]; // 8 hex digits plus a nul terminator.
-    const UInt32 cchBuffer = sizeof(wszBuffer) / sizeof(wszBuffer[0]);
+#define DEBUG_CONFIG_VALUE(_name) _T("RH_") _T(#_name),
+#define RETAIL_CONFIG_VALUE(_name) _T("RH_") _T(#_name),
+#define DEBUG_CONFIG_VALUE_WITH_DEFAULT(_name, defaultVal) _T("RH_") _T(#_name),
+#define RETAIL_CONFIG_VALUE_WITH_DEFAULT(_name, defaultVal) _T("RH_") _T(#_name),
+#include "RhConfigValues.h"
+#undef DEBUG_CONFIG_VALUE
+#undef RETAIL_CONFIG_VALUE
+#undef DEBUG_CONFIG_VALUE_WITH_DEFAULT
+#undef RETAIL_CONFIG_VALUE_WITH_DEFAULT
+};
 
-    UInt32 cchResult = 0;
+void RhConfig::LoadConfigValues()
+{
+    C_ASSERT(sizeof(s_rgConfigNames) / sizeof(s_rgConfigNames[0]) == RCV_Count);
+    C_ASSERT(RCV_Count * 2 <= CONFIG_NAME_TABLE_SIZE);
+    C_ASSERT((CONFIG_NAME_TABLE_SIZE & (CONFIG_NAME_TABLE_SIZE - 1)) == 0);
 
-#ifdef FEATURE_ENVIRONMENT_VARIABLE_CONFIG
-    cchResult = PalGetEnvironmentVariable(wszName, wszBuffer, cchBuffer);
-#endif // FEATURE_ENVIRONMENT_VARIABLE_CONFIG
+    ConfigValues values;
+    memset(&values, 0, sizeof(values));
 
-    //if the config key wasn't found in the environment 
-    if ((cchResult == 0) || (cchResult >= cchBuffer))
-        cchResult = GetIniVariable(wszName, wszBuffer, cchBuffer);
+    //the table is at most half full, so the linear probe sequences stay short
+    for (UInt32 iName = 0; iName < RCV_Count; iName++)
+    {
+        UInt32 iSlot = HashConfigName(s_rgConfigNames[iName]) & (CONFIG_NAME_TABLE_SIZE - 1);
+        while (values.NameTable[iSlot] != 0)
+            iSlot = (iSlot + 1) & (CONFIG_NAME_TABLE_SIZE - 1);
+        values.NameTable[iSlot] = (UInt8)(iName + 1);
+    }
 
+    //read the sources from the lowest to the highest precedence, later ones overwrite the values
 #ifdef FEATURE_EMBEDDED_CONFIG
-    // if the config key wasn't found in the ini file
-    if ((cchResult == 0) || (cchResult >= cchBuffer))
-        cchResult = GetEmbeddedVariable(wszName, wszBuffer, cchBuffer);
+    ReadEmbeddedSettings(&values);
 #endif // FEATURE_EMBEDDED_CONFIG
 
-    if ((cchResult == 0) || (cchResult >= cchBuffer))
-        return uiDefaultValue; // not found, return default
+    ReadConfigIni(&values);
 
-    UInt32 uiResult = 0;
-
-    for (UInt32 i = 0; i < cchResult; i++)
+#ifdef FEATURE_ENVIRONMENT_VARIABLE_CONFIG
+    for (UInt32 iName = 0; iName < RCV_Count; iName++)
     {
-        uiResult <<= 4;
+        TCHAR wszBuffer[CONFIG_VAL_MAXLEN + 1]; // 8 hex digits plus a nul terminator.
+        const UInt32 cchBuffer = sizeof(wszBuffer) / sizeof(wszBuffer[0]);
 
-        TCHAR ch = wszBuffer[i];
-        if ((ch >= _T('0')) && (ch <= _T('9')))
-            uiResult += ch - _T('0');
-        else if ((ch >= _T('a')) && (ch <= _T('f')))
-            uiResult += (ch - _T('a')) + 10;
-        else if ((ch >= _T('A')) && (ch <= _T('F')))
-            uiResult += (ch - _T('A')) + 10;
-        else
-            return uiDefaultValue; // parse error, return default
+        UInt32 cchResult = PalGetEnvironmentVariable(s_rgConfigNames[iName], wszBuffer, cchBuffer);
+        if ((cchResult == 0) || (cchResult >= cchBuffer))
+            continue;
+
+        UInt32 uiValue;
+        if (ParseConfigValue(wszBuffer, cchResult, &uiValue))
+        {
+            values.Values[iName] = uiValue;
+            values.IsSet[iName] = true;
+        }
     }
+#endif // FEATURE_ENVIRONMENT_VARIABLE_CONFIG
+
+    memcpy(m_uiConfigValues, values.Values, sizeof(m_uiConfigValues));
+    memcpy(m_rgfConfigValueSet, values.IsSet, sizeof(m_rgfConfigValueSet));
 
-    return uiResult;
+    //publish the values only once they are written
+    PalMemoryBarrier();
+    m_fConfigValuesLoaded = true;
 }
 
-//reads a config value from rhconfig.ini into outputBuffer buffer returning the length of the value.
-//lazily reads the file so if the file is not yet read, it will read it on first called
-//if the file is not avaliable, or unreadable zero will always be returned
-//cchOutputBuffer is the maximum number of characters to write to outputBuffer
-//cchOutputBuffer must be a size >= CONFIG_VAL_MAXLEN + 1
-UInt32 RhConfig::GetIniVariable(_In_z_ const TCHAR* configName, _Out_writes_all_(cchOutputBuffer) TCHAR* outputBuffer, _In_ UInt32 cchOutputBuffer)
+//case insensitive to be compat with environment variable counterpart
+UInt32 RhConfig::HashConfigName(_In_z_ const TCHAR* configName)
 {
-    //the buffer needs to be big enough to read the value buffer + null terminator
-    if (cchOutputBuffer < CONFIG_VAL_MAXLEN + 1)
+    UInt32 hash = 2166136261;   // FNV-1a
+    for (const TCHAR* pch = configName; *pch != 0; pch++)
     {
-        return 0;
+        TCHAR ch = *pch;
+        if ((ch >= _T('a')) && (ch <= _T('z')))
+            ch = ch - _T('a') + _T('A');
+        hash = (hash ^ (UInt32)ch) * 16777619;
     }
+    return hash;
+}
 
-    //if we haven't read the config yet try to read
-    if (g_iniSettings == NULL)
+UInt32 RhConfig::LookupConfigName(_In_ const ConfigValues* pValues, _In_z_ const TCHAR* configName)
+{
+    UInt32 iSlot = HashConfigName(configName) & (CONFIG_NAME_TABLE_SIZE - 1);
+    while (pValues->NameTable[iSlot] != 0)
     {
-        ReadConfigIni();
+        UInt32 iName = pValues->NameTable[iSlot] - 1;
+        if (_tcsicmp(configName, s_rgConfigNames[iName]) == 0)
+            return iName;
+        iSlot = (iSlot + 1) & (CONFIG_NAME_TABLE_SIZE - 1);
     }
 
-    //if the config wasn't read or reading failed return 0 immediately
-    if (g_iniSettings == CONFIG_INI_NOT_AVAIL)
+    return RCV_Count;
+}
+
+UInt32 RhConfig::LookupConfigNameHash(_In_ const ConfigValues* pValues, UInt32 hash)
+{
+    UInt32 iSlot = hash & (CONFIG_NAME_TABLE_SIZE - 1);
+    while (pValues->NameTable[iSlot] != 0)
     {
-        return 0;
+        UInt32 iName = pValues->NameTable[iSlot] - 1;
+        if (HashConfigName(s_rgConfigNames[iName]) == hash)
+            return iName;
+        iSlot = (iSlot + 1) & (CONFIG_NAME_TABLE_SIZE - 1);
     }
 
-    return GetConfigVariable(configName, (ConfigPair*)g_iniSettings, outputBuffer, cchOutputBuffer);
+    return RCV_Count;
 }
 
-#ifdef FEATURE_EMBEDDED_CONFIG
-UInt32 RhConfig::GetEmbeddedVariable(_In_z_ const TCHAR* configName, _Out_writes_all_(cchOutputBuffer) TCHAR* outputBuffer, _In_ UInt32 cchOutputBuffer)
+bool RhConfig::ParseConfigValue(_In_reads_(cchValue) const TCHAR* value, UInt32 cchValue, _Out_ UInt32* puiValue)
 {
-    //the buffer needs to be big enough to read the value buffer + null terminator
-    if (cchOutputBuffer < CONFIG_VAL_MAXLEN + 1)
-    {
-        return 0;
-    }
+    UInt32 uiResult = 0;
 
-    //if we haven't read the config yet try to read
-    if (g_embeddedSettings == NULL)
+    for (UInt32 i = 0; i < cchValue; i++)
     {
-        ReadEmbeddedSettings();
-    }
+        uiResult <<= 4;
 
-    //if the config wasn't read or reading failed return 0 immediately
-    if (g_embeddedSettings == CONFIG_INI_NOT_AVAIL)
-    {
-        return 0;
+        TCHAR ch = value[i];
+        if ((ch >= _T('0')) && (ch <= _T('9')))
+            uiResult += ch - _T('0');
+        else if ((ch >= _T('a')) && (ch <= _T('f')))
+            uiResult += (ch - _T('a')) + 10;
+        else if ((ch >= _T('A')) && (ch <= _T('F')))
+            uiResult += (ch - _T('A')) + 10;
+        else
+            return false; // parse error
     }
 
-    return GetConfigVariable(configName, (ConfigPair*)g_embeddedSettings, outputBuffer, cchOutputBuffer);
+    *puiValue = uiResult;
+    return true;
 }
-#endif // FEATURE_EMBEDDED_CONFIG
 
-UInt32 RhConfig::GetConfigVariable(_In_z_ const TCHAR* configName, const ConfigPair* configPairs, _Out_writes_all_(cchOutputBuffer) TCHAR* outputBuffer, _In_ UInt32 cchOutputBuffer)
+void RhConfig::ApplyConfigLine(_Inout_ ConfigValues* pValues, _In_z_ const char * line)
 {
-    //find the first name which matches (case insensitive to be compat with environment variable counterpart)
-    for (int iSettings = 0; iSettings < RCV_Count; iSettings++)
-    {
-        if (_tcsicmp(configName, configPairs[iSettings].Key) == 0)
-        {
-            bool nullTerm = FALSE;
-
-            UInt32 iValue;
+    ConfigPair configPair;
+    if (!ParseConfigLine(&configPair, line))
+        return;
 
-            for (iValue = 0; (iValue < CONFIG_VAL_MAXLEN + 1) && (iValue < (Int32)cchOutputBuffer); iValue++)
-            {
-                outputBuffer[iValue] = configPairs[iSettings].Value[iValue];
+    UInt32 iName = LookupConfigName(pValues, configPair.Key);
+    if (iName == RCV_Count)
+        return;
 
-                if (outputBuffer[iValue] == '\0')
-                {
-                    nullTerm = true;
-                    break;
-                }
-            }
+    //an empty value is the same as the key not being present
+    UInt32 cchValue = 0;
+    while (configPair.Value[cchValue] != '\0')
+        cchValue++;
 
-            //return the length of the config value if null terminated else return zero
-            return nullTerm ? iValue : 0;
-        }
+    UInt32 uiValue;
+    if ((cchValue != 0) && ParseConfigValue(configPair.Value, cchValue, &uiValue))
+    {
+        pValues->Values[iName] = uiValue;
+        pValues->IsSet[iName] = true;
     }
-
-    //if the config key was not found return 0
-    return 0;
 }
 
-//reads the configuration values from rhconfig.ini and updates g_iniSettings
-//if the file is read succesfully and g_iniSettings will be set to a valid ConfigPair[] of length RCV_Count.
-//if the file does not exist or reading the file fails,  g_iniSettings is set to CONFIG_INI_NOT_AVAIL
-//NOTE: all return paths must set g_iniSettings 
-void RhConfig::ReadConfigIni()
+//reads the configuration values from rhconfig.ini into pValues
+//if the file does not exist or reading the file fails nothing is recorded
+void RhConfig::ReadConfigIni(_Inout_ ConfigValues* pValues)
 {
-    if (g_iniSettings == NULL)
-    {
-        TCHAR* configPath = GetConfigPath();
+    TCHAR* configPath = GetConfigPath();
 
-        //if we couldn't determine the path to the config set g_iniSettings to CONGIF_NOT_AVAIL
-        if (configPath == NULL)
-        {
-            //only set if another thread hasn't initialized the buffer yet, otherwise ignore and let the first setter win
-            PalInterlockedCompareExchangePointer(&g_iniSettings, CONFIG_INI_NOT_AVAIL, NULL);
+    //if we couldn't determine the path to the config there is nothing to read
+    if (configPath == NULL)
+        return;
 
-            return;
-        }
+    //buffer is max file size + 1 for null terminator if needed
+    char buff[CONFIG_FILE_MAXLEN + 1];
 
-        //buffer is max file size + 1 for null terminator if needed
-        char buff[CONFIG_FILE_MAXLEN + 1];
+    //if the file read failed or the file is bigger than the specified buffer this will return zero
+    UInt32 fSize = PalReadFileContents(configPath, buff, CONFIG_FILE_MAXLEN);
 
-        //if the file read failed or the file is bigger than the specified buffer this will return zero
-        UInt32 fSize = PalReadFileContents(configPath, buff, CONFIG_FILE_MAXLEN);
+    //ensure the buffer is null terminated
+    buff[fSize] = '\0';
 
-        //ensure the buffer is null terminated
-        buff[fSize] = '\0';
+    //delete the configPath
+    delete[] configPath;
 
-        //delete the configPath
-        delete[] configPath;
+    UInt32 iBuff = 0;
+    char* currLine;
 
-        //if reading the file contents failed set g_iniSettings to CONFIG_INI_NOT_AVAIL
-        if (fSize == 0)
-        {
-            //only set if another thread hasn't initialized the buffer yet, otherwise ignore and let the first setter win
-            PalInterlockedCompareExchangePointer(&g_iniSettings, CONFIG_INI_NOT_AVAIL, NULL);
-
-            return;
-        }
-
-        ConfigPair* iniBuff = new (nothrow) ConfigPair[RCV_Count];
-        if (iniBuff == NULL)
-        {
-            //only set if another thread hasn't initialized the buffer yet, otherwise ignore and let the first setter win
-            PalInterlockedCompareExchangePointer(&g_iniSettings, CONFIG_INI_NOT_AVAIL, NULL);
-
-            return;
-        }
-
-        UInt32 iBuff = 0;
-        UInt32 iIniBuff = 0;
-        char* currLine;
-
-        //while we haven't reached the max number of config pairs, or the end of the file, read the next line
-        while (iIniBuff < RCV_Count && iBuff < fSize)
-        {
-            //'trim' the leading whitespace
-            while (priv_isspace(buff[iBuff]) && (iBuff < fSize))
-                iBuff++;
-
-            currLine = &buff[iBuff];
-
-            //find the end of the line
-            while ((buff[iBuff] != '\n') && (buff[iBuff] != '\r') && (iBuff < fSize))
-                iBuff++;
-
-            //null terminate the line
-            buff[iBuff] = '\0';
+    //while we haven't reached the end of the file, read the next line
+    while (iBuff < fSize)
+    {
+        //'trim' the leading whitespace
+        while (priv_isspace(buff[iBuff]) && (iBuff < fSize))
+            iBuff++;
 
-            //parse the line
-            //only increment iIniBuff if the parsing succeeded otherwise reuse the config struct
-            if (ParseConfigLine(&iniBuff[iIniBuff], currLine))
-            {
-                iIniBuff++;
-            }
+        currLine = &buff[iBuff];
 
-            //advance to the next line;
+        //find the end of the line
+        while ((buff[iBuff] != '\n') && (buff[iBuff] != '\r') && (iBuff < fSize))
             iBuff++;
-        }
 
-        //initialize the remaining config pairs to "\0"
-        while (iIniBuff < RCV_Count)
-        {
-            iniBuff[iIniBuff].Key[0] = '\0';
-            iniBuff[iIniBuff].Value[0] = '\0';
-            iIniBuff++;
-        }
+        //null terminate the line
+        buff[iBuff] = '\0';
 
-        //if another thread initialized first let the first setter win
-        //delete the iniBuff to avoid leaking memory
-        if (PalInterlockedCompareExchangePointer(&g_iniSettings, iniBuff, NULL) != NULL)
-        {
-            delete[] iniBuff;
-        }
-    }
+        ApplyConfigLine(pValues, currLine);
 
-    return;
+        //advance to the next line;
+        iBuff++;
+    }
 }
 
 #ifdef FEATURE_EMBEDDED_CONFIG
+//the layout needs to be kept in sync with RuntimeConfigurationRootProvider in the compiler
+enum EmbeddedSettingType
+{
+    EST_Integer = 0,
+    EST_Boolean = 1,
+};
+
+struct CompilerEmbeddedSetting
+{
+    UInt32 KeyHash;     //HashConfigName of the setting name
+    UInt32 Type;        //EmbeddedSettingType
+    UInt64 Value;
+};
+
 struct CompilerEmbeddedSettingsBlob
 {
-    UInt32 Size;
-    char Data[1];
+    UInt32 Count;
+    UInt32 Reserved;
+    CompilerEmbeddedSetting Settings[1];    //sorted by KeyHash
 };
 
 extern "C" CompilerEmbeddedSettingsBlob g_compilerEmbeddedSettingsBlob;
 
-void RhConfig::ReadEmbeddedSettings()
+void RhConfig::ReadEmbeddedSettings(_Inout_ ConfigValues* pValues)
 {
-    if (g_embeddedSettings == NULL)
+    for (UInt32 i = 0; i < g_compilerEmbeddedSettingsBlob.Count; i++)
     {
-        //if reading the file contents failed set g_embeddedSettings to CONFIG_INI_NOT_AVAIL
-        if (g_compilerEmbeddedSettingsBlob.Size == 0)
-        {
-            //only set if another thread hasn't initialized the buffer yet, otherwise ignore and let the first setter win
-            PalInterlockedCompareExchangePointer(&g_embeddedSettings, CONFIG_INI_NOT_AVAIL, NULL);
+        const CompilerEmbeddedSetting * pSetting = &g_compilerEmbeddedSettingsBlob.Settings[i];
 
-            return;
-        }
-
-        ConfigPair* iniBuff = new (nothrow) ConfigPair[RCV_Count];
-        if (iniBuff == NULL)
-        {
-            //only set if another thread hasn't initialized the buffer yet, otherwise ignore and let the first setter win
-            PalInterlockedCompareExchangePointer(&g_embeddedSettings, CONFIG_INI_NOT_AVAIL, NULL);
+        //the settings that are not RH_ values are for the GC, see GetEmbeddedGCConfigValue
+        UInt32 iName = LookupConfigNameHash(pValues, pSetting->KeyHash);
+        if (iName == RCV_Count)
+            continue;
 
-            return;
-        }
-
-        UInt32 iBuff = 0;
-        UInt32 iIniBuff = 0;
-        char* currLine;
-
-        //while we haven't reached the max number of config pairs, or the end of the file, read the next line
-        while (iIniBuff < RCV_Count && iBuff < g_compilerEmbeddedSettingsBlob.Size)
-        {
-            currLine = &g_compilerEmbeddedSettingsBlob.Data[iBuff];
-
-            //find the end of the line
-            while ((g_compilerEmbeddedSettingsBlob.Data[iBuff] != '\0') && (iBuff < g_compilerEmbeddedSettingsBlob.Size))
-                iBuff++;
+        //the compiler validated that the value fits
+        pValues->Values[iName] = (UInt32)pSetting->Value;
+        pValues->IsSet[iName] = true;
+    }
+}
 
-            //parse the line
-            //only increment iIniBuff if the parsing succeeded otherwise reuse the config struct
-            if (ParseConfigLine(&iniBuff[iIniBuff], currLine))
-            {
-                iIniBuff++;
-            }
+bool RhConfig::GetEmbeddedGCConfigValue(_In_z_ const char* privateKey, _Out_ UInt64* puiValue, _Out_ bool* pfIsBoolean)
+{
+    UInt32 hash = 2166136261;   // FNV-1a, same as HashConfigName
+    for (const char* pch = privateKey; *pch != 0; pch++)
+    {
+        char ch = *pch;
+        if ((ch >= 'a') && (ch <= 'z'))
+            ch = ch - 'a' + 'A';
+        hash = (hash ^ (UInt32)ch) * 16777619;
+    }
 
-            //advance to the next line;
-            iBuff++;
-        }
+    //binary search, the compiler sorted the settings by the hash
+    UInt32 iLow = 0;
+    UInt32 iHigh = g_compilerEmbeddedSettingsBlob.Count;
+    while (iLow < iHigh)
+    {
+        UInt32 iMid = iLow + (iHigh - iLow) / 2;
+        const CompilerEmbeddedSetting * pSetting = &g_compilerEmbeddedSettingsBlob.Settings[iMid];
 
-        //initialize the remaining config pairs to "\0"
-        while (iIniBuff < RCV_Count)
+        if (pSetting->KeyHash == hash)
         {
-            iniBuff[iIniBuff].Key[0] = '\0';
-            iniBuff[iIniBuff].Value[0] = '\0';
-            iIniBuff++;
+            *puiValue = pSetting->Value;
+            *pfIsBoolean = pSetting->Type == EST_Boolean;
+            return true;
         }
 
-        //if another thread initialized first let the first setter win
-        //delete the iniBuff to avoid leaking memory
-        if (PalInterlockedCompareExchangePointer(&g_embeddedSettings, iniBuff, NULL) != NULL)
-        {
-            delete[] iniBuff;
-        }
+        if (pSetting->KeyHash < hash)
+            iLow = iMid + 1;
+        else
+            iHigh = iMid;
     }
 
-    return;
+    return false;
+}
+#else // FEATURE_EMBEDDED_CONFIG
+bool RhConfig::GetEmbeddedGCConfigValue(_In_z_ const char* privateKey, _Out_ UInt64* puiValue, _Out_ bool* pfIsBoolean)
+{
+    UNREFERENCED_PARAMETER(privateKey);
+    UNREFERENCED_PARAMETER(puiValue);
+    UNREFERENCED_PARAMETER(pfIsBoolean);
+    return false;
 }
 #endif // FEATURE_EMBEDDED_CONFIG
 
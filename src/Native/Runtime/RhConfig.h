@@ -3,11 +3,10 @@
 // See the LICENSE file in the project root for more information.
 
 //
-// Provides simple configuration support through environment variables. Each variable is lazily inspected on
-// first query and the resulting value cached for future use. To keep things simple we support reading only
-// 32-bit hex quantities and a zero value is considered equivalent to the environment variable not being
-// defined. We can get more sophisticated if needs be, but the hope is that very few configuration values are
-// exposed in this manner.
+// Provides simple configuration support through environment variables. The first query parses all the
+// configuration sources once and caches every known value, later queries are a plain array read. To keep
+// things simple we support reading only 32-bit hex quantities. We can get more sophisticated if needs be, but
+// the hope is that very few configuration values are exposed in this manner.
 //
 // Values can also be configured through an rhconfig.ini file.  The file must be and ASCII text file, must be
 // placed next to the executing assembly, and be named rhconfig.ini.  The file consists of one config entry per line
@@ -16,6 +15,11 @@
 // RH_HeapVerify=1
 // RH_BreakOnAssert=1
 //
+// Environment variables take precedence over rhconfig.ini, which takes precedence over the settings embedded
+// into the executable by the compiler. The compiler embeds the settings already parsed, as records keyed by the
+// hash of the setting name. Settings that are not RH_ values are GC configuration values that are looked up by
+// the GC configuration name with GetEmbeddedGCConfigValue.
+//
 
 
 #ifndef DACCESS_COMPILE
@@ -28,7 +32,6 @@ class RhConfig
 {
 
 #define CONFIG_INI_FILENAME L"rhconfig.ini"
-#define CONFIG_INI_NOT_AVAIL (void*)0x1  //signal for ini file failed to load
 #define CONFIG_KEY_MAXLEN 50             //arbitrary max length of config keys increase if needed
 #define CONFIG_VAL_MAXLEN 8              //32 bit uint in hex
 
@@ -40,40 +43,21 @@ private:
         TCHAR Value[CONFIG_VAL_MAXLEN + 1]; //maxlen + null terminator
     };
 
-    //g_iniSettings is a buffer of ConfigPair structs which when initialized is of length RCV_Count
-    //the first N settings which are set in rhconfig.ini will be initialized and the remainder with have 
-    //empty string "\0" as a Key and Value
-    //
-    //if the buffer has not been initialized (ie the ini file has not been read) the value will be NULL
-    //if we already attempted to initialize the file and could not find or read the contents the 
-    //value will be CONFIG_INI_NOT_AVAIL to distinguish from the unitialized buffer.
-    //
-    //NOTE: g_iniSettings is only set in ReadConfigIni and must be set atomically only once
-    //      using PalInterlockedCompareExchangePointer to avoid races when initializing
-private:
-    void* volatile g_iniSettings = NULL;
-
-#ifdef FEATURE_EMBEDDED_CONFIG
-    // g_embeddedSettings works similarly to g_iniSettings, except the source of the data
-    // is a data blob generated by the compiler and embedded into the executable.
-    void* volatile g_embeddedSettings = NULL;
-#endif // FEATURE_EMBEDDED_CONFIG
-
 public:
 
 #define DEFINE_VALUE_ACCESSOR(_name, defaultVal)        \
     UInt32 Get##_name()                                 \
     {                                                   \
-        if (m_uiConfigValuesRead & (1 << RCV_##_name))  \
-            return m_uiConfigValues[RCV_##_name];       \
-        UInt32 uiValue = ReadConfigValue(_T("RH_") _T(#_name), defaultVal); \
-        m_uiConfigValues[RCV_##_name] = uiValue;        \
-        m_uiConfigValuesRead |= 1 << RCV_##_name;       \
-        return uiValue;                                 \
+        if (!m_fConfigValuesLoaded)                     \
+            LoadConfigValues();                         \
+        if (!m_rgfConfigValueSet[RCV_##_name])          \
+            return defaultVal;                          \
+        return m_uiConfigValues[RCV_##_name];           \
     }
 
 
-#ifdef _DEBUG
+// GC stress builds read the debug values in release builds too, the GC stress settings are among them
+#if defined(_DEBUG) || defined(FEATURE_GC_STRESS)
 #define DEBUG_CONFIG_VALUE(_name) DEFINE_VALUE_ACCESSOR(_name, 0)
 #define DEBUG_CONFIG_VALUE_WITH_DEFAULT(_name, defaultVal) DEFINE_VALUE_ACCESSOR(_name, defaultVal)
 #else
@@ -88,9 +72,11 @@ public:
 #undef DEBUG_CONFIG_VALUE_WITH_DEFAULT
 #undef RETAIL_CONFIG_VALUE_WITH_DEFAULT
 
-private:
+    //returns the value of the GC configuration privateKey embedded in the executable by the compiler
+    //and whether the value was set as a boolean (true/false) rather than as a number
+    bool GetEmbeddedGCConfigValue(_In_z_ const char* privateKey, _Out_ UInt64* puiValue, _Out_ bool* pfIsBoolean);
 
-    UInt32 ReadConfigValue(_In_z_ const TCHAR *wszName, UInt32 uiDefault);
+private:
 
     enum RhConfigValue
     {
@@ -109,33 +95,51 @@ private:
 //accomidate for the maximum number of config values plus sizable buffer for whitespace 2K
 #define CONFIG_FILE_MAXLEN RCV_Count * sizeof(ConfigPair) + 2000  
 
+//size of the open addressed table that maps config names to RhConfigValue, must be a power of 2
+#define CONFIG_NAME_TABLE_SIZE 128
+
+    //the values of all the configuration sources, built once by LoadConfigValues
+    struct ConfigValues
+    {
+        UInt32  Values[RCV_Count];
+        bool    IsSet[RCV_Count];
+        UInt8   NameTable[CONFIG_NAME_TABLE_SIZE]; //RhConfigValue + 1 of the name hashing to the slot, 0 if empty
+    };
+
 private:
     _Ret_maybenull_z_ TCHAR* GetConfigPath();
 
+    //reads all the configuration sources and caches the value of every known config key
+    //this happens on the first query of any value. Racing threads compute the same values.
+    void LoadConfigValues();
+
     //Parses one line of rhconfig.ini and populates values in the passed in configPair
     //returns: true if the parsing was successful, false if the parsing failed. 
     //NOTE: if the method fails configPair is left in an unitialized state
     bool ParseConfigLine(_Out_ ConfigPair* configPair, _In_z_ const char * line);
 
-    //reads the configuration values from rhconfig.ini and updates g_iniSettings
-    //if the file is read succesfully and g_iniSettings will be set to a valid ConfigPair[] of length RCV_Count.
-    //if the file does not exist or reading the file fails,  g_iniSettings is set to CONFIG_INI_NOT_AVAIL
-    //NOTE: all return paths must set g_iniSettings 
-    void ReadConfigIni();
+    //records the value of a <Key>=<Value> line if the key is known and the value is valid
+    void ApplyConfigLine(_Inout_ ConfigValues* pValues, _In_z_ const char * line);
 
-    //reads a config value from rhconfig.ini into outputBuffer buffer returning the length of the value.
-    //lazily reads the file so if the file is not yet read, it will read it on first called
-    //if the file is not avaliable, or unreadable zero will always be returned
-    //cchOutputBuffer is the maximum number of characters to write to outputBuffer
-    UInt32 GetIniVariable(_In_z_ const TCHAR* configName, _Out_writes_all_(cchOutputBuffer) TCHAR* outputBuffer, _In_ UInt32 cchOutputBuffer);
+    //reads the configuration values from rhconfig.ini into pValues
+    //if the file does not exist or reading the file fails nothing is recorded
+    void ReadConfigIni(_Inout_ ConfigValues* pValues);
 
 #ifdef FEATURE_EMBEDDED_CONFIG
-    void ReadEmbeddedSettings();
-
-    UInt32 GetEmbeddedVariable(_In_z_ const TCHAR* configName, _Out_writes_all_(cchOutputBuffer) TCHAR* outputBuffer, _In_ UInt32 cchOutputBuffer);
+    //reads the configuration values embedded in the executable by the compiler into pValues
+    void ReadEmbeddedSettings(_Inout_ ConfigValues* pValues);
 #endif // FEATURE_EMBEDDED_CONFIG
 
-    UInt32 GetConfigVariable(_In_z_ const TCHAR* configName, const ConfigPair* configPairs, _Out_writes_all_(cchOutputBuffer) TCHAR* outputBuffer, _In_ UInt32 cchOutputBuffer);
+    static UInt32 HashConfigName(_In_z_ const TCHAR* configName);
+
+    //returns the RhConfigValue whose name hashes to hash or RCV_Count if there is none
+    static UInt32 LookupConfigNameHash(_In_ const ConfigValues* pValues, UInt32 hash);
+
+    //returns the RhConfigValue of configName or RCV_Count if it is not a known config key
+    static UInt32 LookupConfigName(_In_ const ConfigValues* pValues, _In_z_ const TCHAR* configName);
+
+    //parses cchValue hex digits, returns false on a parse error
+    static bool ParseConfigValue(_In_reads_(cchValue) const TCHAR* value, UInt32 cchValue, _Out_ UInt32* puiValue);
 
     static bool priv_isspace(char c)
     {
@@ -143,8 +147,9 @@ private:
     }
 
 
-    UInt32  m_uiConfigValuesRead;
-    UInt32  m_uiConfigValues[RCV_Count];
+    bool volatile   m_fConfigValuesLoaded;
+    bool            m_rgfConfigValueSet[RCV_Count];
+    UInt32          m_uiConfigValues[RCV_Count];
 };
 
 extern RhConfig * g_pRhConfig;
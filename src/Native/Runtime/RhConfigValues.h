@@ -17,11 +17,36 @@ DEBUG_CONFIG_VALUE_WITH_DEFAULT(BreakOnAssert, 1)
 RETAIL_CONFIG_VALUE(HeapVerify)
 RETAIL_CONFIG_VALUE(StressLogLevel)
 RETAIL_CONFIG_VALUE(TotalStressLogSize)
+RETAIL_CONFIG_VALUE(StressLogStream)         // Write the stress log messages that roll out of the in-memory log to stresslog_<pid>.bin
 RETAIL_CONFIG_VALUE(DisableBGC)
 RETAIL_CONFIG_VALUE(UseServerGC)
+RETAIL_CONFIG_VALUE(GcParallelStackScan)     // Server GC threads claim thread stacks to scan dynamically instead of by heap affinity
+RETAIL_CONFIG_VALUE(InterfaceDispatchStats)  // Collect cached interface dispatch counters (see RhGetInterfaceDispatchStats)
+RETAIL_CONFIG_VALUE_WITH_DEFAULT(InterfaceDispatchCacheTrimming, 1) // Reset grown interface dispatch caches at GCs so they relearn their working set
+RETAIL_CONFIG_VALUE(GcReleaseFreeSpace)      // Return free space inside and at the end of GC segments to the OS eagerly
+RETAIL_CONFIG_VALUE(GcBackgroundDecommit)    // Decommit free GC memory on a thread of its own at a limited rate instead of in GC pauses
+RETAIL_CONFIG_VALUE(GcConserveMemory)        // 1-9 trades GC time for a smaller heap: compact fragmented gen2/LOH, decommit eagerly, small gen0
+RETAIL_CONFIG_VALUE(GcPauseTarget)           // Longest GC pause in microseconds the GC tunes its gen0 and gen1 budgets for, 0 disables
+RETAIL_CONFIG_VALUE_WITH_DEFAULT(GcIdleCollectPercent, 50) // Percent of the gen0/gen1 budget that must be used for RhNotifyIdle to collect
+RETAIL_CONFIG_VALUE(GcTypeStats)             // Count live objects per type while marking during full GCs (see RhGetGCHeapTypeStats)
+RETAIL_CONFIG_VALUE(GcDynamicHeapCount)      // Let server GC grow and shrink the number of heaps allocations use
+RETAIL_CONFIG_VALUE(AllocationSamplingInterval) // Average number of bytes between sampled allocations (see RhpGetAllocationSamples), 0 disables
+RETAIL_CONFIG_VALUE(EventSessionKeywords)    // Record the selected GC and runtime events to events_<pid>.bin, see EventSession.h
+RETAIL_CONFIG_VALUE(SuspendWarningThreshold) // Report threads that take more than this many milliseconds to reach a safe point, 0 disables
+RETAIL_CONFIG_VALUE(GcLOHThreshold)          // Objects of at least this many bytes go on the large object heap, 0 keeps the default of 85000
+RETAIL_CONFIG_VALUE(GcLargePages)            // Back the GC heap and its book keeping with large pages where the OS supports it
+RETAIL_CONFIG_VALUE(FinalizerThreadCount)    // Number of threads that run finalizers, 0 or 1 means the single regular finalizer thread
+RETAIL_CONFIG_VALUE(LazyFinalizerThread)     // Start the finalizer thread(s) on the first finalizable allocation or finalization request
+RETAIL_CONFIG_VALUE(StartupTimeline)         // Print the time spent in each startup phase and module registration at shutdown
+RETAIL_CONFIG_VALUE(MappedPreinitializedStatics) // Use preinitialized GC statics in place in the image instead of copying them to the GC heap
+RETAIL_CONFIG_VALUE(PreciseWriteBarrier)     // Don't mark cards for stores into generation 0 objects (workstation GC only)
+RETAIL_CONFIG_VALUE(HeapSnapshotSignal)      // Write a heap snapshot when the process receives this signal (Unix only), see HeapSnapshot.h
+RETAIL_CONFIG_VALUE(SamplingProfilerInterval) // Sample the stacks of threads running managed code every this many milliseconds, see SamplingProfiler.h
+RETAIL_CONFIG_VALUE(PerfMapEnabled)          // Describe the code of the modules and the thunks in /tmp/perf-<pid>.map (Unix only), see PerfMap.h
 DEBUG_CONFIG_VALUE(DisallowRuntimeServicesFallback)
 DEBUG_CONFIG_VALUE(GcStressThrottleMode)    // gcstm_TriggerAlways / gcstm_TriggerOnFirstHit / gcstm_TriggerRandom
 DEBUG_CONFIG_VALUE(GcStressFreqCallsite)    // Number of times to force GC out of GcStressFreqDenom (for GCSTM_RANDOM)
 DEBUG_CONFIG_VALUE(GcStressFreqLoop)        // Number of times to force GC out of GcStressFreqDenom (for GCSTM_RANDOM)
 DEBUG_CONFIG_VALUE(GcStressFreqDenom)       // Denominator defining frequencies above, 10,000 used when left unspecified (for GCSTM_RANDOM)
 DEBUG_CONFIG_VALUE(GcStressSeed)            // Specify Seed for random generator (for GCSTM_RANDOM)
+DEBUG_CONFIG_VALUE(GcStressEphemeralOnly)   // Stress GCs only collect the ephemeral generations instead of the whole heap
@@ -26,6 +26,7 @@
 #include "eetype.h"
 #include "varint.h"
 #include "DebugEventSource.h"
+#include "PerfMap.h"
 
 #include "CommonMacros.inl"
 #include "slist.inl"
@@ -70,15 +71,34 @@ PTR_UInt8 RuntimeInstance::FindMethodStartAddress(PTR_VOID ControlPC)
 
 ICodeManager * RuntimeInstance::FindCodeManagerByAddress(PTR_VOID pvAddress)
 {
-    ReaderWriterLock::ReadHolder read(&m_ModuleListLock);
-
     // TODO: ICodeManager support in DAC
 #ifndef DACCESS_COMPILE
-    for (CodeManagerEntry * pEntry = m_CodeManagerList.GetHead(); pEntry != NULL; pEntry = pEntry->m_pNext)
+    CodeManagerTable * pTable = m_pCodeManagerTable;
+    if (pTable == NULL)
+        return NULL;
+
+    // Find the last entry that starts at or below the address. The ranges don't overlap, so that is
+    // the only entry that may contain it.
+    CodeManagerEntry * pEntries = pTable->m_pEntries;
+    UInt32 low = 0;
+    UInt32 high = pTable->m_cEntries;
+    while (low < high)
+    {
+        UInt32 mid = low + (high - low) / 2;
+        if (dac_cast<TADDR>(pEntries[mid].m_pvStartRange) <= dac_cast<TADDR>(pvAddress))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low > 0)
     {
+        CodeManagerEntry * pEntry = &pEntries[low - 1];
         if (dac_cast<TADDR>(pvAddress) - dac_cast<TADDR>(pEntry->m_pvStartRange) < pEntry->m_cbRange)
             return pEntry->m_pCodeManager;
     }
+#else
+    UNREFERENCED_PARAMETER(pvAddress);
 #endif
 
     return NULL;
@@ -144,11 +164,11 @@ PTR_RuntimeInstance GetRuntimeInstance()
     return g_pTheRuntimeInstance;
 }
 
-void RuntimeInstance::EnumAllStaticGCRefs(void * pfnCallback, void * pvCallbackData)
+void RuntimeInstance::EnumAllStaticGCRefs(void * pfnCallback, void * pvCallbackData, bool fYoungRefsOnly)
 {
     for (TypeManagerList::Iterator iter = m_TypeManagerList.Begin(); iter != m_TypeManagerList.End(); iter++)
     {
-        iter->m_pTypeManager->EnumStaticGCRefs(pfnCallback, pvCallbackData);
+        iter->m_pTypeManager->EnumStaticGCRefs(pfnCallback, pvCallbackData, fYoungRefsOnly);
     }
 }
 
@@ -174,6 +194,9 @@ ReaderWriterLock& RuntimeInstance::GetTypeManagerLock()
 
 RuntimeInstance::RuntimeInstance() : 
     m_pThreadStore(NULL),
+    m_ModuleListLock(false, true /* read-mostly, keep concurrent readers off a shared counter */),
+    m_pCodeManagerTable(NULL),
+    m_pRetiredCodeManagerTables(NULL),
     m_conservativeStackReportingEnabled(false),
     m_pUnboxingStubsRegion(NULL)
 {
@@ -186,6 +209,9 @@ RuntimeInstance::~RuntimeInstance()
         delete m_pThreadStore;
         m_pThreadStore = NULL;
     }
+
+    ReclaimRetiredCodeManagerTables();
+    delete m_pCodeManagerTable;
 }
 
 HANDLE  RuntimeInstance::GetPalInstance()
@@ -198,46 +224,111 @@ void RuntimeInstance::EnableConservativeStackReporting()
     m_conservativeStackReportingEnabled = true;
 }
 
+// Replace the current code manager table with the new one and retire the old one. Must be called with
+// the module list write lock held.
+void RuntimeInstance::PublishCodeManagerTable(CodeManagerTable * pNewTable)
+{
+    CodeManagerTable * pOldTable = (CodeManagerTable *)PalInterlockedExchangePointer((void * volatile *)&m_pCodeManagerTable, pNewTable);
+    if (pOldTable == NULL)
+        return;
+
+    // Lookups may still be in progress on the old table, so it can only be freed once the EE is suspended
+    CodeManagerTable * pHead;
+    do
+    {
+        pHead = m_pRetiredCodeManagerTables;
+        pOldTable->m_pNextRetired = pHead;
+    }
+    while (PalInterlockedCompareExchangePointer((void * volatile *)&m_pRetiredCodeManagerTables, pOldTable, pHead) != pHead);
+}
+
+// Free the code manager tables replaced since the last call. Must be called while the EE is suspended.
+void RuntimeInstance::ReclaimRetiredCodeManagerTables()
+{
+    CodeManagerTable * pTable = (CodeManagerTable *)PalInterlockedExchangePointer((void * volatile *)&m_pRetiredCodeManagerTables, NULL);
+    while (pTable != NULL)
+    {
+        CodeManagerTable * pNext = pTable->m_pNextRetired;
+        delete pTable;
+        pTable = pNext;
+    }
+}
+
 bool RuntimeInstance::RegisterCodeManager(ICodeManager * pCodeManager, PTR_VOID pvStartRange, UInt32 cbRange)
 {
-    CodeManagerEntry * pEntry = new (nothrow) CodeManagerEntry();
-    if (NULL == pEntry)
+    ReaderWriterLock::WriteHolder write(&m_ModuleListLock);
+
+    CodeManagerTable * pOldTable = m_pCodeManagerTable;
+    UInt32 cOldEntries = (pOldTable != NULL) ? pOldTable->m_cEntries : 0;
+
+    NewHolder<CodeManagerTable> pNewTable = new (nothrow) CodeManagerTable();
+    if (NULL == pNewTable)
+        return false;
+
+    pNewTable->m_pEntries = new (nothrow) CodeManagerEntry[cOldEntries + 1];
+    if (NULL == pNewTable->m_pEntries)
         return false;
 
+    // Copy the old entries, inserting the new one at its sorted position
+    UInt32 iInsert = 0;
+    while (iInsert < cOldEntries && 
+           dac_cast<TADDR>(pOldTable->m_pEntries[iInsert].m_pvStartRange) < dac_cast<TADDR>(pvStartRange))
+    {
+        pNewTable->m_pEntries[iInsert] = pOldTable->m_pEntries[iInsert];
+        iInsert++;
+    }
+
+    for (UInt32 i = iInsert; i < cOldEntries; i++)
+        pNewTable->m_pEntries[i + 1] = pOldTable->m_pEntries[i];
+
+    CodeManagerEntry * pEntry = &pNewTable->m_pEntries[iInsert];
     pEntry->m_pvStartRange = pvStartRange;
     pEntry->m_cbRange = cbRange;
     pEntry->m_pCodeManager = pCodeManager;
+    pNewTable->m_cEntries = cOldEntries + 1;
 
-    {
-        ReaderWriterLock::WriteHolder write(&m_ModuleListLock);
+    PublishCodeManagerTable(pNewTable);
+    pNewTable.SuppressRelease();
 
-        m_CodeManagerList.PushHead(pEntry);
-    }
+    PerfMapLogCode(pvStartRange, cbRange, "[managed code]", pvStartRange);
 
     return true;
 }
 
 void RuntimeInstance::UnregisterCodeManager(ICodeManager * pCodeManager)
 {
-    CodeManagerEntry * pEntry = NULL;
+    ReaderWriterLock::WriteHolder write(&m_ModuleListLock);
 
-    {
-        ReaderWriterLock::WriteHolder write(&m_ModuleListLock);
+    CodeManagerTable * pOldTable = m_pCodeManagerTable;
+    ASSERT(pOldTable != NULL);
 
-        for (CodeManagerList::Iterator i = m_CodeManagerList.Begin(), end = m_CodeManagerList.End(); i != end; i++)
-        {
-            if (i->m_pCodeManager == pCodeManager)
-            {
-                pEntry = *i;
+    UInt32 iRemove = 0;
+    while (iRemove < pOldTable->m_cEntries && pOldTable->m_pEntries[iRemove].m_pCodeManager != pCodeManager)
+        iRemove++;
 
-                m_CodeManagerList.Remove(i);
-                break;
-            }
-        }
+    ASSERT(iRemove < pOldTable->m_cEntries);
+
+    NewHolder<CodeManagerTable> pNewTable = new (nothrow) CodeManagerTable();
+    if (NULL != pNewTable && pOldTable->m_cEntries > 1)
+        pNewTable->m_pEntries = new (nothrow) CodeManagerEntry[pOldTable->m_cEntries - 1];
+
+    if (NULL == pNewTable || (NULL == pNewTable->m_pEntries && pOldTable->m_cEntries > 1))
+    {
+        // Out of memory. Empty the range of the entry in the current table instead, so that lookups
+        // can no longer return the code manager being unregistered.
+        pOldTable->m_pEntries[iRemove].m_cbRange = 0;
+        return;
+    }
+
+    for (UInt32 i = 0, j = 0; i < pOldTable->m_cEntries; i++)
+    {
+        if (i != iRemove)
+            pNewTable->m_pEntries[j++] = pOldTable->m_pEntries[i];
     }
+    pNewTable->m_cEntries = pOldTable->m_cEntries - 1;
 
-    ASSERT(pEntry != NULL);
-    delete pEntry;
+    PublishCodeManagerTable(pNewTable);
+    pNewTable.SuppressRelease();
 }
 
 extern "C" bool __stdcall RegisterCodeManager(ICodeManager * pCodeManager, PTR_VOID pvStartRange, UInt32 cbRange)
@@ -267,6 +358,8 @@ bool RuntimeInstance::RegisterUnboxingStubs(PTR_VOID pvStartRange, UInt32 cbRang
     } 
     while (PalInterlockedCompareExchangePointer((void *volatile *)&m_pUnboxingStubsRegion, pEntry, pEntry->m_pNextRegion) != pEntry->m_pNextRegion);
 
+    PerfMapLogCode(pvStartRange, cbRange, "[unboxing stubs]", pvStartRange);
+
     return true;
 }
 
@@ -309,6 +402,8 @@ bool RuntimeInstance::RegisterTypeManager(TypeManager * pTypeManager)
 
 COOP_PINVOKE_HELPER(TypeManagerHandle, RhpCreateTypeManager, (HANDLE osModule, void* pModuleHeader, PTR_PTR_VOID pClasslibFunctions, UInt32 nClasslibFunctions))
 {
+    STARTUP_TIMELINE_EVENT(CREATE_TYPE_MANAGER_BEGIN);
+
     TypeManager * typeManager = TypeManager::Create(osModule, pModuleHeader, pClasslibFunctions, nClasslibFunctions);
     GetRuntimeInstance()->RegisterTypeManager(typeManager);
 
@@ -316,6 +411,8 @@ COOP_PINVOKE_HELPER(TypeManagerHandle, RhpCreateTypeManager, (HANDLE osModule, v
     if (osModule != nullptr)
         DebugEventSource::SendModuleLoadEvent(osModule);
 
+    STARTUP_TIMELINE_EVENT(CREATE_TYPE_MANAGER_COMPLETE);
+
     return TypeManagerHandle::Create(typeManager);
 }
 
@@ -506,29 +603,6 @@ COOP_PINVOKE_HELPER(PTR_VOID, RhGetRuntimeHelperForType, (EEType * pEEType, int
 #undef DECLARE_INDIRECTION
 #undef INDIRECTION
 
-#ifdef FEATURE_CACHED_INTERFACE_DISPATCH
-EXTERN_C void RhpInitialDynamicInterfaceDispatch();
-
-COOP_PINVOKE_HELPER(void *, RhNewInterfaceDispatchCell, (EEType * pInterface, Int32 slotNumber))
-{
-    InterfaceDispatchCell * pCell = new (nothrow) InterfaceDispatchCell[2];
-    if (pCell == NULL)
-        return NULL;
-
-    // Due to the synchronization mechanism used to update this indirection cell we must ensure the cell's alignment is twice that of a pointer.
-    // Fortunately, Windows heap guarantees this alignment.
-    ASSERT(IS_ALIGNED(pCell, 2 * POINTER_SIZE));
-    ASSERT(IS_ALIGNED(pInterface, (InterfaceDispatchCell::IDC_CachePointerMask + 1)));
-
-    pCell[0].m_pStub = (UIntNative)&RhpInitialDynamicInterfaceDispatch;
-    pCell[0].m_pCache = ((UIntNative)pInterface) | InterfaceDispatchCell::IDC_CachePointerIsInterfacePointerOrMetadataToken;
-    pCell[1].m_pStub = 0;
-    pCell[1].m_pCache = (UIntNative)slotNumber;
-
-    return pCell;
-}
-#endif // FEATURE_CACHED_INTERFACE_DISPATCH
-
 COOP_PINVOKE_HELPER(PTR_UInt8, RhGetThreadLocalStorageForDynamicType, (UInt32 uOffset, UInt32 tlsStorageSize, UInt32 numTlsCells))
 {
     Thread * pCurrentThread = ThreadStore::GetCurrentThread();
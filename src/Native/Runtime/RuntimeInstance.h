@@ -38,19 +38,32 @@ public:
 private:
     OsModuleList                m_OsModuleList;
 
-    struct CodeManagerEntry;
-    typedef DPTR(CodeManagerEntry) PTR_CodeManagerEntry;
-
     struct CodeManagerEntry
     {
-        PTR_CodeManagerEntry    m_pNext;
         PTR_VOID                m_pvStartRange;
         UInt32                  m_cbRange;
         ICodeManager *          m_pCodeManager;
     };
 
-    typedef SList<CodeManagerEntry> CodeManagerList;
-    CodeManagerList             m_CodeManagerList;
+    // Immutable array of the registered code managers sorted by start address. Registration and
+    // unregistration publish a new copy of the table, so lookups can binary search the current table
+    // without taking a lock. Replaced tables are retired and only freed by the GC while the EE is
+    // suspended, which is safe since lookups are only performed in cooperative mode or by the thread
+    // performing the suspension.
+    struct CodeManagerTable
+    {
+        CodeManagerTable *      m_pNextRetired;
+        UInt32                  m_cEntries;
+        CodeManagerEntry *      m_pEntries;
+
+        CodeManagerTable() : m_pNextRetired(NULL), m_cEntries(0), m_pEntries(NULL) { }
+        ~CodeManagerTable() { delete[] m_pEntries; }
+    };
+
+    CodeManagerTable * volatile m_pCodeManagerTable;
+    CodeManagerTable * volatile m_pRetiredCodeManagerTables;
+
+    void PublishCodeManagerTable(CodeManagerTable * pNewTable);
 
 public:
     struct TypeManagerEntry
@@ -101,6 +114,7 @@ public:
     void UnregisterCodeManager(ICodeManager * pCodeManager);
 
     ICodeManager * FindCodeManagerByAddress(PTR_VOID ControlPC);
+    void ReclaimRetiredCodeManagerTables();
     PTR_VOID GetClasslibFunctionFromCodeAddress(PTR_VOID address, ClasslibFunctionId functionId);
 
     bool RegisterTypeManager(TypeManager * pTypeManager);
@@ -114,7 +128,8 @@ public:
     static bool Initialize(HANDLE hPalInstance);
     void Destroy();
 
-    void EnumAllStaticGCRefs(void * pfnCallback, void * pvCallbackData);
+    // fYoungRefsOnly: only thread static references to objects in the ephemeral generations need reporting
+    void EnumAllStaticGCRefs(void * pfnCallback, void * pvCallbackData, bool fYoungRefsOnly = false);
 
     bool ShouldHijackCallsiteForGcStress(UIntNative CallsiteIP);
     bool ShouldHijackLoopForGcStress(UIntNative CallsiteIP);
@@ -0,0 +1,388 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "common.h"
+#include "CommonTypes.h"
+#include "CommonMacros.h"
+#include "daccess.h"
+#include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
+#include "rhassert.h"
+#include "slist.h"
+#include "varint.h"
+#include "regdisplay.h"
+#include "StackFrameIterator.h"
+#include "thread.h"
+#include "holder.h"
+#include "Crst.h"
+#include "event.h"
+#include "RWLock.h"
+#include "threadstore.h"
+#include "threadstore.inl"
+#include "thread.inl"
+#include "RhConfig.h"
+
+#include "SamplingProfiler.h"
+
+//
+// A sample is recorded by the interrupted thread into a slot of a small ring of pending samples, without locks
+// or allocations, and the profiler thread moves the pending samples to the table of stacks after every round of
+// interruptions. A sample that finds its slot still taken is dropped.
+//
+#define SAMPLING_PROFILER_MAX_FRAMES        64
+#define SAMPLING_PROFILER_PENDING_SAMPLES   256         // Power of 2
+#define SAMPLING_PROFILER_INITIAL_STACKS    1024        // Power of 2
+#define SAMPLING_PROFILER_MAPS_SIZE         (1024 * 1024)
+
+enum PendingSampleState
+{
+    PendingSample_Free,
+    PendingSample_Writing,
+    PendingSample_Ready,
+};
+
+struct PendingSample
+{
+    Int32 volatile  m_state;                            // PendingSampleState
+    UInt32          m_cFrames;
+    UIntNative      m_rgFrames[SAMPLING_PROFILER_MAX_FRAMES];
+};
+
+struct SampledStack
+{
+    UInt32          m_hash;
+    UInt32          m_cFrames;
+    UIntNative      m_cSamples;
+    UIntNative *    m_rgFrames;                         // NULL for an empty slot
+};
+
+static CrstStatic g_SamplingProfilerLock;
+static UInt32 g_samplingProfilerInterval = 0;           // Milliseconds, 0 when the profiler is disabled
+static bool volatile g_fSamplingProfilerStopped = false;
+static bool g_fSamplingProfileWritten = false;
+
+static Int32 volatile g_iNextPendingSample = 0;
+static Int32 volatile g_cDroppedSamples = 0;
+static PendingSample g_rgPendingSamples[SAMPLING_PROFILER_PENDING_SAMPLES];
+
+// Open addressed table of the distinct stacks, g_cStackSlots is a power of 2. Only used with the lock held.
+static SampledStack * g_rgStacks = NULL;
+static UInt32 g_cStackSlots = 0;
+static UInt32 g_cStacks = 0;
+
+// The context is the upper bound of the stack of the interrupted thread. On Unix this runs in the signal
+// handler of the interrupted thread and must be async signal safe.
+static UInt32_BOOL SampleCallback(HANDLE /*hThread*/, PAL_LIMITED_CONTEXT * pThreadContext, void * pCallbackContext)
+{
+    UInt32 iSample = (UInt32)PalInterlockedIncrement(&g_iNextPendingSample) & (SAMPLING_PROFILER_PENDING_SAMPLES - 1);
+    PendingSample * pSample = &g_rgPendingSamples[iSample];
+    if (PalInterlockedCompareExchange(&pSample->m_state, PendingSample_Writing, PendingSample_Free) != PendingSample_Free)
+    {
+        PalInterlockedIncrement(&g_cDroppedSamples);
+        return UInt32_FALSE;
+    }
+
+    UIntNative stackHigh = (UIntNative)pCallbackContext;
+    UIntNative sp = pThreadContext->GetSp();
+    UIntNative fp = pThreadContext->GetFp();
+
+    UInt32 cFrames = 0;
+    pSample->m_rgFrames[cFrames++] = pThreadContext->GetIp();
+
+    // Every frame record is the frame pointer of the caller followed by the return address. Only records that
+    // are on the stack of the thread, above the interrupted stack pointer, are followed, so a register that
+    // doesn't hold a frame pointer just ends the walk.
+    while ((cFrames < SAMPLING_PROFILER_MAX_FRAMES) &&
+           (fp >= sp) && (fp < stackHigh - 2 * sizeof(UIntNative)) &&
+           ((fp & (sizeof(UIntNative) - 1)) == 0))
+    {
+        UIntNative * pFrameRecord = (UIntNative *)fp;
+        UIntNative returnAddress = pFrameRecord[1];
+        if (returnAddress == 0)
+            break;
+
+        pSample->m_rgFrames[cFrames++] = returnAddress;
+
+        // The stack grows down, the frame of the caller must be above this one
+        UIntNative callerFp = pFrameRecord[0];
+        if (callerFp <= fp)
+            break;
+
+        fp = callerFp;
+    }
+
+    pSample->m_cFrames = cFrames;
+    PalInterlockedExchange(&pSample->m_state, PendingSample_Ready);
+
+    return UInt32_TRUE;
+}
+
+static UInt32 HashFrames(const UIntNative * rgFrames, UInt32 cFrames)
+{
+    UInt32 hash = cFrames;
+    for (UInt32 i = 0; i < cFrames; i++)
+    {
+        UIntNative frame = rgFrames[i];
+        hash = ((hash << 5) | (hash >> 27)) ^ (UInt32)frame ^ (UInt32)((UInt64)frame >> 32);
+    }
+
+    return hash;
+}
+
+static bool GrowStacks()
+{
+    UInt32 cNewSlots = (g_cStackSlots == 0) ? SAMPLING_PROFILER_INITIAL_STACKS : g_cStackSlots * 2;
+    SampledStack * rgNewStacks = new (nothrow) SampledStack[cNewSlots];
+    if (rgNewStacks == NULL)
+        return false;
+
+    memset(rgNewStacks, 0, cNewSlots * sizeof(SampledStack));
+
+    for (UInt32 i = 0; i < g_cStackSlots; i++)
+    {
+        if (g_rgStacks[i].m_rgFrames == NULL)
+            continue;
+
+        UInt32 iSlot = g_rgStacks[i].m_hash & (cNewSlots - 1);
+        while (rgNewStacks[iSlot].m_rgFrames != NULL)
+            iSlot = (iSlot + 1) & (cNewSlots - 1);
+
+        rgNewStacks[iSlot] = g_rgStacks[i];
+    }
+
+    delete[] g_rgStacks;
+    g_rgStacks = rgNewStacks;
+    g_cStackSlots = cNewSlots;
+    return true;
+}
+
+static void AddSample(const UIntNative * rgFrames, UInt32 cFrames)
+{
+    // Keep the table at most half full
+    if ((g_cStacks * 2 >= g_cStackSlots) && !GrowStacks())
+    {
+        PalInterlockedIncrement(&g_cDroppedSamples);
+        return;
+    }
+
+    UInt32 hash = HashFrames(rgFrames, cFrames);
+    UInt32 iSlot = hash & (g_cStackSlots - 1);
+    for (;;)
+    {
+        SampledStack * pStack = &g_rgStacks[iSlot];
+        if (pStack->m_rgFrames == NULL)
+            break;
+
+        if ((pStack->m_hash == hash) && (pStack->m_cFrames == cFrames) &&
+            (memcmp(pStack->m_rgFrames, rgFrames, cFrames * sizeof(UIntNative)) == 0))
+        {
+            pStack->m_cSamples++;
+            return;
+        }
+
+        iSlot = (iSlot + 1) & (g_cStackSlots - 1);
+    }
+
+    UIntNative * rgStackFrames = new (nothrow) UIntNative[cFrames];
+    if (rgStackFrames == NULL)
+    {
+        PalInterlockedIncrement(&g_cDroppedSamples);
+        return;
+    }
+
+    memcpy(rgStackFrames, rgFrames, cFrames * sizeof(UIntNative));
+
+    SampledStack * pStack = &g_rgStacks[iSlot];
+    pStack->m_hash = hash;
+    pStack->m_cFrames = cFrames;
+    pStack->m_cSamples = 1;
+    pStack->m_rgFrames = rgStackFrames;
+    g_cStacks++;
+}
+
+static void DrainPendingSamples()
+{
+    for (UInt32 i = 0; i < SAMPLING_PROFILER_PENDING_SAMPLES; i++)
+    {
+        PendingSample * pSample = &g_rgPendingSamples[i];
+        if (pSample->m_state != PendingSample_Ready)
+            continue;
+
+        AddSample(pSample->m_rgFrames, pSample->m_cFrames);
+        PalInterlockedExchange(&pSample->m_state, PendingSample_Free);
+    }
+}
+
+static UInt32 __stdcall SamplingProfilerThread(void * /*pContext*/)
+{
+    // The thread has no managed frames, so like the heap snapshot thread it is attached as a GC special thread
+    // to keep the GC from walking its stack.
+    ThreadStore::AttachCurrentThread();
+    Thread * pCurrentThread = ThreadStore::GetCurrentThread();
+    pCurrentThread->SetGCSpecial(true);
+
+    while (!g_fSamplingProfilerStopped)
+    {
+        PalSleep(g_samplingProfilerInterval);
+
+        // PalHijack holds one callback per thread, so the threads are left alone while the GC is hijacking
+        // them. The GC hijacks the threads again on every round of polling them anyway.
+        FOREACH_THREAD(pThread)
+        {
+            if (g_fSamplingProfilerStopped || ThreadStore::IsTrapThreadsRequested())
+                break;
+
+            if ((pThread == pCurrentThread) || pThread->IsGCSpecial())
+                continue;
+
+            PTR_VOID pStackLow, pStackHigh;
+            pThread->GetStackBounds(&pStackLow, &pStackHigh);
+            pThread->InterruptForSample(SampleCallback, pStackHigh);
+        }
+        END_FOREACH_THREAD
+
+        CrstHolder lock(&g_SamplingProfilerLock);
+        DrainPendingSamples();
+    }
+
+    return 0;
+}
+
+static TCHAR * AppendNumber(TCHAR * pch, UInt32 value)
+{
+    TCHAR digits[10];
+    UInt32 cDigits = 0;
+    do
+    {
+        digits[cDigits++] = (TCHAR)(_T('0') + value % 10);
+        value /= 10;
+    } while (value != 0);
+    while (cDigits > 0)
+        *pch++ = digits[--cDigits];
+
+    return pch;
+}
+
+class SamplingProfileWriter
+{
+    HANDLE  m_hFile;
+    bool    m_fFailed;
+
+public:
+    SamplingProfileWriter(HANDLE hFile)
+        : m_hFile(hFile), m_fFailed(false)
+    {
+    }
+
+    void Write(const void * pData, UInt32 cbData)
+    {
+        if (!m_fFailed && !PalWriteFileContents(m_hFile, pData, cbData))
+            m_fFailed = true;
+    }
+
+    void WriteWord(UIntNative value)
+    {
+        Write(&value, sizeof(value));
+    }
+
+    bool HasFailed()
+    {
+        return m_fFailed;
+    }
+};
+
+static bool WriteProfile()
+{
+    TCHAR fileName[48] = _T("cpuprofile_");
+    TCHAR * pch = fileName;
+    while (*pch != 0)
+        pch++;
+
+    pch = AppendNumber(pch, PalGetCurrentProcessId());
+
+    const TCHAR extension[] = _T(".prof");
+    for (size_t i = 0; i < COUNTOF(extension); i++)
+        *pch++ = extension[i];
+
+    HANDLE hFile = PalCreateFileForWriting(fileName);
+    if (hFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    SamplingProfileWriter writer(hFile);
+
+    writer.WriteWord(0);
+    writer.WriteWord(3);
+    writer.WriteWord(0);
+    writer.WriteWord((UIntNative)g_samplingProfilerInterval * 1000);
+    writer.WriteWord(0);
+
+    for (UInt32 i = 0; i < g_cStackSlots; i++)
+    {
+        SampledStack * pStack = &g_rgStacks[i];
+        if (pStack->m_rgFrames == NULL)
+            continue;
+
+        writer.WriteWord(pStack->m_cSamples);
+        writer.WriteWord(pStack->m_cFrames);
+        writer.Write(pStack->m_rgFrames, pStack->m_cFrames * sizeof(UIntNative));
+    }
+
+    writer.WriteWord(0);
+    writer.WriteWord(1);
+    writer.WriteWord(0);
+
+#ifdef TARGET_UNIX
+    // The maps are read in one go so pprof gets a consistent view of them. If they don't fit the buffer, only
+    // the complete lines are written.
+    char * pMaps = new (nothrow) char[SAMPLING_PROFILER_MAPS_SIZE];
+    if (pMaps != NULL)
+    {
+        UInt32 cbMaps = PalReadFileContents(_T("/proc/self/maps"), pMaps, SAMPLING_PROFILER_MAPS_SIZE);
+        while ((cbMaps != 0) && (pMaps[cbMaps - 1] != '\n'))
+            cbMaps--;
+
+        writer.Write(pMaps, cbMaps);
+        delete[] pMaps;
+    }
+#endif // TARGET_UNIX
+
+    PalCloseHandle(hFile);
+    return !writer.HasFailed();
+}
+
+void WriteSamplingProfile()
+{
+    if (g_samplingProfilerInterval == 0)
+        return;
+
+    CrstHolder lock(&g_SamplingProfilerLock);
+
+    if (g_fSamplingProfileWritten)
+        return;
+    g_fSamplingProfileWritten = true;
+
+    // Samples recorded after this point are not written
+    g_fSamplingProfilerStopped = true;
+    DrainPendingSamples();
+
+    if (!WriteProfile())
+        fprintf(stderr, "The sampling profile couldn't be written\n");
+    else if (g_cDroppedSamples != 0)
+        fprintf(stderr, "The sampling profile is missing %d dropped samples\n", g_cDroppedSamples);
+}
+
+bool InitializeSamplingProfiler()
+{
+    g_SamplingProfilerLock.Init(CrstSamplingProfiler, CRST_DEFAULT);
+
+    UInt32 interval = g_pRhConfig->GetSamplingProfilerInterval();
+    if (interval == 0)
+        return true;
+
+    // The runtime works the same without the profiler, so failing to start it isn't fatal.
+    g_samplingProfilerInterval = interval;
+    if (!PalStartBackgroundGCThread(SamplingProfilerThread, NULL))
+        g_samplingProfilerInterval = 0;
+
+    return true;
+}
@@ -0,0 +1,29 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Sampling CPU profiler. When the SamplingProfilerInterval runtime configuration value is set, a background
+// thread interrupts the threads that are running managed code every that many milliseconds, with PalHijack,
+// and records the stack each of them was interrupted at. At shutdown the samples, aggregated by stack, are
+// written to cpuprofile_<pid>.prof in the current directory.
+//
+// The file is in the legacy CPU profile format of gperftools, which pprof reads: a header of five words
+// (0, 3, 0, interval in microseconds, 0), a record per distinct stack of the form (number of samples, number of
+// frames, frames...), the leaf frame first, a trailer (0, 1, 0), and then the text of /proc/self/maps for pprof
+// to map the frames to the symbols of the modules. Words are pointer sized.
+//
+// The stacks are walked by following the frame pointer chain from the interrupted context, which on Unix is
+// done in the signal handler of the interrupted thread. StackFrameIterator can't be used there, it takes locks
+// and decodes unwind info. Frames of code that doesn't set up a frame pointer are missed, the leaf frame is
+// always recorded.
+//
+// Threads in preemptive mode are not sampled: they are running native code or, most of the time, blocked.
+//
+
+#pragma once
+
+bool InitializeSamplingProfiler();
+
+// Called at shutdown, stops the sampling and writes the profile if the profiler is enabled.
+void WriteSamplingProfile();
@@ -52,8 +52,37 @@ private:
 
     volatile Int32 m_lock;
 
+    // Number of normalized yields a waiter spins for before it starts giving up its processor.
+    static const UInt32 SPIN_COUNT = 100;
+
     static void Lock(SpinLock& lock)
-        { YIELD_WHILE (PalInterlockedExchange(&lock.m_lock, LOCKED) == LOCKED); }
+    {
+        if (PalInterlockedExchange(&lock.m_lock, LOCKED) == UNLOCKED)
+            return;
+
+        // Wait on plain reads so that waiters don't keep pulling the cache line away from the holder. Spin
+        // briefly in case the lock is released soon, then switch threads (with periodic sleeps) so that a
+        // descheduled holder gets a chance to run instead of the waiters burning the CPU.
+        YieldProcessorNormalizationInfo normalizationInfo;
+        UInt32 uSpinCount = (g_RhSystemInfo.dwNumberOfProcessors > 1) ? SPIN_COUNT : 0;
+        UInt32 uSwitchCount = 0;
+        do
+        {
+            while (lock.m_lock == LOCKED)
+            {
+                if (uSpinCount > 0)
+                {
+                    uSpinCount--;
+                    YieldProcessorNormalized(normalizationInfo);
+                }
+                else
+                {
+                    __SwitchToThread(0, ++uSwitchCount);
+                }
+            }
+        }
+        while (PalInterlockedExchange(&lock.m_lock, LOCKED) == LOCKED);
+    }
 
     static void Unlock(SpinLock& lock)
         { PalInterlockedExchange(&lock.m_lock, UNLOCKED); }
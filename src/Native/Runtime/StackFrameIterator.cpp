@@ -1677,6 +1677,12 @@ REGDISPLAY * StackFrameIterator::GetRegisterSet()
     return &m_RegDisplay;
 }
 
+PTR_VOID StackFrameIterator::GetControlPC()
+{
+    ASSERT(IsValid());
+    return m_ControlPC;
+}
+
 PTR_VOID StackFrameIterator::GetEffectiveSafePointAddress()
 {
     ASSERT(IsValid());
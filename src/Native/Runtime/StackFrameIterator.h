@@ -37,12 +37,16 @@ public:
     StackFrameIterator(Thread * pThreadToWalk, PTR_VOID pInitialTransitionFrame);
     StackFrameIterator(Thread * pThreadToWalk, PTR_PAL_LIMITED_CONTEXT pCtx);
 
+    // Starts a walk of the current thread's stack from its most recent transition frame, the same way
+    // Environment.StackTrace does.
+    void             InitForStackTrace() { InternalInitForStackTrace(); }
 
     bool             IsValid();
     void             CalculateCurrentMethodState();
     void             Next();
     PTR_VOID         GetEffectiveSafePointAddress();
     REGDISPLAY *     GetRegisterSet();
+    PTR_VOID         GetControlPC();
     PTR_ICodeManager GetCodeManager();
     MethodInfo *     GetMethodInfo();
     bool             GetHijackedReturnValueLocation(PTR_RtuObjectRef * pLocation, GCRefKind * pKind);
@@ -10,9 +10,12 @@
 #include "rhassert.h"
 #include "slist.h"
 #include "holder.h"
+#include "yieldprocessornormalized.h"
 #include "SpinLock.h"
 #include "rhbinder.h"
 #include "CachedInterfaceDispatch.h"
+#include "RWLock.h"
+#include "RuntimeInstance.h"
 
 #include "SyncClean.hpp"
 
@@ -27,4 +30,7 @@ void SyncClean::CleanUp ()
     // Update any interface dispatch caches that were unsafe to modify outside of this GC.
     ReclaimUnusedInterfaceDispatchCaches();
 #endif
+
+    // Free the code manager tables that were replaced since the last GC.
+    GetRuntimeInstance()->ReclaimRetiredCodeManagerTables();
 }
@@ -11,6 +11,8 @@
 #include "volatile.h"
 #include "PalRedhawk.h"
 #include "rhassert.h"
+#include "PerfMap.h"
+#include "NativeMemory.h"
 
 
 #ifdef FEATURE_RX_THUNKS
@@ -207,6 +209,9 @@ EXTERN_C REDHAWK_API void* __cdecl RhAllocateThunksMapping()
         return NULL;
     }
 
+    NativeMemoryAdd(NativeMemoryKind_Thunks, THUNKS_MAP_SIZE * 2);
+    PerfMapLogCode(pThunksSection, THUNKS_MAP_SIZE, "[thunks]", NULL);
+
     return pThunksSection;
 }
 
@@ -261,6 +266,9 @@ EXTERN_C REDHAWK_API void* __cdecl RhAllocateThunksMapping()
         return NULL;
     }
 
+    if (pThunkMap != pThunksTemplateAddress)
+        NativeMemoryAdd(NativeMemoryKind_Thunks, templateSize);
+
     return pThunkMap;
 }
 
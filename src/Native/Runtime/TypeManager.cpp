@@ -21,6 +21,7 @@
 #include "event.h"
 #include "threadstore.h"
 #include "TypeManager.h"
+#include "RhConfig.h"
 
 /* static */
 TypeManager * TypeManager::Create(HANDLE osModule, void * pModuleHeader, void** pClasslibFunctions, UInt32 nClasslibFunctions)
@@ -44,6 +45,23 @@ TypeManager::TypeManager(HANDLE osModule, ReadyToRunHeader * pHeader, void** pCl
     : m_osModule(osModule), m_pHeader(pHeader),
       m_pClasslibFunctions(pClasslibFunctions), m_nClasslibFunctions(nClasslibFunctions)
 {
+    ASSERT(m_pHeader->EntrySize == sizeof(ModuleInfoRow));
+
+    memset(m_rgSectionIndex, 0, sizeof(m_rgSectionIndex));
+
+    ModuleInfoRow * pModuleInfoRows = (ModuleInfoRow *)(m_pHeader + 1);
+    for (int i = 0; i < m_pHeader->NumberOfSections; i++)
+    {
+        int32_t sectionId = pModuleInfoRows[i].SectionId;
+        if (sectionId < FirstIndexedSectionId || sectionId > LastIndexedSectionId)
+            continue;
+
+        // Keep the first row for a section, same as the linear lookup would
+        UInt16 * pEntry = &m_rgSectionIndex[sectionId - FirstIndexedSectionId];
+        if (*pEntry == 0)
+            *pEntry = (UInt16)(i + 1);
+    }
+
     int length;
     m_pStaticsGCDataSection = (UInt8*)GetModuleSection(ReadyToRunSectionType::GCStaticRegion, &length);
     m_pStaticsGCInfo = (StaticGcDesc*)GetModuleSection(ReadyToRunSectionType::GCStaticDesc, &length);
@@ -51,16 +69,69 @@ TypeManager::TypeManager(HANDLE osModule, ReadyToRunHeader * pHeader, void** pCl
     m_pThreadStaticsGCInfo = (StaticGcDesc*)GetModuleSection(ReadyToRunSectionType::ThreadStaticGCDescRegion, &length);
     m_pTlsIndex = (UInt32*)GetModuleSection(ReadyToRunSectionType::ThreadStaticIndex, &length);
     m_pLoopHijackFlag = (UInt32*)GetModuleSection(ReadyToRunSectionType::LoopHijackFlag, &length);
-    m_pDispatchMapTable = (DispatchMap **)GetModuleSection(ReadyToRunSectionType::InterfaceDispatchTable, &length);
+    m_pDispatchMapTable = (Int32*)GetModuleSection(ReadyToRunSectionType::InterfaceDispatchTable, &length);
+    m_pPreInitializedStatics = nullptr;
+    m_cbPreInitializedStatics = 0;
+
+    // The section always ends with a null pointer terminator
+    m_pFrozenObjectsWithGCRefs = (UInt8*)GetModuleSection(ReadyToRunSectionType::FrozenObjectsWithGCRefsRegion, &length);
+    m_cbFrozenObjectsWithGCRefs = (m_pFrozenObjectsWithGCRefs != nullptr) ? (UInt32)length : 0;
+    if (m_cbFrozenObjectsWithGCRefs <= sizeof(void*))
+    {
+        m_pFrozenObjectsWithGCRefs = nullptr;
+        m_cbFrozenObjectsWithGCRefs = 0;
+    }
+}
+
+// The compiler lays out the preinitialized GC static bases of the module as complete objects in a writable
+// data section. By default the startup code copies them over GC static objects allocated on the GC heap. When
+// MappedPreinitializedStatics is set, the section is registered as a frozen segment and the objects are used
+// in place instead: no allocation or copy happens at startup, and pages that are never written stay shared
+// with the image file.
+//
+// The section is usually outside of the range covered by the card table, so the write barrier doesn't track
+// stores into it. The reference fields of these objects are reported as static roots on every GC instead
+// (see EnumStaticGCRefs); static bases without reference fields are not reported at all.
+bool TypeManager::RegisterPreInitializedStatics()
+{
+    if (!g_pRhConfig->GetMappedPreinitializedStatics())
+        return false;
+
+    int length;
+    UInt8 * pSection = (UInt8*)GetModuleSection(ReadyToRunSectionType::PreInitializedStaticsRegion, &length);
+
+    // The section always ends with a null pointer terminator
+    if (pSection == nullptr || length <= (int)sizeof(void*))
+        return false;
+
+    if (RedhawkGCInterface::RegisterFrozenSegment(pSection, length) == NULL)
+        return false;
+
+    m_cbPreInitializedStatics = length;
+    m_pPreInitializedStatics = pSection;
+    return true;
 }
 
 void * TypeManager::GetModuleSection(ReadyToRunSectionType sectionId, int * length)
 {
     ModuleInfoRow * pModuleInfoRows = (ModuleInfoRow *)(m_pHeader + 1);
 
-    ASSERT(m_pHeader->EntrySize == sizeof(ModuleInfoRow));
+    int32_t id = (int32_t)sectionId;
+    if (id >= FirstIndexedSectionId && id <= LastIndexedSectionId)
+    {
+        UInt16 entry = m_rgSectionIndex[id - FirstIndexedSectionId];
+        if (entry == 0)
+        {
+            *length = 0;
+            return nullptr;
+        }
+
+        ModuleInfoRow * pCurrent = pModuleInfoRows + (entry - 1);
+        *length = pCurrent->GetLength();
+        return pCurrent->Start;
+    }
 
-    // TODO: Binary search
+    // Sections outside of the indexed range are rare, fall back to walking the rows
     for (int i = 0; i < m_pHeader->NumberOfSections; i++)
     {
         ModuleInfoRow * pCurrent = pModuleInfoRows + i;
@@ -102,7 +173,7 @@ int TypeManager::ModuleInfoRow::GetLength()
     }
 }
 
-void TypeManager::EnumStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo)
+void TypeManager::EnumStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo, bool fYoungRefsOnly)
 {
     if (pStaticGcInfo == NULL)
         return;
@@ -117,11 +188,14 @@ void TypeManager::EnumStaticGCRefsBlock(void * pfnCallback, void * pvCallbackDat
         PTR_RtuObjectRef    pRefLocation = dac_cast<PTR_RtuObjectRef>(dac_cast<PTR_UInt8>(&pSeries->m_startOffset) + (Int32)pSeries->m_startOffset);
         UInt32              numObjects = pSeries->m_size;
 
-        RedhawkGCInterface::BulkEnumGcObjRef(pRefLocation, numObjects, pfnCallback, pvCallbackData);
+        if (fYoungRefsOnly)
+            RedhawkGCInterface::BulkEnumEphemeralGcObjRef(pRefLocation, numObjects, pfnCallback, pvCallbackData);
+        else
+            RedhawkGCInterface::BulkEnumGcObjRef(pRefLocation, numObjects, pfnCallback, pvCallbackData);
     }
 }
 
-void TypeManager::EnumThreadStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo, UInt8* pbThreadStaticData)
+void TypeManager::EnumThreadStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo, UInt8* pbThreadStaticData, bool fYoungRefsOnly)
 {
     if (pStaticGcInfo == NULL)
         return;
@@ -136,26 +210,54 @@ void TypeManager::EnumThreadStaticGCRefsBlock(void * pfnCallback, void * pvCallb
         PTR_RtuObjectRef    pRefLocation = dac_cast<PTR_RtuObjectRef>(pTlsObject);
         UInt32              numObjects = pSeries->m_size;
 
-        RedhawkGCInterface::BulkEnumGcObjRef(pRefLocation, numObjects, pfnCallback, pvCallbackData);
+        if (fYoungRefsOnly)
+            RedhawkGCInterface::BulkEnumEphemeralGcObjRef(pRefLocation, numObjects, pfnCallback, pvCallbackData);
+        else
+            RedhawkGCInterface::BulkEnumGcObjRef(pRefLocation, numObjects, pfnCallback, pvCallbackData);
     }
 }
 
-void TypeManager::EnumStaticGCRefs(void * pfnCallback, void * pvCallbackData)
+void TypeManager::EnumStaticGCRefs(void * pfnCallback, void * pvCallbackData, bool fYoungRefsOnly)
 {
-    // Regular statics.
-    EnumStaticGCRefsBlock(pfnCallback, pvCallbackData, m_pStaticsGCInfo);
+    // Regular statics. The static bases they refer to are allocated at startup and are old by the time of most
+    // GCs, so ephemeral GCs skip them the same way as the thread statics below.
+    EnumStaticGCRefsBlock(pfnCallback, pvCallbackData, m_pStaticsGCInfo, fYoungRefsOnly);
+
+    // Preinitialized statics used in place in the image.
+    if (m_pPreInitializedStatics != nullptr)
+    {
+        RedhawkGCInterface::EnumGcRefsInFrozenObjects(m_pPreInitializedStatics, m_cbPreInitializedStatics,
+            pfnCallback, pvCallbackData, fYoungRefsOnly);
+    }
+
+    // Preinitialized object graphs in the frozen segment. When the image is loaded they only refer to other
+    // frozen objects, which the GC doesn't collect or relocate, but the program may store references to
+    // objects on the GC heap into them later. The card table doesn't cover the image, so the references are
+    // reported here; ephemeral GCs only need the young ones, which are rare.
+    if (m_pFrozenObjectsWithGCRefs != nullptr)
+    {
+        RedhawkGCInterface::EnumGcRefsInFrozenObjects(m_pFrozenObjectsWithGCRefs, m_cbFrozenObjectsWithGCRefs,
+            pfnCallback, pvCallbackData, fYoungRefsOnly);
+    }
     
-    // Thread local statics.
+    // Thread local statics. With thousands of threads these dominate the static roots, even though the
+    // threads that haven't run since the previous GC typically only refer to objects that were promoted
+    // out of the ephemeral generations by now. For ephemeral GCs only the references to young objects are
+    // reported to the GC, which is where the per reference cost of the scan lies.
     if (m_pThreadStaticsGCInfo != NULL)
     {
         FOREACH_THREAD(pThread)
         {
+            // "GC Special" threads never run managed code, so their thread statics are never written.
+            if (pThread->IsGCSpecial())
+                continue;
+
             // To calculate the address of the data for each thread's TLS fields we need two values:
             //  1) The TLS slot index allocated for this module by the OS loader. We keep a pointer to this
             //     value in the module header.
             //  2) The offset into the TLS block at which managed data begins. 
             EnumThreadStaticGCRefsBlock(pfnCallback, pvCallbackData, m_pThreadStaticsGCInfo,
-                dac_cast<UInt8*>(pThread->GetThreadLocalStorage(*m_pTlsIndex, 0)));
+                dac_cast<UInt8*>(pThread->GetThreadLocalStorage(*m_pTlsIndex, 0)), fYoungRefsOnly);
         }
         END_FOREACH_THREAD
     }
@@ -6,7 +6,6 @@
 #include "ICodeManager.h"
 
 struct StaticGcDesc;
-class DispatchMap;
 typedef unsigned char       UInt8;
 
 class TypeManager
@@ -14,7 +13,7 @@ class TypeManager
     // NOTE: Part of this layout is a contract with the managed side in TypeManagerHandle.cs
     HANDLE                      m_osModule;
     ReadyToRunHeader *          m_pHeader;
-    DispatchMap**               m_pDispatchMapTable;
+    Int32*                      m_pDispatchMapTable;    // DispatchMaps of the module, relative pointers unless the target can't use them
     StaticGcDesc*               m_pStaticsGCInfo;
     StaticGcDesc*               m_pThreadStaticsGCInfo;
     UInt8*                      m_pStaticsGCDataSection;
@@ -23,17 +22,28 @@ class TypeManager
     void**                      m_pClasslibFunctions;
     UInt32                      m_nClasslibFunctions;
     UInt32*                     m_pLoopHijackFlag; 
+    UInt8*                      m_pPreInitializedStatics;       // Set when the preinitialized statics are used in place
+    UInt32                      m_cbPreInitializedStatics;
+    UInt8*                      m_pFrozenObjectsWithGCRefs;     // Frozen objects the compiler emitted with reference fields
+    UInt32                      m_cbFrozenObjectsWithGCRefs;
+
+    // Sections with IDs in [FirstIndexedSectionId, LastIndexedSectionId] are looked up through this table
+    // instead of walking the ModuleInfoRows. An entry is the index of the row + 1, 0 if the section is absent.
+    static const int FirstIndexedSectionId = (int)ReadyToRunSectionType::StringTable;
+    static const int LastIndexedSectionId = (int)ReadyToRunSectionType::ReadonlyBlobRegionEnd;
+    UInt16                      m_rgSectionIndex[LastIndexedSectionId - FirstIndexedSectionId + 1];
 
     TypeManager(HANDLE osModule, ReadyToRunHeader * pHeader, void** pClasslibFunctions, UInt32 nClasslibFunctions);
 
 public:
     static TypeManager * Create(HANDLE osModule, void * pModuleHeader, void** pClasslibFunctions, UInt32 nClasslibFunctions);
     void * GetModuleSection(ReadyToRunSectionType sectionId, int * length);
-    void EnumStaticGCRefs(void * pfnCallback, void * pvCallbackData);
+    void EnumStaticGCRefs(void * pfnCallback, void * pvCallbackData, bool fYoungRefsOnly);
     HANDLE GetOsModuleHandle();
     void* GetClasslibFunction(ClasslibFunctionId functionId);
     UInt32* GetPointerToTlsIndex() { return m_pTlsIndex; }
     void SetLoopHijackFlag(UInt32 flag) { if (m_pLoopHijackFlag != nullptr) *m_pLoopHijackFlag = flag; }
+    bool RegisterPreInitializedStatics();
 
 private:
     
@@ -48,8 +58,8 @@ private:
         int GetLength();
     };
 
-    void EnumStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo);
-    void EnumThreadStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo, UInt8* pbThreadStaticData);
+    void EnumStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo, bool fYoungRefsOnly);
+    void EnumThreadStaticGCRefsBlock(void * pfnCallback, void * pvCallbackData, StaticGcDesc* pStaticGcInfo, UInt8* pbThreadStaticData, bool fYoungRefsOnly);
 };
 
 // TypeManagerHandle represents an AOT module in MRT based runtimes.
@@ -17,12 +17,34 @@
 #include "memaccessmgr.h"
 #endif
 #include "allocheap.h"
+#include "NativeMemory.h"
 
 #include "CommonMacros.inl"
 #include "slist.inl"
 
 using namespace rh::util;
 
+#ifdef FEATURE_RWX_MEMORY
+#define PASS_NULL_WRITE_ACCESS_HOLDER_ARG       , NULL
+#else // FEATURE_RWX_MEMORY
+#define PASS_NULL_WRITE_ACCESS_HOLDER_ARG
+#endif // FEATURE_RWX_MEMORY
+
+// The chunk of the heap a thread allocated from last. Heaps are told apart by id rather than by address, so the
+// chunk of a destroyed heap is never used by a heap created at the same address.
+struct AllocHeapThreadChunk
+{
+    UInt32      m_heapId;
+    UInt8 *     m_pNextFree;
+    UInt8 *     m_pEnd;
+};
+
+DECLSPEC_THREAD
+static AllocHeapThreadChunk tls_allocHeapChunk;
+
+// Ids start at 1, 0 is the id of the empty chunk of a thread that didn't allocate yet.
+static Int32 volatile s_lastAllocHeapId = 0;
+
 //-------------------------------------------------------------------------------------------------
 AllocHeap::AllocHeap()
     : m_blockList(),
@@ -37,7 +59,8 @@ AllocHeap::AllocHeap()
       m_pFreeReserveEnd(NULL),
       m_pbInitialMem(NULL),
       m_fShouldFreeInitialMem(false),
-      m_lock(CrstAllocHeap)
+      m_lock(CrstAllocHeap),
+      m_heapId((UInt32)PalInterlockedIncrement(&s_lastAllocHeapId))
       COMMA_INDEBUG(m_fIsInit(false))
 {
     ASSERT(!_UseAccessManager());
@@ -59,7 +82,8 @@ AllocHeap::AllocHeap(
       m_pFreeReserveEnd(NULL),
       m_pbInitialMem(NULL),
       m_fShouldFreeInitialMem(false),
-      m_lock(CrstAllocHeap)
+      m_lock(CrstAllocHeap),
+      m_heapId((UInt32)PalInterlockedIncrement(&s_lastAllocHeapId))
       COMMA_INDEBUG(m_fIsInit(false))
 {
     ASSERT(!_UseAccessManager() || (m_rwProtectType != m_roProtectType && m_pAccessMgr != NULL));
@@ -110,6 +134,9 @@ bool AllocHeap::Init(
     m_pbInitialMem = pbInitialMem;
     m_fShouldFreeInitialMem = fShouldFreeInitialMem;
 
+    if (fShouldFreeInitialMem)
+        NativeMemoryAdd(NativeMemoryKind_AllocHeap, cbInitialMemReserve);
+
     INDEBUG(m_fIsInit = true;)
     return true;
 }
@@ -121,7 +148,10 @@ AllocHeap::~AllocHeap()
     {
         BlockListElem *pCur = m_blockList.PopHead();
         if (pCur->GetStart() != m_pbInitialMem || m_fShouldFreeInitialMem)
+        {
             PalVirtualFree(pCur->GetStart(), pCur->GetLength(), MEM_RELEASE);
+            NativeMemoryRemove(NativeMemoryKind_AllocHeap, pCur->GetLength());
+        }
         delete pCur;
     }
 }
@@ -145,8 +175,63 @@ UInt8 * AllocHeap::_Alloc(
     if (_UseAccessManager() && pRWAccessHolder == NULL)
         return NULL;
 
+    if (!_UseAccessManager() && cbMem <= s_maxThreadChunkAlloc)
+    {
+        UInt8 * pbMem = _AllocFromThreadChunk(cbMem, alignment);
+        if (pbMem != NULL)
+            return pbMem;
+    }
+
     CrstHolder lock(&m_lock);
 
+    return _AllocLocked(cbMem, alignment PASS_WRITE_ACCESS_HOLDER_ARG);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Allocates from the chunk of the current thread, which only the thread uses and so needs no lock. The lock is
+// only taken to replace the chunk when it doesn't have room left, the rest of the old chunk is not used again.
+UInt8 * AllocHeap::_AllocFromThreadChunk(
+    UIntNative cbMem,
+    UIntNative alignment)
+{
+    ASSERT(!_UseAccessManager());
+    ASSERT(cbMem <= s_maxThreadChunkAlloc);
+
+    AllocHeapThreadChunk * pChunk = &tls_allocHeapChunk;
+
+    if (pChunk->m_heapId == m_heapId)
+    {
+        UInt8 * pbMem = ALIGN_UP(pChunk->m_pNextFree, alignment);
+        if (pbMem <= pChunk->m_pEnd && (UIntNative)(pChunk->m_pEnd - pbMem) >= cbMem)
+        {
+            pChunk->m_pNextFree = pbMem + cbMem;
+            return pbMem;
+        }
+    }
+
+    UInt8 * pbChunk;
+    {
+        CrstHolder lock(&m_lock);
+        pbChunk = _AllocLocked(s_threadChunkSize, alignment PASS_NULL_WRITE_ACCESS_HOLDER_ARG);
+    }
+
+    if (pbChunk == NULL)
+        return NULL;
+
+    pChunk->m_heapId = m_heapId;
+    pChunk->m_pNextFree = pbChunk + cbMem;
+    pChunk->m_pEnd = pbChunk + s_threadChunkSize;
+    return pbChunk;
+}
+
+//-------------------------------------------------------------------------------------------------
+UInt8 * AllocHeap::_AllocLocked(
+    UIntNative cbMem,
+    UIntNative alignment
+    WRITE_ACCESS_HOLDER_ARG)
+{
+    ASSERT(m_lock.OwnedByCurrentThread());
+
     UInt8 * pbMem = _AllocFromCurBlock(cbMem, alignment PASS_WRITE_ACCESS_HOLDER_ARG);
     if (pbMem != NULL)
         return pbMem;
@@ -297,6 +382,8 @@ bool AllocHeap::_AllocNewBlock(UIntNative cbMem)
     // memory barrier to make sure any reader sees a consistent list.
     m_blockList.PushHeadInterlocked(pBlockListElem);
 
+    NativeMemoryAdd(NativeMemoryKind_AllocHeap, cbMem);
+
     return _UpdateMemPtrs(pbMem, pbMem + cbMem, pbMem + cbMem);
 }
 
@@ -62,6 +62,8 @@ class AllocHeap
   private:
     // Allocation Helpers
     UInt8* _Alloc(UIntNative cbMem, UIntNative alignment WRITE_ACCESS_HOLDER_ARG);
+    UInt8* _AllocFromThreadChunk(UIntNative cbMem, UIntNative alignment);
+    UInt8* _AllocLocked(UIntNative cbMem, UIntNative alignment WRITE_ACCESS_HOLDER_ARG);
     bool _AllocNewBlock(UIntNative cbMem);
     UInt8* _AllocFromCurBlock(UIntNative cbMem, UIntNative alignment WRITE_ACCESS_HOLDER_ARG);
     bool _CommitFromCurBlock(UIntNative cbMem);
@@ -77,6 +79,12 @@ class AllocHeap
 
     static const UIntNative s_minBlockSize = OS_PAGE_SIZE;
 
+    // Small allocations of heaps without an access manager are carved by each thread out of a chunk of this size,
+    // which the thread takes from the current block under the lock. Allocations larger than a quarter of a chunk
+    // are taken from the block directly, which bounds the space left unused at the end of a chunk.
+    static const UIntNative s_threadChunkSize = OS_PAGE_SIZE;
+    static const UIntNative s_maxThreadChunkAlloc = s_threadChunkSize / 4;
+
     typedef rh::util::MemRange Block;
     typedef DPTR(Block) PTR_Block;
     struct BlockListElem : public Block
@@ -113,6 +121,8 @@ class AllocHeap
 
     Crst                            m_lock;
 
+    UInt32                          m_heapId;       // Identifies the heap the chunk of a thread belongs to
+
     INDEBUG(bool                    m_fIsInit;)
 };
 typedef DPTR(AllocHeap) PTR_AllocHeap;
@@ -63,4 +63,19 @@ LEAF_ENTRY xmmYmmStateSupport, _TEXT
         ret
 LEAF_END xmmYmmStateSupport, _TEXT
 
+;; extern "C" DWORD __stdcall zmmStateSupport();
+LEAF_ENTRY zmmStateSupport, _TEXT
+        mov     ecx, 0                  ; Specify xcr0
+        xgetbv                          ; result in EDX:EAX
+        and eax, 0E6H
+        cmp eax, 0E6H                   ; check OS has enabled XMM, YMM, opmask and ZMM state support
+        jne     zmm_not_supported
+        mov     eax, 1
+        jmp     zmm_done
+    zmm_not_supported:
+        mov     eax, 0
+    zmm_done:
+        ret
+LEAF_END zmmStateSupport, _TEXT
+
         end
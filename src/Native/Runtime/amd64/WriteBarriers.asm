@@ -108,6 +108,14 @@ DEFINE_UNCHECKED_WRITE_BARRIER_CORE macro BASENAME, REFREG
     cmp     REFREG, [g_ephemeral_high]
     jae     &BASENAME&_NoBarrierRequired_&REFREG&
 
+    ;; Generation 0 objects don't need their cards set since every GC scans all of generation 0. g_gen0_low
+    ;; is ~0 unless the precise write barrier is enabled.
+    cmp     rcx, [g_gen0_low]
+    jb      &BASENAME&_CheckCardTable_&REFREG&
+    cmp     rcx, [g_ephemeral_high]
+    jb      &BASENAME&_NoBarrierRequired_&REFREG&
+
+&BASENAME&_CheckCardTable_&REFREG&:
     ;; We have a location on the GC heap being updated with a reference to an ephemeral object so we must
     ;; track this write. The location address is translated into an offset in the card table bitmap. We set
     ;; an entire byte in the card table since it's quicker than messing around with bitmasks and we only write
@@ -276,6 +284,13 @@ LEAF_ENTRY RhpByRefAssignRef, _TEXT
     cmp     rcx, [g_ephemeral_high]
     jae     RhpByRefAssignRef_NotInHeap
 
+    ;; Generation 0 objects don't need their cards set, see above.
+    cmp     rdi, [g_gen0_low]
+    jb      RhpByRefAssignRef_CheckCardTable
+    cmp     rdi, [g_ephemeral_high]
+    jb      RhpByRefAssignRef_NotInHeap
+
+RhpByRefAssignRef_CheckCardTable:
     ;; move current rdi value into rcx and then increment the pointers
     mov     rcx, rdi
     add     rsi, 8h
@@ -268,7 +268,6 @@ $Name
         EXTERN RhpReversePInvokeAttachOrTrapThread2
         EXTERN RhExceptionHandling_FailedAllocation
         EXTERN RhpPublishObject
-        EXTERN RhpCalculateStackTraceWorker
 
 
         EXTERN $G_LOWEST_ADDRESS
@@ -101,7 +101,6 @@ OFFSETOF__Thread__m_alloc_context__alloc_limit      equ OFFSETOF__Thread__m_rgbA
     EXTERN RhpWaitForSuspend2
     EXTERN RhpWaitForGC2
     EXTERN RhpReversePInvokeAttachOrTrapThread2
-    EXTERN RhpCalculateStackTraceWorker
     EXTERN RhThrowHwEx
     EXTERN RhThrowEx
     EXTERN RhRethrow
@@ -111,6 +110,7 @@ OFFSETOF__Thread__m_alloc_context__alloc_limit      equ OFFSETOF__Thread__m_rgbA
     EXTERN g_highest_address
     EXTERN g_ephemeral_low
     EXTERN g_ephemeral_high
+    EXTERN g_gen0_low
     EXTERN g_card_table
 
 
@@ -133,6 +133,19 @@ INVALIDGCVALUE  EQU 0xCCCCCCCD
         cmp     $refReg, x9
         bge     %ft0
 
+        ;; Generation 0 objects don't need their cards set since every GC scans all of generation 0.
+        ;; g_gen0_low is ~0 unless the precise write barrier is enabled.
+        adrp    x9, g_gen0_low
+        ldr     x9, [x9, g_gen0_low]
+        cmp     $destReg, x9
+        blo     %ft1
+
+        adrp    x9, g_ephemeral_high
+        ldr     x9, [x9, g_ephemeral_high]
+        cmp     $destReg, x9
+        blo     %ft0
+
+1
         ;; Set this object's card, if it hasn't already been set.
         adrp    x9, g_card_table
         ldr     x9, [x9, g_card_table]
@@ -89,6 +89,7 @@ GcInfoDecoder::GcInfoDecoder(
             )
             : m_Reader(dac_cast<PTR_CBYTE>(gcInfoToken.Info))
             , m_InstructionOffset(breakOffset)
+            , m_pLiveSlots(NULL)
             , m_IsInterruptible(false)
             , m_ReturnKind(RT_Illegal)
 #ifdef _DEBUG
@@ -344,6 +345,50 @@ GcInfoDecoder::GcInfoDecoder(
     }
 }
 
+GcInfoDecoder::GcInfoDecoder(GcLiveSlotList* pLiveSlots)
+            : m_InstructionOffset(0)
+            , m_pLiveSlots(NULL)
+            , m_StackBaseRegister(pLiveSlots->StackBaseRegister)
+#ifdef _DEBUG
+            , m_Flags(DECODE_GC_LIFETIMES)
+            , m_GcInfoAddress(NULL)
+#endif
+{
+#ifdef FIXED_STACK_PARAMETER_SCRATCH_AREA
+    m_SizeOfStackOutgoingAndScratchArea = pLiveSlots->SizeOfStackOutgoingAndScratchArea;
+#endif
+}
+
+void GcInfoDecoder::RecordLiveSlots(GcLiveSlotList* pLiveSlots)
+{
+    pLiveSlots->NumSlots = 0;
+    pLiveSlots->StackBaseRegister = m_StackBaseRegister;
+#ifdef FIXED_STACK_PARAMETER_SCRATCH_AREA
+    pLiveSlots->SizeOfStackOutgoingAndScratchArea = m_SizeOfStackOutgoingAndScratchArea;
+#else
+    pLiveSlots->SizeOfStackOutgoingAndScratchArea = 0;
+#endif
+    m_pLiveSlots = pLiveSlots;
+}
+
+void GcInfoDecoder::ReportLiveSlots(
+                GcLiveSlotList*     pLiveSlots,
+                PREGDISPLAY         pRD,
+                unsigned            inputFlags,
+                GCEnumCallback      pCallBack,
+                void *              hCallBack
+                )
+{
+    _ASSERTE(pLiveSlots->IsComplete());
+
+    GcInfoDecoder decoder(pLiveSlots);
+    for (UINT32 i = 0; i < pLiveSlots->NumSlots; i++)
+    {
+        GcLiveSlot* pLiveSlot = &pLiveSlots->pSlots[i];
+        decoder.ReportLiveSlotToGC(&pLiveSlot->Desc, pLiveSlot->IsRegister, pRD, pLiveSlot->ReportScratchSlot, inputFlags, pCallBack, hCallBack);
+    }
+}
+
 bool GcInfoDecoder::IsInterruptible()
 {
     _ASSERTE( m_Flags & DECODE_INTERRUPTIBILITY );
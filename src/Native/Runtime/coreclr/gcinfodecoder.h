@@ -475,6 +475,31 @@ private:
     GcSlotDesc* m_pLastSlot;
 };
 
+// A slot found live by EnumerateLiveSlots
+struct GcLiveSlot
+{
+    GcSlotDesc  Desc;
+    bool        IsRegister;
+    bool        ReportScratchSlot;
+};
+
+// The live slots of a method at one code offset, recorded while EnumerateLiveSlots reports them so that
+// ReportLiveSlots can report them again at later GCs without decoding the GC info. Only valid for the
+// flags EnumerateLiveSlots was called with.
+struct GcLiveSlotList
+{
+    GcLiveSlot* pSlots;
+    UINT32      MaxSlots;
+    UINT32      NumSlots;                       // Greater than MaxSlots if the live slots did not fit
+    UINT32      StackBaseRegister;
+    UINT32      SizeOfStackOutgoingAndScratchArea;
+
+    bool IsComplete()
+    {
+        return NumSlots <= MaxSlots;
+    }
+};
+
 class GcInfoDecoder
 {
 public:
@@ -519,6 +544,18 @@ public:
                 void *              hCallBack
                 );
 
+    // Makes EnumerateLiveSlots also record the slots it reports in pLiveSlots
+    void RecordLiveSlots(GcLiveSlotList* pLiveSlots);
+
+    // Reports the slots recorded by an earlier EnumerateLiveSlots
+    static void ReportLiveSlots(
+                GcLiveSlotList*     pLiveSlots,
+                PREGDISPLAY         pRD,
+                unsigned            flags,
+                GCEnumCallback      pCallBack,
+                void *              hCallBack
+                );
+
     // Public for the gc info dumper
     void EnumerateUntrackedSlots(
                 PREGDISPLAY         pRD,
@@ -555,8 +592,12 @@ public:
 
 
 private:
+    // Only sets up what reporting the recorded slots needs
+    GcInfoDecoder(GcLiveSlotList* pLiveSlots);
+
     BitStreamReader m_Reader;
     UINT32  m_InstructionOffset;
+    GcLiveSlotList* m_pLiveSlots;
 
     // Pre-decoded information
     bool    m_IsInterruptible;
@@ -659,8 +700,34 @@ private:
     {
         _ASSERTE(slotIndex < slotDecoder.GetNumSlots());
         const GcSlotDesc* pSlot = slotDecoder.GetSlotDesc(slotIndex);
+        bool isRegister = (slotIndex < slotDecoder.GetNumRegisters());
+
+        if (m_pLiveSlots != NULL)
+        {
+            if (m_pLiveSlots->NumSlots < m_pLiveSlots->MaxSlots)
+            {
+                GcLiveSlot* pLiveSlot = &m_pLiveSlots->pSlots[m_pLiveSlots->NumSlots];
+                pLiveSlot->Desc = *pSlot;
+                pLiveSlot->IsRegister = isRegister;
+                pLiveSlot->ReportScratchSlot = reportScratchSlots;
+            }
+            m_pLiveSlots->NumSlots++;
+        }
+
+        ReportLiveSlotToGC(pSlot, isRegister, pRD, reportScratchSlots, inputFlags, pCallBack, hCallBack);
+    }
 
-        if(slotIndex < slotDecoder.GetNumRegisters())
+    inline void ReportLiveSlotToGC(
+                    const GcSlotDesc*   pSlot,
+                    bool                isRegister,
+                    PREGDISPLAY         pRD,
+                    bool                reportScratchSlots,
+                    unsigned            inputFlags,
+                    GCEnumCallback      pCallBack,
+                    void *              hCallBack
+                    )
+    {
+        if(isRegister)
         {
             UINT32 regNum = pSlot->Slot.RegisterNumber;
             if( reportScratchSlots || !IsScratchRegister( regNum, pRD ) )
@@ -29,6 +29,11 @@ extern "C" uint32_t* g_card_bundle_table;
 extern "C" uint8_t* g_ephemeral_low;
 extern "C" uint8_t* g_ephemeral_high;
 
+// Start of generation 0 for the precise write barrier: stores into objects between g_gen0_low and
+// g_ephemeral_high don't mark cards. This is ~0 (nothing is skipped) unless the PreciseWriteBarrier runtime
+// configuration value is set and the GC has a single ephemeral segment.
+extern "C" uint8_t* g_gen0_low;
+
 // g_gc_dac_vars is a structure of pointers to GC globals that the
 // DAC uses. It is not exposed directly to the DAC.
 extern GcDacVars g_gc_dac_vars;
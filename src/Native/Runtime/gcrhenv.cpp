@@ -49,6 +49,9 @@
 
 #include "holder.h"
 #include "volatile.h"
+#include "AllocationSampling.h"
+#include "EventSession.h"
+#include "HeapSnapshot.h"
 
 #ifdef FEATURE_ETW
     #ifndef _INC_WINDOWS
@@ -74,11 +77,13 @@ GPTR_IMPL(EEType, g_pFreeObjectEEType);
 #include "DebuggerHook.h"
 
 #include "gctoclreventsink.h"
+#include "IntrinsicConstants.h"
 
 #ifndef DACCESS_COMPILE
 
 bool RhInitializeFinalization();
 bool RhStartFinalizerThread();
+void RhEnsureFinalizerThreadStarted();
 void RhEnableFinalization();
 
 // Simplified EEConfig -- It is just a static member, which statically initializes to the default values and
@@ -210,9 +215,15 @@ bool RedhawkGCInterface::InitializeSubsystems()
     if (FAILED(hr))
         return false;
 
+    s_cbLargeObjectThreshold = g_pGCHeap->GetLOHThreshold();
+
+    STARTUP_TIMELINE_EVENT(GC_HEAP_INIT_COMPLETE);
+
     if (!RhInitializeFinalization())
         return false;
 
+    STARTUP_TIMELINE_EVENT(FINALIZATION_INIT_COMPLETE);
+
     // Initialize HandleTable.
     if (!GCHandleUtilities::GetGCHandleManager()->Initialize())
         return false;
@@ -236,6 +247,14 @@ COOP_PINVOKE_HELPER(void*, RhpGcAlloc, (EEType *pEEType, UInt32 uFlags, UIntNati
 
     ASSERT(!pThread->IsDoNotTriggerGcSet());
 
+    // Allocation contexts start out empty, so the first allocation of the process ends up here
+    static bool s_fFirstAllocationRecorded = false;
+    if (!s_fFirstAllocationRecorded)
+    {
+        s_fFirstAllocationRecorded = true;
+        STARTUP_TIMELINE_EVENT(FIRST_ALLOCATION_REFILL);
+    }
+
     size_t max_object_size;
 #ifdef HOST_64BIT
     if (g_pConfig->GetGCAllowVeryLargeObjects())
@@ -280,13 +299,42 @@ COOP_PINVOKE_HELPER(void*, RhpGcAlloc, (EEType *pEEType, UInt32 uFlags, UIntNati
         }
     }
 
-    if (cbSize > RH_LARGE_OBJECT_SIZE)
+    if (RedhawkGCInterface::IsLargeObjectSize(cbSize))
         uFlags |= GC_ALLOC_LARGE_OBJECT_HEAP;
 
+    // Finalizable objects always take this path, so this is where a deferred finalizer thread gets started.
+    if (uFlags & GC_ALLOC_FINALIZE)
+        RhEnsureFinalizerThreadStarted();
+
     // Save the EEType for instrumentation purposes.
     RedhawkGCInterface::SetLastAllocEEType(pEEType);
 
-    Object * pObject = GCHeapUtilities::GetGCHeap()->Alloc(pThread->GetAllocContext(), cbSize, uFlags);
+    gc_alloc_context * pAllocContext = pThread->GetAllocContext();
+
+    // If this allocation is going to refill the allocation context let the GC know how busy this thread is.
+    if (((uFlags & GC_ALLOC_LARGE_OBJECT_HEAP) == 0) &&
+        ((size_t)(pAllocContext->alloc_limit - pAllocContext->alloc_ptr) < cbSize))
+    {
+        RedhawkGCInterface::TuneAllocContextQuantum(pAllocContext);
+    }
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOC_TRACE))
+    {
+        // The part of the allocation context past alloc_ptr is counted in alloc_bytes but not used yet
+        EventSessionAllocationTrace trace;
+        trace.AllocatedBytes = (UInt64)(pAllocContext->alloc_bytes - (pAllocContext->alloc_limit - pAllocContext->alloc_ptr));
+        trace.Size = cbSize;
+        trace.Flags = uFlags;
+        trace.Padding = 0;
+        WriteEventSessionEvent(EventSessionEvent_AllocationTrace, &trace, sizeof(trace));
+    }
+
+    pThread->BeginAllocContextUpdate();
+    Object * pObject = GCHeapUtilities::GetGCHeap()->Alloc(pAllocContext, cbSize, uFlags);
+    pThread->EndAllocContextUpdate();
+
+    if (g_fAllocationSamplingEnabled && (pObject != NULL))
+        SampleAllocation(pThread, pEEType, cbSize, pTransitionFrame);
 
     // NOTE: we cannot call PublishObject here because the object isn't initialized!
 
@@ -296,9 +344,12 @@ COOP_PINVOKE_HELPER(void*, RhpGcAlloc, (EEType *pEEType, UInt32 uFlags, UIntNati
 // returns the object pointer for caller's convenience
 COOP_PINVOKE_HELPER(void*, RhpPublishObject, (void* pObject, UIntNative cbSize))
 {
-    UNREFERENCED_PARAMETER(cbSize);
     ASSERT(cbSize >= LARGE_OBJECT_SIZE);
-    GCHeapUtilities::GetGCHeap()->PublishObject((uint8_t*)pObject);
+
+    // The allocation helpers publish everything of at least RH_LARGE_OBJECT_SIZE bytes, with a raised
+    // threshold some of those objects are on the small object heap and there is nothing to publish.
+    if (RedhawkGCInterface::IsLargeObjectSize(cbSize))
+        GCHeapUtilities::GetGCHeap()->PublishObject((uint8_t*)pObject);
     return pObject;
 }
 
@@ -344,6 +395,7 @@ void EEType::InitializeAsGcFreeType()
 extern void GcEnumObject(PTR_OBJECTREF pObj, UInt32 flags, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc);
 extern void GcEnumObjectsConservatively(PTR_OBJECTREF pLowerBound, PTR_OBJECTREF pUpperBound, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc);
 extern void GcBulkEnumObjects(PTR_OBJECTREF pObjs, DWORD cObjs, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc);
+extern void GcBulkEnumEphemeralObjects(PTR_OBJECTREF pObjs, DWORD cObjs, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc);
 
 struct EnumGcRefContext : GCEnumContext
 {
@@ -560,6 +612,12 @@ void RedhawkGCInterface::BulkEnumGcObjRef(PTR_RtuObjectRef pRefs, UInt32 cRefs,
     GcBulkEnumObjects((PTR_OBJECTREF)pRefs, cRefs, (EnumGcRefCallbackFunc *)pfnEnumCallback, (EnumGcRefScanContext *)pvCallbackData);
 }
 
+// static 
+void RedhawkGCInterface::BulkEnumEphemeralGcObjRef(PTR_RtuObjectRef pRefs, UInt32 cRefs, void * pfnEnumCallback, void * pvCallbackData)
+{
+    GcBulkEnumEphemeralObjects((PTR_OBJECTREF)pRefs, cRefs, (EnumGcRefCallbackFunc *)pfnEnumCallback, (EnumGcRefScanContext *)pvCallbackData);
+}
+
 // static 
 GcSegmentHandle RedhawkGCInterface::RegisterFrozenSegment(void * pSection, size_t SizeSection)
 {
@@ -584,6 +642,46 @@ void RedhawkGCInterface::UnregisterFrozenSegment(GcSegmentHandle segment)
     GCHeapUtilities::GetGCHeap()->UnregisterFrozenSegment((segment_handle)segment);
 }
 
+// static
+void RedhawkGCInterface::EnumGcRefsInFrozenObjects(void * pSection, size_t SizeSection, void * pfnEnumCallback, void * pvCallbackData,
+                                                   bool fYoungRefsOnly)
+{
+    // The section has the layout of a frozen segment: objects (each preceded by its ObjHeader) aligned to the
+    // pointer size, terminated by a null EEType pointer.
+    PTR_UInt8 pCurrent = (PTR_UInt8)pSection + sizeof(ObjHeader);
+    PTR_UInt8 pEnd = (PTR_UInt8)pSection + SizeSection;
+
+    while (pCurrent < pEnd)
+    {
+        Object * pObject = (Object *)pCurrent;
+        MethodTable * pMT = pObject->RawGetMethodTable();
+        if (pMT == NULL)
+            break;
+
+        if (pMT->ContainsPointersOrCollectible())
+        {
+            CGCDesc * map = CGCDesc::GetCGCDescFromMT(pMT);
+            CGCDescSeries * cur = map->GetHighestSeries();
+            CGCDescSeries * last = map->GetLowestSeries();
+
+            ASSERT(cur >= last);
+            do
+            {
+                PTR_RtuObjectRef pRefs = (PTR_RtuObjectRef)(pCurrent + cur->GetSeriesOffset());
+                size_t cbSeries = cur->GetSeriesSize() + pObject->GetSize();
+                if (fYoungRefsOnly)
+                    BulkEnumEphemeralGcObjRef(pRefs, (UInt32)(cbSeries / sizeof(void *)), pfnEnumCallback, pvCallbackData);
+                else
+                    BulkEnumGcObjRef(pRefs, (UInt32)(cbSeries / sizeof(void *)), pfnEnumCallback, pvCallbackData);
+                cur--;
+            }
+            while (cur >= last);
+        }
+
+        pCurrent += ALIGN_UP(pObject->GetSize(), sizeof(void *));
+    }
+}
+
 EXTERN_C UInt32_BOOL g_fGcStressStarted = UInt32_FALSE; // UInt32_BOOL because asm code reads it
 #ifdef FEATURE_GC_STRESS
 // static 
@@ -595,7 +693,10 @@ void RedhawkGCInterface::StressGc()
 
     if (g_fGcStressStarted && !ThreadStore::GetCurrentThread()->IsSuppressGcStressSet() && !ThreadStore::GetCurrentThread()->IsDoNotTriggerGcSet())
     {
-        GCHeapUtilities::GetGCHeap()->GarbageCollect();
+        // Ephemeral GCs still find the references the code fails to report for the youngest objects, which are
+        // most of the ones a GC hole ends up pointing to, at a fraction of the cost of a full GC
+        int generation = g_pRhConfig->GetGcStressEphemeralOnly() ? 1 : -1;
+        GCHeapUtilities::GetGCHeap()->GarbageCollect(generation);
     }
 
     // Restore the saved error
@@ -719,6 +820,11 @@ UInt32 RedhawkGCInterface::GetGCDescSize(void * pType)
     return (UInt32)CGCDesc::GetCGCDescFromMT(pMT)->GetSize();
 }
 
+// Objects up to this size are copied and compared a pointer sized word at a time rather than by calling
+// memcpy and memcmp. Boxed value types and small classes are well below it, and the sizes of objects are
+// always a multiple of the pointer size.
+#define SMALL_OBJECT_CONTENTS_SIZE 64
+
 COOP_PINVOKE_HELPER(void, RhpCopyObjectContents, (Object* pobjDest, Object* pobjSrc))
 {
     size_t cbDest = pobjDest->GetSize() - sizeof(ObjHeader);
@@ -732,6 +838,15 @@ COOP_PINVOKE_HELPER(void, RhpCopyObjectContents, (Object* pobjDest, Object* pobj
     {
         GCSafeCopyMemoryWithWriteBarrier(pobjDest, pobjSrc, cbDest);
     }
+    else if (cbDest <= SMALL_OBJECT_CONTENTS_SIZE)
+    {
+        ASSERT(cbDest % sizeof(UIntNative) == 0);
+
+        UIntNative * pDest = (UIntNative *)pobjDest;
+        UIntNative * pSrc = (UIntNative *)pobjSrc;
+        for (size_t i = 0; i < cbDest / sizeof(UIntNative); i++)
+            pDest[i] = pSrc[i];
+    }
     else
     {
         memcpy(pobjDest, pobjSrc, cbDest);
@@ -747,6 +862,20 @@ COOP_PINVOKE_HELPER(Boolean, RhCompareObjectContentsAndPadding, (Object* pObj1,
     UInt8 * pbFields1 = (UInt8*)pObj1 + sizeof(EEType*);
     UInt8 * pbFields2 = (UInt8*)pObj2 + sizeof(EEType*);
 
+    if (cbFields <= SMALL_OBJECT_CONTENTS_SIZE)
+    {
+        ASSERT(cbFields % sizeof(UIntNative) == 0);
+
+        // Without early exits, the loop is short and the compiler can unroll it
+        UIntNative * pFields1 = (UIntNative *)pbFields1;
+        UIntNative * pFields2 = (UIntNative *)pbFields2;
+        UIntNative difference = 0;
+        for (size_t i = 0; i < cbFields / sizeof(UIntNative); i++)
+            difference |= pFields1[i] ^ pFields2[i];
+
+        return (difference == 0) ? Boolean_true : Boolean_false;
+    }
+
     return (memcmp(pbFields1, pbFields2, cbFields) == 0) ? Boolean_true : Boolean_false;
 }
 
@@ -767,8 +896,50 @@ void RedhawkGCInterface::SetLastAllocEEType(EEType * pEEType)
     tls_pLastAllocationEEType = pEEType;
 }
 
+DECLSPEC_THREAD
+UInt32 RedhawkGCInterface::tls_uAllocQuantumGcCount = 0;
+
+DECLSPEC_THREAD
+UInt32 RedhawkGCInterface::tls_cAllocContextRefills = 0;
+
+// Refills of an allocation context within a single gen0 cycle after which its quantum is doubled.
+#define HOT_ALLOC_CONTEXT_REFILLS   16
+
+// Bounds on the quantum scaling we ask for (the GC applies its own limits as well).
+#define MAX_ALLOC_QUANTUM_SHIFT     3
+#define MIN_ALLOC_QUANTUM_SHIFT     -2
+
+// Called when the current thread's allocation context is about to be refilled. Threads that refill often
+// between gen0 collections get a progressively larger allocation quantum, reducing the number of trips
+// through the allocation slow path. Threads that refilled at most once during the last cycle get a
+// progressively smaller one so that mostly idle threads don't hold on to large unused portions of gen0.
+void RedhawkGCInterface::TuneAllocContextQuantum(gc_alloc_context * pAllocContext)
+{
+    UInt32 uGcCount = (UInt32)GCHeapUtilities::GetGCHeap()->CollectionCount(0);
+    int shift = pAllocContext->alloc_quantum_shift;
+
+    if (uGcCount != tls_uAllocQuantumGcCount)
+    {
+        if ((tls_cAllocContextRefills <= 1) && (shift > MIN_ALLOC_QUANTUM_SHIFT))
+            shift--;
+
+        tls_uAllocQuantumGcCount = uGcCount;
+        tls_cAllocContextRefills = 0;
+    }
+
+    if ((++tls_cAllocContextRefills >= HOT_ALLOC_CONTEXT_REFILLS) && (shift < MAX_ALLOC_QUANTUM_SHIFT))
+    {
+        shift++;
+        tls_cAllocContextRefills = 0;
+    }
+
+    pAllocContext->alloc_quantum_shift = shift;
+}
+
 uint64_t RedhawkGCInterface::s_DeadThreadsNonAllocBytes = 0;
 
+size_t RedhawkGCInterface::s_cbLargeObjectThreshold = RH_LARGE_OBJECT_SIZE;
+
 uint64_t RedhawkGCInterface::GetDeadThreadsNonAllocBytes()
 {
 #ifdef HOST_64BIT
@@ -801,6 +972,15 @@ void GCToEEInterface::SuspendEE(SUSPEND_REASON reason)
 
     FireEtwGCSuspendEEBegin_V1(Info.SuspendEE.Reason, Info.SuspendEE.GcCount, GetClrInstanceId());
 
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_SUSPENSION))
+    {
+        EventSessionSuspendEE payload;
+        payload.Reason = reason;
+        payload.GcCount = (((reason == SUSPEND_FOR_GC) || (reason == SUSPEND_FOR_GC_PREP)) ?
+            (UInt32)GCHeapUtilities::GetGCHeap()->GetGcCount() : (UInt32)-1);
+        WriteEventSessionEvent(EventSessionEvent_SuspendEEBegin, &payload, sizeof(payload));
+    }
+
     g_SuspendEELock.Enter();
 
     GCHeapUtilities::GetGCHeap()->SetGCInProgress(TRUE);
@@ -809,6 +989,9 @@ void GCToEEInterface::SuspendEE(SUSPEND_REASON reason)
 
     FireEtwGCSuspendEEEnd_V1(GetClrInstanceId());
 
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_SUSPENSION))
+        WriteEventSessionEvent(EventSessionEvent_SuspendEEEnd, NULL, 0);
+
 #ifdef APP_LOCAL_RUNTIME
     // now is a good opportunity to retry starting the finalizer thread
     RhStartFinalizerThread();
@@ -819,6 +1002,9 @@ void GCToEEInterface::RestartEE(bool /*bFinishedGC*/)
 {
     FireEtwGCRestartEEBegin_V1(GetClrInstanceId());
 
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_SUSPENSION))
+        WriteEventSessionEvent(EventSessionEvent_RestartEEBegin, NULL, 0);
+
     SyncClean::CleanUp();
 
     GetThreadStore()->ResumeAllThreads(true);
@@ -827,6 +1013,9 @@ void GCToEEInterface::RestartEE(bool /*bFinishedGC*/)
     g_SuspendEELock.Leave();
 
     FireEtwGCRestartEEEnd_V1(GetClrInstanceId());
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_SUSPENSION))
+        WriteEventSessionEvent(EventSessionEvent_RestartEEEnd, NULL, 0);
 }
 
 void GCToEEInterface::GcStartWork(int condemned, int /*max_gen*/)
@@ -859,6 +1048,11 @@ bool GCToEEInterface::RefCountedHandleCallbacks(Object * pObject)
     return RestrictedCallouts::InvokeRefCountedHandleCallbacks(pObject);
 }
 
+size_t GCToEEInterface::RefCountedHandleCallbacksForBatch(Object ** rgpObjects, size_t cObjects)
+{
+    return RestrictedCallouts::InvokeRefCountedHandleCallbacks(rgpObjects, cObjects);
+}
+
 void GCToEEInterface::SyncBlockCacheWeakPtrScan(HANDLESCANPROC /*scanProc*/, uintptr_t /*lp1*/, uintptr_t /*lp2*/)
 {
 }
@@ -1043,6 +1237,7 @@ void GCProfileWalkHeapWorker(BOOL fShouldWalkHeapRootsForEtw, BOOL fShouldWalkHe
 
 void GCProfileWalkHeap()
 {
+    WriteHeapSnapshotIfRequested();
 
 #ifdef FEATURE_EVENT_TRACE
     if (ETW::GCLog::ShouldWalkStaticsAndCOMForEtw())
@@ -1110,6 +1305,25 @@ void WalkMovedReferences(uint8_t* begin, uint8_t* end,
     UNREFERENCED_PARAMETER(fBGC);
 }
 
+static void WalkObjectRangesForEventSession(uint8_t* begin, uint8_t* end,
+                                            ptrdiff_t reloc,
+                                            void* context,
+                                            bool fCompacting,
+                                            bool /*fBGC*/)
+{
+    RecordEventSessionObjectRange((EventSessionRangeBuffer*)context, begin, end, reloc, fCompacting);
+}
+
+static void WalkSurvivorsForEventSession(void* gcContext, walk_surv_type type, int gen)
+{
+    EventSessionRangeBuffer* pBuffer = GetEventSessionRangeBuffer(gcContext);
+    if (pBuffer == NULL)
+        return;
+
+    GCHeapUtilities::GetGCHeap()->DiagWalkSurvivorsWithType(gcContext, &WalkObjectRangesForEventSession, pBuffer, type, gen);
+    FlushEventSessionObjectRanges(pBuffer);
+}
+
 //
 // Diagnostics code
 //
@@ -1135,9 +1349,10 @@ void GCToEEInterface::DiagWalkSurvivors(void* gcContext, bool fCompacting)
         GCHeapUtilities::GetGCHeap()->DiagWalkSurvivorsWithType(gcContext, &WalkMovedReferences, (void*)context, walk_for_gc);
         ETW::GCLog::EndMovedReferences(context);
     }
-#else
-    UNREFERENCED_PARAMETER(gcContext);
 #endif // FEATURE_EVENT_TRACE
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_GC_SURVIVAL))
+        WalkSurvivorsForEventSession(gcContext, walk_for_gc, -1);
 }
 
 void GCToEEInterface::DiagWalkUOHSurvivors(void* gcContext, int gen)
@@ -1150,9 +1365,10 @@ void GCToEEInterface::DiagWalkUOHSurvivors(void* gcContext, int gen)
         GCHeapUtilities::GetGCHeap()->DiagWalkSurvivorsWithType(gcContext, &WalkMovedReferences, (void*)context, walk_for_uoh, gen);
         ETW::GCLog::EndMovedReferences(context);
     }
-#else
-    UNREFERENCED_PARAMETER(gcContext);
 #endif // FEATURE_EVENT_TRACE
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_GC_SURVIVAL))
+        WalkSurvivorsForEventSession(gcContext, walk_for_uoh, gen);
 }
 
 void GCToEEInterface::DiagWalkBGCSurvivors(void* gcContext)
@@ -1170,6 +1386,18 @@ void GCToEEInterface::DiagWalkBGCSurvivors(void* gcContext)
 #endif // FEATURE_EVENT_TRACE
 }
 
+// The write barriers skip the card of a store into an object between g_gen0_low and g_ephemeral_high. Such
+// objects are in generation 0, which every GC scans in full, so their cards are never needed. Otherwise the
+// stores between young objects leave cards set that the following GCs have to scan once the objects are
+// promoted. The GC itself sets the cards that the promoted objects need (see check_demotion_helper).
+static void SetWriteBarrierGen0Low(uint8_t* gen0_low)
+{
+    if ((gen0_low == nullptr) || !g_pRhConfig->GetPreciseWriteBarrier())
+        gen0_low = (uint8_t*)~0;
+
+    g_gen0_low = gen0_low;
+}
+
 void GCToEEInterface::StompWriteBarrier(WriteBarrierParameters* args)
 {
     // CoreRT doesn't patch the write barrier like CoreCLR does, but it
@@ -1232,6 +1460,7 @@ void GCToEEInterface::StompWriteBarrier(WriteBarrierParameters* args)
         assert(args->ephemeral_high != nullptr);
         g_ephemeral_low = args->ephemeral_low;
         g_ephemeral_high = args->ephemeral_high;
+        SetWriteBarrierGen0Low(args->gen0_low);
         return;
     case WriteBarrierOp::Initialize:
         // This operation should only be invoked once, upon initialization.
@@ -1256,6 +1485,7 @@ void GCToEEInterface::StompWriteBarrier(WriteBarrierParameters* args)
         g_highest_address = args->highest_address;
         g_ephemeral_low = args->ephemeral_low;
         g_ephemeral_high = args->ephemeral_high;
+        SetWriteBarrierGen0Low(args->gen0_low);
         return;
     case WriteBarrierOp::SwitchToWriteWatch:
     case WriteBarrierOp::SwitchToNonWriteWatch:
@@ -1281,8 +1511,9 @@ void GCToEEInterface::HandleFatalError(unsigned int exitCode)
 
 bool GCToEEInterface::EagerFinalized(Object* obj)
 {
-    UNREFERENCED_PARAMETER(obj);
-    return false;
+    // Give the classlib a chance to finalize objects of registered types (e.g. weak reference wrappers) right
+    // away instead of queueing them for the finalizer thread.
+    return RestrictedCallouts::InvokeEagerFinalizers(obj);
 }
 
 bool GCToEEInterface::IsGCThread()
@@ -1409,6 +1640,23 @@ void GCToEEInterface::UpdateGCEventStatus(int currentPublicLevel, int currentPub
     // TODO: Linux LTTng
 }
 
+uint32_t GCToEEInterface::GetSupportedInstructionSets()
+{
+    uint32_t instructionSets = 0;
+#if defined(HOST_AMD64) && !defined(USE_PORTABLE_HELPERS)
+    if ((g_cpuFeatures & XArchIntrinsicConstants_Avx2) != 0)
+        instructionSets |= GCInstructionSet_Avx2;
+    if ((g_cpuFeatures & XArchIntrinsicConstants_Avx512f) != 0)
+        instructionSets |= GCInstructionSet_Avx512F;
+#endif // HOST_AMD64 && !USE_PORTABLE_HELPERS
+    return instructionSets;
+}
+
+void GCToEEInterface::FullGCApproaching(int generation)
+{
+    RestrictedCallouts::InvokeGcCallouts(GCRC_FullGCApproach, generation);
+}
+
 MethodTable* GCToEEInterface::GetFreeObjectMethodTable()
 {
     assert(g_pFreeObjectEEType != nullptr);
@@ -1430,12 +1678,51 @@ bool GCToEEInterface::GetBooleanConfigValue(const char* privateKey, const char*
         return true;
     }
 
+    if (strcmp(privateKey, "GCReleaseFreeSpace") == 0)
+    {
+        *value = g_pRhConfig->GetGcReleaseFreeSpace() != 0;
+        return true;
+    }
+
+    if (strcmp(privateKey, "GCBackgroundDecommit") == 0)
+    {
+        *value = g_pRhConfig->GetGcBackgroundDecommit() != 0;
+        return true;
+    }
+
+    if (strcmp(privateKey, "GCTypeStats") == 0)
+    {
+        *value = g_pRhConfig->GetGcTypeStats() != 0;
+        return true;
+    }
+
+    if (strcmp(privateKey, "GCDynamicHeapCount") == 0)
+    {
+        *value = g_pRhConfig->GetGcDynamicHeapCount() != 0;
+        return true;
+    }
+
+    if (strcmp(privateKey, "GCLargePages") == 0)
+    {
+        *value = g_pRhConfig->GetGcLargePages() != 0;
+        return true;
+    }
+
     if (strcmp(privateKey, "gcConservative") == 0)
     {
         *value = g_pConfig->GetGCConservative();
         return true;
     }
 
+    // the rest can be baked into the executable by the compiler
+    UInt64 uiValue;
+    bool fIsBoolean;
+    if (g_pRhConfig->GetEmbeddedGCConfigValue(privateKey, &uiValue, &fIsBoolean))
+    {
+        *value = uiValue != 0;
+        return true;
+    }
+
     return false;
 }
 
@@ -1447,6 +1734,39 @@ bool GCToEEInterface::GetIntConfigValue(const char* privateKey, const char* publ
         return true;
     }
 
+    if (strcmp(privateKey, "GCConserveMemory") == 0)
+    {
+        *value = g_pRhConfig->GetGcConserveMemory();
+        return true;
+    }
+
+    if (strcmp(privateKey, "GCPauseTarget") == 0)
+    {
+        *value = g_pRhConfig->GetGcPauseTarget();
+        return true;
+    }
+
+    if (strcmp(privateKey, "GCIdleCollectPercent") == 0)
+    {
+        *value = g_pRhConfig->GetGcIdleCollectPercent();
+        return true;
+    }
+
+    if ((strcmp(privateKey, "GCLOHThreshold") == 0) && (g_pRhConfig->GetGcLOHThreshold() != 0))
+    {
+        *value = g_pRhConfig->GetGcLOHThreshold();
+        return true;
+    }
+
+    // the rest can be baked into the executable by the compiler
+    UInt64 uiValue;
+    bool fIsBoolean;
+    if (g_pRhConfig->GetEmbeddedGCConfigValue(privateKey, &uiValue, &fIsBoolean) && !fIsBoolean)
+    {
+        *value = (int64_t)uiValue;
+        return true;
+    }
+
     if (strcmp(privateKey, "GCgen0size") == 0)
     {
 #if defined(USE_PORTABLE_HELPERS) && !defined(HOST_WASM)
@@ -1489,6 +1809,28 @@ GPTR_IMPL(Thread, g_pGcThread);
 
 #ifndef DACCESS_COMPILE
 
+// Reads how much of the alloc context of this thread, which may be running, is not used yet. Fails if the
+// thread is refilling its context meanwhile. The bump allocation helpers only move alloc_ptr towards
+// alloc_limit, so reading alloc_ptr first gives a value no larger than the limit. Like GetAllocContext, this
+// is here for the layout of alloc_context.
+bool Thread::TryGetUnusedAllocContextBytes(UIntNative * pcbUnused)
+{
+    gc_alloc_context * pAllocContext = GetAllocContext();
+
+    UInt32 uEpoch = m_uAllocContextEpoch;
+    PalMemoryBarrier();
+    UInt8 * pAllocPtr = pAllocContext->alloc_ptr;
+    UInt8 * pAllocLimit = pAllocContext->alloc_limit;
+    PalMemoryBarrier();
+
+    if (((uEpoch & 1) != 0) || (uEpoch != m_uAllocContextEpoch))
+        return false;
+
+    *pcbUnused = (UIntNative)(pAllocLimit - pAllocPtr);
+    return true;
+}
+
+
 bool __SwitchToThread(uint32_t dwSleepMSec, uint32_t /*dwSwitchCount*/)
 {
     if (dwSleepMSec > 0)
@@ -21,6 +21,7 @@
 // Global data cells exported by the GC.
 extern "C" unsigned char *g_ephemeral_low;
 extern "C" unsigned char *g_ephemeral_high;
+extern "C" unsigned char *g_gen0_low;
 extern "C" unsigned char *g_lowest_address;
 extern "C" unsigned char *g_highest_address;
 #endif
@@ -116,6 +117,9 @@ public:
 
     static void BulkEnumGcObjRef(PTR_RtuObjectRef pRefs, UInt32 cRefs, void * pfnEnumCallback, void * pvCallbackData);
 
+    // Like BulkEnumGcObjRef, but skips references to objects outside the ephemeral range.
+    static void BulkEnumEphemeralGcObjRef(PTR_RtuObjectRef pRefs, UInt32 cRefs, void * pfnEnumCallback, void * pvCallbackData);
+
     static void EnumGcRefs(ICodeManager * pCodeManager,
                            MethodInfo * pMethodInfo, 
                            PTR_VOID safePointAddress,
@@ -131,6 +135,12 @@ public:
     static GcSegmentHandle RegisterFrozenSegment(void * pSection, size_t SizeSection);
     static void UnregisterFrozenSegment(GcSegmentHandle segment);
 
+    // Reports the reference fields of every object in a section laid out like a frozen segment. Used for
+    // sections whose objects are mutable but live outside the range covered by the card table. With
+    // fYoungRefsOnly only the references to objects in the ephemeral range are reported.
+    static void EnumGcRefsInFrozenObjects(void * pSection, size_t SizeSection, void * pfnEnumCallback, void * pvCallbackData,
+                                          bool fYoungRefsOnly);
+
 #ifdef FEATURE_GC_STRESS
     static void StressGc();
 #endif // FEATURE_GC_STRESS
@@ -149,8 +159,17 @@ public:
     static EEType * GetLastAllocEEType();
     static void SetLastAllocEEType(EEType *pEEType);
 
+    static void TuneAllocContextQuantum(gc_alloc_context * pAllocContext);
+
     static uint64_t GetDeadThreadsNonAllocBytes();
 
+    // Whether an object of cbSize bytes has to be allocated on the large object heap. The threshold is the
+    // GC's, it is RH_LARGE_OBJECT_SIZE unless GcLOHThreshold raised it.
+    static bool IsLargeObjectSize(size_t cbSize)
+    {
+        return cbSize >= s_cbLargeObjectThreshold;
+    }
+
     // Used by debugger hook
     static void* CreateTypedHandle(void* object, int type);
     static void DestroyTypedHandle(void* handle);
@@ -161,9 +180,16 @@ private:
     // race conditions where ETW is enabled after the value is set.
     DECLSPEC_THREAD static EEType * tls_pLastAllocationEEType;
 
+    // The gen0 collection count at which this thread last adjusted its allocation quantum and the number of
+    // times its allocation context has been refilled since then.
+    DECLSPEC_THREAD static UInt32 tls_uAllocQuantumGcCount;
+    DECLSPEC_THREAD static UInt32 tls_cAllocContextRefills;
+
     // Tracks the amount of bytes that were reserved for threads in their gc_alloc_context and went unused when they died.
     // Used for GC.GetTotalAllocatedBytes
     static uint64_t s_DeadThreadsNonAllocBytes;
+
+    static size_t s_cbLargeObjectThreshold;
 };
 
 #endif // __GCRHINTERFACE_INCLUDED
@@ -28,22 +28,40 @@
 #include "thread.inl"
 
 #include "DebuggerHook.h"
+#include "RhConfig.h"
 
 #ifndef DACCESS_COMPILE
 
 void GcEnumObjectsConservatively(PTR_PTR_Object ppLowerBound, PTR_PTR_Object ppUpperBound, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc);
 
-void EnumAllStaticGCRefs(EnumGcRefCallbackFunc * fn, EnumGcRefScanContext * sc)
+void EnumAllStaticGCRefs(EnumGcRefCallbackFunc * fn, EnumGcRefScanContext * sc, bool fYoungRefsOnly)
 {
-    GetRuntimeInstance()->EnumAllStaticGCRefs(reinterpret_cast<void*>(fn), sc);
+    GetRuntimeInstance()->EnumAllStaticGCRefs(reinterpret_cast<void*>(fn), sc, fYoungRefsOnly);
 }
 
+// Number of calls to GcScanRoots made while parallel stack scanning was enabled. Every phase of a server GC
+// that scans roots does so from all of its GC threads at once (one call per heap), and phases never overlap,
+// so dividing this count by the number of heaps yields a scan round number all GC threads in the current
+// phase agree on.
+static Int32 volatile s_cParallelStackScanCalls = 0;
+
 /*
  * Scan all stack and statics roots
  */
  
 void GCToEEInterface::GcScanRoots(EnumGcRefCallbackFunc * fn,  int condemned, int max_gen, EnumGcRefScanContext * sc)
 {
+    // By default each server GC thread scans the threads allocating from its heap, which leaves the GC threads
+    // waiting on whichever heap has the most (or deepest) stacks. In parallel mode the GC threads instead
+    // claim threads on a first come, first served basis so the stack walks are spread evenly.
+    UInt32 uScanRound = 0;
+    bool fParallelScan = GCHeapUtilities::IsServerHeap() && (g_pRhConfig->GetGcParallelStackScan() != 0);
+    if (fParallelScan)
+    {
+        UInt32 cHeaps = (UInt32)GCHeapUtilities::GetGCHeap()->GetNumberOfHeaps();
+        uScanRound = ((UInt32)PalInterlockedIncrement(&s_cParallelStackScanCalls) - 1) / cHeaps + 1;
+    }
+
     DebuggerProtectedBufferListNode* cursor = DebuggerHook::s_debuggerProtectedBuffers;
     while (cursor != nullptr)
     {
@@ -59,18 +77,24 @@ void GCToEEInterface::GcScanRoots(EnumGcRefCallbackFunc * fn,  int condemned, in
         if (pThread->IsGCSpecial())
             continue;
 
+        if (fParallelScan)
+        {
+            if (!pThread->TryClaimForGcScan(uScanRound))
+                continue;
+        }
 #if !defined (ISOLATED_HEAPS)
         // @TODO: it is very bizarre that this IsThreadUsingAllocationContextHeap takes a copy of the
         // allocation context instead of a reference or a pointer to it. This seems very wasteful given how
         // large the alloc_context is.
-        if (!GCHeapUtilities::GetGCHeap()->IsThreadUsingAllocationContextHeap(pThread->GetAllocContext(), 
+        else if (!GCHeapUtilities::GetGCHeap()->IsThreadUsingAllocationContextHeap(pThread->GetAllocContext(), 
                                                                      sc->thread_number))
         {
             // STRESS_LOG2(LF_GC|LF_GCROOTS, LL_INFO100, "{ Scan of Thread %p (ID = %x) declined by this heap\n", 
             //             pThread, pThread->GetThreadId());
+            continue;
         }
-        else
 #endif
+
         {
             STRESS_LOG1(LF_GC|LF_GCROOTS, LL_INFO100, "{ Starting scan of Thread %p\n", pThread);
             sc->thread_under_crawl = pThread;
@@ -94,7 +118,11 @@ void GCToEEInterface::GcScanRoots(EnumGcRefCallbackFunc * fn,  int condemned, in
 #if defined(FEATURE_EVENT_TRACE) && !defined(DACCESS_COMPILE)
         sc->dwEtwRootKind = kEtwGCRootKindHandle;
 #endif 
-        EnumAllStaticGCRefs(fn, sc);
+        // While marking for an ephemeral GC, references to objects outside the ephemeral generations can't
+        // keep anything condemned alive. The relocate phase still needs all of them: objects promoted by this
+        // GC may already be below the adjusted ephemeral range while their references are being updated.
+        bool fYoungRefsOnly = sc->promotion && (condemned < max_gen);
+        EnumAllStaticGCRefs(fn, sc, fYoungRefsOnly);
     }
 }
 
@@ -145,12 +173,60 @@ void GcEnumObject(PTR_PTR_Object ppObj, UInt32 flags, EnumGcRefCallbackFunc * fn
         fnGcEnumRef(ppObj, pSc, flags);
 }
 
+// Null references are not reported, a callback has nothing to do for them. Large blocks of static references
+// are mostly null until the code that fills them has run, so the references are tested four at a time with a
+// single branch before looking at them one by one.
 void GcBulkEnumObjects(PTR_PTR_Object pObjs, UInt32 cObjs, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc)
 {
     PTR_PTR_Object ppObj = pObjs;
+    PTR_PTR_Object ppEnd = pObjs + cObjs;
 
-    for (UInt32 i = 0; i < cObjs; i++)
-        fnGcEnumRef(ppObj++, pSc, 0);
+    for (; ppObj < ppEnd; ppObj++)
+    {
+        if ((ppEnd - ppObj) >= 4 &&
+            (dac_cast<TADDR>(ppObj[0]) | dac_cast<TADDR>(ppObj[1]) | dac_cast<TADDR>(ppObj[2]) | dac_cast<TADDR>(ppObj[3])) == 0)
+        {
+            ppObj += 3;
+            continue;
+        }
+
+        if (*ppObj != NULL)
+            fnGcEnumRef(ppObj, pSc, 0);
+    }
+}
+
+static FORCEINLINE bool IsInEphemeralRange(PTR_Object pObj, UIntNative lowest, UIntNative cbRange)
+{
+    return (dac_cast<TADDR>(pObj) - lowest) < cbRange;
+}
+
+// Like GcBulkEnumObjects, but only reports references into the ephemeral range of the write barrier. That range
+// is exact for workstation GC; server GC leaves it covering the whole address space so nothing is skipped there.
+// Null references are below the range, so they are skipped by the same test.
+void GcBulkEnumEphemeralObjects(PTR_PTR_Object pObjs, UInt32 cObjs, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc)
+{
+    UIntNative lowest = (UIntNative)g_ephemeral_low;
+    UIntNative highest = (UIntNative)g_ephemeral_high;
+    if (highest <= lowest)
+        return;
+
+    UIntNative cbRange = highest - lowest;
+    PTR_PTR_Object ppObj = pObjs;
+    PTR_PTR_Object ppEnd = pObjs + cObjs;
+
+    for (; ppObj < ppEnd; ppObj++)
+    {
+        if ((ppEnd - ppObj) >= 4 &&
+            !(IsInEphemeralRange(ppObj[0], lowest, cbRange) | IsInEphemeralRange(ppObj[1], lowest, cbRange) |
+              IsInEphemeralRange(ppObj[2], lowest, cbRange) | IsInEphemeralRange(ppObj[3], lowest, cbRange)))
+        {
+            ppObj += 3;
+            continue;
+        }
+
+        if (IsInEphemeralRange(*ppObj, lowest, cbRange))
+            fnGcEnumRef(ppObj, pSc, 0);
+    }
 }
 
 // Scan a contiguous range of memory and report everything that looks like it could be a GC reference as a
@@ -159,19 +235,67 @@ void GcBulkEnumObjects(PTR_PTR_Object pObjs, UInt32 cObjs, EnumGcRefCallbackFunc
 // real reference is interior or not and interior is the more conservative choice that will work for both and
 // (b) because it might not be a real GC reference at all and in that case falsely listing the reference as
 // non-interior will cause the GC to make assumptions and crash quite quickly.
+//
+// Resolving an interior reference to its object is the expensive part of the promotion, a walk of the objects
+// from the closest brick, or from the start of the segment for large objects. The same values show up in many
+// slots of a stack, and after the first of them has marked and pinned the object reporting them again does
+// nothing, so the values reported recently are remembered and skipped.
+//
+// Most slots of a large region, such as the one of the universal transition thunk or a shadow stack, don't
+// point into the heap at all. They are tested against the heap range four at a time with a single branch,
+// one unsigned compare each, before looking at them one by one.
+#define CONSERVATIVE_SCAN_RECENT_VALUES 64
+
+static FORCEINLINE bool IsInConservativeScanRange(PTR_Object pObj, UIntNative lowest, UIntNative cbRange)
+{
+    return (dac_cast<TADDR>(pObj) - lowest) <= cbRange;
+}
+
 void GcEnumObjectsConservatively(PTR_PTR_Object ppLowerBound, PTR_PTR_Object ppUpperBound, EnumGcRefCallbackFunc * fnGcEnumRef, EnumGcRefScanContext * pSc)
 {
     // Only report potential references in the promotion phase. Since we report everything as pinned there
     // should be no work to do in the relocation phase.
     if (pSc->promotion)
     {
+        // Only report values that lie in the GC heap range. This doesn't conclusively guarantee that the
+        // value is a GC heap reference but it's a cheap check that weeds out a lot of spurious values.
+        UIntNative lowest = (UIntNative)g_lowest_address;
+        UIntNative highest = (UIntNative)g_highest_address;
+
+        // While marking for an ephemeral GC, values outside the ephemeral generations can't keep anything
+        // condemned alive. Server GC leaves the ephemeral range covering the whole address space.
+        IGCHeap * pHeap = GCHeapUtilities::GetGCHeap();
+        if (pHeap->GetCondemnedGeneration() < pHeap->GetMaxGeneration())
+        {
+            lowest = max(lowest, (UIntNative)g_ephemeral_low);
+            highest = min(highest, (UIntNative)g_ephemeral_high);
+            if (highest < lowest)
+                return;
+        }
+
+        UIntNative cbRange = highest - lowest;
+        PTR_Object recentValues[CONSERVATIVE_SCAN_RECENT_VALUES] = {};
+
         for (PTR_PTR_Object ppObj = ppLowerBound; ppObj < ppUpperBound; ppObj++)
         {
-            // Only report values that lie in the GC heap range. This doesn't conclusively guarantee that the
-            // value is a GC heap reference but it's a cheap check that weeds out a lot of spurious values.
+            if ((ppUpperBound - ppObj) >= 4 &&
+                !(IsInConservativeScanRange(ppObj[0], lowest, cbRange) | IsInConservativeScanRange(ppObj[1], lowest, cbRange) |
+                  IsInConservativeScanRange(ppObj[2], lowest, cbRange) | IsInConservativeScanRange(ppObj[3], lowest, cbRange)))
+            {
+                ppObj += 3;
+                continue;
+            }
+
             PTR_Object pObj = *ppObj;
-            if (((PTR_UInt8)pObj >= g_lowest_address) && ((PTR_UInt8)pObj <= g_highest_address))
+            if (IsInConservativeScanRange(pObj, lowest, cbRange))
+            {
+                PTR_Object * pRecent = &recentValues[(dac_cast<TADDR>(pObj) >> 3) % CONSERVATIVE_SCAN_RECENT_VALUES];
+                if (*pRecent == pObj)
+                    continue;
+                *pRecent = pObj;
+
                 fnGcEnumRef(ppObj, pSc, GC_CALL_INTERIOR|GC_CALL_PINNED);
+            }
         }
     }
 }
@@ -4,6 +4,7 @@
 
 #include "common.h"
 #include "gctoclreventsink.h"
+#include "EventSession.h"
 
 GCToCLREventSink g_gcToClrEventSink;
 
@@ -36,6 +37,12 @@ void GCToCLREventSink::FireGCStart_V2(uint32_t count, uint32_t depth, uint32_t r
     gcStartInfo.GCStart.Type = static_cast<ETW::GCLog::ETW_GC_INFO::GC_TYPE>(type);
     ETW::GCLog::FireGcStart(&gcStartInfo);
 #endif // FEATURE_ETW
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_GC))
+    {
+        EventSessionGCStart payload = { count, depth, reason, type };
+        WriteEventSessionEvent(EventSessionEvent_GCStart, &payload, sizeof(payload));
+    }
 }
 
 void GCToCLREventSink::FireGCGenerationRange(uint8_t generation, void* rangeStart, uint64_t rangeUsedLength, uint64_t rangeReservedLength)
@@ -50,6 +57,12 @@ void GCToCLREventSink::FireGCEnd_V1(uint32_t count, uint32_t depth)
     LIMITED_METHOD_CONTRACT;
 
     FireEtwGCEnd_V1(count, depth, GetClrInstanceId());
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_GC))
+    {
+        EventSessionGCEnd payload = { count, depth };
+        WriteEventSessionEvent(EventSessionEvent_GCEnd, &payload, sizeof(payload));
+    }
 }
 
 void GCToCLREventSink::FireGCHeapStats_V2(
@@ -76,6 +89,26 @@ void GCToCLREventSink::FireGCHeapStats_V2(
                           generationSize2, totalPromotedSize2, generationSize3, totalPromotedSize3,
                           finalizationPromotedSize, finalizationPromotedCount, pinnedObjectCount,
                           sinkBlockCount, gcHandleCount, GetClrInstanceId());
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_GC))
+    {
+        EventSessionGCHeapStats payload;
+        payload.GenerationSize[0] = generationSize0;
+        payload.GenerationSize[1] = generationSize1;
+        payload.GenerationSize[2] = generationSize2;
+        payload.GenerationSize[3] = generationSize3;
+        payload.GenerationSize[4] = generationSize4;
+        payload.TotalPromotedSize[0] = totalPromotedSize0;
+        payload.TotalPromotedSize[1] = totalPromotedSize1;
+        payload.TotalPromotedSize[2] = totalPromotedSize2;
+        payload.TotalPromotedSize[3] = totalPromotedSize3;
+        payload.TotalPromotedSize[4] = totalPromotedSize4;
+        payload.FinalizationPromotedSize = finalizationPromotedSize;
+        payload.FinalizationPromotedCount = finalizationPromotedCount;
+        payload.PinnedObjectCount = pinnedObjectCount;
+        payload.GCHandleCount = gcHandleCount;
+        WriteEventSessionEvent(EventSessionEvent_GCHeapStats, &payload, sizeof(payload));
+    }
 }
 
 void GCToCLREventSink::FireGCCreateSegment_V1(void* address, size_t size, uint32_t type)
@@ -169,6 +202,19 @@ void GCToCLREventSink::FireGCAllocationTick_V3(uint64_t allocationAmount, uint32
             name,
             heapIndex,
             objectAddress);
+
+        if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_ALLOCATION))
+        {
+            WriteEventSessionType((EEType *)typeId);
+
+            EventSessionAllocationTick payload;
+            payload.AllocationAmount = allocationAmount;
+            payload.TypeId = (UInt64)(size_t)typeId;
+            payload.ObjectAddress = (UInt64)(size_t)objectAddress;
+            payload.AllocationKind = allocationKind;
+            payload.HeapIndex = heapIndex;
+            WriteEventSessionEvent(EventSessionEvent_AllocationTick, &payload, sizeof(payload));
+        }
     }
 }
 
@@ -183,6 +229,14 @@ void GCToCLREventSink::FirePinPlugAtGCTime(uint8_t* plugStart, uint8_t* plugEnd,
     FireEtwPinPlugAtGCTime(plugStart, plugEnd, gapBeforeSize, GetClrInstanceId());
 }
 
+void GCToCLREventSink::FireBulkPinPlugAtGCTime(const GCPinPlugEventData* plugs, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        FireEtwPinPlugAtGCTime(plugs[i].plugStart, plugs[i].plugEnd, plugs[i].gapBeforeSize, GetClrInstanceId());
+    }
+}
+
 void GCToCLREventSink::FireGCPerHeapHistory_V3(void *freeListAllocated,
                                                void *freeListRejected,
                                                void *endOfSegAllocated,
@@ -53,6 +53,8 @@ enum class ReadyToRunSectionType
     ThreadStaticIndex           = 210,
     LoopHijackFlag              = 211,
     ImportAddressTables         = 212,
+    PreInitializedStaticsRegion = 213,
+    FrozenObjectsWithGCRefsRegion = 214,
 
     // Sections 300 - 399 are reserved for RhFindBlob backwards compatibility
     ReadonlyBlobRegionStart     = 300,
@@ -21,5 +21,6 @@ DEFINE_INLINE_OPTIONAL_FIELD    (RareFlags,                UInt32)
 DEFINE_INLINE_OPTIONAL_FIELD    (DispatchMap,              UInt32)
 DEFINE_INLINE_OPTIONAL_FIELD    (ValueTypeFieldPadding,    UInt32)
 DEFINE_INLINE_OPTIONAL_FIELD    (NullableValueOffset,      UInt8)
+DEFINE_INLINE_OPTIONAL_FIELD    (InterfaceSignature,       UInt32)
 
 #undef DEFINE_INLINE_OPTIONAL_FIELD
@@ -398,6 +398,12 @@ public:
     // Get flags that are less commonly set on EETypes.
     inline UInt32 get_RareFlags();
 
+#ifndef DACCESS_COMPILE
+    // Get the rare flags through the side table of decoded flags kept by OptionalFieldsRuntime.cpp. Only
+    // valid for types with optional fields.
+    UInt32 GetCachedRareFlags();
+#endif
+
     // Helper methods that deal with EEType topology (size and field layout). These are useful since as we
     // optimize for pay-for-play we increasingly want to customize exactly what goes into an EEType on a
     // per-type basis. The rules that govern this can be both complex and volatile and we risk sprinkling
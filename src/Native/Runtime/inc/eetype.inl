@@ -110,14 +110,13 @@ inline PTR_OptionalFields EEType::get_OptionalFields()
 // Get flags that are less commonly set on EETypes.
 inline UInt32 EEType::get_RareFlags()
 {
-    OptionalFields * pOptFields = get_OptionalFields();
-
     // If there are no optional fields then none of the rare flags have been set.
-    if (!pOptFields)
+    if ((m_usFlags & OptionalFieldsFlag) == 0)
         return 0;
 
-    // Get the flags from the optional fields. The default is zero if that particular field was not included.
-    return pOptFields->GetRareFlags(0);
+    // The flags are decoded once per type and looked up in a side table afterwards, since GetFieldOffset asks
+    // for them for most fields of dynamic types.
+    return GetCachedRareFlags();
 }
 
 inline TypeManagerHandle* EEType::GetTypeManagerPtr()
@@ -318,6 +318,16 @@ public:
     //preallocate up to per thread size limit
     static bool ReserveStressLogChunks (unsigned int chunksToReserve);
 
+    //starts streaming the messages that are about to be overwritten in the thread logs to a file, see
+    //stressLog.cpp for the format. Returns false if the file or the streaming thread couldn't be created
+    static bool InitializeStream ();
+
+    //hands a chunk full of messages of threadId over to the streaming thread, which frees it once written.
+    //Returns false if the chunk couldn't be queued, the caller still owns it then
+    static bool StreamChunk (StressLogChunk * pChunk, uint64_t threadId);
+
+    static bool IsStreaming () { return s_fStreaming; }
+
 // private:
     static ThreadStressLog* CreateThreadStressLog(Thread * pThread);
     static ThreadStressLog* CreateThreadStressLogHelper(Thread * pThread);
@@ -433,6 +443,9 @@ public:
 
 // private: // static variables
     static StressLog theLog;    // We only have one log, and this is it
+#ifndef DACCESS_COMPILE
+    static bool s_fStreaming;   // the messages are streamed to a file before being overwritten
+#endif // DACCESS_COMPILE
 };
 
 
@@ -568,6 +581,7 @@ private:
     FORCEINLINE StressMsg* AdvanceWrite(int cArgs);
     inline StressMsg* AdvWritePastBoundary(int cArgs);
     FORCEINLINE bool GrowChunkList ();
+    inline void StreamCurWriteChunk ();
 
 #else // DACCESS_COMPILE
 public:
@@ -800,10 +814,58 @@ inline StressMsg* ThreadStressLog::AdvWritePastBoundary(int cArgs) {
     {
         writeHasWrapped = TRUE;
     }
+
+    //once wrapped, the chunk we move to holds the oldest messages of this thread
+    if (writeHasWrapped && StressLog::IsStreaming ())
+    {
+        StreamCurWriteChunk ();
+    }
+
     curPtr = (StressMsg*)((char*)curWriteChunk->EndPtr () - sizeof(StressMsg) - cArgs * sizeof(void*));    
     return curPtr;
 }
 
+//------------------------------------------------------------------------------------------
+// Called when streaming, instead of overwriting the messages in curWriteChunk. Hands the chunk
+// over to the stream and puts a new one in its place in the chunk list.
+inline void ThreadStressLog::StreamCurWriteChunk () {
+    StressLogChunk * oldChunk = curWriteChunk;
+    StressLogChunk * newChunk = new (nothrow) StressLogChunk (oldChunk->prev, oldChunk->next);
+    if (newChunk == NULL)
+    {
+        //the messages are overwritten, as without streaming
+        return;
+    }
+
+    if (oldChunk->next == oldChunk)
+    {
+        newChunk->prev = newChunk;
+        newChunk->next = newChunk;
+    }
+    else
+    {
+        oldChunk->prev->next = newChunk;
+        oldChunk->next->prev = newChunk;
+    }
+
+    if (chunkListHead == oldChunk)
+    {
+        chunkListHead = newChunk;
+    }
+    if (chunkListTail == oldChunk)
+    {
+        chunkListTail = newChunk;
+    }
+    StressLog::NewChunk ();
+    curWriteChunk = newChunk;
+
+    if (!StressLog::StreamChunk (oldChunk, threadId))
+    {
+        delete oldChunk;
+        StressLog::ChunkDeleted ();
+    }
+}
+
 #endif // DACCESS_COMPILE
 
 #endif // STRESS_LOG
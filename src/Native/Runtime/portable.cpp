@@ -35,6 +35,7 @@
 
 #include "GCMemoryHelpers.h"
 #include "GCMemoryHelpers.inl"
+#include "CachedInterfaceDispatch.h"
 
 #if defined(USE_PORTABLE_HELPERS)
 
@@ -50,6 +51,7 @@ struct gc_alloc_context
     void*          gc_reserved_1;
     void*          gc_reserved_2;
     int            alloc_count;
+    int            alloc_quantum_shift;
 };
 
 //
@@ -257,6 +259,26 @@ COOP_PINVOKE_HELPER(void, RhpVTableOffsetDispatch, ())
     ASSERT_UNCONDITIONALLY("NYI");
 }
 
+#ifdef FEATURE_CACHED_INTERFACE_DISPATCH
+EXTERN_C void * REDHAWK_CALLCONV RhpResolveInterfaceMethod(Object * pObject, InterfaceDispatchCell * pCell);
+
+// The dispatch stubs can't be called without assembly code to pass them the cell, so code generated for
+// targets without it resolves interface calls through this helper instead. The cache of the cell is probed
+// inline, a miss or a null object goes to RhpResolveInterfaceMethod, which searches the megamorphic table and
+// resolves and caches the target like RhpCidResolve does for the stubs.
+COOP_PINVOKE_HELPER(void *, RhpResolveInterfaceDispatch, (Object * pObject, InterfaceDispatchCell * pCell))
+{
+    if (pObject != NULL)
+    {
+        void * pTargetCode = LookupInterfaceDispatchCache(pCell, pObject->get_EEType());
+        if (pTargetCode != NULL)
+            return pTargetCode;
+    }
+
+    return RhpResolveInterfaceMethod(pObject, pCell);
+}
+#endif // FEATURE_CACHED_INTERFACE_DISPATCH
+
 // @TODO Implement UniversalTransition
 EXTERN_C void * ReturnFromUniversalTransition;
 void * ReturnFromUniversalTransition;
@@ -435,7 +457,37 @@ COOP_PINVOKE_HELPER(void *, RhGetCurrentThunkContext, ())
 
 #endif
 
+#if defined(USE_PORTABLE_HELPERS)
+
+EXTERN_C NOINLINE void FASTCALL RhpWaitForGC2(PInvokeTransitionFrame * pFrame);
+
+// The thread has no transition frame while it runs managed code, publish one for as long as it waits so
+// that the suspension sees it at a safe point.
+EXTERN_C NOINLINE void FASTCALL RhpGcPollRare2()
+{
+    PInvokeTransitionFrame frame;
+    frame.m_RIP = NULL;
+    frame.m_pThread = ThreadStore::GetCurrentThread();
+    frame.m_Flags = 0;
+
+    RhpWaitForGC2(&frame);
+}
+
+// The code generators check RhpTrapThreads inline at method entries and loop back edges and only call
+// this when a suspension was requested, the check is repeated here for callers that don't.
+COOP_PINVOKE_HELPER(void, RhpGcPoll, ())
+{
+    if (ThreadStore::IsTrapThreadsRequested())
+    {
+        RhpGcPollRare2();
+    }
+}
+
+#else // USE_PORTABLE_HELPERS
+
 COOP_PINVOKE_HELPER(void, RhpGcPoll, ())
 {
     // TODO: implement
 }
+
+#endif // USE_PORTABLE_HELPERS
@@ -49,6 +49,13 @@ Revision History:
 
 #include "sha1.h"
 
+#if defined(HOST_X86) || defined(HOST_AMD64)
+#include <immintrin.h>
+
+// Set by DetectCPUFeatures when the processor implements the SHA extensions
+EXTERN_C bool g_fHasShaExtensions;
+#endif
+
 
 #define ROTATE32L(x,n) rotate32l(x,n)
 #define SHAVE32(x)     (UInt32)(x)
@@ -205,6 +212,128 @@ static void SHA1_block(SHA1_CTX *ctx)
 #endif 
 } // end SHA1_block
 
+#if defined(HOST_X86) || defined(HOST_AMD64)
+
+#if defined(__GNUC__)
+__attribute__((target("sha")))
+#endif
+static void SHA1_block_shani(SHA1_CTX *ctx)
+/*
+     SHA1_block with the SHA extensions, four rounds per sha1rnds4.
+*/
+{
+    __m128i abcd, abcd_save, e0, e0_save, e1;
+    __m128i msg0, msg1, msg2, msg3;
+
+    // The words of the state and of the message are kept with the first one in the most significant lane
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)ctx->partial_hash), 0x1B);
+    e0 = _mm_set_epi32((int)ctx->partial_hash[4], 0, 0, 0);
+
+    abcd_save = abcd;
+    e0_save = e0;
+
+    // awaiting_data already holds the big endian words of the block as integers
+    msg0 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(ctx->awaiting_data + 0)), 0x1B);
+    msg1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(ctx->awaiting_data + 4)), 0x1B);
+    msg2 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(ctx->awaiting_data + 8)), 0x1B);
+    msg3 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(ctx->awaiting_data + 12)), 0x1B);
+
+    // Rounds 0-3
+    e0 = _mm_add_epi32(e0, msg0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    // Rounds 4-7
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+    // Rounds 8-11
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // Rounds 12-15
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    msg0 = _mm_sha1msg2_epu32(msg0, msg3);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg2 = _mm_sha1msg1_epu32(msg2, msg3);
+    msg1 = _mm_xor_si128(msg1, msg3);
+
+// Four rounds from round 16 on, that also extend the message
+#define SHA1_ROUNDS4(E_IN, E_OUT, MSG, MSG_NEXT1, MSG_NEXT2, MSG_NEXT3, FUNC)   \
+    E_IN = _mm_sha1nexte_epu32(E_IN, MSG);                                      \
+    E_OUT = abcd;                                                               \
+    MSG_NEXT1 = _mm_sha1msg2_epu32(MSG_NEXT1, MSG);                             \
+    abcd = _mm_sha1rnds4_epu32(abcd, E_IN, FUNC);                               \
+    MSG_NEXT3 = _mm_sha1msg1_epu32(MSG_NEXT3, MSG);                             \
+    MSG_NEXT2 = _mm_xor_si128(MSG_NEXT2, MSG);
+
+    SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 0)     // Rounds 16-19
+    SHA1_ROUNDS4(e1, e0, msg1, msg2, msg3, msg0, 1)     // Rounds 20-23
+    SHA1_ROUNDS4(e0, e1, msg2, msg3, msg0, msg1, 1)     // Rounds 24-27
+    SHA1_ROUNDS4(e1, e0, msg3, msg0, msg1, msg2, 1)     // Rounds 28-31
+    SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 1)     // Rounds 32-35
+    SHA1_ROUNDS4(e1, e0, msg1, msg2, msg3, msg0, 1)     // Rounds 36-39
+    SHA1_ROUNDS4(e0, e1, msg2, msg3, msg0, msg1, 2)     // Rounds 40-43
+    SHA1_ROUNDS4(e1, e0, msg3, msg0, msg1, msg2, 2)     // Rounds 44-47
+    SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 2)     // Rounds 48-51
+    SHA1_ROUNDS4(e1, e0, msg1, msg2, msg3, msg0, 2)     // Rounds 52-55
+    SHA1_ROUNDS4(e0, e1, msg2, msg3, msg0, msg1, 2)     // Rounds 56-59
+    SHA1_ROUNDS4(e1, e0, msg3, msg0, msg1, msg2, 3)     // Rounds 60-63
+    SHA1_ROUNDS4(e0, e1, msg0, msg1, msg2, msg3, 3)     // Rounds 64-67
+
+#undef SHA1_ROUNDS4
+
+    // Rounds 68-71
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // Rounds 72-75
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+    // Rounds 76-79
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+    e0 = _mm_sha1nexte_epu32(e0, e0_save);
+    abcd = _mm_add_epi32(abcd, abcd_save);
+
+    _mm_storeu_si128((__m128i *)ctx->partial_hash, _mm_shuffle_epi32(abcd, 0x1B));
+    ctx->partial_hash[4] = (UInt32)_mm_cvtsi128_si32(_mm_srli_si128(e0, 12));
+
+    // SHA1_block zeroes the block it consumed, SHA1Update and SHA1Final rely on it
+    for (int i = 0; i < 16; i++) {
+        ctx->awaiting_data[i] = 0;
+    }
+} // end SHA1_block_shani
+
+#endif // HOST_X86 || HOST_AMD64
+
+static void SHA1_transform(SHA1_CTX *ctx)
+{
+#if defined(HOST_X86) || defined(HOST_AMD64)
+    if (g_fHasShaExtensions)
+    {
+        SHA1_block_shani(ctx);
+        return;
+    }
+#endif
+
+    SHA1_block(ctx);
+}
+
 
 void SHA1Hash::SHA1Init(SHA1_CTX *ctx)
 {
@@ -285,7 +414,7 @@ void SHA1Hash::SHA1Update(
         } 
 
         if (nbit_occupied == 512) {
-            SHA1_block(ctx);
+            SHA1_transform(ctx);
             nbit_occupied = 0;
             awaiting_data -= 16;
             ASSERT(awaiting_data == ctx->awaiting_data);
@@ -334,12 +463,12 @@ void SHA1Hash::SHA1Final(
     // Here we assume the buffer was zeroed earlier.
 
     if (nbit_occupied > 448) {   // If fewer than 64 bits left
-        SHA1_block(ctx);
+        SHA1_transform(ctx);
         nbit_occupied = 0;
     }
     ctx->awaiting_data[14] = nbit1;
     ctx->awaiting_data[15] = nbit0;
-    SHA1_block(ctx);
+    SHA1_transform(ctx);
 
          /* Copy final digest to user-supplied byte array */
 
@@ -27,13 +27,16 @@
 #include "stressLog.h"
 #include "RestrictedCallouts.h"
 #include "yieldprocessornormalized.h"
+#include "IntrinsicConstants.h"
+#include "AllocationSampling.h"
+#include "EventSession.h"
+#include "HeapSnapshot.h"
+#include "SamplingProfiler.h"
+#include "PerfMap.h"
+#include "GCMemoryHelpers.h"
 
 #ifndef DACCESS_COMPILE
 
-#ifdef PROFILE_STARTUP
-unsigned __int64 g_startupTimelineEvents[NUM_STARTUP_TIMELINE_EVENTS] = { 0 };
-#endif // PROFILE_STARTUP
-
 #ifdef TARGET_UNIX
 Int32 RhpHardwareExceptionHandler(UIntNative faultCode, UIntNative faultAddress, PAL_LIMITED_CONTEXT* palContext, UIntNative* arg0Reg, UIntNative* arg1Reg);
 #else
@@ -46,6 +49,7 @@ static bool DetectCPUFeatures();
 extern RhConfig * g_pRhConfig;
 
 EXTERN_C bool g_fHasFastFxsave = false;
+EXTERN_C bool g_fHasShaExtensions = false;
 
 CrstStatic g_CastCacheLock;
 CrstStatic g_ThunkPoolLock;
@@ -92,11 +96,27 @@ static bool InitDLL(HANDLE hPalInstance)
 
     InitializeYieldProcessorNormalizedCrst();
 
+    // Before the modules register their code
+    if (!InitializePerfMap())
+        return false;
+
     STARTUP_TIMELINE_EVENT(NONGC_INIT_COMPLETE);
 
     if (!RedhawkGCInterface::InitializeSubsystems())
         return false;
 
+    if (!InitializeAllocationSampling())
+        return false;
+
+    if (!InitializeEventSession())
+        return false;
+
+    if (!InitializeHeapSnapshot())
+        return false;
+
+    if (!InitializeSamplingProfiler())
+        return false;
+
     STARTUP_TIMELINE_EVENT(GC_INIT_COMPLETE);
 
 #ifdef STRESS_LOG
@@ -110,12 +130,20 @@ static bool InitDLL(HANDLE hPalInstance)
         StressLog::Initialize(facility, dwStressLogLevel, 
                               dwPerThreadChunks * STRESSLOG_CHUNK_SIZE, 
                               (unsigned)dwTotalStressLogSize, hPalInstance);
+
+        // The in-memory log works the same without the stream, so failing to start it isn't fatal.
+        if (g_pRhConfig->GetStressLogStream() != 0)
+            StressLog::InitializeStream();
     }
 #endif // STRESS_LOG
 
 #ifndef USE_PORTABLE_HELPERS
     if (!DetectCPUFeatures())
         return false;
+
+    InitializeGCMemoryHelpers();
+
+    STARTUP_TIMELINE_EVENT(CPU_FEATURES_DETECTED);
 #endif
 
     if (!g_CastCacheLock.InitNoThrow(CrstType::CrstCastCache))
@@ -156,24 +184,6 @@ static void CheckForPalFallback()
 }
 
 #ifndef USE_PORTABLE_HELPERS
-// Should match the constants defined in the compiler in HardwareIntrinsicHelpers.cs
-enum XArchIntrinsicConstants
-{
-    XArchIntrinsicConstants_Aes = 0x0001,
-    XArchIntrinsicConstants_Pclmulqdq = 0x0002,
-    XArchIntrinsicConstants_Sse3 = 0x0004,
-    XArchIntrinsicConstants_Ssse3 = 0x0008,
-    XArchIntrinsicConstants_Sse41 = 0x0010,
-    XArchIntrinsicConstants_Sse42 = 0x0020,
-    XArchIntrinsicConstants_Popcnt = 0x0040,
-    XArchIntrinsicConstants_Avx = 0x0080,
-    XArchIntrinsicConstants_Fma = 0x0100,
-    XArchIntrinsicConstants_Avx2 = 0x0200,
-    XArchIntrinsicConstants_Bmi1 = 0x0400,
-    XArchIntrinsicConstants_Bmi2 = 0x0800,
-    XArchIntrinsicConstants_Lzcnt = 0x1000,
-};
-
 bool DetectCPUFeatures()
 {
 #if defined(HOST_X86) || defined(HOST_AMD64)
@@ -254,6 +264,13 @@ bool DetectCPUFeatures()
                                         {
                                             g_cpuFeatures |= XArchIntrinsicConstants_Avx2;
                                         }
+
+#ifdef HOST_AMD64
+                                        if (((buffer[6] & 0x01) != 0) && (zmmStateSupport() == 1))  // AVX512F
+                                        {
+                                            g_cpuFeatures |= XArchIntrinsicConstants_Avx512f;
+                                        }
+#endif // HOST_AMD64
                                     }
                                 }
                             }
@@ -276,6 +293,11 @@ bool DetectCPUFeatures()
             {
                 g_cpuFeatures |= XArchIntrinsicConstants_Bmi2;
             }
+
+            if ((buffer[7] & 0x20) != 0)            // SHA
+            {
+                g_fHasShaExtensions = true;
+            }
         }
     }
 
@@ -305,63 +327,112 @@ bool DetectCPUFeatures()
 }
 #endif // !USE_PORTABLE_HELPERS
 
-#ifdef PROFILE_STARTUP
-#define STD_OUTPUT_HANDLE ((UInt32)-11)
+//
+// Startup timeline. Events are recorded from the first thing RhInitialize does, before the configuration can be
+// read, so they are always recorded and RH_StartupTimeline only controls whether they are printed at shutdown.
+// Module registration happens once per module, so the timeline is a log rather than a slot per event.
+//
+#define STARTUP_TIMELINE_CAPACITY 128
 
-struct RegisterModuleTrace
+struct StartupTimelineEntry
 {
-    LARGE_INTEGER Begin;
-    LARGE_INTEGER End;
+    Int64   m_timestamp;
+    UInt32  m_eventId;
 };
 
-const int NUM_REGISTER_MODULE_TRACES = 16;
-int g_registerModuleCount = 0;
+static StartupTimelineEntry g_startupTimeline[STARTUP_TIMELINE_CAPACITY];
+static Int32 volatile g_cStartupTimelineEvents = 0;
+
+static const char * const s_startupTimelineEventNames[] =
+{
+    "ProcessAttachBegin",
+    "PalInitComplete",
+    "NonGcInitComplete",
+    "GcHeapInitComplete",
+    "FinalizationInitComplete",
+    "GcInitComplete",
+    "CpuFeaturesDetected",
+    "ProcessAttachComplete",
+    "RegisterOsModuleBegin",
+    "RegisterOsModuleComplete",
+    "CreateTypeManagerBegin",
+    "CreateTypeManagerComplete",
+    "FirstAllocationRefill",
+    "ManagedMainBegin",
+};
 
-RegisterModuleTrace g_registerModuleTraces[NUM_REGISTER_MODULE_TRACES] = { 0 };
+C_ASSERT(COUNTOF(s_startupTimelineEventNames) == NUM_STARTUP_TIMELINE_EVENTS);
 
-static void AppendInt64(char * pBuffer, UInt32* pLen, UInt64 value)
+void RecordStartupTimelineEvent(STARTUP_TIMELINE_EVENT_ID eventId)
 {
-    char localBuffer[20];
-    int cch = 0;
+    UInt32 index = (UInt32)(PalInterlockedIncrement(&g_cStartupTimelineEvents) - 1);
+    if (index >= STARTUP_TIMELINE_CAPACITY)
+        return;
 
-    do
-    {
-        localBuffer[cch++] = '0' + (value % 10);
-        value = value / 10;
-    } while (value);
+    LARGE_INTEGER timestamp;
+    PalQueryPerformanceCounter(&timestamp);
+
+    g_startupTimeline[index].m_timestamp = timestamp.QuadPart;
+    g_startupTimeline[index].m_eventId = eventId;
+}
+
+// PalInit can switch the performance counter to a clock with another frequency but the same origin, so the
+// events recorded before it are converted to the frequency of the later ones.
+static void RescaleStartupTimeline(Int64 previousFrequency)
+{
+    LARGE_INTEGER frequency;
+    PalQueryPerformanceFrequency(&frequency);
+    if ((frequency.QuadPart == previousFrequency) || (previousFrequency == 0))
+        return;
 
-    for (int i = 0; i < cch; i++)
+    UInt32 cRecorded = min((UInt32)g_cStartupTimelineEvents, (UInt32)STARTUP_TIMELINE_CAPACITY);
+    for (UInt32 i = 0; i < cRecorded; i++)
     {
-        pBuffer[(*pLen)++] = localBuffer[cch - i - 1];
+        g_startupTimeline[i].m_timestamp =
+            (Int64)((double)g_startupTimeline[i].m_timestamp * frequency.QuadPart / previousFrequency);
     }
-
-    pBuffer[(*pLen)++] = ',';
-    pBuffer[(*pLen)++] = ' ';
 }
-#endif // PROFILE_STARTUP
 
-static void UninitDLL()
+// Prints each event with the microseconds since the start of the process attach and since the previous event.
+// The start is also printed as a performance counter value, so a launcher reading the same clock can tell how
+// long the process took to get to the runtime.
+static void DumpStartupTimeline()
 {
-#ifdef PROFILE_STARTUP
-    char buffer[1024];
+    static bool s_fDumped = false;
+    if (s_fDumped || (g_pRhConfig->GetStartupTimeline() == 0))
+        return;
+    s_fDumped = true;
+
+    LARGE_INTEGER frequency;
+    PalQueryPerformanceFrequency(&frequency);
 
-    UInt32 len = 0;
+    UInt32 cEvents = (UInt32)g_cStartupTimelineEvents;
+    UInt32 cRecorded = min(cEvents, (UInt32)STARTUP_TIMELINE_CAPACITY);
+    if ((cRecorded == 0) || (frequency.QuadPart == 0))
+        return;
 
-    AppendInt64(buffer, &len, g_startupTimelineEvents[PROCESS_ATTACH_BEGIN]);
-    AppendInt64(buffer, &len, g_startupTimelineEvents[NONGC_INIT_COMPLETE]);
-    AppendInt64(buffer, &len, g_startupTimelineEvents[GC_INIT_COMPLETE]);
-    AppendInt64(buffer, &len, g_startupTimelineEvents[PROCESS_ATTACH_COMPLETE]);
+    Int64 startTimestamp = g_startupTimeline[0].m_timestamp;
+    Int64 previousTimestamp = startTimestamp;
 
-    for (int i = 0; i < g_registerModuleCount; i++)
+    fprintf(stderr, "RhStartupTimeline: origin %.0f us\n", (double)startTimestamp * 1000000 / frequency.QuadPart);
+
+    for (UInt32 i = 0; i < cRecorded; i++)
     {
-        AppendInt64(buffer, &len, g_registerModuleTraces[i].Begin.QuadPart);
-        AppendInt64(buffer, &len, g_registerModuleTraces[i].End.QuadPart);
+        Int64 timestamp = g_startupTimeline[i].m_timestamp;
+        fprintf(stderr, "RhStartupTimeline: %-26s %10lld us (+%lld us)\n",
+            s_startupTimelineEventNames[g_startupTimeline[i].m_eventId],
+            (long long)((timestamp - startTimestamp) * 1000000 / frequency.QuadPart),
+            (long long)((timestamp - previousTimestamp) * 1000000 / frequency.QuadPart));
+        previousTimestamp = timestamp;
     }
 
-    buffer[len++] = '\n';
+    if (cEvents > cRecorded)
+        fprintf(stderr, "RhStartupTimeline: %u events dropped\n", cEvents - cRecorded);
+}
 
-    fwrite(buffer, len, 1, stdout);
-#endif // PROFILE_STARTUP
+static void UninitDLL()
+{
+    DumpStartupTimeline();
 }
 
 volatile bool g_processShutdownHasStarted = false;
@@ -404,15 +475,33 @@ void RuntimeThreadShutdown(void* thread)
 
 extern "C" bool RhInitialize()
 {
+    LARGE_INTEGER frequency;
+    PalQueryPerformanceFrequency(&frequency);
+
+    STARTUP_TIMELINE_EVENT(PROCESS_ATTACH_BEGIN);
+
     if (!PalInit())
         return false;
 
+    RescaleStartupTimeline(frequency.QuadPart);
+
+    STARTUP_TIMELINE_EVENT(PAL_INIT_COMPLETE);
+
     if (!InitDLL(PalGetModuleHandleFromPointer((void*)&RhInitialize)))
         return false;
 
+    STARTUP_TIMELINE_EVENT(PROCESS_ATTACH_COMPLETE);
+
     return true;
 }
 
+// Called by the bootstrapper right before the managed entry point, once the runtime and the modules are
+// initialized.
+COOP_PINVOKE_HELPER(void, RhpRecordManagedMainBegin, ())
+{
+    STARTUP_TIMELINE_EVENT(MANAGED_MAIN_BEGIN);
+}
+
 COOP_PINVOKE_HELPER(void, RhpEnableConservativeStackReporting, ())
 {
     GetRuntimeInstance()->EnableConservativeStackReporting();
@@ -428,6 +517,9 @@ COOP_PINVOKE_HELPER(void, RhpEnableConservativeStackReporting, ())
 //
 COOP_PINVOKE_HELPER(void, RhpShutdown, ())
 {
+    DumpStartupTimeline();
+    WriteSamplingProfile();
+
     // Indicate that runtime shutdown is complete and that the caller is about to start shutting down the entire process.
     g_processShutdownHasStarted = true;
 }
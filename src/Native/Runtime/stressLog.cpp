@@ -302,6 +302,294 @@ bool StressLog::ReserveStressLogChunks (unsigned chunksToReserve)
     return msgs->chunkListLength >= (long)chunksToReserve;
 }
 
+/*********************************************************************************/
+/* Streaming
+
+   When RH_StressLogStream is set, the chunks of a thread log are not overwritten once the
+   log has wrapped. The logging thread replaces the chunk it is about to overwrite with a new one
+   and queues the full chunk to the streaming thread, which encodes its messages to
+   stresslog_<pid>.bin and frees it. The in-memory log keeps the most recent messages (so crash
+   dumps look the same) and the file has everything that rolled out of it.
+
+   The file starts with a StressLogStreamHeader followed by records that start with a tag byte.
+   All the numbers in the records are LEB128 varints.
+     STRESSLOG_STREAM_FORMAT:  id, length, length chars
+        The format string of the messages with that id, written before its first message.
+     STRESSLOG_STREAM_CHUNK:   thread id, message count, messages
+        The messages of one chunk of a thread, oldest first. Each message is the zigzag encoded
+        time stamp delta from the previous message of the record (the first one from 0), format
+        id, facility, argument count and the arguments.
+   The format id is the offset of the string from the module base, as in the in-memory log.
+*/
+
+#define STRESSLOG_STREAM_MAGIC          0x54534C53  // 'SLST'
+#define STRESSLOG_STREAM_VERSION        1
+#define STRESSLOG_STREAM_FORMAT         1
+#define STRESSLOG_STREAM_CHUNK          2
+#define STRESSLOG_STREAM_INTERVAL       100         // milliseconds between writes
+#define STRESSLOG_STREAM_BUFFER_SIZE    (64 * 1024)
+#define STRESSLOG_STREAM_FORMAT_TABLE_SIZE 4096     // must be a power of 2
+
+struct StressLogStreamHeader
+{
+    UInt32 Magic;
+    UInt32 Version;
+    UInt64 TickFrequency;
+    UInt64 StartTimeStamp;
+    UInt64 StartTime;                   // FILETIME
+    UInt64 ModuleOffset;
+};
+
+// A chunk queued to the streaming thread
+struct StreamedChunk
+{
+    StreamedChunk * pNext;
+    StressLogChunk * pChunk;
+    uint64_t threadId;
+};
+
+bool StressLog::s_fStreaming = false;
+
+static StreamedChunk * volatile s_pStreamedChunks = NULL;
+static HANDLE s_hStreamFile = INVALID_HANDLE_VALUE;
+
+// Only used by the streaming thread
+static UInt8 s_streamBuffer[STRESSLOG_STREAM_BUFFER_SIZE];
+static UInt32 s_cbStreamBuffer = 0;
+static UInt32 s_rgStreamedFormats[STRESSLOG_STREAM_FORMAT_TABLE_SIZE];    // format id + 1, 0 if empty
+static StressMsg * s_rgChunkMessages[STRESSLOG_CHUNK_SIZE / sizeof(StressMsg)];
+
+static void FlushStreamBuffer()
+{
+    if (s_cbStreamBuffer != 0)
+    {
+        // If the write fails there is nobody to tell, the messages are lost.
+        PalWriteFileContents(s_hStreamFile, s_streamBuffer, s_cbStreamBuffer);
+        s_cbStreamBuffer = 0;
+    }
+}
+
+static void EnsureStreamBuffer(UInt32 cbNeeded)
+{
+    ASSERT(cbNeeded <= STRESSLOG_STREAM_BUFFER_SIZE);
+    if (s_cbStreamBuffer + cbNeeded > STRESSLOG_STREAM_BUFFER_SIZE)
+    {
+        FlushStreamBuffer();
+    }
+}
+
+// The callers ensure there is space for the encoded value (at most 10 bytes)
+static void StreamVarInt(UInt64 value)
+{
+    while (value >= 0x80)
+    {
+        s_streamBuffer[s_cbStreamBuffer++] = (UInt8)(value | 0x80);
+        value >>= 7;
+    }
+    s_streamBuffer[s_cbStreamBuffer++] = (UInt8)value;
+}
+
+// Returns true the first time formatId is seen. If the table is full the format is streamed again,
+// which the reader handles just like the first time.
+static bool IsNewStreamedFormat(UInt32 formatId)
+{
+    UInt32 iSlot = (formatId * 0x9E3779B1) & (STRESSLOG_STREAM_FORMAT_TABLE_SIZE - 1);
+    for (UInt32 cProbes = 0; cProbes < STRESSLOG_STREAM_FORMAT_TABLE_SIZE; cProbes++)
+    {
+        UInt32 entry = s_rgStreamedFormats[iSlot];
+        if (entry == formatId + 1)
+            return false;
+
+        if (entry == 0)
+        {
+            s_rgStreamedFormats[iSlot] = formatId + 1;
+            return true;
+        }
+
+        iSlot = (iSlot + 1) & (STRESSLOG_STREAM_FORMAT_TABLE_SIZE - 1);
+    }
+
+    return true;
+}
+
+static void StreamFormat(UInt32 formatId)
+{
+    const char * format = (const char *)(StressLog::theLog.moduleOffset + formatId);
+    size_t cchFormat = strlen(format);
+    if (cchFormat > STRESSLOG_STREAM_BUFFER_SIZE - 32)
+        cchFormat = STRESSLOG_STREAM_BUFFER_SIZE - 32;
+
+    EnsureStreamBuffer((UInt32)cchFormat + 32);
+    s_streamBuffer[s_cbStreamBuffer++] = STRESSLOG_STREAM_FORMAT;
+    StreamVarInt(formatId);
+    StreamVarInt(cchFormat);
+    memcpy(&s_streamBuffer[s_cbStreamBuffer], format, cchFormat);
+    s_cbStreamBuffer += (UInt32)cchFormat;
+}
+
+static void StreamChunkMessages(StressLogChunk * pChunk, uint64_t threadId)
+{
+    // The messages are written from the end of the chunk towards its start, the space before the most
+    // recent one is zeroed. Find the first message just like the debugger does.
+    void ** p = (void **)pChunk->StartPtr();
+    while (*p == NULL && (size_t)(p - (void **)pChunk->StartPtr()) < (StressMsg::maxMsgSize() / sizeof(void *)))
+    {
+        ++p;
+    }
+
+    UInt32 cMessages = 0;
+    StressMsg * pMsg = (StressMsg *)p;
+    while ((char *)pMsg + sizeof(StressMsg) <= pChunk->EndPtr())
+    {
+        StressMsg * pNextMsg = (StressMsg *)((char *)pMsg + sizeof(StressMsg) + pMsg->numberOfArgs * sizeof(void *));
+        if ((char *)pNextMsg > pChunk->EndPtr())
+            break;
+
+        ASSERT(cMessages < COUNTOF(s_rgChunkMessages));
+        s_rgChunkMessages[cMessages++] = pMsg;
+        pMsg = pNextMsg;
+    }
+
+    for (UInt32 i = 0; i < cMessages; i++)
+    {
+        UInt32 formatId = s_rgChunkMessages[i]->formatOffset;
+        if ((formatId != 0) && IsNewStreamedFormat(formatId))
+            StreamFormat(formatId);
+    }
+
+    EnsureStreamBuffer(32);
+    s_streamBuffer[s_cbStreamBuffer++] = STRESSLOG_STREAM_CHUNK;
+    StreamVarInt(threadId);
+    StreamVarInt(cMessages);
+
+    // Oldest first
+    unsigned __int64 lastTimeStamp = 0;
+    for (UInt32 i = cMessages; i-- > 0; )
+    {
+        StressMsg * pCurMsg = s_rgChunkMessages[i];
+
+        EnsureStreamBuffer(10 * (4 + StressMsg::maxArgCnt));
+        Int64 delta = (Int64)(pCurMsg->timeStamp - lastTimeStamp);
+        StreamVarInt(((UInt64)delta << 1) ^ (UInt64)(delta >> 63));
+        lastTimeStamp = pCurMsg->timeStamp;
+
+        StreamVarInt(pCurMsg->formatOffset);
+        StreamVarInt(pCurMsg->facility);
+        StreamVarInt(pCurMsg->numberOfArgs);
+        for (UInt32 iArg = 0; iArg < pCurMsg->numberOfArgs; iArg++)
+        {
+            StreamVarInt((size_t)pCurMsg->args[iArg]);
+        }
+    }
+}
+
+static UInt32 __stdcall StressLogStreamThread(void * /*pContext*/)
+{
+    for (;;)
+    {
+        PalSleep(STRESSLOG_STREAM_INTERVAL);
+
+        StreamedChunk * pChunks = (StreamedChunk *)PalInterlockedExchangePointer((void * volatile *)&s_pStreamedChunks, NULL);
+        if (pChunks == NULL)
+            continue;
+
+        // The chunks were pushed as a stack, put them back in the order they were queued.
+        StreamedChunk * pOrdered = NULL;
+        while (pChunks != NULL)
+        {
+            StreamedChunk * pNext = pChunks->pNext;
+            pChunks->pNext = pOrdered;
+            pOrdered = pChunks;
+            pChunks = pNext;
+        }
+
+        while (pOrdered != NULL)
+        {
+            StreamChunkMessages(pOrdered->pChunk, pOrdered->threadId);
+
+            StreamedChunk * pNext = pOrdered->pNext;
+            delete pOrdered->pChunk;
+            StressLog::ChunkDeleted();
+            delete pOrdered;
+            pOrdered = pNext;
+        }
+
+        FlushStreamBuffer();
+    }
+}
+
+bool StressLog::InitializeStream()
+{
+    if (theLog.MaxSizePerThread == 0)
+    {
+        // The stress log is not enabled
+        return false;
+    }
+
+    TCHAR fileName[32] = _T("stresslog_");
+    TCHAR * pch = fileName;
+    while (*pch != 0)
+        pch++;
+
+    TCHAR digits[10];
+    int cDigits = 0;
+    UInt32 pid = PalGetCurrentProcessId();
+    do
+    {
+        digits[cDigits++] = (TCHAR)(_T('0') + pid % 10);
+        pid /= 10;
+    } while (pid != 0);
+    while (cDigits > 0)
+        *pch++ = digits[--cDigits];
+
+    const TCHAR extension[] = _T(".bin");
+    for (size_t i = 0; i < COUNTOF(extension); i++)
+        *pch++ = extension[i];
+
+    s_hStreamFile = PalCreateFileForWriting(fileName);
+    if (s_hStreamFile == INVALID_HANDLE_VALUE)
+        return false;
+
+    StressLogStreamHeader header;
+    header.Magic = STRESSLOG_STREAM_MAGIC;
+    header.Version = STRESSLOG_STREAM_VERSION;
+    header.TickFrequency = theLog.tickFrequency;
+    header.StartTimeStamp = theLog.startTimeStamp;
+    header.StartTime = ((UInt64)theLog.startTime.dwHighDateTime << 32) | theLog.startTime.dwLowDateTime;
+    header.ModuleOffset = theLog.moduleOffset;
+
+    if (!PalWriteFileContents(s_hStreamFile, &header, sizeof(header)) ||
+        !PalStartBackgroundGCThread(StressLogStreamThread, NULL))
+    {
+        PalCloseHandle(s_hStreamFile);
+        s_hStreamFile = INVALID_HANDLE_VALUE;
+        return false;
+    }
+
+    s_fStreaming = true;
+    return true;
+}
+
+bool StressLog::StreamChunk(StressLogChunk * pChunk, uint64_t threadId)
+{
+    StreamedChunk * pStreamedChunk = new (nothrow) StreamedChunk();
+    if (pStreamedChunk == NULL)
+        return false;
+
+    pStreamedChunk->pChunk = pChunk;
+    pStreamedChunk->threadId = threadId;
+
+    // Any number of logging threads push, the streaming thread only ever takes the whole list.
+    StreamedChunk * pHead;
+    do
+    {
+        pHead = s_pStreamedChunks;
+        pStreamedChunk->pNext = pHead;
+    } while (PalInterlockedCompareExchangePointer((void * volatile *)&s_pStreamedChunks, pStreamedChunk, pHead) != pHead);
+
+    return true;
+}
+
 /*********************************************************************************/
 /* fetch a buffer that can be used to write a stress message, it is thread safe */
 
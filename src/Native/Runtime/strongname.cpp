@@ -21,6 +21,33 @@
 
 #define PUBLIC_KEY_TOKEN_LEN 8
 
+// A process only sees the public keys of a handful of publishers, but assembly name comparisons ask for their
+// tokens over and over. The tokens already computed are kept in immutable entries that are published with an
+// interlocked compare exchange and never freed, so they can be looked up without locks. When all the entries
+// are taken the token is just computed every time.
+struct PublicKeyTokenCacheEntry
+{
+    int   cbPublicKey;
+    UInt8 PublicKeyToken[PUBLIC_KEY_TOKEN_LEN];
+    UInt8 PublicKey[1];     // Actually cbPublicKey bytes
+};
+
+#define PUBLIC_KEY_TOKEN_CACHE_SIZE 16
+
+static PublicKeyTokenCacheEntry * volatile s_publicKeyTokenCache[PUBLIC_KEY_TOKEN_CACHE_SIZE];
+
+static void ComputePublicKeyToken(const UInt8* pbPublicKey, int cbPublicKey, UInt8 *pbPublicKeyTokenOut)
+{
+    SHA1Hash sha1;
+    sha1.AddData(pbPublicKey, cbPublicKey);
+    UInt8* pHash = sha1.GetHash();
+
+    for (int i = 0; i < PUBLIC_KEY_TOKEN_LEN; i++)
+    {
+        pbPublicKeyTokenOut[i] = pHash[SHA1_HASH_SIZE - i - 1];
+    }
+}
+
 COOP_PINVOKE_HELPER(void, RhConvertPublicKeyToPublicKeyToken, (const UInt8* pbPublicKey, int cbPublicKey, UInt8 *pbPublicKeyTokenOut, int cbPublicKeyTokenOut))
 {
     ASSERT(pbPublicKey != NULL);
@@ -31,15 +58,38 @@ COOP_PINVOKE_HELPER(void, RhConvertPublicKeyToPublicKeyToken, (const UInt8* pbPu
         RhFailFast();
     }
 
-    SHA1Hash sha1;
-    sha1.AddData(pbPublicKey, cbPublicKey);
-    UInt8* pHash = sha1.GetHash();
-
-    for (int i = 0; i < PUBLIC_KEY_TOKEN_LEN; i++)
+    int iEntry;
+    for (iEntry = 0; iEntry < PUBLIC_KEY_TOKEN_CACHE_SIZE; iEntry++)
     {
-        pbPublicKeyTokenOut[i] = pHash[SHA1_HASH_SIZE - i - 1];
+        PublicKeyTokenCacheEntry * pEntry = s_publicKeyTokenCache[iEntry];
+        if (pEntry == NULL)
+            break;
+
+        if (pEntry->cbPublicKey == cbPublicKey && memcmp(pEntry->PublicKey, pbPublicKey, cbPublicKey) == 0)
+        {
+            memcpy(pbPublicKeyTokenOut, pEntry->PublicKeyToken, PUBLIC_KEY_TOKEN_LEN);
+            return;
+        }
     }
 
-    return;
+    ComputePublicKeyToken(pbPublicKey, cbPublicKey, pbPublicKeyTokenOut);
+
+    if (iEntry == PUBLIC_KEY_TOKEN_CACHE_SIZE)
+        return;
+
+    PublicKeyTokenCacheEntry * pNewEntry = (PublicKeyTokenCacheEntry *)new (nothrow) UInt8[offsetof(PublicKeyTokenCacheEntry, PublicKey) + cbPublicKey];
+    if (pNewEntry == NULL)
+        return;
+
+    pNewEntry->cbPublicKey = cbPublicKey;
+    memcpy(pNewEntry->PublicKeyToken, pbPublicKeyTokenOut, PUBLIC_KEY_TOKEN_LEN);
+    memcpy(pNewEntry->PublicKey, pbPublicKey, cbPublicKey);
+
+    // The entry has to be complete before another thread can find it
+    PalMemoryBarrier();
+
+    // Another thread may have taken the entry in the meantime, the token is cached by at most one of them
+    if (PalInterlockedCompareExchangePointer((void * volatile *)&s_publicKeyTokenCache[iEntry], pNewEntry, NULL) != NULL)
+        delete[] (UInt8 *)pNewEntry;
 }
 
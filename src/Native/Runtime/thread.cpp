@@ -26,6 +26,9 @@
 #include "rhbinder.h"
 #include "stressLog.h"
 #include "RhConfig.h"
+#include "AllocationSampling.h"
+#include "EventSession.h"
+#include "NativeMemory.h"
 
 #ifndef DACCESS_COMPILE
 
@@ -186,6 +189,35 @@ bool Thread::IsCurrentThreadInCooperativeMode()
     return (m_pTransitionFrame == NULL);
 }
 
+#if defined(FEATURE_CACHED_INTERFACE_DISPATCH) && !defined(DACCESS_COMPILE)
+// Called by the current thread at a point where it cannot be holding a reference to any interface dispatch
+// cache discarded in the given epoch or earlier.
+void Thread::NoteInterfaceDispatchQuiescent(UInt32 uEpoch)
+{
+    ASSERT(ThreadStore::GetCurrentThread() == this);
+
+    if (m_uInterfaceDispatchEpoch != uEpoch)
+    {
+        m_uInterfaceDispatchEpoch = uEpoch;
+
+        // Make the update visible before this thread can go on to load any further cache pointers.
+        PalMemoryBarrier();
+    }
+}
+
+// Determines whether this (arbitrary) thread can no longer reference interface dispatch caches discarded in
+// the given epoch: either it has reported passing through that epoch or it's currently in preemptive mode
+// (and hence not executing a dispatch stub). The caller must have flushed process write buffers after the
+// epoch was started so that the transition frame read here is current.
+bool Thread::IsInterfaceDispatchQuiescent(UInt32 uEpoch)
+{
+    if ((Int32)(m_uInterfaceDispatchEpoch - uEpoch) >= 0)
+        return true;
+
+    return m_pTransitionFrame != NULL;
+}
+#endif // FEATURE_CACHED_INTERFACE_DISPATCH && !DACCESS_COMPILE
+
 //
 // This is used by the EH system to find the place where execution left managed code when an exception leaks out of a 
 // pinvoke and we need to FailFast via the appropriate class library.
@@ -220,6 +252,28 @@ PTR_VOID Thread::GetThreadStressLog() const
     return m_pThreadStressLog;
 }
 
+#ifndef DACCESS_COMPILE
+void * Thread::GetAllocationSampler()
+{
+    return m_pAllocationSampler;
+}
+
+void Thread::SetAllocationSampler(void * pSampler)
+{
+    m_pAllocationSampler = pSampler;
+}
+
+void * Thread::GetEventSessionBuffer()
+{
+    return m_pEventSessionBuffer;
+}
+
+void Thread::SetEventSessionBuffer(void * pBuffer)
+{
+    m_pEventSessionBuffer = pBuffer;
+}
+#endif // DACCESS_COMPILE
+
 #if defined(FEATURE_GC_STRESS) & !defined(DACCESS_COMPILE)
 void Thread::SetRandomSeed(UInt32 seed)
 {
@@ -296,6 +350,7 @@ void Thread::Construct()
 
     m_pThreadLocalModuleStatics = NULL;
     m_numThreadLocalModuleStatics = 0;
+    m_cbThreadStatics = 0;
 
     // NOTE: We do not explicitly defer to the GC implementation to initialize the alloc_context.  The 
     // alloc_context will be initialized to 0 via the static initialization of tls_CurrentThread. If the
@@ -395,8 +450,14 @@ void Thread::Destroy()
         delete[] m_pThreadLocalModuleStatics;
     }
 
+    NativeMemoryRemove(NativeMemoryKind_ThreadStatics, m_cbThreadStatics);
+
     RedhawkGCInterface::ReleaseAllocContext(GetAllocContext());
 
+    ReleaseAllocationSampler(this);
+
+    ReleaseEventSessionBuffer(this);
+
     // Thread::Destroy is called when the thread's "home" fiber dies.  We mark the thread as "detached" here
     // so that we can validate, in our DLL_THREAD_DETACH handler, that the thread was already destroyed at that
     // point.
@@ -404,16 +465,87 @@ void Thread::Destroy()
 }
 
 #ifdef HOST_WASM
+// Every managed method keeps a header in its frame on the shadow stack, following the parameters, and links
+// it into a list when it starts executing. The compiler emits the table of GC references of the frame: the
+// number of entries followed by the entries sorted by offset, each the offset of a slot from pFrame shifted
+// left by SHADOW_FRAME_SLOT_FLAG_BITS combined with the SHADOW_FRAME_SLOT_* flags.
+struct ShadowFrame
+{
+    ShadowFrame *   pPrevious;
+    UInt8 *         pFrame;
+    UInt32 *        pGcSlots;
+    UInt32          cbLive;         // The slots at this offset and above belong to the frame of the callee
+};
+
+#define SHADOW_FRAME_SLOT_INTERIOR  0x1
+#define SHADOW_FRAME_SLOT_PINNED    0x2
+#define SHADOW_FRAME_SLOT_FLAG_BITS 2
+
 extern RtuObjectRef * t_pShadowStackTop;
 extern RtuObjectRef * t_pShadowStackBottom;
+extern ShadowFrame * t_pShadowFrameTop;
 
 void GcScanWasmShadowStack(void * pfnEnumCallback, void * pvCallbackData)
 {
     // Wasm does not permit iteration of stack frames so is uses a shadow stack instead
-    RedhawkGCInterface::EnumGcRefsInRegionConservatively(t_pShadowStackBottom, t_pShadowStackTop, pfnEnumCallback, pvCallbackData);
+    if (t_pShadowFrameTop == NULL)
+    {
+        RedhawkGCInterface::EnumGcRefsInRegionConservatively(t_pShadowStackBottom, t_pShadowStackTop, pfnEnumCallback, pvCallbackData);
+        return;
+    }
+
+    for (ShadowFrame * pShadowFrame = t_pShadowFrameTop; pShadowFrame != NULL; pShadowFrame = pShadowFrame->pPrevious)
+    {
+        UInt32 * pGcSlots = pShadowFrame->pGcSlots;
+        UInt32 cGcSlots = pGcSlots[0];
+
+        for (UInt32 i = 1; i <= cGcSlots; i++)
+        {
+            UInt32 offset = pGcSlots[i] >> SHADOW_FRAME_SLOT_FLAG_BITS;
+            if (offset >= pShadowFrame->cbLive)
+                break;
+
+            PTR_RtuObjectRef pSlot = (PTR_RtuObjectRef)(pShadowFrame->pFrame + offset);
+            if (pGcSlots[i] & SHADOW_FRAME_SLOT_PINNED)
+            {
+                // Pinned locals are reported conservatively, which pins what they point to
+                RedhawkGCInterface::EnumGcRefsInRegionConservatively(pSlot, pSlot + 1, pfnEnumCallback, pvCallbackData);
+            }
+            else
+            {
+                GCRefKind kind = (pGcSlots[i] & SHADOW_FRAME_SLOT_INTERIOR) ? GCRK_Byref : GCRK_Object;
+                RedhawkGCInterface::EnumGcRef(pSlot, kind, pfnEnumCallback, pvCallbackData);
+            }
+        }
+    }
 }
 #endif
 
+// Used when multiple GC threads scan thread stacks concurrently: returns true if the calling GC thread is
+// the first to claim this thread during the given scan round (and hence must scan it).
+bool Thread::TryClaimForGcScan(UInt32 uScanRound)
+{
+    UInt32 uPrevRound = m_uGcScanRound;
+    if (uPrevRound == uScanRound)
+        return false;
+
+    return (UInt32)PalInterlockedCompareExchange((Int32 volatile *)&m_uGcScanRound, (Int32)uScanRound, (Int32)uPrevRound) == uPrevRound;
+}
+
+void Thread::BeginAllocContextUpdate()
+{
+    ASSERT(IsCurrentThread() && ((m_uAllocContextEpoch & 1) == 0));
+    m_uAllocContextEpoch++;
+    PalMemoryBarrier();
+}
+
+void Thread::EndAllocContextUpdate()
+{
+    ASSERT(IsCurrentThread() && ((m_uAllocContextEpoch & 1) != 0));
+    PalMemoryBarrier();
+    m_uAllocContextEpoch++;
+}
+
 void Thread::GcScanRoots(void * pfnEnumCallback, void * pvCallbackData)
 {
 #ifdef HOST_WASM
@@ -649,10 +781,26 @@ bool Thread::Hijack()
     return PalHijack(m_hPalThread, HijackCallback, this) == 0;
 }
 
+// Runs the callback with the context the thread is interrupted at, the way Hijack does, for the sampling
+// profiler. Threads in preemptive mode are not interrupted, their context isn't in managed code. On Unix the
+// callback runs asynchronously on the thread itself, from a signal handler.
+bool Thread::InterruptForSample(PalHijackCallback callback, void * pCallbackContext)
+{
+    ASSERT(ThreadStore::GetCurrentThread() != this);
+
+    if ((m_hPalThread == INVALID_HANDLE_VALUE) || (m_pTransitionFrame != NULL))
+        return false;
+
+    return PalHijack(m_hPalThread, callback, pCallbackContext) == 0;
+}
+
 UInt32_BOOL Thread::HijackCallback(HANDLE /*hThread*/, PAL_LIMITED_CONTEXT* pThreadContext, void* pCallbackContext)
 {
     Thread* pThread = (Thread*) pCallbackContext;
 
+    // Remembered for reporting threads that are slow to reach a safe point
+    pThread->m_pvSuspendIP = (PTR_VOID)pThreadContext->GetIp();
+
     //
     // WARNING: The hijack operation will take a read lock on the RuntimeInstance's module list.
     // (This is done to find a Module based on an IP.)  Therefore, if the thread we've just 
@@ -1082,6 +1230,14 @@ PTR_UInt8 Thread::GetThreadLocalStorageForDynamicType(UInt32 uTlsTypeOffset)
 }
 
 #ifndef DACCESS_COMPILE
+// Accounts for a thread statics table or storage block of cbAllocated bytes that replaces one of cbFreed bytes.
+void Thread::UpdateThreadStaticsMemory(UIntNative cbAllocated, UIntNative cbFreed)
+{
+    m_cbThreadStatics += cbAllocated - cbFreed;
+    NativeMemoryAdd(NativeMemoryKind_ThreadStatics, cbAllocated);
+    NativeMemoryRemove(NativeMemoryKind_ThreadStatics, cbFreed);
+}
+
 PTR_UInt8 Thread::AllocateThreadLocalStorageForDynamicType(UInt32 uTlsTypeOffset, UInt32 tlsStorageSize, UInt32 numTlsCells)
 {
     uTlsTypeOffset &= ~DYNAMIC_TYPE_TLS_OFFSET_FLAG;
@@ -1104,6 +1260,8 @@ PTR_UInt8 Thread::AllocateThreadLocalStorageForDynamicType(UInt32 uTlsTypeOffset
             delete[] m_pDynamicTypesTlsCells;
         }
 
+        UpdateThreadStaticsMemory(sizeof(PTR_UInt8) * numTlsCells, sizeof(PTR_UInt8) * m_numDynamicTypesTlsCells);
+
         m_pDynamicTypesTlsCells = pTlsCells;
         m_numDynamicTypesTlsCells = numTlsCells;
     }
@@ -1118,6 +1276,7 @@ PTR_UInt8 Thread::AllocateThreadLocalStorageForDynamicType(UInt32 uTlsTypeOffset
 
         // Initialize storage to 0's before returning it
         memset(pTlsStorage, 0, tlsStorageSize);
+        UpdateThreadStaticsMemory(tlsStorageSize, 0);
 
         m_pDynamicTypesTlsCells[uTlsTypeOffset] = pTlsStorage;
     }
@@ -1330,6 +1489,8 @@ Boolean Thread::SetThreadStaticStorageForModule(Object * pStorage, UInt32 module
             delete[] m_pThreadLocalModuleStatics;
         }
 
+        UpdateThreadStaticsMemory(sizeof(PTR_VOID) * newSize, sizeof(PTR_VOID) * m_numThreadLocalModuleStatics);
+
         m_pThreadLocalModuleStatics = pThreadLocalModuleStatics;
         m_numThreadLocalModuleStatics = newSize;
     }
@@ -73,7 +73,7 @@ struct ThreadBuffer
 #endif
     PTR_VOID                m_pHackPInvokeTunnel;                   // see Thread::EnablePreemptiveMode
     PTR_VOID                m_pCachedTransitionFrame;
-    PTR_Thread              m_pNext;                                // used by ThreadStore's SList<Thread>
+    PTR_Thread              m_pNext;                                // next thread in the ThreadStore's lists
     HANDLE                  m_hPalThread;                           // WARNING: this may legitimately be INVALID_HANDLE_VALUE
     void **                 m_ppvHijackedReturnAddressLocation;
     void *                  m_pvHijackedReturnAddress;
@@ -98,6 +98,19 @@ struct ThreadBuffer
 
     PTR_PTR_VOID    m_pThreadLocalModuleStatics;
     UInt32          m_numThreadLocalModuleStatics;
+
+#ifdef FEATURE_CACHED_INTERFACE_DISPATCH
+    UInt32 volatile m_uInterfaceDispatchEpoch;              // last discarded cache epoch this thread passed through
+#endif // FEATURE_CACHED_INTERFACE_DISPATCH
+    UInt32 volatile m_uGcScanRound;                         // last parallel stack scan round that claimed this thread
+    PTR_VOID        m_pAllocationSampler;                   // allocation sampling state, see AllocationSampling.cpp
+    PTR_VOID        m_pEventSessionBuffer;                  // events not yet handed to the writer, see EventSession.cpp
+    PTR_Thread      m_pPrev;                                // previous thread in the ThreadStore's thread list
+    PTR_VOID        m_pvSuspendIP;                          // where the thread was running at the last hijack attempt
+    UInt32          m_uSuspendRound;                        // last suspension in which the thread reached a safe point
+    UInt32          m_uSuspendWarningRound;                 // last suspension that reported the thread as slow
+    UInt32 volatile m_uAllocContextEpoch;                   // odd while the thread allocates through the GC, see BeginAllocContextUpdate
+    UIntNative      m_cbThreadStatics;                      // native memory of the thread statics tables and storage above, see NativeMemory.h
 };
 
 struct ReversePInvokeFrame
@@ -144,6 +157,7 @@ private:
     void CrossThreadUnhijack();
     void UnhijackWorker();
     void EnsureRuntimeInitialized();
+    void UpdateThreadStaticsMemory(UIntNative cbAllocated, UIntNative cbFreed);
 #ifdef _DEBUG
     bool DebugIsSuspended();
 #endif
@@ -169,6 +183,14 @@ public:
     bool                IsCurrentThread();
 
     void                GcScanRoots(void * pfnEnumCallback, void * pvCallbackData);
+    bool                TryClaimForGcScan(UInt32 uScanRound);
+
+    // Outside of GCs only the thread itself changes the limits of its alloc context, when it allocates through
+    // the GC. It brackets those calls with these so that other threads can read the context without
+    // suspending it.
+    void                BeginAllocContextUpdate();
+    void                EndAllocContextUpdate();
+    bool                TryGetUnusedAllocContextBytes(UIntNative * pcbUnused);
 #else
     typedef void GcScanRootsCallbackFunc(PTR_RtuObjectRef ppObject, void* token, UInt32 flags);
     bool GcScanRoots(GcScanRootsCallbackFunc * pfnCallback, void * token, PTR_PAL_LIMITED_CONTEXT pInitialContext);
@@ -176,6 +198,7 @@ public:
 
     bool                Hijack();
     void                Unhijack();
+    bool                InterruptForSample(PalHijackCallback callback, void * pCallbackContext);
 #ifdef FEATURE_GC_STRESS
     static void         HijackForGcStress(PAL_LIMITED_CONTEXT * pSuspendCtx);
 #endif // FEATURE_GC_STRESS
@@ -208,6 +231,12 @@ public:
     void                SetDetached();
 
     PTR_VOID            GetThreadStressLog() const;
+#ifndef DACCESS_COMPILE
+    void *              GetAllocationSampler();
+    void                SetAllocationSampler(void * pSampler);
+    void *              GetEventSessionBuffer();
+    void                SetEventSessionBuffer(void * pBuffer);
+#endif // DACCESS_COMPILE
 #ifndef DACCESS_COMPILE
     void                SetThreadStressLog(void * ptsl);
 #endif // DACCESS_COMPILE
@@ -220,6 +249,12 @@ public:
 
     bool                IsCurrentThreadInCooperativeMode();
 
+#ifdef FEATURE_CACHED_INTERFACE_DISPATCH
+    // Support for reclaiming discarded interface dispatch caches outside of a GC.
+    void                NoteInterfaceDispatchQuiescent(UInt32 uEpoch);
+    bool                IsInterfaceDispatchQuiescent(UInt32 uEpoch);
+#endif // FEATURE_CACHED_INTERFACE_DISPATCH
+
     PTR_VOID            GetTransitionFrameForStackTrace();
     void *              GetCurrentThreadPInvokeReturnAddress();
 
@@ -27,6 +27,9 @@
 
 #include "slist.inl"
 #include "GCMemoryHelpers.h"
+#include "RhConfig.h"
+#include "EventSession.h"
+#include "ICodeManager.h"
 
 #include "Debug.h"
 #include "DebugEventSource.h"
@@ -43,7 +46,8 @@ ThreadStore * GetThreadStore()
 
 ThreadStore::Iterator::Iterator() :
     m_readHolder(&GetThreadStore()->m_Lock),
-    m_pCurrentPosition(GetThreadStore()->m_ThreadList.GetHead())
+    m_pCurrentPosition(GetThreadStore()->m_pThreadListHead),
+    m_pNewThreads(GetThreadStore()->m_pNewThreads)
 {
 }
 
@@ -54,6 +58,14 @@ ThreadStore::Iterator::~Iterator()
 PTR_Thread ThreadStore::Iterator::GetNext()
 {
     PTR_Thread pResult = m_pCurrentPosition;
+    if (NULL == pResult)
+    {
+        // Threads pushed on the new threads list after the iterator was created are not walked. They attached
+        // after any suspension that is in progress started, so they can't be running managed code.
+        pResult = m_pNewThreads;
+        m_pNewThreads = NULL;
+    }
+
     if (NULL != pResult)
         m_pCurrentPosition = pResult->m_pNext;
     return pResult;
@@ -69,7 +81,11 @@ PTR_Thread ThreadStore::GetSuspendingThread()
 
 
 ThreadStore::ThreadStore() : 
-    m_ThreadList(),
+    m_pThreadListHead(NULL),
+    m_pNewThreads(NULL),
+    m_uSuspendRound(0),
+    m_suspendTicksPerMicrosecond(1),
+    m_suspendWarningThreshold(0),
     m_Lock(true /* writers (i.e. attaching/detaching threads) should wait on GC event */)
 {
     SaveCurrentThreadOffsetForDAC();
@@ -91,6 +107,12 @@ ThreadStore * ThreadStore::Create(RuntimeInstance * pRuntimeInstance)
 
     pNewThreadStore->m_pRuntimeInstance = pRuntimeInstance;
 
+    LARGE_INTEGER frequency;
+    if (PalQueryPerformanceFrequency(&frequency) && (frequency.QuadPart >= 1000000))
+        pNewThreadStore->m_suspendTicksPerMicrosecond = (UInt64)frequency.QuadPart / 1000000;
+    pNewThreadStore->m_suspendWarningThreshold = (UInt64)g_pRhConfig->GetSuspendWarningThreshold() * 1000;
+    memset(&pNewThreadStore->m_suspensionStats, 0, sizeof(SuspensionStats));
+
     pNewThreadStore.SuppressRelease();
     return pNewThreadStore;
 }
@@ -100,6 +122,46 @@ void ThreadStore::Destroy()
     delete this;
 }
 
+void ThreadStore::LinkThread(Thread * pThread)
+{
+    pThread->m_pPrev = NULL;
+    pThread->m_pNext = m_pThreadListHead;
+    if (m_pThreadListHead != NULL)
+        m_pThreadListHead->m_pPrev = pThread;
+    m_pThreadListHead = pThread;
+}
+
+void ThreadStore::UnlinkThread(Thread * pThread)
+{
+    if (pThread->m_pPrev != NULL)
+    {
+        pThread->m_pPrev->m_pNext = pThread->m_pNext;
+    }
+    else
+    {
+        ASSERT(m_pThreadListHead == pThread);
+        m_pThreadListHead = pThread->m_pNext;
+    }
+
+    if (pThread->m_pNext != NULL)
+        pThread->m_pNext->m_pPrev = pThread->m_pPrev;
+
+    pThread->m_pNext = NULL;
+    pThread->m_pPrev = NULL;
+}
+
+void ThreadStore::LinkNewThreads()
+{
+    // Attaching threads keep pushing while we move the list, they end up on the emptied one.
+    Thread * pNewThread = (Thread *)PalInterlockedExchangePointer((void * volatile *)&m_pNewThreads, NULL);
+    while (pNewThread != NULL)
+    {
+        Thread * pNext = pNewThread->m_pNext;
+        LinkThread(pNewThread);
+        pNewThread = pNext;
+    }
+}
+
 // static 
 void ThreadStore::AttachCurrentThread(bool fAcquireThreadStoreLock)
 {
@@ -127,6 +189,25 @@ void ThreadStore::AttachCurrentThread(bool fAcquireThreadStoreLock)
     pAttachingThread->Construct();
     ASSERT(pAttachingThread->m_ThreadStateFlags == Thread::TSF_Unknown);
 
+    ThreadStore* pTS = GetThreadStore();
+
+    // If no suspension is in progress, push the thread without taking the lock. A suspension that starts
+    // concurrently either sees the thread on the new threads list, or it set RhpTrapThreads before the push 
+    // was visible, and then the thread sees the trap before it enters cooperative mode the first time.
+    if (fAcquireThreadStoreLock && (RhpTrapThreads == (UInt32)TrapThreadsFlags::None))
+    {
+        pAttachingThread->m_ThreadStateFlags = Thread::TSF_Attached;
+
+        Thread * pHead;
+        do
+        {
+            pHead = pTS->m_pNewThreads;
+            pAttachingThread->m_pNext = pHead;
+        } while (PalInterlockedCompareExchangePointer((void * volatile *)&pTS->m_pNewThreads, pAttachingThread, pHead) != pHead);
+
+        return;
+    }
+
     // The runtime holds the thread store lock for the duration of thread suspension for GC, so let's check to 
     // see if that's going on and, if so, use a proper wait instead of the RWL's spinning.  NOTE: when we are 
     // called with fAcquireThreadStoreLock==false, we are being called in a situation where the GC is trying to 
@@ -134,7 +215,6 @@ void ThreadStore::AttachCurrentThread(bool fAcquireThreadStoreLock)
     if (fAcquireThreadStoreLock && (RhpTrapThreads != (UInt32)TrapThreadsFlags::None))
         RedhawkGCInterface::WaitForGCCompletion();
 
-    ThreadStore* pTS = GetThreadStore();
     ReaderWriterLock::WriteHolder write(&pTS->m_Lock, fAcquireThreadStoreLock);
 
     //
@@ -143,7 +223,7 @@ void ThreadStore::AttachCurrentThread(bool fAcquireThreadStoreLock)
     ASSERT(pAttachingThread->m_ThreadStateFlags == Thread::TSF_Unknown);
     pAttachingThread->m_ThreadStateFlags = Thread::TSF_Attached;
 
-    pTS->m_ThreadList.PushHead(pAttachingThread);
+    pTS->LinkThread(pAttachingThread);
 }
 
 // static 
@@ -176,8 +256,10 @@ void ThreadStore::DetachCurrentThread()
 
     ThreadStore* pTS = GetThreadStore();
     ReaderWriterLock::WriteHolder write(&pTS->m_Lock);
-    ASSERT(rh::std::count(pTS->m_ThreadList.Begin(), pTS->m_ThreadList.End(), pDetachingThread) == 1);
-    pTS->m_ThreadList.RemoveFirst(pDetachingThread);
+
+    // The detaching thread may still be on the new threads list, which can't be unlinked from.
+    pTS->LinkNewThreads();
+    pTS->UnlinkThread(pDetachingThread);
     pDetachingThread->Destroy();
 }
 
@@ -202,6 +284,102 @@ void ThreadStore::UnlockThreadStore()
     m_Lock.ReleaseReadLock();
 }
 
+static UInt64 GetSuspendTimeStamp()
+{
+    LARGE_INTEGER timeStamp;
+    PalQueryPerformanceCounter(&timeStamp);
+    return (UInt64)timeStamp.QuadPart;
+}
+
+// Only the suspending thread updates the statistics, and there is one at a time.
+void ThreadStore::RecordTimeToSuspend(UInt64 microseconds)
+{
+    UInt32 iBucket = 0;
+    while ((iBucket < SUSPENSION_HISTOGRAM_BUCKETS - 1) && (microseconds >= ((UInt64)1 << iBucket)))
+        iBucket++;
+
+    m_suspensionStats.m_rgTimeToSuspend[iBucket]++;
+    if (microseconds > m_suspensionStats.m_maxTimeToSuspend)
+        m_suspensionStats.m_maxTimeToSuspend = microseconds;
+}
+
+void ThreadStore::ReportSlowSuspension(Thread * pThread, UInt64 microseconds)
+{
+    m_suspensionStats.m_cSlowThreadWarnings++;
+
+    PTR_VOID pvIP = pThread->m_pvSuspendIP;
+    PTR_VOID pvMethodStart = NULL;
+
+    ICodeManager * pCodeManager = GetRuntimeInstance()->FindCodeManagerByAddress(pvIP);
+    if (pCodeManager != NULL)
+    {
+        MethodInfo methodInfo;
+        if (pCodeManager->FindMethodInfo(pvIP, &methodInfo))
+            pvMethodStart = pCodeManager->GetMethodStartAddress(&methodInfo);
+    }
+
+    STRESS_LOG4(LF_GC, LL_WARNING, "Thread %p (ID = %x) has not reached a safe point after %d us, IP = %p\n",
+        pThread, (size_t)pThread->GetPalThreadIdForLogging(), (size_t)microseconds, pvIP);
+
+    if (IsEventSessionEnabled(EVENT_SESSION_KEYWORD_SUSPENSION))
+    {
+        EventSessionSlowSuspension payload;
+        payload.ThreadId = pThread->GetPalThreadIdForLogging();
+        payload.IP = (UInt64)dac_cast<TADDR>(pvIP);
+        payload.MethodStart = (UInt64)dac_cast<TADDR>(pvMethodStart);
+        payload.ElapsedMicroseconds = microseconds;
+        WriteEventSessionEvent(EventSessionEvent_SlowSuspension, &payload, sizeof(payload));
+    }
+}
+
+void ThreadStore::GetSuspensionStats(SuspensionStats * pStats)
+{
+    *pStats = m_suspensionStats;
+}
+
+// Returns how long threads took to reach a safe point in the suspensions so far.
+COOP_PINVOKE_HELPER(void, RhGetSuspensionStats, (SuspensionStats * pStats))
+{
+    GetThreadStore()->GetSuspensionStats(pStats);
+}
+
+// Returns true if pTargetThread is at a safe point, otherwise hijacks it to drive it to one.
+bool ThreadStore::PollThreadForSuspend(Thread * pTargetThread, UInt32 uSuspendRound, UInt64 elapsed)
+{
+    if (!pTargetThread->CacheTransitionFrameForSuspend())
+    {
+        // We drive all threads to preemptive mode by hijacking them with both a
+        // return-address hijack and loop hijacks.
+        pTargetThread->Hijack();
+
+        if ((m_suspendWarningThreshold != 0) && (elapsed >= m_suspendWarningThreshold) &&
+            (pTargetThread->m_uSuspendWarningRound != uSuspendRound))
+        {
+            pTargetThread->m_uSuspendWarningRound = uSuspendRound;
+            ReportSlowSuspension(pTargetThread, elapsed);
+        }
+
+        return false;
+    }
+
+    if (pTargetThread->DangerousCrossThreadIsHijacked())
+    {
+        // Once a thread is safely in preemptive mode, we must wait until it is also 
+        // unhijacked.  This is done because, otherwise, we might race on into the 
+        // stackwalk and find the hijack still on the stack, which will cause the 
+        // stackwalking code to crash.
+        return false;
+    }
+
+    if (pTargetThread->m_uSuspendRound != uSuspendRound)
+    {
+        pTargetThread->m_uSuspendRound = uSuspendRound;
+        RecordTimeToSuspend(elapsed);
+    }
+
+    return true;
+}
+
 void ThreadStore::SuspendAllThreads(bool waitForGCEvent)
 {
     ThreadStore::SuspendAllThreads(waitForGCEvent, /* fireDebugEvent = */ true);
@@ -246,33 +424,56 @@ void ThreadStore::SuspendAllThreads(bool waitForGCEvent, bool fireDebugEvent)
     // reason for this is that we essentially implement Dekker's algorithm, which requires write ordering.
     PalFlushProcessWriteBuffers();
 
+    // Threads are timed from here, the time of each is when it is first seen at a safe point.
+    UInt32 uSuspendRound = ++m_uSuspendRound;
+    UInt64 startTimeStamp = GetSuspendTimeStamp();
+    m_suspensionStats.m_cSuspensions++;
+
+    // A thread that is at a safe point can't leave it before the suspension ends, it would see RhpTrapThreads
+    // and wait. So after the first pass over all threads only the ones that were still running managed code
+    // are polled again, unless there were too many of them to remember.
+    Thread * rgPendingThreads[SUSPEND_MAX_PENDING_THREADS];
+    UInt32 cPendingThreads = 0;
+    bool fPollAllThreads = true;
+
     bool keepWaiting;
     YieldProcessorNormalizationInfo normalizationInfo;
     do
     {
         keepWaiting = false;
-        FOREACH_THREAD(pTargetThread)
+        UInt64 elapsed = (GetSuspendTimeStamp() - startTimeStamp) / m_suspendTicksPerMicrosecond;
+        if (fPollAllThreads)
         {
-            if (pTargetThread == pThisThread)
-                continue;
-
-            if (!pTargetThread->CacheTransitionFrameForSuspend())
+            fPollAllThreads = false;
+            cPendingThreads = 0;
+            FOREACH_THREAD(pTargetThread)
             {
-                // We drive all threads to preemptive mode by hijacking them with both a
-                // return-address hijack and loop hijacks.
-                keepWaiting = true;
-                pTargetThread->Hijack();
+                if (pTargetThread == pThisThread)
+                    continue;
+
+                if (!PollThreadForSuspend(pTargetThread, uSuspendRound, elapsed))
+                {
+                    keepWaiting = true;
+                    if (cPendingThreads < COUNTOF(rgPendingThreads))
+                        rgPendingThreads[cPendingThreads++] = pTargetThread;
+                    else
+                        fPollAllThreads = true;
+                }
             }
-            else if (pTargetThread->DangerousCrossThreadIsHijacked())
+            END_FOREACH_THREAD
+        }
+        else
+        {
+            // The thread store lock is held for the whole suspension, so the pending threads can't go away.
+            UInt32 cStillPending = 0;
+            for (UInt32 i = 0; i < cPendingThreads; i++)
             {
-                // Once a thread is safely in preemptive mode, we must wait until it is also 
-                // unhijacked.  This is done because, otherwise, we might race on into the 
-                // stackwalk and find the hijack still on the stack, which will cause the 
-                // stackwalking code to crash.
-                keepWaiting = true;
+                if (!PollThreadForSuspend(rgPendingThreads[i], uSuspendRound, elapsed))
+                    rgPendingThreads[cStillPending++] = rgPendingThreads[i];
             }
+            cPendingThreads = cStillPending;
+            keepWaiting = (cStillPending != 0);
         }
-        END_FOREACH_THREAD
 
         if (keepWaiting)
         {
@@ -283,9 +484,8 @@ void ThreadStore::SuspendAllThreads(bool waitForGCEvent, bool fireDebugEvent)
                 // to make forward progress.  
                 // Note that we do not call Sleep, because the minimum granularity of Sleep is much
                 // too long (we probably don't need a 15ms wait here).  Instead, we'll just burn some
-                // cycles.
-    	        // @TODO: need tuning for spin
-                YieldProcessorNormalizedForPreSkylakeCount(normalizationInfo, 10000);
+                // cycles, about as many as 10000 yields took on the processors the wait was tuned on.
+                YieldProcessorNormalizedForDuration(normalizationInfo, SUSPEND_SPIN_DURATION_NS);
             }
         }
 
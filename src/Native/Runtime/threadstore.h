@@ -7,6 +7,27 @@ class RuntimeInstance;
 class Array;
 typedef DPTR(RuntimeInstance) PTR_RuntimeInstance;
 
+// Distribution of the time threads take to reach a safe point once a suspension starts, returned by
+// RhGetSuspensionStats. Bucket i counts the threads that took less than 2^i microseconds and at least half of
+// that, the last one counts all the slower ones. Times are measured when the suspending thread observes a
+// thread at a safe point, so they are rounded up to the suspending thread's polling interval.
+#define SUSPENSION_HISTOGRAM_BUCKETS    24
+
+// Number of threads still running managed code after the first pass of a suspension that are polled without
+// walking all the threads again
+#define SUSPEND_MAX_PENDING_THREADS     256
+
+// Nanoseconds the suspending thread spins between polls when no other thread is ready to run on its processor
+#define SUSPEND_SPIN_DURATION_NS        50000
+
+struct SuspensionStats
+{
+    UInt64  m_cSuspensions;                                         // Calls to SuspendAllThreads
+    UInt64  m_cSlowThreadWarnings;                                  // Threads reported over SuspendWarningThreshold
+    UInt64  m_maxTimeToSuspend;                                     // Slowest thread, in microseconds
+    UInt64  m_rgTimeToSuspend[SUSPENSION_HISTOGRAM_BUCKETS];        // Threads indexed by log2(microseconds) + 1
+};
+
 enum class TrapThreadsFlags
 {
     None = 0,
@@ -16,10 +37,18 @@ enum class TrapThreadsFlags
 
 class ThreadStore
 {
-    SList<Thread>       m_ThreadList;
+    // The attached threads are linked through Thread::m_pNext and Thread::m_pPrev so that a detaching thread
+    // can unlink itself without searching the list. Threads that attach while no suspension is in progress
+    // are pushed on m_pNewThreads without taking the lock, and moved to m_pThreadListHead by the next writer.
+    PTR_Thread          m_pThreadListHead;
+    PTR_Thread          m_pNewThreads;
     PTR_RuntimeInstance m_pRuntimeInstance;
     CLREventStatic      m_SuspendCompleteEvent;
     ReaderWriterLock    m_Lock;
+    UInt32              m_uSuspendRound;
+    UInt64              m_suspendTicksPerMicrosecond;
+    UInt64              m_suspendWarningThreshold;                  // microseconds, 0 if warnings are disabled
+    SuspensionStats     m_suspensionStats;
 
 private:
     ThreadStore();
@@ -28,11 +57,23 @@ private:
     void                    UnlockThreadStore();
     void                    SuspendAllThreads(bool waitForGCEvent, bool fireDebugEvent);
 
+#ifndef DACCESS_COMPILE
+    bool                    PollThreadForSuspend(Thread * pTargetThread, UInt32 uSuspendRound, UInt64 elapsed);
+    void                    RecordTimeToSuspend(UInt64 microseconds);
+    void                    ReportSlowSuspension(Thread * pThread, UInt64 microseconds);
+
+    // These require the thread store lock to be held for writing
+    void                    LinkThread(Thread * pThread);
+    void                    UnlinkThread(Thread * pThread);
+    void                    LinkNewThreads();
+#endif
+
 public:
     class Iterator
     {
         ReaderWriterLock::ReadHolder    m_readHolder;
         PTR_Thread                      m_pCurrentPosition;
+        PTR_Thread                      m_pNewThreads;          // new threads still to walk after the list
     public:
         Iterator();
         ~Iterator();
@@ -62,6 +103,7 @@ public:
     void        ResumeAllThreads(bool waitForGCEvent);
 
     static bool IsTrapThreadsRequested();
+    void        GetSuspensionStats(SuspensionStats * pStats);
     void        WaitForSuspendComplete();
 };
 typedef DPTR(ThreadStore) PTR_ThreadStore;
@@ -11,6 +11,9 @@
 #include "UnixContext.h"
 
 #include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
 #include "HardwareExceptions.h"
 
 #if !HAVE_SIGINFO_T
@@ -47,14 +50,24 @@
 #define EXCEPTION_CONTINUE_SEARCH (0)
 #define EXCEPTION_EXECUTE_HANDLER (1)
 
+#ifdef SIGRTMIN
+#define INJECT_ACTIVATION_SIGNAL SIGRTMIN
+#else
+#define INJECT_ACTIVATION_SIGNAL SIGUSR1
+#endif
+
 struct sigaction g_previousSIGSEGV;
 struct sigaction g_previousSIGFPE;
+struct sigaction g_previousActivation;
 
 typedef void (*SignalHandler)(int code, siginfo_t *siginfo, void *context);
 
 // Exception handler for hardware exceptions
 static PHARDWARE_EXCEPTION_HANDLER g_hardwareExceptionHandler = NULL;
 
+// Function invoked on a thread that was interrupted by the activation injection signal
+static PACTIVATION_FUNCTION g_activationFunction = NULL;
+
 #ifdef HOST_AMD64
 
 // Get value of an instruction operand represented by the ModR/M field
@@ -520,8 +533,10 @@ bool HardwareExceptionHandler(int code, siginfo_t *siginfo, void *context, void*
         }
 #endif //HOST_AMD64
 
+        // The handler only looks at and changes the control registers, and RedirectNativeContext only writes
+        // those back. RhpThrowHwEx captures the rest of the registers itself once the signal handler returns.
         PAL_LIMITED_CONTEXT palContext;
-        NativeContextToPalContext(context, &palContext);
+        NativeContextToPalContextControlRegs(context, &palContext);
 
         UIntNative arg0Reg;
         UIntNative arg1Reg;
@@ -640,6 +655,51 @@ bool InitializeHardwareExceptionHandling()
     return true;
 }
 
+// Handler for the activation injection signal
+void ActivationHandler(int code, siginfo_t *siginfo, void *context)
+{
+    // Only accept activations sent by the current process
+    if ((g_activationFunction != NULL) && (siginfo->si_pid == getpid()))
+    {
+        // The interrupted code may be inspecting errno, so make sure the activation doesn't modify it
+        int savedErrNo = errno;
+
+        PAL_LIMITED_CONTEXT palContext;
+        NativeContextToPalContext(context, &palContext);
+
+        g_activationFunction(&palContext);
+
+        errno = savedErrNo;
+    }
+    else if (g_previousActivation.sa_flags & SA_SIGINFO)
+    {
+        if (g_previousActivation.sa_sigaction != NULL)
+        {
+            g_previousActivation.sa_sigaction(code, siginfo, context);
+        }
+    }
+    else if ((g_previousActivation.sa_handler != SIG_DFL) && (g_previousActivation.sa_handler != SIG_IGN))
+    {
+        g_previousActivation.sa_handler(code);
+    }
+}
+
+// Initialize the signal used to inject activations into threads
+bool InitializeActivationInjection(PACTIVATION_FUNCTION activationFunction)
+{
+    ASSERT_MSG(g_activationFunction == NULL, "Activation function already set");
+    g_activationFunction = activationFunction;
+
+    return AddSignalHandler(INJECT_ACTIVATION_SIGNAL, ActivationHandler, &g_previousActivation);
+}
+
+// Interrupt the specified thread and run the activation function on it
+bool InjectActivation(pthread_t thread)
+{
+    // This can fail with ESRCH when the target thread has already exited
+    return pthread_kill(thread, INJECT_ACTIVATION_SIGNAL) == 0;
+}
+
 // Set CoreRT hardware exception handler
 REDHAWK_PALEXPORT void REDHAWK_PALAPI PalSetHardwareExceptionHandler(PHARDWARE_EXCEPTION_HANDLER handler)
 {
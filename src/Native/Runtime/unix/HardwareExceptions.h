@@ -8,4 +8,14 @@
 // Initialize hardware exception handling
 bool InitializeHardwareExceptionHandling();
 
+// Function invoked on a thread interrupted by an injected activation. The context describes the
+// state of the thread at the point where it was interrupted.
+typedef void (*PACTIVATION_FUNCTION)(PAL_LIMITED_CONTEXT* palContext);
+
+// Initialize the signal used to inject activations into threads
+bool InitializeActivationInjection(PACTIVATION_FUNCTION activationFunction);
+
+// Interrupt the specified thread and run the activation function on it
+bool InjectActivation(pthread_t thread);
+
 #endif // __HARDWARE_EXCEPTIONS_H__
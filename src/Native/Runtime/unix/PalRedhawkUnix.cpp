@@ -16,6 +16,7 @@
 #include "gcenv.h"
 #include "holder.h"
 #include "HardwareExceptions.h"
+#include "rseqcpu.h"
 
 #include <unistd.h>
 #include <sched.h>
@@ -73,6 +74,15 @@
 static mach_timebase_info_data_t s_TimebaseInfo;
 #endif
 
+#if HAVE_LINUX_FUTEX
+#include <linux/futex.h>
+#include <limits.h>
+#endif // HAVE_LINUX_FUTEX
+
+#if HAVE_LINUX_MEMBARRIER
+#include <linux/membarrier.h>
+#endif // HAVE_LINUX_MEMBARRIER
+
 using std::nullptr_t;
 
 #ifndef __APPLE__
@@ -141,8 +151,23 @@ static uint8_t g_helperPage[OS_PAGE_SIZE] __attribute__((aligned(OS_PAGE_SIZE)))
 // Mutex to make the FlushProcessWriteBuffersMutex thread safe
 pthread_mutex_t g_flushProcessWriteBuffersMutex;
 
+#if HAVE_LINUX_MEMBARRIER
+// Set when the kernel supports private expedited membarrier, which only interrupts the processors
+// running threads of this process, and FlushProcessWriteBuffers uses it instead of the helper page
+static bool s_flushUsingMemBarrier = false;
+#endif // HAVE_LINUX_MEMBARRIER
+
+#if defined(__linux__) && (defined(HOST_X86) || defined(HOST_AMD64))
+#define FEATURE_TSC_CLOCK
+// Ticks per second of the time stamp counter, 0 when QueryPerformanceCounter can't use it
+static int64_t s_tscFrequency = 0;
+// Added to the time stamp counter so that QueryPerformanceCounter has the same origin as CLOCK_MONOTONIC
+static int64_t s_tscOffset = 0;
+#endif
+
 bool QueryLogicalProcessorCount();
 bool InitializeFlushProcessWriteBuffers();
+void InitializeTscClock();
 
 extern "C" void RaiseFailFastException(PEXCEPTION_RECORD arg1, PCONTEXT arg2, UInt32 arg3)
 {
@@ -187,6 +212,158 @@ public:
     }
 };
 
+#if HAVE_LINUX_FUTEX
+
+// FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout, so a wait that wakes up spuriously can go back
+// to sleep without recomputing the remaining time.
+static int FutexWait(volatile int32_t* address, int32_t expectedValue, const timespec* endTime)
+{
+    return (int)syscall(SYS_futex, address, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, expectedValue, endTime, NULL, FUTEX_BITSET_MATCH_ANY);
+}
+
+static void FutexWake(volatile int32_t* address, int32_t count)
+{
+    syscall(SYS_futex, address, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, count, NULL, NULL, 0);
+}
+
+// Threads waiting on several events at once sleep on a single futex that every Set bumps while there are
+// such waiters, then look at the state of each of their events. Waits on a single event don't use it.
+static volatile int32_t s_multipleObjectWaitSequence = 0;
+static volatile int32_t s_multipleObjectWaiterCount = 0;
+
+static void NotifyMultipleObjectWaiters()
+{
+    if (__atomic_load_n(&s_multipleObjectWaiterCount, __ATOMIC_SEQ_CST) != 0)
+    {
+        __atomic_add_fetch(&s_multipleObjectWaitSequence, 1, __ATOMIC_SEQ_CST);
+        FutexWake(&s_multipleObjectWaitSequence, INT_MAX);
+    }
+}
+
+// Event built directly on a futex. Setting, resetting and waiting on a signaled event are single atomic
+// operations, and the kernel is only entered to block or to wake threads that actually wait.
+class UnixEvent
+{
+    volatile int32_t m_state;           // 1 when the event is signaled, 0 otherwise; waiters sleep on it
+    volatile int32_t m_waiterCount;     // Number of threads that are about to block or are blocked on m_state
+    bool m_manualReset;
+
+    bool TryConsumeState()
+    {
+        if (m_manualReset)
+        {
+            return __atomic_load_n(&m_state, __ATOMIC_ACQUIRE) != 0;
+        }
+
+        // Clear the state for auto-reset events so that only one waiter gets released
+        int32_t expected = 1;
+        return __atomic_compare_exchange_n(&m_state, &expected, 0, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+    }
+
+public:
+
+    UnixEvent(bool manualReset, bool initialState)
+    : m_state(initialState ? 1 : 0),
+      m_waiterCount(0),
+      m_manualReset(manualReset)
+    {
+    }
+
+    bool Initialize()
+    {
+        return true;
+    }
+
+    bool Destroy()
+    {
+        return true;
+    }
+
+    // Consumes the state if the event is signaled, without blocking
+    bool TryWait()
+    {
+        return TryConsumeState();
+    }
+
+    uint32_t Wait(uint32_t milliseconds)
+    {
+        timespec endTime;
+        if (milliseconds != INFINITE)
+        {
+            clock_gettime(CLOCK_MONOTONIC, &endTime);
+            TimeSpecAdd(&endTime, milliseconds);
+        }
+
+        while (!TryConsumeState())
+        {
+            // Announce the waiter before sleeping. Set publishes the state before it looks at the count, so
+            // either Set sees this waiter and wakes it, or the futex sees the state already set and doesn't
+            // block.
+            __atomic_add_fetch(&m_waiterCount, 1, __ATOMIC_SEQ_CST);
+            int st = FutexWait(&m_state, 0, (milliseconds != INFINITE) ? &endTime : NULL);
+            int error = (st == 0) ? 0 : errno;
+            __atomic_sub_fetch(&m_waiterCount, 1, __ATOMIC_SEQ_CST);
+
+            if (error == ETIMEDOUT)
+            {
+                // The event may have been set right as the wait timed out
+                return TryConsumeState() ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
+            }
+
+            if ((error != 0) && (error != EAGAIN) && (error != EINTR))
+            {
+                return WAIT_FAILED;
+            }
+        }
+
+        return WAIT_OBJECT_0;
+    }
+
+    void Set()
+    {
+        // If the event was already signaled, every blocked waiter has already been woken by the Set that
+        // signaled it.
+        if (__atomic_exchange_n(&m_state, 1, __ATOMIC_SEQ_CST) != 0)
+        {
+            return;
+        }
+
+        if (__atomic_load_n(&m_waiterCount, __ATOMIC_SEQ_CST) != 0)
+        {
+            // An auto-reset event only releases one waiter, so waking the others would just make them go
+            // back to sleep.
+            FutexWake(&m_state, m_manualReset ? INT_MAX : 1);
+        }
+
+        NotifyMultipleObjectWaiters();
+    }
+
+    void Reset()
+    {
+        __atomic_store_n(&m_state, 0, __ATOMIC_RELEASE);
+    }
+};
+
+#else // HAVE_LINUX_FUTEX
+
+// Threads waiting on several events at once wait on a single condition that every Set broadcasts while there
+// are such waiters, then look at the state of each of their events. Waits on a single event don't use it.
+static pthread_mutex_t s_multipleObjectWaitMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_multipleObjectWaitCondition = PTHREAD_COND_INITIALIZER;
+static uint32_t s_multipleObjectWaitSequence = 0;
+static volatile int32_t s_multipleObjectWaiterCount = 0;
+
+static void NotifyMultipleObjectWaiters()
+{
+    if (__atomic_load_n(&s_multipleObjectWaiterCount, __ATOMIC_SEQ_CST) != 0)
+    {
+        pthread_mutex_lock(&s_multipleObjectWaitMutex);
+        s_multipleObjectWaitSequence++;
+        pthread_mutex_unlock(&s_multipleObjectWaitMutex);
+        pthread_cond_broadcast(&s_multipleObjectWaitCondition);
+    }
+}
+
 class UnixEvent
 {
     pthread_cond_t m_condition;
@@ -266,6 +443,20 @@ public:
         return success;
     }
 
+    // Consumes the state if the event is signaled, without blocking
+    bool TryWait()
+    {
+        pthread_mutex_lock(&m_mutex);
+        bool signaled = m_state;
+        if (signaled && !m_manualReset)
+        {
+            m_state = false;
+        }
+        pthread_mutex_unlock(&m_mutex);
+
+        return signaled;
+    }
+
     uint32_t Wait(uint32_t milliseconds)
     {
         timespec endTime;
@@ -367,6 +558,8 @@ public:
 
         // Unblock all threads waiting for the condition variable
         pthread_cond_broadcast(&m_condition);
+
+        NotifyMultipleObjectWaiters();
     }
 
     void Reset()
@@ -377,6 +570,8 @@ public:
     }
 };
 
+#endif // HAVE_LINUX_FUTEX
+
 class EventUnixHandle : public UnixHandle<UnixHandleType::Event, UnixEvent>
 {
 public:
@@ -391,7 +586,68 @@ public:
     }
 };
 
-typedef UnixHandle<UnixHandleType::Thread, pthread_t> ThreadUnixHandle;
+class FileUnixHandle : public UnixHandle<UnixHandleType::File, int>
+{
+public:
+    FileUnixHandle(int fd)
+    : UnixHandle<UnixHandleType::File, int>(fd)
+    {
+    }
+
+    virtual bool Destroy()
+    {
+        return close(m_object) == 0;
+    }
+};
+
+typedef UInt32 (__stdcall *HijackCallback)(HANDLE hThread, _In_ PAL_LIMITED_CONTEXT* pThreadContext, _In_opt_ void* pCallbackContext);
+
+class ThreadUnixHandle : public UnixHandle<UnixHandleType::Thread, pthread_t>
+{
+    // Callback requested by the most recent PalHijack of this thread. It is invoked on the thread
+    // itself from the activation signal handler.
+    HijackCallback m_hijackCallback;
+    void* m_pHijackCallbackContext;
+
+public:
+    ThreadUnixHandle(pthread_t thread)
+    : UnixHandle<UnixHandleType::Thread, pthread_t>(thread),
+      m_hijackCallback(NULL),
+      m_pHijackCallbackContext(NULL)
+    {
+    }
+
+    void SetHijackCallback(HijackCallback callback, void* pCallbackContext)
+    {
+        m_pHijackCallbackContext = pCallbackContext;
+        m_hijackCallback = callback;
+    }
+
+    void InvokeHijackCallback(PAL_LIMITED_CONTEXT* pThreadContext)
+    {
+        HijackCallback callback = m_hijackCallback;
+        if (callback != NULL)
+        {
+            callback(this, pThreadContext, m_pHijackCallbackContext);
+        }
+    }
+};
+
+// Handle of the current thread created by DuplicateHandle. The activation signal handler uses it
+// to find the hijack callback of the interrupted thread.
+static __thread ThreadUnixHandle* tls_pCurrentThreadHandle = NULL;
+
+#ifndef USE_PORTABLE_HELPERS
+// Invoked on a thread interrupted by the activation signal sent from PalHijack
+static void HijackActivationFunction(PAL_LIMITED_CONTEXT* palContext)
+{
+    ThreadUnixHandle* threadHandle = tls_pCurrentThreadHandle;
+    if (threadHandle != NULL)
+    {
+        threadHandle->InvokeHijackCallback(palContext);
+    }
+}
+#endif // !USE_PORTABLE_HELPERS
 
 #if !HAVE_THREAD_LOCAL
 extern "C" int __cxa_thread_atexit(void (*)(void*), void*, void *);
@@ -432,11 +688,19 @@ REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalInit()
     {
         return false;
     }
+
+    InitializeTscClock();
+
 #ifndef USE_PORTABLE_HELPERS
     if (!InitializeHardwareExceptionHandling())
     {
         return false;
     }
+
+    if (!InitializeActivationInjection(HijackActivationFunction))
+    {
+        return false;
+    }
 #endif // !USE_PORTABLE_HELPERS
 
     ConfigureSignals();
@@ -510,14 +774,113 @@ extern "C" bool PalDetachThread(void* thread)
 }
 
 #if !defined(USE_PORTABLE_HELPERS) && !defined(FEATURE_RX_THUNKS)
+
+// Shared memory object holding a copy of the thunks template. Every thunks mapping maps this object as
+// its executable stubs section, so the stubs are written once and never mapped writable.
+static int g_thunksTemplateFd = -1;
+static size_t g_thunksTemplateSize = 0;
+
+// Create an anonymous shared memory object of the specified size. Returns -1 on failure.
+static int CreateAnonymousSharedMemory(size_t size)
+{
+    int fd;
+#if HAVE_MEMFD_CREATE
+    fd = memfd_create("corert-thunks", MFD_CLOEXEC);
+#else // HAVE_MEMFD_CREATE
+    char name[64];
+    snprintf(name, sizeof(name), "/corert-thunks-%d-%p", getpid(), &g_thunksTemplateFd);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+    if (fd != -1)
+    {
+        // The object only needs to live as long as the descriptor is open
+        shm_unlink(name);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+#endif // HAVE_MEMFD_CREATE
+
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    if (ftruncate(fd, size) == -1)
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Create the shared memory object with a copy of the thunks template
+static int CreateThunksTemplateFd(void* pTemplate, size_t templateSize)
+{
+    int fd = CreateAnonymousSharedMemory(templateSize);
+    if (fd == -1)
+    {
+        return -1;
+    }
+
+    void* pTemplateView = mmap(NULL, templateSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (pTemplateView == MAP_FAILED)
+    {
+        close(fd);
+        return -1;
+    }
+
+    memcpy(pTemplateView, pTemplate, templateSize);
+    munmap(pTemplateView, templateSize);
+
+    return fd;
+}
+
+// Allocate a new mapping of the thunks template. The template stubs refer to their data relative to
+// their own address, so the mapping consists of an executable view of the template followed by a
+// read-write data section of the same size.
 REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalAllocateThunksFromTemplate(HANDLE hTemplateModule, uint32_t templateRva, size_t templateSize, void** newThunksOut)
 {
-    PORTABILITY_ASSERT("UNIXTODO: Implement this function");
+    ASSERT((templateSize & (OS_PAGE_SIZE - 1)) == 0);
+
+    if (g_thunksTemplateFd == -1)
+    {
+        int fd = CreateThunksTemplateFd((uint8_t*)hTemplateModule + templateRva, templateSize);
+        if (fd == -1)
+        {
+            return UInt32_FALSE;
+        }
+
+        g_thunksTemplateSize = templateSize;
+        if (PalInterlockedCompareExchange((Int32*)&g_thunksTemplateFd, fd, -1) != -1)
+        {
+            // Another thread has created the template concurrently
+            close(fd);
+        }
+    }
+
+    ASSERT(g_thunksTemplateSize == templateSize);
+
+    // Reserve the address range for both sections first so that they end up adjacent
+    uint8_t* pMapping = (uint8_t*)mmap(NULL, templateSize * 2, PROT_NONE, MAP_ANON | MAP_PRIVATE, -1, 0);
+    if (pMapping == MAP_FAILED)
+    {
+        return UInt32_FALSE;
+    }
+
+    if ((mmap(pMapping, templateSize, PROT_READ | PROT_EXEC, MAP_SHARED | MAP_FIXED, g_thunksTemplateFd, 0) == MAP_FAILED) ||
+        (mmap(pMapping + templateSize, templateSize, PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE | MAP_FIXED, -1, 0) == MAP_FAILED))
+    {
+        munmap(pMapping, templateSize * 2);
+        return UInt32_FALSE;
+    }
+
+    *newThunksOut = pMapping;
+    return UInt32_TRUE;
 }
 
 REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalFreeThunksFromTemplate(void *pBaseAddress)
 {
-    PORTABILITY_ASSERT("UNIXTODO: Implement this function");
+    ASSERT(g_thunksTemplateSize != 0);
+    return munmap(pBaseAddress, g_thunksTemplateSize * 2) == 0;
 }
 #endif // !USE_PORTABLE_HELPERS && !FEATURE_RX_THUNKS
 
@@ -567,6 +930,11 @@ extern "C" UInt32_BOOL CloseHandle(HANDLE handle)
         return UInt32_FALSE;
     }
 
+    if (handle == (HANDLE)tls_pCurrentThreadHandle)
+    {
+        tls_pCurrentThreadHandle = NULL;
+    }
+
     UnixHandleBase* handleBase = (UnixHandleBase*)handle;
 
     bool success = handleBase->Destroy();
@@ -650,6 +1018,36 @@ REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalStartFinalizerThread(_In_ BackgroundCal
 #endif // HOST_WASM
 }
 
+static Int32 volatile * s_signalFlags[NSIG];
+
+static void FlagOnSignalHandler(int signal)
+{
+    // Only async signal safe operations are allowed here
+    *s_signalFlags[signal] = 1;
+}
+
+REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalSetFlagOnSignal(UInt32 signal, _In_ Int32 volatile * pFlag)
+{
+    if ((signal == 0) || (signal >= NSIG) || (s_signalFlags[signal] != NULL))
+        return false;
+
+    s_signalFlags[signal] = pFlag;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = FlagOnSignalHandler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+
+    if (sigaction(signal, &action, NULL) != 0)
+    {
+        s_signalFlags[signal] = NULL;
+        return false;
+    }
+
+    return true;
+}
+
 // Returns a 64-bit tick count with a millisecond resolution. It tries its best
 // to return monotonically increasing counts and avoid being affected by changes
 // to the system clock (either due to drift or due to explicit changes to system
@@ -889,9 +1287,20 @@ extern "C" UInt32_BOOL DuplicateHandle(
     ASSERT(hSourceProcessHandle == GetCurrentProcess());
     ASSERT(hTargetProcessHandle == GetCurrentProcess());
     ASSERT(hSourceHandle == GetCurrentThread());
-    *lpTargetHandle = new (nothrow) ThreadUnixHandle(pthread_self());
+    ThreadUnixHandle* threadHandle = new (nothrow) ThreadUnixHandle(pthread_self());
+    if (threadHandle == NULL)
+    {
+        *lpTargetHandle = INVALID_HANDLE_VALUE;
+        return UInt32_FALSE;
+    }
+
+    if (tls_pCurrentThreadHandle == NULL)
+    {
+        tls_pCurrentThreadHandle = threadHandle;
+    }
 
-    return lpTargetHandle != nullptr;
+    *lpTargetHandle = threadHandle;
+    return UInt32_TRUE;
 }
 
 extern "C" UInt32_BOOL InitializeCriticalSection(CRITICAL_SECTION * lpCriticalSection)
@@ -915,6 +1324,11 @@ extern "C" void EnterCriticalSection(CRITICAL_SECTION * lpCriticalSection)
     pthread_mutex_lock(&lpCriticalSection->mutex);;
 }
 
+extern "C" UInt32_BOOL TryEnterCriticalSection(CRITICAL_SECTION * lpCriticalSection)
+{
+    return pthread_mutex_trylock(&lpCriticalSection->mutex) == 0;
+}
+
 extern "C" void LeaveCriticalSection(CRITICAL_SECTION * lpCriticalSection)
 {
     pthread_mutex_unlock(&lpCriticalSection->mutex);
@@ -983,12 +1397,27 @@ extern "C" UInt16 RtlCaptureStackBackTrace(UInt32 arg1, UInt32 arg2, void* arg3,
     return 0;
 }
 
-typedef UInt32 (__stdcall *HijackCallback)(HANDLE hThread, _In_ PAL_LIMITED_CONTEXT* pThreadContext, _In_opt_ void* pCallbackContext);
-
+// Unlike on Windows, the target thread is not suspended here. Instead, it is sent an activation
+// signal and the callback runs on the target thread itself from the signal handler, with the context
+// at which the thread was interrupted. The hijack is therefore asynchronous: a successful return only
+// means that the signal was sent. Callers are expected to poll the state of the thread anyway.
 REDHAWK_PALEXPORT UInt32 REDHAWK_PALAPI PalHijack(HANDLE hThread, _In_ HijackCallback callback, _In_opt_ void* pCallbackContext)
 {
-    // UNIXTODO: Implement PalHijack
+#ifdef USE_PORTABLE_HELPERS
     return E_FAIL;
+#else
+    if ((hThread == NULL) || (hThread == INVALID_HANDLE_VALUE))
+    {
+        return E_FAIL;
+    }
+
+    ASSERT(((UnixHandleBase*)hThread)->GetType() == UnixHandleType::Thread);
+    ThreadUnixHandle* threadHandle = (ThreadUnixHandle*)hThread;
+
+    threadHandle->SetHijackCallback(callback, pCallbackContext);
+
+    return InjectActivation(*threadHandle->GetObject()) ? S_OK : E_FAIL;
+#endif // USE_PORTABLE_HELPERS
 }
 
 extern "C" UInt32 WaitForSingleObjectEx(HANDLE handle, UInt32 milliseconds, UInt32_BOOL alertable)
@@ -1002,12 +1431,147 @@ extern "C" UInt32 WaitForSingleObjectEx(HANDLE handle, UInt32 milliseconds, UInt
     return unixHandle->GetObject()->Wait(milliseconds);
 }
 
+// Returns WAIT_OBJECT_0 + the index of the first of the events that is signaled, consuming its state
+static bool TryWaitForAnyEvent(uint32_t handleCount, HANDLE* pHandles, uint32_t* pResult)
+{
+    for (uint32_t i = 0; i < handleCount; i++)
+    {
+        UnixHandleBase* handleBase = (UnixHandleBase*)pHandles[i];
+        ASSERT(handleBase->GetType() == UnixHandleType::Event);
+        if (((EventUnixHandle*)handleBase)->GetObject()->TryWait())
+        {
+            *pResult = WAIT_OBJECT_0 + i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Waits until any of the events is signaled. Each event costs one state check per wakeup, and the waiting
+// thread is only woken by Sets, so waiting on dozens of events needs neither a thread nor a kernel object per
+// event.
+static uint32_t WaitForMultipleEvents(uint32_t handleCount, HANDLE* pHandles, uint32_t milliseconds)
+{
+    uint32_t result;
+    if (TryWaitForAnyEvent(handleCount, pHandles, &result))
+    {
+        return result;
+    }
+
+    if (milliseconds == 0)
+    {
+        return WAIT_TIMEOUT;
+    }
+
+#if HAVE_LINUX_FUTEX
+    timespec endTime;
+    if (milliseconds != INFINITE)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &endTime);
+        TimeSpecAdd(&endTime, milliseconds);
+    }
+
+    // Announce the waiter before sampling the sequence. Set publishes the state before it looks at the count,
+    // so either the state check below sees the event signaled or the Set bumps the sequence and the futex
+    // doesn't block.
+    __atomic_add_fetch(&s_multipleObjectWaiterCount, 1, __ATOMIC_SEQ_CST);
+
+    for (;;)
+    {
+        int32_t sequence = __atomic_load_n(&s_multipleObjectWaitSequence, __ATOMIC_SEQ_CST);
+        if (TryWaitForAnyEvent(handleCount, pHandles, &result))
+        {
+            break;
+        }
+
+        int st = FutexWait(&s_multipleObjectWaitSequence, sequence, (milliseconds != INFINITE) ? &endTime : NULL);
+        int error = (st == 0) ? 0 : errno;
+
+        if (error == ETIMEDOUT)
+        {
+            // An event may have been set right as the wait timed out
+            if (!TryWaitForAnyEvent(handleCount, pHandles, &result))
+            {
+                result = WAIT_TIMEOUT;
+            }
+            break;
+        }
+
+        if ((error != 0) && (error != EAGAIN) && (error != EINTR))
+        {
+            result = WAIT_FAILED;
+            break;
+        }
+    }
+
+    __atomic_sub_fetch(&s_multipleObjectWaiterCount, 1, __ATOMIC_SEQ_CST);
+#else // HAVE_LINUX_FUTEX
+    UInt64 endTickCount = (milliseconds != INFINITE) ? (PalGetTickCount64() + milliseconds) : 0;
+
+    pthread_mutex_lock(&s_multipleObjectWaitMutex);
+    __atomic_add_fetch(&s_multipleObjectWaiterCount, 1, __ATOMIC_SEQ_CST);
+
+    for (;;)
+    {
+        // Sets bump the sequence under the lock after publishing the state, so none is missed between the
+        // state check and the wait.
+        if (TryWaitForAnyEvent(handleCount, pHandles, &result))
+        {
+            break;
+        }
+
+        int st;
+        if (milliseconds == INFINITE)
+        {
+            st = pthread_cond_wait(&s_multipleObjectWaitCondition, &s_multipleObjectWaitMutex);
+        }
+        else
+        {
+            UInt64 tickCount = PalGetTickCount64();
+            if (tickCount >= endTickCount)
+            {
+                result = WAIT_TIMEOUT;
+                break;
+            }
+
+            timespec waitTime;
+#if HAVE_MACH_ABSOLUTE_TIME
+            NanosecondsToTimeSpec((endTickCount - tickCount) * tccMilliSecondsToNanoSeconds, &waitTime);
+            st = pthread_cond_timedwait_relative_np(&s_multipleObjectWaitCondition, &s_multipleObjectWaitMutex, &waitTime);
+#else
+            // The condition uses the default clock, so the end time is recomputed after every wakeup
+            clock_gettime(CLOCK_REALTIME, &waitTime);
+            TimeSpecAdd(&waitTime, (uint32_t)(endTickCount - tickCount));
+            st = pthread_cond_timedwait(&s_multipleObjectWaitCondition, &s_multipleObjectWaitMutex, &waitTime);
+#endif
+        }
+
+        if ((st != 0) && (st != ETIMEDOUT))
+        {
+            result = WAIT_FAILED;
+            break;
+        }
+    }
+
+    __atomic_sub_fetch(&s_multipleObjectWaiterCount, 1, __ATOMIC_SEQ_CST);
+    pthread_mutex_unlock(&s_multipleObjectWaitMutex);
+#endif // HAVE_LINUX_FUTEX
+
+    return result;
+}
+
+// There are no APCs on Unix, so nothing can alert a wait and alertable waits behave like the other ones.
 REDHAWK_PALEXPORT uint32_t REDHAWK_PALAPI PalCompatibleWaitAny(UInt32_BOOL alertable, uint32_t timeout, uint32_t handleCount, HANDLE* pHandles, UInt32_BOOL allowReentrantWait)
 {
-    // Only a single handle wait for event is supported
-    ASSERT(handleCount == 1);
+    ASSERT(handleCount >= 1);
 
-    return WaitForSingleObjectEx(pHandles[0], timeout, alertable);
+    if (handleCount == 1)
+    {
+        return WaitForSingleObjectEx(pHandles[0], timeout, alertable);
+    }
+
+    return WaitForMultipleEvents(handleCount, pHandles, timeout);
 }
 
 #ifndef __has_builtin
@@ -1034,9 +1598,24 @@ REDHAWK_PALEXPORT Int32 PalGetProcessCpuCount()
     return g_cNumProcs;
 }
 
+REDHAWK_PALEXPORT UInt32 PalGetCurrentProcessorNumber()
+{
+    int rseqProcessorNumber = GetRseqCurrentProcessor();
+    if (rseqProcessorNumber >= 0)
+        return (UInt32)rseqProcessorNumber;
+
+#if HAVE_SCHED_GETCPU
+    int processorNumber = sched_getcpu();
+    if (processorNumber >= 0)
+        return (UInt32)processorNumber;
+#endif
+    return 0;
+}
+
 //Reads the entire contents of the file into the specified buffer, buff
 //returns the number of bytes read if the file is successfully read
 //returns 0 if the file is not found, size is greater than maxBytesToRead or the file couldn't be opened or read
+//files that report a size of 0, like the ones in /proc, are read up to maxBytesToRead bytes
 REDHAWK_PALEXPORT UInt32 PalReadFileContents(_In_z_ const TCHAR* fileName, _Out_writes_all_(maxBytesToRead) char* buff, _In_ UInt32 maxBytesToRead)
 {
     int fd = open(fileName, O_RDONLY);
@@ -1048,9 +1627,36 @@ REDHAWK_PALEXPORT UInt32 PalReadFileContents(_In_z_ const TCHAR* fileName, _Out_
 
     UInt32 bytesRead = 0;
     struct stat fileStats;
-    if ((fstat(fd, &fileStats) == 0) && (fileStats.st_size <= maxBytesToRead))
+    if (fstat(fd, &fileStats) == 0)
     {
-        bytesRead = read(fd, buff, fileStats.st_size);
+        if (fileStats.st_size == 0)
+        {
+            while (bytesRead < maxBytesToRead)
+            {
+                ssize_t cbRead = read(fd, buff + bytesRead, maxBytesToRead - bytesRead);
+                if (cbRead < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+
+                    bytesRead = 0;
+                    break;
+                }
+
+                if (cbRead == 0)
+                {
+                    break;
+                }
+
+                bytesRead += (UInt32)cbRead;
+            }
+        }
+        else if (fileStats.st_size <= maxBytesToRead)
+        {
+            bytesRead = read(fd, buff, fileStats.st_size);
+        }
     }
 
     close(fd);
@@ -1058,6 +1664,50 @@ REDHAWK_PALEXPORT UInt32 PalReadFileContents(_In_z_ const TCHAR* fileName, _Out_
     return bytesRead;
 }
 
+REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalCreateFileForWriting(_In_z_ const TCHAR* fileName)
+{
+    int fd = open(fileName, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+    {
+        return INVALID_HANDLE_VALUE;
+    }
+
+    FileUnixHandle* handle = new (nothrow) FileUnixHandle(fd);
+    if (handle == NULL)
+    {
+        close(fd);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return handle;
+}
+
+REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalWriteFileContents(HANDLE hFile, _In_reads_bytes_(cbBuffer) const void* pBuffer, UInt32 cbBuffer)
+{
+    ASSERT(((UnixHandleBase*)hFile)->GetType() == UnixHandleType::File);
+    int fd = *((FileUnixHandle*)hFile)->GetObject();
+
+    const char* pCurrent = (const char*)pBuffer;
+    while (cbBuffer != 0)
+    {
+        ssize_t cbWritten = write(fd, pCurrent, cbBuffer);
+        if (cbWritten < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return UInt32_FALSE;
+        }
+
+        pCurrent += cbWritten;
+        cbBuffer -= (UInt32)cbWritten;
+    }
+
+    return UInt32_TRUE;
+}
+
 __thread void* pStackHighOut = NULL;
 __thread void* pStackLowOut = NULL;
 
@@ -1174,6 +1824,19 @@ bool InitializeSystemInfo()
 //  true if it succeeded, false otherwise
 bool InitializeFlushProcessWriteBuffers()
 {
+#if HAVE_LINUX_MEMBARRIER
+    // The process must register for private expedited membarrier before using it. Older kernels don't
+    // support the command, they fall back to the helper page.
+    int mask = (int)syscall(SYS_membarrier, MEMBARRIER_CMD_QUERY, 0);
+    if ((mask >= 0) &&
+        ((mask & MEMBARRIER_CMD_PRIVATE_EXPEDITED) != 0) &&
+        (syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0) == 0))
+    {
+        s_flushUsingMemBarrier = true;
+        return true;
+    }
+#endif // HAVE_LINUX_MEMBARRIER
+
     // Verify that the s_helperPage is really aligned to the g_SystemInfo.dwPageSize
     ASSERT((((size_t)g_helperPage) & (OS_PAGE_SIZE - 1)) == 0);
 
@@ -1198,6 +1861,15 @@ bool InitializeFlushProcessWriteBuffers()
 
 extern "C" void FlushProcessWriteBuffers()
 {
+#if HAVE_LINUX_MEMBARRIER
+    if (s_flushUsingMemBarrier)
+    {
+        int status = (int)syscall(SYS_membarrier, MEMBARRIER_CMD_PRIVATE_EXPEDITED, 0);
+        FATAL_ASSERT(status == 0, "Failed to flush using membarrier");
+        return;
+    }
+#endif // HAVE_LINUX_MEMBARRIER
+
     int status = pthread_mutex_lock(&g_flushProcessWriteBuffersMutex);
     FATAL_ASSERT(status == 0, "Failed to lock the flushProcessWriteBuffersMutex lock");
 
@@ -1233,23 +1905,111 @@ extern "C" void GetSystemTimeAsFileTime(FILETIME *lpSystemTimeAsFileTime)
     lpSystemTimeAsFileTime->dwHighDateTime = (uint32_t)(result >> 32);
 }
 
+#ifdef FEATURE_TSC_CLOCK
+static inline uint64_t ReadTimeStampCounter()
+{
+    uint32_t lo, hi;
+    __asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+static bool IsKernelClockSourceTsc()
+{
+    int fd = open("/sys/devices/system/clocksource/clocksource0/current_clocksource", O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    char buffer[16];
+    ssize_t cbRead = read(fd, buffer, sizeof(buffer) - 1);
+    close(fd);
+
+    return (cbRead >= 3) && (strncmp(buffer, "tsc", 3) == 0) && ((cbRead == 3) || (buffer[3] == '\n'));
+}
+#endif // FEATURE_TSC_CLOCK
+
+// Makes QueryPerformanceCounter read the time stamp counter directly when it is safe to mix its values across
+// processors, which saves the call into the vDSO. The counter must be invariant, so it ticks at a constant rate
+// in all power states, and the kernel must use it as its own clock source, so it is known to be synchronized
+// across processors. The frequency is calibrated against CLOCK_MONOTONIC, and the counter is offset to have the
+// same origin, so values read before this runs only differ from the later ones by the frequency.
+void InitializeTscClock()
+{
+#ifdef FEATURE_TSC_CLOCK
+    unsigned char buffer[16];
+    if (getcpuid(0x80000000, buffer) < 0x80000007)
+        return;
+
+    // EDX bit 8 of the advanced power management leaf is the invariant TSC flag
+    (void)getcpuid(0x80000007, buffer);
+    if ((*(uint32_t *)(buffer + 12) & (1 << 8)) == 0)
+        return;
+
+    if (!IsKernelClockSourceTsc())
+        return;
+
+    const int64_t CalibrationNanoSeconds = 2 * tccMilliSecondsToNanoSeconds;
+
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+        return;
+    uint64_t startTsc = ReadTimeStampCounter();
+    int64_t startTime = (int64_t)ts.tv_sec * tccSecondsToNanoSeconds + ts.tv_nsec;
+
+    int64_t elapsedTime;
+    uint64_t endTsc;
+    do
+    {
+        if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+            return;
+        endTsc = ReadTimeStampCounter();
+        elapsedTime = (int64_t)ts.tv_sec * tccSecondsToNanoSeconds + ts.tv_nsec - startTime;
+    }
+    while (elapsedTime < CalibrationNanoSeconds);
+
+    // Round to the nearest kHz, the calibration isn't more precise than that
+    int64_t frequency = (int64_t)((double)(endTsc - startTsc) * tccSecondsToNanoSeconds / elapsedTime);
+    frequency = (frequency + 500) / 1000 * 1000;
+    if (frequency <= 0)
+        return;
+
+    s_tscOffset = (int64_t)((double)(startTime + elapsedTime) * frequency / tccSecondsToNanoSeconds) - (int64_t)endTsc;
+    s_tscFrequency = frequency;
+#endif // FEATURE_TSC_CLOCK
+}
+
 extern "C" UInt32_BOOL QueryPerformanceCounter(LARGE_INTEGER *lpPerformanceCount)
 {
-    // TODO: More efficient, platform-specific implementation
-    struct timeval tv;
-    if (gettimeofday(&tv, NULL) == -1)
+#ifdef FEATURE_TSC_CLOCK
+    if (s_tscFrequency != 0)
     {
-        ASSERT_UNCONDITIONALLY("gettimeofday() failed");
+        lpPerformanceCount->QuadPart = (int64_t)ReadTimeStampCounter() + s_tscOffset;
+        return UInt32_TRUE;
+    }
+#endif // FEATURE_TSC_CLOCK
+
+    // The monotonic clock has nanosecond resolution and is not affected by changes to the system time.
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+    {
+        ASSERT_UNCONDITIONALLY("clock_gettime(CLOCK_MONOTONIC) failed");
         return UInt32_FALSE;
     }
     lpPerformanceCount->QuadPart =
-        (int64_t) tv.tv_sec * (int64_t) tccSecondsToMicroSeconds + (int64_t) tv.tv_usec;
+        (int64_t) ts.tv_sec * (int64_t) tccSecondsToNanoSeconds + (int64_t) ts.tv_nsec;
     return UInt32_TRUE;
 }
 
 extern "C" UInt32_BOOL QueryPerformanceFrequency(LARGE_INTEGER *lpFrequency)
 {
-    lpFrequency->QuadPart = (int64_t) tccSecondsToMicroSeconds;
+#ifdef FEATURE_TSC_CLOCK
+    if (s_tscFrequency != 0)
+    {
+        lpFrequency->QuadPart = s_tscFrequency;
+        return UInt32_TRUE;
+    }
+#endif // FEATURE_TSC_CLOCK
+
+    lpFrequency->QuadPart = (int64_t) tccSecondsToNanoSeconds;
     return UInt32_TRUE;
 }
 
@@ -1342,4 +2102,18 @@ REDHAWK_PALEXPORT uint32_t REDHAWK_PALAPI xmmYmmStateSupport()
     // check OS has enabled both XMM and YMM state support
     return ((eax & 0x06) == 0x06) ? 1 : 0;
 }
+
+#if defined(HOST_AMD64)
+REDHAWK_PALEXPORT uint32_t REDHAWK_PALAPI zmmStateSupport()
+{
+    DWORD eax;
+    __asm("  xgetbv\n" \
+        : "=a"(eax) /*output in eax*/\
+        : "c"(0) /*inputs - 0 in ecx*/\
+        : "edx" /* registers that are clobbered*/
+      );
+    // check OS has enabled XMM, YMM, opmask and ZMM state support
+    return ((eax & 0xE6) == 0xE6) ? 1 : 0;
+}
+#endif // defined(HOST_AMD64)
 #endif // defined(HOST_X86) || defined(HOST_AMD64)
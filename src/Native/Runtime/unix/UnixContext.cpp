@@ -535,6 +535,15 @@ void NativeContextToPalContext(const void* context, PAL_LIMITED_CONTEXT* palCont
 #undef ASSIGN_REG
 }
 
+// Convert the control registers of Unix native context to PAL_LIMITED_CONTEXT, leaving the others undefined
+void NativeContextToPalContextControlRegs(const void* context, PAL_LIMITED_CONTEXT* palContext)
+{
+    ucontext_t *nativeContext = (ucontext_t*)context;
+#define ASSIGN_REG(regNative, regPal) palContext->regPal = MCREG_##regNative(nativeContext->uc_mcontext);
+    ASSIGN_CONTROL_REGS
+#undef ASSIGN_REG
+}
+
 // Redirect Unix native context to the PAL_LIMITED_CONTEXT and also set the first two argument registers
 void RedirectNativeContext(void* context, const PAL_LIMITED_CONTEXT* palContext, UIntNative arg0Reg, UIntNative arg1Reg)
 {
@@ -7,6 +7,8 @@
 
 // Convert Unix native context to PAL_LIMITED_CONTEXT
 void NativeContextToPalContext(const void* context, PAL_LIMITED_CONTEXT* palContext);
+// Convert the control registers of Unix native context to PAL_LIMITED_CONTEXT, leaving the others undefined
+void NativeContextToPalContextControlRegs(const void* context, PAL_LIMITED_CONTEXT* palContext);
 // Redirect Unix native context to the PAL_LIMITED_CONTEXT and also set the first two argument registers
 void RedirectNativeContext(void* context, const PAL_LIMITED_CONTEXT* palContext, UIntNative arg0Reg, UIntNative arg1Reg);
 
@@ -8,7 +8,8 @@
 enum class UnixHandleType
 {
     Thread,
-    Event
+    Event,
+    File
 };
 
 // TODO: add validity check for usage / closing?
@@ -7,16 +7,21 @@
 #include "CommonMacros.h"
 #include "daccess.h"
 #include "PalRedhawkCommon.h"
+#include "PalRedhawk.h"
 #include "regdisplay.h"
 #include "ICodeManager.h"
 #include "UnixNativeCodeManager.h"
 #include "varint.h"
 #include "holder.h"
+#include "slist.h"
+#include "RWLock.h"
+#include "RuntimeInstance.h"
 
 #include "CommonMacros.inl"
 
 #define GCINFODECODER_NO_EE
 #include "coreclr/gcinfodecoder.cpp"
+#include "GcLiveSlotCache.h"
 
 #include "UnixContext.h"
 
@@ -40,17 +45,207 @@ struct UnixNativeMethodInfo
 // Ensure that UnixNativeMethodInfo fits into the space reserved by MethodInfo
 static_assert(sizeof(UnixNativeMethodInfo) <= sizeof(MethodInfo), "UnixNativeMethodInfo too big");
 
+// Entry of the managed unwind table that the object writer emits into the __managedunwind section.
+// Keep in sync with ObjectWriter::EmitManagedUnwindTable.
+struct ManagedUnwindTableEntry
+{
+    Int32 m_startOffset;                // Start of the frame, relative to this field
+    UInt32 m_length;
+    Int32 m_lsdaOffset;                 // LSDA of the frame, relative to this field
+    Int32 m_cfaOffset;
+    UInt8 m_prologSize;                 // The rules only apply past the prolog
+    UInt8 m_frameKind;
+    UInt16 m_savedRegisterMask;
+    Int16 m_savedRegisterOffsets[6];    // Offsets from the CFA of RBX, RBP, R12, R13, R14 and R15
+
+    UIntNative GetStartAddress()
+    {
+        return (UIntNative)&m_startOffset + m_startOffset;
+    }
+
+    UIntNative GetLsda()
+    {
+        return (UIntNative)&m_lsdaOffset + m_lsdaOffset;
+    }
+};
+
+static_assert(sizeof(ManagedUnwindTableEntry) == 32, "ManagedUnwindTableEntry does not match the object writer");
+
+#define MUTE_FRAME_KIND_RSP         0x00    // CFA is RSP + m_cfaOffset
+#define MUTE_FRAME_KIND_RBP         0x01    // CFA is RBP + m_cfaOffset
+#define MUTE_FRAME_KIND_UNKNOWN     0xFF    // The frame can only be unwound with the unwind sections
+
 UnixNativeCodeManager::UnixNativeCodeManager(TADDR moduleBase, 
                                              PTR_VOID pvManagedCodeStartRange, UInt32 cbManagedCodeRange,
                                              PTR_PTR_VOID pClasslibFunctions, UInt32 nClasslibFunctions)
     : m_moduleBase(moduleBase), 
       m_pvManagedCodeStartRange(pvManagedCodeStartRange), m_cbManagedCodeRange(cbManagedCodeRange),
-      m_pClasslibFunctions(pClasslibFunctions), m_nClasslibFunctions(nClasslibFunctions)
+      m_pClasslibFunctions(pClasslibFunctions), m_nClasslibFunctions(nClasslibFunctions),
+      m_pUnwindTable(NULL), m_nUnwindTableEntries(0)
 {
+    memset(m_methodInfoCache, 0, sizeof(m_methodInfoCache));
+    memset((void *)m_ehClauseCache, 0, sizeof(m_ehClauseCache));
+
+    // The cache is an optimization, GC refs are just decoded every time without it
+    m_pGcLiveSlotCache = new (nothrow) GcLiveSlotCache();
 }
 
 UnixNativeCodeManager::~UnixNativeCodeManager()
 {
+    delete m_pGcLiveSlotCache;
+
+    for (UInt32 i = 0; i < EHClauseCacheSize; i++)
+    {
+        delete[] (UInt8 *)m_ehClauseCache[i];
+    }
+}
+
+// Starts using the managed unwind table of the module. The table is expected to be sorted, but it is assembled
+// by the linker from the tables of all the obj files, so it is checked before it is trusted.
+bool UnixNativeCodeManager::SetUnwindTable(PTR_VOID pvUnwindTable, UInt32 cbUnwindTable)
+{
+    if ((cbUnwindTable % sizeof(ManagedUnwindTableEntry)) != 0)
+        return false;
+
+    ManagedUnwindTableEntry * pTable = (ManagedUnwindTableEntry *)pvUnwindTable;
+    UInt32 nEntries = cbUnwindTable / sizeof(ManagedUnwindTableEntry);
+
+    for (UInt32 i = 1; i < nEntries; i++)
+    {
+        if (pTable[i - 1].GetStartAddress() + pTable[i - 1].m_length > pTable[i].GetStartAddress())
+            return false;
+    }
+
+    m_pUnwindTable = pTable;
+    m_nUnwindTableEntries = nEntries;
+    return true;
+}
+
+// Binary search of the managed unwind table for the frame containing controlPC
+ManagedUnwindTableEntry * UnixNativeCodeManager::FindUnwindTableEntry(UIntNative controlPC)
+{
+    UInt32 low = 0;
+    UInt32 high = m_nUnwindTableEntries;
+
+    while (low < high)
+    {
+        UInt32 mid = low + (high - low) / 2;
+        ManagedUnwindTableEntry * pEntry = &m_pUnwindTable[mid];
+
+        UIntNative startAddress = pEntry->GetStartAddress();
+        if (controlPC < startAddress)
+        {
+            high = mid;
+        }
+        else if (controlPC >= startAddress + pEntry->m_length)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            return pEntry;
+        }
+    }
+
+    return NULL;
+}
+
+// Unwinds a managed frame using the rules from the managed unwind table. Returns false if the frame is not in the
+// table, the rules can't describe it, or controlPC is still in the prolog where the rules don't apply yet.
+bool UnixNativeCodeManager::UnwindWithUnwindTable(REGDISPLAY * pRegisterSet)
+{
+#ifdef TARGET_AMD64
+    UIntNative controlPC = (UIntNative)pRegisterSet->GetIP();
+
+    ManagedUnwindTableEntry * pEntry = FindUnwindTableEntry(controlPC);
+    if ((pEntry == NULL) || (pEntry->m_frameKind == MUTE_FRAME_KIND_UNKNOWN))
+        return false;
+
+    if (controlPC - pEntry->GetStartAddress() < pEntry->m_prologSize)
+        return false;
+
+    UIntNative cfa = ((pEntry->m_frameKind == MUTE_FRAME_KIND_RBP) ? *pRegisterSet->pRbp : pRegisterSet->SP) +
+        pEntry->m_cfaOffset;
+
+    PTR_UIntNative * savedRegisters[] =
+    {
+        &pRegisterSet->pRbx, &pRegisterSet->pRbp,
+        &pRegisterSet->pR12, &pRegisterSet->pR13, &pRegisterSet->pR14, &pRegisterSet->pR15
+    };
+
+    for (int i = 0; i < 6; i++)
+    {
+        if ((pEntry->m_savedRegisterMask & (1 << i)) != 0)
+            *savedRegisters[i] = dac_cast<PTR_UIntNative>(cfa + pEntry->m_savedRegisterOffsets[i]);
+    }
+
+    // The return address is right below the CFA, which is the stack pointer at the call site
+    pRegisterSet->pIP = dac_cast<PTR_PCODE>(cfa - sizeof(TADDR));
+    pRegisterSet->IP = *pRegisterSet->pIP;
+    pRegisterSet->SP = cfa;
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool UnixNativeCodeManager::VirtualUnwindManaged(REGDISPLAY * pRegisterSet)
+{
+    return UnwindWithUnwindTable(pRegisterSet) || VirtualUnwind(pRegisterSet);
+}
+
+// Find LSDA and start address for a function at address controlPC, consulting the method info cache first
+bool UnixNativeCodeManager::FindProcInfoCached(UIntNative controlPC, UIntNative* startAddress, UIntNative* lsda)
+{
+    MethodInfoCacheEntry * pEntry = &m_methodInfoCache[((controlPC >> 2) ^ (controlPC >> 11)) % MethodInfoCacheSize];
+
+    Int32 sequence = pEntry->m_sequence;
+    if ((sequence & 1) == 0)
+    {
+        PalMemoryBarrier();
+
+        UIntNative cachedControlPC = pEntry->m_controlPC;
+        UIntNative cachedStartAddress = pEntry->m_startAddress;
+        UIntNative cachedLsda = pEntry->m_lsda;
+
+        PalMemoryBarrier();
+
+        // The entry is only valid if it was not updated while we were reading it
+        if ((cachedControlPC == controlPC) && (pEntry->m_sequence == sequence))
+        {
+            *startAddress = cachedStartAddress;
+            *lsda = cachedLsda;
+            return true;
+        }
+    }
+
+    ManagedUnwindTableEntry * pUnwindTableEntry = FindUnwindTableEntry(controlPC);
+    if (pUnwindTableEntry != NULL)
+    {
+        *startAddress = pUnwindTableEntry->GetStartAddress();
+        *lsda = pUnwindTableEntry->GetLsda();
+    }
+    else if (!FindProcInfo(controlPC, startAddress, lsda))
+    {
+        return false;
+    }
+
+    // Claim the entry for the update. If another thread is updating it at the same time, or the
+    // lookup raced with an update, just leave the entry alone.
+    Int32 updateSequence = (Int32)((UInt32)sequence + 1);
+    if (((sequence & 1) == 0) && (PalInterlockedCompareExchange(&pEntry->m_sequence, updateSequence, sequence) == sequence))
+    {
+        pEntry->m_controlPC = controlPC;
+        pEntry->m_startAddress = *startAddress;
+        pEntry->m_lsda = *lsda;
+
+        PalMemoryBarrier();
+
+        pEntry->m_sequence = (Int32)((UInt32)updateSequence + 1);
+    }
+
+    return true;
 }
 
 bool UnixNativeCodeManager::FindMethodInfo(PTR_VOID        ControlPC, 
@@ -67,7 +262,7 @@ bool UnixNativeCodeManager::FindMethodInfo(PTR_VOID        ControlPC,
     UIntNative startAddress;
     UIntNative lsda;
 
-    if (!FindProcInfo((UIntNative)ControlPC, &startAddress, &lsda))
+    if (!FindProcInfoCached((UIntNative)ControlPC, &startAddress, &lsda))
     {
         return false;
     }
@@ -135,6 +330,24 @@ void UnixNativeCodeManager::EnumGcRefs(MethodInfo *    pMethodInfo,
 {
     UnixNativeMethodInfo * pNativeMethodInfo = (UnixNativeMethodInfo *)pMethodInfo;
 
+    ICodeManagerFlags flags = (ICodeManagerFlags)0;
+    if (pNativeMethodInfo->executionAborted)
+        flags = ICodeManagerFlags::ExecutionAborted;
+    if (IsFilter(pMethodInfo))
+        flags = (ICodeManagerFlags)(flags | ICodeManagerFlags::NoReportUntracked);
+
+    // Only the frames that are reported without flags are cached, the others are rare
+    bool useLiveSlotCache = (flags == 0) && (m_pGcLiveSlotCache != NULL);
+    if (useLiveSlotCache)
+    {
+        GcLiveSlotList * pCachedLiveSlots = m_pGcLiveSlotCache->Lookup(safePointAddress);
+        if (pCachedLiveSlots != NULL)
+        {
+            GcInfoDecoder::ReportLiveSlots(pCachedLiveSlots, pRegisterSet, flags, hCallback->pCallback, hCallback);
+            return;
+        }
+    }
+
     PTR_UInt8 p = pNativeMethodInfo->pMainLSDA;
 
     uint8_t unwindBlockFlags = *p++;
@@ -153,11 +366,14 @@ void UnixNativeCodeManager::EnumGcRefs(MethodInfo *    pMethodInfo,
         codeOffset - 1 // TODO: Is this adjustment correct?
     );
 
-    ICodeManagerFlags flags = (ICodeManagerFlags)0;
-    if (pNativeMethodInfo->executionAborted)
-        flags = ICodeManagerFlags::ExecutionAborted;
-    if (IsFilter(pMethodInfo))
-        flags = (ICodeManagerFlags)(flags | ICodeManagerFlags::NoReportUntracked);
+    GcLiveSlot liveSlots[GcLiveSlotCache::MaxSlots];
+    GcLiveSlotList liveSlotList;
+    if (useLiveSlotCache)
+    {
+        liveSlotList.pSlots = liveSlots;
+        liveSlotList.MaxSlots = GcLiveSlotCache::MaxSlots;
+        decoder.RecordLiveSlots(&liveSlotList);
+    }
 
     if (!decoder.EnumerateLiveSlots(
         pRegisterSet,
@@ -169,6 +385,11 @@ void UnixNativeCodeManager::EnumGcRefs(MethodInfo *    pMethodInfo,
     {
         assert(false);
     }
+
+    if (useLiveSlotCache && liveSlotList.IsComplete())
+    {
+        m_pGcLiveSlotCache->Add(safePointAddress, &liveSlotList);
+    }
 }
 
 UIntNative UnixNativeCodeManager::GetConservativeUpperBoundForOutgoingArgs(MethodInfo * pMethodInfo, REGDISPLAY * pRegisterSet)
@@ -217,7 +438,7 @@ UIntNative UnixNativeCodeManager::GetConservativeUpperBoundForOutgoingArgs(Metho
         // The passed in pRegisterSet should be left intact
         REGDISPLAY localRegisterSet = *pRegisterSet;
 
-        bool result = VirtualUnwind(&localRegisterSet);
+        bool result = VirtualUnwindManaged(&localRegisterSet);
         assert(result);
 
         // All common ABIs have outgoing arguments under caller SP (minus slot reserved for return address).
@@ -270,7 +491,7 @@ bool UnixNativeCodeManager::UnwindStackFrame(MethodInfo *    pMethodInfo,
 
     *ppPreviousTransitionFrame = NULL;
 
-    if (!VirtualUnwind(pRegisterSet))
+    if (!VirtualUnwindManaged(pRegisterSet))
     {
         return false;
     }
@@ -310,8 +531,8 @@ PTR_VOID UnixNativeCodeManager::RemapHardwareFaultToGCSafePoint(MethodInfo * pMe
 
 struct UnixEHEnumState
 {
-    PTR_UInt8 pMethodStartAddress;
-    PTR_UInt8 pEHInfo;
+    PTR_UInt8 pMethodStartAddress;  // NULL when the clauses come from the EH clause cache
+    PTR_UInt8 pEHInfo;              // Next clause to decode, or the cached EHClause array
     UInt32 uClause;
     UInt32 nClauses;
 };
@@ -344,30 +565,33 @@ bool UnixNativeCodeManager::EHEnumInit(MethodInfo * pMethodInfo, PTR_VOID * pMet
 
     *pMethodStartAddress = pNativeMethodInfo->pMethodStartAddress;
 
-    pEnumState->pMethodStartAddress = dac_cast<PTR_UInt8>(pNativeMethodInfo->pMethodStartAddress);
-    pEnumState->pEHInfo = dac_cast<PTR_UInt8>(p + *dac_cast<PTR_Int32>(p));
+    PTR_UInt8 pStartAddress = dac_cast<PTR_UInt8>(pNativeMethodInfo->pMethodStartAddress);
+    PTR_UInt8 pEHInfo = dac_cast<PTR_UInt8>(p + *dac_cast<PTR_Int32>(p));
+
     pEnumState->uClause = 0;
+
+    EHClauseCacheEntry * pCachedClauses = GetCachedEHClauses(pNativeMethodInfo->pMainLSDA, pStartAddress, pEHInfo);
+    if (pCachedClauses != NULL)
+    {
+        pEnumState->pMethodStartAddress = NULL;
+        pEnumState->pEHInfo = (PTR_UInt8)pCachedClauses->m_clauses;
+        pEnumState->nClauses = pCachedClauses->m_nClauses;
+        return true;
+    }
+
+    pEnumState->pMethodStartAddress = pStartAddress;
+    pEnumState->pEHInfo = pEHInfo;
     pEnumState->nClauses = VarInt::ReadUnsigned(pEnumState->pEHInfo);
 
     return true;
 }
 
-bool UnixNativeCodeManager::EHEnumNext(EHEnumState * pEHEnumState, EHClause * pEHClauseOut)
+// Decodes the clause at pEHInfo and advances pEHInfo past it
+static void DecodeEHClause(PTR_UInt8 pMethodStartAddress, PTR_UInt8 & pEHInfo, EHClause * pEHClauseOut)
 {
-    assert(pEHEnumState != NULL);
-    assert(pEHClauseOut != NULL);
-
-    UnixEHEnumState * pEnumState = (UnixEHEnumState *)pEHEnumState;
-    if (pEnumState->uClause >= pEnumState->nClauses)
-    {
-        return false;
-    }
-
-    pEnumState->uClause++;
-
-    pEHClauseOut->m_tryStartOffset = VarInt::ReadUnsigned(pEnumState->pEHInfo);
+    pEHClauseOut->m_tryStartOffset = VarInt::ReadUnsigned(pEHInfo);
 
-    UInt32 tryEndDeltaAndClauseKind = VarInt::ReadUnsigned(pEnumState->pEHInfo);
+    UInt32 tryEndDeltaAndClauseKind = VarInt::ReadUnsigned(pEHInfo);
     pEHClauseOut->m_clauseKind = (EHClauseKind)(tryEndDeltaAndClauseKind & 0x3);
     pEHClauseOut->m_tryEndOffset = pEHClauseOut->m_tryStartOffset + (tryEndDeltaAndClauseKind >> 2);
 
@@ -383,26 +607,102 @@ bool UnixNativeCodeManager::EHEnumNext(EHEnumState * pEHEnumState, EHClause * pE
     switch (pEHClauseOut->m_clauseKind)
     {
     case EH_CLAUSE_TYPED:
-        pEHClauseOut->m_handlerAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pEnumState->pMethodStartAddress))) + VarInt::ReadUnsigned(pEnumState->pEHInfo);
+        pEHClauseOut->m_handlerAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pMethodStartAddress))) + VarInt::ReadUnsigned(pEHInfo);
 
         // Read target type
         {
             // @TODO: CORERT: Compress EHInfo using type table index scheme
             // https://github.com/dotnet/corert/issues/972
-            Int32 typeRelAddr = *((PTR_Int32&)pEnumState->pEHInfo)++;
-            pEHClauseOut->m_pTargetType = dac_cast<PTR_VOID>(pEnumState->pEHInfo + typeRelAddr);
+            Int32 typeRelAddr = *((PTR_Int32&)pEHInfo)++;
+            pEHClauseOut->m_pTargetType = dac_cast<PTR_VOID>(pEHInfo + typeRelAddr);
         }
         break;
     case EH_CLAUSE_FAULT:
-        pEHClauseOut->m_handlerAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pEnumState->pMethodStartAddress))) + VarInt::ReadUnsigned(pEnumState->pEHInfo);
+        pEHClauseOut->m_handlerAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pMethodStartAddress))) + VarInt::ReadUnsigned(pEHInfo);
         break;
     case EH_CLAUSE_FILTER:
-        pEHClauseOut->m_handlerAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pEnumState->pMethodStartAddress))) + VarInt::ReadUnsigned(pEnumState->pEHInfo);
-        pEHClauseOut->m_filterAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pEnumState->pMethodStartAddress))) + VarInt::ReadUnsigned(pEnumState->pEHInfo);
+        pEHClauseOut->m_handlerAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pMethodStartAddress))) + VarInt::ReadUnsigned(pEHInfo);
+        pEHClauseOut->m_filterAddress = dac_cast<UInt8*>(PINSTRToPCODE(dac_cast<TADDR>(pMethodStartAddress))) + VarInt::ReadUnsigned(pEHInfo);
         break;
     default:
         UNREACHABLE_MSG("unexpected EHClauseKind");
     }
+}
+
+UnixNativeCodeManager::EHClauseCacheEntry * UnixNativeCodeManager::GetCachedEHClauses(PTR_UInt8 pMainLSDA, PTR_UInt8 pMethodStartAddress, PTR_UInt8 pEHInfo)
+{
+    UIntNative key = (UIntNative)pMainLSDA;
+    UInt32 hash = (UInt32)((key >> 2) ^ (key >> 11));
+
+    EHClauseCacheEntry * volatile * pSlot = NULL;
+    for (UInt32 probe = 0; probe < EHClauseCacheMaxProbes; probe++)
+    {
+        EHClauseCacheEntry * volatile * pCandidateSlot = &m_ehClauseCache[(hash + probe) % EHClauseCacheSize];
+        EHClauseCacheEntry * pEntry = *pCandidateSlot;
+        if (pEntry == NULL)
+        {
+            pSlot = pCandidateSlot;
+            break;
+        }
+
+        if (pEntry->m_pMainLSDA == pMainLSDA)
+        {
+            return pEntry;
+        }
+    }
+
+    if (pSlot == NULL)
+    {
+        return NULL;
+    }
+
+    UInt32 nClauses = VarInt::ReadUnsigned(pEHInfo);
+    size_t cbEntry = offsetof(EHClauseCacheEntry, m_clauses) + (size_t)max(nClauses, (UInt32)1) * sizeof(EHClause);
+    EHClauseCacheEntry * pNewEntry = (EHClauseCacheEntry *)new (nothrow) UInt8[cbEntry];
+    if (pNewEntry == NULL)
+    {
+        return NULL;
+    }
+
+    pNewEntry->m_pMainLSDA = pMainLSDA;
+    pNewEntry->m_nClauses = nClauses;
+    for (UInt32 i = 0; i < nClauses; i++)
+    {
+        DecodeEHClause(pMethodStartAddress, pEHInfo, &pNewEntry->m_clauses[i]);
+    }
+
+    // Publish the fully decoded entry. If another thread filled the slot first, use its entry if it is for
+    // the same method and otherwise just go without the cache this time.
+    EHClauseCacheEntry * pExistingEntry = (EHClauseCacheEntry *)PalInterlockedCompareExchangePointer(pSlot, pNewEntry, NULL);
+    if (pExistingEntry != NULL)
+    {
+        delete[] (UInt8 *)pNewEntry;
+        return (pExistingEntry->m_pMainLSDA == pMainLSDA) ? pExistingEntry : NULL;
+    }
+
+    return pNewEntry;
+}
+
+bool UnixNativeCodeManager::EHEnumNext(EHEnumState * pEHEnumState, EHClause * pEHClauseOut)
+{
+    assert(pEHEnumState != NULL);
+    assert(pEHClauseOut != NULL);
+
+    UnixEHEnumState * pEnumState = (UnixEHEnumState *)pEHEnumState;
+    if (pEnumState->uClause >= pEnumState->nClauses)
+    {
+        return false;
+    }
+
+    if (pEnumState->pMethodStartAddress == NULL)
+    {
+        *pEHClauseOut = ((EHClause *)pEnumState->pEHInfo)[pEnumState->uClause++];
+        return true;
+    }
+
+    pEnumState->uClause++;
+
+    DecodeEHClause(pEnumState->pMethodStartAddress, pEnumState->pEHInfo, pEHClauseOut);
 
     return true;
 }
@@ -455,6 +755,8 @@ bool RhRegisterOSModule(void * pModule,
                         void * pvUnboxingStubsStartRange, UInt32 cbUnboxingStubsRange,
                         void ** pClasslibFunctions, UInt32 nClasslibFunctions)
 {
+    STARTUP_TIMELINE_EVENT(REGISTER_OS_MODULE_BEGIN);
+
     NewHolder<UnixNativeCodeManager> pUnixNativeCodeManager = new (nothrow) UnixNativeCodeManager((TADDR)pModule,
         pvManagedCodeStartRange, cbManagedCodeRange,
         pClasslibFunctions, nClasslibFunctions);
@@ -473,5 +775,19 @@ bool RhRegisterOSModule(void * pModule,
 
     pUnixNativeCodeManager.SuppressRelease();
 
+    STARTUP_TIMELINE_EVENT(REGISTER_OS_MODULE_COMPLETE);
+
     return true;
 }
+
+// Registers the managed unwind table of the module whose managed code starts at pvManagedCodeStartRange. Managed
+// code works without it, so a table that can't be used is just ignored.
+extern "C"
+void RhRegisterManagedUnwindTable(void * pvManagedCodeStartRange, void * pvUnwindTable, UInt32 cbUnwindTable)
+{
+    ICodeManager * pCodeManager = GetRuntimeInstance()->FindCodeManagerByAddress(pvManagedCodeStartRange);
+    if (pCodeManager == NULL)
+        return;
+
+    static_cast<UnixNativeCodeManager *>(pCodeManager)->SetUnwindTable(pvUnwindTable, cbUnwindTable);
+}
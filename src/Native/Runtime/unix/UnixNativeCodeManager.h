@@ -4,6 +4,10 @@
 
 #pragma once
 
+struct ManagedUnwindTableEntry;
+
+class GcLiveSlotCache;
+
 class UnixNativeCodeManager : public ICodeManager
 {
     TADDR m_moduleBase;
@@ -14,6 +18,53 @@ class UnixNativeCodeManager : public ICodeManager
     PTR_PTR_VOID m_pClasslibFunctions;
     UInt32 m_nClasslibFunctions;
 
+    // Cache of the start address and LSDA of the methods containing recently queried ControlPCs. Stack
+    // walks keep hitting the same return addresses, and looking them up in the unwind tables is expensive.
+    // Each entry is protected by a sequence number that is odd while the entry is being updated, so the
+    // cache can be read and updated concurrently without locks.
+    struct MethodInfoCacheEntry
+    {
+        volatile Int32 m_sequence;
+        UIntNative m_controlPC;
+        UIntNative m_startAddress;
+        UIntNative m_lsda;
+    };
+
+    static const UInt32 MethodInfoCacheSize = 512;
+    MethodInfoCacheEntry m_methodInfoCache[MethodInfoCacheSize];
+
+    bool FindProcInfoCached(UIntNative controlPC, UIntNative* startAddress, UIntNative* lsda);
+
+    // Cache of the decoded EH clauses of methods that exceptions were dispatched through, keyed by the main
+    // LSDA of the method. Both dispatch passes enumerate the clauses of every frame on every throw, so code
+    // that keeps throwing through the same frames would otherwise decode the same blobs over and over.
+    // Entries are immutable once published and are only freed with the code manager, so they can be read
+    // without locks. When all the slots a method may use are taken its clauses are just decoded every time.
+    struct EHClauseCacheEntry
+    {
+        PTR_UInt8 m_pMainLSDA;
+        UInt32 m_nClauses;
+        EHClause m_clauses[1];  // Actually m_nClauses entries
+    };
+
+    static const UInt32 EHClauseCacheSize = 256;
+    static const UInt32 EHClauseCacheMaxProbes = 8;
+    EHClauseCacheEntry * volatile m_ehClauseCache[EHClauseCacheSize];
+
+    EHClauseCacheEntry * GetCachedEHClauses(PTR_UInt8 pMainLSDA, PTR_UInt8 pMethodStartAddress, PTR_UInt8 pEHInfo);
+
+    // Live slots at the safe points GCs found the methods stopped at, see GcLiveSlotCache.h
+    GcLiveSlotCache * m_pGcLiveSlotCache;
+
+    // Unwind rules of the managed code emitted by the compiler into a table sorted by address, see
+    // ManagedUnwindTableEntry. Methods that are not in the table are looked up in the unwind sections.
+    ManagedUnwindTableEntry * m_pUnwindTable;
+    UInt32 m_nUnwindTableEntries;
+
+    ManagedUnwindTableEntry * FindUnwindTableEntry(UIntNative controlPC);
+    bool UnwindWithUnwindTable(REGDISPLAY * pRegisterSet);
+    bool VirtualUnwindManaged(REGDISPLAY * pRegisterSet);
+
 public:
     UnixNativeCodeManager(TADDR moduleBase,
                           PTR_VOID pvManagedCodeStartRange, UInt32 cbManagedCodeRange,
@@ -21,6 +72,8 @@ public:
 
     virtual ~UnixNativeCodeManager();
 
+    bool SetUnwindTable(PTR_VOID pvUnwindTable, UInt32 cbUnwindTable);
+
     //
     // Code manager methods
     //
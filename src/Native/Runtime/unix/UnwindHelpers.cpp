@@ -42,6 +42,7 @@ using libunwind::LocalAddressSpace;
 using libunwind::EHHeaderParser;
 #if _LIBUNWIND_SUPPORT_DWARF_UNWIND
 using libunwind::DwarfInstructions;
+using libunwind::CFI_Parser;
 #endif
 using libunwind::UnwindInfoSections;
 
@@ -701,6 +702,164 @@ void Registers_arm64_rt::setRegister(int num, uint64_t value, uint64_t location)
 
 #endif // TARGET_ARM64
 
+#if defined(TARGET_AMD64) && _LIBUNWIND_SUPPORT_DWARF_UNWIND
+
+// The CFI of a method describes every PC with the same few rules: the CFA is RSP or RBP plus an offset, and
+// the return address and the saved callee-saved registers are stored at offsets from the CFA. Once those are
+// known for a PC, unwinding it doesn't need the unwind sections to be located, the FDE to be looked up or the
+// CFI to be interpreted again, so the rules of recently unwound PCs are kept in a cache in front of
+// DoTheStep. PCs whose CFI uses anything else (expressions, registers saved in other registers, ...) always
+// take the full path.
+enum UnwindRuleSavedRegister
+{
+    URSR_Rbx,
+    URSR_Rbp,
+    URSR_R12,
+    URSR_R13,
+    URSR_R14,
+    URSR_R15,
+    URSR_Count
+};
+
+struct UnwindRule
+{
+    bool m_cfaIsRbp;                                // CFA is based on RBP rather than RSP
+    int32_t m_cfaOffset;
+    int32_t m_returnAddressOffset;                  // Offset of the return address from the CFA
+    int32_t m_savedRegisterOffsets[URSR_Count];     // Offsets from the CFA, 0 if the register is not saved
+};
+
+// Each entry is protected by a sequence number that is odd while the entry is being updated, so the cache
+// can be read and updated concurrently without locks, the same way as the method info cache of
+// UnixNativeCodeManager. Managed code is never unloaded, so entries never go stale.
+struct UnwindRuleCacheEntry
+{
+    volatile int32_t m_sequence;
+    uintptr_t m_pc;
+    UnwindRule m_rule;
+};
+
+static const uint32_t UnwindRuleCacheSize = 1024;
+static UnwindRuleCacheEntry s_unwindRuleCache[UnwindRuleCacheSize];
+
+static UnwindRuleCacheEntry * GetUnwindRuleCacheEntry(uintptr_t pc)
+{
+    return &s_unwindRuleCache[((pc >> 2) ^ (pc >> 12)) % UnwindRuleCacheSize];
+}
+
+static bool FindCachedUnwindRule(uintptr_t pc, UnwindRule * pRule)
+{
+    UnwindRuleCacheEntry * pEntry = GetUnwindRuleCacheEntry(pc);
+
+    int32_t sequence = pEntry->m_sequence;
+    if ((sequence & 1) != 0)
+        return false;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    uintptr_t cachedPC = pEntry->m_pc;
+    *pRule = pEntry->m_rule;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    // The entry is only valid if it was not updated while we were reading it
+    return (cachedPC == pc) && (pEntry->m_sequence == sequence);
+}
+
+static void CacheUnwindRule(uintptr_t pc, const UnwindRule * pRule)
+{
+    UnwindRuleCacheEntry * pEntry = GetUnwindRuleCacheEntry(pc);
+
+    // If another thread is updating the entry at the same time just leave it alone
+    int32_t sequence = pEntry->m_sequence;
+    if (((sequence & 1) != 0) || !__sync_bool_compare_and_swap(&pEntry->m_sequence, sequence, sequence + 1))
+        return;
+
+    pEntry->m_pc = pc;
+    pEntry->m_rule = *pRule;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    pEntry->m_sequence = sequence + 2;
+}
+
+// Runs the CFI of the FDE at fdeStart up to pc and converts the result into an UnwindRule. Returns false if
+// the CFI can't be expressed that way.
+static bool CompileUnwindRule(uintptr_t pc, uintptr_t fdeStart, UnwindRule * pRule)
+{
+    typedef CFI_Parser<LocalAddressSpace> CFI;
+
+    CFI::FDE_Info fdeInfo;
+    CFI::CIE_Info cieInfo;
+    if (CFI::decodeFDE(_addressSpace, fdeStart, &fdeInfo, &cieInfo) != NULL)
+        return false;
+
+    CFI::PrologInfo prolog;
+    if (!CFI::parseFDEInstructions(_addressSpace, fdeInfo, cieInfo, pc, Registers_REGDISPLAY::getArch(), &prolog))
+        return false;
+
+    if ((prolog.cfaRegister != UNW_X86_64_RSP) && (prolog.cfaRegister != UNW_X86_64_RBP))
+        return false;
+
+    if (cieInfo.returnAddressRegister != Registers_REGDISPLAY::lastDwarfRegNum())
+        return false;
+
+    pRule->m_cfaIsRbp = (prolog.cfaRegister == UNW_X86_64_RBP);
+    pRule->m_cfaOffset = prolog.cfaRegisterOffset;
+    pRule->m_returnAddressOffset = 0;
+    for (int i = 0; i < URSR_Count; i++)
+        pRule->m_savedRegisterOffsets[i] = 0;
+
+    for (int i = 0; i <= Registers_REGDISPLAY::lastDwarfRegNum(); i++)
+    {
+        const CFI::RegisterLocation & savedRegister = prolog.savedRegisters[i];
+        if (savedRegister.location == CFI::kRegisterUnused)
+            continue;
+
+        if ((savedRegister.location != CFI::kRegisterInCFA) || (savedRegister.value == 0))
+            return false;
+
+        int32_t offset = (int32_t)savedRegister.value;
+        switch (i)
+        {
+        case UNW_X86_64_RBX: pRule->m_savedRegisterOffsets[URSR_Rbx] = offset; break;
+        case UNW_X86_64_RBP: pRule->m_savedRegisterOffsets[URSR_Rbp] = offset; break;
+        case UNW_X86_64_R12: pRule->m_savedRegisterOffsets[URSR_R12] = offset; break;
+        case UNW_X86_64_R13: pRule->m_savedRegisterOffsets[URSR_R13] = offset; break;
+        case UNW_X86_64_R14: pRule->m_savedRegisterOffsets[URSR_R14] = offset; break;
+        case UNW_X86_64_R15: pRule->m_savedRegisterOffsets[URSR_R15] = offset; break;
+        default:
+            if (i != (int)cieInfo.returnAddressRegister)
+                return false;
+            pRule->m_returnAddressOffset = offset;
+            break;
+        }
+    }
+
+    return pRule->m_returnAddressOffset != 0;
+}
+
+// Does the same as stepWithDwarf does for the CFI the rule was compiled from
+static void StepWithUnwindRule(const UnwindRule * pRule, REGDISPLAY *regs)
+{
+    uintptr_t cfa = (pRule->m_cfaIsRbp ? *regs->pRbp : regs->SP) + pRule->m_cfaOffset;
+
+    const int32_t * pOffsets = pRule->m_savedRegisterOffsets;
+    if (pOffsets[URSR_Rbx] != 0) regs->pRbx = (PTR_UIntNative)(cfa + pOffsets[URSR_Rbx]);
+    if (pOffsets[URSR_Rbp] != 0) regs->pRbp = (PTR_UIntNative)(cfa + pOffsets[URSR_Rbp]);
+    if (pOffsets[URSR_R12] != 0) regs->pR12 = (PTR_UIntNative)(cfa + pOffsets[URSR_R12]);
+    if (pOffsets[URSR_R13] != 0) regs->pR13 = (PTR_UIntNative)(cfa + pOffsets[URSR_R13]);
+    if (pOffsets[URSR_R14] != 0) regs->pR14 = (PTR_UIntNative)(cfa + pOffsets[URSR_R14]);
+    if (pOffsets[URSR_R15] != 0) regs->pR15 = (PTR_UIntNative)(cfa + pOffsets[URSR_R15]);
+
+    // By definition, the CFA is the stack pointer at the call site
+    regs->IP = *(uintptr_t *)(cfa + pRule->m_returnAddressOffset);
+    regs->SP = cfa;
+    regs->pIP = PTR_PCODE(regs->SP - sizeof(TADDR));
+}
+
+#endif // TARGET_AMD64 && _LIBUNWIND_SUPPORT_DWARF_UNWIND
+
 bool DoTheStep(uintptr_t pc, UnwindInfoSections uwInfoSections, REGDISPLAY *regs)
 {
 #if defined(TARGET_AMD64)
@@ -725,6 +884,16 @@ bool DoTheStep(uintptr_t pc, UnwindInfoSections uwInfoSections, REGDISPLAY *regs
     unw_proc_info_t procInfo;
     uc.getInfo(&procInfo);
 
+#if defined(TARGET_AMD64)
+    UnwindRule rule;
+    if (CompileUnwindRule(pc, procInfo.unwind_info, &rule))
+    {
+        CacheUnwindRule(pc, &rule);
+        StepWithUnwindRule(&rule, regs);
+        return true;
+    }
+#endif
+
 #if defined(TARGET_ARM64)
     DwarfInstructions<LocalAddressSpace, Registers_arm64_rt> dwarfInst;
     int stepRet = dwarfInst.stepWithDwarf(_addressSpace, pc, procInfo.unwind_info, *(Registers_arm64_rt*)regs);
@@ -759,6 +928,14 @@ bool UnwindHelpers::StepFrame(REGDISPLAY *regs)
     UnwindInfoSections uwInfoSections;
 #if _LIBUNWIND_SUPPORT_DWARF_UNWIND
     uintptr_t pc = regs->GetIP();
+#if defined(TARGET_AMD64)
+    UnwindRule rule;
+    if (FindCachedUnwindRule(pc, &rule))
+    {
+        StepWithUnwindRule(&rule, regs);
+        return true;
+    }
+#endif
     if (!_addressSpace.findUnwindSections(pc, uwInfoSections))
     {
         return false;
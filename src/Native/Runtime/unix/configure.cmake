@@ -25,6 +25,7 @@ check_library_exists(pthread pthread_condattr_setclock "" HAVE_PTHREAD_CONDATTR_
 check_library_exists(pthread pthread_getthreadid_np "" HAVE_PTHREAD_GETTHREADID_NP)
 
 check_function_exists(clock_nanosleep HAVE_CLOCK_NANOSLEEP)
+check_cxx_symbol_exists(memfd_create sys/mman.h HAVE_MEMFD_CREATE)
 check_function_exists(sysctl HAVE_SYSCTL)
 check_function_exists(sysconf HAVE_SYSCONF)
 
@@ -114,4 +115,25 @@ int main(int argc, char **argv)
     return 0;
 }" HAVE_THREAD_LOCAL)
 
+check_cxx_source_compiles("
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    int x = 0;
+    return (int)syscall(SYS_futex, &x, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, 1, 0, 0, FUTEX_BITSET_MATCH_ANY);
+}" HAVE_LINUX_FUTEX)
+
+check_cxx_source_compiles("
+#include <linux/membarrier.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    return (int)syscall(SYS_membarrier, MEMBARRIER_CMD_REGISTER_PRIVATE_EXPEDITED, 0);
+}" HAVE_LINUX_MEMBARRIER)
+
 configure_file(${CMAKE_CURRENT_LIST_DIR}/config.h.in ${CMAKE_CURRENT_BINARY_DIR}/config.h)
@@ -19,6 +19,7 @@
 
 #define GCINFODECODER_NO_EE
 #include "coreclr/gcinfodecoder.cpp"
+#include "GcLiveSlotCache.h"
 
 #define UBF_FUNC_KIND_MASK      0x03
 #define UBF_FUNC_KIND_ROOT      0x00
@@ -180,10 +181,13 @@ CoffNativeCodeManager::CoffNativeCodeManager(TADDR moduleBase,
       m_pRuntimeFunctionTable(pRuntimeFunctionTable), m_nRuntimeFunctionTable(nRuntimeFunctionTable),
       m_pClasslibFunctions(pClasslibFunctions), m_nClasslibFunctions(nClasslibFunctions)
 {
+    // The cache is an optimization, GC refs are just decoded every time without it
+    m_pGcLiveSlotCache = new (nothrow) GcLiveSlotCache();
 }
 
 CoffNativeCodeManager::~CoffNativeCodeManager()
 {
+    delete m_pGcLiveSlotCache;
 }
 
 static int LookupUnwindInfoForMethod(UInt32 relativePc,
@@ -338,6 +342,24 @@ void CoffNativeCodeManager::EnumGcRefs(MethodInfo *    pMethodInfo,
 {
     CoffNativeMethodInfo * pNativeMethodInfo = (CoffNativeMethodInfo *)pMethodInfo;
 
+    ICodeManagerFlags flags = (ICodeManagerFlags)0;
+    if (pNativeMethodInfo->executionAborted)
+        flags = ICodeManagerFlags::ExecutionAborted;
+    if (IsFilter(pMethodInfo))
+        flags = (ICodeManagerFlags)(flags | ICodeManagerFlags::NoReportUntracked);
+
+    // Only the frames that are reported without flags are cached, the others are rare
+    bool useLiveSlotCache = (flags == 0) && (m_pGcLiveSlotCache != NULL);
+    if (useLiveSlotCache)
+    {
+        GcLiveSlotList * pCachedLiveSlots = m_pGcLiveSlotCache->Lookup(safePointAddress);
+        if (pCachedLiveSlots != NULL)
+        {
+            GcInfoDecoder::ReportLiveSlots(pCachedLiveSlots, pRegisterSet, flags, hCallback->pCallback, hCallback);
+            return;
+        }
+    }
+
     size_t unwindDataBlobSize;
     PTR_VOID pUnwindDataBlob = GetUnwindDataBlob(m_moduleBase, pNativeMethodInfo->mainRuntimeFunction, &unwindDataBlobSize);
 
@@ -360,11 +382,14 @@ void CoffNativeCodeManager::EnumGcRefs(MethodInfo *    pMethodInfo,
         codeOffset - 1 // TODO: Is this adjustment correct?
         );
 
-    ICodeManagerFlags flags = (ICodeManagerFlags)0;
-    if (pNativeMethodInfo->executionAborted)
-        flags = ICodeManagerFlags::ExecutionAborted;
-    if (IsFilter(pMethodInfo))
-        flags = (ICodeManagerFlags)(flags | ICodeManagerFlags::NoReportUntracked);
+    GcLiveSlot liveSlots[GcLiveSlotCache::MaxSlots];
+    GcLiveSlotList liveSlotList;
+    if (useLiveSlotCache)
+    {
+        liveSlotList.pSlots = liveSlots;
+        liveSlotList.MaxSlots = GcLiveSlotCache::MaxSlots;
+        decoder.RecordLiveSlots(&liveSlotList);
+    }
 
     if (!decoder.EnumerateLiveSlots(
         pRegisterSet,
@@ -376,6 +401,11 @@ void CoffNativeCodeManager::EnumGcRefs(MethodInfo *    pMethodInfo,
     {
         assert(false);
     }
+
+    if (useLiveSlotCache && liveSlotList.IsComplete())
+    {
+        m_pGcLiveSlotCache->Add(safePointAddress, &liveSlotList);
+    }
 }
 
 UIntNative CoffNativeCodeManager::GetConservativeUpperBoundForOutgoingArgs(MethodInfo * pMethodInfo, REGDISPLAY * pRegisterSet)
@@ -822,6 +852,8 @@ bool RhRegisterOSModule(void * pModule,
                         void * pvUnboxingStubsStartRange, UInt32 cbUnboxingStubsRange,
                         void ** pClasslibFunctions, UInt32 nClasslibFunctions)
 {
+    STARTUP_TIMELINE_EVENT(REGISTER_OS_MODULE_BEGIN);
+
     PIMAGE_DOS_HEADER pDosHeader = (PIMAGE_DOS_HEADER)pModule;
     PIMAGE_NT_HEADERS pNTHeaders = (PIMAGE_NT_HEADERS)((TADDR)pModule + pDosHeader->e_lfanew);
 
@@ -847,5 +879,7 @@ bool RhRegisterOSModule(void * pModule,
 
     pCoffNativeCodeManager.SuppressRelease();
 
+    STARTUP_TIMELINE_EVENT(REGISTER_OS_MODULE_COMPLETE);
+
     return true;
 }
@@ -37,6 +37,8 @@ struct T_RUNTIME_FUNCTION {
 
 typedef DPTR(T_RUNTIME_FUNCTION) PTR_RUNTIME_FUNCTION;
 
+class GcLiveSlotCache;
+
 class CoffNativeCodeManager : public ICodeManager
 {
     TADDR m_moduleBase;
@@ -50,6 +52,9 @@ class CoffNativeCodeManager : public ICodeManager
     PTR_PTR_VOID m_pClasslibFunctions;
     UInt32 m_nClasslibFunctions;
 
+    // Live slots at the safe points GCs found the methods stopped at, see GcLiveSlotCache.h
+    GcLiveSlotCache * m_pGcLiveSlotCache;
+
 public:
     CoffNativeCodeManager(TADDR moduleBase, 
                           PTR_VOID pvManagedCodeStartRange, UInt32 cbManagedCodeRange,
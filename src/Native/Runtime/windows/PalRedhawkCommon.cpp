@@ -243,6 +243,11 @@ REDHAWK_PALEXPORT Int32 REDHAWK_PALAPI PalGetProcessCpuCount()
     }
 }
 
+REDHAWK_PALEXPORT UInt32 REDHAWK_PALAPI PalGetCurrentProcessorNumber()
+{
+    return ::GetCurrentProcessorNumber();
+}
+
 //Reads the entire contents of the file into the specified buffer, buff
 //returns the number of bytes read if the file is successfully read
 //returns 0 if the file is not found, size is greater than maxBytesToRead or the file couldn't be opened or read
@@ -278,6 +283,17 @@ REDHAWK_PALEXPORT UInt32 REDHAWK_PALAPI PalReadFileContents(_In_z_ const TCHAR*
     return bytesRead;
 }
 
+REDHAWK_PALEXPORT HANDLE REDHAWK_PALAPI PalCreateFileForWriting(_In_z_ const TCHAR* fileName)
+{
+    return PalCreateFileW(fileName, GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+}
+
+REDHAWK_PALEXPORT UInt32_BOOL REDHAWK_PALAPI PalWriteFileContents(HANDLE hFile, _In_reads_bytes_(cbBuffer) const void* pBuffer, UInt32 cbBuffer)
+{
+    DWORD cbWritten;
+    return WriteFile(hFile, pBuffer, cbBuffer, &cbWritten, NULL) && (cbWritten == cbBuffer);
+}
+
 
 // Retrieves the entire range of memory dedicated to the calling thread's stack.  This does
 // not get the current dynamic bounds of the stack, which can be significantly smaller than 
@@ -381,6 +381,11 @@ REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalStartFinalizerThread(_In_ BackgroundCal
     return PalStartBackgroundWork(callback, pCallbackContext, TRUE) != NULL;
 }
 
+REDHAWK_PALEXPORT bool REDHAWK_PALAPI PalSetFlagOnSignal(UInt32 /*signal*/, _In_ Int32 volatile * /*pFlag*/)
+{
+    return false;
+}
+
 REDHAWK_PALEXPORT UInt32 REDHAWK_PALAPI PalGetTickCount()
 {
 #pragma warning(push)
@@ -26,39 +26,29 @@ static CrstStatic s_initializeYieldProcessorNormalizedCrst;
 unsigned int g_yieldsPerNormalizedYield = 1; // current value is for Skylake processors, this is expected to be ~8 for pre-Skylake
 unsigned int g_optimalMaxNormalizedYieldsPerSpinIteration = 7;
 
+// The duration of a yield changes with the frequency the processor runs at, so the measurement is repeated from time to time
+// by RefreshYieldProcessorNormalized. A measurement is only ever inflated, by the thread being interrupted or descheduled while
+// measuring, so the shortest of the recent measurements is the one used. Old measurements drop out of the window, so a lasting
+// change of the frequency is picked up within NsPerYieldMeasurementCount refreshes.
+const unsigned int NsPerYieldMeasurementCount = 8;
+const unsigned int MeasurementIntervalMs = 4000;
+static double s_nsPerYieldMeasurements[NsPerYieldMeasurementCount];
+static unsigned int s_nextNsPerYieldMeasurementIndex = 0;
+static ULONGLONG s_lastMeasurementTicks = 0;
+static ULONGLONG s_ticksPerSecond = 0;
+
 void InitializeYieldProcessorNormalizedCrst()
 {
     WRAPPER_NO_CONTRACT;
     s_initializeYieldProcessorNormalizedCrst.Init(CrstYieldProcessorNormalized);
 }
 
-static void InitializeYieldProcessorNormalized()
+// Measures the nanoseconds per yield for about the given duration. Must be called with the lock held.
+static double MeasureNsPerYield(ULONGLONG measureDurationTicks)
 {
-    WRAPPER_NO_CONTRACT;
-
-    CrstHolder lock(&s_initializeYieldProcessorNormalizedCrst);
-
-    if (s_isYieldProcessorNormalizedInitialized)
-    {
-        return;
-    }
-
-    // Intel pre-Skylake processor: measured typically 14-17 cycles per yield
-    // Intel post-Skylake processor: measured typically 125-150 cycles per yield
-    const int MeasureDurationMs = 10;
     const int NsPerSecond = 1000 * 1000 * 1000;
 
     LARGE_INTEGER li;
-    if (!PalQueryPerformanceFrequency(&li) || (ULONGLONG)li.QuadPart < 1000 / MeasureDurationMs)
-    {
-        // High precision clock not available or clock resolution is too low, resort to defaults
-        s_isYieldProcessorNormalizedInitialized = true;
-        return;
-    }
-    ULONGLONG ticksPerSecond = li.QuadPart;
-
-    // Measure the nanosecond delay per yield
-    ULONGLONG measureDurationTicks = ticksPerSecond / (1000 / MeasureDurationMs);
     unsigned int yieldCount = 0;
     PalQueryPerformanceCounter(&li);
     ULONGLONG startTicks = li.QuadPart;
@@ -78,12 +68,33 @@ static void InitializeYieldProcessorNormalized()
         ULONGLONG nowTicks = li.QuadPart;
         elapsedTicks = nowTicks - startTicks;
     } while (elapsedTicks < measureDurationTicks);
-    double nsPerYield = (double)elapsedTicks * NsPerSecond / ((double)yieldCount * ticksPerSecond);
+
+    s_lastMeasurementTicks = startTicks + elapsedTicks;
+
+    double nsPerYield = (double)elapsedTicks * NsPerSecond / ((double)yieldCount * s_ticksPerSecond);
     if (nsPerYield < 1)
     {
         nsPerYield = 1;
     }
 
+    return nsPerYield;
+}
+
+// Records a measurement and updates the normalization from the shortest recent one. Must be called with the lock held.
+static void UpdateYieldProcessorNormalized(double nsPerYieldMeasurement)
+{
+    s_nsPerYieldMeasurements[s_nextNsPerYieldMeasurementIndex] = nsPerYieldMeasurement;
+    s_nextNsPerYieldMeasurementIndex = (s_nextNsPerYieldMeasurementIndex + 1) % NsPerYieldMeasurementCount;
+
+    double nsPerYield = nsPerYieldMeasurement;
+    for (unsigned int i = 0; i < NsPerYieldMeasurementCount; ++i)
+    {
+        if ((s_nsPerYieldMeasurements[i] != 0) && (s_nsPerYieldMeasurements[i] < nsPerYield))
+        {
+            nsPerYield = s_nsPerYieldMeasurements[i];
+        }
+    }
+
     // Calculate the number of yields required to span the duration of a normalized yield. Since nsPerYield is at least 1, this
     // value is naturally limited to MinNsPerNormalizedYield.
     int yieldsPerNormalizedYield = (int)(MinNsPerNormalizedYield / nsPerYield + 0.5);
@@ -103,13 +114,48 @@ static void InitializeYieldProcessorNormalized()
         optimalMaxNormalizedYieldsPerSpinIteration = 1;
     }
 
+    if ((g_yieldsPerNormalizedYield == (unsigned int)yieldsPerNormalizedYield) &&
+        (g_optimalMaxNormalizedYieldsPerSpinIteration == (unsigned int)optimalMaxNormalizedYieldsPerSpinIteration))
+    {
+        return;
+    }
+
+    // Spin-waits read the values without the lock, a spin-wait that reads one old and one new value is still reasonable
     g_yieldsPerNormalizedYield = yieldsPerNormalizedYield;
     g_optimalMaxNormalizedYieldsPerSpinIteration = optimalMaxNormalizedYieldsPerSpinIteration;
-    s_isYieldProcessorNormalizedInitialized = true;
 
     GCHeapUtilities::GetGCHeap()->SetYieldProcessorScalingFactor((float)yieldsPerNormalizedYield);
 }
 
+static void InitializeYieldProcessorNormalized()
+{
+    WRAPPER_NO_CONTRACT;
+
+    CrstHolder lock(&s_initializeYieldProcessorNormalizedCrst);
+
+    if (s_isYieldProcessorNormalizedInitialized)
+    {
+        return;
+    }
+
+    // Intel pre-Skylake processor: measured typically 14-17 cycles per yield
+    // Intel post-Skylake processor: measured typically 125-150 cycles per yield
+    const int MeasureDurationMs = 10;
+
+    LARGE_INTEGER li;
+    if (!PalQueryPerformanceFrequency(&li) || (ULONGLONG)li.QuadPart < 1000 / MeasureDurationMs)
+    {
+        // High precision clock not available or clock resolution is too low, resort to defaults
+        s_isYieldProcessorNormalizedInitialized = true;
+        return;
+    }
+    s_ticksPerSecond = li.QuadPart;
+
+    // Measure the nanosecond delay per yield
+    UpdateYieldProcessorNormalized(MeasureNsPerYield(s_ticksPerSecond / (1000 / MeasureDurationMs)));
+    s_isYieldProcessorNormalizedInitialized = true;
+}
+
 void EnsureYieldProcessorNormalizedInitialized()
 {
     WRAPPER_NO_CONTRACT;
@@ -119,3 +165,40 @@ void EnsureYieldProcessorNormalizedInitialized()
         InitializeYieldProcessorNormalized();
     }
 }
+
+// Measures the delay per yield again if the last measurement is more than MeasurementIntervalMs old. The measurement is
+// shorter than the initial one, so that it costs little on the thread that does it. Called by the finalizer thread whenever
+// it goes back to waiting, so a process that is idle doesn't wake up to measure.
+void RefreshYieldProcessorNormalized()
+{
+    WRAPPER_NO_CONTRACT;
+
+    if (!s_isYieldProcessorNormalizedInitialized || (s_ticksPerSecond == 0))
+    {
+        return;
+    }
+
+    const int RefreshMeasureDurationMs = 1;
+    if (s_ticksPerSecond < 1000 / RefreshMeasureDurationMs)
+    {
+        return;
+    }
+
+    LARGE_INTEGER li;
+    PalQueryPerformanceCounter(&li);
+    if ((ULONGLONG)li.QuadPart - s_lastMeasurementTicks < s_ticksPerSecond / 1000 * MeasurementIntervalMs)
+    {
+        return;
+    }
+
+    CrstHolder lock(&s_initializeYieldProcessorNormalizedCrst);
+
+    // Another thread may have measured while this one waited for the lock
+    PalQueryPerformanceCounter(&li);
+    if ((ULONGLONG)li.QuadPart - s_lastMeasurementTicks < s_ticksPerSecond / 1000 * MeasurementIntervalMs)
+    {
+        return;
+    }
+
+    UpdateYieldProcessorNormalized(MeasureNsPerYield(s_ticksPerSecond / (1000 / RefreshMeasureDurationMs)));
+}
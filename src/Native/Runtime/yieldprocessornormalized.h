@@ -29,6 +29,7 @@ extern unsigned int g_optimalMaxNormalizedYieldsPerSpinIteration;
 
 void InitializeYieldProcessorNormalizedCrst();
 void EnsureYieldProcessorNormalizedInitialized();
+void RefreshYieldProcessorNormalized();
 
 class YieldProcessorNormalizationInfo
 {
@@ -135,6 +136,28 @@ FORCEINLINE void YieldProcessorNormalized(unsigned int count)
     YieldProcessorNormalized(YieldProcessorNormalizationInfo(), count);
 }
 
+// See YieldProcessorNormalized() for preliminary info. Delays execution of the current thread for approximately the given number
+// of nanoseconds, for spin-waits that are tuned in time rather than in yields, like a wait for another processor to make
+// progress. Typical usage:
+//     if (!conditionExpectedWithinMicroseconds)
+//     {
+//         YieldProcessorNormalizationInfo normalizationInfo;
+//         do
+//         {
+//             YieldProcessorNormalizedForDuration(normalizationInfo, 50 * 1000);
+//         } while (!conditionExpectedWithinMicroseconds);
+//     }
+FORCEINLINE void YieldProcessorNormalizedForDuration(const YieldProcessorNormalizationInfo &normalizationInfo, unsigned int ns)
+{
+    unsigned int count = ns / MinNsPerNormalizedYield;
+    if (count == 0)
+    {
+        count = 1;
+    }
+
+    YieldProcessorNormalized(normalizationInfo, count);
+}
+
 // Please DO NOT use this function in new code! See YieldProcessorNormalizedForPreSkylakeCount(preSkylakeCount) for preliminary
 // info. Typical usage:
 //     if (!condition)
@@ -65,6 +65,17 @@ check_include_files(gnu/lib-names.h HAVE_GNU_LIBNAMES_H)
 
 check_function_exists(_NSGetEnviron HAVE__NSGETENVIRON)
 
+check_cxx_source_compiles("
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int main(int argc, char **argv)
+{
+    int x = 0;
+    return (int)syscall(SYS_futex, &x, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, 1, 0, 0, FUTEX_BITSET_MATCH_ANY);
+}" HAVE_LINUX_FUTEX)
+
 configure_file(
     ${CMAKE_CURRENT_SOURCE_DIR}/config.h.in
     ${CMAKE_CURRENT_BINARY_DIR}/config.h)
@@ -4,6 +4,9 @@
 
 #include "pal_common.h"
 #include <dlfcn.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 #if HAVE_GNU_LIBNAMES_H
@@ -37,15 +40,185 @@ extern "C" void* CoreLibNative_LoadLibrary(const char* filename)
     return dlopen(filename, RTLD_LAZY);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Symbol cache
+//
+// Lazily bound P/Invokes of different modules that import the same function each resolve it, and dlsym walks the hash tables
+// of the library and its dependencies every time. Resolved symbols are remembered per (handle, name), so a symbol is only
+// looked up once for the process. Only symbols that were found are cached: a symbol missing from the global scope may come
+// with a library that is loaded later. The entries of a handle are dropped when the library is freed, since the library may be
+// unloaded and another one loaded at the same handle.
+
+struct SymbolCacheEntry
+{
+    SymbolCacheEntry* next;
+    void* handle;
+    void* address;
+    uint32_t hash;
+    char name[1];           // Actually as long as the symbol name
+};
+
+static pthread_rwlock_t s_symbolCacheLock = PTHREAD_RWLOCK_INITIALIZER;
+static SymbolCacheEntry** s_symbolCacheBuckets = nullptr;
+static uint32_t s_symbolCacheBucketCount = 0;   // Power of 2
+static uint32_t s_symbolCacheCount = 0;
+
+static uint32_t HashSymbol(void* handle, const char* symbol)
+{
+    // FNV-1a of the name, mixed with the handle
+    uint32_t hash = 2166136261u ^ (uint32_t)((uintptr_t)handle >> 4);
+    for (const char* pch = symbol; *pch != '\0'; pch++)
+    {
+        hash = (hash ^ (uint8_t)*pch) * 16777619u;
+    }
+    return hash;
+}
+
+// Must be called with the lock held
+static SymbolCacheEntry* FindSymbolCacheEntry(void* handle, const char* symbol, uint32_t hash)
+{
+    if (s_symbolCacheBucketCount == 0)
+        return nullptr;
+
+    for (SymbolCacheEntry* entry = s_symbolCacheBuckets[hash & (s_symbolCacheBucketCount - 1)]; entry != nullptr; entry = entry->next)
+    {
+        if (entry->hash == hash && entry->handle == handle && strcmp(entry->name, symbol) == 0)
+            return entry;
+    }
+
+    return nullptr;
+}
+
+// Must be called with the lock held for writing. Failing to grow just leaves the chains longer.
+static void GrowSymbolCache()
+{
+    uint32_t newBucketCount = (s_symbolCacheBucketCount == 0) ? 256 : s_symbolCacheBucketCount * 2;
+    SymbolCacheEntry** newBuckets = static_cast<SymbolCacheEntry**>(calloc(newBucketCount, sizeof(SymbolCacheEntry*)));
+    if (newBuckets == nullptr)
+        return;
+
+    for (uint32_t i = 0; i < s_symbolCacheBucketCount; i++)
+    {
+        SymbolCacheEntry* entry = s_symbolCacheBuckets[i];
+        while (entry != nullptr)
+        {
+            SymbolCacheEntry* next = entry->next;
+            SymbolCacheEntry** bucket = &newBuckets[entry->hash & (newBucketCount - 1)];
+            entry->next = *bucket;
+            *bucket = entry;
+            entry = next;
+        }
+    }
+
+    free(s_symbolCacheBuckets);
+    s_symbolCacheBuckets = newBuckets;
+    s_symbolCacheBucketCount = newBucketCount;
+}
+
+static void AddSymbolCacheEntry(void* handle, const char* symbol, uint32_t hash, void* address)
+{
+    size_t nameLength = strlen(symbol);
+    SymbolCacheEntry* entry = static_cast<SymbolCacheEntry*>(malloc(offsetof(SymbolCacheEntry, name) + nameLength + 1));
+    if (entry == nullptr)
+        return;
+
+    entry->handle = handle;
+    entry->address = address;
+    entry->hash = hash;
+    memcpy(entry->name, symbol, nameLength + 1);
+
+    pthread_rwlock_wrlock(&s_symbolCacheLock);
+
+    if (FindSymbolCacheEntry(handle, symbol, hash) != nullptr)
+    {
+        // Another thread resolved the same symbol first
+        pthread_rwlock_unlock(&s_symbolCacheLock);
+        free(entry);
+        return;
+    }
+
+    if (s_symbolCacheCount >= s_symbolCacheBucketCount)
+        GrowSymbolCache();
+
+    if (s_symbolCacheBucketCount == 0)
+    {
+        pthread_rwlock_unlock(&s_symbolCacheLock);
+        free(entry);
+        return;
+    }
+
+    SymbolCacheEntry** bucket = &s_symbolCacheBuckets[hash & (s_symbolCacheBucketCount - 1)];
+    entry->next = *bucket;
+    *bucket = entry;
+    s_symbolCacheCount++;
+
+    pthread_rwlock_unlock(&s_symbolCacheLock);
+}
+
+static void RemoveSymbolCacheEntries(void* handle)
+{
+    pthread_rwlock_wrlock(&s_symbolCacheLock);
+
+    for (uint32_t i = 0; i < s_symbolCacheBucketCount; i++)
+    {
+        SymbolCacheEntry** link = &s_symbolCacheBuckets[i];
+        while (*link != nullptr)
+        {
+            SymbolCacheEntry* entry = *link;
+            if (entry->handle == handle)
+            {
+                *link = entry->next;
+                free(entry);
+                s_symbolCacheCount--;
+            }
+            else
+            {
+                link = &entry->next;
+            }
+        }
+    }
+
+    pthread_rwlock_unlock(&s_symbolCacheLock);
+}
+
 extern "C" void* CoreLibNative_GetProcAddress(void* handle, const char* symbol)
 {
+    uint32_t hash = HashSymbol(handle, symbol);
+
+    pthread_rwlock_rdlock(&s_symbolCacheLock);
+    SymbolCacheEntry* entry = FindSymbolCacheEntry(handle, symbol, hash);
+    void* address = (entry != nullptr) ? entry->address : nullptr;
+    pthread_rwlock_unlock(&s_symbolCacheLock);
+
+    if (address != nullptr)
+        return address;
+
     // We're not trying to disambiguate between "symbol was not found" and "symbol found, but
     // the value is null". .NET does not define a behavior for DllImports of null entrypoints,
     // so we might as well take the "not found" path on the managed side.
-    return dlsym(handle, symbol);
+    address = dlsym(handle, symbol);
+    if (address != nullptr)
+        AddSymbolCacheEntry(handle, symbol, hash, address);
+
+    return address;
+}
+
+// Resolves count symbols of the library at once, the address of symbols[i] is stored to addresses[i] or null if the symbol
+// isn't found. Returns the number of symbols that were found. A host can use it to bind the imports of a plugin up front.
+extern "C" int32_t CoreLibNative_GetProcAddresses(void* handle, const char** symbols, void** addresses, int32_t count)
+{
+    int32_t found = 0;
+    for (int32_t i = 0; i < count; i++)
+    {
+        addresses[i] = CoreLibNative_GetProcAddress(handle, symbols[i]);
+        if (addresses[i] != nullptr)
+            found++;
+    }
+    return found;
 }
 
 extern "C" void CoreLibNative_FreeLibrary(void* handle)
 {
+    RemoveSymbolCacheEntries(handle);
     dlclose(handle);
 }
@@ -4,6 +4,7 @@
 
 #include "pal_common.h"
 #include "pal_time.h"
+#include "rseqcpu.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -22,6 +23,10 @@ extern "C" char* CoreLibNative_GetEnv(const char* variable)
 
 extern "C" int32_t CoreLibNative_SchedGetCpu()
 {
+    int32_t rseqCpu = GetRseqCurrentProcessor();
+    if (rseqCpu >= 0)
+        return rseqCpu;
+
 #if HAVE_SCHED_GETCPU
     return sched_getcpu();
 #else
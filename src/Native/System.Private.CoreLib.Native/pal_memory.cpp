@@ -1,29 +1,80 @@
 // Licensed to the .NET Foundation under one or more agreements.
 // The .NET Foundation licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
+#include "pal_memory.h"
+
 #include <stdlib.h>
 #include <string.h>
 
-extern "C" void * CoreLibNative_MemAlloc(size_t size)
+static void *CrtAlloc(size_t size)
 {
     return malloc(size);
 }
 
-extern "C" void * CoreLibNative_MemAllocWithZeroInitialize(size_t size)
+static void *CrtAllocZeroed(size_t size)
 {
     return calloc(size, 1);
 }
 
-extern "C" void * CoreLibNative_MemReAlloc(void *ptr, size_t size)
+static void *CrtReAlloc(void *ptr, size_t size)
 {
     return realloc(ptr, size);
 }
 
-extern "C" void CoreLibNative_MemFree(void *ptr)
+static void CrtFree(void *ptr)
 {
     free(ptr);
 }
 
+static const CoreLibNativeMemoryAllocator s_crtAllocator = { CrtAlloc, CrtAllocZeroed, CrtReAlloc, CrtFree };
+
+static const CoreLibNativeMemoryAllocator *volatile s_allocator = nullptr;
+
+static const CoreLibNativeMemoryAllocator *InitializeAllocator()
+{
+    const char *name = getenv("RH_NativeAllocator");
+    const CoreLibNativeMemoryAllocator *allocator =
+        (name != nullptr && strcmp(name, "threadcache") == 0) ? GetThreadCacheMemoryAllocator() : &s_crtAllocator;
+
+    // Another thread may have chosen first, all threads must use the same allocator
+    const CoreLibNativeMemoryAllocator *previous = __sync_val_compare_and_swap(&s_allocator, nullptr, allocator);
+    return (previous != nullptr) ? previous : allocator;
+}
+
+static inline const CoreLibNativeMemoryAllocator *GetAllocator()
+{
+    const CoreLibNativeMemoryAllocator *allocator = s_allocator;
+    if (allocator == nullptr)
+        allocator = InitializeAllocator();
+    return allocator;
+}
+
+extern "C" bool CoreLibNative_SetMemoryAllocator(const CoreLibNativeMemoryAllocator *allocator)
+{
+    assert(allocator != nullptr);
+    return __sync_val_compare_and_swap(&s_allocator, nullptr, allocator) == nullptr;
+}
+
+extern "C" void * CoreLibNative_MemAlloc(size_t size)
+{
+    return GetAllocator()->Alloc(size);
+}
+
+extern "C" void * CoreLibNative_MemAllocWithZeroInitialize(size_t size)
+{
+    return GetAllocator()->AllocZeroed(size);
+}
+
+extern "C" void * CoreLibNative_MemReAlloc(void *ptr, size_t size)
+{
+    return GetAllocator()->ReAlloc(ptr, size);
+}
+
+extern "C" void CoreLibNative_MemFree(void *ptr)
+{
+    GetAllocator()->Free(ptr);
+}
+
 extern "C" void CoreLibNative_MemSet(void *ptr, int c, size_t size)
 {
    memset(ptr, c, size);
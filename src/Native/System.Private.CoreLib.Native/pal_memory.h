@@ -0,0 +1,38 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+#pragma once
+
+#include "pal_common.h"
+
+#include <stddef.h>
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Native memory allocator
+//
+// CoreLibNative_MemAlloc and friends, which back Marshal.AllocHGlobal and the other native allocations of CoreLib, go through
+// the allocator that is chosen when the first of them is made and never changes after that:
+//   - The allocator passed to CoreLibNative_SetMemoryAllocator by native code of the process that runs before any of CoreLib's
+//     native allocations, for example a static initializer of a native library linked into the executable.
+//   - Otherwise the bundled thread caching allocator when the RH_NativeAllocator environment variable is "threadcache".
+//   - Otherwise malloc, calloc, realloc and free.
+//
+// The functions of an allocator must be safe to call from any thread, and ReAlloc and Free must accept the blocks of any of
+// Alloc, AllocZeroed and ReAlloc, like the C runtime's functions do.
+
+struct CoreLibNativeMemoryAllocator
+{
+    void *(*Alloc)(size_t size);
+    void *(*AllocZeroed)(size_t size);
+    void *(*ReAlloc)(void *ptr, size_t size);
+    void (*Free)(void *ptr);
+};
+
+// Returns false if CoreLib already allocated native memory through another allocator.
+extern "C" bool CoreLibNative_SetMemoryAllocator(const CoreLibNativeMemoryAllocator *allocator);
+
+// Thread caching size class allocator. Small blocks come from per-thread free lists of their size class, which are refilled
+// from and trimmed to central free lists in batches, so most allocations and frees don't synchronize with other threads.
+// Memory of small blocks is kept for reuse rather than returned to the system. Large blocks go straight to malloc.
+const CoreLibNativeMemoryAllocator *GetThreadCacheMemoryAllocator();
@@ -0,0 +1,368 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "pal_memory.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <pthread.h>
+
+//
+// Every block starts with a header that records its size class, so the block can be freed and reallocated without the
+// caller knowing its size, and it keeps the user part of the block aligned the way malloc aligns.
+//
+// Size classes are 16 bytes apart up to 128 bytes and then four per power of 2 up to MAX_SMALL_SIZE, which limits the waste
+// of a block to a quarter of its size. Larger blocks are allocated with malloc and have a header too.
+//
+// A thread takes blocks from the free list of its cache for the class. An empty list is refilled with a batch of blocks from
+// the central list of the class, or from new memory when that is empty too, and a list that grows past two batches returns a
+// batch to the central list. The size of a batch is chosen so a batch holds about BATCH_BYTES, which bounds the memory a thread
+// keeps cached per class.
+//
+
+#define HEADER_SIZE         16
+#define MAX_SMALL_SIZE      (32 * 1024)
+#define SMALL_CLASS_COUNT   8           // 16 to 128 bytes
+#define CLASS_COUNT         (SMALL_CLASS_COUNT + 8 * 4)
+#define LARGE_CLASS         0xFFFFFFFF
+#define BATCH_BYTES         (64 * 1024)
+#define MAX_BATCH_COUNT     64
+
+static_assert(HEADER_SIZE >= sizeof(uint32_t) + sizeof(size_t), "The header must hold the class and the size");
+
+struct BlockHeader
+{
+    uint32_t sizeClass;
+    size_t size;                        // Requested size of a large block
+};
+
+struct FreeBlock
+{
+    FreeBlock *next;
+};
+
+struct CentralFreeList
+{
+    pthread_mutex_t lock;
+    FreeBlock *head;
+    uint32_t count;
+};
+
+static CentralFreeList s_centralFreeLists[CLASS_COUNT];
+static pthread_once_t s_initializeOnce = PTHREAD_ONCE_INIT;
+
+static void InitializeCentralFreeLists()
+{
+    for (uint32_t i = 0; i < CLASS_COUNT; i++)
+    {
+        pthread_mutex_init(&s_centralFreeLists[i].lock, nullptr);
+        s_centralFreeLists[i].head = nullptr;
+        s_centralFreeLists[i].count = 0;
+    }
+}
+
+static inline uint32_t GetSizeClass(size_t size)
+{
+    if (size <= 128)
+        return (size == 0) ? 0 : (uint32_t)((size - 1) >> 4);
+
+    // size is in (2^k, 2^(k+1)] with k >= 7, split into four classes 2^(k-2) apart
+    uint32_t k = (uint32_t)(sizeof(unsigned long) * CHAR_BIT - 1 - __builtin_clzl((unsigned long)(size - 1)));
+    return SMALL_CLASS_COUNT + (k - 7) * 4 + (uint32_t)((size - 1 - ((size_t)1 << k)) >> (k - 2));
+}
+
+static inline size_t GetClassSize(uint32_t sizeClass)
+{
+    if (sizeClass < SMALL_CLASS_COUNT)
+        return (size_t)(sizeClass + 1) << 4;
+
+    uint32_t k = 7 + (sizeClass - SMALL_CLASS_COUNT) / 4;
+    uint32_t step = (sizeClass - SMALL_CLASS_COUNT) % 4;
+    return ((size_t)1 << k) + ((size_t)(step + 1) << (k - 2));
+}
+
+static inline uint32_t GetBatchCount(uint32_t sizeClass)
+{
+    size_t count = BATCH_BYTES / (GetClassSize(sizeClass) + HEADER_SIZE);
+    if (count < 2)
+        return 2;
+    if (count > MAX_BATCH_COUNT)
+        return MAX_BATCH_COUNT;
+    return (uint32_t)count;
+}
+
+static inline BlockHeader *GetHeader(void *ptr)
+{
+    return (BlockHeader *)((uint8_t *)ptr - HEADER_SIZE);
+}
+
+static inline void *GetUserPointer(void *block)
+{
+    return (uint8_t *)block + HEADER_SIZE;
+}
+
+// Moves up to count blocks of the central list to the list at *pHead, or carves new ones out of memory from malloc when the
+// central list is empty. Returns the number of blocks moved.
+static uint32_t FetchFromCentralFreeList(uint32_t sizeClass, FreeBlock **pHead, uint32_t count)
+{
+    CentralFreeList *central = &s_centralFreeLists[sizeClass];
+
+    pthread_mutex_lock(&central->lock);
+    uint32_t fetched = 0;
+    while (fetched < count && central->head != nullptr)
+    {
+        FreeBlock *block = central->head;
+        central->head = block->next;
+        block->next = *pHead;
+        *pHead = block;
+        fetched++;
+    }
+    central->count -= fetched;
+    pthread_mutex_unlock(&central->lock);
+
+    if (fetched != 0)
+        return fetched;
+
+    size_t blockSize = GetClassSize(sizeClass) + HEADER_SIZE;
+    uint8_t *memory = (uint8_t *)malloc(blockSize * count);
+    if (memory == nullptr)
+        return 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint8_t *block = memory + i * blockSize;
+        ((BlockHeader *)block)->sizeClass = sizeClass;
+
+        FreeBlock *freeBlock = (FreeBlock *)GetUserPointer(block);
+        freeBlock->next = *pHead;
+        *pHead = freeBlock;
+    }
+
+    return count;
+}
+
+static void ReleaseToCentralFreeList(uint32_t sizeClass, FreeBlock *first, FreeBlock *last, uint32_t count)
+{
+    CentralFreeList *central = &s_centralFreeLists[sizeClass];
+
+    pthread_mutex_lock(&central->lock);
+    last->next = central->head;
+    central->head = first;
+    central->count += count;
+    pthread_mutex_unlock(&central->lock);
+}
+
+class ThreadCache
+{
+    FreeBlock *m_heads[CLASS_COUNT];
+    uint32_t m_counts[CLASS_COUNT];
+
+public:
+    static thread_local bool t_isDestroyed;
+
+    ThreadCache()
+    {
+        pthread_once(&s_initializeOnce, InitializeCentralFreeLists);
+
+        memset(m_heads, 0, sizeof(m_heads));
+        memset(m_counts, 0, sizeof(m_counts));
+    }
+
+    // The blocks of an exiting thread go back to the central lists. Frees that happen later in the exit of the thread, from
+    // the destructors of other thread locals, go straight to the central lists.
+    ~ThreadCache()
+    {
+        for (uint32_t i = 0; i < CLASS_COUNT; i++)
+        {
+            if (m_heads[i] == nullptr)
+                continue;
+
+            FreeBlock *last = m_heads[i];
+            while (last->next != nullptr)
+                last = last->next;
+
+            ReleaseToCentralFreeList(i, m_heads[i], last, m_counts[i]);
+            m_heads[i] = nullptr;
+            m_counts[i] = 0;
+        }
+
+        t_isDestroyed = true;
+    }
+
+    void *Alloc(uint32_t sizeClass)
+    {
+        FreeBlock *block = m_heads[sizeClass];
+        if (block == nullptr)
+        {
+            m_counts[sizeClass] += FetchFromCentralFreeList(sizeClass, &m_heads[sizeClass], GetBatchCount(sizeClass));
+
+            block = m_heads[sizeClass];
+            if (block == nullptr)
+                return nullptr;
+        }
+
+        m_heads[sizeClass] = block->next;
+        m_counts[sizeClass]--;
+        return block;
+    }
+
+    void Free(uint32_t sizeClass, void *ptr)
+    {
+        FreeBlock *block = (FreeBlock *)ptr;
+        block->next = m_heads[sizeClass];
+        m_heads[sizeClass] = block;
+        m_counts[sizeClass]++;
+
+        uint32_t batchCount = GetBatchCount(sizeClass);
+        if (m_counts[sizeClass] <= 2 * batchCount)
+            return;
+
+        // Keep the most recently freed blocks, they are the most likely to still be in the cache of the processor
+        FreeBlock *last = block;
+        for (uint32_t i = 1; i < batchCount; i++)
+            last = last->next;
+
+        FreeBlock *first = last->next;
+        FreeBlock *end = first;
+        for (uint32_t i = 1; i < batchCount; i++)
+            end = end->next;
+
+        last->next = end->next;
+        m_counts[sizeClass] -= batchCount;
+        ReleaseToCentralFreeList(sizeClass, first, end, batchCount);
+    }
+};
+
+thread_local bool ThreadCache::t_isDestroyed = false;
+
+static inline ThreadCache *GetThreadCache()
+{
+    if (ThreadCache::t_isDestroyed)
+        return nullptr;
+
+    static thread_local ThreadCache t_cache;
+    return &t_cache;
+}
+
+static void *AllocSmall(uint32_t sizeClass)
+{
+    ThreadCache *cache = GetThreadCache();
+    if (cache != nullptr)
+        return cache->Alloc(sizeClass);
+
+    FreeBlock *block = nullptr;
+    if (FetchFromCentralFreeList(sizeClass, &block, 1) == 0)
+        return nullptr;
+
+    return block;
+}
+
+static void FreeSmall(uint32_t sizeClass, void *ptr)
+{
+    ThreadCache *cache = GetThreadCache();
+    if (cache != nullptr)
+    {
+        cache->Free(sizeClass, ptr);
+        return;
+    }
+
+    FreeBlock *block = (FreeBlock *)ptr;
+    ReleaseToCentralFreeList(sizeClass, block, block, 1);
+}
+
+static void *ThreadCacheAlloc(size_t size)
+{
+    if (size <= MAX_SMALL_SIZE)
+        return AllocSmall(GetSizeClass(size));
+
+    if (size > SIZE_MAX - HEADER_SIZE)
+        return nullptr;
+
+    void *block = malloc(size + HEADER_SIZE);
+    if (block == nullptr)
+        return nullptr;
+
+    ((BlockHeader *)block)->sizeClass = LARGE_CLASS;
+    ((BlockHeader *)block)->size = size;
+    return GetUserPointer(block);
+}
+
+static void *ThreadCacheAllocZeroed(size_t size)
+{
+    void *ptr = ThreadCacheAlloc(size);
+    if (ptr != nullptr)
+        memset(ptr, 0, size);
+    return ptr;
+}
+
+static void ThreadCacheFree(void *ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    BlockHeader *header = GetHeader(ptr);
+    if (header->sizeClass == LARGE_CLASS)
+    {
+        free(header);
+        return;
+    }
+
+    assert(header->sizeClass < CLASS_COUNT);
+    FreeSmall(header->sizeClass, ptr);
+}
+
+static void *ThreadCacheReAlloc(void *ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return ThreadCacheAlloc(size);
+
+    BlockHeader *header = GetHeader(ptr);
+    size_t oldSize;
+    if (header->sizeClass == LARGE_CLASS)
+    {
+        if (size > MAX_SMALL_SIZE)
+        {
+            if (size > SIZE_MAX - HEADER_SIZE)
+                return nullptr;
+
+            BlockHeader *newHeader = (BlockHeader *)realloc(header, size + HEADER_SIZE);
+            if (newHeader == nullptr)
+                return nullptr;
+
+            newHeader->size = size;
+            return GetUserPointer(newHeader);
+        }
+
+        oldSize = header->size;
+    }
+    else
+    {
+        // The block already has room when the new size is of the same class
+        oldSize = GetClassSize(header->sizeClass);
+        if (size <= MAX_SMALL_SIZE && GetSizeClass(size) == header->sizeClass)
+            return ptr;
+    }
+
+    void *newPtr = ThreadCacheAlloc(size);
+    if (newPtr == nullptr)
+        return nullptr;
+
+    memcpy(newPtr, ptr, (oldSize < size) ? oldSize : size);
+    ThreadCacheFree(ptr);
+    return newPtr;
+}
+
+static const CoreLibNativeMemoryAllocator s_threadCacheAllocator =
+{
+    ThreadCacheAlloc,
+    ThreadCacheAllocZeroed,
+    ThreadCacheReAlloc,
+    ThreadCacheFree,
+};
+
+const CoreLibNativeMemoryAllocator *GetThreadCacheMemoryAllocator()
+{
+    return &s_threadCacheAllocator;
+}
@@ -9,6 +9,17 @@
 #include <limits.h>
 #include <sched.h>
 
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if HAVE_LINUX_FUTEX
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // LowLevelMutex
 
@@ -27,6 +38,79 @@ extern "C" void CoreLibNative_LowLevelMutex_Release(LowLevelMutex *mutex)
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // LowLevelMonitor
 
+#if HAVE_LINUX_FUTEX
+
+LowLevelMonitor::LowLevelMonitor(bool abortOnFailure, bool *successRef)
+    : LowLevelMutex(abortOnFailure, successRef), m_sequence(0), m_waiterCount(0)
+{
+}
+
+void LowLevelMonitor::Wait()
+{
+    bool woken = Wait(-1);
+    assert(woken);
+
+    UnusedInRelease(woken);
+}
+
+// Returns false upon timeout or unexpected error, and true when the thread is woken up (could be a spurious wakeup, depending
+// on implementation)
+bool LowLevelMonitor::Wait(int32_t timeoutMilliseconds)
+{
+    assert(timeoutMilliseconds >= -1);
+
+    // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC timeout
+    timespec timeoutTimeSpec;
+    if (timeoutMilliseconds >= 0)
+    {
+        int error = clock_gettime(CLOCK_MONOTONIC, &timeoutTimeSpec);
+        assert(error == 0);
+        UnusedInRelease(error);
+        AddMillisecondsToTimeSpec(timeoutMilliseconds, &timeoutTimeSpec);
+    }
+
+    int32_t sequence = m_sequence;
+    m_waiterCount++;
+    Release();
+
+    int result =
+        (int)syscall(
+            SYS_futex,
+            &m_sequence,
+            FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+            sequence,
+            timeoutMilliseconds >= 0 ? &timeoutTimeSpec : nullptr,
+            nullptr,
+            FUTEX_BITSET_MATCH_ANY);
+    int error = result == 0 ? 0 : errno;
+    assert(error == 0 || error == EAGAIN || error == EINTR || error == ETIMEDOUT);
+
+    Acquire();
+    m_waiterCount--;
+    return error != ETIMEDOUT;
+}
+
+void LowLevelMonitor::Signal()
+{
+    // Called while holding the mutex, so the waiter count is accurate
+    __atomic_add_fetch(&m_sequence, 1, __ATOMIC_RELEASE);
+    if (m_waiterCount != 0)
+    {
+        syscall(SYS_futex, &m_sequence, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, 1, nullptr, nullptr, 0);
+    }
+}
+
+void LowLevelMonitor::SignalAll()
+{
+    __atomic_add_fetch(&m_sequence, 1, __ATOMIC_RELEASE);
+    if (m_waiterCount != 0)
+    {
+        syscall(SYS_futex, &m_sequence, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, INT_MAX, nullptr, nullptr, 0);
+    }
+}
+
+#else // HAVE_LINUX_FUTEX
+
 #if !(HAVE_MACH_ABSOLUTE_TIME || HAVE_PTHREAD_CONDATTR_SETCLOCK && HAVE_CLOCK_MONOTONIC)
 #error Don't know how to perform timed wait on this platform
 #endif
@@ -119,6 +203,8 @@ bool LowLevelMonitor::Wait(int32_t timeoutMilliseconds)
     return error == 0;
 }
 
+#endif // HAVE_LINUX_FUTEX
+
 extern "C" LowLevelMonitor *CoreLibNative_LowLevelMonitor_New()
 {
     void *monitorBuffer = malloc(sizeof(LowLevelMonitor));
@@ -167,6 +253,185 @@ extern "C" void CoreLibNative_LowLevelMonitor_Signal_Release(LowLevelMonitor *mo
     monitor->Release();
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RuntimeThread
+
+#ifdef __linux__
+#define FEATURE_POOLED_THREAD_STACKS
+#endif
+
+#ifdef FEATURE_POOLED_THREAD_STACKS
+
+// Threads are created on stacks that are mapped once with a guard page and reused by later threads of the same
+// stack size, saving the mmap, mprotect and munmap of each thread. A stack can only be reused once its thread
+// has fully exited, after the thread local destructors that detach the runtime thread ran on it, so the threads
+// are joinable: a thread returning from its start routine queues itself as finished, and the next thread
+// creation joins it, which returns almost immediately, and takes its stack. The number of stacks kept this way
+// is bounded, a thread finishing while the bound is reached joins and unmaps the oldest finished one.
+#define POOLED_THREAD_STACKS_MAX 32
+
+struct PooledThreadStack
+{
+    PooledThreadStack *next;
+    void *base;                         // Start of the mapping, the guard page
+    size_t size;                        // Size of the mapping, including the guard page
+    pthread_t threadId;                 // Thread that last ran on the stack
+    void *(*startAddress)(void*);
+    void *parameter;
+};
+
+static pthread_mutex_t s_threadStackPoolMutex = PTHREAD_MUTEX_INITIALIZER;
+static PooledThreadStack *s_finishedThreadStacks;   // Threads that returned from their start routine, newest first
+static PooledThreadStack *s_freeThreadStacks;       // Stacks of threads that were joined
+static int s_pooledThreadStackCount;                // Finished and free stacks
+
+static void FreeThreadStack(PooledThreadStack *stack)
+{
+    munmap(stack->base, stack->size);
+    free(stack);
+}
+
+// Joins the finished threads so their stacks can be reused. Called with the pool lock held.
+static void JoinFinishedThreads()
+{
+    while (s_finishedThreadStacks != nullptr)
+    {
+        PooledThreadStack *stack = s_finishedThreadStacks;
+        s_finishedThreadStacks = stack->next;
+
+        int error = pthread_join(stack->threadId, nullptr);
+        assert(error == 0);
+        UnusedInRelease(error);
+
+        stack->next = s_freeThreadStacks;
+        s_freeThreadStacks = stack;
+    }
+}
+
+static PooledThreadStack *AcquireThreadStack(size_t size)
+{
+    pthread_mutex_lock(&s_threadStackPoolMutex);
+    JoinFinishedThreads();
+
+    PooledThreadStack **link = &s_freeThreadStacks;
+    while ((*link != nullptr) && ((*link)->size != size))
+    {
+        link = &(*link)->next;
+    }
+
+    PooledThreadStack *stack = *link;
+    if (stack != nullptr)
+    {
+        *link = stack->next;
+        s_pooledThreadStackCount--;
+    }
+    pthread_mutex_unlock(&s_threadStackPoolMutex);
+
+    if (stack != nullptr)
+    {
+        return stack;
+    }
+
+    stack = (PooledThreadStack *)malloc(sizeof(PooledThreadStack));
+    if (stack == nullptr)
+    {
+        return nullptr;
+    }
+
+    void *base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (base == MAP_FAILED)
+    {
+        free(stack);
+        return nullptr;
+    }
+
+    // The stack grows down towards the guard page at the start of the mapping
+    if (mprotect(base, getpagesize(), PROT_NONE) != 0)
+    {
+        munmap(base, size);
+        free(stack);
+        return nullptr;
+    }
+
+    stack->base = base;
+    stack->size = size;
+    return stack;
+}
+
+// Returns the stack of a thread that failed to start
+static void ReleaseUnusedThreadStack(PooledThreadStack *stack)
+{
+    pthread_mutex_lock(&s_threadStackPoolMutex);
+    if (s_pooledThreadStackCount < POOLED_THREAD_STACKS_MAX)
+    {
+        stack->next = s_freeThreadStacks;
+        s_freeThreadStacks = stack;
+        s_pooledThreadStackCount++;
+        stack = nullptr;
+    }
+    pthread_mutex_unlock(&s_threadStackPoolMutex);
+
+    if (stack != nullptr)
+    {
+        FreeThreadStack(stack);
+    }
+}
+
+static void *PooledThreadStart(void *context)
+{
+    PooledThreadStack *stack = (PooledThreadStack *)context;
+    void *result = stack->startAddress(stack->parameter);
+
+    PooledThreadStack *oldestStack = nullptr;
+
+    pthread_mutex_lock(&s_threadStackPoolMutex);
+    if (s_pooledThreadStackCount >= POOLED_THREAD_STACKS_MAX)
+    {
+        // Make room by taking a free stack or else the oldest finished thread, which isn't this one
+        if (s_freeThreadStacks != nullptr)
+        {
+            oldestStack = s_freeThreadStacks;
+            s_freeThreadStacks = oldestStack->next;
+            oldestStack->threadId = 0;
+        }
+        else if (s_finishedThreadStacks != nullptr)
+        {
+            PooledThreadStack **link = &s_finishedThreadStacks;
+            while ((*link)->next != nullptr)
+            {
+                link = &(*link)->next;
+            }
+            oldestStack = *link;
+            *link = nullptr;
+        }
+
+        if (oldestStack != nullptr)
+        {
+            s_pooledThreadStackCount--;
+        }
+    }
+    stack->threadId = pthread_self();
+    stack->next = s_finishedThreadStacks;
+    s_finishedThreadStacks = stack;
+    s_pooledThreadStackCount++;
+    pthread_mutex_unlock(&s_threadStackPoolMutex);
+
+    if (oldestStack != nullptr)
+    {
+        if (oldestStack->threadId != 0)
+        {
+            int error = pthread_join(oldestStack->threadId, nullptr);
+            assert(error == 0);
+            UnusedInRelease(error);
+        }
+        FreeThreadStack(oldestStack);
+    }
+
+    return result;
+}
+
+#endif // FEATURE_POOLED_THREAD_STACKS
+
 extern "C" bool CoreLibNative_RuntimeThread_CreateThread(size_t stackSize, void *(*startAddress)(void*), void *parameter)
 {
     bool result = false;
@@ -179,6 +444,44 @@ extern "C" bool CoreLibNative_RuntimeThread_CreateThread(size_t stackSize, void
         return false;
     }
 
+#ifdef FEATURE_POOLED_THREAD_STACKS
+    if (stackSize == 0)
+    {
+        error = pthread_attr_getstacksize(&attrs, &stackSize);
+        if (error != 0) goto CreateThreadExit;
+    }
+    else if (stackSize < PTHREAD_STACK_MIN)
+    {
+        stackSize = PTHREAD_STACK_MIN;
+    }
+
+    {
+        size_t pageSize = getpagesize();
+        stackSize = (stackSize + pageSize - 1) & ~(pageSize - 1);
+
+        // One more page for the guard
+        PooledThreadStack *stack = AcquireThreadStack(stackSize + pageSize);
+        if (stack == nullptr) goto CreateThreadExit;
+
+        error = pthread_attr_setstack(&attrs, (uint8_t *)stack->base + pageSize, stackSize);
+        if (error != 0)
+        {
+            ReleaseUnusedThreadStack(stack);
+            goto CreateThreadExit;
+        }
+
+        stack->startAddress = startAddress;
+        stack->parameter = parameter;
+
+        pthread_t threadId;
+        error = pthread_create(&threadId, &attrs, PooledThreadStart, stack);
+        if (error != 0)
+        {
+            ReleaseUnusedThreadStack(stack);
+            goto CreateThreadExit;
+        }
+    }
+#else // FEATURE_POOLED_THREAD_STACKS
     error = pthread_attr_setdetachstate(&attrs, PTHREAD_CREATE_DETACHED);
     assert(error == 0);
 
@@ -193,9 +496,12 @@ extern "C" bool CoreLibNative_RuntimeThread_CreateThread(size_t stackSize, void
         if (error != 0) goto CreateThreadExit;
     }
 
-    pthread_t threadId;
-    error = pthread_create(&threadId, &attrs, startAddress, parameter);
-    if (error != 0) goto CreateThreadExit;
+    {
+        pthread_t threadId;
+        error = pthread_create(&threadId, &attrs, startAddress, parameter);
+        if (error != 0) goto CreateThreadExit;
+    }
+#endif // FEATURE_POOLED_THREAD_STACKS
 
     result = true;
 
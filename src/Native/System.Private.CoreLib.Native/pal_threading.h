@@ -107,11 +107,33 @@ public:
 class LowLevelMonitor final : public LowLevelMutex
 {
 private:
+#if HAVE_LINUX_FUTEX
+    // Futex based condition. Both fields are only changed while holding the mutex. A waiter reads m_sequence before releasing
+    // the mutex and only blocks while it is unchanged, so a signal that comes in between is not lost. Signaling a monitor that
+    // nobody waits on doesn't enter the kernel.
+    int32_t m_sequence;
+    int32_t m_waiterCount;
+#else
     pthread_cond_t m_condition;
+#endif
 
 public:
     LowLevelMonitor(bool abortOnFailure, bool *successRef);
 
+#if HAVE_LINUX_FUTEX
+    ~LowLevelMonitor()
+    {
+        assert(m_waiterCount == 0);
+    }
+
+public:
+    void Wait();
+    bool Wait(int32_t timeoutMilliseconds);
+
+public:
+    void Signal();
+    void SignalAll();
+#else
     ~LowLevelMonitor()
     {
         int error = pthread_cond_destroy(&m_condition);
@@ -149,6 +171,7 @@ public:
 
         UnusedInRelease(error);
     }
+#endif
 
     LowLevelMonitor(const LowLevelMonitor &other) = delete;
     LowLevelMonitor &operator =(const LowLevelMonitor &other) = delete;
@@ -39,6 +39,7 @@ public:
 
     // Promote refcounted handle callback
     static bool RefCountedHandleCallbacks(Object * pObject);
+    static size_t RefCountedHandleCallbacksForBatch(Object ** rgpObjects, size_t cObjects);
 
     // Sync block cache management
     static void SyncBlockCacheWeakPtrScan(HANDLESCANPROC scanProc, uintptr_t lp1, uintptr_t lp2);
@@ -91,6 +92,9 @@ public:
 
     static void VerifySyncTableEntry();
     static void UpdateGCEventStatus(int publicLevel, int publicKeywords, int privateLevel, int privateKeywords);
+
+    static uint32_t GetSupportedInstructionSets();
+    static void FullGCApproaching(int generation);
 };
 
 #endif // __GCENV_EE_H__
@@ -54,6 +54,9 @@ struct VirtualReserveFlags
     {
         None = 0,
         WriteWatch = 1,
+        // Hint that the range should be backed by large pages where the OS can do that transparently.
+        // Reservations that cannot get large pages silently fall back to regular pages.
+        LargePages = 2,
     };
 };
 
@@ -410,6 +413,14 @@ public:
     //  true if the priority boost was successful, false otherwise.
     static bool BoostThreadPriority();
 
+    // Get the total time the process was kept from running because it used up its CPU quota, for example the
+    // CFS bandwidth quota of its cgroup on Linux. The time only grows, callers look at how much it grew.
+    // Parameters:
+    //  throttledMicroseconds - receives the time in microseconds
+    // Return:
+    //  true if the process has a CPU quota and the time could be read, false otherwise.
+    static bool GetCpuThrottledTime(uint64_t* throttledMicroseconds);
+
     // Set the set of processors enabled for GC threads for the current process based on config specified affinity mask and set
     // Parameters:
     //  configAffinityMask - mask specified by the GCHeapAffinitizeMask config
@@ -436,6 +447,12 @@ public:
     //  specified, it returns amount of actual physical memory.
     static uint64_t GetPhysicalMemoryLimit(bool* is_restricted=NULL);
 
+    // Re-read the memory and processor limits of the process, which can change while it runs in a container.
+    // GetPhysicalMemoryLimit and GetCurrentProcessCpuCount return the new limits afterwards.
+    // Return:
+    //  true if any of the limits changed
+    static bool RefreshResourceLimits();
+
     // Get memory status
     // Parameters:
     //  restricted_limit - The amount of physical memory in bytes that the current process is being restricted to. If non-zero, it used to calculate
@@ -19,6 +19,10 @@
 
 #include "gcpriv.h"
 
+#ifdef HOST_AMD64
+#include <emmintrin.h>
+#endif // HOST_AMD64
+
 #define USE_INTROSORT
 
 // We just needed a simple random number generator for testing.
@@ -68,7 +72,13 @@ static size_t smoothed_desired_per_heap = 0;
 #define MARK_STACK_INITIAL_LENGTH 128
 #endif // HOST_64BIT
 
+// Most memory a heap spends on mark overflow chunks before it falls back to rescanning address ranges
+#define MARK_OVERFLOW_BUDGET (2*1024*1024*sizeof(uint8_t*))
+
 #define LOH_PIN_QUEUE_LENGTH 100
+
+// Most concurrent rounds of revisiting written pages a BGC does before its final, suspended one
+#define BGC_MAX_REVISIT_ROUNDS 8
 #define LOH_PIN_DECAY 10
 
 uint32_t yp_spin_count_unit = 0;
@@ -81,6 +91,11 @@ int compact_ratio = 0;
 // See comments in reset_memory.
 BOOL reset_mm_p = TRUE;
 
+// Free objects smaller than this are not worth resetting, see reset_memory. With GCReleaseFreeSpace
+// the threshold is lowered so that free space follows the live set more closely.
+#define reset_memory_min_size (128 * 1024)
+#define release_free_space_reset_size (64 * 1024)
+
 bool g_fFinalizerRunOnShutDown = false;
 
 #ifdef FEATURE_SVR_GC
@@ -158,7 +173,11 @@ static const char* const str_gc_reasons[] =
     "induced_compacting",
     "lowmemory_host",
     "pm_full_gc",
-    "lowmemory_host_blocking"
+    "lowmemory_host_blocking",
+    "bgc_tuning_soh",
+    "bgc_tuning_loh",
+    "bgc_stepping",
+    "idle"
 };
 
 static const char* const str_gc_pause_modes[] =
@@ -339,6 +358,18 @@ uint32_t bgc_alloc_spin_count = 140;
 uint32_t bgc_alloc_spin_count_loh = 16;
 uint32_t bgc_alloc_spin = 2;
 
+// The BGC thread looks at the time once every this many calls to allow_fgc, and works for slices of at
+// least bgc_pace_slice_ms before it sleeps to keep to the duty cycle.
+const uint32_t bgc_pace_check_interval = 64;
+const size_t bgc_pace_slice_ms = 10;
+const uint32_t bgc_pace_min_duty_cycle = 25;
+const uint32_t bgc_pace_duty_cycle_step = 12;
+
+// A BGC thread only gives away marking work when its mark stack is at least this deep, and then at most half
+// of it. An idle thread yields this many times before it starts sleeping between looks for work.
+const size_t bgc_mark_publish_min_depth = 64;
+const int bgc_mark_idle_spin_count = 64;
+
 
 inline
 void c_write (uint32_t& place, uint32_t value)
@@ -1234,6 +1265,16 @@ static bool hardware_write_watch_capability = false;
 
 void hardware_write_watch_api_supported()
 {
+#ifdef TARGET_UNIX
+    // Write watch on Unix relies on the kernel tracking the written pages of userfaultfd registered ranges,
+    // which is opt-in for now. Large page reservations are not registered, so they can't be watched.
+    if (!GCConfig::GetGCOSWriteWatch() || GCConfig::GetGCLargePages())
+    {
+        dprintf (2,("WriteWatch not enabled"));
+        return;
+    }
+#endif // TARGET_UNIX
+
     if (GCToOSInterface::SupportsWriteWatch())
     {
         hardware_write_watch_capability = true;
@@ -1568,12 +1609,52 @@ void gc_heap::disable_preemptive (bool restore_cooperative)
 #endif // !DACCESS_COMPILE
 
 typedef void **  PTR_PTR;
+
+#ifdef HOST_AMD64
+// Clears memory with streaming stores that bypass the caches, so that clearing a large object doesn't
+// evict the working set of the process. The memory is handed out as an object right after it is cleared,
+// so the weakly ordered stores are fenced before returning.
+void memclr_non_temporal (uint8_t* mem, size_t size)
+{
+    uint8_t* end = mem + size;
+
+    while ((((size_t)mem & (sizeof(__m128i) - 1)) != 0) && (mem < end))
+    {
+        *(PTR_PTR)mem = 0;
+        mem += sizeof(PTR_PTR);
+    }
+
+    __m128i zero = _mm_setzero_si128();
+    while ((size_t)(end - mem) >= 4 * sizeof(__m128i))
+    {
+        _mm_stream_si128 ((__m128i*)mem, zero);
+        _mm_stream_si128 ((__m128i*)mem + 1, zero);
+        _mm_stream_si128 ((__m128i*)mem + 2, zero);
+        _mm_stream_si128 ((__m128i*)mem + 3, zero);
+        mem += 4 * sizeof(__m128i);
+    }
+    _mm_sfence();
+
+    memset (mem, 0, end - mem);
+}
+#endif // HOST_AMD64
+
 inline
 void memclr ( uint8_t* mem, size_t size)
 {
     dprintf (3, ("MEMCLR: %Ix, %d", mem, size));
     assert ((size & (sizeof(PTR_PTR)-1)) == 0);
     assert (sizeof(PTR_PTR) == DATA_ALIGNMENT);
+
+#ifdef HOST_AMD64
+    int64_t non_temporal_threshold = GCConfig::GetGCNonTemporalClearThreshold();
+    if ((non_temporal_threshold > 0) && (size >= (size_t)non_temporal_threshold))
+    {
+        memclr_non_temporal (mem, size);
+        return;
+    }
+#endif // HOST_AMD64
+
     memset (mem, 0, size);
 }
 
@@ -1956,17 +2037,18 @@ void stomp_write_barrier_resize(bool is_runtime_suspended, bool requires_upper_b
     GCToEEInterface::StompWriteBarrier(&args);
 }
 
-void stomp_write_barrier_ephemeral(uint8_t* ephemeral_low, uint8_t* ephemeral_high)
+void stomp_write_barrier_ephemeral(uint8_t* ephemeral_low, uint8_t* ephemeral_high, uint8_t* gen0_low)
 {
     WriteBarrierParameters args = {};
     args.operation = WriteBarrierOp::StompEphemeral;
     args.is_runtime_suspended = true;
     args.ephemeral_low = ephemeral_low;
     args.ephemeral_high = ephemeral_high;
+    args.gen0_low = gen0_low;
     GCToEEInterface::StompWriteBarrier(&args);
 }
 
-void stomp_write_barrier_initialize(uint8_t* ephemeral_low, uint8_t* ephemeral_high)
+void stomp_write_barrier_initialize(uint8_t* ephemeral_low, uint8_t* ephemeral_high, uint8_t* gen0_low)
 {
     WriteBarrierParameters args = {};
     args.operation = WriteBarrierOp::Initialize;
@@ -1982,6 +2064,7 @@ void stomp_write_barrier_initialize(uint8_t* ephemeral_low, uint8_t* ephemeral_h
     args.highest_address = g_gc_highest_address;
     args.ephemeral_low = ephemeral_low;
     args.ephemeral_high = ephemeral_high;
+    args.gen0_low = gen0_low;
     GCToEEInterface::StompWriteBarrier(&args);
 }
 
@@ -2058,6 +2141,35 @@ uint8_t* tree_search (uint8_t* tree, uint8_t* old_address);
 void qsort1(uint8_t** low, uint8_t** high, unsigned int depth);
 #endif //USE_INTROSORT
 
+#if defined(USE_VXSORT) && defined(USE_INTROSORT)
+// Vectorized partitioning kernel for the best instruction set the EE reports as usable, picked during
+// initialize_gc. Stays null when none is available, in which case introsort only uses scalar code.
+static vxsort_partition_func vxsort_partition = nullptr;
+#endif //USE_VXSORT && USE_INTROSORT
+
+#ifdef USE_VECTORIZED_CARD_SCAN
+// Vectorized kernel for skipping clear card words, picked during initialize_gc like vxsort_partition.
+static card_word_scan_func vectorized_find_nonzero_card_word = nullptr;
+#endif //USE_VECTORIZED_CARD_SCAN
+
+// Returns the first non-zero card word in [card_word, card_word_end), or card_word_end.
+inline
+uint32_t* find_nonzero_card_word (uint32_t* card_word, uint32_t* card_word_end)
+{
+#ifdef USE_VECTORIZED_CARD_SCAN
+    if (vectorized_find_nonzero_card_word != nullptr)
+    {
+        return vectorized_find_nonzero_card_word (card_word, card_word_end);
+    }
+#endif //USE_VECTORIZED_CARD_SCAN
+
+    while ((card_word < card_word_end) && !(*card_word))
+    {
+        card_word++;
+    }
+    return card_word;
+}
+
 void* virtual_alloc (size_t size);
 void* virtual_alloc (size_t size, bool use_large_pages_p);
 void virtual_free (void* add, size_t size);
@@ -2099,6 +2211,34 @@ uintptr_t   process_mask = 0;
 
 int         gc_heap::n_heaps;
 
+#ifdef VERIFY_HEAP
+gc_heap::verify_segment_entry* gc_heap::verify_segments = 0;
+
+int         gc_heap::verify_segments_capacity = 0;
+
+int         gc_heap::verify_segments_count = 0;
+
+VOLATILE(int32_t) gc_heap::verify_segments_next = 0;
+
+BOOL        gc_heap::verify_segments_parallel_p = FALSE;
+#endif //VERIFY_HEAP
+
+int         gc_heap::n_active_heaps;
+
+int         gc_heap::n_max_active_heaps;
+
+bool        gc_heap::heap_count_from_cpu_limit_p = false;
+
+bool        gc_heap::dynamic_heap_count_p = false;
+
+size_t      gc_heap::heap_count_last_gc_end_time = 0;
+
+size_t      gc_heap::heap_count_gc_time = 0;
+
+size_t      gc_heap::heap_count_elapsed_time = 0;
+
+int         gc_heap::heap_count_samples = 0;
+
 gc_heap**   gc_heap::g_heaps;
 
 size_t*     gc_heap::g_promoted;
@@ -2183,6 +2323,28 @@ uint64_t    gc_heap::entry_available_physical_mem = 0;
 
 size_t      gc_heap::heap_hard_limit = 0;
 
+size_t      gc_heap::container_heap_hard_limit = 0;
+
+bool        gc_heap::physical_mem_from_os_p = false;
+
+size_t      gc_heap::resource_limits_refresh_time = 0;
+
+bool        gc_heap::release_free_space_p = false;
+
+int         gc_heap::conserve_mem_setting = 0;
+
+bool        gc_heap::background_decommit_p = false;
+
+CLRCriticalSection gc_heap::decommit_cs;
+
+GCEvent     gc_heap::decommit_event;
+
+gc_heap::decommit_range gc_heap::decommit_queue[decommit_queue_length];
+
+size_t      gc_heap::decommit_queue_count = 0;
+
+bool        gc_heap::type_stats_p = false;
+
 bool        affinity_config_specified_p = false;
 #ifdef BACKGROUND_GC
 GCEvent     gc_heap::bgc_start_event;
@@ -2218,6 +2380,44 @@ BOOL        gc_heap::alloc_wait_event_p = FALSE;
 VOLATILE(c_gc_state) gc_heap::current_c_gc_state = c_gc_state_free;
 
 VOLATILE(BOOL) gc_heap::gc_background_running = FALSE;
+
+bool        gc_heap::bgc_pace_enabled_p = false;
+
+VOLATILE(uint32_t) gc_heap::bgc_pace_duty_cycle = 100;
+
+VOLATILE(int32_t) gc_heap::bgc_pace_sampling = 0;
+
+size_t      gc_heap::bgc_pace_last_sample_time = 0;
+
+uint64_t    gc_heap::bgc_pace_last_throttled_time = 0;
+
+bool        gc_heap::bgc_mark_sharing_p = false;
+
+VOLATILE(bool) gc_heap::bgc_mark_sharing_open = false;
+
+VOLATILE(int32_t) gc_heap::bgc_mark_pool_lock = 0;
+
+bgc_mark_packet* gc_heap::bgc_mark_full_packets = 0;
+
+VOLATILE(int32_t) gc_heap::bgc_mark_full_count = 0;
+
+bgc_mark_packet* gc_heap::bgc_mark_free_packets = 0;
+
+VOLATILE(int32_t) gc_heap::bgc_mark_idle_count = 0;
+
+int32_t     gc_heap::bgc_mark_busy_count = 0;
+
+#ifndef MULTIPLE_HEAPS
+bgc_mark_helper* gc_heap::bgc_mark_helpers = 0;
+
+int         gc_heap::bgc_mark_helper_count = 0;
+
+bool        gc_heap::bgc_mark_helpers_created_p = false;
+
+VOLATILE(int32_t) gc_heap::bgc_mark_helpers_active = 0;
+
+VOLATILE(bool) gc_heap::bgc_mark_helpers_running_p = false;
+#endif //!MULTIPLE_HEAPS
 #endif //BACKGROUND_GC
 
 #ifndef MULTIPLE_HEAPS
@@ -2251,6 +2451,10 @@ oom_history gc_heap::oom_info;
 
 int         gc_heap::oomhist_index_per_heap = 0;
 
+gc_type_stats* gc_heap::type_stats_table = 0;
+
+size_t      gc_heap::type_stats_table_used = 0;
+
 oom_history gc_heap::oomhist_per_heap[max_oom_history_count];
 
 fgm_history gc_heap::fgm_result;
@@ -2381,6 +2585,12 @@ size_t      gc_heap::background_soh_alloc_count = 0;
 
 size_t      gc_heap::background_uoh_alloc_count = 0;
 
+size_t      gc_heap::bgc_pace_slice_start = 0;
+
+uint32_t    gc_heap::bgc_pace_call_count = 0;
+
+bgc_mark_packet* gc_heap::bgc_mark_taken_packet = 0;
+
 uint8_t**   gc_heap::background_mark_stack_tos = 0;
 
 uint8_t**   gc_heap::background_mark_stack_array = 0;
@@ -2435,6 +2645,10 @@ uint8_t*    gc_heap::min_overflow_address = MAX_PTR;
 
 uint8_t*    gc_heap::max_overflow_address = 0;
 
+mark_overflow_chunk* gc_heap::mark_overflow_chunks = 0;
+
+size_t      gc_heap::mark_overflow_chunks_size = 0;
+
 uint8_t*    gc_heap::shigh = 0;
 
 uint8_t*    gc_heap::slow = MAX_PTR;
@@ -2502,6 +2716,29 @@ uint64_t gc_heap::total_loh_a_last_bgc = 0;
 size_t gc_heap::eph_gen_starts_size = 0;
 heap_segment* gc_heap::segment_standby_list;
 bool          gc_heap::use_large_pages_p = 0;
+bool          gc_heap::use_transparent_large_pages_p = 0;
+gc_pause_info gc_heap::pause_info_history[max_pause_info_history_count];
+VOLATILE(uint64_t) gc_heap::pause_info_count = 0;
+uint64_t      gc_heap::pause_start_ts = 0;
+uint64_t      gc_heap::pause_phase_start_ts = 0;
+uint64_t      gc_heap::pause_phase_ticks[gc_pause_phase_count];
+bool          gc_heap::pause_in_progress_p = false;
+gc_generation_info gc_heap::generation_info_history[max_generation_info_history_count];
+VOLATILE(uint64_t) gc_heap::generation_info_count = 0;
+bool          gc_heap::type_stats_in_mark_p = false;
+uint32_t      gc_heap::pause_target_us = 0;
+double        gc_heap::pause_target_budget_scale[max_generation];
+int           gc_heap::idle_collect_percent = 50;
+gc_type_stats* gc_heap::type_stats_result = 0;
+size_t        gc_heap::type_stats_result_used = 0;
+uint64_t      gc_heap::type_stats_gc_index = 0;
+
+// With server GC all heaps go through the same phases at about the same time, heap 0's view is recorded.
+#ifdef MULTIPLE_HEAPS
+#define RECORD_PAUSE_PHASE(phase) do { if (heap_number == 0) record_pause_phase (phase); } while (0)
+#else
+#define RECORD_PAUSE_PHASE(phase) record_pause_phase (phase)
+#endif //MULTIPLE_HEAPS
 #ifdef HEAP_BALANCE_INSTRUMENTATION
 size_t        gc_heap::last_gc_end_time_ms = 0;
 #endif //HEAP_BALANCE_INSTRUMENTATION
@@ -2530,6 +2767,8 @@ GCEvent gc_heap::full_gc_end_event;
 
 uint32_t gc_heap::fgn_loh_percent = 0;
 
+size_t gc_heap::fgn_lead_bytes = 0;
+
 #ifdef BACKGROUND_GC
 BOOL gc_heap::fgn_last_gc_was_concurrent = FALSE;
 #endif //BACKGROUND_GC
@@ -4161,6 +4400,11 @@ void* virtual_alloc (size_t size, bool use_large_pages_p)
     }
 #endif // !FEATURE_USE_SOFTWARE_WRITE_WATCH_FOR_GC_HEAP
 
+    if (gc_heap::use_transparent_large_pages_p)
+    {
+        flags |= VirtualReserveFlags::LargePages;
+    }
+
     void* prgmem = use_large_pages_p ?
         GCToOSInterface::VirtualReserveAndCommitLargePages(requested_size) :
         GCToOSInterface::VirtualReserve(requested_size, card_size * card_word_width, flags);
@@ -4552,7 +4796,13 @@ void release_segment (heap_segment* sg)
 {
     ptrdiff_t delta = 0;
     FIRE_EVENT(GCFreeSegment_V1, heap_segment_mem(sg));
-    virtual_free (sg, (uint8_t*)heap_segment_reserved (sg)-(uint8_t*)sg);
+    size_t size = (uint8_t*)heap_segment_reserved (sg)-(uint8_t*)sg;
+    if (gc_heap::queue_decommit ((uint8_t*)sg, heap_segment_committed (sg)-(uint8_t*)sg, size))
+    {
+        gc_heap::reserved_memory -= size;
+        return;
+    }
+    virtual_free (sg, size);
 }
 
 heap_segment* gc_heap::get_segment_for_uoh (int gen_number, size_t size
@@ -4772,6 +5022,14 @@ public:
             sniff_buffer[(1 + heap_number*n_sniff_buffers + sniff_index)*HS_CACHE_LINE_SIZE] &= 1;
     }
 
+    // Same as select_heap but folded onto the heaps allocations currently use, see gc_heap::n_active_heaps.
+    static int select_active_heap(alloc_context* acontext)
+    {
+        int hp_num = select_heap (acontext);
+        int n_active_heaps = gc_heap::n_active_heaps;
+        return ((hp_num < n_active_heaps) ? hp_num : (hp_num % n_active_heaps));
+    }
+
     static int select_heap(alloc_context* acontext)
     {
 #ifndef TRACE_GC
@@ -5399,9 +5657,11 @@ void gc_heap::gc_thread_function ()
         {
             gc_heap::ee_suspend_event.Wait(INFINITE, FALSE);
 
+            begin_pause_info();
             BEGIN_TIMING(suspend_ee_during_log);
             GCToEEInterface::SuspendEE(SUSPEND_FOR_GC);
             END_TIMING(suspend_ee_during_log);
+            record_pause_phase (gc_pause_phase_suspend);
 
             proceed_with_gc_p = TRUE;
 
@@ -5440,6 +5700,12 @@ void gc_heap::gc_thread_function ()
             if (proceed_with_gc_p && (!settings.concurrent))
             {
                 do_post_gc();
+                refresh_resource_limits();
+
+                if (dynamic_heap_count_p)
+                {
+                    adapt_active_heap_count();
+                }
             }
 
 #ifdef BACKGROUND_GC
@@ -5457,9 +5723,11 @@ void gc_heap::gc_thread_function ()
 
             gc_heap::gc_started = FALSE;
 
+            record_pause_phase (gc_pause_phase_post);
             BEGIN_TIMING(restart_ee_during_log);
             GCToEEInterface::RestartEE(TRUE);
             END_TIMING(restart_ee_during_log);
+            end_pause_info (proceed_with_gc_p != FALSE);
             process_sync_log_stats();
 
             dprintf (SPINLOCK_LOG, ("GC Lgc"));
@@ -5501,10 +5769,10 @@ void gc_heap::gc_thread_function ()
 
 bool gc_heap::virtual_alloc_commit_for_heap (void* addr, size_t size, int h_number)
 {
-#if defined(MULTIPLE_HEAPS) && !defined(FEATURE_REDHAWK)
+#if defined(MULTIPLE_HEAPS)
     // Currently there is no way for us to specific the numa node to allocate on via hosting interfaces to
     // a host. This will need to be added later.
-#if !defined(FEATURE_CORECLR) && !defined(BUILD_AS_STANDALONE)
+#if !defined(FEATURE_CORECLR) && !defined(BUILD_AS_STANDALONE) && !defined(FEATURE_REDHAWK)
     if (!CLRMemoryHosted())
 #endif
     {
@@ -5515,9 +5783,9 @@ bool gc_heap::virtual_alloc_commit_for_heap (void* addr, size_t size, int h_numb
                 return true;
         }
     }
-#else //MULTIPLE_HEAPS && !FEATURE_REDHAWK
+#else //MULTIPLE_HEAPS
     UNREFERENCED_PARAMETER(h_number);
-#endif //MULTIPLE_HEAPS && !FEATURE_REDHAWK
+#endif //MULTIPLE_HEAPS
 
     //numa aware not enabled, or call failed --> fallback to VirtualCommit()
     return GCToOSInterface::VirtualCommit(addr, size);
@@ -5563,6 +5831,11 @@ bool gc_heap::virtual_commit (void* address, size_t size, int h_number, bool* ha
         }
     }
 
+    if (background_decommit_p)
+    {
+        flush_queued_decommit ((uint8_t*)address, size);
+    }
+
     // If it's a valid heap number it means it's commiting for memory on the GC heap.
     // In addition if large pages is enabled, we set commit_succeeded_p to true because memory is already committed.
     bool commit_succeeded_p = ((h_number >= 0) ? (use_large_pages_p ? true :
@@ -5604,6 +5877,121 @@ bool gc_heap::virtual_decommit (void* address, size_t size, int h_number)
     return decommit_succeeded_p;
 }
 
+// Hands a range to the decommit thread, returns false when the caller should decommit it itself.
+bool gc_heap::queue_decommit (uint8_t* address, size_t size, size_t release_size)
+{
+    if (!background_decommit_p)
+        return false;
+
+    bool queued_p = false;
+
+    decommit_cs.Enter();
+    if (decommit_queue_count < decommit_queue_length)
+    {
+        decommit_range* range = &decommit_queue[decommit_queue_count++];
+        range->address = address;
+        range->size = size;
+        range->release_size = release_size;
+        queued_p = true;
+    }
+    decommit_cs.Leave();
+
+    if (queued_p)
+    {
+        dprintf (3, ("Queued decommit [%Ix, %Ix[, release %Id", (size_t)address, (size_t)(address + size), release_size));
+        decommit_event.Set();
+    }
+
+    return queued_p;
+}
+
+// The memory being committed may still be in the queue. It's decommitted first so it reads as zeroes
+// afterwards and the decommit thread doesn't take it away again.
+void gc_heap::flush_queued_decommit (uint8_t* address, size_t size)
+{
+    decommit_cs.Enter();
+    size_t i = 0;
+    while (i < decommit_queue_count)
+    {
+        decommit_range* range = &decommit_queue[i];
+        uint8_t* range_end = range->address + max (range->size, range->release_size);
+        if ((range->address < (address + size)) && (address < range_end))
+        {
+            GCToOSInterface::VirtualDecommit (range->address, range->size);
+            if (range->release_size != 0)
+            {
+                GCToOSInterface::VirtualRelease (range->address, range->release_size);
+            }
+            *range = decommit_queue[--decommit_queue_count];
+        }
+        else
+        {
+            i++;
+        }
+    }
+    decommit_cs.Leave();
+}
+
+// Gives back at most decommit_step_size of the queue, returns whether anything is left in it.
+bool gc_heap::decommit_step()
+{
+    decommit_cs.Enter();
+    if (decommit_queue_count != 0)
+    {
+        decommit_range* range = &decommit_queue[decommit_queue_count - 1];
+        size_t step_size = min (range->size, (size_t)decommit_step_size);
+        range->size -= step_size;
+        if (step_size != 0)
+        {
+            GCToOSInterface::VirtualDecommit (range->address + range->size, step_size);
+        }
+
+        if (range->size == 0)
+        {
+            if (range->release_size != 0)
+            {
+                GCToOSInterface::VirtualRelease (range->address, range->release_size);
+            }
+            decommit_queue_count--;
+        }
+    }
+    bool remaining_p = (decommit_queue_count != 0);
+    decommit_cs.Leave();
+
+    return remaining_p;
+}
+
+void gc_heap::decommit_thread_stub (void* arg)
+{
+    UNREFERENCED_PARAMETER(arg);
+
+    while (true)
+    {
+        decommit_event.Wait (INFINITE, FALSE);
+
+        while (decommit_step())
+        {
+            GCToOSInterface::Sleep (decommit_step_interval_ms);
+        }
+    }
+}
+
+BOOL gc_heap::create_decommit_thread()
+{
+    decommit_cs.Initialize();
+
+    if (!decommit_event.CreateAutoEventNoThrow (FALSE))
+        return FALSE;
+
+    if (!GCToEEInterface::CreateThread (decommit_thread_stub, NULL, false, ".NET GC Decommit"))
+    {
+        decommit_event.CloseEvent();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 class mark
 {
 public:
@@ -6964,7 +7352,10 @@ void gc_heap::mark_array_set_marked (uint8_t* add)
 #ifdef MULTIPLE_HEAPS
     Interlocked::Or (&(mark_array [index]), val);
 #else
-    mark_array [index] |= val;
+    if (bgc_mark_helpers_running_p)
+        Interlocked::Or (&(mark_array [index]), val);
+    else
+        mark_array [index] |= val;
 #endif
 }
 
@@ -7151,6 +7542,10 @@ uint32_t* gc_heap::make_card_table (uint8_t* start, uint8_t* end)
     assert (g_gc_highest_address == end);
 
     uint32_t virtual_reserve_flags = VirtualReserveFlags::None;
+    if (use_transparent_large_pages_p)
+    {
+        virtual_reserve_flags |= VirtualReserveFlags::LargePages;
+    }
 
     size_t bs = size_brick_of (start, end);
     size_t cs = size_card_of (start, end);
@@ -7337,6 +7732,10 @@ int gc_heap::grow_brick_card_tables (uint8_t* start,
 
         bool write_barrier_updated = false;
         uint32_t virtual_reserve_flags = VirtualReserveFlags::None;
+        if (use_transparent_large_pages_p)
+        {
+            virtual_reserve_flags |= VirtualReserveFlags::LargePages;
+        }
         uint32_t* saved_g_card_table = g_gc_card_table;
 
 #ifdef FEATURE_MANUALLY_MANAGED_CARD_BUNDLES
@@ -8036,6 +8435,10 @@ class introsort
 private:
     static const int size_threshold = 64;
     static const int max_depth = 100;
+#ifdef USE_VXSORT
+    // Below this many elements the setup cost of the vectorized partition is not worth it.
+    static const int vxsort_threshold = 512;
+#endif //USE_VXSORT
 
 
 inline static void swap_elements(uint8_t** i,uint8_t** j)
@@ -8064,7 +8467,12 @@ private:
                 heapsort (lo, hi);
                 return;
             }
+#ifdef USE_VXSORT
+            uint8_t** p=((vxsort_partition != nullptr) && ((hi - lo) >= vxsort_threshold)) ?
+                vxsort_median_partition (lo, hi) : median_partition (lo, hi);
+#else //USE_VXSORT
             uint8_t** p=median_partition (lo, hi);
+#endif //USE_VXSORT
             depth_limit=depth_limit-1;
             introsort_loop (p, hi, depth_limit);
             hi=p-1;
@@ -8100,6 +8508,30 @@ private:
         return left;
     }
 
+#ifdef USE_VXSORT
+    // Same contract as median_partition, but the elements between the median-of-three are partitioned
+    // by the vectorized kernel.
+    static uint8_t** vxsort_median_partition (uint8_t** low, uint8_t** high)
+    {
+        //sort low middle and high
+        if (*(low+((high-low)/2)) < *low)
+            swap_elements ((low+((high-low)/2)), low);
+        if (*high < *low)
+            swap_elements (low, high);
+        if (*high < *(low+((high-low)/2)))
+            swap_elements ((low+((high-low)/2)), high);
+
+        swap_elements ((low+((high-low)/2)), (high-1));
+        uint8_t* pivot = *(high-1);
+
+        // *low and *high are already on the correct side, so only the range in between needs partitioning.
+        // This guarantees the pivot never ends up at low, so every partition makes progress.
+        uint8_t** left = vxsort_partition ((low+1), (high-1), pivot);
+        swap_elements (left, (high-1));
+        return left;
+    }
+#endif //USE_VXSORT
+
 
     static void insertionsort (uint8_t** lo, uint8_t** hi)
     {
@@ -9183,7 +9615,7 @@ void gc_heap::delete_heap_segment (heap_segment* seg, BOOL consider_hoarding)
         clear_brick_table (heap_segment_mem (seg), heap_segment_reserved (seg));
     }
 
-    if (consider_hoarding)
+    if (consider_hoarding && !release_free_space_p)
     {
         assert ((heap_segment_mem (seg) - (uint8_t*)seg) <= ptrdiff_t(2*OS_PAGE_SIZE));
         size_t ss = (size_t) (heap_segment_reserved (seg) - (uint8_t*)seg);
@@ -9244,12 +9676,19 @@ void gc_heap::decommit_heap_segment_pages (heap_segment* seg,
     uint8_t*  page_start = align_on_page (heap_segment_allocated(seg));
     size_t size = heap_segment_committed (seg) - page_start;
     extra_space = align_on_page (extra_space);
-    if (size >= max ((extra_space + 2*OS_PAGE_SIZE), 100*OS_PAGE_SIZE))
+    // By default we leave some slack so the segment doesn't thrash between committing and decommitting
+    // when its end moves only a little; GCReleaseFreeSpace trades that for a tighter footprint.
+    size_t min_decommit_size = (release_free_space_p ? 16*OS_PAGE_SIZE : 100*OS_PAGE_SIZE);
+    size_t min_slack_space = (release_free_space_p ? 2*OS_PAGE_SIZE : 32*OS_PAGE_SIZE);
+    if (size >= max ((extra_space + 2*OS_PAGE_SIZE), min_decommit_size))
     {
-        page_start += max(extra_space, 32*OS_PAGE_SIZE);
-        size -= max (extra_space, 32*OS_PAGE_SIZE);
+        page_start += max(extra_space, min_slack_space);
+        size -= max (extra_space, min_slack_space);
 
-        virtual_decommit (page_start, size, heap_number);
+        if (!queue_decommit (page_start, size, 0))
+        {
+            virtual_decommit (page_start, size, heap_number);
+        }
         dprintf (3, ("Decommitting heap segment [%Ix, %Ix[(%d)",
             (size_t)page_start,
             (size_t)(page_start + size),
@@ -9274,7 +9713,10 @@ void gc_heap::decommit_heap_segment (heap_segment* seg)
 #endif //BACKGROUND_GC
 
     size_t size = heap_segment_committed (seg) - page_start;
-    virtual_decommit (page_start, size, heap_number);
+    if (!queue_decommit (page_start, size, 0))
+    {
+        virtual_decommit (page_start, size, heap_number);
+    }
 
     //re-init the segment object
     heap_segment_committed (seg) = page_start;
@@ -9708,7 +10150,7 @@ void gc_heap::adjust_ephemeral_limits ()
 
 #ifndef MULTIPLE_HEAPS
     // This updates the write barrier helpers with the new info.
-    stomp_write_barrier_ephemeral(ephemeral_low, ephemeral_high);
+    stomp_write_barrier_ephemeral(ephemeral_low, ephemeral_high, generation_allocation_start (generation_of (0)));
 #endif // MULTIPLE_HEAPS
 }
 
@@ -9846,6 +10288,30 @@ HRESULT gc_heap::initialize_gc (size_t soh_segment_size,
     }
 #endif //GC_CONFIG_DRIVEN
 
+#if defined(USE_VXSORT) && defined(USE_INTROSORT)
+    uint32_t instruction_sets = GCToEEInterface::GetSupportedInstructionSets();
+    if (instruction_sets & GCInstructionSet_Avx512F)
+    {
+        vxsort_partition = vxsort_partition_avx512;
+    }
+    else if (instruction_sets & GCInstructionSet_Avx2)
+    {
+        vxsort_partition = vxsort_partition_avx2;
+    }
+#endif //USE_VXSORT && USE_INTROSORT
+
+#ifdef USE_VECTORIZED_CARD_SCAN
+    uint32_t card_scan_instruction_sets = GCToEEInterface::GetSupportedInstructionSets();
+    if (card_scan_instruction_sets & GCInstructionSet_Avx512F)
+    {
+        vectorized_find_nonzero_card_word = find_nonzero_card_word_avx512;
+    }
+    else if (card_scan_instruction_sets & GCInstructionSet_Avx2)
+    {
+        vectorized_find_nonzero_card_word = find_nonzero_card_word_avx2;
+    }
+#endif //USE_VECTORIZED_CARD_SCAN
+
     HRESULT hres = S_OK;
 
 #ifdef WRITE_WATCH
@@ -10047,6 +10513,7 @@ gc_heap::init_semi_shared()
     }
 
     fgn_loh_percent = 0;
+    fgn_lead_bytes = 0;
     full_gc_approach_event_set = false;
 
     memset (full_gc_counts, 0, sizeof (full_gc_counts));
@@ -10058,8 +10525,9 @@ gc_heap::init_semi_shared()
     loh_compaction_mode = loh_compaction_default;
 #endif //FEATURE_LOH_COMPACTION
 
-    loh_size_threshold = (size_t)GCConfig::GetLOHThreshold();
-    assert (loh_size_threshold >= LARGE_OBJECT_SIZE);
+    // The allocation helpers of the EE treat anything smaller than LARGE_OBJECT_SIZE as a small object, so
+    // the threshold can only be raised.
+    loh_size_threshold = max ((size_t)GCConfig::GetLOHThreshold(), (size_t)LARGE_OBJECT_SIZE);
 
 #ifdef BGC_SERVO_TUNING
     memset (bgc_tuning::gen_calc, 0, sizeof (bgc_tuning::gen_calc));
@@ -10146,6 +10614,15 @@ gc_heap::init_semi_shared()
     bgc_alloc_spin_count = static_cast<uint32_t>(GCConfig::GetBGCSpinCount());
     bgc_alloc_spin = static_cast<uint32_t>(GCConfig::GetBGCSpin());
 
+    {
+        // Pacing is only needed when there is a quota to be throttled for
+        uint64_t throttled_time = 0;
+        bgc_pace_enabled_p = GCConfig::GetBGCCpuQuotaPacing() &&
+                             GCToOSInterface::GetCpuThrottledTime (&throttled_time);
+    }
+
+    bgc_mark_sharing_p = GCConfig::GetBGCMarkSharing();
+
     {
         int number_bgc_threads = 1;
 #ifdef MULTIPLE_HEAPS
@@ -10160,6 +10637,12 @@ gc_heap::init_semi_shared()
 
     memset (&current_no_gc_region_info, 0, sizeof (current_no_gc_region_info));
 
+    if (background_decommit_p && !create_decommit_thread())
+    {
+        // Decommit during the GC like without GCBackgroundDecommit.
+        background_decommit_p = false;
+    }
+
 #ifdef GC_CONFIG_DRIVEN
     compact_or_sweep_gcs[0] = 0;
     compact_or_sweep_gcs[1] = 0;
@@ -10436,6 +10919,10 @@ gc_heap::init_gc_heap (int  h_number)
 
     max_overflow_address = 0;
 
+    mark_overflow_chunks = 0;
+
+    mark_overflow_chunks_size = 0;
+
     gen0_bricks_cleared = FALSE;
 
     gen0_must_clear_bricks = 0;
@@ -10478,6 +10965,16 @@ gc_heap::init_gc_heap (int  h_number)
     gc_done_event_lock = -1;
     gc_done_event_set = false;
 
+    if (type_stats_p)
+    {
+        type_stats_table = new (nothrow) gc_type_stats [type_stats_table_length + 1];
+        if (!type_stats_table)
+            return 0;
+
+        memset (type_stats_table, 0, (type_stats_table_length + 1) * sizeof (gc_type_stats));
+        type_stats_table_used = 0;
+    }
+
     heap_segment* seg = make_initial_segment (soh_gen0, h_number);
     if (!seg)
         return 0;
@@ -10562,8 +11059,8 @@ gc_heap::init_gc_heap (int  h_number)
     heap_segment_allocated (pseg) = heap_segment_mem (pseg) + Align (min_obj_size, get_alignment_constant (FALSE));
     heap_segment_used (pseg) = heap_segment_allocated (pseg) - plug_skew;
 
-    generation_of (max_generation)->free_list_allocator = allocator(NUM_GEN2_ALIST, BASE_GEN2_ALIST_BITS, gen2_alloc_list);
-    generation_of (loh_generation)->free_list_allocator = allocator(NUM_LOH_ALIST, BASE_LOH_ALIST_BITS, loh_alloc_list);
+    generation_of (max_generation)->free_list_allocator = allocator(NUM_GEN2_ALIST, BASE_GEN2_ALIST_BITS, gen2_alloc_list, true);
+    generation_of (loh_generation)->free_list_allocator = allocator(NUM_LOH_ALIST, BASE_LOH_ALIST_BITS, loh_alloc_list, true);
     generation_of (poh_generation)->free_list_allocator = allocator(NUM_POH_ALIST, BASE_POH_ALIST_BITS, poh_alloc_list);
 
     for (int gen_num = 0; gen_num < total_generation_count; gen_num++)
@@ -10629,9 +11126,9 @@ gc_heap::init_gc_heap (int  h_number)
     {
         stomp_write_barrier_initialize(
 #ifdef MULTIPLE_HEAPS
-            reinterpret_cast<uint8_t*>(1), reinterpret_cast<uint8_t*>(~0)
+            reinterpret_cast<uint8_t*>(1), reinterpret_cast<uint8_t*>(~0), nullptr
 #else
-            ephemeral_low, ephemeral_high
+            ephemeral_low, ephemeral_high, generation_allocation_start(generation_of(0))
 #endif //!MULTIPLE_HEAPS
         );
     }
@@ -11131,11 +11628,12 @@ void gc_heap::check_batch_mark_array_bits (uint8_t* start, uint8_t* end)
 }
 #endif //VERIFY_HEAP && BACKGROUND_GC
 
-allocator::allocator (unsigned int num_b, int fbb, alloc_list* b)
+allocator::allocator (unsigned int num_b, int fbb, alloc_list* b, bool hs)
 {
     assert (num_b < MAX_BUCKET_COUNT);
     num_buckets = num_b;
     first_bucket_bits = fbb;
+    half_steps = hs;
     buckets = b;
 }
 
@@ -11526,7 +12024,25 @@ size_t gc_heap::new_allocation_limit (size_t size, size_t physical_limit, int ge
     return limit;
 }
 
-size_t gc_heap::limit_from_size (size_t size, uint32_t flags, size_t physical_limit, int gen_number,
+// The allocation quantum to use when refilling the given context. The EE may ask for larger quanta for
+// contexts that refill frequently and smaller ones for mostly idle contexts; we honor that within
+// [allocation_quantum / 4, allocation_quantum * 8] so the quantum still shrinks when the gen0 budget is small.
+size_t gc_heap::alloc_quantum_of (alloc_context* acontext)
+{
+    int shift = acontext->alloc_quantum_shift;
+    if (shift == 0)
+        return allocation_quantum;
+
+    size_t quantum;
+    if (shift > 0)
+        quantum = allocation_quantum << min (shift, 3);
+    else
+        quantum = allocation_quantum >> min (-shift, 2);
+
+    return Align (max (quantum, Align (min_obj_size)), get_alignment_constant (FALSE));
+}
+
+size_t gc_heap::limit_from_size (size_t size, alloc_context* acontext, uint32_t flags, size_t physical_limit, int gen_number,
                                  int align_const)
 {
     size_t padded_size = size + Align (min_obj_size, align_const);
@@ -11536,7 +12052,7 @@ size_t gc_heap::limit_from_size (size_t size, uint32_t flags, size_t physical_li
 
     // For SOH if the size asked for is very small, we want to allocate more than just what's asked for if possible.
     // Unless we were told not to clean, then we will not force it.
-    size_t min_size_to_allocate = ((gen_number == 0 && !(flags & GC_ALLOC_ZEROING_OPTIONAL)) ? allocation_quantum : 0);
+    size_t min_size_to_allocate = ((gen_number == 0 && !(flags & GC_ALLOC_ZEROING_OPTIONAL)) ? alloc_quantum_of (acontext) : 0);
 
     size_t desired_size_to_allocate  = max (padded_size, min_size_to_allocate);
     size_t new_physical_limit = min (physical_limit, desired_size_to_allocate);
@@ -11685,10 +12201,10 @@ void gc_heap::check_for_full_gc (int gen_num, size_t size)
 
     new_alloc_remain_percent = (int)(((float)(new_alloc_remain) / (float)dd_desired_allocation (dd_full)) * 100);
 
-    dprintf (2, ("FGN: alloc threshold for gen%d is %d%%, current threshold is %d%%",
-                 gen_num, pct, new_alloc_remain_percent));
+    dprintf (2, ("FGN: alloc threshold for gen%d is %d%% or %Id bytes, current threshold is %d%%",
+                 gen_num, pct, fgn_lead_bytes, new_alloc_remain_percent));
 
-    if (new_alloc_remain_percent <= (int)pct)
+    if ((new_alloc_remain_percent <= (int)pct) || (new_alloc_remain <= (ptrdiff_t)fgn_lead_bytes))
     {
 #ifdef BACKGROUND_GC
         // If background GC is enabled, we still want to check whether this will
@@ -11784,6 +12300,9 @@ void gc_heap::send_full_gc_notification (int gen_num, BOOL due_to_alloc_p)
         full_gc_end_event.Reset();
         full_gc_approach_event.Set();
         full_gc_approach_event_set = true;
+
+        // The EE only needs to know whether the SOH or the LOH budget is the reason.
+        GCToEEInterface::FullGCApproaching ((gen_num >= uoh_start_generation) ? gen_num : max_generation);
     }
 }
 
@@ -11896,7 +12415,7 @@ BOOL gc_heap::a_fit_free_list_p (int gen_number,
                 // We ask for more Align (min_obj_size)
                 // to make sure that we can insert a free object
                 // in adjust_limit will set the limit lower
-                size_t limit = limit_from_size (size, flags, free_list_size, gen_number, align_const);
+                size_t limit = limit_from_size (size, acontext, flags, free_list_size, gen_number, align_const);
 
                 uint8_t*  remain = (free_list + limit);
                 size_t remain_size = (free_list_size - limit);
@@ -12065,7 +12584,7 @@ BOOL gc_heap::a_fit_free_list_uoh_p (size_t size,
                 allocator->unlink_item (a_l_idx, free_list, prev_free_item, FALSE);
 
                 // Substract min obj size because limit_from_size adds it. Not needed for LOH
-                size_t limit = limit_from_size (size - Align(min_obj_size, align_const), flags, free_list_size,
+                size_t limit = limit_from_size (size - Align(min_obj_size, align_const), acontext, flags, free_list_size,
                                                 gen_number, align_const);
 
 #ifdef FEATURE_LOH_COMPACTION
@@ -12158,6 +12677,7 @@ BOOL gc_heap::a_fit_segment_end_p (int gen_number,
     if (a_size_fit_p (size, allocated, end, align_const))
     {
         limit = limit_from_size (size,
+                                 acontext,
                                  flags,
                                  (end - allocated),
                                  gen_number, align_const);
@@ -12169,6 +12689,7 @@ BOOL gc_heap::a_fit_segment_end_p (int gen_number,
     if (a_size_fit_p (size, allocated, end, align_const))
     {
         limit = limit_from_size (size,
+                                 acontext,
                                  flags,
                                  (end - allocated),
                                  gen_number, align_const);
@@ -13415,6 +13936,151 @@ allocation_state gc_heap::try_allocate_more_space (alloc_context* acontext, size
     return can_allocate;
 }
 
+#ifdef MULTIPLE_HEAPS
+// Moves an allocation context off a heap that is no longer active. Called with the EE suspended, after
+// the allocation contexts were retired for the GC, so the context doesn't point into the old heap.
+void gc_heap::rebalance_alloc_context (gc_alloc_context* gc_context, void* param)
+{
+    UNREFERENCED_PARAMETER(param);
+    alloc_context* acontext = (alloc_context*)gc_context;
+
+    GCHeap* alloc_heap = acontext->get_alloc_heap ();
+    if (alloc_heap == NULL)
+        return;
+
+    gc_heap* org_hp = alloc_heap->pGenGCHeap;
+    if (org_hp->heap_number < n_active_heaps)
+        return;
+
+    gc_heap* new_hp = g_heaps[org_hp->heap_number % n_active_heaps];
+    org_hp->alloc_context_count--;
+    new_hp->alloc_context_count++;
+    acontext->set_alloc_heap (GCHeap::GetHeap (new_hp->heap_number));
+    acontext->set_home_heap (acontext->get_alloc_heap ());
+}
+
+void gc_heap::set_active_heap_count (int new_n_active_heaps)
+{
+    assert ((new_n_active_heaps >= 1) && (new_n_active_heaps <= n_heaps));
+    dprintf (GTC_LOG, ("GC#%Id: active heaps %d->%d", settings.gc_index, n_active_heaps, new_n_active_heaps));
+
+    bool shrinking_p = (new_n_active_heaps < n_active_heaps);
+    n_active_heaps = new_n_active_heaps;
+
+    // When growing, balance_heaps moves contexts onto the new heaps as their budgets are the largest.
+    if (shrinking_p)
+    {
+        GCToEEInterface::GcEnumAllocContexts (rebalance_alloc_context, NULL);
+    }
+}
+
+// With fewer active heaps, allocations exhaust the gen0 budget of fewer heaps, so we GC more often
+// but keep less gen0 memory committed. We shrink while the time in GC stays low and grow quickly
+// (doubling) once it gets expensive, measured over a window of blocking GCs.
+#define heap_count_sample_window 8
+#define heap_count_grow_gc_percent 5
+#define heap_count_shrink_gc_percent 1
+
+void gc_heap::adapt_active_heap_count ()
+{
+    size_t now = GetHighPrecisionTimeStamp ();
+    size_t gc_elapsed_time = dd_gc_elapsed_time (g_heaps[0]->dynamic_data_of (0));
+
+    if (heap_count_last_gc_end_time != 0)
+    {
+        heap_count_gc_time += gc_elapsed_time;
+        heap_count_elapsed_time += now - heap_count_last_gc_end_time;
+        heap_count_samples++;
+    }
+    heap_count_last_gc_end_time = now;
+
+    if (heap_count_samples < heap_count_sample_window)
+        return;
+
+    size_t gc_percent = ((heap_count_elapsed_time == 0) ? 100 : (heap_count_gc_time * 100 / heap_count_elapsed_time));
+    heap_count_gc_time = 0;
+    heap_count_elapsed_time = 0;
+    heap_count_samples = 0;
+
+    int new_n_active_heaps = n_active_heaps;
+    if (gc_percent >= heap_count_grow_gc_percent)
+    {
+        new_n_active_heaps = min (n_max_active_heaps, (n_active_heaps * 2));
+    }
+    else if (gc_percent < heap_count_shrink_gc_percent)
+    {
+        new_n_active_heaps = max (1, (n_active_heaps - max (1, (n_active_heaps / 4))));
+    }
+
+    if (new_n_active_heaps != n_active_heaps)
+    {
+        set_active_heap_count (new_n_active_heaps);
+    }
+}
+
+#endif //MULTIPLE_HEAPS
+
+// Containers can change the memory and CPU limits of a running process, e.g. with vertical autoscaling. Every
+// GCResourceLimitsRefresh ms a blocking GC re-reads them and updates what was derived from them at init: the
+// physical memory the memory load is measured against, the hard limit if it came from the container memory
+// limit, and how many server GC heaps allocations use. The heaps themselves are fixed at init, so the heap
+// count and the hard limit can only go down from their initial values.
+void gc_heap::refresh_resource_limits()
+{
+    size_t refresh_interval = (size_t)GCConfig::GetGCResourceLimitsRefresh();
+    if (refresh_interval == 0)
+        return;
+
+    size_t now = GetHighPrecisionTimeStamp();
+    if ((now - resource_limits_refresh_time) < refresh_interval)
+        return;
+    resource_limits_refresh_time = now;
+
+    if (!GCToOSInterface::RefreshResourceLimits())
+        return;
+
+    if (physical_mem_from_os_p)
+    {
+        uint64_t new_physical_mem = GCToOSInterface::GetPhysicalMemoryLimit (&is_restricted_physical_mem);
+        if ((new_physical_mem != 0) && (new_physical_mem != total_physical_mem))
+        {
+            dprintf (GTC_LOG, ("GC#%Id: physical memory %I64d->%I64d", settings.gc_index, total_physical_mem, new_physical_mem));
+            total_physical_mem = new_physical_mem;
+            mem_one_percent = total_physical_mem / 100;
+#ifndef MULTIPLE_HEAPS
+            mem_one_percent /= g_num_processors;
+#endif //!MULTIPLE_HEAPS
+
+#ifdef HOST_64BIT
+            youngest_gen_desired_th = mem_one_percent;
+
+            if (container_heap_hard_limit != 0)
+            {
+                uint64_t physical_mem_for_gc = total_physical_mem * (uint64_t)75 / (uint64_t)100;
+                physical_mem_for_gc = max ((uint64_t)(20 * 1024 * 1024), physical_mem_for_gc);
+                heap_hard_limit = (size_t)min ((uint64_t)container_heap_hard_limit, physical_mem_for_gc);
+            }
+#endif //HOST_64BIT
+        }
+    }
+
+#ifdef MULTIPLE_HEAPS
+    if (heap_count_from_cpu_limit_p)
+    {
+        int cpu_count = (int)GCToOSInterface::GetCurrentProcessCpuCount();
+        n_max_active_heaps = max (1, min (n_heaps, cpu_count));
+
+        // Without GCDynamicHeapCount all the heaps allowed are used, with it adapt_active_heap_count grows
+        // back up to the new maximum.
+        if ((n_active_heaps > n_max_active_heaps) ||
+            (!dynamic_heap_count_p && (n_active_heaps < n_max_active_heaps)))
+        {
+            set_active_heap_count (n_max_active_heaps);
+        }
+    }
+#endif //MULTIPLE_HEAPS
+}
+
 #ifdef MULTIPLE_HEAPS
 void gc_heap::balance_heaps (alloc_context* acontext)
 {
@@ -13422,7 +14088,7 @@ void gc_heap::balance_heaps (alloc_context* acontext)
     {
         if (acontext->alloc_count == 0)
         {
-            int home_hp_num = heap_select::select_heap (acontext);
+            int home_hp_num = heap_select::select_active_heap (acontext);
             acontext->set_home_heap (GCHeap::GetHeap (home_hp_num));
             gc_heap* hp = acontext->get_home_heap ()->pGenGCHeap;
             acontext->set_alloc_heap (acontext->get_home_heap ());
@@ -13460,7 +14126,7 @@ void gc_heap::balance_heaps (alloc_context* acontext)
         {
             assert (acontext->get_home_heap () != NULL);
             home_hp = acontext->get_home_heap ()->pGenGCHeap;
-            proc_hp_num = heap_select::select_heap (acontext);
+            proc_hp_num = heap_select::select_active_heap (acontext);
 
             if (acontext->get_home_heap () != GCHeap::GetHeap (proc_hp_num))
             {
@@ -13550,7 +14216,7 @@ try_again:
                     int current_hp_num = heap_select::proc_no_to_heap_no[proc_no];
                     acontext->set_home_heap (GCHeap::GetHeap (current_hp_num));
 #else
-                    acontext->set_home_heap (GCHeap::GetHeap (heap_select::select_heap (acontext)));
+                    acontext->set_home_heap (GCHeap::GetHeap (heap_select::select_active_heap (acontext)));
 #endif //HEAP_BALANCE_INSTRUMENTATION
                     new_home_hp = acontext->get_home_heap ()->pGenGCHeap;
                     if (org_hp == new_home_hp)
@@ -13566,6 +14232,9 @@ try_again:
 
                     for (int i = start; i < end; i++)
                     {
+                        if ((i % n_heaps) >= n_active_heaps)
+                            continue;
+
                         gc_heap* hp = GCHeap::GetHeap (i % n_heaps)->pGenGCHeap;
                         dd = hp->dynamic_data_of (0);
                         ptrdiff_t size = dd_new_allocation (dd);
@@ -13694,6 +14363,14 @@ try_again:
     gc_heap* max_hp = home_hp;
     ptrdiff_t max_size = home_hp_size + delta;
 
+    // A heap whose UOH lock is held has another thread allocating on it, and we would wait behind that
+    // thread. Busy heaps lose delta so concurrent UOH allocations spread over the heaps instead of
+    // convoying on one lock.
+    if (home_hp->more_space_lock_uoh.lock >= 0)
+    {
+        max_size -= delta;
+    }
+
     dprintf (3, ("home hp: %d, max size: %d",
         home_hp_num,
         max_size));
@@ -13701,7 +14378,11 @@ try_again:
     for (int i = start; i < end; i++)
     {
         gc_heap* hp = GCHeap::GetHeap(i%n_heaps)->pGenGCHeap;
-        const ptrdiff_t size = hp->get_balance_heaps_uoh_effective_budget (generation_num);
+        ptrdiff_t size = hp->get_balance_heaps_uoh_effective_budget (generation_num);
+        if (hp->more_space_lock_uoh.lock >= 0)
+        {
+            size -= delta;
+        }
 
         dprintf (3, ("hp: %d, size: %d", hp->heap_number, size));
         if (size > max_size)
@@ -14895,6 +15576,34 @@ int gc_heap::joined_generation_to_condemn (BOOL should_evaluate_elevation,
         }
     }
 
+    // Only gen1 GCs are turned into compacting full GCs for GCConserveMemory, so a generation that compaction
+    // can't defragment (because of pinning) doesn't make every GC a full one.
+    if ((conserve_mem_setting != 0) && (n == (max_generation - 1)) && !provisional_mode_triggered
+#ifdef BACKGROUND_GC
+        && !gc_heap::background_running_p()
+#endif //BACKGROUND_GC
+        )
+    {
+        if (conserve_mem_frag_exceeded_p (max_generation))
+        {
+            dprintf (GTC_LOG, ("conserving memory, compacting gen2"));
+            gc_data_global.gen_to_condemn_reasons.set_condition(gen_max_high_frag_p);
+            n = max_generation;
+            *blocking_collection_p = TRUE;
+        }
+
+#ifdef FEATURE_LOH_COMPACTION
+        if (conserve_mem_frag_exceeded_p (loh_generation))
+        {
+            dprintf (GTC_LOG, ("conserving memory, compacting LOH"));
+            gc_data_global.gen_to_condemn_reasons.set_condition(gen_joined_limit_loh_frag);
+            n = max_generation;
+            *blocking_collection_p = TRUE;
+            settings.loh_compaction = TRUE;
+        }
+#endif //FEATURE_LOH_COMPACTION
+    }
+
 #ifdef BGC_SERVO_TUNING
     if (bgc_tuning::should_trigger_ngc2())
     {
@@ -16430,6 +17139,7 @@ void gc_heap::gc1()
     {
         rearrange_uoh_segments();
         do_post_gc();
+        refresh_resource_limits();
     }
 
     pm_full_gc_init_or_clear();
@@ -16591,6 +17301,111 @@ start_no_gc_region_status gc_heap::get_start_no_gc_region_status()
     return current_no_gc_region_info.start_status;
 }
 
+// What the heaps can still allocate in gen_number before the no gc region runs out.
+uint64_t gc_heap::no_gc_remaining (int gen_number)
+{
+    uint64_t remaining = 0;
+
+#ifdef MULTIPLE_HEAPS
+    for (int i = 0; i < n_heaps; i++)
+    {
+        gc_heap* hp = g_heaps[i];
+#else //MULTIPLE_HEAPS
+    {
+        gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+        ptrdiff_t new_allocation = dd_new_allocation (hp->dynamic_data_of (gen_number));
+        if (new_allocation > 0)
+            remaining += (uint64_t)new_allocation;
+    }
+
+    return remaining;
+}
+
+inline
+uint64_t no_gc_participant_used (no_gc_participant* participant)
+{
+    int64_t used = participant->acontext->alloc_bytes - participant->start_alloc_bytes;
+    return ((used > 0) ? (uint64_t)used : 0);
+}
+
+inline
+uint64_t no_gc_participant_unused (no_gc_participant* participant)
+{
+    uint64_t used = no_gc_participant_used (participant);
+    return ((used < participant->allowance) ? (participant->allowance - used) : 0);
+}
+
+no_gc_participant* gc_heap::find_no_gc_participant()
+{
+    gc_alloc_context* acontext = GCToEEInterface::GetAllocContext();
+    for (int i = 0; i < current_no_gc_region_info.participant_count; i++)
+    {
+        if (current_no_gc_region_info.participants[i].acontext == acontext)
+            return &current_no_gc_region_info.participants[i];
+    }
+
+    return 0;
+}
+
+no_gc_participant* gc_heap::add_no_gc_participant (uint64_t allowance)
+{
+    if (current_no_gc_region_info.participant_count == max_no_gc_participants)
+        return 0;
+
+    no_gc_participant* participant = &current_no_gc_region_info.participants[current_no_gc_region_info.participant_count++];
+    participant->acontext = GCToEEInterface::GetAllocContext();
+    participant->allowance = allowance;
+    participant->start_alloc_bytes = participant->acontext->alloc_bytes;
+    participant->depth = 1;
+
+    return participant;
+}
+
+// Starting a no gc region while one is in progress joins it without a GC when what is left of its reservation
+// covers the allowance on top of what the other threads in it may still allocate. A nested region of the same
+// thread only needs what its allowance grows by. UOH bytes are only checked against what is left for them.
+start_no_gc_region_status gc_heap::join_no_gc_region (uint64_t total_size, BOOL loh_size_known, uint64_t loh_size)
+{
+    // A GC already ended the region for everyone in it.
+    if (settings.pause_mode != pause_no_gc)
+        return start_no_gc_in_progress;
+
+    uint64_t allowance = (loh_size_known ? (total_size - loh_size) : total_size);
+    no_gc_participant* participant = find_no_gc_participant();
+
+    uint64_t others_unused = 0;
+    for (int i = 0; i < current_no_gc_region_info.participant_count; i++)
+    {
+        if (&current_no_gc_region_info.participants[i] != participant)
+            others_unused += no_gc_participant_unused (&current_no_gc_region_info.participants[i]);
+    }
+
+    uint64_t needed = (participant ? max (allowance, no_gc_participant_unused (participant)) : allowance);
+    if ((others_unused + needed) > no_gc_remaining (0))
+    {
+        dprintf (1, ("can't join no gc region: %I64d unused by others + %I64d > %I64d left",
+            others_unused, needed, no_gc_remaining (0)));
+        return start_no_gc_no_memory;
+    }
+
+    if (loh_size_known && (loh_size > no_gc_remaining (loh_generation)))
+        return start_no_gc_no_memory;
+
+    if (participant)
+    {
+        participant->allowance = no_gc_participant_used (participant) + needed;
+        participant->depth++;
+    }
+    else if (!add_no_gc_participant (allowance))
+    {
+        return start_no_gc_in_progress;
+    }
+
+    dprintf (1, ("joined no gc region with %I64d, %d threads in it", allowance, current_no_gc_region_info.participant_count));
+    return start_no_gc_success;
+}
+
 void gc_heap::record_gcs_during_no_gc()
 {
     if (current_no_gc_region_info.started)
@@ -16876,6 +17691,35 @@ end_no_gc_region_status gc_heap::end_no_gc_region()
     else if (current_no_gc_region_info.num_gcs)
         status = end_no_gc_alloc_exceeded;
 
+    // Only the last thread to leave ends the region. A region that was started on one thread can still be
+    // ended on another as long as nobody joined it.
+    if (current_no_gc_region_info.started && (current_no_gc_region_info.participant_count != 0))
+    {
+        no_gc_participant* participant = find_no_gc_participant();
+        if (!participant)
+        {
+            if (current_no_gc_region_info.participant_count > 1)
+                return end_no_gc_not_in_progress;
+
+            participant = &current_no_gc_region_info.participants[0];
+        }
+
+        if ((status == end_no_gc_success) && (no_gc_participant_used (participant) > participant->allowance))
+            status = end_no_gc_alloc_exceeded;
+
+        participant->depth--;
+        if ((participant->depth != 0) || (current_no_gc_region_info.participant_count > 1))
+        {
+            if (participant->depth == 0)
+            {
+                *participant = current_no_gc_region_info.participants[--current_no_gc_region_info.participant_count];
+            }
+
+            dprintf (1, ("left no gc region, %d threads still in it", current_no_gc_region_info.participant_count));
+            return status;
+        }
+    }
+
     if (settings.pause_mode == pause_no_gc)
         restore_data_for_no_gc();
 
@@ -17441,6 +18285,10 @@ void gc_heap::garbage_collect (int n)
         }
 #else
         prepare_bgc_thread(0);
+
+        // The helpers are suspendable threads, which have to be created during a GC.
+        if (!bgc_mark_helpers_created_p)
+            create_bgc_mark_helpers();
 #endif //MULTIPLE_HEAPS
 
 #ifdef MULTIPLE_HEAPS
@@ -18103,6 +18951,70 @@ inline void Prefetch (void* addr)
     UNREFERENCED_PARAMETER(addr);
 }
 #endif //PREFETCH
+
+#define MARK_PHASE_PREFETCH
+
+#ifdef MARK_PHASE_PREFETCH
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#define PrefetchForMark(addr) _mm_prefetch((const char*)(addr), _MM_HINT_T0)
+#elif defined(__GNUC__)
+#define PrefetchForMark(addr) __builtin_prefetch((addr))
+#else
+#define PrefetchForMark(addr) UNREFERENCED_PARAMETER(addr)
+#endif
+
+// A small FIFO that sits between discovering a reference and marking it. Marking reads and writes the
+// header of the referenced object, which is usually a cache miss when chasing a pointer graph. Each
+// reference is prefetched when it is queued and only marked once slot_count other references have been
+// queued after it, so the miss overlaps with the work done in the meantime.
+class mark_queue_t
+{
+    static const size_t slot_count = 16;
+    uint8_t* slot_table[slot_count];
+    size_t curr_slot_index;
+    uint8_t* range_low;
+    uint8_t* range_high;
+
+public:
+    mark_queue_t (uint8_t* low, uint8_t* high)
+    {
+        memset (slot_table, 0, sizeof (slot_table));
+        curr_slot_index = 0;
+        range_low = low;
+        range_high = high;
+    }
+
+    // Queues o if it is in the range that can be marked and returns the reference that has been
+    // waiting the longest, or 0 if no reference is ready yet.
+    uint8_t* queue_mark (uint8_t* o)
+    {
+        if ((o < range_low) || (o >= range_high))
+            return 0;
+
+        PrefetchForMark (o);
+        size_t slot_index = curr_slot_index;
+        uint8_t* old_o = slot_table[slot_index];
+        slot_table[slot_index] = o;
+        curr_slot_index = (slot_index + 1) % slot_count;
+        return old_o;
+    }
+
+    // Removes and returns the oldest reference still in the queue, or 0 once the queue is empty.
+    uint8_t* get_next_queued()
+    {
+        for (size_t i = 0; i < slot_count; i++)
+        {
+            size_t slot_index = curr_slot_index;
+            uint8_t* o = slot_table[slot_index];
+            slot_table[slot_index] = 0;
+            curr_slot_index = (slot_index + 1) % slot_count;
+            if (o)
+                return o;
+        }
+        return 0;
+    }
+};
+#endif //MARK_PHASE_PREFETCH
 #ifdef MH_SC_MARK
 inline
 VOLATILE(uint8_t*)& gc_heap::ref_mark_stack (gc_heap* hp, int index)
@@ -18166,6 +19078,15 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
 
     assert ((start >= oo) && (start < oo+size(oo)));
 
+#ifdef MARK_PHASE_PREFETCH
+#ifdef MULTIPLE_HEAPS
+    // References into other heaps can be marked too, gc_mark does the precise range check.
+    mark_queue_t mark_queue (g_gc_lowest_address, g_gc_highest_address);
+#else //MULTIPLE_HEAPS
+    mark_queue_t mark_queue (gc_low, gc_high);
+#endif //MULTIPLE_HEAPS
+#endif //MARK_PHASE_PREFETCH
+
 #ifndef MH_SC_MARK
     *mark_stack_tos = oo;
 #endif //!MH_SC_MARK
@@ -18204,8 +19125,12 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
 
                     go_through_object_cl (method_table(oo), oo, s, ppslot,
                                           {
+#ifdef MARK_PHASE_PREFETCH
+                                              uint8_t* o = mark_queue.queue_mark (*ppslot);
+#else //MARK_PHASE_PREFETCH
                                               uint8_t* o = *ppslot;
                                               Prefetch(o);
+#endif //MARK_PHASE_PREFETCH
                                               if (gc_mark (o, gc_low, gc_high))
                                               {
                                                   if (full_p)
@@ -18218,6 +19143,8 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
                                                   }
                                                   size_t obj_size = size (o);
                                                   promoted_bytes (thread) += obj_size;
+                                                  if (type_stats_in_mark_p)
+                                                      record_type_stats (o, obj_size THREAD_NUMBER_ARG);
                                                   if (contain_pointers_or_collectible (o))
                                                   {
                                                       *(mark_stack_tos++) = o;
@@ -18229,8 +19156,7 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
                 else
                 {
                     dprintf(3,("mark stack overflow for object %Ix ", (size_t)oo));
-                    min_overflow_address = min (min_overflow_address, oo);
-                    max_overflow_address = max (max_overflow_address, oo);
+                    record_mark_overflow (oo);
                 }
             }
             else
@@ -18263,6 +19189,8 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
 
                             size_t obj_size = size (class_obj);
                             promoted_bytes (thread) += obj_size;
+                            if (type_stats_in_mark_p)
+                                record_type_stats (class_obj, obj_size THREAD_NUMBER_ARG);
                             *(mark_stack_tos++) = class_obj;
                             // The code below expects that the oo is still stored in the stack slot that was
                             // just popped and it "pushes" it back just by incrementing the mark_stack_tos.
@@ -18304,8 +19232,12 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
                     go_through_object (method_table(oo), oo, s, ppslot,
                                        start, use_start, (oo + s),
                                        {
+#ifdef MARK_PHASE_PREFETCH
+                                           uint8_t* o = mark_queue.queue_mark (*ppslot);
+#else //MARK_PHASE_PREFETCH
                                            uint8_t* o = *ppslot;
                                            Prefetch(o);
+#endif //MARK_PHASE_PREFETCH
                                            if (gc_mark (o, gc_low, gc_high))
                                            {
                                                 if (full_p)
@@ -18318,6 +19250,8 @@ void gc_heap::mark_object_simple1 (uint8_t* oo, uint8_t* start THREAD_NUMBER_DCL
                                                 }
                                                 size_t obj_size = size (o);
                                                 promoted_bytes (thread) += obj_size;
+                                                if (type_stats_in_mark_p)
+                                                    record_type_stats (o, obj_size THREAD_NUMBER_ARG);
                                                 if (contain_pointers_or_collectible (o))
                                                 {
                                                     *(mark_stack_tos++) = o;
@@ -18357,8 +19291,7 @@ more_to_do:
                 else
                 {
                     dprintf(3,("mark stack overflow for object %Ix ", (size_t)oo));
-                    min_overflow_address = min (min_overflow_address, oo);
-                    max_overflow_address = max (max_overflow_address, oo);
+                    record_mark_overflow (oo);
                 }
             }
 #ifdef SORT_MARK_STACK
@@ -18370,6 +19303,37 @@ more_to_do:
 #endif //SORT_MARK_STACK
         }
     next_level:
+#ifdef MARK_PHASE_PREFETCH
+        if (mark_stack_empty_p())
+        {
+            // Mark what is still parked in the queue before giving up; the first of those that has
+            // references to follow gets pushed so we keep going from there.
+            uint8_t* o;
+            while ((o = mark_queue.get_next_queued()) != 0)
+            {
+                if (gc_mark (o, gc_low, gc_high))
+                {
+                    if (full_p)
+                    {
+                        m_boundary_fullgc (o);
+                    }
+                    else
+                    {
+                        m_boundary (o);
+                    }
+                    size_t obj_size = size (o);
+                    promoted_bytes (thread) += obj_size;
+                    if (type_stats_in_mark_p)
+                        record_type_stats (o, obj_size THREAD_NUMBER_ARG);
+                    if (contain_pointers_or_collectible (o))
+                    {
+                        *(mark_stack_tos++) = o;
+                        break;
+                    }
+                }
+            }
+        }
+#endif //MARK_PHASE_PREFETCH
         if (!(mark_stack_empty_p()))
         {
             oo = *(--mark_stack_tos);
@@ -18744,6 +19708,8 @@ gc_heap::mark_object_simple (uint8_t** po THREAD_NUMBER_DCL)
             m_boundary (o);
             size_t s = size (o);
             promoted_bytes (thread) += s;
+            if (type_stats_in_mark_p)
+                record_type_stats (o, s THREAD_NUMBER_ARG);
             {
                 go_through_object_cl (method_table(o), o, s, poo,
                                         {
@@ -18753,6 +19719,8 @@ gc_heap::mark_object_simple (uint8_t** po THREAD_NUMBER_DCL)
                                                 m_boundary (oo);
                                                 size_t obj_size = size (oo);
                                                 promoted_bytes (thread) += obj_size;
+                                                if (type_stats_in_mark_p)
+                                                    record_type_stats (oo, obj_size THREAD_NUMBER_ARG);
 
                                                 if (contain_pointers_or_collectible (oo))
                                                     mark_object_simple1 (oo, oo THREAD_NUMBER_ARG);
@@ -18837,6 +19805,8 @@ void gc_heap::background_mark_simple1 (uint8_t* oo THREAD_NUMBER_DCL)
                             //m_boundary (o);
                             size_t obj_size = size (o);
                             bpromoted_bytes (thread) += obj_size;
+                            if (type_stats_p)
+                                record_type_stats (o, obj_size THREAD_NUMBER_ARG);
                             if (contain_pointers_or_collectible (o))
                             {
                                 *(background_mark_stack_tos++) = o;
@@ -18876,6 +19846,8 @@ void gc_heap::background_mark_simple1 (uint8_t* oo THREAD_NUMBER_DCL)
                         {
                             size_t obj_size = size (class_obj);
                             bpromoted_bytes (thread) += obj_size;
+                            if (type_stats_p)
+                                record_type_stats (class_obj, obj_size THREAD_NUMBER_ARG);
 
                             *(background_mark_stack_tos++) = class_obj;
                         }
@@ -18933,6 +19905,8 @@ void gc_heap::background_mark_simple1 (uint8_t* oo THREAD_NUMBER_DCL)
                             //m_boundary (o);
                             size_t obj_size = size (o);
                             bpromoted_bytes (thread) += obj_size;
+                            if (type_stats_p)
+                                record_type_stats (o, obj_size THREAD_NUMBER_ARG);
                             if (contain_pointers_or_collectible (o))
                             {
                                 *(background_mark_stack_tos++) = o;
@@ -18979,6 +19953,13 @@ void gc_heap::background_mark_simple1 (uint8_t* oo THREAD_NUMBER_DCL)
 #ifdef COLLECTIBLE_CLASS
 next_level:
 #endif // COLLECTIBLE_CLASS
+        if (bgc_mark_sharing_open &&
+            (bgc_mark_idle_count > bgc_mark_full_count) &&
+            ((size_t)(background_mark_stack_tos - background_mark_stack_array) >= bgc_mark_publish_min_depth))
+        {
+            background_mark_publish_work();
+        }
+
         allow_fgc();
 
         if (!(background_mark_stack_tos == background_mark_stack_array))
@@ -18998,6 +19979,484 @@ next_level:
 
 }
 
+void gc_heap::bgc_mark_pool_enter()
+{
+    // Held for a few instructions at a time, never across an allow_fgc or an allocation.
+    while (Interlocked::CompareExchange (&bgc_mark_pool_lock, 1, 0) != 0)
+    {
+        YieldProcessor();           // indicate to the processor that we are spinning
+    }
+}
+
+void gc_heap::bgc_mark_pool_leave()
+{
+    VolatileStore<int32_t>((int32_t*)&bgc_mark_pool_lock, 0);
+}
+
+// Packets are kept on the free list for the BGCs that come after, there are never more of them than the
+// participants publish at once.
+bgc_mark_packet* gc_heap::bgc_mark_get_free_packet()
+{
+    bgc_mark_pool_enter();
+    bgc_mark_packet* packet = bgc_mark_free_packets;
+    if (packet)
+    {
+        bgc_mark_free_packets = packet->next;
+    }
+    bgc_mark_pool_leave();
+
+    if (!packet)
+    {
+        packet = new (nothrow) bgc_mark_packet;
+        if (!packet)
+            return 0;
+    }
+
+    packet->next = 0;
+    packet->count = 0;
+    return packet;
+}
+
+void gc_heap::bgc_mark_free_packet (bgc_mark_packet* packet)
+{
+    bgc_mark_pool_enter();
+    packet->next = bgc_mark_free_packets;
+    bgc_mark_free_packets = packet;
+    bgc_mark_pool_leave();
+}
+
+void gc_heap::bgc_mark_push_packet (bgc_mark_packet* packet)
+{
+    bgc_mark_pool_enter();
+    // The window can't close while a participant is busy, which the one publishing is.
+    assert (bgc_mark_sharing_open);
+    packet->next = bgc_mark_full_packets;
+    bgc_mark_full_packets = packet;
+    bgc_mark_full_count++;
+    bgc_mark_pool_leave();
+}
+
+void gc_heap::background_mark_publish_work()
+{
+    size_t depth = background_mark_stack_tos - background_mark_stack_array;
+    bgc_mark_packet* packet = bgc_mark_get_free_packet();
+    if (!packet)
+        return;
+
+    // Take the oldest entries, they are the closest to the roots and have the most work under them. A
+    // partially marked object stays on the stack together with where it got to, and so do the ones before
+    // and after it.
+    size_t limit = min ((size_t)BGC_MARK_PACKET_LENGTH, depth / 2);
+    size_t kept = 0;
+    size_t i = 0;
+    while ((i < depth) && (packet->count < limit))
+    {
+        uint8_t* o = background_mark_stack_array[i];
+        if (((i + 1) < depth) && ((size_t)background_mark_stack_array[i + 1] & 1))
+        {
+            background_mark_stack_array[kept++] = o;
+            background_mark_stack_array[kept++] = background_mark_stack_array[i + 1];
+            i += 2;
+        }
+        else
+        {
+            // finished partial marks leave 0's behind
+            if (o)
+            {
+                packet->objects[packet->count++] = o;
+            }
+            i++;
+        }
+    }
+
+    if (packet->count == 0)
+    {
+        bgc_mark_free_packet (packet);
+        return;
+    }
+
+    memmove (&background_mark_stack_array[kept], &background_mark_stack_array[i], (depth - i) * sizeof (uint8_t*));
+    background_mark_stack_tos = &background_mark_stack_array[kept + (depth - i)];
+
+    dprintf (3, ("h%d: published %Id objects, %Id left on the mark stack",
+        heap_number, packet->count, (size_t)(background_mark_stack_tos - background_mark_stack_array)));
+
+    bgc_mark_push_packet (packet);
+}
+
+void gc_heap::background_mark_open_sharing()
+{
+    if (!bgc_mark_sharing_p)
+        return;
+
+#ifdef MULTIPLE_HEAPS
+    int participants = n_heaps;
+    for (int i = 0; i < n_heaps; i++)
+    {
+        g_heaps[i]->bgc_mark_taken_packet = 0;
+    }
+#else
+    // The helpers would get in the way of pacing, and type stats are not kept with interlocked operations.
+    if ((bgc_mark_helper_count == 0) || type_stats_p || bgc_pace_enabled_p)
+        return;
+
+    int participants = 1 + bgc_mark_helper_count;
+    bgc_mark_taken_packet = 0;
+#endif //MULTIPLE_HEAPS
+
+    if (participants < 2)
+        return;
+
+    assert (!bgc_mark_sharing_open);
+    assert (bgc_mark_full_packets == 0);
+    bgc_mark_full_count = 0;
+    bgc_mark_idle_count = 0;
+    bgc_mark_busy_count = participants;
+    bgc_mark_sharing_open = true;
+
+    dprintf (GTC_LOG, ("BGC mark sharing open for %d threads", participants));
+
+#ifndef MULTIPLE_HEAPS
+    bgc_mark_helpers_running_p = true;
+    bgc_mark_helpers_active = bgc_mark_helper_count;
+    for (int i = 0; i < bgc_mark_helper_count; i++)
+    {
+        bgc_mark_helper* helper = &bgc_mark_helpers[i];
+        helper->in = 0;
+        helper->current = 0;
+        helper->current_offset = 0;
+        helper->promoted_bytes = 0;
+        helper->min_overflow_address = MAX_PTR;
+        helper->max_overflow_address = 0;
+        helper->start_event.Set();
+    }
+#endif //!MULTIPLE_HEAPS
+}
+
+void gc_heap::background_mark_share_work (bgc_mark_helper* helper)
+{
+#ifdef MULTIPLE_HEAPS
+    int thread = heap_number;
+#endif //MULTIPLE_HEAPS
+
+    bgc_mark_pool_enter();
+    bgc_mark_busy_count--;
+    bgc_mark_pool_leave();
+    Interlocked::Increment (&bgc_mark_idle_count);
+
+    int spins = 0;
+    while (1)
+    {
+        bgc_mark_packet* packet = 0;
+        bool done_p = false;
+
+        if ((bgc_mark_full_count > 0) || (VolatileLoad (&bgc_mark_busy_count) == 0) || !bgc_mark_sharing_open)
+        {
+            bgc_mark_pool_enter();
+            if (!bgc_mark_sharing_open)
+            {
+                done_p = true;
+            }
+            else if (bgc_mark_full_packets)
+            {
+                packet = bgc_mark_full_packets;
+                bgc_mark_full_packets = packet->next;
+                bgc_mark_full_count--;
+                bgc_mark_busy_count++;
+            }
+            else if (bgc_mark_busy_count == 0)
+            {
+                // Nobody has anything left and nobody can publish more.
+                bgc_mark_sharing_open = false;
+                done_p = true;
+            }
+            bgc_mark_pool_leave();
+        }
+
+        if (done_p)
+            break;
+
+        if (packet)
+        {
+            Interlocked::Decrement (&bgc_mark_idle_count);
+
+#ifndef MULTIPLE_HEAPS
+            if (helper)
+            {
+                helper->in = packet;
+                bgc_mark_helper_drain (helper);
+                packet = helper->in;
+                helper->in = 0;
+            }
+            else
+#else
+            UNREFERENCED_PARAMETER(helper);
+#endif //!MULTIPLE_HEAPS
+            {
+                // What is left of the packet is scanned by the foreground GC, the object being marked
+                // is on the mark stack by the time it can run.
+                bgc_mark_taken_packet = packet;
+                while (packet->count > 0)
+                {
+                    uint8_t* o = packet->objects[--packet->count];
+                    background_mark_simple1 (o THREAD_NUMBER_ARG);
+                }
+                bgc_mark_taken_packet = 0;
+            }
+
+            bgc_mark_pool_enter();
+            packet->next = bgc_mark_free_packets;
+            bgc_mark_free_packets = packet;
+            bgc_mark_busy_count--;
+            bgc_mark_pool_leave();
+
+            Interlocked::Increment (&bgc_mark_idle_count);
+            spins = 0;
+            continue;
+        }
+
+#ifndef MULTIPLE_HEAPS
+        if (helper)
+            bgc_mark_helper_allow_fgc();
+        else
+#endif //!MULTIPLE_HEAPS
+            allow_fgc();
+
+        if (++spins < bgc_mark_idle_spin_count)
+        {
+            GCToOSInterface::YieldThread (0);
+        }
+        else
+        {
+            enable_preemptive ();
+            GCToOSInterface::Sleep (1);
+            disable_preemptive (true);
+        }
+    }
+
+    Interlocked::Decrement (&bgc_mark_idle_count);
+}
+
+void gc_heap::background_mark_scan_packet (bgc_mark_packet* packet, promote_func* fn, ScanContext* pSC)
+{
+    for (size_t i = 0; i < packet->count; i++)
+    {
+        if (packet->objects[i])
+        {
+            dprintf(3,("background packet root %Ix", (size_t)packet->objects[i]));
+            (*fn) ((Object**)&(packet->objects[i]), pSC, 0);
+        }
+    }
+}
+
+#ifndef MULTIPLE_HEAPS
+void gc_heap::create_bgc_mark_helpers()
+{
+    bgc_mark_helpers_created_p = true;
+
+    int count = (int)GCConfig::GetBGCMarkHelpers();
+    count = min (count, (int)GCToOSInterface::GetCurrentProcessCpuCount() - 1);
+    if (!bgc_mark_sharing_p || (count <= 0))
+        return;
+
+    bgc_mark_helpers = new (nothrow) bgc_mark_helper[count];
+    if (!bgc_mark_helpers)
+        return;
+
+    for (int i = 0; i < count; i++)
+    {
+        bgc_mark_helper* helper = &bgc_mark_helpers[i];
+        helper->in = 0;
+        helper->out = 0;
+        helper->current = 0;
+        if (!helper->start_event.CreateAutoEventNoThrow (FALSE))
+            break;
+
+        // The helpers wait for the next BGC forever, they don't time out like the BGC thread does.
+        if (!GCToEEInterface::CreateThread (bgc_mark_helper_stub, helper, true, ".NET BGC Mark Helper"))
+        {
+            helper->start_event.CloseEvent();
+            break;
+        }
+
+        bgc_mark_helper_count++;
+    }
+
+    dprintf (GTC_LOG, ("created %d BGC mark helpers", bgc_mark_helper_count));
+}
+
+void gc_heap::bgc_mark_helper_stub (void* arg)
+{
+    bgc_mark_helper_function ((bgc_mark_helper*)arg);
+}
+
+void gc_heap::bgc_mark_helper_function (bgc_mark_helper* helper)
+{
+    while (1)
+    {
+        enable_preemptive ();
+        helper->start_event.Wait (INFINITE, FALSE);
+        disable_preemptive (true);
+
+        background_mark_share_work (helper);
+
+        enable_preemptive ();
+        Interlocked::Decrement (&bgc_mark_helpers_active);
+    }
+}
+
+void gc_heap::bgc_mark_helper_allow_fgc()
+{
+    if (g_fSuspensionPending > 0)
+    {
+        if (GCToEEInterface::EnablePreemptiveGC())
+        {
+            GCToEEInterface::DisablePreemptiveGC();
+        }
+    }
+}
+
+void gc_heap::bgc_mark_helper_push (bgc_mark_helper* helper, uint8_t* o)
+{
+    bgc_mark_packet* out = helper->out;
+    if (out &&
+        ((out->count == BGC_MARK_PACKET_LENGTH) ||
+         ((out->count >= (BGC_MARK_PACKET_LENGTH / 4)) && (bgc_mark_idle_count > bgc_mark_full_count))))
+    {
+        bgc_mark_push_packet (out);
+        out = 0;
+    }
+
+    if (!out)
+    {
+        out = bgc_mark_get_free_packet();
+        helper->out = out;
+    }
+
+    if (out)
+    {
+        out->objects[out->count++] = o;
+    }
+    else
+    {
+        dprintf (3,("mark helper overflow for object %Ix ", (size_t)o));
+        helper->min_overflow_address = min (helper->min_overflow_address, o);
+        helper->max_overflow_address = max (helper->max_overflow_address, o);
+    }
+}
+
+// Marks the references of the objects in helper->in, and of the objects it marks, which go to helper->out.
+// Unlike the BGC thread the helpers go through large objects in one place, which they record in the helper,
+// and objects that two of them mark at the same time are gone through twice.
+void gc_heap::bgc_mark_helper_drain (bgc_mark_helper* helper)
+{
+    while (1)
+    {
+        bgc_mark_packet* in = helper->in;
+        if (in->count == 0)
+        {
+            bgc_mark_packet* out = helper->out;
+            if (!out || (out->count == 0))
+                break;
+
+            helper->in = out;
+            helper->out = in;
+            continue;
+        }
+
+        uint8_t* oo = in->objects[--in->count];
+        helper->current = oo;
+        helper->current_offset = 0;
+
+#ifdef COLLECTIBLE_CLASS
+        if (is_collectible (oo))
+        {
+            uint8_t* class_obj = get_class_object (oo);
+            if (background_mark (class_obj,
+                                 background_saved_lowest_address,
+                                 background_saved_highest_address))
+            {
+                helper->promoted_bytes += size (class_obj);
+                bgc_mark_helper_push (helper, class_obj);
+            }
+        }
+#endif //COLLECTIBLE_CLASS
+
+        if (contain_pointers (oo))
+        {
+            while (1)
+            {
+                oo = helper->current;
+                uint8_t* start = oo + helper->current_offset;
+                size_t s = size (oo);
+                int num_processed_refs = num_partial_refs * 16;
+                bool more_to_do_p = false;
+
+                go_through_object (method_table(oo), oo, s, ppslot,
+                                   start, use_start, (oo + s),
+                {
+                    uint8_t* o = *ppslot;
+                    Prefetch(o);
+                    if (background_mark (o,
+                                         background_saved_lowest_address,
+                                         background_saved_highest_address))
+                    {
+                        helper->promoted_bytes += size (o);
+                        if (contain_pointers_or_collectible (o))
+                        {
+                            bgc_mark_helper_push (helper, o);
+                        }
+                    }
+                    if (--num_processed_refs == 0)
+                    {
+                        // give foreground GC a chance to run
+                        helper->current_offset = (uint8_t*)(ppslot + 1) - oo;
+                        more_to_do_p = true;
+                        goto more_to_do;
+                    }
+                }
+                    );
+            more_to_do:
+                if (!more_to_do_p)
+                    break;
+
+                bgc_mark_helper_allow_fgc();
+            }
+        }
+
+        helper->current = 0;
+        bgc_mark_helper_allow_fgc();
+    }
+}
+
+// Waits for the helpers to stop marking, and adds what they promoted and overflowed to the BGC thread's.
+void gc_heap::bgc_mark_wait_for_helpers()
+{
+    while (bgc_mark_helpers_active > 0)
+    {
+        allow_fgc();
+        GCToOSInterface::YieldThread (0);
+    }
+
+    bgc_mark_helpers_running_p = false;
+
+    for (int i = 0; i < bgc_mark_helper_count; i++)
+    {
+        bgc_mark_helper* helper = &bgc_mark_helpers[i];
+        assert (helper->current == 0);
+        bpromoted_bytes (0) += helper->promoted_bytes;
+        background_min_overflow_address = min (background_min_overflow_address, helper->min_overflow_address);
+        background_max_overflow_address = max (background_max_overflow_address, helper->max_overflow_address);
+        if (helper->out)
+        {
+            assert (helper->out->count == 0);
+            bgc_mark_free_packet (helper->out);
+            helper->out = 0;
+        }
+    }
+}
+#endif //!MULTIPLE_HEAPS
+
 //this version is different than the foreground GC because
 //it can't keep pointers to the inside of an object
 //while calling background_mark_simple1. The object could be moved
@@ -19018,6 +20477,8 @@ gc_heap::background_mark_simple (uint8_t* o THREAD_NUMBER_DCL)
             //m_boundary (o);
             size_t s = size (o);
             bpromoted_bytes (thread) += s;
+            if (type_stats_p)
+                record_type_stats (o, s THREAD_NUMBER_ARG);
 
             if (contain_pointers_or_collectible (o))
             {
@@ -19178,6 +20639,42 @@ gc_heap::scan_background_roots (promote_func* fn, int hn, ScanContext *pSC)
         (*fn) ((Object**)finger, pSC, 0);
         finger++;
     }
+
+    //scan the work shared between the BGC threads
+    dprintf (3, ("Scanning background mark packets"));
+
+    if (bgc_mark_taken_packet)
+    {
+        background_mark_scan_packet (bgc_mark_taken_packet, fn, pSC);
+    }
+
+    if (hn == 0)
+    {
+        for (bgc_mark_packet* packet = bgc_mark_full_packets; packet; packet = packet->next)
+        {
+            background_mark_scan_packet (packet, fn, pSC);
+        }
+
+#ifndef MULTIPLE_HEAPS
+        if (bgc_mark_helpers_running_p)
+        {
+            for (int i = 0; i < bgc_mark_helper_count; i++)
+            {
+                bgc_mark_helper* helper = &bgc_mark_helpers[i];
+                if (helper->in)
+                    background_mark_scan_packet (helper->in, fn, pSC);
+                if (helper->out)
+                    background_mark_scan_packet (helper->out, fn, pSC);
+                if (helper->current)
+                {
+                    // current_offset stays right when the object is relocated
+                    dprintf(3,("background helper root %Ix", (size_t)helper->current));
+                    (*fn) ((Object**)&(helper->current), pSC, 0);
+                }
+            }
+        }
+#endif //!MULTIPLE_HEAPS
+    }
 }
 
 uint8_t* gc_heap::background_seg_end (heap_segment* seg, BOOL concurrent_p)
@@ -19570,6 +21067,36 @@ size_t gc_heap::get_total_gen_estimated_reclaim (int gen_number)
     return total_estimated_reclaim;
 }
 
+float gc_heap::conserve_mem_frag_limit()
+{
+    return (float)(10 - conserve_mem_setting) / 10.0f;
+}
+
+bool gc_heap::conserve_mem_frag_exceeded_p (int gen_number)
+{
+    size_t total_size = 0;
+    size_t total_fragmentation = 0;
+
+#ifdef MULTIPLE_HEAPS
+    for (int hn = 0; hn < gc_heap::n_heaps; hn++)
+    {
+        gc_heap* hp = gc_heap::g_heaps[hn];
+#else //MULTIPLE_HEAPS
+    {
+        gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+        generation* gen = hp->generation_of (gen_number);
+        total_size += hp->generation_size (gen_number);
+        total_fragmentation += (generation_free_list_space (gen) + generation_free_obj_space (gen));
+    }
+
+    dprintf (GTC_LOG, ("g%d size %Id frag %Id (%d%%), limit %d%%", gen_number, total_size, total_fragmentation,
+        (total_size ? (int)((float)total_fragmentation * 100 / total_size) : 0), (int)(conserve_mem_frag_limit() * 100)));
+
+    return ((total_size >= conserve_mem_min_gen_size) &&
+            ((float)total_fragmentation > (conserve_mem_frag_limit() * total_size)));
+}
+
 size_t gc_heap::committed_size()
 {
     size_t total_committed = 0;
@@ -19639,12 +21166,90 @@ void fire_mark_event (int heap_num, int root_type, size_t bytes_marked)
     FIRE_EVENT(GCMarkWithType, heap_num, root_type, bytes_marked);
 }
 
+// The object is marked but its references aren't, it goes in a chunk unless that takes more than the budget.
+void gc_heap::record_mark_overflow (uint8_t* o)
+{
+    mark_overflow_chunk* chunk = mark_overflow_chunks;
+    if ((chunk == 0) || (chunk->count == MARK_OVERFLOW_CHUNK_LENGTH))
+    {
+        chunk = 0;
+        if ((mark_overflow_chunks_size + sizeof (mark_overflow_chunk)) <= MARK_OVERFLOW_BUDGET)
+        {
+            chunk = new (nothrow) mark_overflow_chunk;
+        }
+
+        if (chunk == 0)
+        {
+            min_overflow_address = min (min_overflow_address, o);
+            max_overflow_address = max (max_overflow_address, o);
+            return;
+        }
+
+        mark_overflow_chunks_size += sizeof (mark_overflow_chunk);
+        chunk->count = 0;
+        chunk->next = mark_overflow_chunks;
+        mark_overflow_chunks = chunk;
+    }
+
+    chunk->objects[chunk->count++] = o;
+}
+
+// Marks through the objects of the overflow chunks, including the ones that overflow again while doing that.
+// Returns TRUE if there were any.
+BOOL gc_heap::process_mark_overflow_chunks()
+{
+#ifdef MULTIPLE_HEAPS
+    int thread = heap_number;
+#endif //MULTIPLE_HEAPS
+
+    if (mark_overflow_chunks == 0)
+        return FALSE;
+
+    dprintf (3, ("Processing mark overflow chunks (%Id bytes)", mark_overflow_chunks_size));
+
+    while (mark_overflow_chunks != 0)
+    {
+        mark_overflow_chunk* chunk = mark_overflow_chunks;
+        if (chunk->count == 0)
+        {
+            mark_overflow_chunks = chunk->next;
+            mark_overflow_chunks_size -= sizeof (mark_overflow_chunk);
+            delete chunk;
+            continue;
+        }
+
+        // Marking through the object can add to this chunk, or push a new one in front of it.
+        uint8_t* o = chunk->objects[--chunk->count];
+        mark_through_object (o, TRUE THREAD_NUMBER_ARG);
+    }
+
+    assert (mark_overflow_chunks_size == 0);
+    return TRUE;
+}
+
+void gc_heap::release_mark_overflow_chunks()
+{
+    while (mark_overflow_chunks != 0)
+    {
+        mark_overflow_chunk* chunk = mark_overflow_chunks;
+        mark_overflow_chunks = chunk->next;
+        delete chunk;
+    }
+
+    mark_overflow_chunks_size = 0;
+}
+
 //returns TRUE is an overflow happened.
 BOOL gc_heap::process_mark_overflow(int condemned_gen_number)
 {
     size_t last_promoted_bytes = promoted_bytes (heap_number);
     BOOL  overflow_p = FALSE;
 recheck:
+    if (process_mark_overflow_chunks())
+    {
+        overflow_p = TRUE;
+    }
+
     if ((! (max_overflow_address == 0) ||
          ! (min_overflow_address == MAX_PTR)))
     {
@@ -19923,6 +21528,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
     sc.concurrent = FALSE;
 
     dprintf(2,("---- Mark Phase condemning %d ----", condemned_gen_number));
+    RECORD_PAUSE_PHASE (gc_pause_phase_init);
     BOOL  full_p = (condemned_gen_number == max_generation);
 
     int gen_to_init = condemned_gen_number;
@@ -19995,6 +21601,8 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
 
         num_sizedrefs = GCToEEInterface::GetTotalNumSizedRefHandles();
 
+        type_stats_in_mark_p = type_stats_p && (condemned_gen_number == max_generation);
+
 #ifdef MULTIPLE_HEAPS
 
 #ifdef MH_SC_MARK
@@ -20050,6 +21658,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
             GCScan::GcScanSizedRefs(GCHeap::Promote, condemned_gen_number, max_generation, &sc);
             fire_mark_event (heap_number, ETW::GC_ROOT_SIZEDREF, (promoted_bytes (heap_number) - last_promoted_bytes));
             last_promoted_bytes = promoted_bytes (heap_number);
+            RECORD_PAUSE_PHASE (gc_pause_phase_mark_handles);
 
 #ifdef MULTIPLE_HEAPS
             gc_t_join.join(this, gc_join_scan_sizedref_done);
@@ -20069,6 +21678,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
 
         fire_mark_event (heap_number, ETW::GC_ROOT_STACK, (promoted_bytes (heap_number) - last_promoted_bytes));
         last_promoted_bytes = promoted_bytes (heap_number);
+        RECORD_PAUSE_PHASE (gc_pause_phase_mark_stack);
 
 #ifdef BACKGROUND_GC
         if (gc_heap::background_running_p())
@@ -20084,6 +21694,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
 
         fire_mark_event (heap_number, ETW::GC_ROOT_FQ, (promoted_bytes (heap_number) - last_promoted_bytes));
         last_promoted_bytes = promoted_bytes (heap_number);
+        RECORD_PAUSE_PHASE (gc_pause_phase_mark_finalization);
 
 // MTHTS
         {
@@ -20094,6 +21705,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
                                       &sc);
             fire_mark_event (heap_number, ETW::GC_ROOT_HANDLES, (promoted_bytes (heap_number) - last_promoted_bytes));
             last_promoted_bytes = promoted_bytes (heap_number);
+            RECORD_PAUSE_PHASE (gc_pause_phase_mark_handles);
         }
 
 #ifdef TRACE_GC
@@ -20199,6 +21811,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
                 (promoted_bytes (heap_number) - promoted_before_cards)));
             fire_mark_event (heap_number, ETW::GC_ROOT_OLDER, (promoted_bytes (heap_number) - last_promoted_bytes));
             last_promoted_bytes = promoted_bytes (heap_number);
+            RECORD_PAUSE_PHASE (gc_pause_phase_mark_cards);
         }
     }
 
@@ -20218,6 +21831,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
     // handle table has been fully promoted.
     GCScan::GcDhInitialScan(GCHeap::Promote, condemned_gen_number, max_generation, &sc);
     scan_dependent_handles(condemned_gen_number, &sc, true);
+    RECORD_PAUSE_PHASE (gc_pause_phase_mark_handles);
 
 #ifdef MULTIPLE_HEAPS
     dprintf(3, ("Joining for short weak handle scan"));
@@ -20274,6 +21888,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
     // Scan dependent handles again to promote any secondaries associated with primaries that were promoted
     // for finalization. As before scan_dependent_handles will also process any mark stack overflow.
     scan_dependent_handles(condemned_gen_number, &sc, false);
+    RECORD_PAUSE_PHASE (gc_pause_phase_mark_finalization);
 
 #ifdef MULTIPLE_HEAPS
     dprintf(3, ("Joining for weak pointer deletion"));
@@ -20306,6 +21921,12 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
         // scan for deleted entries in the syncblk cache
         GCScan::GcWeakPtrScanBySingleThread (condemned_gen_number, max_generation, &sc);
 
+        if (type_stats_in_mark_p)
+        {
+            publish_type_stats();
+            type_stats_in_mark_p = false;
+        }
+
 #ifdef MULTIPLE_HEAPS
 #if defined(MARK_LIST) && !defined(PARALLEL_MARK_LIST_SORT)
         //compact g_mark_list and sort it.
@@ -20438,6 +22059,7 @@ void gc_heap::mark_phase (int condemned_gen_number, BOOL mark_only_p)
 
     promoted_bytes (heap_number) -= promoted_bytes_live;
 
+    RECORD_PAUSE_PHASE (gc_pause_phase_mark_handles);
     dprintf(2,("---- End of mark phase ----"));
 }
 
@@ -20481,6 +22103,7 @@ void gc_heap::reset_mark_stack ()
     reset_pinned_queue();
     max_overflow_address = 0;
     min_overflow_address = MAX_PTR;
+    release_mark_overflow_chunks();
 }
 
 #ifdef FEATURE_STRUCTALIGN
@@ -22180,6 +23803,9 @@ void gc_heap::plan_phase (int condemned_gen_number)
     }
 
     BOOL fire_pinned_plug_events_p = EVENT_ENABLED(PinPlugAtGCTime);
+#ifdef FEATURE_EVENT_TRACE
+    GCPinPlugEventBuffer pinned_plug_events;
+#endif //FEATURE_EVENT_TRACE
     size_t last_plug_len = 0;
 
     while (1)
@@ -22470,11 +24096,16 @@ void gc_heap::plan_phase (int condemned_gen_number)
 
             if (pinned_plug_p)
             {
+#ifdef FEATURE_EVENT_TRACE
                 if (fire_pinned_plug_events_p)
                 {
-                    FIRE_EVENT(PinPlugAtGCTime, plug_start, plug_end,
-                               (merge_with_last_pin_p ? 0 : (uint8_t*)node_gap_size (plug_start)));
+                    GCPinPlugEventData plug_event;
+                    plug_event.plugStart = plug_start;
+                    plug_event.plugEnd = plug_end;
+                    plug_event.gapBeforeSize = (merge_with_last_pin_p ? 0 : (uint8_t*)node_gap_size (plug_start));
+                    pinned_plug_events.Add (plug_event);
                 }
+#endif //FEATURE_EVENT_TRACE
 
                 if (merge_with_last_pin_p)
                 {
@@ -22624,6 +24255,10 @@ void gc_heap::plan_phase (int condemned_gen_number)
         }
     }
 
+#ifdef FEATURE_EVENT_TRACE
+    pinned_plug_events.Flush();
+#endif //FEATURE_EVENT_TRACE
+
     while (!pinned_plug_que_empty_p())
     {
         if (settings.promotion)
@@ -22891,7 +24526,11 @@ void gc_heap::plan_phase (int condemned_gen_number)
                 }
             }
         }
+#endif //FEATURE_LOH_COMPACTION
+
+        RECORD_PAUSE_PHASE (gc_pause_phase_plan);
 
+#ifdef FEATURE_LOH_COMPACTION
         if (!loh_compacted_p)
 #endif //FEATURE_LOH_COMPACTION
         {
@@ -22901,6 +24540,7 @@ void gc_heap::plan_phase (int condemned_gen_number)
 
         GCToEEInterface::DiagWalkUOHSurvivors(__this, poh_generation);
         sweep_uoh_objects (poh_generation);
+        RECORD_PAUSE_PHASE (gc_pause_phase_sweep);
     }
     else
     {
@@ -23143,9 +24783,12 @@ void gc_heap::plan_phase (int condemned_gen_number)
 
         GCToEEInterface::DiagWalkSurvivors(__this, true);
 
+        RECORD_PAUSE_PHASE (gc_pause_phase_plan);
         relocate_phase (condemned_gen_number, first_condemned_address);
+        RECORD_PAUSE_PHASE (gc_pause_phase_relocate);
         compact_phase (condemned_gen_number, first_condemned_address,
                        (!settings.demotion && settings.promotion));
+        RECORD_PAUSE_PHASE (gc_pause_phase_compact);
         fix_generation_bounds (condemned_gen_number, consing_gen);
         assert (generation_allocation_limit (youngest_generation) ==
                 generation_allocation_pointer (youngest_generation));
@@ -23354,7 +24997,9 @@ void gc_heap::plan_phase (int condemned_gen_number)
         GCToEEInterface::DiagWalkSurvivors(__this, false);
 
         gen0_big_free_spaces = 0;
+        RECORD_PAUSE_PHASE (gc_pause_phase_plan);
         make_free_lists (condemned_gen_number);
+        RECORD_PAUSE_PHASE (gc_pause_phase_sweep);
         recover_saved_pinned_info();
 
 #ifdef FEATURE_PREMORTEM_FINALIZATION
@@ -23739,7 +25384,7 @@ void gc_heap::thread_gap (uint8_t* gap_start, size_t size, generation*  gen)
         assert (size >= Align (min_obj_size));
         make_unused_array (gap_start, size,
                           (!settings.concurrent && (gen != youngest_generation)),
-                          (gen->gen_num == max_generation));
+                          (release_free_space_p ? (gen->gen_num >= max_generation) : (gen->gen_num == max_generation)));
         dprintf (3, ("fr: [%Ix, %Ix[", (size_t)gap_start, (size_t)gap_start+size));
 
         if ((size >= min_free_list))
@@ -25634,6 +27279,74 @@ void gc_heap::allow_fgc()
             GCToEEInterface::DisablePreemptiveGC();
         }
     }
+
+    if (bgc_pace_enabled_p)
+    {
+        bgc_pace_for_cpu_quota();
+    }
+}
+
+void gc_heap::bgc_pace_for_cpu_quota()
+{
+    if ((++bgc_pace_call_count % bgc_pace_check_interval) != 0)
+        return;
+
+    size_t now = GetHighPrecisionTimeStamp();
+    if (bgc_pace_slice_start == 0)
+    {
+        bgc_pace_slice_start = now;
+        return;
+    }
+
+    size_t worked = now - bgc_pace_slice_start;
+    if (worked < bgc_pace_slice_ms)
+        return;
+
+    if (Interlocked::CompareExchange (&bgc_pace_sampling, 1, 0) == 0)
+    {
+        uint64_t throttled_time = 0;
+        if (((now - bgc_pace_last_sample_time) >= bgc_pace_slice_ms) &&
+            GCToOSInterface::GetCpuThrottledTime (&throttled_time))
+        {
+            // The first sample of a BGC is only a baseline
+            if (bgc_pace_last_sample_time != 0)
+            {
+                uint32_t duty_cycle = bgc_pace_duty_cycle;
+                if (throttled_time > bgc_pace_last_throttled_time)
+                    duty_cycle = max (duty_cycle / 2, bgc_pace_min_duty_cycle);
+                else
+                    duty_cycle = min (duty_cycle + bgc_pace_duty_cycle_step, (uint32_t)100);
+
+                if (duty_cycle != bgc_pace_duty_cycle)
+                {
+                    dprintf (2, ("h%d: bgc duty cycle %d%% -> %d%%, throttled %I64dus",
+                        heap_number, (uint32_t)bgc_pace_duty_cycle, duty_cycle,
+                        (throttled_time - bgc_pace_last_throttled_time)));
+                    bgc_pace_duty_cycle = duty_cycle;
+                }
+            }
+            bgc_pace_last_sample_time = now;
+            bgc_pace_last_throttled_time = throttled_time;
+        }
+        bgc_pace_sampling = 0;
+    }
+
+    uint32_t duty_cycle = bgc_pace_duty_cycle;
+    if (duty_cycle < 100)
+    {
+        uint32_t sleep_ms = (uint32_t)(worked * (100 - duty_cycle) / duty_cycle);
+
+        // A foreground GC may be waiting for this thread, it must not be held up by the sleep
+        bool bToggleGC = GCToEEInterface::EnablePreemptiveGC();
+        GCToOSInterface::Sleep (sleep_ms);
+        if (bToggleGC)
+        {
+            GCToEEInterface::DisablePreemptiveGC();
+        }
+        now = GetHighPrecisionTimeStamp();
+    }
+
+    bgc_pace_slice_start = now;
 }
 
 BOOL gc_heap::should_commit_mark_array()
@@ -26050,6 +27763,8 @@ void gc_heap::background_mark_phase ()
     background_soh_alloc_count = 0;
     background_uoh_alloc_count = 0;
     bgc_overflow_count = 0;
+    bgc_pace_slice_start = 0;
+    bgc_pace_last_sample_time = 0;
 
     bpromoted_bytes (heap_number) = 0;
     static uint32_t num_sizedrefs = 0;
@@ -26208,6 +27923,8 @@ void gc_heap::background_mark_phase ()
             current_bgc_state = bgc_mark_handles;
 #endif //MULTIPLE_HEAPS
 
+            background_mark_open_sharing();
+
             current_c_gc_state = c_gc_state_marking;
 
             enable_preemptive ();
@@ -26253,13 +27970,43 @@ void gc_heap::background_mark_phase ()
 
         dprintf (2,("concurrent revisiting dirtied pages"));
 
-        // tuning has shown that there are advantages in doing this 2 times
-        revisit_written_pages (TRUE);
+        // tuning has shown that there are advantages in doing this 2 times. Write heavy heaps keep dirtying
+        // pages faster than two rounds catch up with, and whatever is left is revisited while the EE is
+        // suspended, so we keep going while the rounds still find more than the target and shrink.
         revisit_written_pages (TRUE);
+        size_t dirtied_pages = revisit_written_pages (TRUE);
+
+        size_t revisit_target_pages = (size_t)GCConfig::GetBGCRevisitTargetPages();
+        if (revisit_target_pages != 0)
+        {
+            for (int round = 2; (round < BGC_MAX_REVISIT_ROUNDS) && (dirtied_pages > revisit_target_pages); round++)
+            {
+                size_t last_dirtied_pages = dirtied_pages;
+                dirtied_pages = revisit_written_pages (TRUE);
+                dprintf (GTC_LOG, ("h%d: revisit round %d: %Id pages", heap_number, round, dirtied_pages));
+
+                if (dirtied_pages >= last_dirtied_pages)
+                    break;
+            }
+        }
 
         //concurrent_print_time_delta ("concurrent marking dirtied pages on LOH");
         concurrent_print_time_delta ("CRre");
 
+        // Threads that are done help the ones that aren't, what overflowed is still processed by each heap.
+        if (bgc_mark_sharing_open)
+        {
+            background_mark_share_work (0);
+            concurrent_print_time_delta ("CRsh");
+        }
+
+#ifndef MULTIPLE_HEAPS
+        if (bgc_mark_helpers_running_p)
+        {
+            bgc_mark_wait_for_helpers();
+        }
+#endif //!MULTIPLE_HEAPS
+
         enable_preemptive ();
 
 #ifdef MULTIPLE_HEAPS
@@ -26511,6 +28258,11 @@ void gc_heap::background_mark_phase ()
         // scan for deleted entries in the syncblk cache
         GCScan::GcWeakPtrScanBySingleThread (max_generation, max_generation, &sc);
         concurrent_print_time_delta ("NR GcWeakPtrScanBySingleThread");
+
+        if (type_stats_p)
+        {
+            publish_type_stats();
+        }
 #ifdef MULTIPLE_HEAPS
         dprintf(2, ("Starting BGC threads for end of background mark phase"));
         bgc_t_join.restart();
@@ -26814,13 +28566,15 @@ end_limit:
 // When reset_only_p is TRUE, we should only reset pages that are in range
 // because we need to consider the segments or part of segments that were
 // allocated out of range all live.
-void gc_heap::revisit_written_pages (BOOL concurrent_p, BOOL reset_only_p)
+// Returns the number of written pages found on all the segments.
+size_t gc_heap::revisit_written_pages (BOOL concurrent_p, BOOL reset_only_p)
 {
     if (concurrent_p && !reset_only_p)
     {
         current_bgc_state = bgc_revisit_soh;
     }
 
+    size_t all_dirtied_pages = 0;
     size_t total_dirtied_pages = 0;
     size_t total_marked_objects = 0;
 
@@ -26914,6 +28668,7 @@ void gc_heap::revisit_written_pages (BOOL concurrent_p, BOOL reset_only_p)
                         if (bcount != 0)
                         {
                             total_dirtied_pages += bcount;
+                            all_dirtied_pages += bcount;
 
                             dprintf (3, ("Found %d pages [%Ix, %Ix[", 
                                             bcount, (size_t)base_address, (size_t)high_address));
@@ -26989,6 +28744,8 @@ void gc_heap::revisit_written_pages (BOOL concurrent_p, BOOL reset_only_p)
             }
         }
     }
+
+    return all_dirtied_pages;
 }
 
 void gc_heap::background_grow_c_mark_list()
@@ -28857,20 +30614,25 @@ BOOL gc_heap::find_card_dword (size_t& cardw, size_t cardw_end)
         size_t end_cardb = cardw_card_bundle (align_cardw_on_bundle (cardw_end));
         while (1)
         {
-            // Find a non-zero bundle
-            while ((cardb < end_cardb) && (card_bundle_set_p (cardb) == 0))
+            // Find a non-zero bundle, skipping a whole bundle word at a time when it is clear
+            while (cardb < end_cardb)
             {
-                cardb++;
+                uint32_t bundle_bits = card_bundle_table[card_bundle_word (cardb)] >> card_bundle_bit (cardb);
+                if (bundle_bits != 0)
+                {
+                    uint32_t bit_index;
+                    BitScanForward (&bit_index, bundle_bits);
+                    cardb += bit_index;
+                    break;
+                }
+                cardb = (card_bundle_word (cardb) + 1) * card_bundle_word_width;
             }
-            if (cardb == end_cardb)
+            if (cardb >= end_cardb)
                 return FALSE;
 
             uint32_t* card_word = &card_table[max(card_bundle_cardw (cardb),cardw)];
             uint32_t* card_word_end = &card_table[min(card_bundle_cardw (cardb+1),cardw_end)];
-            while ((card_word < card_word_end) && !(*card_word))
-            {
-                card_word++;
-            }
+            card_word = find_nonzero_card_word (card_word, card_word_end);
 
             if (card_word != card_word_end)
             {
@@ -28896,15 +30658,11 @@ BOOL gc_heap::find_card_dword (size_t& cardw, size_t cardw_end)
         uint32_t* card_word = &card_table[cardw];
         uint32_t* card_word_end = &card_table [cardw_end];
 
-        while (card_word < card_word_end)
+        card_word = find_nonzero_card_word (card_word, card_word_end);
+        if (card_word < card_word_end)
         {
-            if ((*card_word) != 0)
-            {
-                cardw = (card_word - &card_table [0]);
-                return TRUE;
-            }
-
-            card_word++;
+            cardw = (card_word - &card_table [0]);
+            return TRUE;
         }
         return FALSE;
 
@@ -28957,12 +30715,7 @@ BOOL gc_heap::find_card(uint32_t* card_table,
 #else //CARD_BUNDLE
         // Go through the remaining card words between here and card_word_end until we find
         // one that is non-zero.
-        do
-        {
-            ++last_card_word;
-        }
-
-        while ((last_card_word < &card_table [card_word_end]) && !(*last_card_word));
+        last_card_word = find_nonzero_card_word ((last_card_word + 1), &card_table [card_word_end]);
         if (last_card_word < &card_table [card_word_end])
         {
             card_word_value = *last_card_word;
@@ -28979,11 +30732,10 @@ BOOL gc_heap::find_card(uint32_t* card_table,
     // Look for the lowest bit set
     if (card_word_value)
     {
-        while (!(card_word_value & 1))
-        {
-            bit_position++;
-            card_word_value = card_word_value / 2;
-        }
+        uint32_t lowest_bit_index;
+        BitScanForward (&lowest_bit_index, card_word_value);
+        bit_position += lowest_bit_index;
+        card_word_value >>= lowest_bit_index;
     }
 
     // card is the card word index * card size + the bit index within the card
@@ -31125,6 +32877,12 @@ void gc_heap::init_static_data()
         gen0_max_size = min (gen0_max_size, gen0_max_size_seg);
     }
 
+    if (conserve_mem_setting != 0)
+    {
+        // A budget much bigger than the cache mostly adds dead objects to the footprint between GCs.
+        gen0_max_size = min (gen0_max_size, max (gen0_min_size, (size_t)(6*1024*1024)));
+    }
+
     size_t gen0_max_size_config = (size_t)GCConfig::GetGCGen0MaxBudget();
 
     if (gen0_max_size_config)
@@ -31370,6 +33128,12 @@ size_t gc_heap::desired_new_allocation (dynamic_data* dd,
                                           max (min_gc_size, (max_size/3)));
                 }
             }
+
+            if (pause_target_us != 0)
+            {
+                size_t scaled_allocation = (size_t)(new_allocation * pause_target_budget_scale[gen_number]);
+                new_allocation = min (new_allocation, max (scaled_allocation, (size_t)pause_target_min_budget));
+            }
         }
 
         size_t new_allocation_ret = Align (new_allocation, get_alignment_constant (gen_number <= max_generation));
@@ -31934,6 +33698,14 @@ BOOL gc_heap::decide_on_compacting (int condemned_gen_number,
         should_compact = TRUE;
     }
 
+    if ((conserve_mem_setting != 0) && (condemned_gen_number == max_generation) &&
+        (fragmentation_burden > conserve_mem_frag_limit()))
+    {
+        dprintf (GTC_LOG, ("compacting to conserve memory"));
+        should_compact = TRUE;
+        get_gc_data_per_heap()->set_mechanism (gc_heap_compact, compact_high_frag);
+    }
+
     if (!should_compact)
     {
         if (dt_low_ephemeral_space_p (tuning_deciding_compaction))
@@ -32355,7 +34127,8 @@ CObjectHeader* gc_heap::allocate_uoh_object (size_t jsize, uint32_t flags, int g
 
 void reset_memory (uint8_t* o, size_t sizeo)
 {
-    if (sizeo > 128 * 1024)
+    size_t min_size = (gc_heap::release_free_space_p ? release_free_space_reset_size : reset_memory_min_size);
+    if (sizeo > min_size)
     {
         // We cannot reset the memory for the useful part of a free object.
         size_t size_to_skip = min_free_list - plug_skew;
@@ -34291,7 +36064,6 @@ gc_heap::verify_free_lists ()
     {
         dprintf (3, ("Verifying free list for gen:%d", gen_num));
         allocator* gen_alloc = generation_allocator (generation_of (gen_num));
-        size_t sz = gen_alloc->first_bucket_size();
         bool verify_undo_slot = (gen_num != 0) && (gen_num <= max_generation) && !gen_alloc->discard_if_no_fit_p();
 
         for (unsigned int a_l_number = 0; a_l_number < gen_alloc->number_of_buckets(); a_l_number++)
@@ -34306,8 +36078,7 @@ gc_heap::verify_free_lists ()
                                  (size_t)free_list));
                     FATAL_GC_ERROR();
                 }
-                if (((a_l_number < (gen_alloc->number_of_buckets()-1))&& (unused_array_size (free_list) >= sz))
-                    || ((a_l_number != 0) && (unused_array_size (free_list) < sz/2)))
+                if (gen_alloc->first_suitable_bucket (unused_array_size (free_list)) != a_l_number)
                 {
                     dprintf (3, ("Verifiying Heap: curr free list item %Ix isn't in the right bucket",
                                  (size_t)free_list));
@@ -34345,11 +36116,329 @@ gc_heap::verify_free_lists ()
                     FATAL_GC_ERROR();
                 }
             }
+        }
+    }
+}
+
+// Verifies the objects of one segment of this heap, starting with those of generation curr_gen_num. The objects
+// verified are added to the totals, that may be shared with the other segments verified by the same thread.
+void
+gc_heap::verify_heap_segment (heap_segment* seg, int curr_gen_num, int heap_verify_level,
+                              size_t* total_objects_verified_p, size_t* total_objects_verified_deep_p)
+{
+    int             align_const = get_alignment_constant (curr_gen_num == max_generation);
+    BOOL            large_brick_p = (curr_gen_num != max_generation);
+
+    size_t          total_objects_verified = 0;
+    size_t          total_objects_verified_deep = 0;
+
+    BOOL            bCurrentBrickInvalid = FALSE;
+    size_t          last_valid_brick = 0;
+    size_t          curr_brick = 0;
+    size_t          prev_brick = (size_t)-1;
+    uint8_t*        begin_youngest = generation_allocation_start(generation_of(0));
+    uint8_t*        next_boundary = generation_allocation_start (generation_of (max_generation - 1));
+
+    uint8_t*        curr_object = heap_segment_mem (seg);
+    uint8_t*        prev_object = 0;
+
+#ifdef BACKGROUND_GC
+    BOOL consider_bgc_mark_p    = FALSE;
+    BOOL check_current_sweep_p  = FALSE;
+    BOOL check_saved_sweep_p    = FALSE;
+    should_check_bgc_mark (seg, &consider_bgc_mark_p, &check_current_sweep_p, &check_saved_sweep_p);
+#endif //BACKGROUND_GC
+
+    while (curr_object < heap_segment_allocated (seg))
+    {
+         //if (is_mark_set (curr_object))
+         //{
+         //        printf ("curr_object: %Ix is marked!",(size_t)curr_object);
+         //        FATAL_GC_ERROR();
+         //}
+
+        size_t s = size (curr_object);
+        dprintf (3, ("o: %Ix, s: %d", (size_t)curr_object, s));
+        if (s == 0)
+        {
+            dprintf (3, ("Verifying Heap: size of current object %Ix == 0", curr_object));
+            FATAL_GC_ERROR();
+        }
+
+        // handle generation boundaries within ephemeral segment
+        if (seg == ephemeral_heap_segment)
+        {
+            if ((curr_gen_num > 0) && (curr_object >= next_boundary))
+            {
+                curr_gen_num--;
+                if (curr_gen_num > 0)
+                {
+                    next_boundary = generation_allocation_start (generation_of (curr_gen_num - 1));
+                }
+            }
+        }
+
+        // If object is not in the youngest generation, then lets
+        // verify that the brick table is correct....
+        if (((seg != ephemeral_heap_segment) ||
+             (brick_of(curr_object) < brick_of(begin_youngest))))
+        {
+            curr_brick = brick_of(curr_object);
+
+            // Brick Table Verification...
+            //
+            // On brick transition
+            //     if brick is negative
+            //          verify that brick indirects to previous valid brick
+            //     else
+            //          set current brick invalid flag to be flipped if we
+            //          encounter an object at the correct place
+            //
+            if (curr_brick != prev_brick)
+            {
+                // If the last brick we were examining had positive
+                // entry but we never found the matching object, then
+                // we have a problem
+                // If prev_brick was the last one of the segment
+                // it's ok for it to be invalid because it is never looked at
+                if (bCurrentBrickInvalid &&
+                    (curr_brick != brick_of (heap_segment_mem (seg))) &&
+                    !heap_segment_read_only_p (seg))
+                {
+                    dprintf (3, ("curr brick %Ix invalid", curr_brick));
+                    FATAL_GC_ERROR();
+                }
+
+                if (large_brick_p)
+                {
+                    //large objects verify the table only if they are in
+                    //range.
+                    if ((heap_segment_reserved (seg) <= highest_address) &&
+                        (heap_segment_mem (seg) >= lowest_address) &&
+                        brick_table [curr_brick] != 0)
+                    {
+                        dprintf (3, ("curr_brick %Ix for large object %Ix not set to -32768",
+                                curr_brick, (size_t)curr_object));
+                        FATAL_GC_ERROR();
+                    }
+                    else
+                    {
+                        bCurrentBrickInvalid = FALSE;
+                    }
+                }
+                else
+                {
+                    // If the current brick contains a negative value make sure
+                    // that the indirection terminates at the last  valid brick
+                    if (brick_table [curr_brick] <= 0)
+                    {
+                        if (brick_table [curr_brick] == 0)
+                        {
+                            dprintf(3, ("curr_brick %Ix for object %Ix set to 0",
+                                    curr_brick, (size_t)curr_object));
+                            FATAL_GC_ERROR();
+                        }
+                        ptrdiff_t i = curr_brick;
+                        while ((i >= ((ptrdiff_t) brick_of (heap_segment_mem (seg)))) &&
+                               (brick_table[i] < 0))
+                        {
+                            i = i + brick_table[i];
+                        }
+                        if (i <  ((ptrdiff_t)(brick_of (heap_segment_mem (seg))) - 1))
+                        {
+                            dprintf (3, ("ptrdiff i: %Ix < brick_of (heap_segment_mem (seg)):%Ix - 1. curr_brick: %Ix",
+                                    i, brick_of (heap_segment_mem (seg)),
+                                    curr_brick));
+                            FATAL_GC_ERROR();
+                        }
+                        // if (i != last_valid_brick)
+                        //  FATAL_GC_ERROR();
+                        bCurrentBrickInvalid = FALSE;
+                    }
+                    else if (!heap_segment_read_only_p (seg))
+                    {
+                        bCurrentBrickInvalid = TRUE;
+                    }
+                }
+            }
 
-            sz *=2;
+            if (bCurrentBrickInvalid)
+            {
+                if (curr_object == (brick_address(curr_brick) + brick_table[curr_brick] - 1))
+                {
+                    bCurrentBrickInvalid = FALSE;
+                    last_valid_brick = curr_brick;
+                }
+            }
+        }
+
+        if (*((uint8_t**)curr_object) != (uint8_t *) g_gc_pFreeObjectMethodTable)
+        {
+#ifdef FEATURE_LOH_COMPACTION
+            if ((curr_gen_num == loh_generation) && (prev_object != 0))
+            {
+                assert (method_table (prev_object) == g_gc_pFreeObjectMethodTable);
+            }
+#endif //FEATURE_LOH_COMPACTION
+
+            total_objects_verified++;
+
+            BOOL can_verify_deep = TRUE;
+#ifdef BACKGROUND_GC
+            can_verify_deep = fgc_should_consider_object (curr_object, seg, consider_bgc_mark_p, check_current_sweep_p, check_saved_sweep_p);
+#endif //BACKGROUND_GC
+
+            BOOL deep_verify_obj = can_verify_deep;
+            if ((heap_verify_level & GCConfig::HEAPVERIFY_DEEP_ON_COMPACT) && !settings.compaction)
+                deep_verify_obj = FALSE;
+
+            ((CObjectHeader*)curr_object)->ValidateHeap(deep_verify_obj);
+
+            if (can_verify_deep)
+            {
+                if (curr_gen_num > 0)
+                {
+                    BOOL need_card_p = FALSE;
+                    if (contain_pointers_or_collectible (curr_object))
+                    {
+                        dprintf (4, ("curr_object: %Ix", (size_t)curr_object));
+                        size_t crd = card_of (curr_object);
+                        BOOL found_card_p = card_set_p (crd);
+
+#ifdef COLLECTIBLE_CLASS
+                        if (is_collectible(curr_object))
+                        {
+                            uint8_t* class_obj = get_class_object (curr_object);
+                            if ((class_obj < ephemeral_high) && (class_obj >= next_boundary))
+                            {
+                                if (!found_card_p)
+                                {
+                                    dprintf (3, ("Card not set, curr_object = [%Ix:%Ix pointing to class object %Ix",
+                                                card_of (curr_object), (size_t)curr_object, class_obj));
+
+                                    FATAL_GC_ERROR();
+                                }
+                            }
+                        }
+#endif //COLLECTIBLE_CLASS
+
+                        if (contain_pointers(curr_object))
+                        {
+                            go_through_object_nostart
+                                (method_table(curr_object), curr_object, s, oo,
+                                {
+                                    if ((crd != card_of ((uint8_t*)oo)) && !found_card_p)
+                                    {
+                                        crd = card_of ((uint8_t*)oo);
+                                        found_card_p = card_set_p (crd);
+                                        need_card_p = FALSE;
+                                    }
+                                    if ((*oo < ephemeral_high) && (*oo >= next_boundary))
+                                    {
+                                        need_card_p = TRUE;
+                                    }
+
+                                if (need_card_p && !found_card_p)
+                                {
+
+                                        dprintf (3, ("Card not set, curr_object = [%Ix:%Ix, %Ix:%Ix[",
+                                                    card_of (curr_object), (size_t)curr_object,
+                                                    card_of (curr_object+Align(s, align_const)), (size_t)curr_object+Align(s, align_const)));
+                                        FATAL_GC_ERROR();
+                                    }
+                                }
+                                    );
+                        }
+                        if (need_card_p && !found_card_p)
+                        {
+                            dprintf (3, ("Card not set, curr_object = [%Ix:%Ix, %Ix:%Ix[",
+                                    card_of (curr_object), (size_t)curr_object,
+                                    card_of (curr_object+Align(s, align_const)), (size_t)curr_object+Align(s, align_const)));
+                            FATAL_GC_ERROR();
+                        }
+                    }
+                }
+                total_objects_verified_deep++;
+            }
+        }
+
+        prev_object = curr_object;
+        prev_brick = curr_brick;
+        curr_object = curr_object + Align(s, align_const);
+        if (curr_object < prev_object)
+        {
+            dprintf (3, ("overflow because of a bad object size: %Ix size %Ix", prev_object, s));
+            FATAL_GC_ERROR();
+        }
+    }
+
+    if (curr_object > heap_segment_allocated(seg))
+    {
+        dprintf (3, ("Verifiying Heap: curr_object: %Ix > heap_segment_allocated (seg: %Ix)",
+                (size_t)curr_object, (size_t)seg));
+        FATAL_GC_ERROR();
+    }
+
+    *total_objects_verified_p += total_objects_verified;
+    *total_objects_verified_deep_p += total_objects_verified_deep;
+}
+
+#ifdef MULTIPLE_HEAPS
+// Lists the segments of all heaps for the GC threads to claim in verify_heap, so that a heap with more
+// segments than the others doesn't leave their threads waiting. Called by the thread that joined last.
+void
+gc_heap::prepare_parallel_verify_heap()
+{
+    verify_segments_parallel_p = FALSE;
+
+    int count = 0;
+    for (int i = 0; i < n_heaps; i++)
+    {
+        for (int gen_num = max_generation; gen_num < total_generation_count; gen_num++)
+        {
+            heap_segment* seg = heap_segment_in_range (generation_start_segment (g_heaps[i]->generation_of (gen_num)));
+            while (seg)
+            {
+                count++;
+                seg = heap_segment_next_in_range (seg);
+            }
+        }
+    }
+
+    if (count > verify_segments_capacity)
+    {
+        delete[] verify_segments;
+        verify_segments = new (nothrow) verify_segment_entry[count];
+        verify_segments_capacity = (verify_segments != 0) ? count : 0;
+        if (verify_segments == 0)
+        {
+            // each heap then verifies its own segments
+            return;
         }
     }
+
+    int index = 0;
+    for (int i = 0; i < n_heaps; i++)
+    {
+        for (int gen_num = total_generation_count - 1; gen_num >= max_generation; gen_num--)
+        {
+            heap_segment* seg = heap_segment_in_range (generation_start_segment (g_heaps[i]->generation_of (gen_num)));
+            while (seg)
+            {
+                verify_segments[index].hp = g_heaps[i];
+                verify_segments[index].seg = seg;
+                verify_segments[index].gen_num = gen_num;
+                index++;
+                seg = heap_segment_next_in_range (seg);
+            }
+        }
+    }
+
+    verify_segments_count = count;
+    verify_segments_next = 0;
+    verify_segments_parallel_p = TRUE;
 }
+#endif //MULTIPLE_HEAPS
 
 void
 gc_heap::verify_heap (BOOL begin_gc_p)
@@ -34365,6 +36454,8 @@ gc_heap::verify_heap (BOOL begin_gc_p)
         current_join = &bgc_t_join;
     }
 #endif //BACKGROUND_GC
+    // Background GC threads verify their own heap while the program is allocating from the others
+    BOOL parallel_verify_p = (current_join == &gc_t_join);
 #endif //MULTIPLE_HEAPS
 
 #ifndef TRACE_GC
@@ -34434,6 +36525,11 @@ gc_heap::verify_heap (BOOL begin_gc_p)
             }
         }
 
+        if (parallel_verify_p)
+        {
+            prepare_parallel_verify_heap();
+        }
+
         current_join->restart();
     }
 #else
@@ -34470,264 +36566,34 @@ gc_heap::verify_heap (BOOL begin_gc_p)
     size_t          total_objects_verified = 0;
     size_t          total_objects_verified_deep = 0;
 
-    BOOL            bCurrentBrickInvalid = FALSE;
-    size_t          last_valid_brick = 0;
-    size_t          curr_brick = 0;
-    size_t          prev_brick = (size_t)-1;
-    uint8_t*        begin_youngest = generation_allocation_start(generation_of(0));
-    uint8_t*        next_boundary = generation_allocation_start (generation_of (max_generation - 1));
-
-    // go through all generations starting with the highest
-    for (int curr_gen_num = total_generation_count - 1; curr_gen_num >= max_generation; curr_gen_num--)
+#ifdef MULTIPLE_HEAPS
+    if (parallel_verify_p && verify_segments_parallel_p)
     {
-        int             align_const = get_alignment_constant (curr_gen_num == max_generation);
-        BOOL            large_brick_p = (curr_gen_num != max_generation);
-
-        heap_segment*   seg = heap_segment_in_range (generation_start_segment (generation_of (curr_gen_num) ));
-
-        while (seg)
+        // the objects of all heaps are verified by whichever GC thread claims their segment first
+        while (true)
         {
-            uint8_t*        curr_object = heap_segment_mem (seg);
-            uint8_t*        prev_object = 0;
-
-        #ifdef BACKGROUND_GC
-            BOOL consider_bgc_mark_p    = FALSE;
-            BOOL check_current_sweep_p  = FALSE;
-            BOOL check_saved_sweep_p    = FALSE;
-            should_check_bgc_mark (seg, &consider_bgc_mark_p, &check_current_sweep_p, &check_saved_sweep_p);
-        #endif //BACKGROUND_GC
-
-            while (curr_object < heap_segment_allocated (seg))
-            {
-                 //if (is_mark_set (curr_object))
-                 //{
-                 //        printf ("curr_object: %Ix is marked!",(size_t)curr_object);
-                 //        FATAL_GC_ERROR();
-                 //}
-
-                size_t s = size (curr_object);
-                dprintf (3, ("o: %Ix, s: %d", (size_t)curr_object, s));
-                if (s == 0)
-                {
-                    dprintf (3, ("Verifying Heap: size of current object %Ix == 0", curr_object));
-                    FATAL_GC_ERROR();
-                }
-
-                // handle generation boundaries within ephemeral segment
-                if (seg == ephemeral_heap_segment)
-                {
-                    if ((curr_gen_num > 0) && (curr_object >= next_boundary))
-                    {
-                        curr_gen_num--;
-                        if (curr_gen_num > 0)
-                        {
-                            next_boundary = generation_allocation_start (generation_of (curr_gen_num - 1));
-                        }
-                    }
-                }
-
-                // If object is not in the youngest generation, then lets
-                // verify that the brick table is correct....
-                if (((seg != ephemeral_heap_segment) ||
-                     (brick_of(curr_object) < brick_of(begin_youngest))))
-                {
-                    curr_brick = brick_of(curr_object);
-
-                    // Brick Table Verification...
-                    //
-                    // On brick transition
-                    //     if brick is negative
-                    //          verify that brick indirects to previous valid brick
-                    //     else
-                    //          set current brick invalid flag to be flipped if we
-                    //          encounter an object at the correct place
-                    //
-                    if (curr_brick != prev_brick)
-                    {
-                        // If the last brick we were examining had positive
-                        // entry but we never found the matching object, then
-                        // we have a problem
-                        // If prev_brick was the last one of the segment
-                        // it's ok for it to be invalid because it is never looked at
-                        if (bCurrentBrickInvalid &&
-                            (curr_brick != brick_of (heap_segment_mem (seg))) &&
-                            !heap_segment_read_only_p (seg))
-                        {
-                            dprintf (3, ("curr brick %Ix invalid", curr_brick));
-                            FATAL_GC_ERROR();
-                        }
-
-                        if (large_brick_p)
-                        {
-                            //large objects verify the table only if they are in
-                            //range.
-                            if ((heap_segment_reserved (seg) <= highest_address) &&
-                                (heap_segment_mem (seg) >= lowest_address) &&
-                                brick_table [curr_brick] != 0)
-                            {
-                                dprintf (3, ("curr_brick %Ix for large object %Ix not set to -32768",
-                                        curr_brick, (size_t)curr_object));
-                                FATAL_GC_ERROR();
-                            }
-                            else
-                            {
-                                bCurrentBrickInvalid = FALSE;
-                            }
-                        }
-                        else
-                        {
-                            // If the current brick contains a negative value make sure
-                            // that the indirection terminates at the last  valid brick
-                            if (brick_table [curr_brick] <= 0)
-                            {
-                                if (brick_table [curr_brick] == 0)
-                                {
-                                    dprintf(3, ("curr_brick %Ix for object %Ix set to 0",
-                                            curr_brick, (size_t)curr_object));
-                                    FATAL_GC_ERROR();
-                                }
-                                ptrdiff_t i = curr_brick;
-                                while ((i >= ((ptrdiff_t) brick_of (heap_segment_mem (seg)))) &&
-                                       (brick_table[i] < 0))
-                                {
-                                    i = i + brick_table[i];
-                                }
-                                if (i <  ((ptrdiff_t)(brick_of (heap_segment_mem (seg))) - 1))
-                                {
-                                    dprintf (3, ("ptrdiff i: %Ix < brick_of (heap_segment_mem (seg)):%Ix - 1. curr_brick: %Ix",
-                                            i, brick_of (heap_segment_mem (seg)),
-                                            curr_brick));
-                                    FATAL_GC_ERROR();
-                                }
-                                // if (i != last_valid_brick)
-                                //  FATAL_GC_ERROR();
-                                bCurrentBrickInvalid = FALSE;
-                            }
-                            else if (!heap_segment_read_only_p (seg))
-                            {
-                                bCurrentBrickInvalid = TRUE;
-                            }
-                        }
-                    }
-
-                    if (bCurrentBrickInvalid)
-                    {
-                        if (curr_object == (brick_address(curr_brick) + brick_table[curr_brick] - 1))
-                        {
-                            bCurrentBrickInvalid = FALSE;
-                            last_valid_brick = curr_brick;
-                        }
-                    }
-                }
-
-                if (*((uint8_t**)curr_object) != (uint8_t *) g_gc_pFreeObjectMethodTable)
-                {
-        #ifdef FEATURE_LOH_COMPACTION
-                    if ((curr_gen_num == loh_generation) && (prev_object != 0))
-                    {
-                        assert (method_table (prev_object) == g_gc_pFreeObjectMethodTable);
-                    }
-        #endif //FEATURE_LOH_COMPACTION
-
-                    total_objects_verified++;
-
-                    BOOL can_verify_deep = TRUE;
-        #ifdef BACKGROUND_GC
-                    can_verify_deep = fgc_should_consider_object (curr_object, seg, consider_bgc_mark_p, check_current_sweep_p, check_saved_sweep_p);
-        #endif //BACKGROUND_GC
-
-                    BOOL deep_verify_obj = can_verify_deep;
-                    if ((heap_verify_level & GCConfig::HEAPVERIFY_DEEP_ON_COMPACT) && !settings.compaction)
-                        deep_verify_obj = FALSE;
-
-                    ((CObjectHeader*)curr_object)->ValidateHeap(deep_verify_obj);
-
-                    if (can_verify_deep)
-                    {
-                        if (curr_gen_num > 0)
-                        {
-                            BOOL need_card_p = FALSE;
-                            if (contain_pointers_or_collectible (curr_object))
-                            {
-                                dprintf (4, ("curr_object: %Ix", (size_t)curr_object));
-                                size_t crd = card_of (curr_object);
-                                BOOL found_card_p = card_set_p (crd);
-
-        #ifdef COLLECTIBLE_CLASS
-                                if (is_collectible(curr_object))
-                                {
-                                    uint8_t* class_obj = get_class_object (curr_object);
-                                    if ((class_obj < ephemeral_high) && (class_obj >= next_boundary))
-                                    {
-                                        if (!found_card_p)
-                                        {
-                                            dprintf (3, ("Card not set, curr_object = [%Ix:%Ix pointing to class object %Ix",
-                                                        card_of (curr_object), (size_t)curr_object, class_obj));
-
-                                            FATAL_GC_ERROR();
-                                        }
-                                    }
-                                }
-        #endif //COLLECTIBLE_CLASS
-
-                                if (contain_pointers(curr_object))
-                                {
-                                    go_through_object_nostart
-                                        (method_table(curr_object), curr_object, s, oo,
-                                        {
-                                            if ((crd != card_of ((uint8_t*)oo)) && !found_card_p)
-                                            {
-                                                crd = card_of ((uint8_t*)oo);
-                                                found_card_p = card_set_p (crd);
-                                                need_card_p = FALSE;
-                                            }
-                                            if ((*oo < ephemeral_high) && (*oo >= next_boundary))
-                                            {
-                                                need_card_p = TRUE;
-                                            }
-
-                                        if (need_card_p && !found_card_p)
-                                        {
-
-                                                dprintf (3, ("Card not set, curr_object = [%Ix:%Ix, %Ix:%Ix[",
-                                                            card_of (curr_object), (size_t)curr_object,
-                                                            card_of (curr_object+Align(s, align_const)), (size_t)curr_object+Align(s, align_const)));
-                                                FATAL_GC_ERROR();
-                                            }
-                                        }
-                                            );
-                                }
-                                if (need_card_p && !found_card_p)
-                                {
-                                    dprintf (3, ("Card not set, curr_object = [%Ix:%Ix, %Ix:%Ix[",
-                                            card_of (curr_object), (size_t)curr_object,
-                                            card_of (curr_object+Align(s, align_const)), (size_t)curr_object+Align(s, align_const)));
-                                    FATAL_GC_ERROR();
-                                }
-                            }
-                        }
-                        total_objects_verified_deep++;
-                    }
-                }
-
-                prev_object = curr_object;
-                prev_brick = curr_brick;
-                curr_object = curr_object + Align(s, align_const);
-                if (curr_object < prev_object)
-                {
-                    dprintf (3, ("overflow because of a bad object size: %Ix size %Ix", prev_object, s));
-                    FATAL_GC_ERROR();
-                }
-            }
+            int index = Interlocked::Increment (&verify_segments_next) - 1;
+            if (index >= verify_segments_count)
+                break;
 
-            if (curr_object > heap_segment_allocated(seg))
+            verify_segment_entry* entry = &verify_segments[index];
+            entry->hp->verify_heap_segment (entry->seg, entry->gen_num, heap_verify_level,
+                                            &total_objects_verified, &total_objects_verified_deep);
+        }
+    }
+    else
+#endif //MULTIPLE_HEAPS
+    {
+        // go through all generations starting with the highest
+        for (int curr_gen_num = total_generation_count - 1; curr_gen_num >= max_generation; curr_gen_num--)
+        {
+            heap_segment* seg = heap_segment_in_range (generation_start_segment (generation_of (curr_gen_num)));
+            while (seg)
             {
-                dprintf (3, ("Verifiying Heap: curr_object: %Ix > heap_segment_allocated (seg: %Ix)",
-                        (size_t)curr_object, (size_t)seg));
-                FATAL_GC_ERROR();
+                verify_heap_segment (seg, curr_gen_num, heap_verify_level,
+                                     &total_objects_verified, &total_objects_verified_deep);
+                seg = heap_segment_next_in_range (seg);
             }
-
-            seg = heap_segment_next_in_range (seg);
         }
     }
 
@@ -34935,6 +36801,7 @@ HRESULT GCHeap::Initialize()
     else
     {
         gc_heap::total_physical_mem = GCToOSInterface::GetPhysicalMemoryLimit (&gc_heap::is_restricted_physical_mem);
+        gc_heap::physical_mem_from_os_p = true;
     }
 
 #ifdef HOST_64BIT
@@ -34957,10 +36824,32 @@ HRESULT GCHeap::Initialize()
         {
             uint64_t physical_mem_for_gc = gc_heap::total_physical_mem * (uint64_t)75 / (uint64_t)100;
             gc_heap::heap_hard_limit = (size_t)max ((20 * 1024 * 1024), physical_mem_for_gc);
+            gc_heap::container_heap_hard_limit = gc_heap::heap_hard_limit;
         }
     }
 #endif //HOST_64BIT
 
+    gc_heap::conserve_mem_setting = (int)min ((int64_t)9, max ((int64_t)0, GCConfig::GetGCConserveMemory()));
+    gc_heap::release_free_space_p = GCConfig::GetGCReleaseFreeSpace() || (gc_heap::conserve_mem_setting != 0);
+    gc_heap::background_decommit_p = GCConfig::GetGCBackgroundDecommit() && !gc_heap::heap_hard_limit;
+
+    for (int i = 0; i < max_generation; i++)
+    {
+        gc_heap::pause_target_budget_scale[i] = 1.0;
+    }
+    gc_heap::pause_target_us = (uint32_t)min ((int64_t)UINT32_MAX, max ((int64_t)0, GCConfig::GetGCPauseTarget()));
+    gc_heap::idle_collect_percent = (int)min ((int64_t)100, max ((int64_t)1, GCConfig::GetGCIdleCollectPercent()));
+
+    if (GCConfig::GetGCTypeStats())
+    {
+        gc_heap::type_stats_result = new (nothrow) gc_type_stats [type_stats_table_length + 1];
+        if (!gc_heap::type_stats_result)
+            return E_OUTOFMEMORY;
+
+        memset (gc_heap::type_stats_result, 0, (type_stats_table_length + 1) * sizeof (gc_type_stats));
+        gc_heap::type_stats_p = true;
+    }
+
     uint32_t nhp = 1;
     uint32_t nhp_from_config = 0;
 
@@ -35041,6 +36930,10 @@ HRESULT GCHeap::Initialize()
         seg_size = get_valid_segment_size();
         gc_heap::soh_segment_size = seg_size;
         large_seg_size = get_valid_segment_size (TRUE);
+
+        // Without a hard limit nothing is committed upfront, so large pages can only be used where the
+        // OS hands them out transparently as memory gets committed.
+        gc_heap::use_transparent_large_pages_p = GCConfig::GetGCLargePages();
     }
 
     dprintf (1, ("%d heaps, soh seg size: %Id mb, loh: %Id mb\n",
@@ -35058,6 +36951,10 @@ HRESULT GCHeap::Initialize()
 
 #ifdef MULTIPLE_HEAPS
     gc_heap::n_heaps = nhp;
+    gc_heap::n_active_heaps = nhp;
+    gc_heap::n_max_active_heaps = nhp;
+    gc_heap::heap_count_from_cpu_limit_p = (nhp_from_config == 0) && (nhp > 1);
+    gc_heap::dynamic_heap_count_p = GCConfig::GetGCDynamicHeapCount() && (nhp > 1);
     hr = gc_heap::initialize_gc (seg_size, large_seg_size /*loh_segment_size*/, large_seg_size /*poh_segment_size*/, nhp);
 #else
     hr = gc_heap::initialize_gc (seg_size, large_seg_size /*loh_segment_size*/, large_seg_size /*poh_segment_size*/);
@@ -36073,6 +37970,327 @@ GCHeap::GarbageCollectTry (int generation, BOOL low_memory_p, int mode)
     return GarbageCollectGeneration (gen, reason);
 }
 
+// How much of its budget the generation has used, in percent.
+int budget_used_percent (dynamic_data* dd)
+{
+    if (dd_desired_allocation (dd) <= 0)
+    {
+        return 0;
+    }
+
+    float used = (float)(dd_desired_allocation (dd) - dd_new_allocation (dd));
+    return (int)(used * 100.0f / (float)dd_desired_allocation (dd));
+}
+
+int GCHeap::NotifyIdle()
+{
+    if (gc_heap::gc_started || (gc_heap::settings.pause_mode == pause_no_gc))
+    {
+        return -1;
+    }
+
+    int gen0_used_percent = 0;
+    int gen1_used_percent = 0;
+#ifdef MULTIPLE_HEAPS
+    for (int hn = 0; hn < gc_heap::n_heaps; hn++)
+    {
+        gc_heap* hp = gc_heap::g_heaps[hn];
+#else
+    {
+        gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+        gen0_used_percent = max (gen0_used_percent, budget_used_percent (hp->dynamic_data_of (0)));
+        gen1_used_percent = max (gen1_used_percent, budget_used_percent (hp->dynamic_data_of (max_generation - 1)));
+    }
+
+    // A GC now gets the pause out of the way of whatever the host does after the idle window, and
+    // collecting gen1 first keeps the next gen0 GC from turning into one.
+    int gen = -1;
+    if (gen1_used_percent >= gc_heap::idle_collect_percent)
+    {
+        gen = max_generation - 1;
+    }
+    else if (gen0_used_percent >= gc_heap::idle_collect_percent)
+    {
+        gen = 0;
+    }
+
+    if (gen >= 0)
+    {
+        dprintf (2, ("Idle GC of gen%d", gen));
+        GarbageCollectGeneration (gen, reason_idle);
+    }
+
+    return gen;
+}
+
+void gc_heap::begin_pause_info()
+{
+    pause_start_ts = RawGetHighPrecisionTimeStamp();
+    pause_phase_start_ts = pause_start_ts;
+    memset (pause_phase_ticks, 0, sizeof (pause_phase_ticks));
+    pause_in_progress_p = true;
+}
+
+void gc_heap::record_pause_phase (gc_pause_phase phase)
+{
+    if (!pause_in_progress_p)
+        return;
+
+    uint64_t now = RawGetHighPrecisionTimeStamp();
+    pause_phase_ticks[phase] += now - pause_phase_start_ts;
+    pause_phase_start_ts = now;
+}
+
+void gc_heap::end_pause_info (bool gc_happened_p)
+{
+    if (!pause_in_progress_p)
+        return;
+
+    record_pause_phase (gc_pause_phase_resume);
+    pause_in_progress_p = false;
+
+    if (!gc_happened_p)
+        return;
+
+    uint64_t index = pause_info_count;
+    gc_pause_info* info = &pause_info_history[index % max_pause_info_history_count];
+
+    info->gc_index = settings.gc_index;
+    info->condemned_generation = settings.condemned_generation;
+    info->compacting = settings.compaction ? 1 : 0;
+    info->concurrent = settings.concurrent ? 1 : 0;
+    info->reserved = 0;
+    info->pause_duration_us = (pause_phase_start_ts - pause_start_ts) * 1000000 / qpf;
+    for (int i = 0; i < gc_pause_phase_count; i++)
+    {
+        info->phase_duration_us[i] = pause_phase_ticks[i] * 1000000 / qpf;
+    }
+
+    if (pause_target_us != 0)
+    {
+        update_pause_target_tuning (info);
+    }
+
+    // Make the record visible before publishing it.
+    MemoryBarrier();
+    pause_info_count = index + 1;
+}
+
+uint32_t gc_heap::get_pause_info (gc_pause_info* pause_info, uint32_t max_count)
+{
+    uint64_t count_before = pause_info_count;
+    uint32_t copied = 0;
+
+    while ((copied < max_count) && (copied < count_before) && (copied < max_pause_info_history_count))
+    {
+        pause_info[copied] = pause_info_history[(count_before - 1 - copied) % max_pause_info_history_count];
+        copied++;
+    }
+
+    MemoryBarrier();
+
+    // A GC that ended meanwhile may have reused the slots of the oldest records we copied (and the one
+    // after the latest completed record may be in the middle of being written), drop those.
+    uint64_t count_after = pause_info_count;
+    while (copied > 0)
+    {
+        uint64_t oldest_index = count_before - copied;
+        if ((oldest_index + max_pause_info_history_count) > count_after)
+            break;
+        copied--;
+    }
+
+    return copied;
+}
+
+void gc_heap::record_generation_info()
+{
+    static_assert (total_generation_count == gc_generation_info_generations, "gc_generation_info doesn't cover all the generations");
+
+    uint64_t index = generation_info_count;
+    gc_generation_info* info = &generation_info_history[index % max_generation_info_history_count];
+
+    info->gc_index = settings.gc_index;
+    info->condemned_generation = settings.condemned_generation;
+    info->concurrent = settings.concurrent ? 1 : 0;
+    memset (info->generations, 0, sizeof (info->generations));
+
+#ifdef MULTIPLE_HEAPS
+    for (int hn = 0; hn < n_heaps; hn++)
+    {
+        gc_heap* hp = g_heaps[hn];
+#else
+    {
+        gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+        for (int gen_number = 0; gen_number < total_generation_count; gen_number++)
+        {
+            dynamic_data* dd = hp->dynamic_data_of (gen_number);
+            gc_generation_data_info* gen_info = &info->generations[gen_number];
+
+            gen_info->budget += dd_desired_allocation (dd);
+            gen_info->budget_left += max (dd_new_allocation (dd), (ptrdiff_t)0);
+            gen_info->size_before += dd_begin_data_size (dd);
+            gen_info->survived += dd_survived_size (dd);
+            gen_info->promoted += dd_promoted_size (dd);
+            gen_info->size_after += dd_current_size (dd);
+            gen_info->fragmentation += dd_fragmentation (dd);
+            gen_info->collection_count = dd_collection_count (dd);
+        }
+    }
+
+    // Make the record visible before publishing it.
+    MemoryBarrier();
+    generation_info_count = index + 1;
+}
+
+uint32_t gc_heap::get_generation_info (gc_generation_info* generation_info, uint32_t max_count)
+{
+    uint64_t count_before = generation_info_count;
+    uint32_t copied = 0;
+
+    while ((copied < max_count) && (copied < count_before) && (copied < max_generation_info_history_count))
+    {
+        generation_info[copied] = generation_info_history[(count_before - 1 - copied) % max_generation_info_history_count];
+        copied++;
+    }
+
+    MemoryBarrier();
+
+    // Same as get_pause_info, drop the records a GC that ended meanwhile may have overwritten.
+    uint64_t count_after = generation_info_count;
+    while (copied > 0)
+    {
+        uint64_t oldest_index = count_before - copied;
+        if ((oldest_index + max_generation_info_history_count) > count_after)
+            break;
+        copied--;
+    }
+
+    return copied;
+}
+
+void gc_heap::update_pause_target_tuning (gc_pause_info* info)
+{
+    // Only the pauses of blocking ephemeral GCs depend on the budgets being tuned, a BGC pause is spent
+    // marking roots and a blocking gen2 pause depends on the size of the whole heap.
+    int gen = (int)info->condemned_generation;
+    if (info->concurrent || (gen >= max_generation))
+        return;
+
+    double target = (double)pause_target_us;
+    double error = (target - (double)info->pause_duration_us) / target;
+    error = max (-1.0, min (1.0, error));
+
+    double gain = ((error < 0) ? pause_target_shrink_gain : pause_target_grow_gain);
+    double scale = pause_target_budget_scale[gen] * (1.0 + gain * error);
+    pause_target_budget_scale[gen] = max (0.01, min (1.0, scale));
+
+    dprintf (2, ("pause target: gen%d pause %I64dus target %dus scale %d%%", gen, info->pause_duration_us,
+        pause_target_us, (int)(pause_target_budget_scale[gen] * 100)));
+}
+
+void gc_heap::add_type_stats (gc_type_stats* table, size_t* used, void* type, uint64_t count, uint64_t bytes)
+{
+    const size_t mask = type_stats_table_length - 1;
+    size_t index = (((size_t)type >> 3) * 0x9E3779B1) & mask;
+
+    while (table[index].type != type)
+    {
+        if (table[index].type == 0)
+        {
+            if (*used >= (type_stats_table_length / 4 * 3))
+            {
+                index = type_stats_table_length;
+                break;
+            }
+
+            table[index].type = type;
+            (*used)++;
+            break;
+        }
+
+        index = (index + 1) & mask;
+    }
+
+    table[index].count += count;
+    table[index].bytes += bytes;
+}
+
+// Called for every object the mark phase marks, thread is the heap whose mark thread marked it.
+inline
+void gc_heap::record_type_stats (uint8_t* o, size_t s THREAD_NUMBER_DCL)
+{
+#ifdef MULTIPLE_HEAPS
+    gc_heap* hp = g_heaps[thread];
+    add_type_stats (hp->type_stats_table, &hp->type_stats_table_used, method_table (o), 1, s);
+#else //MULTIPLE_HEAPS
+    add_type_stats (type_stats_table, &type_stats_table_used, method_table (o), 1, s);
+#endif //MULTIPLE_HEAPS
+}
+
+// Called by one thread at the end of marking, with the EE suspended.
+void gc_heap::publish_type_stats ()
+{
+    memset (type_stats_result, 0, (type_stats_table_length + 1) * sizeof (gc_type_stats));
+    type_stats_result_used = 0;
+
+#ifdef MULTIPLE_HEAPS
+    for (int i = 0; i < n_heaps; i++)
+    {
+        gc_heap* hp = g_heaps[i];
+#else //MULTIPLE_HEAPS
+    {
+        gc_heap* hp = pGenGCHeap;
+#endif //MULTIPLE_HEAPS
+
+        for (size_t j = 0; j <= type_stats_table_length; j++)
+        {
+            gc_type_stats* entry = &hp->type_stats_table[j];
+            if (entry->count == 0)
+                continue;
+
+            if (j == type_stats_table_length)
+            {
+                type_stats_result[type_stats_table_length].count += entry->count;
+                type_stats_result[type_stats_table_length].bytes += entry->bytes;
+            }
+            else
+            {
+                add_type_stats (type_stats_result, &type_stats_result_used, entry->type, entry->count, entry->bytes);
+            }
+        }
+
+        memset (hp->type_stats_table, 0, (type_stats_table_length + 1) * sizeof (gc_type_stats));
+        hp->type_stats_table_used = 0;
+    }
+
+    type_stats_gc_index = settings.gc_index;
+}
+
+uint32_t gc_heap::get_type_stats (gc_type_stats* type_stats, uint32_t max_count, uint64_t* gc_index)
+{
+    *gc_index = type_stats_gc_index;
+
+    uint32_t count = 0;
+    if (!type_stats_p)
+        return count;
+
+    for (size_t i = 0; i <= type_stats_table_length; i++)
+    {
+        gc_type_stats* entry = &type_stats_result[i];
+        if (entry->count == 0)
+            continue;
+
+        if (count < max_count)
+            type_stats[count] = *entry;
+        count++;
+    }
+
+    return count;
+}
+
 void gc_heap::do_pre_gc()
 {
     STRESS_LOG_GC_STACK;
@@ -36443,6 +38661,8 @@ void gc_heap::do_post_gc()
     gc_heap* hp = 0;
 #endif //MULTIPLE_HEAPS
 
+    record_generation_info();
+
     GCToEEInterface::GcDone(settings.condemned_generation);
 
     GCToEEInterface::DiagGCEnd(VolatileLoad(&settings.gc_index),
@@ -36669,9 +38889,11 @@ GCHeap::GarbageCollectGeneration (unsigned int gen, gc_reason reason)
         cooperative_mode = gc_heap::enable_preemptive ();
 
         dprintf (2, ("Suspending EE"));
+        gc_heap::begin_pause_info();
         BEGIN_TIMING(suspend_ee_during_log);
         GCToEEInterface::SuspendEE(SUSPEND_FOR_GC);
         END_TIMING(suspend_ee_during_log);
+        gc_heap::record_pause_phase (gc_pause_phase_suspend);
         gc_heap::proceed_with_gc_p = gc_heap::should_proceed_with_gc();
         gc_heap::disable_preemptive (cooperative_mode);
         if (gc_heap::proceed_with_gc_p)
@@ -36731,9 +38953,11 @@ GCHeap::GarbageCollectGeneration (unsigned int gen, gc_reason reason)
     if (!gc_heap::dont_restart_ee_p)
     {
 #endif //BACKGROUND_GC
+        gc_heap::record_pause_phase (gc_pause_phase_post);
         BEGIN_TIMING(restart_ee_during_log);
         GCToEEInterface::RestartEE(TRUE);
         END_TIMING(restart_ee_during_log);
+        gc_heap::end_pause_info (gc_heap::proceed_with_gc_p != FALSE);
 #ifdef BACKGROUND_GC
     }
 #endif //BACKGROUND_GC
@@ -36866,7 +39090,7 @@ size_t GCHeap::ApproxTotalBytesInUse(BOOL small_heap_only)
 void GCHeap::AssignHeap (alloc_context* acontext)
 {
     // Assign heap based on processor
-    acontext->set_alloc_heap(GetHeap(heap_select::select_heap(acontext)));
+    acontext->set_alloc_heap(GetHeap(heap_select::select_active_heap(acontext)));
     acontext->set_home_heap(acontext->get_alloc_heap());
 }
 
@@ -36987,6 +39211,31 @@ int GCHeap::SetGcLatencyMode (int newLatencyMode)
     return (int)set_pause_mode_success;
 }
 
+size_t GCHeap::GetLOHThreshold()
+{
+    return loh_size_threshold;
+}
+
+uint32_t GCHeap::GetGcPauseTarget()
+{
+    return gc_heap::pause_target_us;
+}
+
+uint32_t GCHeap::SetGcPauseTarget (uint32_t pause_target_us)
+{
+    uint32_t previous_target = gc_heap::pause_target_us;
+
+    // Budgets start again from what the regular tuning gives, a GC that happens to be running keeps using
+    // the old values until it ends.
+    for (int i = 0; i < max_generation; i++)
+    {
+        gc_heap::pause_target_budget_scale[i] = 1.0;
+    }
+    gc_heap::pause_target_us = pause_target_us;
+
+    return previous_target;
+}
+
 int GCHeap::GetLOHCompactionMode()
 {
     return pGenGCHeap->loh_compaction_mode;
@@ -37000,7 +39249,8 @@ void GCHeap::SetLOHCompactionMode (int newLOHCompactionMode)
 }
 
 bool GCHeap::RegisterForFullGCNotification(uint32_t gen2Percentage,
-                                           uint32_t lohPercentage)
+                                           uint32_t lohPercentage,
+                                           size_t leadBytes)
 {
 #ifdef MULTIPLE_HEAPS
     for (int hn = 0; hn < gc_heap::n_heaps; hn++)
@@ -37020,6 +39270,13 @@ bool GCHeap::RegisterForFullGCNotification(uint32_t gen2Percentage,
 
     pGenGCHeap->fgn_loh_percent = lohPercentage;
 
+    // The budgets are per heap.
+#ifdef MULTIPLE_HEAPS
+    pGenGCHeap->fgn_lead_bytes = leadBytes / gc_heap::n_heaps;
+#else //MULTIPLE_HEAPS
+    pGenGCHeap->fgn_lead_bytes = leadBytes;
+#endif //MULTIPLE_HEAPS
+
     return TRUE;
 }
 
@@ -37036,6 +39293,7 @@ bool GCHeap::CancelFullGCNotification()
 #endif //MULTIPLE_HEAPS
 
     pGenGCHeap->fgn_loh_percent = 0;
+    pGenGCHeap->fgn_lead_bytes = 0;
     pGenGCHeap->full_gc_approach_event.Set();
     pGenGCHeap->full_gc_end_event.Set();
 
@@ -37063,6 +39321,12 @@ int GCHeap::StartNoGCRegion(uint64_t totalSize, bool lohSizeKnown, uint64_t lohS
     NoGCRegionLockHolder lh;
 
     dprintf (1, ("begin no gc called"));
+    if (gc_heap::current_no_gc_region_info.started)
+    {
+        // Failing to join leaves the region as it is for the threads in it.
+        return (int)gc_heap::join_no_gc_region (totalSize, lohSizeKnown, lohSize);
+    }
+
     start_no_gc_region_status status = gc_heap::prepare_for_no_gc_region (totalSize, lohSizeKnown, lohSize, disallowFullBlockingGC);
     if (status == start_no_gc_success)
     {
@@ -37070,7 +39334,9 @@ int GCHeap::StartNoGCRegion(uint64_t totalSize, bool lohSizeKnown, uint64_t lohS
         status = gc_heap::get_start_no_gc_region_status();
     }
 
-    if (status != start_no_gc_success)
+    if (status == start_no_gc_success)
+        gc_heap::add_no_gc_participant (lohSizeKnown ? (totalSize - lohSize) : totalSize);
+    else
         gc_heap::handle_failure_for_no_gc();
 
     return (int)status;
@@ -37251,6 +39517,29 @@ Object* GCHeap::GetNextFinalizableObject()
 
 }
 
+uint32_t GCHeap::GetNextFinalizableObjects(Object** objects, uint32_t count)
+{
+#ifdef MULTIPLE_HEAPS
+    uint32_t found = 0;
+
+    // same order as GetNextFinalizableObject: all the non critical ones first, then the critical ones.
+    for (int hn = 0; (hn < gc_heap::n_heaps) && (found < count); hn++)
+    {
+        gc_heap* hp = gc_heap::g_heaps [hn];
+        found += hp->finalize_queue->GetNextFinalizableObjects (objects + found, count - found, TRUE);
+    }
+    for (int hn = 0; (hn < gc_heap::n_heaps) && (found < count); hn++)
+    {
+        gc_heap* hp = gc_heap::g_heaps [hn];
+        found += hp->finalize_queue->GetNextFinalizableObjects (objects + found, count - found, FALSE);
+    }
+    return found;
+
+#else //MULTIPLE_HEAPS
+    return pGenGCHeap->finalize_queue->GetNextFinalizableObjects (objects, count);
+#endif //MULTIPLE_HEAPS
+}
+
 size_t GCHeap::GetNumberFinalizableObjects()
 {
 #ifdef MULTIPLE_HEAPS
@@ -37501,8 +39790,33 @@ CFinalize::RegisterForFinalization (int gen, Object* obj, size_t size)
 Object*
 CFinalize::GetNextFinalizableObject (BOOL only_non_critical)
 {
-    Object* obj = 0;
     EnterFinalizeLock();
+    Object* obj = GetNextFinalizableObjectLocked (only_non_critical);
+    LeaveFinalizeLock();
+    return obj;
+}
+
+// Dequeues up to count finalizable objects while taking the finalize lock only once.
+uint32_t
+CFinalize::GetNextFinalizableObjects (Object** objects, uint32_t count, BOOL only_non_critical)
+{
+    uint32_t found = 0;
+    EnterFinalizeLock();
+    while (found < count)
+    {
+        Object* obj = GetNextFinalizableObjectLocked (only_non_critical);
+        if (!obj)
+            break;
+        objects[found++] = obj;
+    }
+    LeaveFinalizeLock();
+    return found;
+}
+
+Object*
+CFinalize::GetNextFinalizableObjectLocked (BOOL only_non_critical)
+{
+    Object* obj = 0;
 
 retry:
     if (!IsSegEmpty(FinalizerListSeg))
@@ -37534,7 +39848,6 @@ retry:
     {
         dprintf (3, ("running finalizer for %Ix (mt: %Ix)", obj, method_table (obj)));
     }
-    LeaveFinalizeLock();
     return obj;
 }
 
@@ -73,6 +73,7 @@ enum gc_reason
     reason_bgc_tuning_soh = 14,
     reason_bgc_tuning_loh = 15,
     reason_bgc_stepping = 16,
+    reason_idle = 17,           // the host reported an idle window, see IGCHeap::NotifyIdle
     reason_max
 };
 
@@ -263,7 +264,6 @@ public:
     virtual ~IGCHeapInternal() {}
 
 public:
-    virtual int GetNumberOfHeaps () = 0;
     virtual int GetHomeHeapNumber () = 0;
     virtual size_t GetPromotedBytes(int heap_index) = 0;
 
@@ -0,0 +1,73 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+#include "common.h"
+#include "gcenv.h"
+#include "gccardscan.h"
+
+#ifdef USE_VECTORIZED_CARD_SCAN
+
+#include <immintrin.h>
+
+// The rest of the GC is compiled for the baseline ISA, so the kernels opt into AVX2/AVX-512 one function
+// at a time. The GC only calls them once the EE has reported the instruction set as usable.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CARD_SCAN_TARGET_AVX2
+#define CARD_SCAN_TARGET_AVX512
+#else
+#define CARD_SCAN_TARGET_AVX2   __attribute__((target("avx2")))
+#define CARD_SCAN_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// Each vector checks 256 (AVX2) or 512 (AVX-512) cards at once. The card table is mostly zero during
+// ephemeral GCs over large gen2 heaps, so the common case is a run of empty vectors.
+
+CARD_SCAN_TARGET_AVX2
+uint32_t* find_nonzero_card_word_avx2(uint32_t* card_word, uint32_t* card_word_end)
+{
+    const size_t N = sizeof(__m256i) / sizeof(uint32_t);
+
+    while ((size_t)(card_word_end - card_word) >= N)
+    {
+        __m256i v = _mm256_loadu_si256((__m256i*)card_word);
+        if (!_mm256_testz_si256(v, v))
+            break;
+        card_word += N;
+    }
+
+    while ((card_word < card_word_end) && !(*card_word))
+    {
+        card_word++;
+    }
+
+    return card_word;
+}
+
+CARD_SCAN_TARGET_AVX512
+uint32_t* find_nonzero_card_word_avx512(uint32_t* card_word, uint32_t* card_word_end)
+{
+    const size_t N = sizeof(__m512i) / sizeof(uint32_t);
+
+    while ((size_t)(card_word_end - card_word) >= N)
+    {
+        __m512i v = _mm512_loadu_si512(card_word);
+        __mmask16 nonzero = _mm512_test_epi32_mask(v, v);
+        if (nonzero != 0)
+        {
+            uint32_t index;
+            BitScanForward(&index, (uint32_t)nonzero);
+            return card_word + index;
+        }
+        card_word += N;
+    }
+
+    while ((card_word < card_word_end) && !(*card_word))
+    {
+        card_word++;
+    }
+
+    return card_word;
+}
+
+#endif // USE_VECTORIZED_CARD_SCAN
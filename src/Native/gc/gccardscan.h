@@ -0,0 +1,24 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+#ifndef __GC_CARD_SCAN_H__
+#define __GC_CARD_SCAN_H__
+
+// Vectorized kernels used by the GC to skip over runs of clear cards when looking for set cards.
+#if defined(TARGET_AMD64)
+#define USE_VECTORIZED_CARD_SCAN
+#endif // TARGET_AMD64
+
+#ifdef USE_VECTORIZED_CARD_SCAN
+
+// Returns the first non-zero card word in [card_word, card_word_end), or card_word_end if all of
+// them are zero.
+typedef uint32_t* (*card_word_scan_func)(uint32_t* card_word, uint32_t* card_word_end);
+
+uint32_t* find_nonzero_card_word_avx2(uint32_t* card_word, uint32_t* card_word_end);
+uint32_t* find_nonzero_card_word_avx512(uint32_t* card_word, uint32_t* card_word_end);
+
+#endif // USE_VECTORIZED_CARD_SCAN
+
+#endif // __GC_CARD_SCAN_H__
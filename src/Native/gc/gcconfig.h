@@ -76,13 +76,36 @@ public:
     BOOL_CONFIG  (LogEnabled,             "GCLogEnabled",           NULL,                             false,             "Specifies if you want to turn on logging in GC")                                         \
     BOOL_CONFIG  (ConfigLogEnabled,       "GCConfigLogEnabled",     NULL,                             false,             "Specifies the name of the GC config log file")                                           \
     BOOL_CONFIG  (GCNumaAware,            "GCNumaAware",            NULL,                             true,              "Enables numa allocations in the GC")                                                     \
+    BOOL_CONFIG  (GCDynamicHeapCount,     "GCDynamicHeapCount",     "System.GC.DynamicHeapCount",     false,             "Grow and shrink the number of server GC heaps used for allocations based on the "        \
+                                                                                                                         "time spent in GC")                                                                       \
     BOOL_CONFIG  (GCCpuGroup,             "GCCpuGroup",             NULL,                             false,             "Enables CPU groups in the GC")                                                           \
     BOOL_CONFIG  (GCLargePages,           "GCLargePages",           "System.GC.LargePages",           false,             "Enables using Large Pages in the GC")                                                    \
+    BOOL_CONFIG  (GCReleaseFreeSpace,     "GCReleaseFreeSpace",     "System.GC.ReleaseFreeSpace",     false,             "Return free space within and at the end of segments to the OS instead of keeping it "    \
+                                                                                                                         "for future allocations")                                                                 \
+    BOOL_CONFIG  (GCBackgroundDecommit,   "GCBackgroundDecommit",   "System.GC.BackgroundDecommit",   false,             "Decommit the free memory at the end of segments and deleted segments on a thread of "    \
+                                                                                                                         "its own at a limited rate instead of during the GC pause")                               \
+    BOOL_CONFIG  (GCTypeStats,            "GCTypeStats",            "System.GC.TypeStats",            false,             "Count the live objects and bytes of each type while marking during full GCs, see "       \
+                                                                                                                         "IGCHeap::GetHeapTypeStats")                                                              \
+    BOOL_CONFIG  (GCOSWriteWatch,         "GCOSWriteWatch",         NULL,                             false,             "On Linux, track the pages written during background GC with the kernel's userfaultfd "   \
+                                                                                                                         "write protection, which enables concurrent GC there")                                    \
     INT_CONFIG   (HeapVerifyLevel,        "HeapVerify",             NULL,                             HEAPVERIFY_NONE,   "When set verifies the integrity of the managed heap on entry and exit of each GC")       \
     INT_CONFIG   (LOHCompactionMode,      "GCLOHCompact",           NULL,                             0,                 "Specifies the LOH compaction mode")                                                      \
     INT_CONFIG   (LOHThreshold,           "GCLOHThreshold",         NULL,                             LARGE_OBJECT_SIZE, "Specifies the size that will make objects go on LOH")                                    \
+    INT_CONFIG   (GCNonTemporalClearThreshold, "GCNonTemporalClearThreshold", NULL,                       0,                 "Clears of at least this many bytes use streaming stores that bypass the caches, "        \
+                                                                                                                         "0 disables (AMD64 only)")                                                                \
+    INT_CONFIG   (GCConserveMemory,       "GCConserveMemory",       "System.GC.ConserveMemory",       0,                 "Trade GC time for a smaller heap, from 0 (off) to 9. A generation with more than "       \
+                                                                                                                         "(10 - value) * 10% free space gets compacted, see conserve_mem_setting")                 \
+    INT_CONFIG   (GCPauseTarget,          "GCPauseTarget",          "System.GC.PauseTarget",          0,                 "Longest GC pause to aim for, in microseconds. Ephemeral budgets shrink when pauses go "  \
+                                                                                                                         "over it and grow back when they are well under it, 0 disables")                         \
+    INT_CONFIG   (GCIdleCollectPercent,   "GCIdleCollectPercent",   "System.GC.IdleCollectPercent",   50,                "How much of its gen0 or gen1 budget, in percent, a heap must have used for an idle "     \
+                                                                                                                         "notification from the host to collect that generation")                                  \
     INT_CONFIG   (BGCSpinCount,           "BGCSpinCount",           NULL,                             140,               "Specifies the bgc spin count")                                                           \
     INT_CONFIG   (BGCSpin,                "BGCSpin",                NULL,                             2,                 "Specifies the bgc spin time")                                                            \
+    BOOL_CONFIG  (BGCCpuQuotaPacing,      "GCBGCCpuQuotaPacing",    NULL,                             true,              "Pace the background GC threads when the process gets throttled for exceeding its CPU quota") \
+    INT_CONFIG   (BGCRevisitTargetPages,  "BGCRevisitTargetPages",  NULL,                             1024,              "Concurrent revisits of written pages are repeated until a round finds no more "          \
+                                                                                                                         "than this many pages per heap, or stops shrinking. 0 does the usual two rounds")        \
+    BOOL_CONFIG  (BGCMarkSharing,         "GCBGCMarkSharing",       NULL,                             true,              "BGC threads that are done with their own concurrent marking take over work of the others") \
+    INT_CONFIG   (BGCMarkHelpers,         "GCBGCMarkHelpers",       NULL,                             0,                 "Number of threads that help the BGC thread of workstation GC with concurrent marking")    \
     INT_CONFIG   (HeapCount,              "GCHeapCount",            "System.GC.HeapCount",            0,                 "Specifies the number of server GC heaps")                                                \
     INT_CONFIG   (Gen0Size,               "GCgen0size",             NULL,                             0,                 "Specifies the smallest gen0 size")                                                       \
     INT_CONFIG   (SegmentSize,            "GCSegmentSize",          NULL,                             0,                 "Specifies the managed heap segment size")                                                \
@@ -102,6 +125,7 @@ public:
     INT_CONFIG   (GCHeapHardLimit,        "GCHeapHardLimit",        NULL,                             0,                 "Specifies a hard limit for the GC heap")                                                 \
     INT_CONFIG   (GCHeapHardLimitPercent, "GCHeapHardLimitPercent", "System.GC.HeapHardLimitPercent", 0,                 "Specifies the GC heap usage as a percentage of the total memory")                        \
     INT_CONFIG   (GCTotalPhysicalMemory,  "GCTotalPhysicalMemory",  NULL,                             0,                 "Specifies what the GC should consider to be total physical memory")                      \
+    INT_CONFIG   (GCResourceLimitsRefresh, "GCResourceLimitsRefresh", NULL,                           5000,              "Specifies how often, in milliseconds, blocking GCs re-read the container memory and CPU limits, 0 disables it") \
     STRING_CONFIG(LogFile,                "GCLogFile",              NULL,                                                "Specifies the name of the GC log file")                                                  \
     STRING_CONFIG(ConfigLogFile,          "GCConfigLogFile",        NULL,                                                "Specifies the name of the GC config log file")                                           \
     INT_CONFIG   (BGCFLTuningEnabled,     "BGCFLTuningEnabled",     NULL,                             0,                 "Enables FL tuning")                                                                      \
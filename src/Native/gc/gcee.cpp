@@ -250,6 +250,27 @@ size_t GCHeap::GetNow()
     return GetHighPrecisionTimeStamp();
 }
 
+// Copies up to max_count of the most recent GC pause records into pause_info, newest first, and returns
+// how many were copied.
+uint32_t GCHeap::GetGCPauseInfo(gc_pause_info* pause_info, uint32_t max_count)
+{
+    return gc_heap::get_pause_info (pause_info, max_count);
+}
+
+// Copies up to max_count of the most recent generation snapshots into generation_info, newest first, and
+// returns how many were copied.
+uint32_t GCHeap::GetGenerationInfo(gc_generation_info* generation_info, uint32_t max_count)
+{
+    return gc_heap::get_generation_info (generation_info, max_count);
+}
+
+// Copies up to max_count of the per-type live object counts of the last full GC into type_stats and returns
+// how many types there are.
+uint32_t GCHeap::GetHeapTypeStats(gc_type_stats* type_stats, uint32_t max_count, uint64_t* gc_index)
+{
+    return gc_heap::get_type_stats (type_stats, max_count, gc_index);
+}
+
 bool GCHeap::IsGCInProgressHelper (bool bConsiderGCStart)
 {
     return GcInProgress || (bConsiderGCStart? VolatileLoad(&gc_heap::gc_started) : FALSE);
@@ -65,6 +65,12 @@ inline bool GCToEEInterface::RefCountedHandleCallbacks(Object * pObject)
     return g_theGCToCLR->RefCountedHandleCallbacks(pObject);
 }
 
+inline size_t GCToEEInterface::RefCountedHandleCallbacksForBatch(Object ** rgpObjects, size_t cObjects)
+{
+    assert(g_theGCToCLR != nullptr);
+    return g_theGCToCLR->RefCountedHandleCallbacksForBatch(rgpObjects, cObjects);
+}
+
 inline void GCToEEInterface::SyncBlockCacheWeakPtrScan(HANDLESCANPROC scanProc, uintptr_t lp1, uintptr_t lp2)
 {
     assert(g_theGCToCLR != nullptr);
@@ -295,4 +301,16 @@ inline void GCToEEInterface::UpdateGCEventStatus(int publicLevel, int publicKeyw
 #endif // __linux__
 }
 
+inline uint32_t GCToEEInterface::GetSupportedInstructionSets()
+{
+    assert(g_theGCToCLR != nullptr);
+    return g_theGCToCLR->GetSupportedInstructionSets();
+}
+
+inline void GCToEEInterface::FullGCApproaching(int generation)
+{
+    assert(g_theGCToCLR != nullptr);
+    g_theGCToCLR->FullGCApproaching(generation);
+}
+
 #endif // __GCTOENV_EE_STANDALONE_INL__
@@ -7,3 +7,22 @@
 
 Volatile<GCEventLevel> GCEventStatus::enabledLevels[2] = {GCEventLevel_None, GCEventLevel_None};
 Volatile<GCEventKeyword> GCEventStatus::enabledKeywords[2] = {GCEventKeyword_None, GCEventKeyword_None};
+Volatile<uint32_t> GCEventStatus::enabledEvents[(GCEventId_Count + 31) / 32];
+
+void GCEventStatus::UpdateEnabledEvents()
+{
+    uint32_t events[(GCEventId_Count + 31) / 32] = {};
+
+#define KNOWN_EVENT(name, provider, level, keyword)                       \
+    if (IsEnabled(provider, keyword, level))                              \
+        events[GCEventId_##name / 32] |= 1u << (GCEventId_##name % 32);
+#define DYNAMIC_EVENT(name, level, keyword, ...)                          \
+    if (IsEnabled(GCEventProvider_Default, keyword, level))               \
+        events[GCEventId_##name / 32] |= 1u << (GCEventId_##name % 32);
+#include "gcevents.h"
+
+    for (size_t i = 0; i < sizeof(events) / sizeof(events[0]); i++)
+    {
+        enabledEvents[i] = events[i];
+    }
+}
@@ -32,6 +32,18 @@
 // Uncomment this define to print out event state changes to standard error.
 // #define TRACE_GC_EVENT_STATE 1
 
+/*
+ * GCEventId numbers the known and dynamic events of gcevents.h, in the order
+ * they are declared there.
+ */
+enum GCEventId
+{
+#define KNOWN_EVENT(name, provider, level, keyword) GCEventId_##name,
+#define DYNAMIC_EVENT(name, level, keyword, ...) GCEventId_##name,
+#include "gcevents.h"
+    GCEventId_Count
+};
+
 
 /*
  * GCEventStatus maintains all eventing state for the GC. It consists
@@ -56,6 +68,21 @@ private:
      */
     static Volatile<GCEventKeyword> enabledKeywords[2];
 
+    /*
+     * A bit per GCEventId, set if the event is enabled by the current levels
+     * and keywords of its provider. Checking an event at its call site is then
+     * a single load and test, no matter which provider, level and keyword the
+     * event has. The words are 32 bits so that they are updated atomically on
+     * every platform.
+     */
+    static Volatile<uint32_t> enabledEvents[(GCEventId_Count + 31) / 32];
+
+    /*
+     * UpdateEnabledEvents recomputes enabledEvents from the levels and keywords
+     * of both providers.
+     */
+    static void UpdateEnabledEvents();
+
 public:
     /*
      * IsEnabled queries whether or not the given level and keyword are
@@ -70,6 +97,15 @@ public:
           && (enabledKeywords[index].LoadWithoutBarrier() & keyword);
     }
 
+    /*
+     * IsEventEnabled queries whether or not the given event is enabled,
+     * returning true if it is.
+     */
+    __forceinline static bool IsEventEnabled(GCEventId id)
+    {
+        return (enabledEvents[id / 32].LoadWithoutBarrier() & (1u << (id % 32))) != 0;
+    }
+
     /*
      * Set sets the eventing state (level and keyword bitmap) for a given
      * provider to the provided values.
@@ -82,6 +118,7 @@ public:
 
         enabledLevels[index] = level;
         enabledKeywords[index] = keywords;
+        UpdateEnabledEvents();
 
 #if TRACE_GC_EVENT_STATE
         fprintf(stderr, "event state change:\n");
@@ -245,7 +282,7 @@ void FireDynamicEvent(const char* name, EventArgument... arguments)
 #if FEATURE_EVENT_TRACE
 
 #define KNOWN_EVENT(name, provider, level, keyword)               \
-  inline bool GCEventEnabled##name() { return GCEventStatus::IsEnabled(provider, keyword, level); } \
+  inline bool GCEventEnabled##name() { return GCEventStatus::IsEventEnabled(GCEventId_##name); } \
   template<typename... EventActualArgument>                       \
   inline void GCEventFire##name(EventActualArgument... arguments) \
   {                                                               \
@@ -258,7 +295,7 @@ void FireDynamicEvent(const char* name, EventArgument... arguments)
   }
 
 #define DYNAMIC_EVENT(name, level, keyword, ...)                                                                   \
-  inline bool GCEventEnabled##name() { return GCEventStatus::IsEnabled(GCEventProvider_Default, keyword, level); } \
+  inline bool GCEventEnabled##name() { return GCEventStatus::IsEventEnabled(GCEventId_##name); } \
   template<typename... EventActualArgument>                                                                        \
   inline void GCEventFire##name(EventActualArgument... arguments) { FireDynamicEvent<__VA_ARGS__>(#name, arguments...); }
 
@@ -267,6 +304,59 @@ void FireDynamicEvent(const char* name, EventArgument... arguments)
 #define EVENT_ENABLED(name) GCEventEnabled##name()
 #define FIRE_EVENT(name, ...) GCEventFire##name(__VA_ARGS__)
 
+/*
+ * GCBulkEventBuffer collects the payloads of an event that the GC fires many
+ * times in a row, such as once per pinned plug of a GC, and passes them to
+ * FireBulk, which makes one call on IGCToCLREventSink for all of them, when
+ * Capacity of them are collected and when the buffer is flushed. The owner
+ * checks that the event is enabled before adding to the buffer and flushes
+ * it once the loop that fires the event is done.
+ */
+template<typename Payload, uint32_t Capacity, void (*FireBulk)(const Payload* payloads, uint32_t count)>
+class GCBulkEventBuffer
+{
+private:
+    Payload payloads[Capacity];
+    uint32_t count;
+
+public:
+    GCBulkEventBuffer() : count(0)
+    {
+    }
+
+    ~GCBulkEventBuffer()
+    {
+        assert(count == 0);
+    }
+
+    void Add(const Payload& payload)
+    {
+        payloads[count++] = payload;
+        if (count == Capacity)
+        {
+            Flush();
+        }
+    }
+
+    void Flush()
+    {
+        if (count != 0)
+        {
+            FireBulk(payloads, count);
+            count = 0;
+        }
+    }
+};
+
+inline void GCEventFireBulkPinPlugAtGCTime(const GCPinPlugEventData* plugs, uint32_t count)
+{
+    IGCToCLREventSink* sink = GCToEEInterface::EventSink();
+    assert(sink != nullptr);
+    sink->FireBulkPinPlugAtGCTime(plugs, count);
+}
+
+typedef GCBulkEventBuffer<GCPinPlugEventData, 64, GCEventFireBulkPinPlugAtGCTime> GCPinPlugEventBuffer;
+
 #else // FEATURE_EVENT_TRACE
 #define EVENT_ENABLED(name) false
 #define FIRE_EVENT(name, ...) 0
@@ -57,6 +57,24 @@ OBJECTHANDLE GCHandleStore::CreateDependentHandle(Object* primary, Object* secon
     return handle;
 }
 
+bool GCHandleStore::CreateHandlesOfType(Object** objects, HandleType type, OBJECTHANDLE* handles, uint32_t count)
+{
+    HHANDLETABLE handletable = _underlyingBucket.pTable[GetCurrentThreadHomeHeapNumber()];
+    uint32_t created = ::HndCreateHandles(handletable, type, handles, count);
+    if (created != count)
+    {
+        ::HndDestroyHandles(handletable, type, handles, created);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        ::HndAssignHandle(handles[i], ObjectToOBJECTREF(objects[i]));
+    }
+
+    return true;
+}
+
 GCHandleStore::~GCHandleStore()
 {
     ::Ref_DestroyHandleTableBucket(&_underlyingBucket);
@@ -177,3 +195,25 @@ void GCHandleManager::TraceRefCountedHandles(HANDLESCANPROC callback, uintptr_t
     ::Ref_TraceRefCountHandles(callback, param1, param2);
 }
 
+void GCHandleManager::DestroyHandlesOfUnknownType(const OBJECTHANDLE* handles, uint32_t count)
+{
+    // Handles of a batch usually come from the same table and have the same type, free them in runs that do.
+    uint32_t start = 0;
+    while (start < count)
+    {
+        HHANDLETABLE handletable = ::HndGetHandleTable(handles[start]);
+        uint32_t type = ::HandleFetchType(handles[start]);
+
+        uint32_t end = start + 1;
+        while ((end < count) &&
+               (::HndGetHandleTable(handles[end]) == handletable) &&
+               (::HandleFetchType(handles[end]) == type))
+        {
+            end++;
+        }
+
+        ::HndDestroyHandles(handletable, type, handles + start, end - start);
+        start = end;
+    }
+}
+
@@ -23,6 +23,8 @@ public:
 
     virtual OBJECTHANDLE CreateDependentHandle(Object* primary, Object* secondary);
 
+    virtual bool CreateHandlesOfType(Object** objects, HandleType type, OBJECTHANDLE* handles, uint32_t count);
+
     virtual ~GCHandleStore();
 
     HandleTableBucket _underlyingBucket;
@@ -68,6 +70,8 @@ public:
     virtual HandleType HandleFetchType(OBJECTHANDLE handle);
 
     virtual void TraceRefCountedHandles(HANDLESCANPROC callback, uintptr_t param1, uintptr_t param2);
+
+    virtual void DestroyHandlesOfUnknownType(const OBJECTHANDLE* handles, uint32_t count);
 };
 
 #endif  // GCHANDLETABLE_H_
@@ -82,6 +82,19 @@ public:
     size_t  GetLastGCDuration(int generation);
     size_t  GetNow();
 
+    uint32_t GetGCPauseInfo(gc_pause_info* pause_info, uint32_t max_count);
+
+    uint32_t GetGenerationInfo(gc_generation_info* generation_info, uint32_t max_count);
+
+    uint32_t GetHeapTypeStats(gc_type_stats* type_stats, uint32_t max_count, uint64_t* gc_index);
+
+    uint32_t GetGcPauseTarget();
+    uint32_t SetGcPauseTarget(uint32_t pause_target_us);
+
+    int NotifyIdle();
+
+    size_t GetLOHThreshold();
+
     void  DiagTraceGCSegments ();
     void PublishObject(uint8_t* obj);
 
@@ -179,7 +192,8 @@ public:
     void SetLOHCompactionMode(int newLOHCompactionyMode);
 
     bool RegisterForFullGCNotification(uint32_t gen2Percentage,
-                                       uint32_t lohPercentage);
+                                       uint32_t lohPercentage,
+                                       size_t leadBytes);
     bool CancelFullGCNotification();
     int WaitForFullGCApproach(int millisecondsTimeout);
     int WaitForFullGCComplete(int millisecondsTimeout);
@@ -190,6 +204,7 @@ public:
     unsigned GetGcCount();
 
     Object* GetNextFinalizable() { return GetNextFinalizableObject(); };
+    uint32_t GetNextFinalizables(Object** objects, uint32_t count) { return GetNextFinalizableObjects(objects, count); };
     size_t GetNumberOfFinalizable() { return GetNumberFinalizableObjects(); }
 
     PER_HEAP_ISOLATED HRESULT GetGcCounters(int gen, gc_counters* counters);
@@ -199,6 +214,7 @@ public:
     void SetReservedVMLimit (size_t vmlimit);
 
     PER_HEAP_ISOLATED Object* GetNextFinalizableObject();
+    PER_HEAP_ISOLATED uint32_t GetNextFinalizableObjects(Object** objects, uint32_t count);
     PER_HEAP_ISOLATED size_t GetNumberFinalizableObjects();
     PER_HEAP_ISOLATED size_t GetFinalizablePromotedCount();
 
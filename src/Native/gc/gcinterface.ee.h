@@ -21,6 +21,22 @@ enum EtwGCRootKind
     kEtwGCRootKindOther =               3,
 };
 
+// Instruction set extensions the EE can report to the GC as usable, see
+// IGCToCLR::GetSupportedInstructionSets.
+enum GCInstructionSet
+{
+    GCInstructionSet_Avx2 =             0x1,
+    GCInstructionSet_Avx512F =          0x2,
+};
+
+// A pinned plug found by the plan phase, see IGCToCLREventSink::FireBulkPinPlugAtGCTime.
+struct GCPinPlugEventData
+{
+    uint8_t* plugStart;
+    uint8_t* plugEnd;
+    uint8_t* gapBeforeSize;
+};
+
 // This interface provides functions that the GC can use to fire events.
 // Events fired on this interface are split into two categories: "known"
 // events and "dynamic" events. Known events are events that are baked-in
@@ -112,6 +128,11 @@ public:
     virtual
     void FirePinPlugAtGCTime(uint8_t* plug_start, uint8_t* plug_end, uint8_t* gapBeforeSize) = 0;
 
+    // Fires PinPlugAtGCTime for each of the plugs, which the GC collects to
+    // make one call for many of them.
+    virtual
+    void FireBulkPinPlugAtGCTime(const GCPinPlugEventData* plugs, uint32_t count) = 0;
+
     virtual
     void FireGCPerHeapHistory_V3(void *freeListAllocated,
                                  void *freeListRejected,
@@ -215,6 +236,11 @@ public:
     virtual
     bool RefCountedHandleCallbacks(Object * pObject) = 0;
 
+    // The same predicate for a batch of objects of refcounted handles. The objects that should be promoted
+    // are moved to the start of the array, in their original order, and their number is returned.
+    virtual
+    size_t RefCountedHandleCallbacksForBatch(Object ** rgpObjects, size_t cObjects) = 0;
+
     // Performs a weak pointer scan of the sync block cache.
     virtual
     void SyncBlockCacheWeakPtrScan(HANDLESCANPROC scanProc, uintptr_t lp1, uintptr_t lp2) = 0;
@@ -422,6 +448,17 @@ public:
 
     virtual
     void UpdateGCEventStatus(int publicLevel, int publicKeywords, int privateLEvel, int privateKeywords) = 0;
+
+    // Returns the GCInstructionSet flags for the instruction set extensions that the processor and
+    // OS support, so the GC can pick vectorized code paths.
+    virtual
+    uint32_t GetSupportedInstructionSets() = 0;
+
+    // Called once a registered full GC notification detects that a full blocking GC
+    // is approaching, on the thread that detected it. generation is max_generation
+    // when the gen2 budget is the reason, or the UOH generation whose budget is.
+    virtual
+    void FullGCApproaching(int generation) = 0;
 };
 
 #endif // _GCINTERFACE_EE_H_
@@ -7,12 +7,12 @@
 
 // The major version of the GC/EE interface. Breaking changes to this interface
 // require bumps in the major version number.
-#define GC_INTERFACE_MAJOR_VERSION 4
+#define GC_INTERFACE_MAJOR_VERSION 5
 
 // The minor version of the GC/EE interface. Non-breaking changes are required
 // to bump the minor version number. GCs and EEs with minor version number
 // mismatches can still interopate correctly, with some care.
-#define GC_INTERFACE_MINOR_VERSION 1
+#define GC_INTERFACE_MINOR_VERSION 6
 
 struct ScanContext;
 struct gc_alloc_context;
@@ -109,6 +109,13 @@ struct WriteBarrierParameters
     // The new write watch table, if we are using our own write watch
     // implementation. Used for WriteBarrierOp::SwitchToWriteWatch only.
     uint8_t* write_watch_table;
+
+    // The new start of generation 0, or nullptr if generation 0 isn't a single
+    // range below ephemeral_high (server GC). Every object between it and
+    // ephemeral_high is in generation 0, so a write barrier may skip marking
+    // the card of such an object. Used for WriteBarrierOp::Initialize and
+    // WriteBarrierOp::StompEphemeral.
+    uint8_t* gen0_low;
 };
 
 // Opaque type for tracking object pointers
@@ -142,6 +149,9 @@ struct gc_alloc_context
     void*          gc_reserved_1;
     void*          gc_reserved_2;
     int            alloc_count;
+    // Set by the EE to scale the allocation quantum used to refill this context: the GC's quantum is
+    // multiplied (or divided for negative values) by 2^alloc_quantum_shift, within limits set by the GC.
+    int            alloc_quantum_shift;
 public:
 
     void init()
@@ -155,6 +165,7 @@ public:
         gc_reserved_1 = 0;
         gc_reserved_2 = 0;
         alloc_count = 0;
+        alloc_quantum_shift = 0;
     }
 };
 
@@ -297,6 +308,70 @@ enum end_no_gc_region_status
     end_no_gc_alloc_exceeded = 3
 };
 
+// The parts a GC pause is broken down into by IGCHeap::GetGCPauseInfo. Time between two phase boundaries
+// is charged to the phase that ends at the second one, so the durations add up to the whole pause.
+enum gc_pause_phase
+{
+    gc_pause_phase_suspend = 0,             // suspending the EE
+    gc_pause_phase_init = 1,                // deciding what to collect and preparing for it
+    gc_pause_phase_mark_stack = 2,          // marking from thread stacks
+    gc_pause_phase_mark_finalization = 3,   // marking from the finalization queue and finding finalizable objects
+    gc_pause_phase_mark_handles = 4,        // marking from strong and dependent handles, nulling weak handles
+    gc_pause_phase_mark_cards = 5,          // marking through cross-generation pointers
+    gc_pause_phase_plan = 6,
+    gc_pause_phase_relocate = 7,
+    gc_pause_phase_compact = 8,
+    gc_pause_phase_sweep = 9,
+    gc_pause_phase_post = 10,               // bookkeeping after the heap has been reorganized
+    gc_pause_phase_resume = 11,             // restarting the EE
+    gc_pause_phase_count = 12
+};
+
+// Describes one pause of the EE for a GC. Background GCs only contribute their initial pause.
+struct gc_pause_info
+{
+    uint64_t gc_index;
+    uint32_t condemned_generation;
+    uint32_t compacting;                                // non-zero if the GC compacted rather than swept
+    uint32_t concurrent;                                // non-zero if the pause started a background GC
+    uint32_t reserved;
+    uint64_t pause_duration_us;
+    uint64_t phase_duration_us[gc_pause_phase_count];
+};
+
+// The dynamic data of one generation when a GC is done, summed over the heaps. size_before, survived and
+// promoted are from the last GC that condemned the generation, which isn't necessarily the one recorded.
+struct gc_generation_data_info
+{
+    uint64_t budget;                                    // bytes the generation may allocate before it is collected
+    uint64_t budget_left;                               // part of the budget not allocated yet
+    uint64_t size_before;                               // bytes of objects when the generation was last collected
+    uint64_t survived;                                  // bytes of those objects that survived
+    uint64_t promoted;                                  // bytes promoted by the marking of that GC
+    uint64_t size_after;                                // bytes of objects now, not counting fragmentation
+    uint64_t fragmentation;                             // free list and free object space
+    uint64_t collection_count;
+};
+
+#define gc_generation_info_generations 5                // gen0, gen1, gen2, LOH and POH
+
+// The state of all the generations when one GC is done, see IGCHeap::GetGenerationInfo.
+struct gc_generation_info
+{
+    uint64_t gc_index;
+    uint32_t condemned_generation;
+    uint32_t concurrent;                                // non-zero for the end of a background GC
+    gc_generation_data_info generations[gc_generation_info_generations];
+};
+
+// Live objects of one type found by the mark phase of the last full GC, see IGCHeap::GetHeapTypeStats.
+struct gc_type_stats
+{
+    void* type;                                         // MethodTable, or null for the types that didn't fit the tables
+    uint64_t count;
+    uint64_t bytes;
+};
+
 typedef enum
 {
     /*
@@ -469,6 +544,10 @@ public:
 
     virtual OBJECTHANDLE CreateDependentHandle(Object* primary, Object* secondary) = 0;
 
+    // Creates count handles of the given type referring to objects[0..count) and stores them in handles.
+    // Either all of the handles are created and true is returned, or none are and false is returned.
+    virtual bool CreateHandlesOfType(Object** objects, HandleType type, OBJECTHANDLE* handles, uint32_t count) = 0;
+
     virtual ~IGCHandleStore() {};
 };
 
@@ -510,6 +589,8 @@ public:
     virtual HandleType HandleFetchType(OBJECTHANDLE handle) = 0;
 
     virtual void TraceRefCountedHandles(HANDLESCANPROC callback, uintptr_t param1, uintptr_t param2) = 0;
+
+    virtual void DestroyHandlesOfUnknownType(const OBJECTHANDLE* handles, uint32_t count) = 0;
 };
 
 // IGCHeap is the interface that the VM will use when interacting with the GC.
@@ -585,6 +666,9 @@ public:
     // Gets the next finalizable object.
     virtual Object* GetNextFinalizable() = 0;
 
+    // Gets up to count of the next finalizable objects and returns how many were stored in objects.
+    virtual uint32_t GetNextFinalizables(Object** objects, uint32_t count) = 0;
+
     // Sets whether or not the GC should report all finalizable objects as
     // ready to be finalized, instead of only collectable objects.
     virtual void SetFinalizeRunOnShutdown(bool value) = 0;
@@ -627,8 +711,10 @@ public:
     virtual void SetLOHCompactionMode(int newLOHCompactionMode) = 0;
 
     // Registers for a full GC notification, raising a notification if the gen 2 or
-    // LOH object heap thresholds are exceeded.
-    virtual bool RegisterForFullGCNotification(uint32_t gen2Percentage, uint32_t lohPercentage) = 0;
+    // LOH object heap thresholds are exceeded, or if less than leadBytes of their
+    // budget is left. The notification is also passed to the EE through
+    // GCToEEInterface::FullGCApproaching.
+    virtual bool RegisterForFullGCNotification(uint32_t gen2Percentage, uint32_t lohPercentage, size_t leadBytes) = 0;
 
     // Cancels a full GC notification that was requested by `RegisterForFullGCNotification`.
     virtual bool CancelFullGCNotification() = 0;
@@ -651,10 +737,11 @@ public:
     virtual int CollectionCount(int generation, int get_bgc_fgc_coutn = 0) = 0;
 
     // Begins a no-GC region, returning a code indicating whether entering the no-GC
-    // region was successful.
+    // region was successful. While one is in progress, nested regions and the regions of
+    // other threads join it if its reservation still covers their allowance.
     virtual int StartNoGCRegion(uint64_t totalSize, bool lohSizeKnown, uint64_t lohSize, bool disallowFullBlockingGC) = 0;
 
-    // Exits a no-GC region.
+    // Exits a no-GC region. The region ends once the last thread in it exits.
     virtual int EndNoGCRegion() = 0;
 
     // Gets the total number of bytes in use.
@@ -878,6 +965,45 @@ public:
     // Enables or disables the given keyword or level on the private event provider.
     virtual void ControlPrivateEvents(GCEventKeyword keyword, GCEventLevel level) = 0;
 
+    /*
+    ===========================================================================
+    Miscellaneous routines used by the EE.
+    ===========================================================================
+    */
+
+    // Gets the number of heaps, which is also the number of GC threads that take part in each phase of
+    // a collection (and so the number of concurrent calls to IGCToCLR::GcScanRoots).
+    virtual int GetNumberOfHeaps() = 0;
+
+    // Copies the records of up to max_count of the most recent GC pauses into pause_info, most recent
+    // first, and returns how many were copied.
+    virtual uint32_t GetGCPauseInfo(gc_pause_info* pause_info, uint32_t max_count) = 0;
+
+    // Copies the snapshots of the generations taken at the end of up to max_count of the most recent GCs
+    // into generation_info, most recent first, and returns how many were copied. Takes no lock.
+    virtual uint32_t GetGenerationInfo(gc_generation_info* generation_info, uint32_t max_count) = 0;
+
+    // With GCTypeStats the mark phase of full GCs counts the live objects and bytes of each type. Copies up
+    // to max_count of the entries of the last full GC, in no particular order, into type_stats and returns
+    // the number of entries there are. gc_index receives the index of that GC, 0 if there was none. Must be
+    // called in cooperative mode so that no GC publishes new entries during the copy.
+    virtual uint32_t GetHeapTypeStats(gc_type_stats* type_stats, uint32_t max_count, uint64_t* gc_index) = 0;
+
+    // Gets the pause target in microseconds, 0 if the GC isn't tuning its budgets for one.
+    virtual uint32_t GetGcPauseTarget() = 0;
+
+    // Sets the pause target in microseconds, 0 turns the tuning off. Returns the previous target.
+    virtual uint32_t SetGcPauseTarget(uint32_t pause_target_us) = 0;
+
+    // Tells the GC the host is idle for a while. When a heap has used GCIdleCollectPercent of its gen1 or
+    // gen0 budget, collects that generation now instead of when the budget runs out. Returns the generation
+    // collected, -1 if none. Must be called in cooperative mode, like GarbageCollect.
+    virtual int NotifyIdle() = 0;
+
+    // Gets the size in bytes from which objects must be allocated on the large object heap. Never less than
+    // LARGE_OBJECT_SIZE, GCLOHThreshold can only raise it.
+    virtual size_t GetLOHThreshold() = 0;
+
     IGCHeap() {}
     virtual ~IGCHeap() {}
 };
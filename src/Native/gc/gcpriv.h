@@ -571,10 +571,12 @@ typedef DPTR(class CFinalize)                  PTR_CFinalize;
 
 //-------------------------------------
 //generation free list. It is an array of free lists bucketed by size, starting at sizes lower than (1 << first_bucket_bits)
-//and doubling each time. The last bucket (index == num_buckets) is for largest sizes with no limit
+//and doubling each time. The last bucket (index == num_buckets) is for largest sizes with no limit.
+//With half steps every power of two range above the first bucket is split in two buckets on the bit below
+//its highest one, so the items of a bucket are within 1.5x of each other and the first fit is closer to the best one.
 
-#define MAX_SOH_BUCKET_COUNT (13)//Max number of buckets for the SOH generations.
-#define MAX_BUCKET_COUNT (20)//Max number of buckets.
+#define MAX_SOH_BUCKET_COUNT (22)//Max number of buckets for the SOH generations.
+#define MAX_BUCKET_COUNT (24)//Max number of buckets.
 class alloc_list
 {
     uint8_t* head;
@@ -602,18 +604,20 @@ class allocator
 {
     int first_bucket_bits;
     unsigned int num_buckets;
+    bool half_steps;
     alloc_list first_bucket;
     alloc_list* buckets;
     alloc_list& alloc_list_of (unsigned int bn);
     size_t& alloc_list_damage_count_of (unsigned int bn);
 
 public:
-    allocator (unsigned int num_b, int fbb, alloc_list* b);
+    allocator (unsigned int num_b, int fbb, alloc_list* b, bool hs = false);
 
     allocator()
     {
         num_buckets = 1;
         first_bucket_bits = sizeof(size_t) * 8 - 1;
+        half_steps = false;
     }
 
     unsigned int number_of_buckets()
@@ -627,21 +631,24 @@ public:
     {
         // sizes taking first_bucket_bits or less are mapped to bucket 0
         // others are mapped to buckets 0, 1, 2 respectively
-        size = (size >> first_bucket_bits) | 1;
+        size_t bucket_size = (size >> first_bucket_bits) | 1;
 
         DWORD highest_set_bit_index;
     #ifdef HOST_64BIT
-        BitScanReverse64(&highest_set_bit_index, size);
+        BitScanReverse64(&highest_set_bit_index, bucket_size);
     #else
-        BitScanReverse(&highest_set_bit_index, size);
+        BitScanReverse(&highest_set_bit_index, bucket_size);
     #endif
 
-        return min ((unsigned int)highest_set_bit_index, num_buckets - 1);
-    }
+        unsigned int bn = (unsigned int)highest_set_bit_index;
+        if (half_steps && (bn != 0))
+        {
+            // [2^n, 1.5*2^n) goes to bucket 2n-1 and [1.5*2^n, 2^(n+1)) to bucket 2n. The bit is taken from
+            // the unshifted size since the low bit of bucket_size is always set.
+            bn = 2 * bn - 1 + (unsigned int)((size >> (first_bucket_bits + bn - 1)) & 1);
+        }
 
-    size_t first_bucket_size()
-    {
-        return ((size_t)1 << (first_bucket_bits + 1));
+        return min (bn, num_buckets - 1);
     }
 
     uint8_t*& alloc_list_head_of (unsigned int bn)
@@ -1001,6 +1008,19 @@ struct snoop_stats_data
 };
 #endif //SNOOP_STATS
 
+#define max_no_gc_participants 64
+
+// A thread inside a no gc region. Nested and overlapping regions share the reservation of the region that
+// started first, each thread may allocate its allowance of SOH bytes from it. Bytes are counted with the
+// alloc_bytes of the thread's allocation context.
+struct no_gc_participant
+{
+    gc_alloc_context* acontext;
+    uint64_t allowance;
+    int64_t start_alloc_bytes;
+    int depth;
+};
+
 struct no_gc_region_info
 {
     size_t soh_allocation_size;
@@ -1013,6 +1033,8 @@ struct no_gc_region_info
     size_t saved_gen0_min_size;
     size_t saved_gen3_min_size;
     BOOL minimal_gc_p;
+    int participant_count;
+    no_gc_participant participants[max_no_gc_participants];
 };
 
 // if you change these, make sure you update them for sos (strike.cpp) as well.
@@ -1035,6 +1057,45 @@ enum interesting_data_point
     max_idp_count
 };
 
+// Objects whose references didn't fit on the mark stack. They are kept in chunks, most recent first, so that
+// process_mark_overflow can finish them without rescanning the address range between the lowest and the
+// highest of them. The range is only used when the chunks would take more than MARK_OVERFLOW_BUDGET.
+#define MARK_OVERFLOW_CHUNK_LENGTH (1022)
+struct mark_overflow_chunk
+{
+    mark_overflow_chunk* next;
+    size_t count;
+    uint8_t* objects[MARK_OVERFLOW_CHUNK_LENGTH];
+};
+
+#ifdef BACKGROUND_GC
+// Marked objects whose references are still to be marked, moved off the mark stack of a BGC thread so that
+// another BGC thread that ran out of work can mark them. See background_mark_share_work.
+#define BGC_MARK_PACKET_LENGTH (256)
+struct bgc_mark_packet
+{
+    bgc_mark_packet* next;
+    size_t count;
+    uint8_t* objects[BGC_MARK_PACKET_LENGTH];
+};
+
+// A thread that helps the BGC thread of workstation GC with concurrent marking. It marks the references of the
+// objects of the packet it took, in, and keeps the objects it marks in out, or publishes out when it is full.
+// current and current_offset are the object it is going through and how far it got, the foreground GC
+// relocates current when it runs while the helper gives it a chance to.
+struct bgc_mark_helper
+{
+    GCEvent start_event;
+    bgc_mark_packet* in;
+    bgc_mark_packet* out;
+    uint8_t* current;
+    size_t current_offset;
+    size_t promoted_bytes;
+    uint8_t* min_overflow_address;
+    uint8_t* max_overflow_address;
+};
+#endif //BACKGROUND_GC
+
 //class definition of the internal class
 class gc_heap
 {
@@ -1123,6 +1184,13 @@ public:
     void verify_free_lists();
     PER_HEAP
     void verify_heap (BOOL begin_gc_p);
+    PER_HEAP
+    void verify_heap_segment (heap_segment* seg, int curr_gen_num, int heap_verify_level,
+                              size_t* total_objects_verified_p, size_t* total_objects_verified_deep_p);
+#ifdef MULTIPLE_HEAPS
+    PER_HEAP_ISOLATED
+    void prepare_parallel_verify_heap();
+#endif //MULTIPLE_HEAPS
 #endif //VERIFY_HEAP
 
     PER_HEAP_ISOLATED
@@ -1185,6 +1253,12 @@ public:
 
     static
     void balance_heaps (alloc_context* acontext);
+    static
+    void adapt_active_heap_count ();
+    static
+    void set_active_heap_count (int new_n_active_heaps);
+    static
+    void rebalance_alloc_context (gc_alloc_context* gc_context, void* param);
     PER_HEAP
     ptrdiff_t get_balance_heaps_uoh_effective_budget (int generation_num);
     static 
@@ -1215,6 +1289,9 @@ public:
     PER_HEAP_ISOLATED
     void do_post_gc();
 
+    PER_HEAP_ISOLATED
+    void refresh_resource_limits();
+
 #ifdef BGC_SERVO_TUNING
     PER_HEAP_ISOLATED
     void check_and_adjust_bgc_tuning (int gen_number, size_t physical_size, ptrdiff_t virtual_fl_size);
@@ -1407,6 +1484,18 @@ protected:
     PER_HEAP_ISOLATED
     end_no_gc_region_status end_no_gc_region();
 
+    PER_HEAP_ISOLATED
+    start_no_gc_region_status join_no_gc_region (uint64_t total_size, BOOL loh_size_known, uint64_t loh_size);
+
+    PER_HEAP_ISOLATED
+    no_gc_participant* add_no_gc_participant (uint64_t allowance);
+
+    PER_HEAP_ISOLATED
+    no_gc_participant* find_no_gc_participant();
+
+    PER_HEAP_ISOLATED
+    uint64_t no_gc_remaining (int gen_number);
+
     PER_HEAP_ISOLATED
     void handle_failure_for_no_gc();
 
@@ -1417,9 +1506,11 @@ protected:
     void fire_etw_pin_object_event (uint8_t* object, uint8_t** ppObject);
 
     PER_HEAP
-    size_t limit_from_size (size_t size, uint32_t flags, size_t room, int gen_number,
+    size_t limit_from_size (size_t size, alloc_context* acontext, uint32_t flags, size_t room, int gen_number,
                             int align_const);
     PER_HEAP
+    size_t alloc_quantum_of (alloc_context* acontext);
+    PER_HEAP
     allocation_state try_allocate_more_space (alloc_context* acontext, size_t jsize, uint32_t flags,
                                               int alloc_generation_number);
     PER_HEAP_ISOLATED
@@ -1975,6 +2066,52 @@ protected:
     void background_mark_simple (uint8_t* o THREAD_NUMBER_DCL);
     PER_HEAP
     void background_mark_simple1 (uint8_t* o THREAD_NUMBER_DCL);
+
+    // Moves the oldest part of the mark stack to a packet other BGC threads can take, when some of them are
+    // waiting for work.
+    PER_HEAP
+    void background_mark_publish_work();
+
+    PER_HEAP_ISOLATED
+    void bgc_mark_pool_enter();
+    PER_HEAP_ISOLATED
+    void bgc_mark_pool_leave();
+    PER_HEAP_ISOLATED
+    bgc_mark_packet* bgc_mark_get_free_packet();
+    PER_HEAP_ISOLATED
+    void bgc_mark_push_packet (bgc_mark_packet* packet);
+    PER_HEAP_ISOLATED
+    void bgc_mark_free_packet (bgc_mark_packet* packet);
+
+    // Opens the window in which the BGC threads, and the mark helpers of workstation GC, share their
+    // concurrent marking work, if there is more than one of them.
+    PER_HEAP_ISOLATED
+    void background_mark_open_sharing();
+
+    // Called by each participant once it's done with its own marking work, marks what the others publish
+    // until none of them have anything left. helper is 0 for BGC threads.
+    PER_HEAP
+    void background_mark_share_work (bgc_mark_helper* helper);
+
+    PER_HEAP_ISOLATED
+    void background_mark_scan_packet (bgc_mark_packet* packet, promote_func* fn, ScanContext* pSC);
+
+#ifndef MULTIPLE_HEAPS
+    PER_HEAP_ISOLATED
+    void create_bgc_mark_helpers();
+    static
+    void bgc_mark_helper_stub (void* arg);
+    PER_HEAP_ISOLATED
+    void bgc_mark_helper_function (bgc_mark_helper* helper);
+    PER_HEAP_ISOLATED
+    void bgc_mark_helper_allow_fgc();
+    PER_HEAP_ISOLATED
+    void bgc_mark_helper_drain (bgc_mark_helper* helper);
+    PER_HEAP_ISOLATED
+    void bgc_mark_helper_push (bgc_mark_helper* helper, uint8_t* o);
+    PER_HEAP_ISOLATED
+    void bgc_mark_wait_for_helpers();
+#endif //!MULTIPLE_HEAPS
     PER_HEAP_ISOLATED
     void background_promote (Object**, ScanContext* , uint32_t);
     PER_HEAP
@@ -2305,6 +2442,12 @@ protected:
     PER_HEAP
     void process_mark_overflow_internal (int condemned_gen_number,
                                          uint8_t* min_address, uint8_t* max_address);
+    PER_HEAP
+    void record_mark_overflow (uint8_t* o);
+    PER_HEAP
+    BOOL process_mark_overflow_chunks();
+    PER_HEAP
+    void release_mark_overflow_chunks();
 
 #ifdef SNOOP_STATS
     PER_HEAP
@@ -2880,7 +3023,7 @@ protected:
                                uint8_t*& last_object, BOOL large_objects_p,
                                size_t& num_marked_objects);
     PER_HEAP
-    void revisit_written_pages (BOOL concurrent_p, BOOL reset_only_p=FALSE);
+    size_t revisit_written_pages (BOOL concurrent_p, BOOL reset_only_p=FALSE);
 
     PER_HEAP
     void concurrent_scan_dependent_handles (ScanContext *sc);
@@ -2900,6 +3043,10 @@ protected:
     PER_HEAP
     void allow_fgc();
 
+    // Called from allow_fgc, makes the BGC thread take breaks when the process gets throttled for its CPU quota.
+    PER_HEAP
+    void bgc_pace_for_cpu_quota();
+
     // Restores BGC settings if necessary.
     PER_HEAP_ISOLATED
     void recover_bgc_settings();
@@ -3085,6 +3232,123 @@ public:
     PER_HEAP
     void add_to_oom_history_per_heap();
 
+#define max_pause_info_history_count 64
+
+    // Ring of the most recent pause records, indexed by pause_info_count modulo its size. pause_info_count
+    // is only bumped once a record is complete so readers outside of a GC can tell which entries are stable.
+    PER_HEAP_ISOLATED
+    gc_pause_info pause_info_history[max_pause_info_history_count];
+
+    PER_HEAP_ISOLATED
+    VOLATILE(uint64_t) pause_info_count;
+
+    // Raw timestamps and per-phase ticks of the pause in progress.
+    PER_HEAP_ISOLATED
+    uint64_t pause_start_ts;
+
+    PER_HEAP_ISOLATED
+    uint64_t pause_phase_start_ts;
+
+    PER_HEAP_ISOLATED
+    uint64_t pause_phase_ticks[gc_pause_phase_count];
+
+    PER_HEAP_ISOLATED
+    bool pause_in_progress_p;
+
+    PER_HEAP_ISOLATED
+    void begin_pause_info();
+
+    // Charges the time since the previous phase boundary to phase. On server GC only heap 0 records, its
+    // timings include waiting for the other heaps at the joins.
+    PER_HEAP_ISOLATED
+    void record_pause_phase (gc_pause_phase phase);
+
+    PER_HEAP_ISOLATED
+    void end_pause_info (bool gc_happened_p);
+
+    PER_HEAP_ISOLATED
+    uint32_t get_pause_info (gc_pause_info* pause_info, uint32_t max_count);
+
+#define max_generation_info_history_count 64
+
+    // Snapshots of the dynamic data of the generations taken by do_post_gc, published through
+    // generation_info_count the same way as the pause records.
+    PER_HEAP_ISOLATED
+    gc_generation_info generation_info_history[max_generation_info_history_count];
+
+    PER_HEAP_ISOLATED
+    VOLATILE(uint64_t) generation_info_count;
+
+    PER_HEAP_ISOLATED
+    void record_generation_info();
+
+    PER_HEAP_ISOLATED
+    uint32_t get_generation_info (gc_generation_info* generation_info, uint32_t max_count);
+
+#define pause_target_shrink_gain 0.5
+#define pause_target_grow_gain 0.1
+#define pause_target_min_budget (256*1024)
+
+    // With a pause target (GCPauseTarget, 0 when off) the budgets of gen0 and gen1 computed by
+    // desired_new_allocation are scaled by pause_target_budget_scale[gen], between 0 and 1. Once a blocking
+    // GC of that generation completes, its pause moves the scale by the pause's distance to the target,
+    // quickly down when over and slowly up when under, so pauses settle just below the target. The scale
+    // accumulates the error the same way the integral term of the bgc_tuning controllers does.
+    PER_HEAP_ISOLATED
+    uint32_t pause_target_us;
+
+    PER_HEAP_ISOLATED
+    double pause_target_budget_scale[max_generation];
+
+    PER_HEAP_ISOLATED
+    void update_pause_target_tuning (gc_pause_info* info);
+
+    // GCIdleCollectPercent, how much of its gen0 or gen1 budget a heap must have used for IGCHeap::NotifyIdle
+    // to collect that generation.
+    PER_HEAP_ISOLATED
+    int idle_collect_percent;
+
+#define type_stats_table_length 4096
+
+    // With GCTypeStats each heap counts the objects its mark threads mark per type in type_stats_table, an
+    // open addressed table of type_stats_table_length entries indexed by a hash of the MethodTable. Once the
+    // table is 3/4 full the remaining types are counted in the extra entry at the end. At the end of the mark
+    // phase of a full blocking GC or a BGC, with the EE suspended, the tables are merged into type_stats_result
+    // and cleared.
+    PER_HEAP_ISOLATED
+    bool type_stats_p;
+
+    // Set for the mark phase of full blocking GCs, BGC marking only checks type_stats_p.
+    PER_HEAP_ISOLATED
+    bool type_stats_in_mark_p;
+
+    PER_HEAP
+    gc_type_stats* type_stats_table;
+
+    PER_HEAP
+    size_t type_stats_table_used;
+
+    PER_HEAP_ISOLATED
+    gc_type_stats* type_stats_result;
+
+    PER_HEAP_ISOLATED
+    size_t type_stats_result_used;
+
+    PER_HEAP_ISOLATED
+    uint64_t type_stats_gc_index;
+
+    PER_HEAP_ISOLATED
+    void add_type_stats (gc_type_stats* table, size_t* used, void* type, uint64_t count, uint64_t bytes);
+
+    PER_HEAP_ISOLATED
+    void record_type_stats (uint8_t* o, size_t s THREAD_NUMBER_DCL);
+
+    PER_HEAP_ISOLATED
+    void publish_type_stats ();
+
+    PER_HEAP_ISOLATED
+    uint32_t get_type_stats (gc_type_stats* type_stats, uint32_t max_count, uint64_t* gc_index);
+
     PER_HEAP
     BOOL expanded_in_fgc;
 
@@ -3171,6 +3435,11 @@ public:
     PER_HEAP_ISOLATED
     uint32_t fgn_loh_percent;
 
+    // Budget left in gen2 or the LOH of a heap below which a full GC
+    // is notified regardless of the percentages.
+    PER_HEAP_ISOLATED
+    size_t fgn_lead_bytes;
+
     PER_HEAP_ISOLATED
     VOLATILE(bool) full_gc_approach_event_set;
 
@@ -3360,6 +3629,89 @@ public:
     PER_HEAP_ISOLATED
     size_t heap_hard_limit;
 
+    // The hard limit derived from the container memory limit at init, 0 if the hard limit was configured or
+    // there is no container limit. refresh_resource_limits never raises heap_hard_limit above it.
+    PER_HEAP_ISOLATED
+    size_t container_heap_hard_limit;
+
+    // Set when total_physical_mem comes from the OS rather than GCTotalPhysicalMemory.
+    PER_HEAP_ISOLATED
+    bool physical_mem_from_os_p;
+
+    // When refresh_resource_limits last re-read the limits, in milliseconds.
+    PER_HEAP_ISOLATED
+    size_t resource_limits_refresh_time;
+
+    // When set, free space is handed back to the OS at a finer granularity than whole segments:
+    // free gaps in gen2 and UOH are reset once they exceed release_free_space_reset_size, the unused
+    // end of segments is decommitted with little slack and empty segments are never hoarded.
+    PER_HEAP_ISOLATED
+    bool release_free_space_p;
+
+    // GCConserveMemory, 0 when off. Once the free space of gen2 or LOH is more than (10 - conserve_mem_setting)
+    // tenths of the generation, the next gen1 GC becomes a blocking full GC that compacts it. It also turns on
+    // release_free_space_p and caps the gen0 budget close to the cache size.
+    PER_HEAP_ISOLATED
+    int conserve_mem_setting;
+
+    // Generations smaller than this, over all heaps, are not compacted for GCConserveMemory.
+#define conserve_mem_min_gen_size (16*1024*1024)
+
+    PER_HEAP_ISOLATED
+    float conserve_mem_frag_limit();
+
+    PER_HEAP_ISOLATED
+    bool conserve_mem_frag_exceeded_p (int gen_number);
+
+    // GCBackgroundDecommit. The memory the GC decommits at the end of segments and the segments it deletes
+    // are queued for the decommit thread instead, which gives them back to the OS decommit_step_size at a time
+    // every decommit_step_interval_ms so the system calls stay out of the pause. virtual_commit decommits the
+    // queued ranges it overlaps right away, that keeps newly committed memory zeroed. Off with a hard limit,
+    // which needs the committed bytes to be exact.
+    PER_HEAP_ISOLATED
+    bool background_decommit_p;
+
+#define decommit_queue_length       256
+#define decommit_step_size          (16*1024*1024)
+#define decommit_step_interval_ms   100
+
+    struct decommit_range
+    {
+        uint8_t* address;
+        // Bytes from address still to decommit.
+        size_t size;
+        // Bytes from address to release once they are decommitted, 0 to keep the range reserved.
+        size_t release_size;
+    };
+
+    // Protects the queue, and the decommit thread holds it while it calls the OS.
+    PER_HEAP_ISOLATED
+    CLRCriticalSection decommit_cs;
+
+    PER_HEAP_ISOLATED
+    GCEvent decommit_event;
+
+    PER_HEAP_ISOLATED
+    decommit_range decommit_queue[decommit_queue_length];
+
+    PER_HEAP_ISOLATED
+    size_t decommit_queue_count;
+
+    PER_HEAP_ISOLATED
+    BOOL create_decommit_thread();
+
+    static
+    void decommit_thread_stub (void* arg);
+
+    PER_HEAP_ISOLATED
+    bool decommit_step();
+
+    PER_HEAP_ISOLATED
+    bool queue_decommit (uint8_t* address, size_t size, size_t release_size);
+
+    PER_HEAP_ISOLATED
+    void flush_queued_decommit (uint8_t* address, size_t size);
+
     PER_HEAP_ISOLATED
     CLRCriticalSection check_commit_cs;
 
@@ -3378,6 +3730,11 @@ public:
     PER_HEAP_ISOLATED
     bool use_large_pages_p;
 
+    // This is if the OS should be asked to back the heap and the GC's own book keeping with
+    // large pages when they get committed. Ranges that can't get them use regular pages.
+    PER_HEAP_ISOLATED
+    bool use_transparent_large_pages_p;
+
 #ifdef HEAP_BALANCE_INSTRUMENTATION
     PER_HEAP_ISOLATED
     size_t last_gc_end_time_ms;
@@ -3657,6 +4014,85 @@ protected:
     PER_HEAP
     size_t     background_uoh_alloc_count;
 
+    // When the process runs under a CPU quota (the CFS bandwidth control of its cgroup) a BGC that runs flat
+    // out can use up the quota of a period, after which the whole process, user threads included, is stopped
+    // until the next period. So while the throttled time of the process keeps growing the BGC threads only
+    // work for bgc_pace_duty_cycle percent of the time and sleep for the rest. The duty cycle is halved each
+    // time throttling is seen and grows back slowly when it isn't.
+    PER_HEAP_ISOLATED
+    bool       bgc_pace_enabled_p;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(uint32_t) bgc_pace_duty_cycle;
+
+    // Held by the BGC thread that reads the throttled time, which it does for all of them.
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) bgc_pace_sampling;
+
+    // Time in ms the throttled time was last read at, and what it was.
+    PER_HEAP_ISOLATED
+    size_t     bgc_pace_last_sample_time;
+    PER_HEAP_ISOLATED
+    uint64_t   bgc_pace_last_throttled_time;
+
+    // Time in ms the BGC thread of this heap started working at since it last slept.
+    PER_HEAP
+    size_t     bgc_pace_slice_start;
+
+    PER_HEAP
+    uint32_t   bgc_pace_call_count;
+
+    // Work sharing for concurrent marking. While bgc_mark_sharing_open is set a BGC thread moves part of its
+    // mark stack to a packet on the full list when more threads are idle than there are packets. Idle threads
+    // take packets from the list, and marking is done when the list is empty and no thread is busy. The pool
+    // is guarded by bgc_mark_pool_lock, which is never held across an allow_fgc, so the foreground GC that
+    // runs during the BGC can scan all the packets as roots.
+    PER_HEAP_ISOLATED
+    bool       bgc_mark_sharing_p;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(bool) bgc_mark_sharing_open;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) bgc_mark_pool_lock;
+
+    PER_HEAP_ISOLATED
+    bgc_mark_packet* bgc_mark_full_packets;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) bgc_mark_full_count;
+
+    PER_HEAP_ISOLATED
+    bgc_mark_packet* bgc_mark_free_packets;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) bgc_mark_idle_count;
+
+    PER_HEAP_ISOLATED
+    int32_t    bgc_mark_busy_count;
+
+    // The packet the BGC thread of this heap is marking the objects of.
+    PER_HEAP
+    bgc_mark_packet* bgc_mark_taken_packet;
+
+#ifndef MULTIPLE_HEAPS
+    PER_HEAP_ISOLATED
+    bgc_mark_helper* bgc_mark_helpers;
+
+    PER_HEAP_ISOLATED
+    int        bgc_mark_helper_count;
+
+    PER_HEAP_ISOLATED
+    bool       bgc_mark_helpers_created_p;
+
+    PER_HEAP_ISOLATED
+    VOLATILE(int32_t) bgc_mark_helpers_active;
+
+    // Set while the helpers mark, the mark array is then updated with interlocked operations.
+    PER_HEAP_ISOLATED
+    VOLATILE(bool) bgc_mark_helpers_running_p;
+#endif //!MULTIPLE_HEAPS
+
     PER_HEAP
     VOLATILE(int32_t) uoh_alloc_thread_count;
 
@@ -3753,6 +4189,12 @@ protected:
     PER_HEAP
     uint8_t*  max_overflow_address;
 
+    PER_HEAP
+    mark_overflow_chunk* mark_overflow_chunks;
+
+    PER_HEAP
+    size_t mark_overflow_chunks_size;
+
 #ifndef MULTIPLE_HEAPS
     PER_HEAP
     uint8_t*  shigh; //keeps track of the highest marked object
@@ -3861,20 +4303,20 @@ protected:
 
 #endif //SYNCHRONIZATION_STATS
 
-#define NUM_LOH_ALIST (7)
-    // bucket 0 contains sizes less than 64*1024
+#define NUM_LOH_ALIST (12)
+    // bucket 0 contains sizes less than 64*1024, the others are half steps up to 2MB
     // the "BITS" number here is the highest bit in 64*1024 - 1, zero-based as in BitScanReverse.
     // see first_suitable_bucket(size_t size) for details.
 #define BASE_LOH_ALIST_BITS (15)
     PER_HEAP
     alloc_list loh_alloc_list[NUM_LOH_ALIST-1];
 
-#define NUM_GEN2_ALIST (12)
+#define NUM_GEN2_ALIST (22)
 #ifdef HOST_64BIT
-    // bucket 0 contains sizes less than 256
+    // bucket 0 contains sizes less than 256, the others are half steps up to 256K
 #define BASE_GEN2_ALIST_BITS (7)
 #else
-    // bucket 0 contains sizes less than 128
+    // bucket 0 contains sizes less than 128, the others are half steps up to 128K
 #define BASE_GEN2_ALIST_BITS (6)
 #endif // HOST_64BIT
     PER_HEAP
@@ -4135,6 +4577,60 @@ public:
     static
     int n_heaps;
 
+#ifdef VERIFY_HEAP
+    // The segments of all heaps, claimed by the GC threads one at a time when they verify the heap
+    struct verify_segment_entry
+    {
+        gc_heap*        hp;
+        heap_segment*   seg;
+        int             gen_num;
+    };
+
+    static
+    verify_segment_entry* verify_segments;
+
+    static
+    int verify_segments_capacity;
+
+    static
+    int verify_segments_count;
+
+    static
+    VOLATILE(int32_t) verify_segments_next;
+
+    static
+    BOOL verify_segments_parallel_p;
+#endif //VERIFY_HEAP
+
+    // Heaps [0, n_active_heaps) are the ones allocation contexts get assigned to. This equals n_heaps
+    // unless GCDynamicHeapCount is enabled; all n_heaps GC threads still take part in every GC.
+    static
+    int n_active_heaps;
+
+    // The most heaps allocations can use, lowered by refresh_resource_limits when the CPU limit shrinks.
+    static
+    int n_max_active_heaps;
+
+    // Set when the heap count wasn't configured, so it follows the CPU limit of the process.
+    static
+    bool heap_count_from_cpu_limit_p;
+
+    // GCDynamicHeapCount state, only updated by heap 0's GC thread at the end of blocking GCs.
+    static
+    bool dynamic_heap_count_p;
+
+    static
+    size_t heap_count_last_gc_end_time;
+
+    static
+    size_t heap_count_gc_time;
+
+    static
+    size_t heap_count_elapsed_time;
+
+    static
+    int heap_count_samples;
+
     static
     gc_heap** g_heaps;
 
@@ -4253,6 +4749,7 @@ private:
     void MoveItem (Object** fromIndex,
                    unsigned int fromSeg,
                    unsigned int toSeg);
+    Object* GetNextFinalizableObjectLocked (BOOL only_non_critical);
 
     inline PTR_PTR_Object& SegQueue (unsigned int Seg)
     {
@@ -4277,6 +4774,7 @@ public:
     void LeaveFinalizeLock();
     bool RegisterForFinalization (int gen, Object* obj, size_t size=0);
     Object* GetNextFinalizableObject (BOOL only_non_critical=FALSE);
+    uint32_t GetNextFinalizableObjects (Object** objects, uint32_t count, BOOL only_non_critical=FALSE);
     BOOL ScanForFinalization (promote_func* fn, int gen,BOOL mark_only_p, gc_heap* hp);
     void RelocateFinalizationData (int gen, gc_heap* hp);
     void WalkFReachableObjects (fq_walk_fn fn);
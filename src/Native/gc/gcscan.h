@@ -21,6 +21,16 @@
 // result we need to maintain a context between all the DH scanning methods called during a single mark phase.
 // The structure below describes this context. We allocate one of these per GC heap at Ref_Initialize time and
 // select between them based on the ScanContext passed to us by the GC during the mark phase.
+//
+// Once the first scan of a mark phase is done, the only handles that can still cause promotions are the ones
+// whose primary was not promoted yet. Those are recorded in a worklist so that re-scans visit just them rather
+// than walking the whole handle table again.
+struct DhPendingHandle
+{
+    Object        **m_pPrimary;                 // Handle slot holding the primary
+    Object        **m_pSecondary;               // Extra info slot holding the secondary
+};
+
 struct DhContext
 {
     bool            m_fUnpromotedPrimaries;     // Did last scan find at least one non-null unpromoted primary?
@@ -29,6 +39,11 @@ struct DhContext
     int             m_iCondemned;               // The condemned generation
     int             m_iMaxGen;                  // The maximum generation
     ScanContext    *m_pScanContext;             // The GC's scan context for this phase
+    bool            m_fCollectPending;          // Is the current table scan recording handles into the worklist?
+    bool            m_fPendingValid;            // Does the worklist hold every handle with an unpromoted primary?
+    DhPendingHandle *m_pPending;                // Worklist of handles with unpromoted primaries
+    size_t          m_cPending;                 // Number of entries in use in m_pPending
+    size_t          m_cPendingMax;              // Number of entries allocated in m_pPending (kept across GCs)
 };
 
 class GCScan
@@ -14,6 +14,8 @@
 #include "gcscan.h"
 #include "gcdesc.h"
 #include "softwarewritewatch.h"
+#include "gcvxsort.h"
+#include "gccardscan.h"
 #include "handletable.h"
 #include "handletable.inl"
 #include "gcenv.inl"
@@ -0,0 +1,174 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+#include "common.h"
+#include "gcenv.h"
+#include "gcvxsort.h"
+
+#ifdef USE_VXSORT
+
+#include <immintrin.h>
+
+// The rest of the GC is compiled for the baseline ISA, so the kernels opt into AVX2/AVX-512 one function
+// at a time. The GC only calls them once the EE has reported the instruction set as usable.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define VXSORT_TARGET_AVX2
+#define VXSORT_TARGET_AVX512
+#else
+#define VXSORT_TARGET_AVX2   __attribute__((target("avx2")))
+#define VXSORT_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// Both kernels use the same in-place scheme. The first and last vector of the range are set aside so
+// that there is always at least one vector worth of free space on either end. Each step reads a vector
+// from whichever end has less free space, and writes the elements that are less than or equal to the
+// pivot to the left end and the rest to the right end. Once fewer than a vector of unread elements is
+// left, the free space is one contiguous gap and the leftovers are placed with scalar code.
+
+static inline size_t vxsort_popcount8(unsigned int mask)
+{
+    mask = mask - ((mask >> 1) & 0x55);
+    mask = (mask & 0x33) + ((mask >> 2) & 0x33);
+    return (mask + (mask >> 4)) & 0x0F;
+}
+
+static uint8_t** vxsort_partition_scalar_tail(uint8_t** write_left, uint8_t** write_right,
+                                              uint8_t** pending, size_t pending_count, uint8_t* pivot)
+{
+    for (size_t i = 0; i < pending_count; i++)
+    {
+        uint8_t* o = pending[i];
+        if (o <= pivot)
+            *write_left++ = o;
+        else
+            *--write_right = o;
+    }
+
+    assert (write_left == write_right);
+    return write_left;
+}
+
+// Permutation for _mm256_permutevar8x32_epi32 that moves the 64-bit lanes whose bit is clear in the
+// comparison mask to the bottom of the vector (in order) and the lanes whose bit is set to the top.
+static const int32_t s_avx2_partition_permutations[16 * 8] =
+{
+    0, 1, 2, 3, 4, 5, 6, 7, // 0000
+    2, 3, 4, 5, 6, 7, 0, 1, // 0001
+    0, 1, 4, 5, 6, 7, 2, 3, // 0010
+    4, 5, 6, 7, 0, 1, 2, 3, // 0011
+    0, 1, 2, 3, 6, 7, 4, 5, // 0100
+    2, 3, 6, 7, 0, 1, 4, 5, // 0101
+    0, 1, 6, 7, 2, 3, 4, 5, // 0110
+    6, 7, 0, 1, 2, 3, 4, 5, // 0111
+    0, 1, 2, 3, 4, 5, 6, 7, // 1000
+    2, 3, 4, 5, 0, 1, 6, 7, // 1001
+    0, 1, 4, 5, 2, 3, 6, 7, // 1010
+    4, 5, 0, 1, 2, 3, 6, 7, // 1011
+    0, 1, 2, 3, 4, 5, 6, 7, // 1100
+    2, 3, 0, 1, 4, 5, 6, 7, // 1101
+    0, 1, 2, 3, 4, 5, 6, 7, // 1110
+    0, 1, 2, 3, 4, 5, 6, 7, // 1111
+};
+
+VXSORT_TARGET_AVX2
+uint8_t** vxsort_partition_avx2(uint8_t** low, uint8_t** high, uint8_t* pivot)
+{
+    const size_t N = sizeof(__m256i) / sizeof(uint8_t*);
+    assert ((size_t)(high - low) >= VXSORT_MIN_PARTITION_SIZE);
+
+    // AVX2 only has a signed 64-bit compare; flipping the sign bit of both sides makes it unsigned.
+    const __m256i sign_bit = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i pivot_vec = _mm256_xor_si256(_mm256_set1_epi64x((int64_t)pivot), sign_bit);
+
+    uint8_t* pending[3 * N];
+    _mm256_storeu_si256((__m256i*)&pending[0], _mm256_loadu_si256((__m256i*)low));
+    _mm256_storeu_si256((__m256i*)&pending[N], _mm256_loadu_si256((__m256i*)(high - N)));
+
+    uint8_t** read_left = low + N;
+    uint8_t** read_right = high - N;
+    uint8_t** write_left = low;
+    uint8_t** write_right = high;
+
+    while ((size_t)(read_right - read_left) >= N)
+    {
+        __m256i v;
+        if ((read_left - write_left) <= (write_right - read_right))
+        {
+            v = _mm256_loadu_si256((__m256i*)read_left);
+            read_left += N;
+        }
+        else
+        {
+            read_right -= N;
+            v = _mm256_loadu_si256((__m256i*)read_right);
+        }
+
+        __m256i greater = _mm256_cmpgt_epi64(_mm256_xor_si256(v, sign_bit), pivot_vec);
+        unsigned int mask = (unsigned int)_mm256_movemask_pd(_mm256_castsi256_pd(greater));
+        __m256i permutation = _mm256_loadu_si256((__m256i*)&s_avx2_partition_permutations[mask * 8]);
+        v = _mm256_permutevar8x32_epi32(v, permutation);
+
+        // The same vector goes to both ends; only the bottom lanes are kept on the left and only the
+        // top lanes on the right, the rest gets overwritten by later steps.
+        size_t greater_count = vxsort_popcount8(mask);
+        _mm256_storeu_si256((__m256i*)write_left, v);
+        _mm256_storeu_si256((__m256i*)(write_right - N), v);
+        write_left += N - greater_count;
+        write_right -= greater_count;
+    }
+
+    size_t pending_count = 2 * N;
+    while (read_left < read_right)
+        pending[pending_count++] = *read_left++;
+
+    return vxsort_partition_scalar_tail(write_left, write_right, pending, pending_count, pivot);
+}
+
+VXSORT_TARGET_AVX512
+uint8_t** vxsort_partition_avx512(uint8_t** low, uint8_t** high, uint8_t* pivot)
+{
+    const size_t N = sizeof(__m512i) / sizeof(uint8_t*);
+    assert ((size_t)(high - low) >= VXSORT_MIN_PARTITION_SIZE);
+
+    const __m512i pivot_vec = _mm512_set1_epi64((int64_t)pivot);
+
+    uint8_t* pending[3 * N];
+    _mm512_storeu_si512(&pending[0], _mm512_loadu_si512(low));
+    _mm512_storeu_si512(&pending[N], _mm512_loadu_si512(high - N));
+
+    uint8_t** read_left = low + N;
+    uint8_t** read_right = high - N;
+    uint8_t** write_left = low;
+    uint8_t** write_right = high;
+
+    while ((size_t)(read_right - read_left) >= N)
+    {
+        __m512i v;
+        if ((read_left - write_left) <= (write_right - read_right))
+        {
+            v = _mm512_loadu_si512(read_left);
+            read_left += N;
+        }
+        else
+        {
+            read_right -= N;
+            v = _mm512_loadu_si512(read_right);
+        }
+
+        __mmask8 greater = _mm512_cmpgt_epu64_mask(v, pivot_vec);
+        size_t greater_count = vxsort_popcount8((unsigned int)greater);
+        _mm512_mask_compressstoreu_epi64(write_left, (__mmask8)~greater, v);
+        _mm512_mask_compressstoreu_epi64(write_right - greater_count, greater, v);
+        write_left += N - greater_count;
+        write_right -= greater_count;
+    }
+
+    size_t pending_count = 2 * N;
+    while (read_left < read_right)
+        pending[pending_count++] = *read_left++;
+
+    return vxsort_partition_scalar_tail(write_left, write_right, pending, pending_count, pivot);
+}
+
+#endif // USE_VXSORT
@@ -0,0 +1,28 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+#ifndef __GC_VXSORT_H__
+#define __GC_VXSORT_H__
+
+// Vectorized partitioning kernels used by the GC to sort large mark lists. The kernels only deal with
+// 64-bit pointers, so they are limited to AMD64.
+#if defined(TARGET_AMD64)
+#define USE_VXSORT
+#endif // TARGET_AMD64
+
+#ifdef USE_VXSORT
+
+// Partitions the elements in [low, high) around "pivot" and returns the boundary: elements before
+// the returned position are less than or equal to "pivot", elements at or after it are greater.
+// The range must hold at least VXSORT_MIN_PARTITION_SIZE elements.
+typedef uint8_t** (*vxsort_partition_func)(uint8_t** low, uint8_t** high, uint8_t* pivot);
+
+#define VXSORT_MIN_PARTITION_SIZE 16
+
+uint8_t** vxsort_partition_avx2(uint8_t** low, uint8_t** high, uint8_t* pivot);
+uint8_t** vxsort_partition_avx512(uint8_t** low, uint8_t** high, uint8_t* pivot);
+
+#endif // USE_VXSORT
+
+#endif // __GC_VXSORT_H__
@@ -12,6 +12,8 @@
 #include "gcscan.h"
 #include "gcdesc.h"
 #include "softwarewritewatch.h"
+#include "gcvxsort.h"
+#include "gccardscan.h"
 #include "handletable.h"
 #include "handletable.inl"
 #include "gcenv.inl"
@@ -419,6 +419,128 @@ void HndDestroyHandleOfUnknownType(HHANDLETABLE hTable, OBJECTHANDLE handle)
     HndDestroyHandle(hTable, HandleFetchType(handle), handle);
 }
 
+
+/*
+ * HndCreateHandles
+ *
+ * Entrypoint for allocating handles in bulk.  The handles don't refer to
+ * anything when they are returned.
+ *
+ * Returns the number of handles that were allocated, which is less than the
+ * number requested only in out-of-memory conditions.
+ *
+ */
+uint32_t HndCreateHandles(HHANDLETABLE hTable, uint32_t uType, OBJECTHANDLE *pHandles, uint32_t uCount)
+{
+    CONTRACTL
+    {
+        NOTHROW;
+        GC_NOTRIGGER;
+        MODE_ANY;
+        CAN_TAKE_LOCK;     // because of TableAllocBulkHandles
+    }
+    CONTRACTL_END;
+
+    // fetch the handle table pointer
+    HandleTable *pTable = Table(hTable);
+
+    // sanity check the type index
+    _ASSERTE(uType < pTable->uTypeCount);
+
+    // keep track of the number of handles we've allocated
+    uint32_t uSatisfied = 0;
+
+    // if this is a large number of handles then bypass the cache, taking the
+    // table lock once for the whole batch instead of going through the cache
+    // for every handle
+    if (uCount > SMALL_ALLOC_COUNT)
+    {
+        CrstHolder ch(&pTable->Lock);
+
+        // allocate handles in bulk from the main handle table
+        uSatisfied = TableAllocBulkHandles(pTable, uType, pHandles, uCount);
+    }
+
+    // do we still need to get some handles?
+    if (uSatisfied < uCount)
+    {
+        // get some handles from the cache
+        uSatisfied += TableAllocHandlesFromCache(pTable, uType, pHandles + uSatisfied, uCount - uSatisfied);
+    }
+
+#if defined(ENABLE_PERF_COUNTERS) || defined(FEATURE_EVENT_TRACE)
+    g_dwHandles += uSatisfied;
+#endif // defined(ENABLE_PERF_COUNTERS) || defined(FEATURE_EVENT_TRACE)
+
+    // return the number of handles we allocated
+    return uSatisfied;
+}
+
+
+/*
+ * HndDestroyHandles
+ *
+ * Entrypoint for freeing handles in bulk.
+ *
+ */
+void HndDestroyHandles(HHANDLETABLE hTable, uint32_t uType, const OBJECTHANDLE *pHandles, uint32_t uCount)
+{
+    CONTRACTL
+    {
+        NOTHROW;
+        GC_NOTRIGGER;
+        MODE_ANY;
+        CAN_TAKE_LOCK;     // because of TableFreeBulkUnpreparedHandles
+    }
+    CONTRACTL_END;
+
+    if (uCount == 0)
+        return;
+
+    // fetch the handle table pointer
+    HandleTable *pTable = Table(hTable);
+
+    // sanity check the type index
+    _ASSERTE(uType < pTable->uTypeCount);
+
+    for (uint32_t u = 0; u < uCount; u++)
+    {
+        _ASSERTE(pHandles[u]);
+        _ASSERTE(HandleFetchType(pHandles[u]) == uType);
+
+        FIRE_EVENT(DestroyGCHandle, (void *)pHandles[u]);
+        FIRE_EVENT(PrvDestroyGCHandle, (void *)pHandles[u]);
+    }
+
+    // is this a small number of handles?
+    if (uCount <= SMALL_ALLOC_COUNT)
+    {
+        // yes - free them via the handle cache
+        TableFreeHandlesToCache(pTable, uType, pHandles, uCount);
+    }
+    else
+    {
+        // no - free them directly to the main handle table under the lock
+        CrstHolder ch(&pTable->Lock);
+
+        // if this handle type has user data then clear it - AFTER the referent is cleared!
+        if (TypeHasUserData(pTable, uType))
+        {
+            for (uint32_t u = 0; u < uCount; u++)
+            {
+                *(_UNCHECKED_OBJECTREF *)pHandles[u] = NULL;
+                HandleQuickSetUserData(pHandles[u], 0L);
+            }
+        }
+
+        TableFreeBulkUnpreparedHandles(pTable, uType, pHandles, uCount);
+    }
+
+#if defined(ENABLE_PERF_COUNTERS) || defined(FEATURE_EVENT_TRACE)
+    g_dwHandles -= uCount;
+#endif // defined(ENABLE_PERF_COUNTERS) || defined(FEATURE_EVENT_TRACE)
+}
+
 /*
  * HndSetHandleExtraInfo
  *
@@ -968,6 +1090,16 @@ uint32_t HndCountHandles(HHANDLETABLE hTable)
         if (*pQuickCache)
             ++uCacheCount;
 
+    // likewise for the per-processor quick caches
+    for (uint32_t uProcessor = 0; uProcessor < HANDLE_PROCESSOR_CACHE_COUNT; uProcessor++)
+    {
+        pQuickCache = pTable->rgProcessorCache[uProcessor].rgQuickCache;
+        pQuickCacheEnd = pQuickCache + HANDLE_MAX_INTERNAL_TYPES;
+        for (; pQuickCache != pQuickCacheEnd; ++pQuickCache)
+            if (*pQuickCache)
+                ++uCacheCount;
+    }
+
     // return the number of handles marked as "used" that are not
     // residing in the cache
     return (uCount - uCacheCount);
@@ -704,6 +704,29 @@ void TableCacheMissOnFree(HandleTable *pTable, HandleTypeCache *pCache, uint32_t
 }
 
 
+/*
+ * TableGetProcessorCache
+ *
+ * Returns the per-processor quick cache of the handle table for the processor
+ * the calling thread is running on, or NULL if the current processor number
+ * can't be determined.
+ *
+ * The thread may be moved to another processor at any point, so the slots of
+ * the returned cache must still be accessed with interlocked operations.
+ *
+ */
+static HandleProcessorCache *TableGetProcessorCache(HandleTable *pTable)
+{
+    LIMITED_METHOD_CONTRACT;
+
+    if (!GCToOSInterface::CanGetCurrentProcessorNumber())
+        return NULL;
+
+    uint32_t uProcessor = GCToOSInterface::GetCurrentProcessorNumber();
+    return pTable->rgProcessorCache + (uProcessor & (HANDLE_PROCESSOR_CACHE_COUNT - 1));
+}
+
+
 /*
  * TableAllocSingleHandleFromCache
  *
@@ -719,7 +742,19 @@ OBJECTHANDLE TableAllocSingleHandleFromCache(HandleTable *pTable, uint32_t uType
     // we use this in two places
     OBJECTHANDLE handle;
 
-    // first try to get a handle from the quick cache
+    // first try to get a handle from this processor's quick cache
+    HandleProcessorCache *pProcessorCache = TableGetProcessorCache(pTable);
+    if (pProcessorCache && pProcessorCache->rgQuickCache[uType])
+    {
+        // try to grab the handle we saw
+        handle = Interlocked::ExchangePointer(pProcessorCache->rgQuickCache + uType, (OBJECTHANDLE)NULL);
+
+        // if it worked then we're done
+        if (handle)
+            return handle;
+    }
+
+    // next try to get a handle from the table's quick cache
     if (pTable->rgQuickCache[uType])
     {
         // try to grab the handle we saw
@@ -787,7 +822,19 @@ void TableFreeSingleHandleToCache(HandleTable *pTable, uint32_t uType, OBJECTHAN
     if (TypeHasUserData(pTable, uType))
         HandleQuickSetUserData(handle, 0L);
 
-    // is there room in the quick cache?
+    // is there room in this processor's quick cache?
+    HandleProcessorCache *pProcessorCache = TableGetProcessorCache(pTable);
+    if (pProcessorCache && !pProcessorCache->rgQuickCache[uType])
+    {
+        // yup - try to stuff our handle in the slot we saw
+        handle = Interlocked::ExchangePointer(&pProcessorCache->rgQuickCache[uType], handle);
+
+        // if we didn't end up with another handle then we're done
+        if (!handle)
+            return;
+    }
+
+    // is there room in the table's quick cache?
     if (!pTable->rgQuickCache[uType])
     {
         // yup - try to stuff our handle in the slot we saw
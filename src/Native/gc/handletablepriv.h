@@ -99,6 +99,10 @@ C_ASSERT (HANDLE_HANDLES_PER_MASK * 2 == HANDLE_HANDLES_PER_BLOCK);
 #define HANDLE_CACHE_TYPE_SIZE          128 // 128 == 63 handles per bank
 #define HANDLES_PER_CACHE_BANK          ((HANDLE_CACHE_TYPE_SIZE / 2) - 1)
 
+// per-processor cache layout metrics
+#define HANDLE_PROCESSOR_CACHE_COUNT    16  // MUST be a power of 2
+#define HANDLE_CACHE_LINE_SIZE          64
+
 // cache policy defines
 #define REBALANCE_TOLERANCE             (HANDLES_PER_CACHE_BANK / 3)
 #define REBALANCE_LOWATER_MARK          (HANDLES_PER_CACHE_BANK - REBALANCE_TOLERANCE)
@@ -338,6 +342,27 @@ struct HandleTypeCache
     int32_t lFreeIndex;
 };
 
+
+/*
+ * Handle Processor Cache
+ *
+ * Defines the layout of a per-processor 'quick' handle cache.
+ */
+struct HandleProcessorCache
+{
+    /*
+     * N.B. a full cache line of padding precedes the slots so that the slots of
+     * neighboring processors never share a cache line, however the table happens
+     * to be aligned
+     */
+    uint8_t rgPadding[HANDLE_CACHE_LINE_SIZE];
+
+    /*
+     * one handle slot per type
+     */
+    OBJECTHANDLE rgQuickCache[HANDLE_MAX_INTERNAL_TYPES];   // interlocked ops used here
+};
+
 /*---------------------------------------------------------------------------*/
 
 
@@ -489,7 +514,8 @@ struct HandleTable
 
     /*
      * number of handles owned by this table that are marked as "used"
-     * (this includes the handles residing in rgMainCache and rgQuickCache)
+     * (this includes the handles residing in rgMainCache, rgQuickCache and
+     * rgProcessorCache)
      */
     uint32_t dwCount;
 
@@ -513,6 +539,13 @@ struct HandleTable
      */
     OBJECTHANDLE rgQuickCache[HANDLE_MAX_INTERNAL_TYPES];   // interlocked ops used here
 
+    /*
+     * per-processor 'quick' handle caches, indexed by the current processor number
+     * (modulo HANDLE_PROCESSOR_CACHE_COUNT) so that threads on different processors
+     * don't contend on the same cache lines
+     */
+    HandleProcessorCache rgProcessorCache[HANDLE_PROCESSOR_CACHE_COUNT];
+
     /*
      * debug-only statistics
      */
@@ -68,40 +68,75 @@ void CALLBACK VariableTraceDispatcher(_UNCHECKED_OBJECTREF *pObjRef, uintptr_t *
 }
 
 #if defined(FEATURE_COMINTEROP) || defined(FEATURE_REDHAWK)
+/*
+ * Objects of ref-counted handles waiting for the EE to decide whether they are promoted.
+ *
+ * The EE is asked about the objects a batch at a time rather than once per handle, so
+ * the per call setup of the callouts is paid once per batch.
+ */
+#define REFCOUNTED_PROMOTE_BATCH_SIZE 256
+
+struct RefCountedPromoteBatch
+{
+    ScanContext *   sc;
+    promote_func *  fn;
+    size_t          cObjects;
+    Object *        rgpObjects[REFCOUNTED_PROMOTE_BATCH_SIZE];
+};
+
+static void FlushRefCountedPromoteBatch(RefCountedPromoteBatch *pBatch)
+{
+    WRAPPER_NO_CONTRACT;
+
+    if (pBatch->cObjects == 0)
+        return;
+
+    size_t cPromoted = GCToEEInterface::RefCountedHandleCallbacksForBatch(pBatch->rgpObjects, pBatch->cObjects);
+    for (size_t i = 0; i < cPromoted; i++)
+    {
+        Object *pObj = pBatch->rgpObjects[i];
+
+#ifdef _DEBUG
+        Object *pOldObj = pObj;
+#endif
+
+        pBatch->fn(&pObj, pBatch->sc, 0);
+
+        // Assert this object wasn't relocated since we are passing a temporary object's address.
+        _ASSERTE(pOldObj == pObj);
+    }
+
+    pBatch->cObjects = 0;
+}
+
 /*
  * Scan callback for tracing ref-counted handles.
  *
  * This callback is called to trace individual objects referred to by handles
- * in the refcounted table.
+ * in the refcounted table. lp1 is the RefCountedPromoteBatch the objects are
+ * added to, the batch is flushed when it is full and after each table is scanned.
  */
 void CALLBACK PromoteRefCounted(_UNCHECKED_OBJECTREF *pObjRef, uintptr_t *pExtraInfo, uintptr_t lp1, uintptr_t lp2)
 {
     WRAPPER_NO_CONTRACT;
     UNREFERENCED_PARAMETER(pExtraInfo);
+    UNREFERENCED_PARAMETER(lp2);
+
+    RefCountedPromoteBatch *pBatch = (RefCountedPromoteBatch *)lp1;
 
     // there are too many races when asynchronously scanning ref-counted handles so we no longer support it
-    _ASSERTE(!((ScanContext*)lp1)->concurrent);
+    _ASSERTE(!pBatch->sc->concurrent);
 
     LOG((LF_GC, LL_INFO1000, LOG_HANDLE_OBJECT_CLASS("", pObjRef, "causes promotion of ", *pObjRef)));
 
     Object *pObj = VolatileLoad((PTR_Object*)pObjRef);
 
-#ifdef _DEBUG
-    Object *pOldObj = pObj;
-#endif
-
     if (!HndIsNullOrDestroyedHandle(pObj) && !g_theGCHeap->IsPromoted(pObj))
     {
-        if (GCToEEInterface::RefCountedHandleCallbacks(pObj))
-        {
-            _ASSERTE(lp2);
-            promote_func* callback = (promote_func*) lp2;
-            callback(&pObj, (ScanContext *)lp1, 0);
-        }
+        pBatch->rgpObjects[pBatch->cObjects++] = pObj;
+        if (pBatch->cObjects == REFCOUNTED_PROMOTE_BATCH_SIZE)
+            FlushRefCountedPromoteBatch(pBatch);
     }
-
-    // Assert this object wasn't relocated since we are passing a temporary object's address.
-    _ASSERTE(pOldObj == pObj);
 }
 #endif // FEATURE_COMINTEROP || FEATURE_REDHAWK
 
@@ -183,6 +218,37 @@ void CALLBACK UpdateDependentHandle(_UNCHECKED_OBJECTREF *pObjRef, uintptr_t *pE
 #endif
 }
 
+// Appends a handle with an unpromoted primary to the dependent handle worklist. If the worklist can't be grown
+// it is abandoned for the rest of this mark phase and re-scans go back to walking the handle table.
+static void AddPendingDependentHandle(DhContext *pDhContext, Object **pPrimaryRef, Object **pSecondaryRef)
+{
+    LIMITED_METHOD_CONTRACT;
+
+    if (pDhContext->m_cPending == pDhContext->m_cPendingMax)
+    {
+        size_t cNewMax = (pDhContext->m_cPendingMax == 0) ? 256 : (pDhContext->m_cPendingMax * 2);
+        DhPendingHandle *pNewPending = new (nothrow) DhPendingHandle[cNewMax];
+        if (pNewPending == NULL)
+        {
+            pDhContext->m_fCollectPending = false;
+            return;
+        }
+
+        if (pDhContext->m_pPending != NULL)
+        {
+            memcpy(pNewPending, pDhContext->m_pPending, pDhContext->m_cPending * sizeof(DhPendingHandle));
+            delete [] pDhContext->m_pPending;
+        }
+
+        pDhContext->m_pPending = pNewPending;
+        pDhContext->m_cPendingMax = cNewMax;
+    }
+
+    DhPendingHandle *pEntry = &pDhContext->m_pPending[pDhContext->m_cPending++];
+    pEntry->m_pPrimary = pPrimaryRef;
+    pEntry->m_pSecondary = pSecondaryRef;
+}
+
 void CALLBACK PromoteDependentHandle(_UNCHECKED_OBJECTREF *pObjRef, uintptr_t *pExtraInfo, uintptr_t lp1, uintptr_t lp2)
 {
     LIMITED_METHOD_CONTRACT;
@@ -218,7 +284,50 @@ void CALLBACK PromoteDependentHandle(_UNCHECKED_OBJECTREF *pObjRef, uintptr_t *p
         // promoted handles, so there's no chance of finding an additional handle being promoted on a
         // subsequent scan).
         pDhContext->m_fUnpromotedPrimaries = true;
+
+        if (pDhContext->m_fCollectPending)
+            AddPendingDependentHandle(pDhContext, pPrimaryRef, pSecondaryRef);
+    }
+}
+
+// Re-scans just the dependent handles on the worklist, promoting the secondaries of the ones whose primary is
+// promoted by now. Those handles are done for this mark phase and are dropped from the worklist; the order of
+// the remaining ones is preserved so that a chain of dependencies declared in table order is still resolved in
+// a single pass.
+static void ScanPendingDependentHandles(DhContext *pDhContext)
+{
+    LIMITED_METHOD_CONTRACT;
+
+    ScanContext *sc = pDhContext->m_pScanContext;
+    promote_func *callback = pDhContext->m_pfnPromoteFunction;
+
+    DhPendingHandle *pPending = pDhContext->m_pPending;
+    size_t cKept = 0;
+    for (size_t i = 0; i < pDhContext->m_cPending; i++)
+    {
+        Object **pPrimaryRef = pPending[i].m_pPrimary;
+        Object **pSecondaryRef = pPending[i].m_pSecondary;
+
+        if (!*pPrimaryRef)
+            continue;
+
+        if (g_theGCHeap->IsPromoted(*pPrimaryRef))
+        {
+            if (!g_theGCHeap->IsPromoted(*pSecondaryRef))
+            {
+                LOG((LF_GC|LF_ENC, LL_INFO10000, "\tPromoting secondary " LOG_OBJECT_CLASS(*pSecondaryRef)));
+                callback(pSecondaryRef, sc, 0);
+                pDhContext->m_fPromoted = true;
+            }
+        }
+        else
+        {
+            pDhContext->m_fUnpromotedPrimaries = true;
+            pPending[cKept++] = pPending[i];
+        }
     }
+
+    pDhContext->m_cPending = cKept;
 }
 
 void CALLBACK ClearDependentHandle(_UNCHECKED_OBJECTREF *pObjRef, uintptr_t *pExtraInfo, uintptr_t /*lp1*/, uintptr_t /*lp2*/)
@@ -639,7 +748,7 @@ bool Ref_Initialize()
 
     // Allocate contexts used during dependent handle promotion scanning. There's one of these for every GC
     // heap since they're scanned in parallel.
-    g_pDependentHandleContexts = new (nothrow) DhContext[n_slots];
+    g_pDependentHandleContexts = new (nothrow) DhContext[n_slots]();
     if (g_pDependentHandleContexts == NULL)
         goto CleanupAndFail;
 
@@ -661,6 +770,12 @@ void Ref_Shutdown()
 
     if (g_pDependentHandleContexts)
     {
+        for (int i = 0; i < getNumberOfSlots(); i++)
+        {
+            if (g_pDependentHandleContexts[i].m_pPending != NULL)
+                delete [] g_pDependentHandleContexts[i].m_pPending;
+        }
+
         delete [] g_pDependentHandleContexts;
         g_pDependentHandleContexts = NULL;
     }
@@ -1073,6 +1188,11 @@ void Ref_TraceNormalRoots(uint32_t condemned, uint32_t maxgen, ScanContext* sc,
         // promote ref-counted handles
         uint32_t type = HNDTYPE_REFCOUNTED;
 
+        RefCountedPromoteBatch batch;
+        batch.sc = sc;
+        batch.fn = fn;
+        batch.cObjects = 0;
+
         walk = &g_HandleTableMap;
         while (walk) {
             for (uint32_t i = 0; i < INITIAL_HANDLE_TABLE_ARRAY_SIZE; i ++)
@@ -1080,7 +1200,10 @@ void Ref_TraceNormalRoots(uint32_t condemned, uint32_t maxgen, ScanContext* sc,
                 {
                     HHANDLETABLE hTable = walk->pBuckets[i]->pTable[getSlotNumber(sc)];
                     if (hTable)
-                        HndScanHandlesForGC(hTable, PromoteRefCounted, uintptr_t(sc), uintptr_t(fn), &type, 1, condemned, maxgen, flags );
+                    {
+                        HndScanHandlesForGC(hTable, PromoteRefCounted, uintptr_t(&batch), 0, &type, 1, condemned, maxgen, flags );
+                        FlushRefCountedPromoteBatch(&batch);
+                    }
                 }
             walk = walk->pNext;
         }
@@ -1220,6 +1343,21 @@ bool Ref_ScanDependentHandlesForPromotion(DhContext *pDhContext)
         pDhContext->m_fUnpromotedPrimaries = false;
         pDhContext->m_fPromoted = false;
 
+        if (pDhContext->m_fPendingValid)
+        {
+            ScanPendingDependentHandles(pDhContext);
+
+            if (pDhContext->m_fPromoted)
+                fAnyPromotions = true;
+
+            continue;
+        }
+
+        // Record the handles whose primary is not promoted while walking the table. Handles can be freed
+        // and reused while a concurrent scan is running, so the worklist is only used when the EE is suspended.
+        pDhContext->m_fCollectPending = !pDhContext->m_pScanContext->concurrent;
+        pDhContext->m_cPending = 0;
+
         HandleTableMap *walk = &g_HandleTableMap;
         while (walk)
         {
@@ -1244,6 +1382,9 @@ bool Ref_ScanDependentHandlesForPromotion(DhContext *pDhContext)
             walk = walk->pNext;
         }
 
+        pDhContext->m_fPendingValid = pDhContext->m_fCollectPending;
+        pDhContext->m_fCollectPending = false;
+
         if (pDhContext->m_fPromoted)
             fAnyPromotions = true;
 
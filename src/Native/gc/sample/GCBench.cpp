@@ -0,0 +1,1368 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// GCBench.cpp
+//
+
+//
+//  Benchmark scenarios for measuring GC changes without the rest of the runtime. A scenario runs the same
+//  amount of work on each of a number of threads, so that runs of different GC builds or settings can be
+//  compared. Each thread first builds the objects the scenario starts from, then a full GC is done and the
+//  measurement starts once all threads are ready. At the end the sample reports:
+//
+//  * Allocation throughput
+//  * GC counts and pause percentiles, where a pause is the time from SuspendEE to RestartEE
+//  * Peak working set of the process, including the setup of the scenario
+//
+//  Usage: gcsample -scenario:<name> [-threads:<n>] [-iterations:<n>] [-gc:wks|bgc|svr|svrbgc] [-heaps:<n>]
+//                  [-config:<GC config key>=<value>]... [-trace:<events file>]
+//
+//  -iterations is the number of steps of the scenario done by each thread, -heaps the number of server GC
+//  heaps and -config sets any of the configuration keys of gcconfig.h, such as GCgen0size. The replay
+//  scenario replays the events file of the runtime given by -trace, once per iteration.
+//
+
+#include "common.h"
+
+#include "windows.h"
+#include "psapi.h"
+
+#include "gcenv.h"
+
+#include "gc.h"
+#include "objecthandle.h"
+
+#include "gcdesc.h"
+
+#include "GCBench.h"
+
+//
+// Object layouts used by the scenarios
+//
+
+class Node : public Object
+{
+public:
+    Object * m_pLeft;
+    Object * m_pRight;
+    uintptr_t m_payload;
+};
+
+template <size_t NumSeries>
+struct MethodTableWithGCDesc
+{
+    // GCDesc
+    CGCDescSeries m_series[NumSeries];
+    size_t m_numSeries;
+
+    // The actual methodtable
+    MethodTable m_MT;
+};
+
+static MethodTableWithGCDesc<1> s_nodeMT;
+static MethodTableWithGCDesc<1> s_refArrayMT;
+static MethodTable s_byteArrayMT;
+
+// Arrays are the object header, the methodtable and the length padded to a pointer, followed by the elements
+static const uint32_t ArrayBaseSize = 3 * sizeof(void *);
+static const size_t ArrayElementsOffset = ArrayBaseSize - sizeof(ObjHeader);
+
+static void InitializeTypes()
+{
+    uint32_t nodeBaseSize = sizeof(Node) + sizeof(ObjHeader);
+    s_nodeMT.m_MT.m_baseSize = max(nodeBaseSize, (uint32_t)MIN_OBJECT_SIZE);
+    s_nodeMT.m_MT.m_componentSize = 0;
+    s_nodeMT.m_MT.m_flags = MTFlag_ContainsPointers;
+    s_nodeMT.m_numSeries = 1;
+    s_nodeMT.m_series[0].SetSeriesOffset(offsetof(Node, m_pLeft));
+    s_nodeMT.m_series[0].SetSeriesCount(2);
+    s_nodeMT.m_series[0].seriessize -= s_nodeMT.m_MT.m_baseSize;
+
+    // The series of an array covers everything past the base size, whatever the length is
+    s_refArrayMT.m_MT.m_baseSize = ArrayBaseSize;
+    s_refArrayMT.m_MT.m_componentSize = sizeof(Object *);
+    s_refArrayMT.m_MT.m_flags = MTFlag_ContainsPointers | MTFlag_HasComponentSize | MTFlag_IsArray;
+    s_refArrayMT.m_numSeries = 1;
+    s_refArrayMT.m_series[0].SetSeriesOffset(ArrayElementsOffset);
+    s_refArrayMT.m_series[0].SetSeriesSize(0 - (size_t)ArrayBaseSize);
+
+    s_byteArrayMT.m_baseSize = ArrayBaseSize;
+    s_byteArrayMT.m_componentSize = 1;
+    s_byteArrayMT.m_flags = MTFlag_HasComponentSize | MTFlag_IsArray;
+}
+
+//
+// Per thread state. Objects are only kept alive through m_roots, which the GC reports as the roots of the
+// thread, or through handles. Object pointers held anywhere else are stale after an allocation or a poll.
+//
+
+#define WORKER_ROOT_COUNT 16
+
+struct WorkerState
+{
+    Object * m_roots[WORKER_ROOT_COUNT];
+    uint32_t m_index;
+    uint32_t m_random;
+    uint64_t m_bytesAllocated;
+    uint64_t m_objectsAllocated;
+    bool m_fSucceeded;
+};
+
+static uint32_t NextRandom(WorkerState * pState)
+{
+    // xorshift32, seeded per thread so that runs are repeatable
+    uint32_t x = pState->m_random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pState->m_random = x;
+    return x;
+}
+
+static Object * Allocate(WorkerState * pState, MethodTable * pMT, size_t size, uint32_t flags)
+{
+    alloc_context * acontext = GetThread()->GetAllocContext();
+    Object * pObject;
+
+    size = (size + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+    if (size >= LARGE_OBJECT_SIZE)
+        flags |= GC_ALLOC_LARGE_OBJECT_HEAP;
+
+    uint8_t* result = acontext->alloc_ptr;
+    uint8_t* advance = result + size;
+    if (((flags & GC_ALLOC_USER_OLD_HEAP) == 0) && (advance <= acontext->alloc_limit))
+    {
+        acontext->alloc_ptr = advance;
+        pObject = (Object *)result;
+    }
+    else
+    {
+        pObject = g_theGCHeap->Alloc(acontext, size, flags);
+        if (pObject == NULL)
+            return NULL;
+    }
+
+    pObject->RawSetMethodTable(pMT);
+
+    // Objects of the large and pinned object heaps can only be seen by a background GC once they have a
+    // methodtable
+    if (flags & GC_ALLOC_USER_OLD_HEAP)
+        g_theGCHeap->PublishObject((uint8_t*)pObject);
+
+    pState->m_bytesAllocated += size;
+    pState->m_objectsAllocated++;
+
+    return pObject;
+}
+
+static Object * AllocateNode(WorkerState * pState)
+{
+    return Allocate(pState, &s_nodeMT.m_MT, s_nodeMT.m_MT.m_baseSize, GC_ALLOC_CONTAINS_REF);
+}
+
+static Object * AllocateArray(WorkerState * pState, MethodTable * pMT, uint32_t length, uint32_t flags)
+{
+    Object * pArray = Allocate(pState, pMT, pMT->m_baseSize + (size_t)length * pMT->m_componentSize, flags);
+    if (pArray != NULL)
+        *(uint32_t *)((uint8_t *)pArray + ArrayBase::GetOffsetOfNumComponents()) = length;
+    return pArray;
+}
+
+static Object ** GetArrayElements(Object * pArray)
+{
+    return (Object **)((uint8_t *)pArray + ArrayElementsOffset);
+}
+
+static OBJECTHANDLE CreateHandle(Object * pObject, HandleType type)
+{
+    return HndCreateHandle(g_HandleTableMap.pBuckets[0]->pTable[GetCurrentThreadHomeHeapNumber()], type, pObject);
+}
+
+//
+// Scenarios
+//
+
+// alloc: short lived small objects of a few sizes
+static bool RunAlloc(WorkerState * pState, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        Object * pNode = AllocateNode(pState);
+        if (pNode == NULL)
+            return false;
+        pState->m_roots[0] = pNode;
+
+        if ((i % 4) == 0)
+        {
+            if (AllocateArray(pState, &s_byteArrayMT, NextRandom(pState) % 256, 0) == NULL)
+                return false;
+        }
+
+        GCPoll();
+    }
+
+    return true;
+}
+
+// survival: a graph of long lived nodes, each pointing at another one. One node in eight replaces a random
+// node of the graph, so the graph keeps surviving into gen2 and slowly dies there.
+#define SURVIVAL_NODE_COUNT (128 * 1024)
+
+static bool SetupSurvival(WorkerState * pState)
+{
+    pState->m_roots[0] = AllocateArray(pState, &s_refArrayMT.m_MT, SURVIVAL_NODE_COUNT, GC_ALLOC_CONTAINS_REF);
+    if (pState->m_roots[0] == NULL)
+        return false;
+
+    for (uint32_t i = 0; i < SURVIVAL_NODE_COUNT; i++)
+    {
+        pState->m_roots[1] = AllocateNode(pState);
+        if (pState->m_roots[1] == NULL)
+            return false;
+
+        Object ** pNodes = GetArrayElements(pState->m_roots[0]);
+        if (i > 0)
+            WriteBarrier(&((Node *)pState->m_roots[1])->m_pLeft, pNodes[NextRandom(pState) % i]);
+        WriteBarrier(&pNodes[i], pState->m_roots[1]);
+
+        GCPoll();
+    }
+
+    return true;
+}
+
+static bool RunSurvival(WorkerState * pState, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        pState->m_roots[1] = AllocateNode(pState);
+        if (pState->m_roots[1] == NULL)
+            return false;
+
+        if ((i % 8) == 0)
+        {
+            Object ** pNodes = GetArrayElements(pState->m_roots[0]);
+            WriteBarrier(&((Node *)pState->m_roots[1])->m_pLeft, pNodes[NextRandom(pState) % SURVIVAL_NODE_COUNT]);
+            WriteBarrier(&pNodes[NextRandom(pState) % SURVIVAL_NODE_COUNT], pState->m_roots[1]);
+        }
+
+        GCPoll();
+    }
+
+    return true;
+}
+
+// loh: large arrays of up to five times the large object threshold, the last eight of which are kept alive
+static bool RunLoh(WorkerState * pState, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        uint32_t length = (uint32_t)LARGE_OBJECT_SIZE + NextRandom(pState) % (4 * (uint32_t)LARGE_OBJECT_SIZE);
+        Object * pArray = AllocateArray(pState, &s_byteArrayMT, length, 0);
+        if (pArray == NULL)
+            return false;
+        pState->m_roots[i % 8] = pArray;
+
+        GCPoll();
+    }
+
+    return true;
+}
+
+// pinning: short lived arrays, one in sixteen of which is pinned by a handle for the next thousand arrays,
+// and arrays on the pinned object heap kept alive for a while
+#define PINNED_HANDLE_COUNT 64
+
+static bool RunPinning(WorkerState * pState, uint32_t iterations)
+{
+    OBJECTHANDLE pinnedHandles[PINNED_HANDLE_COUNT] = {};
+    bool fSucceeded = true;
+
+    for (uint32_t i = 0; fSucceeded && (i < iterations); i++)
+    {
+        pState->m_roots[0] = AllocateArray(pState, &s_byteArrayMT, 16 + NextRandom(pState) % 1024, 0);
+        if (pState->m_roots[0] == NULL)
+        {
+            fSucceeded = false;
+            break;
+        }
+
+        if ((i % 16) == 0)
+        {
+            uint32_t slot = (i / 16) % PINNED_HANDLE_COUNT;
+            if (pinnedHandles[slot] != NULL)
+                HndDestroyHandle(HndGetHandleTable(pinnedHandles[slot]), HNDTYPE_PINNED, pinnedHandles[slot]);
+
+            pinnedHandles[slot] = CreateHandle(pState->m_roots[0], HNDTYPE_PINNED);
+            fSucceeded = (pinnedHandles[slot] != NULL);
+        }
+
+        if ((i % 256) == 0)
+        {
+            Object * pPinnedArray = AllocateArray(pState, &s_byteArrayMT, NextRandom(pState) % 4096, GC_ALLOC_PINNED_OBJECT_HEAP);
+            if (pPinnedArray == NULL)
+                fSucceeded = false;
+            pState->m_roots[1 + (i / 256) % 8] = pPinnedArray;
+        }
+
+        GCPoll();
+    }
+
+    for (uint32_t slot = 0; slot < PINNED_HANDLE_COUNT; slot++)
+    {
+        if (pinnedHandles[slot] != NULL)
+            HndDestroyHandle(HndGetHandleTable(pinnedHandles[slot]), HNDTYPE_PINNED, pinnedHandles[slot]);
+    }
+
+    return fSucceeded;
+}
+
+// handles: a node per step, stored in a strong or a weak handle that replaces a random one of a thousand
+#define CHURNED_HANDLE_COUNT 1024
+
+static HandleType GetChurnedHandleType(uint32_t slot)
+{
+    return ((slot % 2) == 0) ? HNDTYPE_DEFAULT : HNDTYPE_WEAK_DEFAULT;
+}
+
+static bool RunHandles(WorkerState * pState, uint32_t iterations)
+{
+    OBJECTHANDLE * pHandles = new (nothrow) OBJECTHANDLE[CHURNED_HANDLE_COUNT];
+    if (pHandles == NULL)
+        return false;
+    memset(pHandles, 0, sizeof(OBJECTHANDLE) * CHURNED_HANDLE_COUNT);
+
+    bool fSucceeded = true;
+
+    for (uint32_t i = 0; fSucceeded && (i < iterations); i++)
+    {
+        pState->m_roots[0] = AllocateNode(pState);
+        if (pState->m_roots[0] == NULL)
+        {
+            fSucceeded = false;
+            break;
+        }
+
+        uint32_t slot = NextRandom(pState) % CHURNED_HANDLE_COUNT;
+        if (pHandles[slot] != NULL)
+            HndDestroyHandle(HndGetHandleTable(pHandles[slot]), GetChurnedHandleType(slot), pHandles[slot]);
+
+        pHandles[slot] = CreateHandle(pState->m_roots[0], GetChurnedHandleType(slot));
+        fSucceeded = (pHandles[slot] != NULL);
+
+        GCPoll();
+    }
+
+    for (uint32_t slot = 0; slot < CHURNED_HANDLE_COUNT; slot++)
+    {
+        if (pHandles[slot] != NULL)
+            HndDestroyHandle(HndGetHandleTable(pHandles[slot]), GetChurnedHandleType(slot), pHandles[slot]);
+    }
+
+    delete[] pHandles;
+    return fSucceeded;
+}
+
+// cards: old nodes, made gen2 by the GC before the measurement, each step storing a new node into a random
+// one of them, so that ephemeral GCs find their roots through the card table
+#define CARDS_NODE_COUNT (64 * 1024)
+
+static bool SetupCards(WorkerState * pState)
+{
+    pState->m_roots[0] = AllocateArray(pState, &s_refArrayMT.m_MT, CARDS_NODE_COUNT, GC_ALLOC_CONTAINS_REF);
+    if (pState->m_roots[0] == NULL)
+        return false;
+
+    for (uint32_t i = 0; i < CARDS_NODE_COUNT; i++)
+    {
+        pState->m_roots[1] = AllocateNode(pState);
+        if (pState->m_roots[1] == NULL)
+            return false;
+
+        WriteBarrier(&GetArrayElements(pState->m_roots[0])[i], pState->m_roots[1]);
+
+        GCPoll();
+    }
+
+    return true;
+}
+
+static bool RunCards(WorkerState * pState, uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        pState->m_roots[1] = AllocateNode(pState);
+        if (pState->m_roots[1] == NULL)
+            return false;
+
+        Node * pOldNode = (Node *)GetArrayElements(pState->m_roots[0])[NextRandom(pState) % CARDS_NODE_COUNT];
+        WriteBarrier(((i % 2) == 0) ? &pOldNode->m_pLeft : &pOldNode->m_pRight, pState->m_roots[1]);
+
+        GCPoll();
+    }
+
+    return true;
+}
+
+// replay: the allocations and handles recorded by the event session of the runtime, with keywords
+// EVENT_SESSION_KEYWORD_GC | EVENT_SESSION_KEYWORD_ALLOC_TRACE (0x11), see Runtime/EventSession.h. The trace
+// has the size and the flags of the allocations that left the allocation helpers, how much each thread
+// allocated from its allocation context in between, and the heap statistics of every GC. Objects get
+// retained with the survival rate of gen0 measured by the next recorded GC, in the order they were allocated,
+// up to the heap size that GC saw. The threads of the trace are spread over the threads of the sample and
+// each iteration replays the whole trace.
+//
+// The types of the objects are not recorded, so an object is a reference array or a byte array of its size
+// and the allocations from the allocation contexts are byte arrays.
+
+// Layouts of the events file, see EventSession.h of the runtime
+#define TRACE_MAGIC                     0x54534545
+#define TRACE_VERSION                   1
+#define TRACE_EVENT_GC_START            1
+#define TRACE_EVENT_GC_HEAP_STATS       3
+#define TRACE_EVENT_ALLOCATION          13
+#define TRACE_EVENT_HANDLE_CREATED      14
+#define TRACE_EVENT_HANDLE_DESTROYED    15
+
+struct TraceHeader
+{
+    uint32_t m_magic;
+    uint32_t m_version;
+    uint64_t m_tickFrequency;
+    uint64_t m_startTimeStamp;
+    uint32_t m_processId;
+    uint32_t m_pointerSize;
+};
+
+struct TraceBufferHeader
+{
+    uint64_t m_threadId;
+    uint32_t m_cbEvents;
+    uint32_t m_padding;
+};
+
+struct TraceEventHeader
+{
+    uint16_t m_id;
+    uint16_t m_cbPayload;
+    uint32_t m_padding;
+    uint64_t m_timeStamp;
+};
+
+struct TraceGCStart
+{
+    uint32_t m_count;
+    uint32_t m_depth;
+    uint32_t m_reason;
+    uint32_t m_type;
+};
+
+struct TraceGCHeapStats
+{
+    uint64_t m_generationSize[5];
+    uint64_t m_totalPromotedSize[5];
+};
+
+struct TraceAllocation
+{
+    uint64_t m_allocatedBytes;
+    uint64_t m_size;
+    uint32_t m_flags;
+    uint32_t m_padding;
+};
+
+struct TraceHandle
+{
+    uint64_t m_handle;
+    uint32_t m_type;
+    uint32_t m_padding;
+};
+
+enum ReplayOpKind
+{
+    ReplayOp_None,
+    ReplayOp_Allocate,
+    ReplayOp_CreateHandle,
+    ReplayOp_DestroyHandle,
+};
+
+struct ReplayOp
+{
+    uint64_t m_timeStamp;
+    uint64_t m_value;               // Recorded handle, then the slot of the handle, or AllocatedBytes
+    uint64_t m_size;                // Allocations
+    uint64_t m_fillerBytes;         // Allocations, bytes allocated from the context since the previous one
+    uint64_t m_retainedBytes;       // Allocations, heap size seen by the next GC
+    uint32_t m_flags;               // Allocations, GC_ALLOC_* flags, or the HandleType of handles
+    uint32_t m_survival;            // Allocations, chance of surviving out of 65536
+    uint32_t m_thread;              // Index of the recorded thread
+    uint32_t m_sequence;            // Order in the file, for a stable sort
+    uint16_t m_kind;                // ReplayOpKind
+};
+
+struct ReplayGC
+{
+    uint64_t m_timeStamp;
+    uint64_t m_promotedBytes;       // Promoted out of gen0
+    uint64_t m_heapSize;            // Size of all generations after the GC
+};
+
+static ReplayOp * s_pReplayOps;
+static uint32_t s_cReplayOps;
+static uint32_t s_cReplayThreads;
+static uint32_t s_cReplayAllocations;
+static uint32_t s_cReplayHandles;
+static uint32_t s_recordedCollections[max_generation + 1];
+static uint64_t s_recordedHeapSize;
+
+// Handles replayed so far, by slot. A slot is destroyed once, which can happen on another thread before the
+// handle gets created.
+#define DESTROYED_HANDLE ((OBJECTHANDLE)(uintptr_t)1)
+static OBJECTHANDLE * s_pReplayHandles;
+
+static uint32_t s_cWorkers;
+static int32_t s_cReplayBarrier;
+static bool s_fReplayFailed;
+
+#define REPLAY_RETAINED_COUNT (64 * 1024)
+#define REPLAY_FILLER_SIZE (8 * 1024)
+
+// The retained objects of a thread are a ring in the reference array m_roots[0], oldest first
+struct ReplayWorker
+{
+    uint32_t * m_pRetainedSizes;
+    uint32_t m_firstRetained;
+    uint32_t m_cRetained;
+    uint64_t m_retainedBytes;
+    uint64_t m_pendingFillerBytes;
+};
+
+static ReplayWorker * s_pReplayWorkers;
+
+static int __cdecl CompareReplayOps(const void * pFirst, const void * pSecond)
+{
+    const ReplayOp * pFirstOp = (const ReplayOp *)pFirst;
+    const ReplayOp * pSecondOp = (const ReplayOp *)pSecond;
+    if (pFirstOp->m_timeStamp != pSecondOp->m_timeStamp)
+        return (pFirstOp->m_timeStamp < pSecondOp->m_timeStamp) ? -1 : 1;
+    return (pFirstOp->m_sequence < pSecondOp->m_sequence) ? -1 : ((pFirstOp->m_sequence > pSecondOp->m_sequence) ? 1 : 0);
+}
+
+// Handle operations sorted by the recorded handle, in the order they happened
+static int __cdecl CompareHandleOps(const void * pFirst, const void * pSecond)
+{
+    uint32_t first = *(const uint32_t *)pFirst;
+    uint32_t second = *(const uint32_t *)pSecond;
+    if (s_pReplayOps[first].m_value != s_pReplayOps[second].m_value)
+        return (s_pReplayOps[first].m_value < s_pReplayOps[second].m_value) ? -1 : 1;
+    return (first < second) ? -1 : ((first > second) ? 1 : 0);
+}
+
+static int __cdecl CompareReplayGCs(const void * pFirst, const void * pSecond)
+{
+    uint64_t first = ((const ReplayGC *)pFirst)->m_timeStamp;
+    uint64_t second = ((const ReplayGC *)pSecond)->m_timeStamp;
+    return (first < second) ? -1 : ((first > second) ? 1 : 0);
+}
+
+static bool ReadTraceFile(const char * path, uint8_t ** ppData, size_t * pcbData)
+{
+    FILE * pFile = fopen(path, "rb");
+    if (pFile == NULL)
+        return false;
+
+    bool fSucceeded = false;
+    if (fseek(pFile, 0, SEEK_END) == 0)
+    {
+        long cbFile = ftell(pFile);
+        if ((cbFile > 0) && (fseek(pFile, 0, SEEK_SET) == 0))
+        {
+            *ppData = new (nothrow) uint8_t[(size_t)cbFile];
+            *pcbData = (size_t)cbFile;
+            fSucceeded = (*ppData != NULL) && (fread(*ppData, 1, (size_t)cbFile, pFile) == (size_t)cbFile);
+        }
+    }
+
+    fclose(pFile);
+    return fSucceeded;
+}
+
+// Walks the events of the trace. The first walk, with pOps NULL, only counts the buffers, the operations to
+// replay and the GCs.
+static void ParseTrace(const uint8_t * pData, size_t cbData, ReplayOp * pOps, ReplayGC * pGCs, uint64_t * pThreadIds,
+                       uint32_t * pcBuffers, uint32_t * pcOps, uint32_t * pcGCs)
+{
+    uint32_t cBuffers = 0;
+    uint32_t cOps = 0;
+    uint32_t cGCs = 0;
+
+    size_t offset = sizeof(TraceHeader);
+    while (offset + sizeof(TraceBufferHeader) <= cbData)
+    {
+        const TraceBufferHeader * pBuffer = (const TraceBufferHeader *)(pData + offset);
+        offset += sizeof(TraceBufferHeader);
+        if (pBuffer->m_cbEvents > cbData - offset)
+            break;
+
+        size_t eventOffset = offset;
+        size_t endOffset = offset + pBuffer->m_cbEvents;
+        offset = endOffset;
+        cBuffers++;
+
+        // Buffers of the same thread get the same index
+        uint32_t thread = 0;
+        if (pOps != NULL)
+        {
+            while ((thread < s_cReplayThreads) && (pThreadIds[thread] != pBuffer->m_threadId))
+                thread++;
+            if (thread == s_cReplayThreads)
+                pThreadIds[s_cReplayThreads++] = pBuffer->m_threadId;
+        }
+
+        while (eventOffset + sizeof(TraceEventHeader) <= endOffset)
+        {
+            const TraceEventHeader * pEvent = (const TraceEventHeader *)(pData + eventOffset);
+            const uint8_t * pPayload = (const uint8_t *)(pEvent + 1);
+            eventOffset += (sizeof(TraceEventHeader) + pEvent->m_cbPayload + 7) & ~(size_t)7;
+            if (eventOffset > endOffset)
+                break;
+
+            if ((pEvent->m_id == TRACE_EVENT_GC_START) && (pEvent->m_cbPayload >= sizeof(TraceGCStart)))
+            {
+                uint32_t depth = ((const TraceGCStart *)pPayload)->m_depth;
+                if ((pOps != NULL) && (depth <= max_generation))
+                    s_recordedCollections[depth]++;
+            }
+            else if ((pEvent->m_id == TRACE_EVENT_GC_HEAP_STATS) && (pEvent->m_cbPayload >= sizeof(TraceGCHeapStats)))
+            {
+                if (pOps != NULL)
+                {
+                    const TraceGCHeapStats * pStats = (const TraceGCHeapStats *)pPayload;
+                    pGCs[cGCs].m_timeStamp = pEvent->m_timeStamp;
+                    pGCs[cGCs].m_promotedBytes = pStats->m_totalPromotedSize[0];
+                    pGCs[cGCs].m_heapSize = 0;
+                    for (int gen = 0; gen < 5; gen++)
+                        pGCs[cGCs].m_heapSize += pStats->m_generationSize[gen];
+                }
+                cGCs++;
+            }
+            else if (((pEvent->m_id == TRACE_EVENT_ALLOCATION) && (pEvent->m_cbPayload >= sizeof(TraceAllocation))) ||
+                     (((pEvent->m_id == TRACE_EVENT_HANDLE_CREATED) || (pEvent->m_id == TRACE_EVENT_HANDLE_DESTROYED)) &&
+                      (pEvent->m_cbPayload >= sizeof(TraceHandle))))
+            {
+                if (pOps != NULL)
+                {
+                    ReplayOp * pOp = &pOps[cOps];
+                    memset(pOp, 0, sizeof(ReplayOp));
+                    pOp->m_timeStamp = pEvent->m_timeStamp;
+                    pOp->m_thread = thread;
+                    pOp->m_sequence = cOps;
+
+                    if (pEvent->m_id == TRACE_EVENT_ALLOCATION)
+                    {
+                        const TraceAllocation * pAllocation = (const TraceAllocation *)pPayload;
+                        pOp->m_kind = ReplayOp_Allocate;
+                        pOp->m_value = pAllocation->m_allocatedBytes;
+                        pOp->m_size = pAllocation->m_size;
+                        pOp->m_flags = pAllocation->m_flags;
+                    }
+                    else
+                    {
+                        const TraceHandle * pHandle = (const TraceHandle *)pPayload;
+                        pOp->m_kind = (pEvent->m_id == TRACE_EVENT_HANDLE_CREATED) ? ReplayOp_CreateHandle : ReplayOp_DestroyHandle;
+                        pOp->m_value = pHandle->m_handle;
+                        pOp->m_flags = pHandle->m_type;
+                    }
+                }
+                cOps++;
+            }
+        }
+    }
+
+    *pcBuffers = cBuffers;
+    *pcOps = cOps;
+    *pcGCs = cGCs;
+}
+
+// The bytes each allocation was preceded by on its thread, and how likely it is to survive: the bytes gen0
+// GCs promoted over the bytes allocated since the GC before
+static bool AnnotateAllocations(ReplayGC * pGCs, uint32_t cGCs)
+{
+    uint64_t * pLastAllocatedBytes = new (nothrow) uint64_t[s_cReplayThreads];
+    uint64_t * pLastContextSize = new (nothrow) uint64_t[s_cReplayThreads];
+    uint64_t * pIntervalBytes = new (nothrow) uint64_t[cGCs + 1];
+    if ((pLastAllocatedBytes == NULL) || (pLastContextSize == NULL) || (pIntervalBytes == NULL))
+        return false;
+
+    // The bytes a thread allocated before the trace started are unknown
+    for (uint32_t i = 0; i < s_cReplayThreads; i++)
+    {
+        pLastAllocatedBytes[i] = UINT64_MAX;
+        pLastContextSize[i] = 0;
+    }
+    memset(pIntervalBytes, 0, sizeof(uint64_t) * (cGCs + 1));
+
+    uint32_t gc = 0;
+    for (uint32_t i = 0; i < s_cReplayOps; i++)
+    {
+        ReplayOp * pOp = &s_pReplayOps[i];
+        while ((gc < cGCs) && (pGCs[gc].m_timeStamp <= pOp->m_timeStamp))
+            gc++;
+
+        if (pOp->m_kind != ReplayOp_Allocate)
+            continue;
+
+        // AllocatedBytes includes the previous allocation of the thread when it went to the allocation context
+        uint32_t thread = pOp->m_thread;
+        if ((pLastAllocatedBytes[thread] != UINT64_MAX) && (pOp->m_value > pLastAllocatedBytes[thread] + pLastContextSize[thread]))
+            pOp->m_fillerBytes = pOp->m_value - pLastAllocatedBytes[thread] - pLastContextSize[thread];
+        pLastAllocatedBytes[thread] = pOp->m_value;
+        pLastContextSize[thread] = (((pOp->m_flags & GC_ALLOC_USER_OLD_HEAP) == 0) && (pOp->m_size < LARGE_OBJECT_SIZE)) ? pOp->m_size : 0;
+
+        pIntervalBytes[gc] += pOp->m_fillerBytes + pOp->m_size;
+        pOp->m_value = gc;
+    }
+
+    for (uint32_t i = 0; i < s_cReplayOps; i++)
+    {
+        ReplayOp * pOp = &s_pReplayOps[i];
+        if (pOp->m_kind != ReplayOp_Allocate)
+            continue;
+
+        // Allocations after the last GC behave like the ones before it
+        uint32_t interval = (uint32_t)pOp->m_value;
+        if (cGCs == 0)
+        {
+            pOp->m_retainedBytes = UINT64_MAX;
+            continue;
+        }
+        if (interval == cGCs)
+            interval = cGCs - 1;
+
+        uint64_t survival = (pIntervalBytes[interval] == 0) ? 0 : (pGCs[interval].m_promotedBytes * 65536) / pIntervalBytes[interval];
+        pOp->m_survival = (uint32_t)min(survival, (uint64_t)65536);
+        pOp->m_retainedBytes = pGCs[interval].m_heapSize;
+    }
+
+    delete[] pLastAllocatedBytes;
+    delete[] pLastContextSize;
+    delete[] pIntervalBytes;
+    return true;
+}
+
+static HandleType GetReplayedHandleType(uint32_t recordedType)
+{
+    // Handle types that need more than an object, such as dependent handles, are replayed as strong handles
+    switch (recordedType)
+    {
+    case HNDTYPE_WEAK_SHORT:
+    case HNDTYPE_WEAK_LONG:
+    case HNDTYPE_PINNED:
+        return (HandleType)recordedType;
+    default:
+        return HNDTYPE_STRONG;
+    }
+}
+
+// Gives every handle created by the trace a slot, and the operation that destroys it the same slot
+static bool AssignHandleSlots()
+{
+    uint32_t * pHandleOps = new (nothrow) uint32_t[s_cReplayOps + 1];
+    if (pHandleOps == NULL)
+        return false;
+
+    uint32_t cHandleOps = 0;
+    for (uint32_t i = 0; i < s_cReplayOps; i++)
+    {
+        if (s_pReplayOps[i].m_kind != ReplayOp_Allocate)
+            pHandleOps[cHandleOps++] = i;
+    }
+
+    qsort(pHandleOps, cHandleOps, sizeof(pHandleOps[0]), CompareHandleOps);
+
+    // Operations on a handle are consecutive now, the recorded value is replaced by the slot after the group
+    uint64_t recordedHandle = 0;
+    ReplayOp * pLiveCreate = NULL;
+    for (uint32_t i = 0; i < cHandleOps; i++)
+    {
+        ReplayOp * pOp = &s_pReplayOps[pHandleOps[i]];
+        if ((i == 0) || (pOp->m_value != recordedHandle))
+        {
+            recordedHandle = pOp->m_value;
+            pLiveCreate = NULL;
+        }
+
+        if (pOp->m_kind == ReplayOp_CreateHandle)
+        {
+            // A handle the trace never destroys lives until the end of the iteration
+            pOp->m_flags = GetReplayedHandleType(pOp->m_flags);
+            pOp->m_value = s_cReplayHandles++;
+            pLiveCreate = pOp;
+        }
+        else if (pLiveCreate != NULL)
+        {
+            pOp->m_flags = pLiveCreate->m_flags;
+            pOp->m_value = pLiveCreate->m_value;
+            pLiveCreate = NULL;
+        }
+        else
+        {
+            // Destroys a handle that was created before the trace started
+            pOp->m_kind = ReplayOp_None;
+        }
+    }
+
+    delete[] pHandleOps;
+
+    s_pReplayHandles = new (nothrow) OBJECTHANDLE[s_cReplayHandles + 1];
+    if (s_pReplayHandles == NULL)
+        return false;
+    memset(s_pReplayHandles, 0, sizeof(OBJECTHANDLE) * (s_cReplayHandles + 1));
+    return true;
+}
+
+static bool LoadTrace(const char * path, uint32_t cWorkers)
+{
+    uint8_t * pData = NULL;
+    size_t cbData = 0;
+    if (!ReadTraceFile(path, &pData, &cbData))
+    {
+        printf("Can't read the trace '%s'\n", path);
+        return false;
+    }
+
+    const TraceHeader * pHeader = (const TraceHeader *)pData;
+    if ((cbData < sizeof(TraceHeader)) || (pHeader->m_magic != TRACE_MAGIC) || (pHeader->m_version != TRACE_VERSION))
+    {
+        printf("'%s' is not an event session file\n", path);
+        return false;
+    }
+
+    uint32_t cBuffers;
+    uint32_t cGCs;
+    ParseTrace(pData, cbData, NULL, NULL, NULL, &cBuffers, &s_cReplayOps, &cGCs);
+
+    s_pReplayOps = new (nothrow) ReplayOp[s_cReplayOps + 1];
+    ReplayGC * pGCs = new (nothrow) ReplayGC[cGCs + 1];
+    uint64_t * pThreadIds = new (nothrow) uint64_t[cBuffers + 1];
+    if ((s_pReplayOps == NULL) || (pGCs == NULL) || (pThreadIds == NULL))
+        return false;
+
+    ParseTrace(pData, cbData, s_pReplayOps, pGCs, pThreadIds, &cBuffers, &s_cReplayOps, &cGCs);
+    delete[] pThreadIds;
+    delete[] pData;
+
+    // Buffers of different threads overlap in time
+    qsort(s_pReplayOps, s_cReplayOps, sizeof(ReplayOp), CompareReplayOps);
+    qsort(pGCs, cGCs, sizeof(ReplayGC), CompareReplayGCs);
+
+    for (uint32_t i = 0; i < s_cReplayOps; i++)
+    {
+        if (s_pReplayOps[i].m_kind == ReplayOp_Allocate)
+            s_cReplayAllocations++;
+    }
+    s_recordedHeapSize = (cGCs != 0) ? pGCs[cGCs - 1].m_heapSize : 0;
+
+    bool fSucceeded = AnnotateAllocations(pGCs, cGCs) && AssignHandleSlots();
+    delete[] pGCs;
+    if (!fSucceeded)
+        return false;
+
+    s_cWorkers = cWorkers;
+    s_pReplayWorkers = new (nothrow) ReplayWorker[cWorkers];
+    if (s_pReplayWorkers == NULL)
+        return false;
+    memset(s_pReplayWorkers, 0, sizeof(ReplayWorker) * cWorkers);
+
+    for (uint32_t i = 0; i < cWorkers; i++)
+    {
+        s_pReplayWorkers[i].m_pRetainedSizes = new (nothrow) uint32_t[REPLAY_RETAINED_COUNT];
+        if (s_pReplayWorkers[i].m_pRetainedSizes == NULL)
+            return false;
+    }
+
+    return true;
+}
+
+static bool SetupReplay(WorkerState * pState)
+{
+    pState->m_roots[0] = AllocateArray(pState, &s_refArrayMT.m_MT, REPLAY_RETAINED_COUNT, GC_ALLOC_CONTAINS_REF);
+    return pState->m_roots[0] != NULL;
+}
+
+// Keeps the object in m_roots[1] alive, after letting go of the oldest objects that don't fit under the heap
+// size of the thread
+static void RetainObject(WorkerState * pState, ReplayWorker * pWorker, uint32_t size, uint64_t maxRetainedBytes)
+{
+    Object ** pRetained = GetArrayElements(pState->m_roots[0]);
+
+    while ((pWorker->m_cRetained != 0) &&
+           ((pWorker->m_cRetained == REPLAY_RETAINED_COUNT) || (pWorker->m_retainedBytes + size > maxRetainedBytes)))
+    {
+        pRetained[pWorker->m_firstRetained] = NULL;
+        pWorker->m_retainedBytes -= pWorker->m_pRetainedSizes[pWorker->m_firstRetained];
+        pWorker->m_firstRetained = (pWorker->m_firstRetained + 1) % REPLAY_RETAINED_COUNT;
+        pWorker->m_cRetained--;
+    }
+
+    if (size > maxRetainedBytes)
+        return;
+
+    uint32_t slot = (pWorker->m_firstRetained + pWorker->m_cRetained) % REPLAY_RETAINED_COUNT;
+    WriteBarrier(&pRetained[slot], pState->m_roots[1]);
+    pWorker->m_pRetainedSizes[slot] = size;
+    pWorker->m_retainedBytes += size;
+    pWorker->m_cRetained++;
+}
+
+static bool ReplayAllocation(WorkerState * pState, ReplayWorker * pWorker, const ReplayOp * pOp)
+{
+    pWorker->m_pendingFillerBytes += pOp->m_fillerBytes;
+    while (pWorker->m_pendingFillerBytes >= REPLAY_FILLER_SIZE)
+    {
+        if (AllocateArray(pState, &s_byteArrayMT, REPLAY_FILLER_SIZE - ArrayBaseSize, 0) == NULL)
+            return false;
+        pWorker->m_pendingFillerBytes -= REPLAY_FILLER_SIZE;
+
+        GCPoll();
+    }
+
+    uint32_t size = (uint32_t)min(max(pOp->m_size, (uint64_t)MIN_OBJECT_SIZE), (uint64_t)INT32_MAX);
+    uint32_t flags = pOp->m_flags & (GC_ALLOC_CONTAINS_REF | GC_ALLOC_LARGE_OBJECT_HEAP | GC_ALLOC_PINNED_OBJECT_HEAP);
+
+    if (flags & GC_ALLOC_CONTAINS_REF)
+        pState->m_roots[1] = AllocateArray(pState, &s_refArrayMT.m_MT, (size - ArrayBaseSize) / sizeof(Object *), flags);
+    else
+        pState->m_roots[1] = AllocateArray(pState, &s_byteArrayMT, size - ArrayBaseSize, flags);
+    if (pState->m_roots[1] == NULL)
+        return false;
+
+    if ((NextRandom(pState) & 0xFFFF) < pOp->m_survival)
+        RetainObject(pState, pWorker, size, pOp->m_retainedBytes / s_cWorkers);
+
+    return true;
+}
+
+// Handles are created on the last object allocated by the thread
+static bool ReplayCreateHandle(WorkerState * pState, const ReplayOp * pOp)
+{
+    OBJECTHANDLE handle = CreateHandle(pState->m_roots[1], (HandleType)pOp->m_flags);
+    if (handle == NULL)
+        return false;
+
+    // The handle was destroyed already when the thread that destroys it got ahead of this one
+    if (Interlocked::CompareExchangePointer(&s_pReplayHandles[pOp->m_value], handle, (OBJECTHANDLE)NULL) != NULL)
+        HndDestroyHandle(HndGetHandleTable(handle), (HandleType)pOp->m_flags, handle);
+
+    return true;
+}
+
+static void ReplayDestroyHandle(const ReplayOp * pOp, OBJECTHANDLE replacement)
+{
+    OBJECTHANDLE handle = Interlocked::ExchangePointer(&s_pReplayHandles[pOp->m_value], replacement);
+    if ((handle != NULL) && (handle != DESTROYED_HANDLE))
+        HndDestroyHandle(HndGetHandleTable(handle), (HandleType)pOp->m_flags, handle);
+}
+
+// Waits for all threads to get to the same point of the replay. It returns false if a thread failed.
+static bool WaitForReplayWorkers(int32_t target)
+{
+    Interlocked::Increment(&s_cReplayBarrier);
+    while (VolatileLoad(&s_cReplayBarrier) < target)
+    {
+        if (VolatileLoad(&s_fReplayFailed))
+            return false;
+
+        GCPoll();
+        GCToOSInterface::YieldThread(0);
+    }
+
+    return !VolatileLoad(&s_fReplayFailed);
+}
+
+static bool RunReplay(WorkerState * pState, uint32_t iterations)
+{
+    ReplayWorker * pWorker = &s_pReplayWorkers[pState->m_index];
+    bool fSucceeded = true;
+
+    for (uint32_t iteration = 0; fSucceeded && (iteration < iterations); iteration++)
+    {
+        for (uint32_t i = 0; fSucceeded && (i < s_cReplayOps); i++)
+        {
+            const ReplayOp * pOp = &s_pReplayOps[i];
+            if ((pOp->m_thread % s_cWorkers) != pState->m_index)
+                continue;
+
+            switch (pOp->m_kind)
+            {
+            case ReplayOp_Allocate:
+                fSucceeded = ReplayAllocation(pState, pWorker, pOp);
+                break;
+            case ReplayOp_CreateHandle:
+                fSucceeded = ReplayCreateHandle(pState, pOp);
+                break;
+            case ReplayOp_DestroyHandle:
+                ReplayDestroyHandle(pOp, DESTROYED_HANDLE);
+                break;
+            }
+
+            GCPoll();
+        }
+
+        if (!fSucceeded)
+        {
+            VolatileStore(&s_fReplayFailed, true);
+            break;
+        }
+
+        // Once every thread is done with the iteration the threads that created the handles reset them for
+        // the next one
+        fSucceeded = WaitForReplayWorkers((2 * iteration + 1) * s_cWorkers);
+        for (uint32_t i = 0; fSucceeded && (i < s_cReplayOps); i++)
+        {
+            const ReplayOp * pOp = &s_pReplayOps[i];
+            if ((pOp->m_kind == ReplayOp_CreateHandle) && ((pOp->m_thread % s_cWorkers) == pState->m_index))
+                ReplayDestroyHandle(pOp, NULL);
+        }
+        fSucceeded = fSucceeded && WaitForReplayWorkers((2 * iteration + 2) * s_cWorkers);
+    }
+
+    return fSucceeded;
+}
+
+struct Scenario
+{
+    const char * m_name;
+    uint32_t m_defaultIterations;
+    bool (*m_pfnSetup)(WorkerState * pState);
+    bool (*m_pfnRun)(WorkerState * pState, uint32_t iterations);
+};
+
+static const Scenario s_scenarios[] =
+{
+    { "alloc",      10000000,   NULL,           RunAlloc },
+    { "survival",   10000000,   SetupSurvival,  RunSurvival },
+    { "loh",        20000,      NULL,           RunLoh },
+    { "pinning",    5000000,    NULL,           RunPinning },
+    { "handles",    2000000,    NULL,           RunHandles },
+    { "cards",      10000000,   SetupCards,     RunCards },
+    { "replay",     1,          SetupReplay,    RunReplay },
+};
+
+//
+// Pause statistics, recorded by RestartEE while the thread store lock is held
+//
+
+#define MAX_RECORDED_PAUSES (64 * 1024)
+
+static int64_t * s_pPauseTicks;
+static uint32_t s_cRecordedPauses;
+static uint32_t s_cPauses;
+static int64_t s_totalPauseTicks;
+
+static void OnRestartEE(int64_t suspendedTicks)
+{
+    s_cPauses++;
+    s_totalPauseTicks += suspendedTicks;
+
+    if (s_cRecordedPauses < MAX_RECORDED_PAUSES)
+        s_pPauseTicks[s_cRecordedPauses++] = suspendedTicks;
+}
+
+static int __cdecl ComparePauses(const void * pFirst, const void * pSecond)
+{
+    int64_t first = *(const int64_t *)pFirst;
+    int64_t second = *(const int64_t *)pSecond;
+    return (first < second) ? -1 : ((first > second) ? 1 : 0);
+}
+
+static double TicksToMilliseconds(int64_t ticks)
+{
+    return (double)ticks * 1000.0 / (double)GCToOSInterface::QueryPerformanceFrequency();
+}
+
+static double GetPausePercentile(uint32_t percentTimesTen)
+{
+    if (s_cRecordedPauses == 0)
+        return 0.0;
+
+    uint32_t index = (uint32_t)(((uint64_t)s_cRecordedPauses * percentTimesTen) / 1000);
+    if (index >= s_cRecordedPauses)
+        index = s_cRecordedPauses - 1;
+    return TicksToMilliseconds(s_pPauseTicks[index]);
+}
+
+//
+// Driver
+//
+
+static const Scenario * s_pScenario;
+static uint32_t s_iterations;
+static HANDLE s_hStartEvent;
+static int32_t s_cWorkersReady;
+
+static DWORD WINAPI WorkerThreadStart(void * pArg)
+{
+    WorkerState * pState = (WorkerState *)pArg;
+
+    ThreadStore::AttachCurrentThread();
+    Thread * pThread = GetThread();
+    pThread->SetRoots(pState->m_roots, WORKER_ROOT_COUNT);
+    pThread->DisablePreemptiveGC();
+
+    bool fSucceeded = (s_pScenario->m_pfnSetup == NULL) || s_pScenario->m_pfnSetup(pState);
+
+    // Wait in preemptive mode, so that the GC before the measurement can run
+    pThread->EnablePreemptiveGC();
+    Interlocked::Increment(&s_cWorkersReady);
+    WaitForSingleObjectEx(s_hStartEvent, INFINITE, FALSE);
+    pThread->DisablePreemptiveGC();
+
+    if (fSucceeded)
+        fSucceeded = s_pScenario->m_pfnRun(pState, s_iterations);
+    pState->m_fSucceeded = fSucceeded;
+
+    pThread->SetRoots(NULL, 0);
+    ThreadStore::DetachCurrentThread();
+
+    return 0;
+}
+
+static bool ParseOption(const char * arg, const char * name, const char ** pValue)
+{
+    size_t cchName = strlen(name);
+    if ((_strnicmp(arg, name, cchName) != 0) || (arg[cchName] != ':'))
+        return false;
+
+    *pValue = arg + cchName + 1;
+    return true;
+}
+
+static bool ParseNumber(const char * value, int64_t * pNumber)
+{
+    char * pEnd;
+    *pNumber = _strtoi64(value, &pEnd, 0);
+    return (*value != '\0') && (*pEnd == '\0');
+}
+
+static void PrintUsage()
+{
+    printf("Usage: gcsample -scenario:<name> [-threads:<n>] [-iterations:<n>] [-gc:wks|bgc|svr|svrbgc] [-heaps:<n>]\n");
+    printf("                [-config:<GC config key>=<value>]... [-trace:<events file>]\n");
+    printf("Scenarios:");
+    for (size_t i = 0; i < sizeof(s_scenarios) / sizeof(s_scenarios[0]); i++)
+        printf(" %s", s_scenarios[i].m_name);
+    printf("\n");
+}
+
+int RunBenchmark(int argc, char* argv[])
+{
+    const char * gcMode = "wks";
+    int64_t threadCount = 1;
+    int64_t iterations = 0;
+    const char * tracePath = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char * value;
+        int64_t number;
+
+        if (ParseOption(argv[i], "-scenario", &value))
+        {
+            s_pScenario = NULL;
+            for (size_t j = 0; j < sizeof(s_scenarios) / sizeof(s_scenarios[0]); j++)
+            {
+                if (_stricmp(value, s_scenarios[j].m_name) == 0)
+                    s_pScenario = &s_scenarios[j];
+            }
+
+            if (s_pScenario == NULL)
+            {
+                printf("Unknown scenario '%s'\n", value);
+                PrintUsage();
+                return -1;
+            }
+        }
+        else if (ParseOption(argv[i], "-threads", &value) && ParseNumber(value, &threadCount) && (threadCount > 0) && (threadCount <= 1024))
+        {
+        }
+        else if (ParseOption(argv[i], "-iterations", &value) && ParseNumber(value, &iterations) && (iterations > 0) && (iterations <= UINT32_MAX))
+        {
+        }
+        else if (ParseOption(argv[i], "-gc", &value) &&
+                 ((_stricmp(value, "wks") == 0) || (_stricmp(value, "bgc") == 0) || (_stricmp(value, "svr") == 0) || (_stricmp(value, "svrbgc") == 0)))
+        {
+            gcMode = value;
+        }
+        else if (ParseOption(argv[i], "-trace", &value) && (*value != '\0'))
+        {
+            tracePath = value;
+        }
+        else if (ParseOption(argv[i], "-heaps", &value) && ParseNumber(value, &number) && (number > 0))
+        {
+            SetGCConfigValue("GCHeapCount", number);
+        }
+        else if (ParseOption(argv[i], "-config", &value) && (strchr(value, '=') != NULL) && ParseNumber(strchr(value, '=') + 1, &number))
+        {
+            // The GC keeps using the key, so it gets a copy that outlives the arguments
+            size_t cchKey = strchr(value, '=') - value;
+            char * key = new (nothrow) char[cchKey + 1];
+            if (key == NULL)
+                return -1;
+            memcpy(key, value, cchKey);
+            key[cchKey] = '\0';
+
+            if (!SetGCConfigValue(key, number))
+            {
+                printf("Too many GC configuration values\n");
+                return -1;
+            }
+        }
+        else
+        {
+            printf("Invalid argument '%s'\n", argv[i]);
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    if (s_pScenario == NULL)
+    {
+        PrintUsage();
+        return -1;
+    }
+
+    bool fReplay = (s_pScenario->m_pfnRun == RunReplay);
+    if (fReplay != (tracePath != NULL))
+    {
+        printf(fReplay ? "The replay scenario needs a trace\n" : "Only the replay scenario takes a trace\n");
+        PrintUsage();
+        return -1;
+    }
+
+    if (fReplay && !LoadTrace(tracePath, (uint32_t)threadCount))
+        return -1;
+
+    s_iterations = (iterations != 0) ? (uint32_t)iterations : s_pScenario->m_defaultIterations;
+
+    SetGCConfigValue("gcServer", (_strnicmp(gcMode, "svr", 3) == 0) ? 1 : 0);
+    SetGCConfigValue("gcConcurrent", (strstr(gcMode, "bgc") != NULL) ? 1 : 0);
+
+    if (!InitializeGC())
+        return -1;
+
+    InitializeTypes();
+
+    s_pPauseTicks = new (nothrow) int64_t[MAX_RECORDED_PAUSES];
+    WorkerState * pStates = new (nothrow) WorkerState[(size_t)threadCount];
+    HANDLE * pThreads = new (nothrow) HANDLE[(size_t)threadCount];
+    s_hStartEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if ((s_pPauseTicks == NULL) || (pStates == NULL) || (pThreads == NULL) || (s_hStartEvent == NULL))
+        return -1;
+
+    // The driver thread only runs the GC that ends the setup
+    ThreadStore::AttachCurrentThread();
+
+    memset(pStates, 0, sizeof(WorkerState) * (size_t)threadCount);
+    for (int64_t i = 0; i < threadCount; i++)
+    {
+        pStates[i].m_index = (uint32_t)i;
+        pStates[i].m_random = 0x9E3779B9u * (uint32_t)(i + 1);
+        pThreads[i] = CreateThread(NULL, 0, WorkerThreadStart, &pStates[i], 0, NULL);
+        if (pThreads[i] == NULL)
+            return -1;
+    }
+
+    while (VolatileLoad(&s_cWorkersReady) != threadCount)
+        GCToOSInterface::Sleep(1);
+
+    // Start every run from the same heap state, with the objects built by the setup in gen2
+    GetThread()->DisablePreemptiveGC();
+    g_theGCHeap->GarbageCollect(max_generation);
+    GetThread()->EnablePreemptiveGC();
+
+    uint64_t startBytes = 0;
+    uint64_t startObjects = 0;
+    for (int64_t i = 0; i < threadCount; i++)
+    {
+        startBytes += pStates[i].m_bytesAllocated;
+        startObjects += pStates[i].m_objectsAllocated;
+    }
+
+    int startCounts[max_generation + 1];
+    for (int gen = 0; gen <= max_generation; gen++)
+        startCounts[gen] = g_theGCHeap->CollectionCount(gen);
+
+    SetRestartEECallback(OnRestartEE);
+
+    int64_t startTicks = GCToOSInterface::QueryPerformanceCounter();
+    SetEvent(s_hStartEvent);
+
+    bool fSucceeded = true;
+    for (int64_t i = 0; i < threadCount; i++)
+    {
+        WaitForSingleObjectEx(pThreads[i], INFINITE, FALSE);
+        CloseHandle(pThreads[i]);
+        fSucceeded = fSucceeded && pStates[i].m_fSucceeded;
+    }
+
+    int64_t elapsedTicks = GCToOSInterface::QueryPerformanceCounter() - startTicks;
+
+    // Any GC from here on is not part of the measurement
+    SetRestartEECallback(NULL);
+
+    if (!fSucceeded)
+    {
+        printf("The scenario ran out of memory\n");
+        return -1;
+    }
+
+    uint64_t bytesAllocated = 0;
+    uint64_t objectsAllocated = 0;
+    for (int64_t i = 0; i < threadCount; i++)
+    {
+        bytesAllocated += pStates[i].m_bytesAllocated;
+        objectsAllocated += pStates[i].m_objectsAllocated;
+    }
+    bytesAllocated -= startBytes;
+    objectsAllocated -= startObjects;
+
+    double elapsedMilliseconds = TicksToMilliseconds(elapsedTicks);
+    double elapsedSeconds = elapsedMilliseconds / 1000.0;
+
+    qsort(s_pPauseTicks, s_cRecordedPauses, sizeof(s_pPauseTicks[0]), ComparePauses);
+
+    PROCESS_MEMORY_COUNTERS memoryCounters;
+    memset(&memoryCounters, 0, sizeof(memoryCounters));
+    GetProcessMemoryInfo(GetCurrentProcess(), &memoryCounters, sizeof(memoryCounters));
+
+    printf("Scenario:           %s\n", s_pScenario->m_name);
+    printf("GC:                 %s, %d heap(s)\n", gcMode, g_theGCHeap->GetNumberOfHeaps());
+    printf("Threads:            %d, %u iterations each\n", (int)threadCount, s_iterations);
+    printf("Elapsed:            %.3f ms\n", elapsedMilliseconds);
+    printf("Allocated:          %.1f MB in %llu objects\n", (double)bytesAllocated / (1024 * 1024), (unsigned long long)objectsAllocated);
+    printf("Throughput:         %.1f MB/s, %.0f objects/s\n", (double)bytesAllocated / (1024 * 1024) / elapsedSeconds, (double)objectsAllocated / elapsedSeconds);
+    printf("Collections:        gen0 %d, gen1 %d, gen2 %d\n",
+        g_theGCHeap->CollectionCount(0) - startCounts[0],
+        g_theGCHeap->CollectionCount(1) - startCounts[1],
+        g_theGCHeap->CollectionCount(2) - startCounts[2]);
+    printf("Pauses:             %u, %.3f ms in total, %.2f%% of elapsed\n",
+        s_cPauses, TicksToMilliseconds(s_totalPauseTicks), TicksToMilliseconds(s_totalPauseTicks) * 100.0 / elapsedMilliseconds);
+    printf("Pause percentiles:  p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, p99.9 %.3f ms, max %.3f ms\n",
+        GetPausePercentile(500), GetPausePercentile(900), GetPausePercentile(990), GetPausePercentile(999), GetPausePercentile(1000));
+    if (s_cRecordedPauses < s_cPauses)
+        printf("                    (percentiles of the first %u pauses)\n", s_cRecordedPauses);
+    printf("Peak working set:   %.1f MB\n", (double)memoryCounters.PeakWorkingSetSize / (1024 * 1024));
+
+    if (fReplay)
+    {
+        printf("Heap at the end:    %.1f MB\n", (double)g_theGCHeap->GetTotalBytesInUse() / (1024 * 1024));
+        printf("Trace:              %u threads, %u allocations, %u handles\n", s_cReplayThreads, s_cReplayAllocations, s_cReplayHandles);
+        printf("Traced collections: gen0 %u, gen1 %u, gen2 %u, %.1f MB heap after the last one\n",
+            s_recordedCollections[0], s_recordedCollections[1], s_recordedCollections[2], (double)s_recordedHeapSize / (1024 * 1024));
+    }
+
+    return 0;
+}
@@ -0,0 +1,17 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+#ifndef __GCBENCH_H__
+#define __GCBENCH_H__
+
+// Write barrier of GCSample.cpp
+void WriteBarrier(Object ** dst, Object * ref);
+
+// Initializes the OS interface, the thread store, the GC heap and the handle manager
+bool InitializeGC();
+
+// Runs the benchmark scenario selected by the command line, returns the exit code of the process
+int RunBenchmark(int argc, char* argv[]);
+
+#endif // __GCBENCH_H__
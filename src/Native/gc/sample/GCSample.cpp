@@ -38,6 +38,8 @@
 //  For now, the sample GC environment has some cruft in it to decouple the GC from Windows and rest of CoreCLR.
 //  It is something we would like to clean up.
 //
+//  Run with arguments, the sample runs one of the benchmark scenarios of GCBench.cpp instead.
+//
 
 #include "common.h"
 
@@ -48,6 +50,8 @@
 
 #include "gcdesc.h"
 
+#include "GCBench.h"
+
 //
 // The fast paths for object allocation and write barriers is performance critical. They are often
 // hand written in assembly code, etc.
@@ -109,16 +113,19 @@ void WriteBarrier(Object ** dst, Object * ref)
 
 extern "C" HRESULT GC_Initialize(IGCToCLR* clrToGC, IGCHeap** gcHeap, IGCHandleManager** gcHandleManager, GcDacVars* gcDacVars);
 
-int __cdecl main(int argc, char* argv[])
+bool InitializeGC()
 {
     //
     // Initialize system info
     //
     if (!GCToOSInterface::Initialize())
     {
-        return -1;
+        return false;
     }
 
+    if (!ThreadStore::Initialize())
+        return false;
+
     //
     // Initialize GC heap
     //
@@ -127,22 +134,34 @@ int __cdecl main(int argc, char* argv[])
     IGCHandleManager *pGCHandleManager;
     if (GC_Initialize(nullptr, &pGCHeap, &pGCHandleManager, &dacVars) != S_OK)
     {
-        return -1;
+        return false;
     }
 
     if (FAILED(pGCHeap->Initialize()))
-        return -1;
+        return false;
 
     //
     // Initialize handle manager
     //
     if (!pGCHandleManager->Initialize())
+        return false;
+
+    return true;
+}
+
+int __cdecl main(int argc, char* argv[])
+{
+    if (argc > 1)
+        return RunBenchmark(argc, argv);
+
+    if (!InitializeGC())
         return -1;
 
     //
     // Initialize current thread
     //
     ThreadStore::AttachCurrentThread();
+    GetThread()->DisablePreemptiveGC();
 
     //
     // Create a Methodtable with GCDesc
@@ -226,7 +245,7 @@ int __cdecl main(int argc, char* argv[])
     HndDestroyHandle(HndGetHandleTable(oh), HNDTYPE_DEFAULT, oh);
 
     // Explicitly trigger full GC
-    pGCHeap->GarbageCollect();
+    g_theGCHeap->GarbageCollect();
 
     // Verify that the weak handle got cleared by the GC
     assert(HndFetchHandle(ohWeak) == NULL);
@@ -97,6 +97,7 @@ uint32_t CLREventStatic::Wait(uint32_t dwMilliseconds, bool bAlertable)
 }
 
 thread_local Thread * pCurrentThread;
+thread_local bool fCurrentThreadCreatedByGC;
 
 Thread * GetThread()
 {
@@ -105,6 +106,27 @@ Thread * GetThread()
 
 Thread * g_pThreadList = NULL;
 
+// Held from SuspendEE to RestartEE, so threads are only added to or removed from the list while the
+// execution engine runs
+static CLRCriticalSection g_threadStoreLock;
+
+// Set while the execution engine is suspended. Threads entering cooperative mode wait on g_hRestartEvent
+// until it is cleared again.
+bool g_fSuspendRequested;
+static HANDLE g_hRestartEvent;
+static Thread * g_pSuspendingThread;
+
+static int64_t g_suspendStartTicks;
+static RestartEECallback g_pfnRestartEECallback;
+
+bool ThreadStore::Initialize()
+{
+    g_threadStoreLock.Initialize();
+
+    g_hRestartEvent = CreateEventW(NULL, TRUE, TRUE, NULL);
+    return g_hRestartEvent != NULL;
+}
+
 Thread * ThreadStore::GetThreadList(Thread * pThread)
 {
     if (pThread == NULL)
@@ -113,35 +135,130 @@ Thread * ThreadStore::GetThreadList(Thread * pThread)
     return pThread->m_pNext;
 }
 
-void ThreadStore::AttachCurrentThread()
+void ThreadStore::AttachCurrentThread(bool fAcquireThreadStoreLock)
 {
-    // TODO: Locks
-
     Thread * pThread = new Thread();
     pThread->GetAllocContext()->init();
     pCurrentThread = pThread;
 
+    if (fAcquireThreadStoreLock)
+        g_threadStoreLock.Enter();
+
     pThread->m_pNext = g_pThreadList;
     g_pThreadList = pThread;
+
+    if (fAcquireThreadStoreLock)
+        g_threadStoreLock.Leave();
+}
+
+void ThreadStore::DetachCurrentThread()
+{
+    Thread * pThread = GetThread();
+
+    // The lock can't be taken in cooperative mode since the GC may be waiting for this thread. Holding it
+    // keeps GCs out while the allocation context is retired.
+    pThread->EnablePreemptiveGC();
+    g_threadStoreLock.Enter();
+
+    g_theGCHeap->FixAllocContext(pThread->GetAllocContext(), NULL, NULL);
+
+    Thread ** ppThread = &g_pThreadList;
+    while (*ppThread != pThread)
+        ppThread = &(*ppThread)->m_pNext;
+    *ppThread = pThread->m_pNext;
+
+    g_threadStoreLock.Leave();
+
+    pCurrentThread = NULL;
+    delete pThread;
+}
+
+void Thread::DisablePreemptiveGC()
+{
+    for (;;)
+    {
+        VolatileStore(&m_fPreemptiveGCDisabled, true);
+
+        // SuspendEE flushes the write buffers of all processors after setting g_fSuspendRequested, so either
+        // it sees this thread in cooperative mode and waits for it, or this thread sees the request here.
+        if (!VolatileLoad(&g_fSuspendRequested) || (this == g_pSuspendingThread))
+            return;
+
+        VolatileStore(&m_fPreemptiveGCDisabled, false);
+        WaitForSingleObjectEx(g_hRestartEvent, INFINITE, FALSE);
+    }
+}
+
+void SetRestartEECallback(RestartEECallback pfnCallback)
+{
+    g_pfnRestartEECallback = pfnCallback;
 }
 
 void GCToEEInterface::SuspendEE(SUSPEND_REASON reason)
 {
+    int64_t startTicks = GCToOSInterface::QueryPerformanceCounter();
+
+    g_threadStoreLock.Enter();
+
     g_theGCHeap->SetGCInProgress(true);
 
-    // TODO: Implement
+    // Lets a background GC thread in cooperative mode know that it should yield
+    g_theGCHeap->SetSuspensionPending(true);
+
+    ResetEvent(g_hRestartEvent);
+    g_pSuspendingThread = GetThread();
+    VolatileStore(&g_fSuspendRequested, true);
+    GCToOSInterface::FlushProcessWriteBuffers();
+
+    // Wait for every other thread to leave cooperative mode, either at a poll or on the way into a wait
+    Thread * pThread = NULL;
+    while ((pThread = ThreadStore::GetThreadList(pThread)) != NULL)
+    {
+        uint32_t switchCount = 0;
+        while ((pThread != g_pSuspendingThread) && pThread->PreemptiveGCDisabled())
+        {
+            GCToOSInterface::YieldThread(switchCount++);
+        }
+    }
+
+    g_theGCHeap->SetSuspensionPending(false);
+
+    g_suspendStartTicks = startTicks;
 }
 
 void GCToEEInterface::RestartEE(bool bFinishedGC)
 {
-    // TODO: Implement
-
     g_theGCHeap->SetGCInProgress(false);
+
+    if (g_pfnRestartEECallback != NULL)
+        g_pfnRestartEECallback(GCToOSInterface::QueryPerformanceCounter() - g_suspendStartTicks);
+
+    g_pSuspendingThread = NULL;
+    VolatileStore(&g_fSuspendRequested, false);
+    SetEvent(g_hRestartEvent);
+
+    g_threadStoreLock.Leave();
 }
 
 void GCToEEInterface::GcScanRoots(promote_func* fn,  int condemned, int max_gen, ScanContext* sc)
 {
-    // TODO: Implement - Scan stack roots on given thread
+    Thread * pThread = NULL;
+    while ((pThread = ThreadStore::GetThreadList(pThread)) != NULL)
+    {
+        if (pThread->IsGCSpecial())
+            continue;
+
+        // With server GC, each heap scans the threads allocating from it
+        if (!g_theGCHeap->IsThreadUsingAllocationContextHeap(pThread->GetAllocContext(), sc->thread_number))
+            continue;
+
+        Object ** pRoots = pThread->GetRoots();
+        for (size_t i = 0; i < pThread->GetRootCount(); i++)
+        {
+            if (pRoots[i] != NULL)
+                fn(&pRoots[i], sc, 0);
+        }
+    }
 }
 
 void GCToEEInterface::GcStartWork(int condemned, int max_gen)
@@ -165,6 +282,11 @@ bool GCToEEInterface::RefCountedHandleCallbacks(Object * pObject)
     return false;
 }
 
+size_t GCToEEInterface::RefCountedHandleCallbacksForBatch(Object ** rgpObjects, size_t cObjects)
+{
+    return 0;
+}
+
 bool GCToEEInterface::IsPreemptiveGCDisabled()
 {
     Thread* pThread = ::GetThread();
@@ -186,7 +308,10 @@ bool GCToEEInterface::EnablePreemptiveGC()
 void GCToEEInterface::DisablePreemptiveGC()
 {
     Thread* pThread = ::GetThread();
-    pThread->DisablePreemptiveGC();
+    if (pThread)
+    {
+        pThread->DisablePreemptiveGC();
+    }
 }
 
 Thread* GCToEEInterface::GetThread()
@@ -275,14 +400,62 @@ bool GCToEEInterface::EagerFinalized(Object* obj)
     return false;
 }
 
-bool GCToEEInterface::GetBooleanConfigValue(const char* privateKey, const char* publicKey, bool* value)
+struct GCConfigValue
 {
+    const char * m_privateKey;
+    int64_t m_value;
+};
+
+static GCConfigValue g_configValues[16];
+static int g_cConfigValues;
+
+bool SetGCConfigValue(const char * privateKey, int64_t value)
+{
+    for (int i = 0; i < g_cConfigValues; i++)
+    {
+        if (_stricmp(g_configValues[i].m_privateKey, privateKey) == 0)
+        {
+            g_configValues[i].m_value = value;
+            return true;
+        }
+    }
+
+    if (g_cConfigValues == sizeof(g_configValues) / sizeof(g_configValues[0]))
+        return false;
+
+    g_configValues[g_cConfigValues].m_privateKey = privateKey;
+    g_configValues[g_cConfigValues].m_value = value;
+    g_cConfigValues++;
+    return true;
+}
+
+static bool GetGCConfigValue(const char * privateKey, int64_t * value)
+{
+    for (int i = 0; (privateKey != NULL) && (i < g_cConfigValues); i++)
+    {
+        if (_stricmp(g_configValues[i].m_privateKey, privateKey) == 0)
+        {
+            *value = g_configValues[i].m_value;
+            return true;
+        }
+    }
+
     return false;
 }
 
+bool GCToEEInterface::GetBooleanConfigValue(const char* privateKey, const char* publicKey, bool* value)
+{
+    int64_t configValue;
+    if (!GetGCConfigValue(privateKey, &configValue))
+        return false;
+
+    *value = (configValue != 0);
+    return true;
+}
+
 bool GCToEEInterface::GetIntConfigValue(const char* privateKey, const char* publicKey, int64_t* value)
 {
-    return false;
+    return GetGCConfigValue(privateKey, value);
 }
 
 bool GCToEEInterface::GetStringConfigValue(const char* privateKey, const char* publicKey, const char** value)
@@ -297,12 +470,17 @@ void GCToEEInterface::FreeStringConfigValue(const char *value)
 
 bool GCToEEInterface::IsGCThread()
 {
-    return false;
+    if (fCurrentThreadCreatedByGC)
+        return true;
+
+    // The thread that suspended the execution engine runs the GC for workstation heaps
+    Thread * pThread = ::GetThread();
+    return (pThread != NULL) && (pThread == g_pSuspendingThread);
 }
 
 bool GCToEEInterface::WasCurrentThreadCreatedByGC()
 {
-    return false;
+    return fCurrentThreadCreatedByGC;
 }
 
 static MethodTable freeObjectMT;
@@ -317,9 +495,62 @@ MethodTable* GCToEEInterface::GetFreeObjectMethodTable()
     return &freeObjectMT;
 }
 
+struct ThreadStubArguments
+{
+    void (*m_pRealStartRoutine)(void*);
+    void* m_pRealContext;
+    bool m_isSuspendable;
+    HANDLE m_hThreadStarted;
+};
+
+static DWORD WINAPI GCThreadStub(void* argument)
+{
+    ThreadStubArguments* pStartContext = (ThreadStubArguments*)argument;
+
+    fCurrentThreadCreatedByGC = true;
+
+    if (pStartContext->m_isSuspendable)
+    {
+        // Background GC threads are created during a GC, while the thread store lock is held by the thread
+        // that suspended the execution engine
+        ThreadStore::AttachCurrentThread(false);
+        GetThread()->SetGCSpecial(true);
+    }
+
+    void (*realStartRoutine)(void*) = pStartContext->m_pRealStartRoutine;
+    void* realContext = pStartContext->m_pRealContext;
+
+    SetEvent(pStartContext->m_hThreadStarted);
+
+    realStartRoutine(realContext);
+
+    return 0;
+}
+
 bool GCToEEInterface::CreateThread(void (*threadStart)(void*), void* arg, bool is_suspendable, const char* name)
 {
-    return false;
+    ThreadStubArguments threadStubArgs;
+
+    threadStubArgs.m_pRealStartRoutine = threadStart;
+    threadStubArgs.m_pRealContext = arg;
+    threadStubArgs.m_isSuspendable = is_suspendable;
+    threadStubArgs.m_hThreadStarted = CreateEventW(NULL, FALSE, FALSE, NULL);
+    if (threadStubArgs.m_hThreadStarted == NULL)
+        return false;
+
+    HANDLE hThread = ::CreateThread(NULL, 0, GCThreadStub, &threadStubArgs, 0, NULL);
+    if (hThread == NULL)
+    {
+        CloseHandle(threadStubArgs.m_hThreadStarted);
+        return false;
+    }
+
+    // The arguments live on this stack, so wait for the thread to be done with them
+    WaitForSingleObjectEx(threadStubArgs.m_hThreadStarted, INFINITE, FALSE);
+
+    CloseHandle(threadStubArgs.m_hThreadStarted);
+    CloseHandle(hThread);
+    return true;
 }
 
 void GCToEEInterface::WalkAsyncPinnedForPromotion(Object* object, ScanContext* sc, promote_func* callback)
@@ -344,3 +575,12 @@ inline void GCToEEInterface::AnalyzeSurvivorsFinished(int condemnedGeneration)
 {
 
 }
+
+uint32_t GCToEEInterface::GetSupportedInstructionSets()
+{
+    return 0;
+}
+
+void GCToEEInterface::FullGCApproaching(int generation)
+{
+}
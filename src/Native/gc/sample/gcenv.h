@@ -93,30 +93,35 @@ struct alloc_context;
 class Thread
 {
     bool m_fPreemptiveGCDisabled;
+    bool m_fGCSpecial;
     uintptr_t m_alloc_context[16]; // Reserve enough space to fix allocation context
 
+    // The sample has no stacks to walk. Objects a thread keeps alive across allocations are stored in
+    // this array instead, and GcScanRoots reports every non-null entry of it.
+    Object ** m_pRoots;
+    size_t m_cRoots;
+
     friend class ThreadStore;
     Thread * m_pNext;
 
 public:
     Thread()
+        : m_fPreemptiveGCDisabled(false), m_fGCSpecial(false), m_pRoots(NULL), m_cRoots(0), m_pNext(NULL)
     {
     }
 
     bool PreemptiveGCDisabled()
     {
-        return m_fPreemptiveGCDisabled;
+        return VolatileLoad(&m_fPreemptiveGCDisabled);
     }
 
     void EnablePreemptiveGC()
     {
-        m_fPreemptiveGCDisabled = false;
+        VolatileStore(&m_fPreemptiveGCDisabled, false);
     }
 
-    void DisablePreemptiveGC()
-    {
-        m_fPreemptiveGCDisabled = true;
-    }
+    // Switches to cooperative mode, waiting for the execution engine to be restarted if it is suspended
+    void DisablePreemptiveGC();
 
     alloc_context* GetAllocContext()
     {
@@ -125,6 +130,28 @@ public:
 
     void SetGCSpecial(bool fGCSpecial)
     {
+        m_fGCSpecial = fGCSpecial;
+    }
+
+    bool IsGCSpecial()
+    {
+        return m_fGCSpecial;
+    }
+
+    void SetRoots(Object ** pRoots, size_t cRoots)
+    {
+        m_pRoots = pRoots;
+        m_cRoots = cRoots;
+    }
+
+    Object ** GetRoots()
+    {
+        return m_pRoots;
+    }
+
+    size_t GetRootCount()
+    {
+        return m_cRoots;
     }
 };
 
@@ -133,11 +160,39 @@ Thread * GetThread();
 class ThreadStore
 {
 public:
+    static bool Initialize();
+
     static Thread * GetThreadList(Thread * pThread);
 
-    static void AttachCurrentThread();
+    // Threads are attached in preemptive mode. The thread store lock is already held by the suspending
+    // thread when a thread is attached during a GC.
+    static void AttachCurrentThread(bool fAcquireThreadStoreLock = true);
+
+    static void DetachCurrentThread();
 };
 
+extern bool g_fSuspendRequested;
+
+// Threads that run in cooperative mode for a long time call this at regular points to let GCs happen
+inline void GCPoll()
+{
+    if (VolatileLoad(&g_fSuspendRequested))
+    {
+        Thread * pThread = GetThread();
+        pThread->EnablePreemptiveGC();
+        pThread->DisablePreemptiveGC();
+    }
+}
+
+// Called with the time the execution engine was suspended for, in QueryPerformanceCounter units, before
+// the suspended threads are released
+typedef void (*RestartEECallback)(int64_t suspendedTicks);
+void SetRestartEECallback(RestartEECallback pfnCallback);
+
+// Sets the value the GC reads for one of its configuration keys, see gcconfig.h. Values set after the GC
+// is initialized are ignored.
+bool SetGCConfigValue(const char * privateKey, int64_t value);
+
 // -----------------------------------------------------------------------------------------------------------
 // Config file enumulation
 //
@@ -53,6 +53,9 @@ Abstract:
 #define CGROUP1_CFS_QUOTA_FILENAME "/cpu.cfs_quota_us"
 #define CGROUP1_CFS_PERIOD_FILENAME "/cpu.cfs_period_us"
 #define CGROUP2_CPU_MAX_FILENAME "/cpu.max"
+#define CGROUP_CPU_STAT_FILENAME "/cpu.stat"
+#define CGROUP1_THROTTLED_TIME_KEY "throttled_time"
+#define CGROUP2_THROTTLED_TIME_KEY "throttled_usec"
 
 class CGroup
 {
@@ -120,6 +123,28 @@ public:
         }
     }
 
+    // Total time, in microseconds, the tasks of the cgroup couldn't run because the cgroup ran out of its CPU quota.
+    // cgroup v1 reports it in nanoseconds.
+    static bool GetCpuThrottledTime(uint64_t *val)
+    {
+        if (s_cgroup_version == 0)
+            return false;
+        else if (s_cgroup_version == 1)
+        {
+            if (!ReadCpuStatValue(CGROUP1_THROTTLED_TIME_KEY, val))
+                return false;
+            *val /= 1000;
+            return true;
+        }
+        else if (s_cgroup_version == 2)
+            return ReadCpuStatValue(CGROUP2_THROTTLED_TIME_KEY, val);
+        else
+        {
+            assert(!"Unknown cgroup version.");
+            return false;
+        }
+    }
+
 private:
     static int FindCGroupVersion()
     {
@@ -588,6 +613,47 @@ private:
         return val;
     }
 
+    // Reads the value of the "$KEY $VALUE" line of cpu.stat with the given key.
+    static bool ReadCpuStatValue(const char* key, uint64_t* val)
+    {
+        char *filename = nullptr;
+        FILE *file = nullptr;
+        char *line = nullptr;
+        size_t lineLen = 0;
+        size_t keyLen = strlen(key);
+        bool result = false;
+
+        if (s_cpu_cgroup_path == nullptr)
+            return false;
+
+        if (asprintf(&filename, "%s%s", s_cpu_cgroup_path, CGROUP_CPU_STAT_FILENAME) < 0)
+            return false;
+
+        file = fopen(filename, "r");
+        if (file == nullptr)
+            goto done;
+
+        while (getline(&line, &lineLen, file) != -1)
+        {
+            if (strncmp(line, key, keyLen) != 0 || line[keyLen] != ' ')
+                continue;
+
+            char *valueString = line + keyLen + 1;
+            char *endptr = nullptr;
+            errno = 0;
+            *val = strtoull(valueString, &endptr, BASE_TEN);
+            result = (valueString != endptr && errno == 0);
+            break;
+        }
+
+    done:
+        if (file)
+            fclose(file);
+        free(filename);
+        free(line);
+        return result;
+    }
+
     static bool ReadLongLongValueFromFile(const char* filename, long long* val)
     {
         bool result = false;
@@ -729,3 +795,11 @@ bool GetCpuLimit(uint32_t* val)
 
     return CGroup::GetCpuLimit(val);
 }
+
+bool GetCpuThrottledTime(uint64_t* val)
+{
+    if (val == nullptr)
+        return false;
+
+    return CGroup::GetCpuThrottledTime(val);
+}
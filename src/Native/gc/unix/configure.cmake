@@ -46,6 +46,26 @@ check_cxx_source_compiles("
     }
     " HAVE_MAP_HUGETLB)
 
+check_cxx_source_compiles("
+    #include <sys/mman.h>
+
+    int main()
+    {
+        return MADV_HUGEPAGE;
+    }
+    " HAVE_MADV_HUGEPAGE)
+
+check_cxx_source_compiles("
+    #include <linux/fs.h>
+    #include <linux/userfaultfd.h>
+
+    int main()
+    {
+        struct pm_scan_arg arg = { sizeof(arg), PM_SCAN_WP_MATCHING };
+        return (int)(PAGEMAP_SCAN + UFFDIO_WRITEPROTECT + UFFD_FEATURE_WP_ASYNC + arg.flags);
+    }
+    " HAVE_PAGEMAP_SCAN)
+
 check_cxx_source_compiles("
 #include <pthread_np.h>
 int main(int argc, char **argv) {
@@ -19,8 +19,11 @@
 #include "gcenv.structs.h"
 #include "gcenv.base.h"
 #include "gcenv.os.h"
+#include "gcenv.ee.h"
 #include "gcenv.unix.inl"
 #include "volatile.h"
+#include "gcconfig.h"
+#include "rseqcpu.h"
 
 #if HAVE_SWAPCTL
 #include <sys/swap.h>
@@ -148,6 +151,9 @@ static uint32_t g_totalCpuCount = 0;
 // The cached number of CPUs available for the current process.
 static uint32_t g_currentProcessCpuCount = 0;
 
+// Number of processors in the affinity set of the process, before the cgroup CPU limit is applied
+static uint32_t g_processAffinityCpuCount = 0;
+
 //
 // Helper membarrier function
 //
@@ -183,9 +189,32 @@ static pthread_mutex_t g_flushProcessWriteBuffersMutex;
 size_t GetRestrictedPhysicalMemoryLimit();
 bool GetPhysicalMemoryUsed(size_t* val);
 bool GetCpuLimit(uint32_t* val);
+bool GetCpuThrottledTime(uint64_t* val);
 
 static size_t g_RestrictedPhysicalMemoryLimit = 0;
 
+#if HAVE_MADV_HUGEPAGE
+// Size of the large pages that transparent huge pages use with 4KB base pages.
+static const size_t TRANSPARENT_LARGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Set once a reservation has been advised to use transparent huge pages.
+static bool g_transparentLargePagesUsed = false;
+#endif // HAVE_MADV_HUGEPAGE
+
+#if HAVE_PAGEMAP_SCAN
+#include <linux/fs.h>
+#include <linux/userfaultfd.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+
+// Write watch uses the asynchronous write protection of userfaultfd. Ranges reserved for write watching are
+// registered with g_writeWatchUffd, and resetting the write watch state write protects their pages. The kernel
+// resolves the first write to a protected page by itself, without notifying us, and the PAGEMAP_SCAN ioctl on
+// g_writeWatchPagemap reports the pages that are no longer protected as written.
+static int g_writeWatchUffd = -1;
+static int g_writeWatchPagemap = -1;
+#endif // HAVE_PAGEMAP_SCAN
+
 uint32_t g_pageSizeUnixInl = 0;
 
 AffinitySet g_processAffinitySet;
@@ -413,6 +442,8 @@ bool GCToOSInterface::Initialize()
 
 #endif // HAVE_SCHED_GETAFFINITY
 
+    g_processAffinityCpuCount = g_currentProcessCpuCount;
+
     uint32_t cpuLimit;
     if (GetCpuLimit(&cpuLimit) && cpuLimit < g_currentProcessCpuCount)
     {
@@ -479,6 +510,10 @@ bool GCToOSInterface::SetCurrentThreadIdealAffinity(uint16_t srcProcNo, uint16_t
 // Get the number of the current processor
 uint32_t GCToOSInterface::GetCurrentProcessorNumber()
 {
+    int rseqProcessorNumber = GetRseqCurrentProcessor();
+    if (rseqProcessorNumber >= 0)
+        return rseqProcessorNumber;
+
 #if HAVE_SCHED_GETCPU
     int processorNumber = sched_getcpu();
     assert(processorNumber != -1);
@@ -584,12 +619,25 @@ void GCToOSInterface::YieldThread(uint32_t switchCount)
 //  Starting virtual address of the reserved range
 static void* VirtualReserveInner(size_t size, size_t alignment, uint32_t flags, uint32_t hugePagesFlag = 0)
 {
+#if HAVE_PAGEMAP_SCAN
+    assert(!(flags & VirtualReserveFlags::WriteWatch) || (g_writeWatchUffd != -1));
+#else
     assert(!(flags & VirtualReserveFlags::WriteWatch) && "WriteWatch not supported on Unix");
+#endif // HAVE_PAGEMAP_SCAN
     if (alignment == 0)
     {
         alignment = OS_PAGE_SIZE;
     }
 
+#if HAVE_MADV_HUGEPAGE
+    // Transparent huge pages can only back naturally aligned large pages, so make sure that ranges
+    // big enough to contain one start on a large page boundary.
+    if ((flags & VirtualReserveFlags::LargePages) && (size >= TRANSPARENT_LARGE_PAGE_SIZE))
+    {
+        alignment = std::max(alignment, TRANSPARENT_LARGE_PAGE_SIZE);
+    }
+#endif // HAVE_MADV_HUGEPAGE
+
     size_t alignedSize = size + (alignment - OS_PAGE_SIZE);
     void * pRetVal = mmap(nullptr, alignedSize, PROT_NONE, MAP_ANON | MAP_PRIVATE | hugePagesFlag, -1, 0);
 
@@ -611,6 +659,36 @@ static void* VirtualReserveInner(size_t size, size_t alignment, uint32_t flags,
         }
 
         pRetVal = pAlignedRetVal;
+
+#if HAVE_MADV_HUGEPAGE
+        if (flags & VirtualReserveFlags::LargePages)
+        {
+            // The advice sticks to the mapping, so it also applies to the pages committed later. If the
+            // kernel refuses it, this range just uses regular pages.
+            if (madvise(pRetVal, size, MADV_HUGEPAGE) == 0)
+            {
+                g_transparentLargePagesUsed = true;
+            }
+        }
+#endif // HAVE_MADV_HUGEPAGE
+
+#if HAVE_PAGEMAP_SCAN
+        if (flags & VirtualReserveFlags::WriteWatch)
+        {
+            // The registration sticks to the mapping, so it also covers the pages committed later.
+            uffdio_register uffdRegister;
+            uffdRegister.range.start = (uint64_t)pRetVal;
+            uffdRegister.range.len = size;
+            uffdRegister.mode = UFFDIO_REGISTER_MODE_WP;
+            uffdRegister.ioctls = 0;
+
+            if (ioctl(g_writeWatchUffd, UFFDIO_REGISTER, &uffdRegister) != 0)
+            {
+                munmap(pRetVal, size);
+                return nullptr;
+            }
+        }
+#endif // HAVE_PAGEMAP_SCAN
     }
 
     return pRetVal;
@@ -681,13 +759,14 @@ bool GCToOSInterface::VirtualCommit(void* address, size_t size, uint16_t node)
     {
         if ((int)node <= g_highestNumaNode)
         {
+            const int bitsPerMaskWord = sizeof(unsigned long) * 8;
             int usedNodeMaskBits = g_highestNumaNode + 1;
-            int nodeMaskLength = (usedNodeMaskBits + sizeof(unsigned long) - 1) / sizeof(unsigned long);
+            int nodeMaskLength = (usedNodeMaskBits + bitsPerMaskWord - 1) / bitsPerMaskWord;
             unsigned long nodeMask[nodeMaskLength];
             memset(nodeMask, 0, sizeof(nodeMask));
 
-            int index = node / sizeof(unsigned long);
-            nodeMask[index] = ((unsigned long)1) << (node & (sizeof(unsigned long) - 1));
+            int index = node / bitsPerMaskWord;
+            nodeMask[index] = ((unsigned long)1) << (node % bitsPerMaskWord);
 
             int st = mbind(address, size, MPOL_PREFERRED, nodeMask, usedNodeMaskBits, 0);
             assert(st == 0);
@@ -707,12 +786,32 @@ bool GCToOSInterface::VirtualCommit(void* address, size_t size, uint16_t node)
 //  true if it has succeeded, false if it has failed
 bool GCToOSInterface::VirtualDecommit(void* address, size_t size)
 {
+#if HAVE_PAGEMAP_SCAN
+    if (g_writeWatchUffd != -1)
+    {
+        // Replacing the mapping would drop its write watch registration, so discard the pages in place
+        // instead. Private anonymous pages read as zeros once they are committed again.
+        return (madvise(address, size, MADV_DONTNEED) == 0) && (mprotect(address, size, PROT_NONE) == 0);
+    }
+#endif // HAVE_PAGEMAP_SCAN
+
     // TODO: This can fail, however the GC does not handle the failure gracefully
     // Explicitly calling mmap instead of mprotect here makes it
     // that much more clear to the operating system that we no
     // longer need these pages. Also, GC depends on re-commited pages to
     // be zeroed-out.
-    return mmap(address, size, PROT_NONE, MAP_FIXED | MAP_ANON | MAP_PRIVATE, -1, 0) != NULL;
+    bool success = mmap(address, size, PROT_NONE, MAP_FIXED | MAP_ANON | MAP_PRIVATE, -1, 0) != NULL;
+
+#if HAVE_MADV_HUGEPAGE
+    if (success && g_transparentLargePagesUsed)
+    {
+        // The new mapping doesn't carry over the large page advice of the one it replaced. Aside from the
+        // GC heap only handle table segments get decommitted, and those are too small for a large page.
+        madvise(address, size, MADV_HUGEPAGE);
+    }
+#endif // HAVE_MADV_HUGEPAGE
+
+    return success;
 }
 
 // Reset virtual memory range. Indicates that data in the memory range specified by address and size is no
@@ -744,7 +843,45 @@ bool GCToOSInterface::VirtualReset(void * address, size_t size, bool unlock)
 // Check if the OS supports write watching
 bool GCToOSInterface::SupportsWriteWatch()
 {
+#if HAVE_PAGEMAP_SCAN
+    if (g_writeWatchUffd != -1)
+    {
+        return true;
+    }
+
+    // Only user mode writes need to be tracked, which also lets unprivileged processes use userfaultfd.
+    int uffd = syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+    if (uffd == -1)
+    {
+        return false;
+    }
+
+    // Asynchronous write protection (Linux 6.7+) is what makes this usable: faults on protected pages are
+    // resolved by the kernel instead of being queued for a handler thread.
+    uffdio_api uffdApi;
+    uffdApi.api = UFFD_API;
+    uffdApi.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_UNPOPULATED;
+    uffdApi.ioctls = 0;
+
+    if (ioctl(uffd, UFFDIO_API, &uffdApi) != 0)
+    {
+        close(uffd);
+        return false;
+    }
+
+    int pagemap = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    if (pagemap == -1)
+    {
+        close(uffd);
+        return false;
+    }
+
+    g_writeWatchUffd = uffd;
+    g_writeWatchPagemap = pagemap;
+    return true;
+#else
     return false;
+#endif // HAVE_PAGEMAP_SCAN
 }
 
 // Reset the write tracking state for the specified virtual memory range.
@@ -753,7 +890,22 @@ bool GCToOSInterface::SupportsWriteWatch()
 //  size    - size of the virtual memory range
 void GCToOSInterface::ResetWriteWatch(void* address, size_t size)
 {
+#if HAVE_PAGEMAP_SCAN
+    assert(g_writeWatchUffd != -1);
+
+    uint64_t start = (uint64_t)address & ~(uint64_t)(OS_PAGE_SIZE - 1);
+    uint64_t end = ((uint64_t)address + size + OS_PAGE_SIZE - 1) & ~(uint64_t)(OS_PAGE_SIZE - 1);
+
+    uffdio_writeprotect writeProtect;
+    writeProtect.range.start = start;
+    writeProtect.range.len = end - start;
+    writeProtect.mode = UFFDIO_WRITEPROTECT_MODE_WP;
+
+    int st = ioctl(g_writeWatchUffd, UFFDIO_WRITEPROTECT, &writeProtect);
+    assert(st == 0);
+#else
     assert(!"should never call ResetWriteWatch on Unix");
+#endif // HAVE_PAGEMAP_SCAN
 }
 
 // Retrieve addresses of the pages that are written to in a region of virtual memory
@@ -768,14 +920,142 @@ void GCToOSInterface::ResetWriteWatch(void* address, size_t size)
 //  true if it has succeeded, false if it has failed
 bool GCToOSInterface::GetWriteWatch(bool resetState, void* address, size_t size, void** pageAddresses, uintptr_t* pageAddressesCount)
 {
+#if HAVE_PAGEMAP_SCAN
+    assert(g_writeWatchPagemap != -1);
+
+    uint64_t start = (uint64_t)address & ~(uint64_t)(OS_PAGE_SIZE - 1);
+    uint64_t end = ((uint64_t)address + size + OS_PAGE_SIZE - 1) & ~(uint64_t)(OS_PAGE_SIZE - 1);
+    uintptr_t maxCount = *pageAddressesCount;
+    uintptr_t count = 0;
+
+    // The kernel merges adjacent written pages into one region
+    page_region regions[64];
+
+    while ((start < end) && (count < maxCount))
+    {
+        pm_scan_arg scanArg;
+        memset(&scanArg, 0, sizeof(scanArg));
+        scanArg.size = sizeof(scanArg);
+        // Fail rather than silently skip ranges that are not registered for write watching. With
+        // PM_SCAN_WP_MATCHING the reported pages are write protected again in the same pass.
+        scanArg.flags = PM_SCAN_CHECK_WPASYNC | (resetState ? PM_SCAN_WP_MATCHING : 0);
+        scanArg.start = start;
+        scanArg.end = end;
+        scanArg.vec = (uint64_t)regions;
+        scanArg.vec_len = sizeof(regions) / sizeof(regions[0]);
+        scanArg.max_pages = maxCount - count;
+        scanArg.category_mask = PAGE_IS_WRITTEN;
+        scanArg.return_mask = PAGE_IS_WRITTEN;
+
+        int regionCount = ioctl(g_writeWatchPagemap, PAGEMAP_SCAN, &scanArg);
+        if (regionCount < 0)
+        {
+            return false;
+        }
+
+        for (int i = 0; i < regionCount; i++)
+        {
+            for (uint64_t page = regions[i].start; page < regions[i].end; page += OS_PAGE_SIZE)
+            {
+                assert(count < maxCount);
+                pageAddresses[count++] = (void*)page;
+            }
+        }
+
+        // The walk stops early when the regions or the page addresses buffer fill up
+        assert(scanArg.walk_end > start);
+        start = scanArg.walk_end;
+    }
+
+    *pageAddressesCount = count;
+    return true;
+#else
     assert(!"should never call GetWriteWatch on Unix");
     return false;
+#endif // HAVE_PAGEMAP_SCAN
+}
+
+// Get memory size multiplier based on the passed in units (k = kilo, m = mega, g = giga)
+static uint64_t GetMemorySizeMultiplier(char units)
+{
+    switch(units)
+    {
+        case 'g':
+        case 'G': return 1024 * 1024 * 1024;
+        case 'm':
+        case 'M': return 1024 * 1024;
+        case 'k':
+        case 'K': return 1024;
+    }
+
+    // No units multiplier
+    return 1;
 }
 
+#ifdef __linux__
+// Reads the first line of a small sysfs file into buffer. Returns false if the file can't be read.
+static bool ReadSysfsLine(const char* path, char* buffer, size_t bufferSize)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+        return false;
+
+    bool result = fgets(buffer, (int)bufferSize, file) != NULL;
+    fclose(file);
+    return result;
+}
+
+// Gets the size of the largest data or unified cache of any processor from the cache topology the kernel
+// describes in /sys/devices/system/cpu/cpu*/cache/index*. All processors are looked at rather than just the
+// first one since their caches differ on heterogeneous systems: on big.LITTLE parts the clusters have caches
+// of different sizes and processor 0 is typically a little core. sysconf, which reads the CPUID leaves on x86
+// and usually returns 0 on ARM, is only used when this isn't available.
+// Return:
+//  Size of the cache, 0 if the topology isn't available
+static size_t GetLogicalProcessorCacheSizeFromSysfs()
+{
+    size_t cacheSize = 0;
+
+    long processorCount = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu = 0; cpu < processorCount; cpu++)
+    {
+        for (int index = 0; ; index++)
+        {
+            char path[128];
+            char value[64];
+
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/cache/index%d/type", cpu, index);
+            if (!ReadSysfsLine(path, value, sizeof(value)))
+                break;
+
+            if (strncmp(value, "Instruction", 11) == 0)
+                continue;
+
+            snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/cache/index%d/size", cpu, index);
+            if (!ReadSysfsLine(path, value, sizeof(value)))
+                continue;
+
+            char units = '\0';
+            uint64_t size;
+            if (sscanf(value, "%" SCNu64 "%c", &size, &units) >= 1)
+                cacheSize = std::max(cacheSize, (size_t)(size * GetMemorySizeMultiplier(units)));
+        }
+    }
+
+    return cacheSize;
+}
+#endif // __linux__
+
 static size_t GetLogicalProcessorCacheSizeFromOS()
 {
     size_t cacheSize = 0;
 
+#ifdef __linux__
+    cacheSize = GetLogicalProcessorCacheSizeFromSysfs();
+    if (cacheSize != 0)
+        return cacheSize;
+#endif // __linux__
+
 #ifdef _SC_LEVEL1_DCACHE_SIZE
     cacheSize = std::max(cacheSize, ( size_t) sysconf(_SC_LEVEL1_DCACHE_SIZE));
 #endif
@@ -790,30 +1070,14 @@ static size_t GetLogicalProcessorCacheSizeFromOS()
 #endif
 
 #if defined(HOST_ARM64)
-    if (cacheSize == 0)
-    {
-        size_t size;
-
-        if (ReadMemoryValueFromFile("/sys/devices/system/cpu/cpu0/cache/index0/size", &size))
-            cacheSize = std::max(cacheSize, size);
-        if (ReadMemoryValueFromFile("/sys/devices/system/cpu/cpu0/cache/index1/size", &size))
-            cacheSize = std::max(cacheSize, size);
-        if (ReadMemoryValueFromFile("/sys/devices/system/cpu/cpu0/cache/index2/size", &size))
-            cacheSize = std::max(cacheSize, size);
-        if (ReadMemoryValueFromFile("/sys/devices/system/cpu/cpu0/cache/index3/size", &size))
-            cacheSize = std::max(cacheSize, size);
-        if (ReadMemoryValueFromFile("/sys/devices/system/cpu/cpu0/cache/index4/size", &size))
-            cacheSize = std::max(cacheSize, size);
-    }
-
     if (cacheSize == 0)
     {
         // It is currently expected to be missing cache size info
         //
         // _SC_LEVEL*_*CACHE_SIZE is not yet present.  Work is in progress to enable this for arm64
         //
-        // /sys/devices/system/cpu/cpu*/cache/index*/ is also not yet present in most systems.
-        // Arm64 patch is in Linux kernel tip.
+        // /sys/devices/system/cpu/cpu*/cache/index*/ (read above) is not present on all systems, in
+        // particular on older kernels and in some virtual machines.
         //
         // midr_el1 is available in "/sys/devices/system/cpu/cpu0/regs/identification/midr_el1",
         // but without an exhaustive list of ARM64 processors any decode of midr_el1
@@ -851,23 +1115,6 @@ static size_t GetLogicalProcessorCacheSizeFromOS()
     return cacheSize;
 }
 
-// Get memory size multiplier based on the passed in units (k = kilo, m = mega, g = giga)
-static uint64_t GetMemorySizeMultiplier(char units)
-{
-    switch(units)
-    {
-        case 'g':
-        case 'G': return 1024 * 1024 * 1024;
-        case 'm':
-        case 'M': return 1024 * 1024;
-        case 'k':
-        case 'K': return 1024;
-    }
-
-    // No units multiplier
-    return 1;
-}
-
 #ifndef __APPLE__
 // Try to read the MemAvailable entry from /proc/meminfo.
 // Return true if the /proc/meminfo existed, the entry was present and we were able to parse it.
@@ -967,6 +1214,16 @@ bool GCToOSInterface::BoostThreadPriority()
     return false;
 }
 
+// Get the total time the process was kept from running because it used up its CPU quota.
+// Parameters:
+//  throttledMicroseconds - receives the time in microseconds
+// Return:
+//  true if the process has a CPU quota and the time could be read, false otherwise.
+bool GCToOSInterface::GetCpuThrottledTime(uint64_t* throttledMicroseconds)
+{
+    return ::GetCpuThrottledTime(throttledMicroseconds);
+}
+
 // Set the set of processors enabled for GC threads for the current process based on config specified affinity mask and set
 // Parameters:
 //  configAffinityMask - mask specified by the GCHeapAffinitizeMask config
@@ -1072,6 +1329,36 @@ uint64_t GCToOSInterface::GetPhysicalMemoryLimit(bool* is_restricted)
 #endif // HAVE_SYSCTL
 }
 
+// Re-read the memory and processor limits of the process, which can change while it runs in a container.
+// Return:
+//  true if any of the limits changed
+bool GCToOSInterface::RefreshResourceLimits()
+{
+    bool changed = false;
+
+    size_t restricted_limit = GetRestrictedPhysicalMemoryLimit();
+    if (restricted_limit != g_RestrictedPhysicalMemoryLimit)
+    {
+        VolatileStore(&g_RestrictedPhysicalMemoryLimit, restricted_limit);
+        changed = true;
+    }
+
+    uint32_t cpuCount = g_processAffinityCpuCount;
+    uint32_t cpuLimit;
+    if (GetCpuLimit(&cpuLimit) && cpuLimit < cpuCount)
+    {
+        cpuCount = cpuLimit;
+    }
+
+    if (cpuCount != g_currentProcessCpuCount)
+    {
+        VolatileStore(&g_currentProcessCpuCount, cpuCount);
+        changed = true;
+    }
+
+    return changed;
+}
+
 // Get amount of physical memory available for use in the system
 uint64_t GetAvailablePhysicalMemory()
 {
@@ -1298,7 +1585,42 @@ uint32_t GCToOSInterface::GetTotalProcessorCount()
 
 bool GCToOSInterface::CanEnableGCNumaAware()
 {
-    return g_numaAvailable;
+    return g_numaAvailable && GCConfig::GetGCNumaAware();
+}
+
+// Get the number of NUMA nodes and the highest number of processors of the process on any of them
+// Parameters:
+//  total_nodes        - set to the number of NUMA nodes
+//  max_procs_per_node - set to the highest number of processors on a node
+// Return:
+//  true if NUMA is enabled, false otherwise
+bool GCToOSInterface::GetNumaInfo(uint16_t* total_nodes, uint32_t* max_procs_per_node)
+{
+#if HAVE_NUMA_H
+    if (GCToOSInterface::CanEnableGCNumaAware())
+    {
+        uint32_t procsOnNode[MAX_SUPPORTED_CPUS] = {};
+        uint32_t maxProcsOnNode = 0;
+        for (size_t procNumber = 0; procNumber < MAX_SUPPORTED_CPUS; procNumber++)
+        {
+            if (g_processAffinitySet.Contains(procNumber))
+            {
+                int node = numa_node_of_cpu(procNumber);
+                if ((node >= 0) && (node < MAX_SUPPORTED_CPUS))
+                {
+                    procsOnNode[node]++;
+                    maxProcsOnNode = std::max(maxProcsOnNode, procsOnNode[node]);
+                }
+            }
+        }
+
+        *total_nodes = (uint16_t)(g_highestNumaNode + 1);
+        *max_procs_per_node = maxProcsOnNode;
+        return true;
+    }
+#endif // HAVE_NUMA_H
+
+    return false;
 }
 
 bool GCToOSInterface::CanEnableGCCPUGroups()
@@ -903,6 +903,17 @@ bool GCToOSInterface::BoostThreadPriority()
     return !!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST);
 }
 
+// Get the total time the process was kept from running because it used up its CPU quota.
+// Parameters:
+//  throttledMicroseconds - receives the time in microseconds
+// Return:
+//  true if the process has a CPU quota and the time could be read, false otherwise.
+bool GCToOSInterface::GetCpuThrottledTime(uint64_t* throttledMicroseconds)
+{
+    // Job object CPU rate control doesn't report the time the job was held back
+    return false;
+}
+
 // Set the set of processors enabled for GC threads for the current process based on config specified affinity mask and set
 // Parameters:
 //  configAffinityMask - mask specified by the GCHeapAffinitizeMask config
@@ -1033,6 +1044,16 @@ uint64_t GCToOSInterface::GetPhysicalMemoryLimit(bool* is_restricted)
     return memStatus.ullTotalPhys;
 }
 
+// Re-read the memory and processor limits of the process.
+// Return:
+//  true if any of the limits changed
+// Remarks:
+//  The job object limits are only read once, so they never change.
+bool GCToOSInterface::RefreshResourceLimits()
+{
+    return false;
+}
+
 // Get memory status
 // Parameters:
 //  restricted_limit - The amount of physical memory in bytes that the current process is being restricted to. If non-zero, it used to calculate
@@ -0,0 +1,89 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+//
+// Current processor lookup through a restartable sequences (rseq) area. Each thread registers an area with
+// the kernel the first time it asks, and the kernel keeps the cpu_id field of the area up to date whenever
+// the thread is scheduled, so later lookups are a single load from thread local storage instead of a call
+// into sched_getcpu. The runtime PAL, the GC PAL and CoreLib native code all include this header, and the
+// area is an inline function's thread local, so they share one registration per thread.
+//
+// The kernel only allows one area per thread. On a libc that registers its own, the registration here fails
+// and GetRseqCurrentProcessor returns -1 so callers fall back to sched_getcpu, which then reads the libc area.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/rseq.h>)
+#include <linux/rseq.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef SYS_rseq
+#define HAVE_RSEQ_CPU 1
+#endif
+#endif
+#endif
+
+#ifdef HAVE_RSEQ_CPU
+
+// Signature the kernel checks before aborting a restartable sequence, the same value libc uses on x86
+#define RSEQ_CPU_SIGNATURE 0x53053053
+
+class RseqCpuArea
+{
+public:
+    struct rseq m_rseq __attribute__((aligned(32)));
+
+    RseqCpuArea()
+    {
+        m_rseq = {};
+        m_rseq.cpu_id = RSEQ_CPU_ID_UNINITIALIZED;
+    }
+
+    // Thread local storage of a shared library can be freed before the thread is gone, so the area is
+    // unregistered before the kernel could write to freed memory.
+    ~RseqCpuArea()
+    {
+        if ((int32_t)m_rseq.cpu_id >= 0)
+            syscall(SYS_rseq, &m_rseq, sizeof(m_rseq), RSEQ_FLAG_UNREGISTER, RSEQ_CPU_SIGNATURE);
+    }
+
+    void Register()
+    {
+        if (syscall(SYS_rseq, &m_rseq, sizeof(m_rseq), 0, RSEQ_CPU_SIGNATURE) != 0)
+            m_rseq.cpu_id = RSEQ_CPU_ID_REGISTRATION_FAILED;
+    }
+};
+
+// Returns the processor the current thread is running on, or -1 if it isn't available through rseq.
+inline int32_t GetRseqCurrentProcessor()
+{
+    static thread_local RseqCpuArea s_area;
+
+    int32_t cpuId = *(volatile int32_t *)&s_area.m_rseq.cpu_id;
+    if (cpuId >= 0)
+        return cpuId;
+
+    if (cpuId == (int32_t)RSEQ_CPU_ID_UNINITIALIZED)
+    {
+        s_area.Register();
+        cpuId = *(volatile int32_t *)&s_area.m_rseq.cpu_id;
+        if (cpuId >= 0)
+            return cpuId;
+    }
+
+    return -1;
+}
+
+#else // HAVE_RSEQ_CPU
+
+inline int32_t GetRseqCurrentProcessor()
+{
+    return -1;
+}
+
+#endif // HAVE_RSEQ_CPU
@@ -16,6 +16,7 @@ static void *s_mrtAddr = nullptr;
 static void *s_bottomAddress = nullptr;
 static void *s_topAddress = nullptr;
 static DWORD s_pageSize = 0;
+static bool s_fDualMapped = false;
 extern HMODULE s_hRuntime;
 
 #if FEATURE_SINGLE_MODULE_RUNTIME
@@ -43,13 +44,19 @@ void InitMemoryStatics()
         s_bottomAddress = sysInfo.lpMinimumApplicationAddress;
         s_topAddress = sysInfo.lpMaximumApplicationAddress;
         s_pageSize = sysInfo.dwPageSize;
+
+        char value[2];
+        s_fDualMapped = GetEnvironmentVariableA("RH_JitWriteXorExecute", value, sizeof(value)) == 1 && value[0] == '1';
     });
 }
 
 
 ExecutableCodeHeap::ExecutableCodeHeap()
-: m_base(0), m_curr(0), m_commit(0), m_limit(0)
+: m_base(0), m_curr(0), m_commit(0), m_dataCurr(0), m_dataCommit(0), m_limit(0),
+  m_hSection(NULL), m_writableDelta(0)
 {
+    memset(m_codeFreeLists, 0, sizeof(m_codeFreeLists));
+    memset(m_dataFreeLists, 0, sizeof(m_dataFreeLists));
 }
 
 
@@ -62,36 +69,165 @@ bool ExecutableCodeHeap::Init(size_t size)
     // We must allocate code pages within an int32 of the runtime helpers, since the JIT only
     // emits call rel32 instructions.
     size = ALIGN_UP(size, s_pageSize);
-    m_base = ClrVirtualAllocWithinRange((BYTE*)s_mrtAddr - INT_MAX / 2, (BYTE*)s_mrtAddr + INT_MAX / 2,
-                                        size, MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    if (s_fDualMapped)
+    {
+        if (!ReserveDualMapped(size))
+            return false;
+    }
+    else
+    {
+        m_base = ClrVirtualAllocWithinRange((BYTE*)s_mrtAddr - INT_MAX / 2, (BYTE*)s_mrtAddr + INT_MAX / 2,
+                                            size, MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+    }
 
     m_curr = (size_t)m_base;
     m_commit = m_curr;
     m_limit = m_curr + size;
+    m_dataCurr = m_limit;
+    m_dataCommit = m_limit;
 
     return m_base != nullptr;
 }
 
-void *ExecutableCodeHeap::AllocMemory(size_t size, DWORD alignment)
+// Creates the section backing the heap and maps its two views. Only the execute view has to be within
+// rel32 range of the runtime.
+bool ExecutableCodeHeap::ReserveDualMapped(size_t size)
+{
+    m_hSection = CreateFileMappingW(INVALID_HANDLE_VALUE, NULL, PAGE_EXECUTE_READWRITE | SEC_RESERVE,
+                                    (DWORD)((ULONGLONG)size >> 32), (DWORD)size, NULL);
+    if (m_hSection == NULL)
+        return false;
+
+    void *pWritable = MapViewOfFile(m_hSection, FILE_MAP_WRITE, 0, 0, size);
+    if (pWritable != nullptr)
+    {
+        // There is no way to map a view within a range, so find a free range by reserving it and map
+        // the view in its place once it is released. Another thread may grab the range in between.
+        for (int attempt = 0; attempt < 8 && m_base == nullptr; attempt++)
+        {
+            BYTE *pRange = ClrVirtualAllocWithinRange((BYTE*)s_mrtAddr - INT_MAX / 2, (BYTE*)s_mrtAddr + INT_MAX / 2,
+                                                      size, MEM_RESERVE, PAGE_NOACCESS);
+            if (pRange == nullptr)
+                break;
+
+            VirtualFree(pRange, 0, MEM_RELEASE);
+            m_base = MapViewOfFileEx(m_hSection, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, size, pRange);
+        }
+
+        if (m_base != nullptr)
+        {
+            m_writableDelta = (BYTE*)pWritable - (BYTE*)m_base;
+            return true;
+        }
+
+        UnmapViewOfFile(pWritable);
+    }
+
+    CloseHandle(m_hSection);
+    m_hSection = NULL;
+    return false;
+}
+
+// Returns the size class of a block of the given size, NumSizeClasses if it is bigger than all of them.
+int ExecutableCodeHeap::GetSizeClass(size_t size)
+{
+    int sizeClass = 0;
+    while (sizeClass < NumSizeClasses && ((size_t)1 << (sizeClass + MinSizeClassShift)) < size)
+        sizeClass++;
+
+    return sizeClass;
+}
+
+size_t ExecutableCodeHeap::RoundUpToSizeClass(size_t size)
+{
+    int sizeClass = GetSizeClass(size);
+    if (sizeClass == NumSizeClasses)
+        return ALIGN_UP(size, sizeof(void*));
+
+    return (size_t)1 << (sizeClass + MinSizeClassShift);
+}
+
+void *ExecutableCodeHeap::AllocFromFreeList(FreeBlock **freeLists, size_t size, size_t *pBlockSize)
+{
+    int sizeClass = GetSizeClass(size);
+
+    // Any block of a size class fits, and so does any block of a larger one.
+    for (int i = sizeClass; i < NumSizeClasses; i++)
+    {
+        FreeBlock *pBlock = freeLists[i];
+        if (pBlock != nullptr)
+        {
+            freeLists[i] = pBlock->m_pNext;
+            *pBlockSize = pBlock->m_size;
+            return pBlock;
+        }
+    }
+
+    // Blocks in the last list have arbitrary sizes.
+    for (FreeBlock **ppBlock = &freeLists[NumSizeClasses]; *ppBlock != nullptr; ppBlock = &(*ppBlock)->m_pNext)
+    {
+        FreeBlock *pBlock = *ppBlock;
+        if (pBlock->m_size >= size)
+        {
+            *ppBlock = pBlock->m_pNext;
+            *pBlockSize = pBlock->m_size;
+            return pBlock;
+        }
+    }
+
+    return nullptr;
+}
+
+void ExecutableCodeHeap::AddToFreeList(FreeBlock **freeLists, void *pBlock, size_t blockSize)
+{
+    // Blocks are only ever rounded up to their class, so a block is at least the size of its class.
+    int sizeClass = GetSizeClass(blockSize);
+    if (sizeClass < NumSizeClasses && ((size_t)1 << (sizeClass + MinSizeClassShift)) != blockSize)
+        sizeClass--;
+
+    // The block is linked by its executable address, but written through the writable one.
+    FreeBlock *pFreeBlock = GetWritableAddress((FreeBlock *)pBlock);
+    pFreeBlock->m_size = blockSize;
+    pFreeBlock->m_pNext = freeLists[sizeClass];
+    freeLists[sizeClass] = (FreeBlock *)pBlock;
+}
+
+// Data blocks are preceded by their size so that they can be freed.
+void *ExecutableCodeHeap::AllocData(size_t size)
 {
     assert(size > 0);
-    assert(alignment > 0);
     assert(m_curr != 0);
 
-    // The location we will start allocating from.
-    size_t curr = ALIGN_UP(m_curr, alignment);
+    size_t blockSize = RoundUpToSizeClass(sizeof(size_t) + size);
 
-    // Check that we haven't filled the heap.
-    if (curr >= m_limit || size >= (m_limit - curr))
-        return nullptr;
+    void *pBlock = AllocFromFreeList(m_dataFreeLists, blockSize, &blockSize);
+    if (pBlock == nullptr)
+    {
+        size_t blockStart = m_dataCurr - blockSize;
 
-    // Commit pages, be sure to count the alignment change
-    if (!CommitPages(size + (curr - m_curr)))
-        return nullptr;
+        // Check that we haven't filled the heap. Data must not share a page with code.
+        if (blockSize > m_dataCurr - m_curr || blockStart < ALIGN_UP(m_curr, s_pageSize))
+            return nullptr;
 
-    void *result = (void*)curr;
-    m_curr = m_curr + size;
-    return result;
+        if (!CommitDataPages(blockStart))
+            return nullptr;
+
+        m_dataCurr = blockStart;
+        pBlock = (void*)blockStart;
+    }
+
+    *GetWritableAddress((size_t*)pBlock) = blockSize;
+    return (BYTE*)pBlock + sizeof(size_t);
+}
+
+void ExecutableCodeHeap::FreeData(void *pData)
+{
+    // Data that didn't fit into the heap was allocated separately and is never freed.
+    if ((size_t)pData < m_dataCurr || (size_t)pData >= m_limit)
+        return;
+
+    BYTE *pBlock = (BYTE*)pData - sizeof(size_t);
+    AddToFreeList(m_dataFreeLists, pBlock, *(size_t*)pBlock);
 }
 
 void *ExecutableCodeHeap::AllocPData(size_t size)
@@ -103,7 +239,7 @@ void *ExecutableCodeHeap::AllocPData(size_t size)
         MutexHolder lock(m_mutex);
         commit = m_commit;
 
-        void *result = AllocMemory(size, 1);
+        void *result = AllocData(size);
         if (result != nullptr)
             return result;
     }
@@ -114,12 +250,18 @@ void *ExecutableCodeHeap::AllocPData(size_t size)
                                       size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 }
 
+void ExecutableCodeHeap::FreePData(void *pData)
+{
+    MutexHolder lock(m_mutex);
+    FreeData(pData);
+}
+
 void *ExecutableCodeHeap::AllocEHInfoRaw(size_t size)
 {
     {
         // Try to alloc from our heap.
         MutexHolder lock(m_mutex);
-        void *result = AllocMemory(size, 1);
+        void *result = AllocData(size);
         if (result != nullptr)
             return result;
     }
@@ -129,7 +271,7 @@ void *ExecutableCodeHeap::AllocEHInfoRaw(size_t size)
     return ClrVirtualAllocWithinRange(NULL, NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
 }
 
-void *ExecutableCodeHeap::AllocMemoryWithCodeHeader_NoThrow(size_t codeSize, DWORD alignment)
+void *ExecutableCodeHeap::AllocMemoryWithCodeHeader_NoThrow(size_t codeSize, DWORD alignment, void **ppWritableCode)
 {
     assert(codeSize > 0);
     assert(alignment > 0);
@@ -137,56 +279,108 @@ void *ExecutableCodeHeap::AllocMemoryWithCodeHeader_NoThrow(size_t codeSize, DWO
 
     MutexHolder lock(m_mutex);
 
-    // The location we will start allocating from.  The header needs to be pointer aligned.
-    size_t hdrAlloc = ALIGN_UP(m_curr, sizeof(void*));
+    // Blocks start pointer aligned, which is enough for the header. The code must be aligned correctly too,
+    // so leave room for aligning it within any block.
     size_t hdrSize = sizeof(CodeHeader);
+    size_t blockSize = RoundUpToSizeClass(hdrSize + (alignment > sizeof(void*) ? alignment - sizeof(void*) : 0) + codeSize);
 
-    // The code must be aligned correctly too.
-    size_t codeAlloc = ALIGN_UP(hdrAlloc + hdrSize, alignment);
-    size_t newHeapEnd = codeAlloc + codeSize;
+    size_t blockStart = (size_t)AllocFromFreeList(m_codeFreeLists, blockSize, &blockSize);
+    if (blockStart == 0)
+    {
+        blockStart = ALIGN_UP(m_curr, sizeof(void*));
+        size_t newHeapEnd = blockStart + blockSize;
 
-    // Check that we haven't filled the heap.
-    if (newHeapEnd >= m_limit)
-        return nullptr;
+        // Check that we haven't filled the heap. Code must not share a page with data.
+        if (blockSize > m_dataCurr - blockStart || newHeapEnd > ALIGN_DOWN(m_dataCurr, s_pageSize))
+            return nullptr;
 
-    // Commit pages
-    if (!CommitPages(newHeapEnd - m_curr))
-        return nullptr;
+        // Commit pages
+        if (!CommitCodePages(newHeapEnd))
+            return nullptr;
 
-    // Update heap
-    m_curr = newHeapEnd;
+        // Update heap
+        m_curr = newHeapEnd;
+    }
 
     // Calculate return value.
-    void *result = (void*)codeAlloc;
+    void *result = (void*)ALIGN_UP(blockStart + hdrSize, alignment);
     assert(ALIGN_UP(result, alignment) == result);
-    
-    CodeHeader *header = new ((void*)hdrAlloc)CodeHeader(m_base, (DWORD)((BYTE*)result - (BYTE*)m_base));
+    assert((size_t)result + codeSize <= blockStart + blockSize);
+
+    CodeHeader *header = new (GetWritableAddress((BYTE*)result - hdrSize))CodeHeader(m_base, (DWORD)((BYTE*)result - (BYTE*)m_base));
     assert(ALIGN_UP(header, sizeof(void*)) == header);
+    header->SetBlock((DWORD)(blockStart - (size_t)m_base), blockSize, codeSize);
 
     assert(result == header->GetCode());
+
+    if (ppWritableCode != nullptr)
+        *ppWritableCode = GetWritableAddress(result);
+
     return result;
 }
 
-bool ExecutableCodeHeap::CommitPages(size_t size)
+void ExecutableCodeHeap::FreeMemoryWithCodeHeader(void *pCode)
+{
+    CodeHeader *header = GetWritableAddress((CodeHeader*)((BYTE*)pCode - sizeof(CodeHeader)));
+    void *pBlock = (BYTE*)m_base + header->GetBlockOffset();
+    size_t blockSize = header->GetBlockSize();
+
+    header->~CodeHeader();
+
+    MutexHolder lock(m_mutex);
+    AddToFreeList(m_codeFreeLists, pBlock, blockSize);
+}
+
+// Commits [start, start + size) in both views. In the execute view code is never writable and data is only readable.
+bool ExecutableCodeHeap::CommitPages(size_t start, size_t size, bool executable)
+{
+    if (!IsDualMapped())
+        return VirtualAlloc((LPVOID)start, size, MEM_COMMIT, executable ? PAGE_EXECUTE_READWRITE : PAGE_READWRITE) != nullptr;
+
+    // Committing through one view commits the pages of the section; the other view still needs its protection set.
+    if (VirtualAlloc((LPVOID)(start + m_writableDelta), size, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+        return false;
+
+    return VirtualAlloc((LPVOID)start, size, MEM_COMMIT, executable ? PAGE_EXECUTE_READ : PAGE_READONLY) != nullptr;
+}
+
+bool ExecutableCodeHeap::CommitCodePages(size_t end)
 {
     // Do we need to commit anything?
-    if (m_curr + size <= m_commit)
+    if (end <= m_commit)
         return true;
 
     // Have we reserved enough memory to complete this request?
-    size = ALIGN_UP(size, s_pageSize);
-    if (m_commit + size > m_limit)
+    size_t size = ALIGN_UP(end - m_commit, s_pageSize);
+    if (m_commit + size > m_dataCommit)
         return false;
 
     // Commit pages
-    void *result = VirtualAlloc((LPVOID)m_commit, size, MEM_COMMIT, PAGE_EXECUTE_READWRITE);
-    if (result == nullptr)
+    if (!CommitPages(m_commit, size, true))
         return false;
 
     m_commit += size;
     return true;
 }
 
+bool ExecutableCodeHeap::CommitDataPages(size_t start)
+{
+    // Do we need to commit anything?
+    if (start >= m_dataCommit)
+        return true;
+
+    size_t size = ALIGN_UP(m_dataCommit - start, s_pageSize);
+    if (m_dataCommit - size < m_commit)
+        return false;
+
+    // Data is never executed
+    if (!CommitPages(m_dataCommit - size, size, false))
+        return false;
+
+    m_dataCommit -= size;
+    return true;
+}
+
 
 #define TOP_MEMORY (s_topAddress)
 #define BOT_MEMORY (s_bottomAddress)
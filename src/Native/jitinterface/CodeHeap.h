@@ -14,6 +14,18 @@
  * This heap does not dynamically grow, instead it stays a fixed size.  This is
  * important since we must report the exact bounds of each JIT manager to the
  * runtime.
+ *
+ * Code is allocated upwards from the base of the heap and data (unwind and EH
+ * info) downwards from its limit, so that method bodies stay densely packed
+ * for the instruction cache and data never shares a page with code. Freed
+ * blocks go back to size-class free lists and are reused by later allocations
+ * of the same kind.
+ *
+ * When RH_JitWriteXorExecute=1 is set in the environment, the heap is a section
+ * mapped twice: an execute view at GetBase() whose code pages are never
+ * writable and data pages are read only, and a read/write alias view that all
+ * writes (instructions, headers, unwind and EH data) go through.  Otherwise
+ * the two views are the same and code pages are read/write/execute.
  */
 class ExecutableCodeHeap
 {
@@ -32,35 +44,86 @@ public:
     // Returns the size (in bytes) of this heap.
     inline size_t GetSize() const { return m_limit - (size_t)m_base; }
 
-    // Allocates a chunk of executable memory.
-    void *AllocMemory_NoThrow(size_t size, DWORD alignment);
+    // Returns true if the heap is mapped separately for writing and for execution.
+    inline bool IsDualMapped() const { return m_writableDelta != 0; }
+
+    /* Returns the address through which memory of this heap at "p" can be
+     * written.  Addresses outside of the heap are returned unchanged.
+     */
+    template <class T>
+    inline T *GetWritableAddress(T *p) const
+    {
+        if ((size_t)p < (size_t)m_base || (size_t)p >= m_limit)
+            return p;
+
+        return (T*)((BYTE*)p + m_writableDelta);
+    }
 
     /* Allocates a chunk of executable memory with a CodeHeader before it.
-     * Returns the address of memory to write instructions to (that is,
-     * this function returns the pointer AFTER the CodeHeader).  The code
-     * header is placed at retval-ALIGN_UP(sizeof(CodeHeader), alignment).
+     * Returns the address the code will execute at (that is, this function
+     * returns the pointer AFTER the CodeHeader).  The code header is placed
+     * at retval-sizeof(CodeHeader).  If ppWritableCode is not null, it
+     * receives the address to write the instructions to.
+     */
+    void *AllocMemoryWithCodeHeader_NoThrow(size_t size, DWORD alignment, void **ppWritableCode = nullptr);
+
+    /* Returns memory allocated with AllocMemoryWithCodeHeader_NoThrow to the
+     * heap.  The caller must guarantee that the code can no longer be called
+     * and that no thread has it on its stack.
      */
-    void *AllocMemoryWithCodeHeader_NoThrow(size_t size, DWORD alignment);
+    void FreeMemoryWithCodeHeader(void *pCode);
 
     /* Allocates space for PData in the correct location (unwind data must
      * be located AFTER the code it referrs to, within a DWORD from it).
      */
     void *AllocPData(size_t size);
 
+    // Returns memory allocated with AllocPData to the heap.
+    void FreePData(void *pData);
+
     /*Allocate space for EH info
     */
     void *AllocEHInfoRaw(size_t size);
 
 private:
-    void *AllocMemory(size_t size, DWORD alignment);
-    bool CommitPages(size_t len);
+    // Blocks up to the largest size class are rounded up to their class so
+    // that any free block of a class fits any request of that class. Bigger
+    // blocks are kept in one more list that is searched first fit.
+    static const int MinSizeClassShift = 6;     // 64 bytes
+    static const int NumSizeClasses = 11;       // up to 64 KB
+
+    struct FreeBlock
+    {
+        FreeBlock *m_pNext;
+        size_t m_size;
+    };
+
+    static int GetSizeClass(size_t size);
+    static size_t RoundUpToSizeClass(size_t size);
+    static void *AllocFromFreeList(FreeBlock **freeLists, size_t size, size_t *pBlockSize);
+    void AddToFreeList(FreeBlock **freeLists, void *pBlock, size_t blockSize);
+
+    bool ReserveDualMapped(size_t size);
+    void *AllocData(size_t size);
+    void FreeData(void *pData);
+    bool CommitPages(size_t start, size_t size, bool executable);
+    bool CommitCodePages(size_t end);
+    bool CommitDataPages(size_t start);
 
 private:
     void *m_base;               // The base address where we started allocating
-    volatile size_t m_curr;     // The current "used" line of memory.
-    volatile size_t m_commit;   // The committed memory line.
+    volatile size_t m_curr;     // The current "used" line of code memory.
+    volatile size_t m_commit;   // The committed code memory line.
+    volatile size_t m_dataCurr;     // The current "used" line of data memory, growing down.
+    volatile size_t m_dataCommit;   // The committed data memory line.
     volatile size_t m_limit;    // The limit of memory this heap can use (also the reserved line).
 
+    HANDLE m_hSection;          // The section backing both views when dual mapped.
+    ptrdiff_t m_writableDelta;  // Distance from the execute view to the writable view, 0 if single mapped.
+
+    FreeBlock *m_codeFreeLists[NumSizeClasses + 1];
+    FreeBlock *m_dataFreeLists[NumSizeClasses + 1];
+
     std::mutex m_mutex;
     typedef std::lock_guard<std::mutex> MutexHolder;
 };
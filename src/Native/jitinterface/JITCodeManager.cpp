@@ -8,6 +8,7 @@
 
 #include "CodeHeap.h"
 #include <mutex>
+#include <algorithm>
 
 #include "../Runtime/coreclr/GCInfoDecoder.h"
 
@@ -83,6 +84,7 @@ enum CORINFO_EH_CLAUSE_FLAGS
 
 extern "C" __declspec(dllexport) void __stdcall InitJitCodeManager(HMODULE mrtModule);
 extern "C" __declspec(dllexport) void* __stdcall AllocJittedCode(UInt32 cbCode, UInt32 align, JITCodeManager** pCodeManager);
+extern "C" __declspec(dllexport) void* __stdcall AllocJittedCodeWithWritableAlias(UInt32 cbCode, UInt32 align, JITCodeManager** pCodeManager, void** ppWritableCode);
 extern "C" __declspec(dllexport) void __stdcall SetEHInfoPtr(JITCodeManager* pCodeManager, uint8_t *pbCode, void* ehInfo);
 
 extern "C" __declspec(dllexport) PTR_RUNTIME_FUNCTION __stdcall PublishRuntimeFunction(
@@ -96,7 +98,27 @@ extern "C" __declspec(dllexport) PTR_RUNTIME_FUNCTION __stdcall PublishRuntimeFu
     uint8_t* pGCData, 
     UInt32 cbGCData);
 
+// A runtime function to publish with PublishRuntimeFunctionBatch. The arguments are the same as the ones
+// of PublishRuntimeFunction, except that funclets refer to their main method by its index in the batch.
+struct RuntimeFunctionBatchEntry
+{
+    uint8_t *pbCode;
+    Int32 mainFunctionIndex;    // -1 for main methods
+    UInt32 startOffset;
+    UInt32 endOffset;
+    uint8_t *pUnwindInfo;
+    UInt32 cbUnwindInfo;
+    uint8_t *pGCData;
+    UInt32 cbGCData;
+};
+
+extern "C" __declspec(dllexport) bool __stdcall PublishRuntimeFunctionBatch(
+    JITCodeManager *pCodeManager,
+    RuntimeFunctionBatchEntry *pEntries,
+    UInt32 cEntries);
+
 extern "C" __declspec(dllexport) void __stdcall UpdateRuntimeFunctionTable(JITCodeManager *pCodeManager);
+extern "C" __declspec(dllexport) void __stdcall FreeJittedCode(JITCodeManager *pCodeManager, uint8_t *pbCode);
 
 __declspec(dllexport) void __stdcall InitJitCodeManager(HMODULE mrtModule)
 {
@@ -110,6 +132,15 @@ __declspec(dllexport) void* __stdcall AllocJittedCode(UInt32 cbCode, UInt32 alig
     return pCode;
 }
 
+// Like AllocJittedCode, but also returns the address the code has to be written to. The returned code
+// address is where it executes and is the one to pass to the other exports.
+__declspec(dllexport) void* __stdcall AllocJittedCodeWithWritableAlias(UInt32 cbCode, UInt32 align, JITCodeManager** pCodeManager, void** ppWritableCode)
+{
+    void *pCode;
+    JITCodeManager::AllocCode(cbCode, align, &pCode, pCodeManager, ppWritableCode);
+    return pCode;
+}
+
 CodeHeader *GetCodeHeader(uint8_t* pbCode)
 {
     return (CodeHeader*)((BYTE*)pbCode - sizeof(CodeHeader));
@@ -117,7 +148,7 @@ CodeHeader *GetCodeHeader(uint8_t* pbCode)
 
 __declspec(dllexport) void __stdcall SetEHInfoPtr(JITCodeManager* pCodeManager, uint8_t *pbCode, void* ehInfo)
 {
-    CodeHeader *hdr = GetCodeHeader(pbCode);
+    CodeHeader *hdr = pCodeManager->GetWritableAddress(GetCodeHeader(pbCode));
     hdr->SetEHInfo(ehInfo);
 }
 
@@ -143,21 +174,68 @@ __declspec(dllexport) PTR_RUNTIME_FUNCTION __stdcall PublishRuntimeFunction(
     if (pUnwindData == nullptr)
         return nullptr;
 
-    memcpy(pUnwindData, pUnwindInfo, cbUnwindInfo);
-    memcpy(pUnwindData + cbUnwindInfo, pGCData, cbGCData);
+    uint8_t* pWritableUnwindData = pCodeManager->GetWritableAddress(pUnwindData);
+    memcpy(pWritableUnwindData, pUnwindInfo, cbUnwindInfo);
+    memcpy(pWritableUnwindData + cbUnwindInfo, pGCData, cbGCData);
     assert(pUnwindData > pdataBase);
     assert((LONGLONG)pUnwindData - (LONGLONG)pdataBase < (LONGLONG)INT_MAX);
     DWORD unwindData = (DWORD)((PBYTE)pUnwindData - pdataBase);
     return pCodeManager->AllocRuntimeFunction(pMainRuntimeFunction, beginAddr, endAddr, unwindData);
 }
 
+__declspec(dllexport) bool __stdcall PublishRuntimeFunctionBatch(
+    JITCodeManager *pCodeManager,
+    RuntimeFunctionBatchEntry *pEntries,
+    UInt32 cEntries)
+{
+    std::vector<RUNTIME_FUNCTION> functions(cEntries);
+    std::vector<DWORD> mainBeginAddresses(cEntries);
+
+    for (UInt32 i = 0; i < cEntries; i++)
+    {
+        RuntimeFunctionBatchEntry *pEntry = &pEntries[i];
+
+        CodeHeader *hdr = GetCodeHeader(pEntry->pbCode);
+        DWORD codeOffset = hdr->GetCodeOffset();
+        BYTE *pdataBase = (BYTE*)hdr->GetHeapBase();
+
+        uint8_t* pUnwindData = (uint8_t*)pCodeManager->AllocPData(pEntry->cbUnwindInfo + pEntry->cbGCData);
+        if (pUnwindData == nullptr)
+            return false;
+
+        uint8_t* pWritableUnwindData = pCodeManager->GetWritableAddress(pUnwindData);
+        memcpy(pWritableUnwindData, pEntry->pUnwindInfo, pEntry->cbUnwindInfo);
+        memcpy(pWritableUnwindData + pEntry->cbUnwindInfo, pEntry->pGCData, pEntry->cbGCData);
+        assert(pUnwindData > pdataBase);
+        assert((LONGLONG)pUnwindData - (LONGLONG)pdataBase < (LONGLONG)INT_MAX);
+
+        functions[i].BeginAddress = codeOffset + pEntry->startOffset;
+        functions[i].EndAddress = codeOffset + pEntry->endOffset;
+        functions[i].UnwindData = (DWORD)((PBYTE)pUnwindData - pdataBase);
+
+        if (pEntry->mainFunctionIndex >= 0)
+        {
+            assert((UInt32)pEntry->mainFunctionIndex < i);
+            mainBeginAddresses[i] = functions[pEntry->mainFunctionIndex].BeginAddress;
+        }
+    }
+
+    pCodeManager->AddRuntimeFunctions(functions.data(), mainBeginAddresses.data(), cEntries);
+    return true;
+}
+
 __declspec(dllexport) void __stdcall UpdateRuntimeFunctionTable(JITCodeManager *pCodeManager)
 {
     pCodeManager->UpdateRuntimeFunctionTable();
 }
 
+__declspec(dllexport) void __stdcall FreeJittedCode(JITCodeManager *pCodeManager, uint8_t *pbCode)
+{
+    pCodeManager->FreeCode(pbCode);
+}
+
 CodeHeader::CodeHeader(void *heapBase, DWORD codeOffs)
-: m_heapBase((BYTE*)heapBase), m_codeOffset(codeOffs), m_ehInfo(NULL)
+: m_heapBase((BYTE*)heapBase), m_codeOffset(codeOffs), m_blockOffset(0), m_blockSize(0), m_codeSize(0), m_ehInfo(NULL)
 {
     assert(m_heapBase != nullptr);
     assert(codeOffs > 0);
@@ -167,7 +245,7 @@ CodeHeader::~CodeHeader()
 {
 }
 
-std::list<JITCodeManager*> JITCodeManager::s_instances;
+JITCodeManager::InstanceTable * volatile JITCodeManager::s_pInstances = nullptr;
 JITCodeManager * volatile JITCodeManager::s_pLastCodeManager = nullptr;
 std::mutex JITCodeManager::s_instanceLock;
 
@@ -177,15 +255,58 @@ JITCodeManager *JITCodeManager::FindCodeManager(PTR_VOID addr)
     if (curr != nullptr && curr->Contains(addr))
         return curr;
 
-    MutexHolder lock(s_instanceLock);
-    for (auto instance : s_instances)
-        if (instance->Contains(addr))
-            return instance;
+    InstanceTable *pInstances = s_pInstances;
+    if (pInstances == nullptr)
+        return nullptr;
+
+    // Find the last code manager that starts at or below addr, the ranges don't overlap.
+    size_t low = 0;
+    size_t high = pInstances->m_count;
+    while (low < high)
+    {
+        size_t mid = low + (high - low) / 2;
+        if (pInstances->m_instances[mid]->m_pvStartRange <= addr)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    if (low > 0 && pInstances->m_instances[low - 1]->Contains(addr))
+        return pInstances->m_instances[low - 1];
 
     return nullptr;
 }
 
-void JITCodeManager::AllocCode(size_t size, DWORD align, void **ppCode, JITCodeManager **ppManager)
+// Publishes a copy of the instance table with pCodeManager inserted. Must be called with s_instanceLock held.
+void JITCodeManager::AddInstance(JITCodeManager * pCodeManager)
+{
+    InstanceTable *pOldInstances = s_pInstances;
+    size_t oldCount = (pOldInstances != nullptr) ? pOldInstances->m_count : 0;
+
+    InstanceTable *pNewInstances = (InstanceTable *)new BYTE[offsetof(InstanceTable, m_instances) + sizeof(JITCodeManager*) * (oldCount + 1)];
+
+    size_t newCount = 0;
+    for (size_t i = 0; i < oldCount; i++)
+    {
+        JITCodeManager *instance = pOldInstances->m_instances[i];
+        if (pCodeManager != nullptr && pCodeManager->m_pvStartRange < instance->m_pvStartRange)
+        {
+            pNewInstances->m_instances[newCount++] = pCodeManager;
+            pCodeManager = nullptr;
+        }
+        pNewInstances->m_instances[newCount++] = instance;
+    }
+    if (pCodeManager != nullptr)
+        pNewInstances->m_instances[newCount++] = pCodeManager;
+
+    pNewInstances->m_count = newCount;
+
+    // Make sure the contents of the table are visible before the table is
+    MemoryBarrier();
+    s_pInstances = pNewInstances;
+}
+
+void JITCodeManager::AllocCode(size_t size, DWORD align, void **ppCode, JITCodeManager **ppManager, void **ppWritableCode)
 {
     assert(ppCode != nullptr);
     JITCodeManager *curr = s_pLastCodeManager;
@@ -195,7 +316,7 @@ void JITCodeManager::AllocCode(size_t size, DWORD align, void **ppCode, JITCodeM
     {
         if (curr != nullptr)
         {
-            void *result = curr->m_codeHeap.AllocMemoryWithCodeHeader_NoThrow(size, align);
+            void *result = curr->m_codeHeap.AllocMemoryWithCodeHeader_NoThrow(size, align, ppWritableCode);
             if (result != nullptr)
             {
                 *ppCode = result;
@@ -221,7 +342,7 @@ void JITCodeManager::AllocCode(size_t size, DWORD align, void **ppCode, JITCodeM
         if (!pCodeMgr->Initialize())
             DebugBreak();  // TODO: We need to clean up error handling in mrtjit.dll.
 
-        s_instances.push_back(pCodeMgr);
+        AddInstance(pCodeMgr);
         curr = s_pLastCodeManager = pCodeMgr;
     }
 }
@@ -232,7 +353,7 @@ void JITCodeManager::AllocCode(size_t size, DWORD align, void **ppCode, JITCodeM
 
 JITCodeManager::JITCodeManager() : 
     m_pvStartRange(0), m_cbRange(0), 
-    m_pRuntimeFunctionTable(NULL), m_nRuntimeFunctionTable(0)
+    m_pRuntimeFunctionTable(NULL), m_nRuntimeFunctionTable(0), m_cRuntimeFunctionTableCapacity(0)
 {
 #ifdef USE_GROWABLE_FUNCTION_TABLE
     m_hGrowableFunctionTable = NULL;
@@ -254,6 +375,8 @@ JITCodeManager::~JITCodeManager()
 #endif
 
     s_pfnUnregisterCodeManager(this);
+
+    delete[] m_pRuntimeFunctionTable;
 }
 
 bool JITCodeManager::Initialize()
@@ -271,8 +394,8 @@ PTR_RUNTIME_FUNCTION JITCodeManager::AllocRuntimeFunction(PTR_RUNTIME_FUNCTION m
 {
     SlimReaderWriterLock::WriteHolder lh(&m_lock);
 
-    m_runtimeFunctions.push_back(RUNTIME_FUNCTION());
-    PTR_RUNTIME_FUNCTION method = &m_runtimeFunctions.back();
+    m_pendingRuntimeFunctions.push_back(RUNTIME_FUNCTION());
+    PTR_RUNTIME_FUNCTION method = &m_pendingRuntimeFunctions.back();
 
     method->BeginAddress = beginAddr;
     method->EndAddress = endAddr;
@@ -285,43 +408,142 @@ PTR_RUNTIME_FUNCTION JITCodeManager::AllocRuntimeFunction(PTR_RUNTIME_FUNCTION m
     return method;
 }
 
+void JITCodeManager::AddRuntimeFunctions(const RUNTIME_FUNCTION *pFunctions, const DWORD *pMainBeginAddresses, UInt32 cFunctions)
+{
+    SlimReaderWriterLock::WriteHolder lh(&m_lock);
+
+    for (UInt32 i = 0; i < cFunctions; i++)
+    {
+        m_pendingRuntimeFunctions.push_back(pFunctions[i]);
+
+        if (pMainBeginAddresses[i] != 0)
+            m_FuncletToMainMethodMap[pFunctions[i].BeginAddress] = pMainBeginAddresses[i];
+    }
+
+    UpdateRuntimeFunctionTableLocked();
+}
+
+void JITCodeManager::FreeCode(void *pCode)
+{
+    CodeHeader *hdr = GetCodeHeader(pCode);
+    DWORD beginAddr = hdr->GetCodeOffset();
+    DWORD endAddr = beginAddr + (DWORD)hdr->GetCodeSize();
+
+    auto isInCode = [=](const RUNTIME_FUNCTION &function)
+    {
+        return function.BeginAddress >= beginAddr && function.BeginAddress < endAddr;
+    };
+
+    {
+        SlimReaderWriterLock::WriteHolder lh(&m_lock);
+
+        UpdateRuntimeFunctionTableLocked();
+
+        // The main method and all its funclets are contiguous in the sorted table
+        PTR_RUNTIME_FUNCTION pTableEnd = m_pRuntimeFunctionTable + m_nRuntimeFunctionTable;
+        PTR_RUNTIME_FUNCTION pFirst = std::find_if(m_pRuntimeFunctionTable, pTableEnd, isInCode);
+        PTR_RUNTIME_FUNCTION pLast = std::find_if_not(pFirst, pTableEnd, isInCode);
+
+        if (pFirst != pLast)
+        {
+            for (PTR_RUNTIME_FUNCTION pFunction = pFirst; pFunction != pLast; pFunction++)
+            {
+                m_FuncletToMainMethodMap.erase(pFunction->BeginAddress);
+                m_codeHeap.FreePData((BYTE*)m_pvStartRange + pFunction->UnwindData);
+            }
+
+            // The table may be in use outside of the lock, so publish a copy without the functions
+            PTR_RUNTIME_FUNCTION pNewTable = new RUNTIME_FUNCTION[m_cRuntimeFunctionTableCapacity];
+            PTR_RUNTIME_FUNCTION pNewTableEnd = std::copy(m_pRuntimeFunctionTable, pFirst, pNewTable);
+            pNewTableEnd = std::copy(pLast, pTableEnd, pNewTableEnd);
+
+            PublishRuntimeFunctionTable(pNewTable, (UInt32)(pNewTableEnd - pNewTable), m_cRuntimeFunctionTableCapacity);
+        }
+    }
+
+    m_codeHeap.FreeMemoryWithCodeHeader(pCode);
+}
+
+static bool CompareRuntimeFunctions(const RUNTIME_FUNCTION &a, const RUNTIME_FUNCTION &b)
+{
+    return a.BeginAddress < b.BeginAddress;
+}
 
 void JITCodeManager::UpdateRuntimeFunctionTable()
 {
     SlimReaderWriterLock::WriteHolder lh(&m_lock);
-    
-    PTR_RUNTIME_FUNCTION pFunctionTable = &m_runtimeFunctions[0];
-    DWORD nEntryCount = (DWORD)m_runtimeFunctions.size();
-    DWORD nMaximumEntryCount = (DWORD)m_runtimeFunctions.capacity();
+    UpdateRuntimeFunctionTableLocked();
+}
 
-#ifdef USE_GROWABLE_FUNCTION_TABLE
-    if (m_pRuntimeFunctionTable == pFunctionTable)
+// Publishes the pending functions
+void JITCodeManager::UpdateRuntimeFunctionTableLocked()
+{
+    if (m_pendingRuntimeFunctions.empty())
+        return;
+
+    // Functions are allocated in address order, unless freed code got reused
+    std::sort(m_pendingRuntimeFunctions.begin(), m_pendingRuntimeFunctions.end(), CompareRuntimeFunctions);
+
+    UInt32 nEntryCount = m_nRuntimeFunctionTable + (UInt32)m_pendingRuntimeFunctions.size();
+
+    bool fAppend = (nEntryCount <= m_cRuntimeFunctionTableCapacity) &&
+        ((m_nRuntimeFunctionTable == 0) ||
+         (m_pRuntimeFunctionTable[m_nRuntimeFunctionTable - 1].BeginAddress < m_pendingRuntimeFunctions.front().BeginAddress));
+
+    if (fAppend)
     {
+        // Lookups only look at the first m_nRuntimeFunctionTable entries, so the new ones can be written in
+        // place before they are published
+        std::copy(m_pendingRuntimeFunctions.begin(), m_pendingRuntimeFunctions.end(), m_pRuntimeFunctionTable + m_nRuntimeFunctionTable);
+
+#ifdef USE_GROWABLE_FUNCTION_TABLE
         if (m_hGrowableFunctionTable != NULL)
             RtlGrowFunctionTable(m_hGrowableFunctionTable, nEntryCount);
+#endif
+
+        m_nRuntimeFunctionTable = nEntryCount;
     }
     else
     {
-        if (m_hGrowableFunctionTable != NULL)
-        {
-            RtlDeleteGrowableFunctionTable(m_hGrowableFunctionTable);
-            m_hGrowableFunctionTable = NULL;
-        }
+        UInt32 nMaximumEntryCount = max(max(m_cRuntimeFunctionTableCapacity, nEntryCount) * 2, (UInt32)64);
 
-        // Note that there is a short time when the table is not published...
+        PTR_RUNTIME_FUNCTION pNewTable = new RUNTIME_FUNCTION[nMaximumEntryCount];
+        std::merge(m_pRuntimeFunctionTable, m_pRuntimeFunctionTable + m_nRuntimeFunctionTable,
+                   m_pendingRuntimeFunctions.begin(), m_pendingRuntimeFunctions.end(),
+                   pNewTable, CompareRuntimeFunctions);
 
-        DWORD ret = RtlAddGrowableFunctionTable(&m_hGrowableFunctionTable, pFunctionTable, nEntryCount, nMaximumEntryCount,
-                                                dac_cast<TADDR>(m_pvStartRange), dac_cast<TADDR>(m_pvStartRange) + m_cbRange);
-        if (ret != 0)
-        {
-            OutputDebugString(L"Failed to register unwindinfo");
-            m_hGrowableFunctionTable = NULL;
-        }
+        PublishRuntimeFunctionTable(pNewTable, nEntryCount, nMaximumEntryCount);
     }
+
+    m_pendingRuntimeFunctions.clear();
+}
+
+// Replaces the published table with pTable. The new table is registered before the old one is
+// unregistered, so unwinding through the code keeps working throughout.
+void JITCodeManager::PublishRuntimeFunctionTable(PTR_RUNTIME_FUNCTION pTable, UInt32 nEntries, UInt32 cCapacity)
+{
+#ifdef USE_GROWABLE_FUNCTION_TABLE
+    PVOID hNewGrowableFunctionTable = NULL;
+    DWORD ret = RtlAddGrowableFunctionTable(&hNewGrowableFunctionTable, pTable, nEntries, cCapacity,
+                                            dac_cast<TADDR>(m_pvStartRange), dac_cast<TADDR>(m_pvStartRange) + m_cbRange);
+    if (ret != 0)
+    {
+        OutputDebugString(L"Failed to register unwindinfo");
+        hNewGrowableFunctionTable = NULL;
+    }
+
+    if (m_hGrowableFunctionTable != NULL)
+        RtlDeleteGrowableFunctionTable(m_hGrowableFunctionTable);
+
+    m_hGrowableFunctionTable = hNewGrowableFunctionTable;
 #endif
 
-    m_pRuntimeFunctionTable = pFunctionTable;
-    m_nRuntimeFunctionTable = nEntryCount;
+    // Lookups hold the lock, so nobody can be using the old table anymore
+    delete[] m_pRuntimeFunctionTable;
+
+    m_pRuntimeFunctionTable = pTable;
+    m_nRuntimeFunctionTable = nEntries;
+    m_cRuntimeFunctionTableCapacity = cCapacity;
 }
 
 static int LookupUnwindInfoForMethod(UInt32 RelativePc,
@@ -355,10 +577,10 @@ static int LookupUnwindInfoForMethod(UInt32 RelativePc,
 
     for (int i = Low; i <= High; ++i)
     {
-        // This is safe because of entries are terminated by sentinel value (DWORD)-1
+        // The last entry extends to the end of the table
         PTR_RUNTIME_FUNCTION pNextFunctionEntry = pRuntimeFunctionTable + (i + 1);
 
-        if (RelativePc < pNextFunctionEntry->BeginAddress)
+        if (i == High || RelativePc < pNextFunctionEntry->BeginAddress)
         {
             PTR_RUNTIME_FUNCTION pFunctionEntry = pRuntimeFunctionTable + i;
             if (RelativePc >= pFunctionEntry->BeginAddress)
@@ -6,8 +6,8 @@
 
 #include "CodeHeap.h"
 
-#include <list>
 #include <vector>
+#include <deque>
 #include <unordered_map>
 #include <mutex>
 
@@ -125,6 +125,29 @@ public:
     {
         return m_heapBase;
     }
+
+    // Records the heap block the code was allocated in, so that it can be freed
+    inline void SetBlock(DWORD blockOffset, size_t blockSize, size_t codeSize)
+    {
+        m_blockOffset = blockOffset;
+        m_blockSize = blockSize;
+        m_codeSize = codeSize;
+    }
+
+    inline DWORD GetBlockOffset() const
+    {
+        return m_blockOffset;
+    }
+
+    inline size_t GetBlockSize() const
+    {
+        return m_blockSize;
+    }
+
+    inline size_t GetCodeSize() const
+    {
+        return m_codeSize;
+    }
     
     inline void SetEHInfo(void *ehInfo)
     {
@@ -153,6 +176,9 @@ public:
 private:
     BYTE *m_heapBase;
     DWORD m_codeOffset;
+    DWORD m_blockOffset;
+    size_t m_blockSize;
+    size_t m_codeSize;
 
     // Exception handling clauses
     // Storage layout: <Number of EH clauses><Clause1>...<ClauseN>
@@ -166,12 +192,20 @@ class JITCodeManager : ICodeManager
     PTR_VOID m_pvStartRange;
     UInt32 m_cbRange;
 
-    // lock to protect m_runtimeFunctions and m_FuncletToMainMethodMap
+    // lock to protect the runtime function tables and m_FuncletToMainMethodMap
     SlimReaderWriterLock m_lock;
 
-    std::vector<RUNTIME_FUNCTION> m_runtimeFunctions;
+    // Functions allocated since the table was last published. This is a deque so that the entries handed
+    // out by AllocRuntimeFunction stay in place until they are published.
+    std::deque<RUNTIME_FUNCTION> m_pendingRuntimeFunctions;
+
+    // The published table, sorted by address. Its storage has room for m_cRuntimeFunctionTableCapacity
+    // entries so that functions following the last published one can be appended in place. Any other
+    // change builds a complete new table that is published before the old one is released, so there is
+    // never a window where the functions are not published.
     PTR_RUNTIME_FUNCTION m_pRuntimeFunctionTable;
     UInt32 m_nRuntimeFunctionTable;
+    UInt32 m_cRuntimeFunctionTableCapacity;
 
 #ifdef USE_GROWABLE_FUNCTION_TABLE
     PTR_VOID m_hGrowableFunctionTable;
@@ -186,11 +220,22 @@ class JITCodeManager : ICodeManager
     // that it will be easy to refactor into a better/more permanent version later.
     ExecutableCodeHeap m_codeHeap;
 
-    static std::list<JITCodeManager*> s_instances;
+    // Immutable array of all the code managers sorted by start address. It is replaced (under s_instanceLock)
+    // whenever a code manager is added, so FindCodeManager can binary search it without taking the lock.
+    // Replaced arrays are never freed since lookups may still be using them; there is one per code heap.
+    struct InstanceTable
+    {
+        size_t m_count;
+        JITCodeManager * m_instances[1];    // Actually m_count entries
+    };
+
+    static InstanceTable * volatile s_pInstances;
     static JITCodeManager * volatile s_pLastCodeManager;
     static std::mutex s_instanceLock;
     typedef std::lock_guard<std::mutex> MutexHolder;
 
+    static void AddInstance(JITCodeManager * pCodeManager);
+
     // Get the code header given method's start address
     static inline CodeHeader* GetCodeHeader(void *methodStart)
     {
@@ -202,8 +247,9 @@ public:
     static JITCodeManager *FindCodeManager(PTR_VOID addr);
 
     // Finds a JITCodeManager instance with free space and allocates executable memory.
-    // This function throws on failure, and passes out the code address and JIT manager used.
-    static void AllocCode(size_t size, DWORD align, void **ppCode, JITCodeManager **ppManager);
+    // This function throws on failure, and passes out the code address, the address to write the code
+    // to (the same unless the code heap is dual mapped) and the JIT manager used.
+    static void AllocCode(size_t size, DWORD align, void **ppCode, JITCodeManager **ppManager, void **ppWritableCode = nullptr);
 
 public:
     JITCodeManager();
@@ -216,18 +262,33 @@ public:
         return m_codeHeap.AllocPData(size);
     }
 
+    // Returns the address through which the code heap memory at "p" can be written.
+    template <class T>
+    T *GetWritableAddress(T *p) const
+    {
+        return m_codeHeap.GetWritableAddress(p);
+    }
+
     void *AllocEHInfo(CodeHeader *hdr, unsigned cEH)
     {
         size_t size = sizeof(size_t)+sizeof(struct EHClause) * cEH;
         size_t *ehInfo = (size_t *)m_codeHeap.AllocEHInfoRaw(size);
-        *ehInfo = cEH;
-        hdr->SetEHInfo(ehInfo + 1);
+        *GetWritableAddress(ehInfo) = cEH;
+        GetWritableAddress(hdr)->SetEHInfo(ehInfo + 1);
         
         return ehInfo;
     }
 
     PTR_RUNTIME_FUNCTION AllocRuntimeFunction(PTR_RUNTIME_FUNCTION mainMethod, DWORD beginAddr, DWORD endAddr, DWORD unwindData);
 
+    // Adds a batch of runtime functions and publishes them at once. pMainBeginAddresses gives the BeginAddress
+    // of the main method of each funclet, or 0 for main methods.
+    void AddRuntimeFunctions(const RUNTIME_FUNCTION *pFunctions, const DWORD *pMainBeginAddresses, UInt32 cFunctions);
+
+    // Unregisters the runtime functions of a method and returns its code and unwind data to the code heap.
+    // The caller must guarantee that the code can no longer be called and that no thread has it on its stack.
+    void FreeCode(void *pCode);
+
     inline bool Contains(void *pCode) const
     {
         return m_pvStartRange <= pCode && pCode < (void*)((BYTE*)m_pvStartRange + m_cbRange);
@@ -236,6 +297,12 @@ public:
 
     void UpdateRuntimeFunctionTable();
 
+private:
+    void UpdateRuntimeFunctionTableLocked();
+    void PublishRuntimeFunctionTable(PTR_RUNTIME_FUNCTION pTable, UInt32 nEntries, UInt32 cCapacity);
+
+public:
+
     //
     // Code manager methods
     //
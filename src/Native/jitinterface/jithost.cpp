@@ -21,6 +21,71 @@ public:
         ) = 0;
 };
 
+// Per-thread cache of the slabs of RyuJIT's arena allocator. The compiler compiles methods on many threads and
+// every method allocates and frees its arena slabs, so most slabs can be reused right away by the next method
+// compiled on the same thread without going through the C heap. Only slabs of the standard size are cached,
+// requests for less get a slab of the standard size.
+//
+// The cache holds at most MaxCachedSlabs slabs. Every DecayInterval slab allocations it frees half of the slabs
+// that stayed in the cache during the whole interval, so a thread that is done with a large method doesn't keep
+// the slabs it needed around while compiling small ones.
+
+class SlabCache
+{
+    static const size_t MaxCachedSlabs = 16;
+    static const unsigned DecayInterval = 256;
+
+    void* m_slabs[MaxCachedSlabs];
+    size_t m_count;
+
+    // Fewest slabs in the cache since the last decay, and allocations until the next one
+    size_t m_lowWater;
+    unsigned m_allocationsUntilDecay;
+
+public:
+    // The default page size of RyuJIT's arena allocator
+    static const size_t StandardSlabSize = 0x10000;
+
+    SlabCache()
+        : m_count(0), m_lowWater(0), m_allocationsUntilDecay(DecayInterval) { }
+
+    ~SlabCache()
+    {
+        while (m_count != 0)
+            free(m_slabs[--m_count]);
+    }
+
+    void* allocate()
+    {
+        void* slab = (m_count != 0) ? m_slabs[--m_count] : malloc(StandardSlabSize);
+
+        if (m_count < m_lowWater)
+            m_lowWater = m_count;
+
+        if (--m_allocationsUntilDecay == 0)
+        {
+            for (size_t unused = m_lowWater / 2; unused != 0; unused--)
+                free(m_slabs[--m_count]);
+
+            m_lowWater = m_count;
+            m_allocationsUntilDecay = DecayInterval;
+        }
+
+        return slab;
+    }
+
+    bool tryCache(void* slab)
+    {
+        if (m_count == MaxCachedSlabs)
+            return false;
+
+        m_slabs[m_count++] = slab;
+        return true;
+    }
+};
+
+static thread_local SlabCache t_slabCache;
+
 // Native implementation of the JIT host.
 // The native implementation calls into JitConfigProvider (implemented on the managed side) to get the actual
 // configuration values.
@@ -79,12 +144,24 @@ public:
 
     virtual void* allocateSlab(size_t size, size_t* pActualSize)
     {
+        if (size <= SlabCache::StandardSlabSize)
+        {
+            void* slab = t_slabCache.allocate();
+            *pActualSize = (slab != nullptr) ? SlabCache::StandardSlabSize : 0;
+            return slab;
+        }
+
         *pActualSize = size;
         return allocateMemory(size);
     }
 
     virtual void freeSlab(void* slab, size_t actualSize)
     {
+        // Slabs may be freed on another thread than the one that allocated them, they go to the cache of the
+        // thread freeing them.
+        if (actualSize == SlabCache::StandardSlabSize && t_slabCache.tryCache(slab))
+            return;
+
         freeMemory(slab);
     }
 };
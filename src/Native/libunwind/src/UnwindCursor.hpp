@@ -108,6 +108,29 @@ private:
   static entry *_bufferUsed;
   static entry *_bufferEnd;
   static entry _initialBuffer[64];
+
+  // Lock-free cache of the FDE found for a pc, in front of the ranges above.
+  // Stack walks look up the same return addresses over and over, from many
+  // threads at once, so they are served from here without taking _lock. The
+  // table is split in shards that are probed linearly. A slot is claimed by
+  // setting its pc and published by setting its fde, it is never reused for
+  // another pc until removeAllIn clears the table. Lookups that find no slot
+  // go to the ranges, so the cache can fill up without losing entries.
+  struct pc_entry {
+    pint_t pc;
+    pint_t fde;
+  };
+
+  static const size_t kPCCacheShardBits = 4;
+  static const size_t kPCCacheShardSize = 512;
+  static const size_t kPCCacheMaxProbes = 8;
+
+  static pc_entry *pcCacheSlot(pint_t pc, size_t probe);
+  static pint_t findInPCCache(pint_t pc);
+  static void addToPCCache(pint_t pc, pint_t fde);
+  static void clearPCCache();
+
+  static pc_entry _pcCache[kPCCacheShardSize << kPCCacheShardBits];
 };
 
 template <typename A>
@@ -128,14 +151,70 @@ typename DwarfFDECache<A>::entry DwarfFDECache<A>::_initialBuffer[64];
 template <typename A>
 RWMutex DwarfFDECache<A>::_lock;
 
+template <typename A>
+typename DwarfFDECache<A>::pc_entry
+DwarfFDECache<A>::_pcCache[kPCCacheShardSize << kPCCacheShardBits];
+
 #ifdef __APPLE__
 template <typename A>
 bool DwarfFDECache<A>::_registeredForDyldUnloads = false;
 #endif
 
+template <typename A>
+typename DwarfFDECache<A>::pc_entry *
+DwarfFDECache<A>::pcCacheSlot(pint_t pc, size_t probe) {
+  uint32_t hash = (uint32_t)((uint64_t)pc ^ ((uint64_t)pc >> 32)) * 0x9E3779B1u;
+  size_t shard = hash >> (32 - kPCCacheShardBits);
+  return &_pcCache[shard * kPCCacheShardSize +
+                   ((hash + probe) & (kPCCacheShardSize - 1))];
+}
+
+template <typename A>
+typename A::pint_t DwarfFDECache<A>::findInPCCache(pint_t pc) {
+  for (size_t probe = 0; probe < kPCCacheMaxProbes; ++probe) {
+    pc_entry *p = pcCacheSlot(pc, probe);
+    pint_t slotPC = __atomic_load_n(&p->pc, __ATOMIC_ACQUIRE);
+    if (slotPC == pc)
+      return __atomic_load_n(&p->fde, __ATOMIC_ACQUIRE);
+    if (slotPC == 0)
+      break;
+  }
+  return 0;
+}
+
+template <typename A>
+void DwarfFDECache<A>::addToPCCache(pint_t pc, pint_t fde) {
+  for (size_t probe = 0; probe < kPCCacheMaxProbes; ++probe) {
+    pc_entry *p = pcCacheSlot(pc, probe);
+    pint_t slotPC = 0;
+    if (__atomic_compare_exchange_n(&p->pc, &slotPC, pc, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      __atomic_store_n(&p->fde, fde, __ATOMIC_RELEASE);
+      return;
+    }
+    // Another thread got to this pc first.
+    if (slotPC == pc)
+      return;
+  }
+}
+
+template <typename A>
+void DwarfFDECache<A>::clearPCCache() {
+  for (size_t i = 0; i < (kPCCacheShardSize << kPCCacheShardBits); ++i) {
+    __atomic_store_n(&_pcCache[i].fde, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&_pcCache[i].pc, 0, __ATOMIC_RELEASE);
+  }
+}
+
 template <typename A>
 typename A::pint_t DwarfFDECache<A>::findFDE(pint_t mh, pint_t pc) {
-  pint_t result = 0;
+  // A pc belongs to a single image, so the cached FDE is the right one
+  // whichever mh is asked for. The fde of a slot that was just claimed may not
+  // be published yet, that is a miss.
+  pint_t result = findInPCCache(pc);
+  if (result != 0)
+    return result;
+
   _LIBUNWIND_LOG_IF_FALSE(_lock.lock_shared());
   for (entry *p = _buffer; p < _bufferUsed; ++p) {
     if ((mh == p->mh) || (mh == 0)) {
@@ -146,6 +225,9 @@ typename A::pint_t DwarfFDECache<A>::findFDE(pint_t mh, pint_t pc) {
     }
   }
   _LIBUNWIND_LOG_IF_FALSE(_lock.unlock_shared());
+
+  if (result != 0)
+    addToPCCache(pc, result);
   return result;
 }
 
@@ -193,6 +275,7 @@ void DwarfFDECache<A>::removeAllIn(pint_t mh) {
     }
   }
   _bufferUsed = d;
+  clearPCCache();
   _LIBUNWIND_LOG_IF_FALSE(_lock.unlock());
 }
 
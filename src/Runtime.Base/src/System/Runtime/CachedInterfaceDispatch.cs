@@ -18,7 +18,12 @@ namespace System.Runtime
         {
             IntPtr locationOfThisPointer = callerTransitionBlockParam + TransitionBlock.GetThisOffset();
             object pObject = Unsafe.As<IntPtr, object>(ref *(IntPtr*)locationOfThisPointer);
-            IntPtr dispatchResolveTarget = RhpCidResolve_Worker(pObject, pCell);
+
+            // Cells that outgrew the largest cache size keep their additional mappings in the runtime's
+            // megamorphic table, which the dispatch stubs don't search.
+            IntPtr dispatchResolveTarget = InternalCalls.RhpSearchDispatchCellCache(pCell, pObject.EEType);
+            if (dispatchResolveTarget == IntPtr.Zero)
+                dispatchResolveTarget = RhpCidResolve_Worker(pObject, pCell);
             return dispatchResolveTarget;
         }
 
@@ -290,6 +290,66 @@ namespace System.Runtime
             }
         }
 
+        // The IPs of the frames the first pass walked that have not been passed to the classlib yet.
+        // DispatchEx collects them in a buffer on its own stack and hands them to the classlib in one call
+        // when the buffer fills up, before a filter runs and once the first pass is over, rather than calling
+        // the classlib for every frame.
+        private ref struct PendingStackTrace
+        {
+            internal const int MaxCount = 64;
+
+            internal IntPtr* _pIPs;
+            internal int _count;
+            internal bool _isFirstFrame;
+            internal bool _isFirstRethrowFrame;
+        }
+
+        private static void AppendPendingStackTrace(object exception, ref PendingStackTrace pending, IntPtr ip)
+        {
+            if (pending._count == PendingStackTrace.MaxCount)
+                FlushPendingStackTrace(exception, ref pending);
+
+            pending._pIPs[pending._count++] = ip;
+        }
+
+        private static void FlushPendingStackTrace(object exception, ref PendingStackTrace pending)
+        {
+            if (pending._count == 0)
+                return;
+
+            IntPtr pAppendStackFrames = (IntPtr)InternalCalls.RhpGetClasslibFunctionFromCodeAddress(pending._pIPs[0],
+                ClassLibFunctionId.AppendExceptionStackFrames);
+
+            if (pAppendStackFrames != IntPtr.Zero)
+            {
+                int flags = (pending._isFirstFrame ? (int)RhEHFrameType.RH_EH_FIRST_FRAME : 0) |
+                            (pending._isFirstRethrowFrame ? (int)RhEHFrameType.RH_EH_FIRST_RETHROW_FRAME : 0);
+
+                try
+                {
+                    CalliIntrinsics.CallVoid(pAppendStackFrames, exception, (IntPtr)pending._pIPs, pending._count, flags);
+                }
+                catch when (true)
+                {
+                    // disallow all exceptions leaking out of callbacks
+                }
+
+                pending._isFirstRethrowFrame = false;
+                pending._isFirstFrame = false;
+            }
+            else
+            {
+                // The classlib only knows how to append one frame at a time
+                for (int i = 0; i < pending._count; i++)
+                {
+                    AppendExceptionStackFrameViaClasslib(exception, pending._pIPs[i],
+                        ref pending._isFirstRethrowFrame, ref pending._isFirstFrame);
+                }
+            }
+
+            pending._count = 0;
+        }
+
         // Given an ExceptionID and an address pointing somewhere into a managed module, get
         // an exception object of a type that the module containing the given address will understand.
         // This finds the classlib-defined GetRuntimeException function and asks it for the exception object.
@@ -648,8 +708,12 @@ namespace System.Runtime
             byte* pCatchHandler = null;
             uint catchingTryRegionIdx = MaxTryRegionIdx;
 
-            bool isFirstRethrowFrame = (startIdx != MaxTryRegionIdx);
-            bool isFirstFrame = true;
+            PendingStackTrace pendingStackTrace;
+            IntPtr* pPendingStackTraceIPs = stackalloc IntPtr[PendingStackTrace.MaxCount];
+            pendingStackTrace._pIPs = pPendingStackTraceIPs;
+            pendingStackTrace._count = 0;
+            pendingStackTrace._isFirstFrame = true;
+            pendingStackTrace._isFirstRethrowFrame = (startIdx != MaxTryRegionIdx);
 
             byte* prevControlPC = null;
             byte* prevOriginalPC = null;
@@ -680,10 +744,10 @@ namespace System.Runtime
                 if (exInfo._notifyDebuggerSP == frameIter.SP)
                     DebuggerNotify.FirstPassFrameEntered(exceptionObj, frameIter.OriginalControlPC, frameIter.SP);
 
-                UpdateStackTrace(exceptionObj, exInfo._frameIter.FramePointer, (IntPtr)frameIter.OriginalControlPC, ref isFirstRethrowFrame, ref prevFramePtr, ref isFirstFrame);
+                UpdateStackTrace(exceptionObj, exInfo._frameIter.FramePointer, (IntPtr)frameIter.OriginalControlPC, ref pendingStackTrace, ref prevFramePtr);
 
                 byte* pHandler;
-                if (FindFirstPassHandler(exceptionObj, startIdx, ref frameIter,
+                if (FindFirstPassHandler(exceptionObj, startIdx, ref frameIter, ref pendingStackTrace,
                                          out catchingTryRegionIdx, out pHandler))
                 {
                     handlingFrameSP = frameIter.SP;
@@ -693,6 +757,7 @@ namespace System.Runtime
                     break;
                 }
             }
+            FlushPendingStackTrace(exceptionObj, ref pendingStackTrace);
             DebuggerNotify.EndFirstPass(exceptionObj, pCatchHandler, handlingFrameSP);
 
             if (pCatchHandler == null)
@@ -772,7 +837,7 @@ namespace System.Runtime
         }
 
         private static void UpdateStackTrace(object exceptionObj, UIntPtr curFramePtr, IntPtr ip, 
-            ref bool isFirstRethrowFrame, ref UIntPtr prevFramePtr, ref bool isFirstFrame)
+            ref PendingStackTrace pendingStackTrace, ref UIntPtr prevFramePtr)
         {
             // We use the fact that all funclet stack frames belonging to the same logical method activation 
             // will have the same FramePointer value.  Additionally, the stackwalker will return a sequence of
@@ -782,14 +847,13 @@ namespace System.Runtime
             // and corresponds to the current 'IP state' of the method.            
             if ((prevFramePtr == UIntPtr.Zero) || (curFramePtr != prevFramePtr))
             {
-                AppendExceptionStackFrameViaClasslib(exceptionObj, ip,
-                    ref isFirstRethrowFrame, ref isFirstFrame);
+                AppendPendingStackTrace(exceptionObj, ref pendingStackTrace, ip);
             }
             prevFramePtr = curFramePtr;
         }
 
         private static bool FindFirstPassHandler(object exception, uint idxStart,
-            ref StackFrameIterator frameIter, out uint tryRegionIdx, out byte* pHandler)
+            ref StackFrameIterator frameIter, ref PendingStackTrace pendingStackTrace, out uint tryRegionIdx, out byte* pHandler)
         {
             pHandler = null;
             tryRegionIdx = MaxTryRegionIdx;
@@ -853,6 +917,9 @@ namespace System.Runtime
                 }
                 else
                 {
+                    // The filter may look at the stack trace of the exception
+                    FlushPendingStackTrace(exception, ref pendingStackTrace);
+
                     byte* pFilterFunclet = ehClause._filterAddress;
                     bool shouldInvokeHandler =
                         InternalCalls.RhpCallFilterFunclet(exception, pFilterFunclet, frameIter.RegisterSet);
@@ -50,6 +50,7 @@ namespace System.Runtime
         OnFirstChance = 6,
         DebugFuncEvalHelper = 7,
         DebugFuncEvalAbortHelper = 8,
+        AppendExceptionStackFrames = 9,
     }
 
     internal static class InternalCalls
@@ -68,6 +69,17 @@ namespace System.Runtime
         [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
         private static extern void RhpCollect(int generation, InternalGCCollectionMode mode);
 
+        // Tell the GC the host is idle, it collects gen0 or gen1 now if their budgets are mostly used up.
+        // Returns the generation collected, -1 if none.
+        [RuntimeExport("RhNotifyIdle")]
+        internal static int RhNotifyIdle()
+        {
+            return RhpNotifyIdle();
+        }
+
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern int RhpNotifyIdle();
+
         [RuntimeExport("RhGetGcTotalMemory")]
         internal static long RhGetGcTotalMemory()
         {
@@ -99,6 +111,13 @@ namespace System.Runtime
         [ManuallyManaged(GcPollPolicy.Never)]
         internal static extern object RhpGetNextFinalizableObject();
 
+        // Fetch up to as many objects which need finalization as fit in the array, returns the number fetched or 0
+        // if we've reached the end of the list.
+        [RuntimeImport(Redhawk.BaseName, "RhpGetNextFinalizableObjects")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal static extern uint RhpGetNextFinalizableObjects(object[] results);
+
         //
         // internalcalls for System.Runtime.InteropServices.GCHandle.
         //
@@ -349,6 +368,20 @@ namespace System.Runtime
         [ManuallyManaged(GcPollPolicy.Never)]
         internal extern static int RhpGetThunkSize();
 
+        [RuntimeImport(Redhawk.BaseName, "RhCurrentNativeThreadId")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal extern static IntPtr RhCurrentNativeThreadId();
+
+#if TARGET_64BIT
+        [RuntimeImport(Redhawk.BaseName, "RhpLockCmpXchg64")]
+#else
+        [RuntimeImport(Redhawk.BaseName, "RhpLockCmpXchg32")]
+#endif
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal extern static IntPtr InterlockedCompareExchange(ref IntPtr location1, IntPtr value, IntPtr comparand);
+
         [RuntimeImport(Redhawk.BaseName, "RhpGetThunkDataBlockAddress")]
         [MethodImpl(MethodImplOptions.InternalCall)]
         [ManuallyManaged(GcPollPolicy.Never)]
@@ -385,12 +418,42 @@ namespace System.Runtime
         [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern void RhpSignalFinalizationComplete();
 
+        // Wake the finalizer helper threads to drain the queue alongside the finalizer thread. Returns the number
+        // of helpers woken.
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern uint RhpStartFinalizerHelpers();
+
+        // Block the finalizer thread until the helpers woken by RhpStartFinalizerHelpers are done.
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void RhpWaitForFinalizerHelpers();
+
+        // Block a finalizer helper thread until the finalizer thread has work for it.
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void RhpWaitForFinalizerHelperRequest(uint index);
+
+        // Indicate that a finalizer helper thread is done with the current round of finalizations.
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        internal static extern void RhpSignalFinalizerHelperDone();
+
         [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern void RhpAcquireCastCacheLock();
 
         [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
         internal static extern void RhpReleaseCastCacheLock();
 
+        // Lock-free cast cache kept by the runtime. Lookup returns 1 if the cast succeeds, 0 if it fails and -1
+        // if the pair isn't cached. Add returns 0 if the result wasn't recorded because another thread was
+        // updating the same entry.
+        [RuntimeImport(Redhawk.BaseName, "RhpCastCacheLookup")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal extern static unsafe int RhpCastCacheLookup(EEType* pSourceType, EEType* pTargetType, uint variation);
+
+        [RuntimeImport(Redhawk.BaseName, "RhpCastCacheAdd")]
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [ManuallyManaged(GcPollPolicy.Never)]
+        internal extern static unsafe int RhpCastCacheAdd(EEType* pSourceType, EEType* pTargetType, uint variation, int result);
+
         [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
         internal extern static long PalGetTickCount64();
 
@@ -320,43 +320,17 @@ namespace System.Runtime
         [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
         private static extern unsafe int RhpGetCurrentThreadStackTrace(IntPtr* pOutputBuffer, uint outputBufferLength);
 
-        // Worker for RhGetCurrentThreadStackTrace.  RhGetCurrentThreadStackTrace just allocates a transition
-        // frame that will be used to seed the stack trace and this method does all the real work.
-        //
-        // Input:           outputBuffer may be null or non-null
-        // Return value:    positive: number of entries written to outputBuffer
-        //                  negative: number of required entries in outputBuffer in case it's too small (or null)
-        // Output:          outputBuffer is filled in with return address IPs, starting with placing the this
-        //                  method's return address into index 0
-        //
-        // NOTE: We don't want to allocate the array on behalf of the caller because we don't know which class
-        // library's objects the caller understands (we support multiple class libraries with multiple root
-        // System.Object types).
-        [UnmanagedCallersOnly(EntryPoint = "RhpCalculateStackTraceWorker", CallingConvention = CallingConvention.Cdecl)]
-        private static unsafe int RhpCalculateStackTraceWorker(IntPtr* pOutputBuffer, uint outputBufferLength)
+        // pOutputBuffer points to StackFrameData entries, which are only interpreted by the class library
+        [RuntimeExport("RhGetCurrentThreadStackFrames")]
+        [MethodImpl(MethodImplOptions.NoInlining)] // Ensures that the RhGetCurrentThreadStackFrames frame is always present
+        public static unsafe int RhGetCurrentThreadStackFrames(void* pOutputBuffer, int outputBufferLength, int skipFrames)
         {
-            uint nFrames = 0;
-            bool success = true;
-
-            StackFrameIterator frameIter = new StackFrameIterator();
-
-            bool isValid = frameIter.Init(null);
-            Debug.Assert(isValid, "Missing RhGetCurrentThreadStackTrace frame");
-
-            // Note that the while loop will skip RhGetCurrentThreadStackTrace frame
-            while (frameIter.Next())
-            {
-                if (nFrames < outputBufferLength)
-                    pOutputBuffer[nFrames] = new IntPtr(frameIter.ControlPC);
-                else
-                    success = false;
-
-                nFrames++;
-            }
-
-            return success ? (int)nFrames : -(int)nFrames;
+            return RhpGetCurrentThreadStackFrames(pOutputBuffer, (uint)outputBufferLength, (uint)skipFrames);
         }
 
+        [DllImport(Redhawk.BaseName, CallingConvention = CallingConvention.Cdecl)]
+        private static extern unsafe int RhpGetCurrentThreadStackFrames(void* pOutputBuffer, uint outputBufferLength, uint skipFrames);
+
         // The GC conservative reporting descriptor is a special structure of data that the GC
         // parses to determine whether there are specific regions of memory that it should not
         // collect or move around.
@@ -30,9 +30,16 @@
 // the thunk stubs blocks are groupped at the begining of the allocated virtual memory space, and all the
 // thunk data blocks are groupped in the second half of the virtual space.
 //
-// Available thunks are tracked using a linked list. The first cell in the data block of each thunk is
+// Available thunks are tracked using linked lists. The first cell in the data block of each thunk is
 // used as the nodes of the linked list. The cell will point to the data block of the next available thunk, 
-// if one is available, or point to null. When thunks are freed, they are added to the begining of the list.
+// if one is available, or point to null.
+//
+// Threads allocate from magazines: short lists of thunks kept in slots picked by the current thread, so
+// that threads rarely share a slot. A thread takes the whole list of its slot with an interlocked exchange,
+// keeps the first thunk and puts the rest back. Freed thunks are pushed onto a lock-free free list, and an
+// empty magazine is refilled with the whole free list, the thunks of other magazines, or a batch of thunks
+// carved out of the heap under the thunk pool lock, in that order. The lists are only ever pushed onto or
+// taken whole, which keeps them safe from the ABA problem without version counters.
 // 
 
 using System.Diagnostics;
@@ -71,10 +78,16 @@ namespace System.Runtime
             internal AllocatedBlock _nextBlock;
         }
 
+        private const int NumMagazines = 16;            // MUST BE A POWER OF TWO
+        private const int MagazineRefillSize = 16;
+
         private IntPtr _commonStubAddress;
         private IntPtr _nextAvailableThunkPtr;
         private IntPtr _lastThunkPtr;
 
+        private IntPtr _freeList;
+        private IntPtr[] _magazines;
+
         private AllocatedBlock _allocatedBlocks;
 
         // Helper functions to set/clear the lowest bit for ARM instruction pointers
@@ -100,6 +113,7 @@ namespace System.Runtime
             _commonStubAddress = commonStubAddress;
 
             _allocatedBlocks = new AllocatedBlock();
+            _magazines = new IntPtr[NumMagazines];
 
             InternalCalls.RhpAcquireThunkPoolLock();
 
@@ -191,35 +205,124 @@ namespace System.Runtime
             return false;
         }
 
-        public unsafe IntPtr AllocateThunk()
+        //
+        // Note: Expected to be called under lock
+        //
+        private unsafe IntPtr TakeThunksFromHeap(int count)
         {
-            // TODO: optimize the implementation and make it lock-free
-            // or at least change it to a per-heap lock instead of a global lock.
+            IntPtr firstThunkPtr = _nextAvailableThunkPtr;
+            IntPtr lastTakenThunkPtr = IntPtr.Zero;
 
-            Debug.Assert(_nextAvailableThunkPtr != IntPtr.Zero);
+            for (int i = 0; i < count; i++)
+            {
+                IntPtr nextNextAvailableThunkPtr = *((IntPtr*)(_nextAvailableThunkPtr));
 
-            InternalCalls.RhpAcquireThunkPoolLock();
+                // The last thunk of the heap stays in the list until the heap is expanded, ExpandHeap links the
+                // new block to it.
+                if (nextNextAvailableThunkPtr == IntPtr.Zero)
+                {
+                    if (!ExpandHeap())
+                        break;
+
+                    nextNextAvailableThunkPtr = *((IntPtr*)(_nextAvailableThunkPtr));
+                    Debug.Assert(nextNextAvailableThunkPtr != IntPtr.Zero);
+                }
+
+                lastTakenThunkPtr = _nextAvailableThunkPtr;
+                _nextAvailableThunkPtr = nextNextAvailableThunkPtr;
+            }
 
-            IntPtr nextAvailableThunkPtr = _nextAvailableThunkPtr;
-            IntPtr nextNextAvailableThunkPtr = *((IntPtr*)(nextAvailableThunkPtr));
+            if (lastTakenThunkPtr == IntPtr.Zero)
+                return IntPtr.Zero;
+
+            *((IntPtr*)(lastTakenThunkPtr)) = IntPtr.Zero;
+            return firstThunkPtr;
+        }
 
-            if (nextNextAvailableThunkPtr == IntPtr.Zero)
+        private static IntPtr InterlockedExchange(ref IntPtr location, IntPtr value)
+        {
+            IntPtr oldValue;
+            do
             {
-                if (!ExpandHeap())
-                {
-                    InternalCalls.RhpReleaseThunkPoolLock();
-                    return IntPtr.Zero;
-                }
+                oldValue = location;
+            }
+            while (InternalCalls.InterlockedCompareExchange(ref location, value, oldValue) != oldValue);
 
-                nextAvailableThunkPtr = _nextAvailableThunkPtr;
-                nextNextAvailableThunkPtr = *((IntPtr*)(nextAvailableThunkPtr));
-                Debug.Assert(nextNextAvailableThunkPtr != IntPtr.Zero);
+            return oldValue;
+        }
+
+        // Push a list of thunks onto the free list
+        private unsafe void PushFreeThunks(IntPtr firstThunkPtr)
+        {
+            IntPtr lastThunkPtr = firstThunkPtr;
+            while (*((IntPtr*)(lastThunkPtr)) != IntPtr.Zero)
+                lastThunkPtr = *((IntPtr*)(lastThunkPtr));
+
+            IntPtr freeList;
+            do
+            {
+                freeList = _freeList;
+                *((IntPtr*)(lastThunkPtr)) = freeList;
             }
+            while (InternalCalls.InterlockedCompareExchange(ref _freeList, firstThunkPtr, freeList) != freeList);
+        }
 
-            _nextAvailableThunkPtr = nextNextAvailableThunkPtr;
+        private IntPtr RefillMagazine(int magazineIndex)
+        {
+            IntPtr thunks = InterlockedExchange(ref _freeList, IntPtr.Zero);
+            if (thunks != IntPtr.Zero)
+                return thunks;
+
+            for (int i = 1; i < NumMagazines; i++)
+            {
+                int otherMagazineIndex = (magazineIndex + i) & (NumMagazines - 1);
+                if (_magazines[otherMagazineIndex] == IntPtr.Zero)
+                    continue;
+
+                thunks = InterlockedExchange(ref _magazines[otherMagazineIndex], IntPtr.Zero);
+                if (thunks != IntPtr.Zero)
+                    return thunks;
+            }
+
+            InternalCalls.RhpAcquireThunkPoolLock();
+
+            thunks = TakeThunksFromHeap(MagazineRefillSize);
 
             InternalCalls.RhpReleaseThunkPoolLock();
 
+            return thunks;
+        }
+
+        private static int GetMagazineIndex()
+        {
+            // The native thread id is the address of a per-thread structure
+            nuint threadId = (nuint)InternalCalls.RhCurrentNativeThreadId();
+            return (int)((threadId >> 6) ^ (threadId >> 12)) & (NumMagazines - 1);
+        }
+
+        public unsafe IntPtr AllocateThunk()
+        {
+            Debug.Assert(_nextAvailableThunkPtr != IntPtr.Zero);
+
+            int magazineIndex = GetMagazineIndex();
+
+            IntPtr nextAvailableThunkPtr = InterlockedExchange(ref _magazines[magazineIndex], IntPtr.Zero);
+            if (nextAvailableThunkPtr == IntPtr.Zero)
+            {
+                nextAvailableThunkPtr = RefillMagazine(magazineIndex);
+                if (nextAvailableThunkPtr == IntPtr.Zero)
+                    return IntPtr.Zero;
+            }
+
+            // Put the rest of the thunks back into the magazine, or onto the free list if another thread refilled
+            // the magazine in the meantime
+            IntPtr remainingThunksPtr = *((IntPtr*)(nextAvailableThunkPtr));
+            if (remainingThunksPtr != IntPtr.Zero &&
+                InternalCalls.InterlockedCompareExchange(ref _magazines[magazineIndex], remainingThunksPtr, IntPtr.Zero) != IntPtr.Zero)
+            {
+                PushFreeThunks(remainingThunksPtr);
+            }
+
             Debug.Assert(nextAvailableThunkPtr != IntPtr.Zero);
 
 #if DEBUG
@@ -238,9 +341,6 @@ namespace System.Runtime
 
         public unsafe void FreeThunk(IntPtr thunkAddress)
         {
-            // TODO: optimize the implementation and make it lock-free
-            // or at least change it to a per-heap lock instead of a global lock.
-
             IntPtr dataAddress = TryGetThunkDataAddress(thunkAddress);
             if (dataAddress == IntPtr.Zero)
                 EH.FallbackFailFast(RhFailFastReason.InternalError, null);
@@ -253,12 +353,8 @@ namespace System.Runtime
             *((IntPtr*)(dataAddress + IntPtr.Size)) = new IntPtr(-1);
 #endif
 
-            InternalCalls.RhpAcquireThunkPoolLock();
-
-            *((IntPtr*)(dataAddress)) = _nextAvailableThunkPtr;
-            _nextAvailableThunkPtr = dataAddress;
-
-            InternalCalls.RhpReleaseThunkPoolLock();
+            *((IntPtr*)(dataAddress)) = IntPtr.Zero;
+            PushFreeThunks(dataAddress);
         }
 
         private bool IsThunkInHeap(IntPtr thunkAddress)
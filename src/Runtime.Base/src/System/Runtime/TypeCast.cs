@@ -269,7 +269,21 @@ namespace System.Runtime
 
             int numInterfaces = pObjType->NumInterfaces;
             EEInterfaceInfo* interfaceMap = pObjType->InterfaceMap;
-            for (int i = 0; i < numInterfaces; i++)
+
+            // Types with many interfaces carry a bloom filter of their interface map. If the bits of the target
+            // are missing the target isn't in the map and only the variance checks below can still match.
+            bool fMightImplementExactly = true;
+            if (numInterfaces >= InterfaceSignatureBits.MinimumInterfaceCount)
+            {
+                uint signature = pObjType->InterfaceSignature;
+                if (signature != 0)
+                {
+                    uint targetBits = InterfaceSignatureBits.Get(pTargetType->HashCode);
+                    fMightImplementExactly = (signature & targetBits) == targetBits;
+                }
+            }
+
+            for (int i = 0; fMightImplementExactly && i < numInterfaces; i++)
             {
                 EEType* pInterfaceType = interfaceMap[i].InterfaceType;
 
@@ -1071,10 +1085,22 @@ namespace System.Runtime
                 bool result = false;
                 bool previouslyCached = false;
 
+                //
+                // Try to find the entry in the lock-free cache of the runtime. Results are only moved into this
+                // cache, under the lock, when they are asked for again, so a burst of casts between new pairs
+                // doesn't serialize on the lock.
+                //
+                int nativeResult = InternalCalls.RhpCastCacheLookup(key.SourceType, key.TargetType, (uint)key.Variation);
+                if (nativeResult >= 0)
+                {
+                    result = nativeResult != 0;
+                    previouslyCached = true;
+                }
+
                 //
                 // Try to find the entry in the previous version of the cache that is kept alive by weak reference
                 //
-                if (s_previousCache.IsAllocated)
+                if (!previouslyCached && s_previousCache.IsAllocated)
                 {
                     // Unchecked cast to avoid recursive dependency on array casting
                     Entry[] previousCache = Unsafe.As<Entry[]>(s_previousCache.Target);
@@ -1096,6 +1122,9 @@ namespace System.Runtime
                 {
                     EETypePairList newList = new EETypePairList(key.SourceType, key.TargetType, pVisited);
                     result = TypeCast.AreTypesAssignableInternal(key.SourceType, key.TargetType, key.Variation, &newList);
+
+                    if (InternalCalls.RhpCastCacheAdd(key.SourceType, key.TargetType, (uint)key.Variation, result ? 1 : 0) != 0)
+                        return result;
                 }
 
                 //
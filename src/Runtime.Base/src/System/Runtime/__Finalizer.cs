@@ -7,9 +7,10 @@ using System.Runtime.InteropServices;
 using System.Runtime.CompilerServices;
 
 //
-// Implements the single finalizer thread for a Redhawk instance. Essentially waits for an event to fire
+// Implements the finalizer thread for a Redhawk instance. Essentially waits for an event to fire
 // indicating finalization is necessary then drains the queue of pending finalizable objects, calling the
-// finalize method for each one.
+// finalize method for each one. If the runtime was configured with more than one finalizer thread, the
+// helper threads drain the same queue while the finalizer thread does.
 // 
 
 namespace System.Runtime
@@ -30,8 +31,13 @@ namespace System.Runtime
                 // otherwise memory is low and we should initiate a collection. 
                 if (InternalCalls.RhpWaitForFinalizerRequest() != 0)
                 {
+                    uint helpers = InternalCalls.RhpStartFinalizerHelpers();
+
                     DrainQueue();
 
+                    if (helpers != 0)
+                        InternalCalls.RhpWaitForFinalizerHelpers();
+
                     // Tell anybody that's interested that the finalization pass is complete (there is a race condition here
                     // where we might immediately signal a new request as complete, but this is acceptable).
                     InternalCalls.RhpSignalFinalizationComplete();
@@ -45,24 +51,52 @@ namespace System.Runtime
             }
         }
 
+        [UnmanagedCallersOnly(EntryPoint = "ProcessFinalizersOnHelperThread", CallingConvention = CallingConvention.Cdecl)]
+        public static void ProcessFinalizersOnHelperThread(uint index)
+        {
+            while (true)
+            {
+                InternalCalls.RhpWaitForFinalizerHelperRequest(index);
+
+                DrainQueue();
+
+                InternalCalls.RhpSignalFinalizerHelperDone();
+            }
+        }
+
         // Do not inline this method -- we do not want to accidentally have any temps in ProcessFinalizers which contain
         // objects that came off of the finalizer queue.  If such temps were reported across the duration of the 
         // finalizer thread wait operation, it could cause unpredictable behavior with weak handles.
         [MethodImpl(MethodImplOptions.NoInlining)]
         private static unsafe void DrainQueue()
         {
+            // Objects are dequeued in batches so that the finalize queue lock and the transition into the
+            // runtime are paid once per batch instead of once per object.
+            object[] batch = new object[FinalizerBatchSize];
+
             // Drain the queue of finalizable objects.
             while (true)
             {
-                object target = InternalCalls.RhpGetNextFinalizableObject();
-                if (target == null)
+                uint count = InternalCalls.RhpGetNextFinalizableObjects(batch);
+                if (count == 0)
                     return;
 
-                // Call the finalizer on the current target object. If the finalizer throws we'll fail
-                // fast via normal Redhawk exception semantics (since we don't attempt to catch
-                // anything).
-                CalliIntrinsics.CallVoid(target.EEType->FinalizerCode, target);
+                for (uint i = 0; i < count; i++)
+                {
+                    object target = batch[i];
+
+                    // Don't keep the object alive past its finalizer.
+                    batch[i] = null;
+
+                    // Call the finalizer on the current target object. If the finalizer throws we'll fail
+                    // fast via normal Redhawk exception semantics (since we don't attempt to catch
+                    // anything).
+                    CalliIntrinsics.CallVoid(target.EEType->FinalizerCode, target);
+                }
             }
         }
+
+        // Kept small so that finalizer helper threads share the work of a burst evenly.
+        private const int FinalizerBatchSize = 32;
     }
 }
@@ -131,7 +131,7 @@ namespace System.IO
             if (_buffer.Length != _bufferSize || _bufferSize >= MaxShadowBufferSize)
                 return;
 
-            byte[] shadowBuffer = new byte[Math.Min(_bufferSize + _bufferSize, MaxShadowBufferSize)];
+            byte[] shadowBuffer = GC.AllocateUninitializedArray<byte>(Math.Min(_bufferSize + _bufferSize, MaxShadowBufferSize));
             Buffer.BlockCopy(_buffer, 0, shadowBuffer, 0, _writePos);
             _buffer = shadowBuffer;
         }
@@ -142,7 +142,7 @@ namespace System.IO
 
             // BufferedStream is not intended for multi-threaded use, so no worries about the get/set race on _buffer.
             if (_buffer == null)
-                _buffer = new byte[_bufferSize];
+                _buffer = GC.AllocateUninitializedArray<byte>(_bufferSize);
         }
 
         public Stream UnderlyingStream
@@ -734,7 +734,7 @@ namespace System.IO
             Debug.Assert(_buffer == null || _buffer.Length == _bufferLength);
             if (_buffer == null)
             {
-                _buffer = new byte[_bufferLength];
+                _buffer = GC.AllocateUninitializedArray<byte>(_bufferLength);
                 OnBufferAllocated();
             }
 
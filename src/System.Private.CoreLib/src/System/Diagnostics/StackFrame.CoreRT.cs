@@ -40,10 +40,33 @@ namespace System.Diagnostics
             InitializeForIpAddress(ipAddress, needFileInfo);
         }
 
+        /// <summary>
+        /// Constructs a StackFrame corresponding to a given IP address of a method that starts at
+        /// methodStartAddress, when the stack walk already found the start of the method.
+        /// </summary>
+        internal StackFrame(IntPtr ipAddress, IntPtr methodStartAddress, bool needFileInfo)
+        {
+            InitializeForIpAddress(ipAddress, methodStartAddress, needFileInfo);
+        }
+
         /// <summary>
         /// Internal stack frame initialization based on IP address.
         /// </summary>
         private void InitializeForIpAddress(IntPtr ipAddress, bool needFileInfo)
+        {
+            IntPtr methodStartAddress = IntPtr.Zero;
+            if (ipAddress != IntPtr.Zero && ipAddress != StackTraceHelper.SpecialIP.EdiSeparator)
+            {
+                methodStartAddress = RuntimeImports.RhFindMethodStartAddress(ipAddress);
+            }
+
+            InitializeForIpAddress(ipAddress, methodStartAddress, needFileInfo);
+        }
+
+        /// <summary>
+        /// Internal stack frame initialization based on IP address and the start of the method.
+        /// </summary>
+        private void InitializeForIpAddress(IntPtr ipAddress, IntPtr methodStartAddress, bool needFileInfo)
         {
             _ipAddress = ipAddress;
             _needFileInfo = needFileInfo;
@@ -54,8 +77,6 @@ namespace System.Diagnostics
             }
             else if (_ipAddress != IntPtr.Zero)
             {
-                IntPtr methodStartAddress = RuntimeImports.RhFindMethodStartAddress(ipAddress);
-
                 _nativeOffset = (int)(_ipAddress.ToInt64() - methodStartAddress.ToInt64());
 
                 DeveloperExperience.Default.TryGetILOffsetWithinMethod(_ipAddress, out _ilOffset);
@@ -28,16 +28,38 @@ namespace System.Diagnostics
         /// <summary>
         /// Initialize the stack trace based on current thread and given initial frame index.
         /// </summary>
-        private void InitializeForCurrentThread(int skipFrames, bool needFileInfo)
+        private unsafe void InitializeForCurrentThread(int skipFrames, bool needFileInfo)
         {
-            int frameCount = -RuntimeImports.RhGetCurrentThreadStackTrace(Array.Empty<IntPtr>());
-            Debug.Assert(frameCount >= 0);
-            IntPtr[] stackTrace = new IntPtr[frameCount];
-            int trueFrameCount = RuntimeImports.RhGetCurrentThreadStackTrace(stackTrace);
-            Debug.Assert(trueFrameCount == frameCount);
-            InitializeForIpAddressArray(stackTrace, skipFrames, frameCount, needFileInfo);
+            // Most stacks fit the initial buffer and take a single walk. Deeper ones are walked a second time
+            // into a buffer of the size the first walk returned.
+            RuntimeImports.StackFrameData[] frames = new RuntimeImports.StackFrameData[InitialFrameBufferLength];
+            int frameCount;
+            fixed (RuntimeImports.StackFrameData* pFrames = frames)
+                frameCount = RuntimeImports.RhGetCurrentThreadStackFrames(pFrames, frames.Length, skipFrames);
+
+            if (frameCount < 0)
+            {
+                frames = new RuntimeImports.StackFrameData[-frameCount];
+                fixed (RuntimeImports.StackFrameData* pFrames = frames)
+                    frameCount = RuntimeImports.RhGetCurrentThreadStackFrames(pFrames, frames.Length, skipFrames);
+                Debug.Assert(frameCount == frames.Length);
+            }
+
+            if (frameCount > 0)
+            {
+                _stackFrames = new StackFrame[frameCount];
+                for (int frameIndex = 0; frameIndex < frameCount; frameIndex++)
+                {
+                    _stackFrames[frameIndex] = new StackFrame(frames[frameIndex].IP, frames[frameIndex].MethodStart, needFileInfo);
+                }
+            }
+
+            _numOfFrames = frameCount;
+            _methodsToSkip = 0;
         }
 
+        private const int InitialFrameBufferLength = 64;
+
         /// <summary>
         /// Initialize the stack trace based on a given exception and initial frame index.
         /// </summary>
@@ -183,6 +183,17 @@ namespace System
             _corDbgStackTrace[_idxFirstFreeStackTraceEntry++] = IP;
         }
 
+        private unsafe void AppendStackIPs(IntPtr* pIPs, int count, bool isFirstRethrowFrame)
+        {
+            AppendStackIP(pIPs[0], isFirstRethrowFrame);
+
+            while (_idxFirstFreeStackTraceEntry + count - 1 > _corDbgStackTrace.Length)
+                GrowStackTrace();
+
+            for (int i = 1; i < count; i++)
+                _corDbgStackTrace[_idxFirstFreeStackTraceEntry++] = pIPs[i];
+        }
+
         private void GrowStackTrace()
         {
             IntPtr[] newArray = new IntPtr[_corDbgStackTrace.Length * 2];
@@ -208,7 +219,14 @@ namespace System
         }
 
         [RuntimeExport("AppendExceptionStackFrame")]
-        private static void AppendExceptionStackFrame(object exceptionObj, IntPtr IP, int flags)
+        private static unsafe void AppendExceptionStackFrame(object exceptionObj, IntPtr IP, int flags)
+        {
+            AppendExceptionStackFrames(exceptionObj, (IntPtr)(&IP), 1, flags);
+        }
+
+        // Called by the runtime's EH dispatch code with the IPs of a run of frames, flags apply to the first one
+        [RuntimeExport("AppendExceptionStackFrames")]
+        private static unsafe void AppendExceptionStackFrames(object exceptionObj, IntPtr pIPs, int count, int flags)
         {
             // This method is called by the runtime's EH dispatch code and is not allowed to leak exceptions
             // back into the dispatcher.
@@ -235,8 +253,10 @@ namespace System
                 // with another OutOfMemoryException, which may lead to infinite recursion.
                 bool fatalOutOfMemory = ex == PreallocatedOutOfMemoryException.Instance;
 
+                IntPtr IP = *(IntPtr*)pIPs;
+
                 if (!fatalOutOfMemory)
-                    ex.AppendStackIP(IP, isFirstRethrowFrame);
+                    ex.AppendStackIPs((IntPtr*)pIPs, count, isFirstRethrowFrame);
 
                 // UNIX-TODO: RhpEtwExceptionThrown
 #if TARGET_WINDOWS
@@ -273,7 +273,7 @@ namespace System
         /// <returns>True if the disallowing of garbage collection was successful, False otherwise</returns>
         /// <exception cref="ArgumentOutOfRangeException">If the amount of memory requested
         /// is too large for the GC to accommodate</exception>
-        /// <exception cref="InvalidOperationException">If the GC is already in a NoGCRegion</exception>
+        /// <exception cref="InvalidOperationException">If the NoGCRegion in progress was already ended by a garbage collection</exception>
         public static bool TryStartNoGCRegion(long totalSize)
         {
             return StartNoGCRegionWorker(totalSize, false, 0, false);
@@ -289,7 +289,7 @@ namespace System
         /// <returns>True if the disallowing of garbage collection was successful, False otherwise</returns>
         /// <exception cref="ArgumentOutOfRangeException">If the amount of memory requested
         /// is too large for the GC to accomodate</exception>
-        /// <exception cref="InvalidOperationException">If the GC is already in a NoGCRegion</exception>
+        /// <exception cref="InvalidOperationException">If the NoGCRegion in progress was already ended by a garbage collection</exception>
         public static bool TryStartNoGCRegion(long totalSize, long lohSize)
         {
             return StartNoGCRegionWorker(totalSize, true, lohSize, false);
@@ -305,7 +305,7 @@ namespace System
         /// <returns>True if the disallowing of garbage collection was successful, False otherwise</returns>
         /// <exception cref="ArgumentOutOfRangeException">If the amount of memory requested
         /// is too large for the GC to accomodate</exception>
-        /// <exception cref="InvalidOperationException">If the GC is already in a NoGCRegion</exception>
+        /// <exception cref="InvalidOperationException">If the NoGCRegion in progress was already ended by a garbage collection</exception>
         public static bool TryStartNoGCRegion(long totalSize, bool disallowFullBlockingGC)
         {
             return StartNoGCRegionWorker(totalSize, false, 0, disallowFullBlockingGC);
@@ -323,7 +323,7 @@ namespace System
         /// <returns>True if the disallowing of garbage collection was successful, False otherwise</returns>
         /// <exception cref="ArgumentOutOfRangeException">If the amount of memory requested
         /// is too large for the GC to accomodate</exception>
-        /// <exception cref="InvalidOperationException">If the GC is already in a NoGCRegion</exception>
+        /// <exception cref="InvalidOperationException">If the NoGCRegion in progress was already ended by a garbage collection</exception>
         public static bool TryStartNoGCRegion(long totalSize, long lohSize, bool disallowFullBlockingGC)
         {
             return StartNoGCRegionWorker(totalSize, true, lohSize, disallowFullBlockingGC);
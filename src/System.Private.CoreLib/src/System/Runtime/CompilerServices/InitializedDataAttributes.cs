@@ -47,6 +47,23 @@ namespace System.Runtime.CompilerServices
         public TypeHandleFixupAttribute(int offset, string typeName) { }
     }
 
+    // Generated by the toolchain.  Placed on the toolchain-generated RVA/proxy static field.  Represents a fixup
+    // to a frozen string object with the given value.
+    [AttributeUsage(AttributeTargets.Field, AllowMultiple = true)]
+    public sealed class StringFixupAttribute : Attribute
+    {
+        public StringFixupAttribute(int offset, string value) { }
+    }
+
+    // Generated by the toolchain.  Placed on the toolchain-generated RVA/proxy static field.  Represents a fixup
+    // to the frozen object that another pre-initialized static field refers to, which lets pre-initialized arrays
+    // refer to each other.
+    [AttributeUsage(AttributeTargets.Field, AllowMultiple = true)]
+    public sealed class FrozenObjectFixupAttribute : Attribute
+    {
+        public FrozenObjectFixupAttribute(int offset, Type containerType, string fieldName) { }
+    }
+
     // Generated by the toolchain.  Placed on the toolchain-generated proxy static field.  Represents the initialization
     // of a non-array-typed static field.
     [AttributeUsage(AttributeTargets.Field)]
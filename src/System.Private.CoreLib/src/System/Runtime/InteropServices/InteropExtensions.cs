@@ -202,6 +202,28 @@ namespace System.Runtime.InteropServices
             return RuntimeImports.RhRegisterGcCallout(RuntimeImports.GcRestrictedCalloutKind.AfterMarkPhase, pCalloutMethod);
         }
 
+        /// <summary>
+        /// Registers a restricted callout made once a full blocking GC is approaching, when the gen2 or LOH
+        /// budget left drops to the given percentage of the budget or to leadBytes. The callout is passed 2 or 3
+        /// for the gen2 or LOH budget and may run on an allocating thread, it must not allocate or block.
+        /// </summary>
+        public static bool RuntimeRegisterGcCalloutForFullGCApproach(IntPtr pCalloutMethod, int maxGenerationThreshold, int largeObjectHeapThreshold, long leadBytes)
+        {
+            if (maxGenerationThreshold <= 0 || maxGenerationThreshold >= 100)
+                throw new ArgumentOutOfRangeException(nameof(maxGenerationThreshold));
+            if (largeObjectHeapThreshold <= 0 || largeObjectHeapThreshold >= 100)
+                throw new ArgumentOutOfRangeException(nameof(largeObjectHeapThreshold));
+            if (leadBytes < 0)
+                throw new ArgumentOutOfRangeException(nameof(leadBytes));
+
+            return RuntimeImports.RhRegisterForFullGCApproachCallout(pCalloutMethod, maxGenerationThreshold, largeObjectHeapThreshold, leadBytes);
+        }
+
+        public static void RuntimeUnregisterGcCalloutForFullGCApproach(IntPtr pCalloutMethod)
+        {
+            RuntimeImports.RhUnregisterGcCallout(RuntimeImports.GcRestrictedCalloutKind.FullGCApproach, pCalloutMethod);
+        }
+
         public static bool RuntimeRegisterRefCountedHandleCallback(IntPtr pCalloutMethod, RuntimeTypeHandle pTypeFilter)
         {
             return RuntimeImports.RhRegisterRefCountedHandleCallback(pCalloutMethod, pTypeFilter.ToEETypePtr());
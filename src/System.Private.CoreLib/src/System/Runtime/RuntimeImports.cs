@@ -70,6 +70,12 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhCollect")]
         internal static extern void RhCollect(int generation, InternalGCCollectionMode mode);
 
+        // Tell the GC the host is idle, it collects gen0 or gen1 now if their budgets are mostly used up.
+        // Returns the generation collected, -1 if none.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhNotifyIdle")]
+        internal static extern int RhNotifyIdle();
+
         // Mark an object instance as already finalized.
         [MethodImpl(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhSuppressFinalize")]
@@ -164,6 +170,15 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhpUnregisterFrozenSegment")]
         internal static extern void RhpUnregisterFrozenSegment(IntPtr pSegmentHandle);
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhpRegisterPreInitializedStatics")]
+        private static extern bool RhpRegisterPreInitializedStatics(ref TypeManagerHandle module);
+
+        internal static bool RhpRegisterPreInitializedStatics(TypeManagerHandle module)
+        {
+            return RhpRegisterPreInitializedStatics(ref module);
+        }
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhRegisterForFullGCNotification")]
         internal static extern bool RhRegisterForFullGCNotification(int maxGenerationThreshold, int largeObjectHeapThreshold);
@@ -217,9 +232,18 @@ namespace System.Runtime
                                                     out UIntPtr lastRecordedHeapSizeBytes,
                                                     out UIntPtr lastRecordedFragmentationBytes);
 
+        // Copies the bytes of native memory the runtime uses for each kind of its internal structures (see
+        // NativeMemory.h) and returns the number of kinds.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetNativeMemoryInfo")]
+        internal static extern unsafe uint RhGetNativeMemoryInfo(long* pBytes, uint count);
+
         [DllImport(RuntimeLibrary, ExactSpelling = true)]
         internal static unsafe extern void RhAllocateNewArray(IntPtr pArrayEEType, uint numElements, uint flags, void* pResult);
 
+        [DllImport(RuntimeLibrary, ExactSpelling = true)]
+        internal static unsafe extern uint RhpNewFastBatch(IntPtr pEEType, uint count, void* pResults);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhCompareObjectContentsAndPadding")]
         internal extern static bool RhCompareObjectContentsAndPadding(object obj1, object obj2);
@@ -272,11 +296,27 @@ namespace System.Runtime
             return h;
         }
 
+        // Allocate a handle for each of the values, all at once.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhpHandleAllocBatch")]
+        private static extern unsafe bool RhpHandleAllocBatch(object[] values, GCHandleType type, IntPtr* handles);
+
+        internal static unsafe void RhHandleAllocBatch(object[] values, GCHandleType type, IntPtr* handles)
+        {
+            if (!RhpHandleAllocBatch(values, type, handles))
+                throw new OutOfMemoryException();
+        }
+
         // Free handle.
         [MethodImpl(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhHandleFree")]
         internal static extern void RhHandleFree(IntPtr handle);
 
+        // Free a batch of handles.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhHandleFreeBatch")]
+        internal static extern unsafe void RhHandleFreeBatch(IntPtr* handles, uint count);
+
         // Get object reference from handle.
         [MethodImpl(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhHandleGet")]
@@ -423,6 +463,11 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhSpinWait")]
         internal static extern void RhSpinWait(int iterations);
 
+        // Max number of iterations to pass to RhSpinWait at a time, normalized to the processor.
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetOptimalMaxSpinWaitsPerSpinIteration")]
+        internal static extern int RhGetOptimalMaxSpinWaitsPerSpinIteration();
+
         // Yield the cpu to another thread ready to process, if one is available.
         [DllImport(RuntimeLibrary, EntryPoint = "RhYield", CallingConvention = CallingConvention.Cdecl, ExactSpelling = true)]
         private static extern int _RhYield();
@@ -524,6 +569,7 @@ namespace System.Runtime
             EndCollection = 1, // Collection has completed
             AfterMarkPhase = 2, // All live objects are marked (not including ready for finalization objects),
                                 // no handles have been cleared
+            FullGCApproach = 3, // A full blocking collection is approaching, may be called outside of collections
         }
 
         [MethodImplAttribute(MethodImplOptions.InternalCall)]
@@ -534,6 +580,20 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhUnregisterGcCallout")]
         internal static extern void RhUnregisterGcCallout(GcRestrictedCalloutKind eKind, IntPtr pCalloutMethod);
 
+        [MethodImplAttribute(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhRegisterForFullGCApproachCallout")]
+        internal static extern bool RhRegisterForFullGCApproachCallout(IntPtr pCalloutMethod, int maxGenerationThreshold, int largeObjectHeapThreshold, long leadBytes);
+
+        // Registers a restricted callout that finalizes unreachable objects of exactly the given type from
+        // within the GC instead of queueing them for the finalizer thread.
+        [MethodImplAttribute(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhRegisterEagerFinalizer")]
+        internal static extern bool RhRegisterEagerFinalizer(IntPtr pCalloutMethod, EETypePtr pTypeFilter);
+
+        [MethodImplAttribute(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhUnregisterEagerFinalizer")]
+        internal static extern void RhUnregisterEagerFinalizer(IntPtr pCalloutMethod, EETypePtr pTypeFilter);
+
         [MethodImplAttribute(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhRegisterRefCountedHandleCallback")]
         internal static extern bool RhRegisterRefCountedHandleCallback(IntPtr pCalloutMethod, EETypePtr pTypeFilter);
@@ -663,6 +723,25 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhGetCurrentThreadStackTrace")]
         internal static extern int RhGetCurrentThreadStackTrace(IntPtr[] outputBuffer);
 
+        // Must match StackFrameData in MiscHelpers.cpp
+        internal struct StackFrameData
+        {
+            internal IntPtr IP;
+            internal IntPtr SP;
+            internal IntPtr MethodStart;
+            internal uint Flags;
+        }
+
+        internal const uint StackFrameDataFlagFunclet = 0x1;
+
+        // Fetch the frames of the current thread's (managed) stack in bulk. Like RhGetCurrentThreadStackTrace
+        // with the SP and the method start of every frame as well, and frame 0, the caller of this method, is
+        // preceded by skipFrames frames that are not returned. The return value is the number of frames written
+        // or the negated number of frames after the skipped ones if the buffer is too small.
+        [MethodImplAttribute(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhGetCurrentThreadStackFrames")]
+        internal static extern unsafe int RhGetCurrentThreadStackFrames(StackFrameData* pOutputBuffer, int outputBufferLength, int skipFrames);
+
         [MethodImplAttribute(MethodImplOptions.InternalCall)]
         [RuntimeImport(RuntimeLibrary, "RhGetCurrentThreadStackBounds")]
         internal static extern void RhGetCurrentThreadStackBounds(out IntPtr pStackLow, out IntPtr pStackHigh);
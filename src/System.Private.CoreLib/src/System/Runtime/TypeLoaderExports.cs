@@ -14,18 +14,56 @@ namespace System.Runtime
     [ReflectionBlocked]
     public static class TypeLoaderExports
     {
+        // Thread local storage blocks of dynamic types that the current thread already looked up, indexed like
+        // the blocks of the runtime thread. The runtime keeps a block at the same address until the thread is
+        // gone and reports its contents to the GC, so caching the address here only saves the call into the
+        // runtime and the thread lookup it does on every access.
+        [ThreadStatic]
+        private static IntPtr[] t_dynamicTypesTlsCells;
+
+        // Set on the index of every dynamic type TLS block, see DYNAMIC_TYPE_TLS_OFFSET_FLAG in the runtime
+        private const int DynamicTypeTlsOffsetFlag = unchecked((int)0x80000000);
+
         public static IntPtr GetThreadStaticsForDynamicType(int index)
         {
-            IntPtr result = RuntimeImports.RhGetThreadLocalStorageForDynamicType(index, 0, 0);
-            if (result != IntPtr.Zero)
-                return result;
+            IntPtr[] cells = t_dynamicTypesTlsCells;
+            int cellIndex = index & ~DynamicTypeTlsOffsetFlag;
+            if (cells != null && (uint)cellIndex < (uint)cells.Length)
+            {
+                IntPtr cachedResult = cells[cellIndex];
+                if (cachedResult != IntPtr.Zero)
+                    return cachedResult;
+            }
 
-            int numTlsCells;
-            int tlsStorageSize = RuntimeAugments.TypeLoaderCallbacks.GetThreadStaticsSizeForDynamicType(index, out numTlsCells);
-            result = RuntimeImports.RhGetThreadLocalStorageForDynamicType(index, tlsStorageSize, numTlsCells);
+            return GetThreadStaticsForDynamicTypeSlow(index);
+        }
 
+        private static IntPtr GetThreadStaticsForDynamicTypeSlow(int index)
+        {
+            IntPtr result = RuntimeImports.RhGetThreadLocalStorageForDynamicType(index, 0, 0);
             if (result == IntPtr.Zero)
-                throw new OutOfMemoryException();
+            {
+                int numTlsCells;
+                int tlsStorageSize = RuntimeAugments.TypeLoaderCallbacks.GetThreadStaticsSizeForDynamicType(index, out numTlsCells);
+                result = RuntimeImports.RhGetThreadLocalStorageForDynamicType(index, tlsStorageSize, numTlsCells);
+
+                if (result == IntPtr.Zero)
+                    throw new OutOfMemoryException();
+            }
+
+            IntPtr[] cells = t_dynamicTypesTlsCells;
+            int cellIndex = index & ~DynamicTypeTlsOffsetFlag;
+            if (cells == null || cellIndex >= cells.Length)
+            {
+                // Grow at least 2x, the same as the runtime does, so that a thread touching many types doesn't
+                // copy the cache for each of them
+                int newLength = Math.Max(cellIndex + 1, cells != null ? 2 * cells.Length : 16);
+                IntPtr[] newCells = new IntPtr[newLength];
+                if (cells != null)
+                    Array.Copy(cells, newCells, cells.Length);
+                t_dynamicTypesTlsCells = cells = newCells;
+            }
+            cells[cellIndex] = result;
 
             return result;
         }
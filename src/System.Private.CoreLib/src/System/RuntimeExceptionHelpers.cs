@@ -567,7 +567,8 @@ namespace System
                     cbFinalBuffer += serializedExceptions[i].Length;
                 }
 
-                byte[] finalBuffer = new byte[cbFinalBuffer];
+                // The buffer is handed to the runtime as 'unmanaged memory', so it lives on the pinned object heap.
+                byte[] finalBuffer = GC.AllocateArray<byte>(cbFinalBuffer, pinned: true);
                 fixed (byte* pBuffer = &finalBuffer[0])
                 {
                     byte* pCursor = pBuffer;
@@ -618,7 +619,7 @@ namespace System
             }
         }
 
-        private static GCHandle s_ExceptionInfoBufferPinningHandle;
+        private static byte[] s_ExceptionInfoBuffer;
         private static Lock s_ExceptionInfoBufferLock = new Lock();
 
         private static unsafe void UpdateErrorReportBuffer(byte[] finalBuffer)
@@ -630,23 +631,16 @@ namespace System
                 fixed (byte* pBuffer = &finalBuffer[0])
                 {
                     byte* pPrevBuffer = (byte*)RuntimeImports.RhSetErrorInfoBuffer(pBuffer);
-                    Debug.Assert(s_ExceptionInfoBufferPinningHandle.IsAllocated == (pPrevBuffer != null));
+                    Debug.Assert((s_ExceptionInfoBuffer != null) == (pPrevBuffer != null));
                     if (pPrevBuffer != null)
                     {
-                        byte[] currentExceptionInfoBuffer = (byte[])s_ExceptionInfoBufferPinningHandle.Target;
-                        Debug.Assert(currentExceptionInfoBuffer?.Length > 0);
-                        fixed (byte* pPrev = &currentExceptionInfoBuffer[0])
+                        fixed (byte* pPrev = &s_ExceptionInfoBuffer[0])
                             Debug.Assert(pPrev == pPrevBuffer);
                     }
-                    if (!s_ExceptionInfoBufferPinningHandle.IsAllocated)
-                    {
-                        // We allocate a pinning GC handle because we are logically giving the runtime 'unmanaged memory'.
-                        s_ExceptionInfoBufferPinningHandle = GCHandle.Alloc(finalBuffer, GCHandleType.Pinned);
-                    }
-                    else
-                    {
-                        s_ExceptionInfoBufferPinningHandle.Target = finalBuffer;
-                    }
+
+                    // The buffer was allocated on the pinned object heap, so it never moves and a strong
+                    // reference is enough to keep the memory given to the runtime alive.
+                    s_ExceptionInfoBuffer = finalBuffer;
                 }
             }
         }
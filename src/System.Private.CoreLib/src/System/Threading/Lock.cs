@@ -45,6 +45,13 @@ namespace System.Threading
         private IntPtr _owningThreadId;
         private volatile AutoResetEvent _lazyEvent;
 
+        //
+        // Set instead of _owningThreadId when a thin lock of an object header was moved to this lock while
+        // another thread held it, since only the managed thread ID of the owner is known then.  The owner
+        // moves its native thread ID to _owningThreadId the first time it uses the lock.
+        //
+        private int _owningManagedThreadId;
+
         private AutoResetEvent Event
         {
             get
@@ -62,6 +69,31 @@ namespace System.Threading
 
         private static IntPtr CurrentNativeThreadId => (IntPtr)RuntimeImports.RhCurrentNativeThreadId();
 
+        /// <summary>
+        /// Sets the state of a lock that no other thread can see yet to that of a thin lock held by the thread
+        /// with the given managed thread ID, or to not held if the ID is zero.
+        /// </summary>
+        internal void InitializeLocked(int managedThreadId, uint recursionCount)
+        {
+            Debug.Assert(_owningThreadId == IntPtr.Zero);
+            Debug.Assert(managedThreadId != 0 || recursionCount == 0);
+
+            _state = (managedThreadId != 0) ? Locked : Uncontended;
+            _owningManagedThreadId = managedThreadId;
+            _recursionCount = recursionCount;
+        }
+
+        [MethodImpl(MethodImplOptions.NoInlining)]
+        private bool TryResolveOwningThreadId(IntPtr currentThreadId)
+        {
+            if (_owningManagedThreadId != ManagedThreadId.Current)
+                return false;
+
+            _owningManagedThreadId = 0;
+            _owningThreadId = currentThreadId;
+            return true;
+        }
+
         // On platforms where CurrentNativeThreadId redirects to ManagedThreadId.Current the inlined
         // version of Lock.Acquire has the ManagedThreadId.Current call not inlined, while the non-inlined
         // version has it inlined.  So it saves code to keep this function not inlined while having
@@ -123,7 +155,8 @@ namespace System.Threading
             //
             // If we already own the lock, just increment the recursion count.
             //
-            if (_owningThreadId == currentThreadId)
+            if (_owningThreadId == currentThreadId ||
+                (_owningManagedThreadId != 0 && TryResolveOwningThreadId(currentThreadId)))
             {
                 checked { _recursionCount++; }
                 return true;
@@ -232,6 +265,7 @@ namespace System.Threading
         GotTheLock:
             Debug.Assert((_state | Locked) != 0);
             Debug.Assert(_owningThreadId == IntPtr.Zero);
+            Debug.Assert(_owningManagedThreadId == 0);
             Debug.Assert(_recursionCount == 0);
             _owningThreadId = currentThreadId;
             return true;
@@ -261,7 +295,8 @@ namespace System.Threading
                 // alive.
                 //
                 IntPtr currentThreadId = CurrentNativeThreadId;
-                bool acquired = (currentThreadId == _owningThreadId);
+                bool acquired = (currentThreadId == _owningThreadId) ||
+                    (_owningManagedThreadId != 0 && TryResolveOwningThreadId(currentThreadId));
                 if (acquired)
                     Debug.Assert((_state & Locked) != 0);
                 return acquired;
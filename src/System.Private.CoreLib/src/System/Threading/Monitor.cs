@@ -60,6 +60,10 @@ namespace System.Threading
 
         public static void Enter(object obj)
         {
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryAcquireThinLock(obj))
+                return;
+#endif
             Lock lck = GetLock(obj);
             if (lck.TryAcquire(0))
                 return;
@@ -71,6 +75,13 @@ namespace System.Threading
             if (lockTaken)
                 throw new ArgumentException(SR.Argument_MustBeFalse, nameof(lockTaken));
 
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryAcquireThinLock(obj))
+            {
+                lockTaken = true;
+                return;
+            }
+#endif
             Lock lck = GetLock(obj);
             if (lck.TryAcquire(0))
             {
@@ -83,6 +94,10 @@ namespace System.Threading
 
         public static bool TryEnter(object obj)
         {
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryAcquireThinLock(obj))
+                return true;
+#endif
             return GetLock(obj).TryAcquire(0);
         }
 
@@ -91,6 +106,13 @@ namespace System.Threading
             if (lockTaken)
                 throw new ArgumentException(SR.Argument_MustBeFalse, nameof(lockTaken));
 
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryAcquireThinLock(obj))
+            {
+                lockTaken = true;
+                return;
+            }
+#endif
             lockTaken = GetLock(obj).TryAcquire(0);
         }
 
@@ -99,6 +121,10 @@ namespace System.Threading
             if (millisecondsTimeout < -1)
                 throw new ArgumentOutOfRangeException(nameof(millisecondsTimeout), SR.ArgumentOutOfRange_NeedNonNegOrNegative1);
 
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryAcquireThinLock(obj))
+                return true;
+#endif
             Lock lck = GetLock(obj);
             if (lck.TryAcquire(0))
                 return true;
@@ -112,6 +138,13 @@ namespace System.Threading
             if (millisecondsTimeout < -1)
                 throw new ArgumentOutOfRangeException(nameof(millisecondsTimeout), SR.ArgumentOutOfRange_NeedNonNegOrNegative1);
 
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryAcquireThinLock(obj))
+            {
+                lockTaken = true;
+                return;
+            }
+#endif
             Lock lck = GetLock(obj);
             if (lck.TryAcquire(0))
             {
@@ -129,11 +162,19 @@ namespace System.Threading
 
         public static void Exit(object obj)
         {
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryReleaseThinLock(obj))
+                return;
+#endif
             GetLock(obj).Release();
         }
 
         public static bool IsEntered(object obj)
         {
+#if FEATURE_SYNCTABLE
+            if (obj != null && ObjectHeader.TryIsThinLockAcquired(obj, out bool isAcquired))
+                return isAcquired;
+#endif
             return GetLock(obj).IsAcquired;
         }
 
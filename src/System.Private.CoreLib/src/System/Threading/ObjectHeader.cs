@@ -23,8 +23,15 @@ namespace System.Threading
         //
         // All other bits may be used to store runtime data: hash code, sync entry index, etc.
         // Here we use the same bit layout as in CLR: if bit 26 (BIT_SBLK_IS_HASHCODE) is set,
-        // all the lower bits 0..25 store the hash code, otherwise they store either the sync
-        // entry index or all zero.
+        // all the lower bits 0..25 store the hash code.  If bit 27 (BIT_SBLK_IS_THIN_LOCK) is set,
+        // the object is locked by Monitor without a sync entry: bits 0..15 store the managed
+        // thread ID of the owner and bits 16..21 the number of times it entered the lock
+        // recursively.  Otherwise the lower bits store either the sync entry index or all zero.
+        //
+        // The thin lock takes a single compare-and-swap of the header to enter and exit and no
+        // allocation.  The lock is moved to a sync entry when another thread has to wait for it,
+        // when the recursion count or the thread ID don't fit in the header, or when the object
+        // needs a hash code or a Monitor condition too.
         //
         // If needed, the MASK_HASHCODE_INDEX bit mask may be made wider or narrower than the
         // current 26 bits; the BIT_SBLK_IS_HASHCODE bit is not required to be adjacent to the
@@ -36,6 +43,15 @@ namespace System.Threading
         private const int BIT_SBLK_IS_HASHCODE = 1 << IS_HASHCODE_BIT_NUMBER;
         internal const int MASK_HASHCODE_INDEX = BIT_SBLK_IS_HASHCODE - 1;
 
+        private const int BIT_SBLK_IS_THIN_LOCK = 1 << 27;
+        private const int SBLK_MASK_LOCK_THREADID = 0x0000FFFF;
+        private const int SBLK_LOCK_RECLEVEL_INC = 0x00010000;
+        private const int SBLK_MASK_LOCK_RECLEVEL = 0x003F0000;
+        private const int SBLK_LOCK_RECLEVEL_SHIFT = 16;
+
+        // Bits that tell whether the header stores anything besides the bits of the GC engine
+        private const int MASK_HEADER_DATA = BIT_SBLK_IS_THIN_LOCK | BIT_SBLK_IS_HASHCODE | MASK_HASHCODE_INDEX;
+
 #if TARGET_ARM || TARGET_ARM64
         [MethodImpl(MethodImplOptions.NoInlining)]
 #else
@@ -76,7 +92,7 @@ namespace System.Threading
                     Debug.Assert(hashOrIndex != 0);
                     return hashOrIndex;
                 }
-                if (hashOrIndex != 0)
+                if ((bits & BIT_SBLK_IS_THIN_LOCK) == 0 && hashOrIndex != 0)
                 {
                     // Look up the hash code in the SyncTable
                     int hashCode = SyncTable.GetHashCode(hashOrIndex);
@@ -86,14 +102,14 @@ namespace System.Threading
                     }
                 }
                 // The hash code has not yet been set.  Assign some value.
-                return AssignHashCode(pHeader);
+                return AssignHashCode(o, pHeader);
             }
         }
 
         /// <summary>
         /// Assigns a hash code to the object in a thread-safe way.
         /// </summary>
-        private static unsafe int AssignHashCode(int* pHeader)
+        private static unsafe int AssignHashCode(object o, int* pHeader)
         {
             int newHash = RuntimeHelpers.GetNewHashCode() & MASK_HASHCODE_INDEX;
             int bitAndValue;
@@ -107,7 +123,7 @@ namespace System.Threading
             while (true)
             {
                 int oldBits = Volatile.Read(ref *pHeader);
-                bitAndValue = oldBits & (BIT_SBLK_IS_HASHCODE | MASK_HASHCODE_INDEX);
+                bitAndValue = oldBits & MASK_HEADER_DATA;
                 if (bitAndValue != 0)
                 {
                     // The header already stores some value
@@ -124,6 +140,12 @@ namespace System.Threading
                 // Another thread modified the header; try again
             }
 
+            if ((bitAndValue & BIT_SBLK_IS_THIN_LOCK) != 0)
+            {
+                // The header is taken by a thin lock, move it to a sync entry that can store both
+                bitAndValue = SyncTable.AssignEntry(o, pHeader);
+            }
+
             if ((bitAndValue & BIT_SBLK_IS_HASHCODE) == 0)
             {
                 // Set the hash code in SyncTable.  This call will resolve the potential race.
@@ -145,10 +167,10 @@ namespace System.Threading
         {
             hashOrIndex = header & MASK_HASHCODE_INDEX;
             // The following is equivalent to:
-            //   return (hashOrIndex != 0) && ((header & BIT_SBLK_IS_HASHCODE) == 0);
-            // Shifting the BIT_SBLK_IS_HASHCODE bit to the sign bit saves one branch.
-            int bitAndValue = header & (BIT_SBLK_IS_HASHCODE | MASK_HASHCODE_INDEX);
-            return (bitAndValue << (31 - IS_HASHCODE_BIT_NUMBER)) > 0;
+            //   return (hashOrIndex != 0) && ((header & (BIT_SBLK_IS_HASHCODE | BIT_SBLK_IS_THIN_LOCK)) == 0);
+            // A single unsigned comparison of the data bits saves one branch.
+            int bitAndValue = header & MASK_HEADER_DATA;
+            return (uint)(bitAndValue - 1) < (uint)MASK_HASHCODE_INDEX;
         }
 
         /// <summary>
@@ -199,17 +221,157 @@ namespace System.Threading
                 }
 
                 Debug.Assert(((oldBits & BIT_SBLK_IS_HASHCODE) == 0) || (hashOrIndex != 0));
-                if (hashOrIndex != 0)
+
+                // Move the thin lock to the sync entry.  The lock of the entry is set on every attempt
+                // since the owner may release the thin lock, or another thread take it, in between.
+                int thinLockOwner = 0;
+                uint recursionCount = 0;
+                if ((oldBits & BIT_SBLK_IS_THIN_LOCK) != 0)
+                {
+                    thinLockOwner = oldBits & SBLK_MASK_LOCK_THREADID;
+                    recursionCount = (uint)((oldBits & SBLK_MASK_LOCK_RECLEVEL) >> SBLK_LOCK_RECLEVEL_SHIFT);
+                }
+                SyncTable.MoveThinLockToNewEntry(syncIndex, thinLockOwner, recursionCount);
+
+                if ((oldBits & BIT_SBLK_IS_HASHCODE) != 0)
                 {
                     // Move the hash code to the sync entry
                     SyncTable.MoveHashCodeToNewEntry(syncIndex, hashOrIndex);
                 }
 
                 // Store the sync entry index
-                newBits &= ~(BIT_SBLK_IS_HASHCODE | MASK_HASHCODE_INDEX);
+                newBits &= ~MASK_HEADER_DATA;
                 newBits |= syncIndex;
             }
             while (Interlocked.CompareExchange(ref *pHeader, newBits, oldBits) != oldBits);
         }
+
+        /// <summary>
+        /// Tries to enter the thin lock of the object for the current thread.  Returns false if the
+        /// lock has to go through the sync entry of the object instead.
+        /// </summary>
+        // Called from Monitor.Enter only; inlining is important for lock performance
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static unsafe bool TryAcquireThinLock(object o)
+        {
+            int currentThreadId = ManagedThreadId.Current;
+
+            fixed (byte* pRawData = &o.GetRawData())
+            {
+                // The header is 4 bytes before m_pEEType field on all architectures
+                int* pHeader = (int*)(pRawData - sizeof(IntPtr) - sizeof(int));
+
+                // Make one quick attempt to take an unlocked thin lock
+                int oldBits = *pHeader;
+                if ((oldBits & MASK_HEADER_DATA) == 0 && (uint)currentThreadId <= SBLK_MASK_LOCK_THREADID &&
+                    Interlocked.CompareExchange(ref *pHeader, oldBits | BIT_SBLK_IS_THIN_LOCK | currentThreadId, oldBits) == oldBits)
+                {
+                    return true;
+                }
+
+                return TryAcquireThinLockSlow(pHeader, currentThreadId);
+            }
+        }
+
+        private static unsafe bool TryAcquireThinLockSlow(int* pHeader, int currentThreadId)
+        {
+            if ((uint)currentThreadId > SBLK_MASK_LOCK_THREADID)
+                return false;
+
+            while (true)
+            {
+                int oldBits = Volatile.Read(ref *pHeader);
+                int newBits;
+
+                if ((oldBits & MASK_HEADER_DATA) == 0)
+                {
+                    newBits = oldBits | BIT_SBLK_IS_THIN_LOCK | currentThreadId;
+                }
+                else if ((oldBits & (BIT_SBLK_IS_THIN_LOCK | SBLK_MASK_LOCK_THREADID)) == (BIT_SBLK_IS_THIN_LOCK | currentThreadId))
+                {
+                    // Entered recursively, the sync entry takes over when the count doesn't fit anymore
+                    if ((oldBits & SBLK_MASK_LOCK_RECLEVEL) == SBLK_MASK_LOCK_RECLEVEL)
+                        return false;
+
+                    newBits = oldBits + SBLK_LOCK_RECLEVEL_INC;
+                }
+                else
+                {
+                    // Held by another thread, or the object has a hash code or a sync entry
+                    return false;
+                }
+
+                if (Interlocked.CompareExchange(ref *pHeader, newBits, oldBits) == oldBits)
+                    return true;
+
+                // Another thread modified the header; try again
+            }
+        }
+
+        /// <summary>
+        /// Tries to exit the thin lock of the object that the current thread holds.  Returns false if
+        /// the header doesn't store a thin lock of the current thread, the lock may be in the sync entry
+        /// of the object then.
+        /// </summary>
+        // Called from Monitor.Exit only; inlining is important for lock performance
+        [MethodImpl(MethodImplOptions.AggressiveInlining)]
+        public static unsafe bool TryReleaseThinLock(object o)
+        {
+            int currentThreadId = ManagedThreadId.Current;
+
+            fixed (byte* pRawData = &o.GetRawData())
+            {
+                // The header is 4 bytes before m_pEEType field on all architectures
+                int* pHeader = (int*)(pRawData - sizeof(IntPtr) - sizeof(int));
+
+                // Make one quick attempt to exit a thin lock that wasn't entered recursively
+                int oldBits = *pHeader;
+                if ((oldBits & (BIT_SBLK_IS_THIN_LOCK | SBLK_MASK_LOCK_RECLEVEL | SBLK_MASK_LOCK_THREADID)) == (BIT_SBLK_IS_THIN_LOCK | currentThreadId) &&
+                    Interlocked.CompareExchange(ref *pHeader, oldBits & ~(BIT_SBLK_IS_THIN_LOCK | SBLK_MASK_LOCK_THREADID), oldBits) == oldBits)
+                {
+                    return true;
+                }
+
+                return TryReleaseThinLockSlow(pHeader, currentThreadId);
+            }
+        }
+
+        private static unsafe bool TryReleaseThinLockSlow(int* pHeader, int currentThreadId)
+        {
+            while (true)
+            {
+                int oldBits = Volatile.Read(ref *pHeader);
+                if ((oldBits & (BIT_SBLK_IS_THIN_LOCK | SBLK_MASK_LOCK_THREADID)) != (BIT_SBLK_IS_THIN_LOCK | currentThreadId))
+                    return false;
+
+                int newBits = ((oldBits & SBLK_MASK_LOCK_RECLEVEL) != 0) ?
+                    oldBits - SBLK_LOCK_RECLEVEL_INC :
+                    oldBits & ~(BIT_SBLK_IS_THIN_LOCK | SBLK_MASK_LOCK_THREADID);
+
+                if (Interlocked.CompareExchange(ref *pHeader, newBits, oldBits) == oldBits)
+                    return true;
+
+                // Another thread modified the header; try again
+            }
+        }
+
+        /// <summary>
+        /// Tells whether the current thread holds the thin lock of the object.  Returns false if the
+        /// header stores a sync entry index, the lock is in the sync entry then.
+        /// </summary>
+        public static unsafe bool TryIsThinLockAcquired(object o, out bool isAcquired)
+        {
+            int currentThreadId = ManagedThreadId.Current;
+
+            fixed (byte* pRawData = &o.GetRawData())
+            {
+                // The header is 4 bytes before m_pEEType field on all architectures
+                int* pHeader = (int*)(pRawData - sizeof(IntPtr) - sizeof(int));
+
+                int bits = ReadVolatileMemory(pHeader);
+                isAcquired = (bits & (BIT_SBLK_IS_THIN_LOCK | SBLK_MASK_LOCK_THREADID)) == (BIT_SBLK_IS_THIN_LOCK | currentThreadId);
+                return !GetSyncEntryIndex(bits, out _);
+            }
+        }
     }
 }
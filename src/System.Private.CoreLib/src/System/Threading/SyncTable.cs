@@ -398,6 +398,18 @@ namespace System.Threading
             s_entries[syncIndex].HashCode = hashCode;
         }
 
+        /// <summary>
+        /// Sets the state of the Monitor synchronization object to that of the thin lock of the
+        /// object header, assuming the caller holds s_freeEntriesLock.  Use for not yet published
+        /// entries only.
+        /// </summary>
+        public static void MoveThinLockToNewEntry(int syncIndex, int managedThreadId, uint recursionCount)
+        {
+            Debug.Assert(s_freeEntriesLock.IsAcquired);
+            Debug.Assert((0 < syncIndex) && (syncIndex < s_unusedEntryIndex));
+            s_entries[syncIndex].Lock.InitializeLocked(managedThreadId, recursionCount);
+        }
+
         /// <summary>
         /// Returns the Monitor synchronization object.  The return value is never null.
         /// </summary>
@@ -327,12 +327,11 @@ namespace System.Threading
         public static void Sleep(int millisecondsTimeout) => SleepInternal(VerifyTimeoutMilliseconds(millisecondsTimeout));
 
         /// <summary>
-        /// Max value to be passed into <see cref="SpinWait(int)"/> for optimal delaying. Currently, the value comes from
-        /// defaults in CoreCLR's Thread::InitializeYieldProcessorNormalized(). This value is supposed to be normalized to be
-        /// appropriate for the processor.
-        /// TODO: See issue https://github.com/dotnet/corert/issues/4430
+        /// Max value to be passed into <see cref="SpinWait(int)"/> for optimal delaying. The runtime measures the delay of a
+        /// yield at startup and again from time to time, so the value is normalized to be appropriate for the processor and
+        /// its current frequency.
         /// </summary>
-        internal const int OptimalMaxSpinWaitsPerSpinIteration = 64;
+        internal static int OptimalMaxSpinWaitsPerSpinIteration => RuntimeImports.RhGetOptimalMaxSpinWaitsPerSpinIteration();
 
         public static void SpinWait(int iterations) => RuntimeImports.RhSpinWait(iterations);
 
@@ -74,12 +74,7 @@ namespace System
                 Debug.Assert(!this.EETypePtr.HasPointers);
 
                 // Compare the memory
-                int valueTypeSize = (int)this.EETypePtr.ValueTypeSize;
-                for (int i = 0; i < valueTypeSize; i++)
-                {
-                    if (Unsafe.Add(ref thisRawData, i) != Unsafe.Add(ref thatRawData, i))
-                        return false;
-                }
+                return SpanHelpers.SequenceEqual(ref thisRawData, ref thatRawData, this.EETypePtr.ValueTypeSize);
             }
             else
             {
@@ -132,12 +127,22 @@ namespace System
             // Sanity check - if there are GC references, we should not be hashing bytes
             Debug.Assert(!type.HasPointers);
 
+            // The hash code is the xor of the Int32s of the value, trailing bytes are ignored. Xor the Int64s
+            // and fold them to get there with half the reads.
             int size = (int)type.ValueTypeSize;
-            int hashCode = 0;
+            long wideHashCode = 0;
+
+            int i = 0;
+            for (; i + 8 <= size; i += 8)
+            {
+                wideHashCode ^= Unsafe.ReadUnaligned<long>(ref Unsafe.Add(ref data, i));
+            }
+
+            int hashCode = (int)wideHashCode ^ (int)(wideHashCode >> 32);
 
-            for (int i = 0; i < size / 4; i++)
+            if (i + 4 <= size)
             {
-                hashCode ^= Unsafe.As<byte, int>(ref Unsafe.Add(ref data, i * 4));
+                hashCode ^= Unsafe.ReadUnaligned<int>(ref Unsafe.Add(ref data, i));
             }
 
             return hashCode;
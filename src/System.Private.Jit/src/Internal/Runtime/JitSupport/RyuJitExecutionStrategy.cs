@@ -36,7 +36,7 @@ namespace Internal.Runtime.JitSupport
         }
 
         [DllImport(NativeJitSupportLibrary)]
-        static extern IntPtr AllocJittedCode(UInt32 cbCode, UInt32 align, out IntPtr pCodeManager);
+        static extern IntPtr AllocJittedCodeWithWritableAlias(UInt32 cbCode, UInt32 align, out IntPtr pCodeManager, out IntPtr pWritableCode);
 
         [DllImport(NativeJitSupportLibrary)]
         static extern void SetEHInfoPtr(IntPtr pCodeManager, IntPtr pbCode, IntPtr ehInfo);
@@ -161,27 +161,31 @@ namespace Internal.Runtime.JitSupport
 
                 // Layout of allocated memory...
                 // ObjectNodes (aligned as appropriate)
+                // The memory is written through writableCode, which may be a different mapping of the same
+                // memory if the code heap never makes code writable. Relocations are relative within the
+                // allocation, so they are the same in both.
                 IntPtr pCodeManager;
-                IntPtr jittedCode = AllocJittedCode(checked((uint)totalAllocSizeNeeded), 8/* TODO, alignment calculation */, out pCodeManager);
+                IntPtr writableCode;
+                IntPtr jittedCode = AllocJittedCodeWithWritableAlias(checked((uint)totalAllocSizeNeeded), 8/* TODO, alignment calculation */, out pCodeManager, out writableCode);
                 int currentOffset = 0;
 
                 foreach (var node in nodesToEmit)
                 {
                     ObjectNode.ObjectData objectData = node.GetData(_nodeFactory);
-                    EmitAndRelocData(objectData, jittedCode, relocTargetOffsetStart, ref currentOffset, relocTargetsArray, relocTargetsAsIntPtr);
+                    EmitAndRelocData(objectData, writableCode, relocTargetOffsetStart, ref currentOffset, relocTargetsArray, relocTargetsAsIntPtr);
 
                     // EHInfo doesn't get its own node, but it does get emitted into the stream.
                     if ((node == codeNode) && (codeNode.EHInfo != null))
                     {
                         Debug.Assert(offsetOfEHData == currentOffset);
-                        EmitAndRelocData(codeNode.EHInfo, jittedCode, relocTargetOffsetStart, ref currentOffset, relocTargetsArray, relocTargetsAsIntPtr);
+                        EmitAndRelocData(codeNode.EHInfo, writableCode, relocTargetOffsetStart, ref currentOffset, relocTargetsArray, relocTargetsAsIntPtr);
                     }
                 }
 
                 foreach (IntPtr ptr in relocTargetsAsIntPtr)
                 {
                     currentOffset = currentOffset.AlignUp(IntPtr.Size);
-                    Marshal.WriteIntPtr(jittedCode, currentOffset, ptr);
+                    Marshal.WriteIntPtr(writableCode, currentOffset, ptr);
                     currentOffset += IntPtr.Size;
                 }
 
@@ -368,6 +368,9 @@ namespace Internal.Runtime.TypeLoader
 
                     optionalFields.ClearField(EETypeOptionalFieldTag.ValueTypeFieldPadding);
 
+                    // The interfaces of the new type can differ from the ones of the template
+                    optionalFields.ClearField(EETypeOptionalFieldTag.InterfaceSignature);
+
                     if (valueTypeFieldPaddingEncoded != 0)
                         optionalFields.SetFieldValue(EETypeOptionalFieldTag.ValueTypeFieldPadding, valueTypeFieldPaddingEncoded);
 
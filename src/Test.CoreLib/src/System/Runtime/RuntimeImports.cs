@@ -55,6 +55,15 @@ namespace System.Runtime
         [RuntimeImport(RuntimeLibrary, "RhpUnregisterFrozenSegment")]
         internal static extern void RhpUnregisterFrozenSegment(IntPtr pSegmentHandle);
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        [RuntimeImport(RuntimeLibrary, "RhpRegisterPreInitializedStatics")]
+        private static extern bool RhpRegisterPreInitializedStatics(ref TypeManagerHandle module);
+
+        internal static bool RhpRegisterPreInitializedStatics(TypeManagerHandle module)
+        {
+            return RhpRegisterPreInitializedStatics(ref module);
+        }
+
         [RuntimeImport(RuntimeLibrary, "RhpGetModuleSection")]
         [MethodImplAttribute(MethodImplOptions.InternalCall)]
         private static extern IntPtr RhGetModuleSection(ref TypeManagerHandle module, ReadyToRunSectionType section, out int length);
@@ -116,6 +116,14 @@ namespace System
                 FailFast("Exceptions must derive from the System.Exception class");
         }
 
+        [RuntimeExport("AppendExceptionStackFrames")]
+        private static void AppendExceptionStackFrames(object exceptionObj, IntPtr pIPs, int count, int flags)
+        {
+            Exception ex = exceptionObj as Exception;
+            if (ex == null)
+                FailFast("Exceptions must derive from the System.Exception class");
+        }
+
         [RuntimeExport("OnFirstChanceException")]
         internal static void OnFirstChanceException(object e)
         {
@@ -60,6 +60,7 @@ if /i "%1" == "/multimodule" (set CoreRT_MultiFileConfiguration=MultiModule&shif
 if /i "%1" == "/singlethread" (set CoreRT_SingleThreaded=true&shift&goto ArgLoop)
 if /i "%1" == "/determinism" (set CoreRT_DeterminismMode=true&shift&goto ArgLoop)
 if /i "%1" == "/nocleanup" (set CoreRT_NoCleanup=true&shift&goto ArgLoop)
+if /i "%1" == "/startup" (set CoreRT_RunStartupBenchmark=true&shift&goto ArgLoop)
 echo Invalid command line argument: %1
 goto :Usage
 
@@ -79,6 +80,7 @@ echo     /singlethread : Run tests on a single thread (avoid parallel test execu
 echo     /determinism  : Compile the test twice with randomized dependency node mark stack to validate
 echo                      compiler determinism in multi-threaded compilation.
 echo     /nocleanup    : Do not delete compiled test artifacts after running each test
+echo     /startup      : Build the startup benchmark tests and measure their startup (see scripts\startup_benchmark.py)
 echo.
 echo     --- CoreCLR Subset ---
 echo        Top200     : Runs broad coverage / CI validation (~200 tests).
@@ -147,6 +149,9 @@ set /a __JitTotalTests=0
 set /a __JitPassedTests=0
 set /a __WasmTotalTests=0
 set /a __WasmPassedTests=0
+
+if /i "%CoreRT_RunStartupBenchmark%"=="true" goto :StartupBenchmark
+
 for /f "delims=" %%a in ('dir /s /aD /b %CoreRT_TestRoot%\src\%CoreRT_TestName%') do (
     set __SourceFolder=%%a
     set __SourceFileName=%%~na
@@ -233,6 +238,24 @@ if not !__CppStatusPassed! EQU 1 (exit /b 1)
 if not !__WasmStatusPassed! EQU 1 (exit /b 1)
 exit /b 0
 
+:StartupBenchmark
+set CoreRT_TestRun=false
+set __Mode=Jit
+set __StartupExecutables=
+for %%t in (Hello MultiModule Reflection) do (
+    set __StartupFolder=%CoreRT_TestRoot%src\Simple\%%t
+    call :CompileFile !__StartupFolder! %%t !__StartupFolder!\%%t.csproj %__LogDir%\src\Simple\%%t
+    if not exist "!__StartupFolder!\bin\%CoreRT_BuildType%\%CoreRT_BuildArch%\native\%%t.exe" (
+        echo Error: %%t failed to build.
+        exit /b 1
+    )
+    set __StartupExecutables=!__StartupExecutables! !__StartupFolder!\bin\%CoreRT_BuildType%\%CoreRT_BuildArch%\native\%%t.exe
+)
+python %CoreRT_TestRoot%scripts\startup_benchmark.py -output %__CoreRTTestBinDir%\startup.csv !__StartupExecutables!
+set __SavedErrorLevel=!ErrorLevel!
+type %__CoreRTTestBinDir%\startup.csv
+exit /b !__SavedErrorLevel!
+
 :PassFail
 set __Green=%~1
 set __OutStr=%~2
@@ -12,6 +12,7 @@ usage()
     echo "    -singlethread : Run tests on a single thread (avoid parallel execution)"
     echo "    -coredumps    : [For CI use] Enables core dump generation, and analyzes and possibly stores/uploads"
     echo "                      dumps collected during test run."
+    echo "    -startup      : Build the startup benchmark tests and measure their startup (see scripts/startup_benchmark.py)"
     echo ""
     echo "    --- CoreCLR Subset ---"
     echo "       top200     : Runs broad coverage / CI validation (~200 tests)."
@@ -222,6 +223,32 @@ run_coreclr_tests()
     python runtest.py -test_native_bin_location ${CoreRT_TestExtRepo}/native/tests -test_location ${CoreRT_TestRoot}/CoreCLR -core_root ${CoreRT_TestExtRepo}/Tests/Core_Root -coreclr_repo_location ${CoreRT_TestRoot}/.. ${CoreRT_TestSelectionArg}
 }
 
+run_startup_benchmark()
+{
+    local __startup_executables=()
+
+    CoreRT_TestRun=false
+    for __test_name in Hello MultiModule Reflection
+    do
+        local __test_dir=${CoreRT_TestRoot}/src/Simple/${__test_name}
+        if [ -e ${__test_dir}/no_unix ]; then continue; fi
+
+        run_test_dir ${__test_dir}/${__test_name}.csproj "Jit"
+
+        local __executable=${__test_dir}/bin/${CoreRT_BuildType}/${CoreRT_BuildArch}/native/${__test_name}
+        if [ ! -e ${__executable} ]; then
+            echo "Error: ${__test_name} failed to build."
+            return 1
+        fi
+        __startup_executables+=(${__executable})
+    done
+
+    python3 ${CoreRT_TestRoot}/scripts/startup_benchmark.py -output ${__CoreRTTestBinDir}/startup.csv "${__startup_executables[@]}"
+    local __exitcode=$?
+    cat ${__CoreRTTestBinDir}/startup.csv
+    return ${__exitcode}
+}
+
 run_corefx_tests()
 {
     CoreRT_TestExtRepo_CoreFX=${CoreRT_TestRoot}/../tests_downloaded/CoreFX
@@ -390,6 +417,9 @@ while [ "$1" != "" ]; do
         -coredumps)
             CoreRT_EnableCoreDumps=1
             ;;
+        -startup)
+            CoreRT_RunStartupBenchmark=true
+            ;;
         *)
             ;;
     esac
@@ -487,6 +517,11 @@ if [ ! -d ${__CoreRTTestBinDir} ]; then
 fi
 echo > ${__CoreRTTestBinDir}/testResults.tmp
 
+if [ ${CoreRT_RunStartupBenchmark} ]; then
+    run_startup_benchmark
+    exit $?
+fi
+
 __BuildOsLowcase=$(echo "${CoreRT_BuildOS}" | tr '[:upper:]' '[:lower:]')
 __TestSearchPath=${CoreRT_TestRoot}/src/Simple/${CoreRT_TestName}
 for csproj in $(find ${__TestSearchPath} -name "*.csproj")
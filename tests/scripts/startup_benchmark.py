@@ -0,0 +1,271 @@
+#!/usr/bin/env python
+#
+## Licensed to the .NET Foundation under one or more agreements.
+## The .NET Foundation licenses this file to you under the MIT license.
+## See the LICENSE file in the project root for more information.
+#
+##
+# Title               : startup_benchmark.py
+#
+# Notes:
+#
+# Startup benchmark for native executables. Each executable is launched a
+# number of times with RH_StartupTimeline=1, and the timeline the runtime
+# prints to stderr at shutdown is combined with the time the launcher started
+# the process and the resource usage of the process once it exited:
+#
+#   launch_to_runtime_us    : process creation to the start of RhInitialize
+#   time_to_first_refill_us : process creation to the first allocation that
+#                             needed a new allocation context
+#   time_to_main_us         : process creation to the managed entry point
+#   total_us                : process creation to exit
+#   phase:<event>_us        : time between the previous timeline event and
+#                             <event>, summed over the modules registered
+#   page_faults             : minor and major page faults of the process
+#   peak_rss_kb             : peak resident set size of the process
+#
+# The median of each metric is written as CSV (executable,metric,median,min,max)
+# to stdout or to the -output file. Given a -baseline file in the same format,
+# medians that grew by more than -threshold percent are reported and make the
+# script fail, so a CI job can keep the startup numbers from regressing.
+#
+# The launcher reads the clock the runtime uses for its performance counter,
+# CLOCK_MONOTONIC on Unix and QueryPerformanceCounter on Windows.
+#
+################################################################################
+################################################################################
+
+from __future__ import print_function
+
+import argparse
+import csv
+import os
+import subprocess
+import sys
+import time
+
+################################################################################
+# Argument Parser
+################################################################################
+
+description = ("""Measures the startup of native executables built with the
+               CoreRT toolchain.""")
+
+parser = argparse.ArgumentParser(description=description)
+
+parser.add_argument("executables", nargs="+", help="Executables to measure")
+parser.add_argument("-iterations", dest="iterations", type=int, default=20, help="Measured runs of each executable")
+parser.add_argument("-warmup", dest="warmup", type=int, default=2, help="Runs of each executable that are not measured, to fill the file system cache")
+parser.add_argument("-output", dest="output", default=None, help="CSV file to write the results to instead of stdout")
+parser.add_argument("-baseline", dest="baseline", default=None, help="CSV file written by an earlier run to compare the results to")
+parser.add_argument("-threshold", dest="threshold", type=float, default=10.0, help="Percent a median can grow over the baseline before it is a regression")
+
+TIMELINE_PREFIX = "RhStartupTimeline: "
+
+################################################################################
+# Process measurement
+################################################################################
+
+if sys.platform == "win32":
+    import ctypes
+    import ctypes.wintypes
+
+    class PROCESS_MEMORY_COUNTERS(ctypes.Structure):
+        _fields_ = [("cb", ctypes.wintypes.DWORD),
+                    ("PageFaultCount", ctypes.wintypes.DWORD),
+                    ("PeakWorkingSetSize", ctypes.c_size_t),
+                    ("WorkingSetSize", ctypes.c_size_t),
+                    ("QuotaPeakPagedPoolUsage", ctypes.c_size_t),
+                    ("QuotaPagedPoolUsage", ctypes.c_size_t),
+                    ("QuotaPeakNonPagedPoolUsage", ctypes.c_size_t),
+                    ("QuotaNonPagedPoolUsage", ctypes.c_size_t),
+                    ("PagefileUsage", ctypes.c_size_t),
+                    ("PeakPagefileUsage", ctypes.c_size_t)]
+
+    def now_us():
+        return time.perf_counter() * 1000000
+
+    def run_process(args, env):
+        """ Run a process to completion.
+
+        Returns:
+            (exit code, stderr, page faults, peak RSS in KB)
+        """
+        process = subprocess.Popen(args, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+        stderr = process.stderr.read()
+        process.wait()
+
+        counters = PROCESS_MEMORY_COUNTERS()
+        counters.cb = ctypes.sizeof(counters)
+        if not ctypes.windll.psapi.GetProcessMemoryInfo(ctypes.wintypes.HANDLE(int(process._handle)), ctypes.byref(counters), counters.cb):
+            return process.returncode, stderr, None, None
+
+        return process.returncode, stderr, counters.PageFaultCount, counters.PeakWorkingSetSize // 1024
+
+else:
+    def now_us():
+        return time.clock_gettime(time.CLOCK_MONOTONIC) * 1000000
+
+    def run_process(args, env):
+        """ Run a process to completion.
+
+        Returns:
+            (exit code, stderr, page faults, peak RSS in KB)
+        """
+        process = subprocess.Popen(args, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, universal_newlines=True)
+        stderr = process.stderr.read()
+
+        # Reap the process here rather than through Popen to get its resource usage
+        _, status, usage = os.wait4(process.pid, 0)
+        process.returncode = os.WEXITSTATUS(status) if os.WIFEXITED(status) else -os.WTERMSIG(status)
+
+        # ru_maxrss is in bytes on macOS and in kilobytes elsewhere
+        peak_rss_kb = usage.ru_maxrss // 1024 if sys.platform == "darwin" else usage.ru_maxrss
+        return process.returncode, stderr, usage.ru_minflt + usage.ru_majflt, peak_rss_kb
+
+def parse_timeline(stderr):
+    """ Parse the startup timeline printed by the runtime.
+
+    Returns:
+        (origin of the timeline in us, [(event, us since origin)])
+    """
+    origin = None
+    events = []
+
+    for line in stderr.splitlines():
+        if not line.startswith(TIMELINE_PREFIX):
+            continue
+
+        fields = line[len(TIMELINE_PREFIX):].split()
+        if len(fields) >= 3 and fields[0] == "origin":
+            origin = float(fields[1])
+        elif len(fields) >= 3 and fields[2] == "us":
+            events.append((fields[0], float(fields[1])))
+
+    return origin, events
+
+def measure(executable):
+    """ Run an executable once.
+
+    Returns:
+        dictionary of metric to value
+    """
+    env = dict(os.environ)
+    env["RH_StartupTimeline"] = "1"
+
+    launch = now_us()
+    exit_code, stderr, page_faults, peak_rss_kb = run_process([executable], env)
+    total = now_us() - launch
+
+    if exit_code not in (0, 100):
+        raise RuntimeError("{} exited with {}:\n{}".format(executable, exit_code, stderr))
+
+    origin, events = parse_timeline(stderr)
+    if origin is None or len(events) == 0:
+        raise RuntimeError("{} did not print a startup timeline".format(executable))
+
+    metrics = {}
+    metrics["total_us"] = total
+    metrics["launch_to_runtime_us"] = origin - launch
+
+    previous = 0.0
+    for event, offset in events:
+        phase = "phase:" + event + "_us"
+        metrics[phase] = metrics.get(phase, 0.0) + offset - previous
+        previous = offset
+
+        if event == "FirstAllocationRefill":
+            metrics["time_to_first_refill_us"] = origin + offset - launch
+        elif event == "ManagedMainBegin":
+            metrics["time_to_main_us"] = origin + offset - launch
+
+    if page_faults is not None:
+        metrics["page_faults"] = page_faults
+        metrics["peak_rss_kb"] = peak_rss_kb
+
+    return metrics
+
+def median(values):
+    values = sorted(values)
+    middle = len(values) // 2
+    if len(values) % 2 == 1:
+        return values[middle]
+    return (values[middle - 1] + values[middle]) / 2.0
+
+################################################################################
+# Reporting
+################################################################################
+
+def summarize(executable, runs):
+    """ Returns [(executable, metric, median, min, max)] for the metrics of all runs """
+    name = os.path.splitext(os.path.basename(executable))[0]
+    metrics = []
+    for run in runs:
+        for metric in run:
+            if metric not in metrics:
+                metrics.append(metric)
+
+    rows = []
+    for metric in metrics:
+        values = [run[metric] for run in runs if metric in run]
+        rows.append((name, metric, median(values), min(values), max(values)))
+    return rows
+
+def compare(rows, baseline_file, threshold):
+    """ Returns the number of medians that regressed against the baseline """
+    baseline = {}
+    with open(baseline_file) as f:
+        for row in csv.reader(f):
+            if len(row) >= 3 and row[0] != "executable":
+                baseline[(row[0], row[1])] = float(row[2])
+
+    regressions = 0
+    for name, metric, value, _, _ in rows:
+        previous = baseline.get((name, metric))
+        if previous is None or previous <= 0:
+            continue
+
+        change = (value - previous) * 100.0 / previous
+        if change > threshold:
+            print("Regression: {} {} {:.0f} -> {:.0f} (+{:.1f}%)".format(name, metric, previous, value, change), file=sys.stderr)
+            regressions += 1
+
+    return regressions
+
+def main(args):
+    if sys.version_info.major < 3:
+        print("startup_benchmark.py requires Python 3", file=sys.stderr)
+        return 2
+
+    rows = []
+    for executable in args.executables:
+        if not os.path.isfile(executable):
+            print("{} does not exist".format(executable), file=sys.stderr)
+            return 1
+
+        for _ in range(args.warmup):
+            measure(executable)
+
+        runs = [measure(executable) for _ in range(args.iterations)]
+        rows.extend(summarize(executable, runs))
+
+    output = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(output, lineterminator="\n")
+    writer.writerow(("executable", "metric", "median", "min", "max"))
+    for name, metric, value, minimum, maximum in rows:
+        writer.writerow((name, metric, "{:.0f}".format(value), "{:.0f}".format(minimum), "{:.0f}".format(maximum)))
+    if args.output:
+        output.close()
+
+    if args.baseline and compare(rows, args.baseline, args.threshold) > 0:
+        return 1
+
+    return 0
+
+################################################################################
+# __Main__
+################################################################################
+
+if __name__ == "__main__":
+    args = parser.parse_args()
+    sys.exit(main(args))
@@ -0,0 +1,487 @@
+// Licensed to the .NET Foundation under one or more agreements.
+// The .NET Foundation licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Runtime.CompilerServices;
+using System.Threading;
+
+//
+// Microbenchmarks of the runtime paths that compiled code calls the most: interface dispatch at each size of
+// the dispatch cell cache (RhpInterfaceDispatch), casting (RhTypeCast), allocation (RhpNewFast, RhpNewArray),
+// exception dispatch, stack trace capture (RhGetCurrentThreadStackTrace) and thread suspension.
+//
+// Every measurement is written as a line of CSV:
+//
+//     benchmark,parameter,operations,nanoseconds_per_operation
+//
+// so runs of different builds can be compared with a script. The test run passes -quick, which does a few
+// iterations of each benchmark to keep them working. Without it the iteration counts are sized for
+// measurements that are stable to a few percent.
+//
+
+internal static class Program
+{
+    private const int Pass = 100;
+    private const int Fail = -1;
+
+    private static int s_scale;
+
+    public static int Main(string[] args)
+    {
+        bool quick = args.Length > 0 && args[0] == "-quick";
+        s_scale = quick ? 1 : 1000;
+
+        Console.WriteLine("benchmark,parameter,operations,nanoseconds_per_operation");
+
+        try
+        {
+            DispatchBenchmarks.Run();
+            CastingBenchmarks.Run();
+            AllocationBenchmarks.Run();
+            ExceptionBenchmarks.Run();
+            StackTraceBenchmarks.Run();
+            SuspensionBenchmarks.Run();
+        }
+        catch (Exception e)
+        {
+            Console.WriteLine("Unexpected exception: " + e.ToString());
+            return Fail;
+        }
+
+        return Pass;
+    }
+
+    public static int Iterations(int full)
+    {
+        return Math.Max(1, full / 1000 * s_scale);
+    }
+
+    public static void Report(string benchmark, string parameter, long operations, Stopwatch stopwatch)
+    {
+        double nanoseconds = stopwatch.Elapsed.Ticks * (1000000000.0 / TimeSpan.TicksPerSecond) / operations;
+        Console.WriteLine(string.Join(",",
+            benchmark,
+            parameter,
+            operations.ToString(CultureInfo.InvariantCulture),
+            nanoseconds.ToString("F2", CultureInfo.InvariantCulture)));
+    }
+}
+
+//
+// Interface dispatch. A dispatch cell starts out resolving every call through the runtime and then grows a
+// cache of the types it has seen, 1, 2, 4, ... 64 entries. Each call site below sees an increasing number of
+// types, so the measurement for N types runs with a cache that has just grown to hold them.
+//
+internal interface IDispatchTarget
+{
+    int GetValue();
+}
+
+internal class Target0<T> : IDispatchTarget { public int GetValue() => 0; }
+internal class Target1<T> : IDispatchTarget { public int GetValue() => 1; }
+internal class Target2<T> : IDispatchTarget { public int GetValue() => 2; }
+internal class Target3<T> : IDispatchTarget { public int GetValue() => 3; }
+internal class Target4<T> : IDispatchTarget { public int GetValue() => 4; }
+internal class Target5<T> : IDispatchTarget { public int GetValue() => 5; }
+internal class Target6<T> : IDispatchTarget { public int GetValue() => 6; }
+internal class Target7<T> : IDispatchTarget { public int GetValue() => 7; }
+
+internal class Arg0 { }
+internal class Arg1 { }
+internal class Arg2 { }
+internal class Arg3 { }
+internal class Arg4 { }
+internal class Arg5 { }
+internal class Arg6 { }
+internal class Arg7 { }
+
+internal static class DispatchBenchmarks
+{
+    private static void AddTargets<T>(List<IDispatchTarget> targets)
+    {
+        targets.Add(new Target0<T>());
+        targets.Add(new Target1<T>());
+        targets.Add(new Target2<T>());
+        targets.Add(new Target3<T>());
+        targets.Add(new Target4<T>());
+        targets.Add(new Target5<T>());
+        targets.Add(new Target6<T>());
+        targets.Add(new Target7<T>());
+    }
+
+    // 64 objects of distinct types. Class types over different reference type arguments share code but
+    // each has its own EEType, so each takes its own entry in the cache.
+    private static IDispatchTarget[] CreateTargets()
+    {
+        var targets = new List<IDispatchTarget>();
+        AddTargets<Arg0>(targets);
+        AddTargets<Arg1>(targets);
+        AddTargets<Arg2>(targets);
+        AddTargets<Arg3>(targets);
+        AddTargets<Arg4>(targets);
+        AddTargets<Arg5>(targets);
+        AddTargets<Arg6>(targets);
+        AddTargets<Arg7>(targets);
+        return targets.ToArray();
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int Dispatch(IDispatchTarget[] targets, int typeCount, int iterations)
+    {
+        int sum = 0;
+        for (int i = 0; i < iterations; i++)
+        {
+            for (int j = 0; j < typeCount; j++)
+                sum += targets[j].GetValue();
+        }
+        return sum;
+    }
+
+    public static void Run()
+    {
+        IDispatchTarget[] targets = CreateTargets();
+        int iterations = Program.Iterations(10000000);
+
+        for (int typeCount = 1; typeCount <= targets.Length; typeCount *= 2)
+        {
+            int rounds = Math.Max(1, iterations / typeCount);
+
+            // Let the cache grow to hold the new types before it is measured
+            Dispatch(targets, typeCount, 1);
+
+            Stopwatch stopwatch = Stopwatch.StartNew();
+            Dispatch(targets, typeCount, rounds);
+            stopwatch.Stop();
+
+            Program.Report("InterfaceDispatch", typeCount.ToString(CultureInfo.InvariantCulture) + " types", (long)rounds * typeCount, stopwatch);
+        }
+    }
+}
+
+//
+// Casting. Each case is measured on a cast that succeeds and one that fails, since the runtime returns from
+// different points of the type hierarchy and interface map walks for the two.
+//
+internal class CastBase { }
+internal class CastDerived : CastBase, IDisposable { public void Dispose() { } }
+internal class CastMostDerived : CastDerived { }
+internal class CastUnrelated { }
+
+internal static class CastingBenchmarks
+{
+    private static object s_mostDerived = new CastMostDerived();
+    private static object s_unrelated = new CastUnrelated();
+    private static object s_stringArray = new string[1];
+    private static object s_intArray = new int[1];
+    private static object s_stringList = new List<string>();
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int IsClass(object o, int iterations)
+    {
+        int count = 0;
+        for (int i = 0; i < iterations; i++)
+            if (o is CastBase) count++;
+        return count;
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int IsInterface(object o, int iterations)
+    {
+        int count = 0;
+        for (int i = 0; i < iterations; i++)
+            if (o is IDisposable) count++;
+        return count;
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int IsArray(object o, int iterations)
+    {
+        int count = 0;
+        for (int i = 0; i < iterations; i++)
+            if (o is object[]) count++;
+        return count;
+    }
+
+    // Variant interfaces go through the cast cache of the runtime
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int IsVariantInterface(object o, int iterations)
+    {
+        int count = 0;
+        for (int i = 0; i < iterations; i++)
+            if (o is IEnumerable<object>) count++;
+        return count;
+    }
+
+    private static void Measure(string benchmark, Func<object, int, int> cast, object hit, object miss)
+    {
+        int iterations = Program.Iterations(10000000);
+
+        cast(hit, 1);
+        cast(miss, 1);
+
+        Stopwatch stopwatch = Stopwatch.StartNew();
+        int count = cast(hit, iterations);
+        stopwatch.Stop();
+        if (count != iterations)
+            throw new Exception(benchmark + " cast failed");
+        Program.Report(benchmark, "hit", iterations, stopwatch);
+
+        stopwatch = Stopwatch.StartNew();
+        count = cast(miss, iterations);
+        stopwatch.Stop();
+        if (count != 0)
+            throw new Exception(benchmark + " cast succeeded");
+        Program.Report(benchmark, "miss", iterations, stopwatch);
+    }
+
+    public static void Run()
+    {
+        Measure("CastClass", IsClass, s_mostDerived, s_unrelated);
+        Measure("CastInterface", IsInterface, s_mostDerived, s_unrelated);
+        Measure("CastArray", IsArray, s_stringArray, s_intArray);
+        Measure("CastVariantInterface", IsVariantInterface, s_stringList, s_unrelated);
+    }
+}
+
+//
+// Allocation. Objects are dropped right away, so the measurements include the share of gen0 GCs that the
+// allocation rate causes, as in real code.
+//
+internal class SmallObject
+{
+    public object Field;
+}
+
+internal class FinalizableObject
+{
+    ~FinalizableObject() { }
+}
+
+internal static class AllocationBenchmarks
+{
+    private static object s_sink;
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static void NewObject(int iterations)
+    {
+        for (int i = 0; i < iterations; i++)
+            s_sink = new SmallObject();
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static void NewFinalizableObject(int iterations)
+    {
+        for (int i = 0; i < iterations; i++)
+            s_sink = new FinalizableObject();
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static void NewArray(int length, int iterations)
+    {
+        for (int i = 0; i < iterations; i++)
+            s_sink = new int[length];
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static void NewString(int length, int iterations)
+    {
+        for (int i = 0; i < iterations; i++)
+            s_sink = new string('a', length);
+    }
+
+    public static void Run()
+    {
+        int iterations = Program.Iterations(10000000);
+
+        NewObject(1);
+        Stopwatch stopwatch = Stopwatch.StartNew();
+        NewObject(iterations);
+        stopwatch.Stop();
+        Program.Report("NewObject", "", iterations, stopwatch);
+
+        int finalizableIterations = Program.Iterations(1000000);
+        NewFinalizableObject(1);
+        stopwatch = Stopwatch.StartNew();
+        NewFinalizableObject(finalizableIterations);
+        stopwatch.Stop();
+        Program.Report("NewFinalizableObject", "", finalizableIterations, stopwatch);
+        GC.Collect();
+        GC.WaitForPendingFinalizers();
+
+        foreach (int length in new int[] { 0, 16, 256, 4096 })
+        {
+            int arrayIterations = Math.Max(1, iterations / Math.Max(1, length / 16));
+            NewArray(length, 1);
+            stopwatch = Stopwatch.StartNew();
+            NewArray(length, arrayIterations);
+            stopwatch.Stop();
+            Program.Report("NewArray", length.ToString(CultureInfo.InvariantCulture) + " elements", arrayIterations, stopwatch);
+        }
+
+        NewString(16, 1);
+        stopwatch = Stopwatch.StartNew();
+        NewString(16, iterations);
+        stopwatch.Stop();
+        Program.Report("NewString", "16 chars", iterations, stopwatch);
+
+        s_sink = null;
+    }
+}
+
+//
+// Exception dispatch. The cost of a throw grows with the number of frames the two passes of the dispatcher
+// unwind, so it is measured between frames that are increasingly far apart.
+//
+internal class BenchmarkException : Exception
+{
+}
+
+internal static class ExceptionBenchmarks
+{
+    private static Exception s_exception = new BenchmarkException();
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int ThrowAtDepth(int depth)
+    {
+        if (depth == 0)
+            throw s_exception;
+        return ThrowAtDepth(depth - 1) + 1;
+    }
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int ThrowAndCatch(int depth, int iterations)
+    {
+        int caught = 0;
+        for (int i = 0; i < iterations; i++)
+        {
+            try
+            {
+                ThrowAtDepth(depth);
+            }
+            catch (BenchmarkException)
+            {
+                caught++;
+            }
+        }
+        return caught;
+    }
+
+    public static void Run()
+    {
+        foreach (int depth in new int[] { 0, 1, 10, 100 })
+        {
+            int iterations = Program.Iterations(100000 / (depth + 1));
+
+            ThrowAndCatch(depth, 1);
+            Stopwatch stopwatch = Stopwatch.StartNew();
+            int caught = ThrowAndCatch(depth, iterations);
+            stopwatch.Stop();
+            if (caught != iterations)
+                throw new Exception("Exceptions weren't caught");
+
+            Program.Report("ThrowCatch", depth.ToString(CultureInfo.InvariantCulture) + " frames", iterations, stopwatch);
+        }
+    }
+}
+
+//
+// Stack trace capture walks the stack of the current thread twice, once to count the frames and once to
+// record their IPs, and creates a StackFrame for each. File and line information isn't asked for.
+//
+internal static class StackTraceBenchmarks
+{
+    private static StackTrace s_stackTrace;
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int CaptureAtDepth(int depth, int iterations)
+    {
+        if (depth > 0)
+            return CaptureAtDepth(depth - 1, iterations) + 1;
+
+        for (int i = 0; i < iterations; i++)
+            s_stackTrace = new StackTrace(false);
+        return 0;
+    }
+
+    public static void Run()
+    {
+        foreach (int depth in new int[] { 0, 10, 100 })
+        {
+            int iterations = Program.Iterations(100000);
+
+            CaptureAtDepth(depth, 1);
+            Stopwatch stopwatch = Stopwatch.StartNew();
+            CaptureAtDepth(depth, iterations);
+            stopwatch.Stop();
+
+            Program.Report("StackTrace", depth.ToString(CultureInfo.InvariantCulture) + " frames", iterations, stopwatch);
+        }
+
+        s_stackTrace = null;
+    }
+}
+
+//
+// Thread suspension. A gen0 GC of an empty heap does little besides suspending and restarting the threads,
+// so its cost as more threads run managed code is a measure of the SuspendAllThreads path. The threads keep
+// making calls so that each one is stopped by a return address hijack, as a thread in ordinary code is.
+//
+internal static class SuspensionBenchmarks
+{
+    private static volatile bool s_stop;
+    private static int s_started;
+
+    [MethodImpl(MethodImplOptions.NoInlining)]
+    private static int Work(int value)
+    {
+        return value * 31 + 7;
+    }
+
+    private static void Spin()
+    {
+        Interlocked.Increment(ref s_started);
+
+        int value = 0;
+        while (!s_stop)
+            value = Work(value);
+    }
+
+    public static void Run()
+    {
+        int iterations = Program.Iterations(10000);
+        int maxThreads = Math.Max(8, Environment.ProcessorCount);
+
+        for (int threadCount = 0; threadCount <= maxThreads; threadCount = threadCount == 0 ? 1 : threadCount * 2)
+        {
+            s_stop = false;
+            s_started = 0;
+
+            var threads = new Thread[threadCount];
+            for (int i = 0; i < threadCount; i++)
+            {
+                threads[i] = new Thread(Spin);
+                threads[i].IsBackground = true;
+                threads[i].Start();
+            }
+
+            while (Volatile.Read(ref s_started) != threadCount)
+                Thread.Sleep(1);
+
+            GC.Collect(0);
+            Stopwatch stopwatch = Stopwatch.StartNew();
+            for (int i = 0; i < iterations; i++)
+                GC.Collect(0);
+            stopwatch.Stop();
+
+            s_stop = true;
+            foreach (Thread thread in threads)
+                thread.Join();
+
+            Program.Report("SuspendAllThreads", threadCount.ToString(CultureInfo.InvariantCulture) + " threads", iterations, stopwatch);
+        }
+    }
+}
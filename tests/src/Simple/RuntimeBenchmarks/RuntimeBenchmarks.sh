@@ -0,0 +1,9 @@
+#!/usr/bin/env bash
+$1/$2 -quick
+if [ $? == 100 ]; then
+    echo pass
+    exit 0
+else
+    echo fail
+    exit 1
+fi